@@ -0,0 +1,1820 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * benchmark_algorithms.cpp
+ *
+ * @brief The benchmark of each CUDPP algorithm.
+ *
+ * Each benchmark allocates device arrays for its largest size, then plans
+ * and times every configuration it sweeps.  Inputs are random but fixed
+ * (see fillDeviceRandom()), so results are comparable between runs.  The
+ * bytes per element reported are the nominal input and output traffic of
+ * the algorithm, not a measurement.
+ */
+
+#include <cuda_runtime_api.h>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <vector>
+
+#include "cudpp_benchmark.h"
+#include "cuda_util.h"
+
+/** @brief Fills in the description of a configuration */
+static void initResult(benchmarkResult &result, const char *algorithm,
+                       const char *variant, const CUDPPConfiguration &config,
+                       size_t numElements, double bytesPerElement)
+{
+    result.algorithm       = algorithm;
+    result.variant         = variant;
+    result.datatype        = datatypeName(config.datatype);
+    result.op              = operatorName(config.op);
+    result.options         = optionsName(config.options);
+    result.numElements     = numElements;
+    result.bytesPerElement = bytesPerElement;
+    result.planBytes       = 0;
+    result.times.clear();
+}
+
+/** @brief Creates a plan, recording the device memory it takes
+ *  @returns false (after reporting the failure) if planning failed */
+static bool planBenchmark(CUDPPHandle theCudpp, CUDPPHandle &plan,
+                          const CUDPPConfiguration &config, size_t numElements,
+                          size_t numRows, size_t rowPitch,
+                          benchmarkResult &result, BenchmarkReporter &reporter)
+{
+    size_t before = deviceMemoryInUse();
+    if (cudppPlan(theCudpp, &plan, config, numElements, numRows, rowPitch)
+        != CUDPP_SUCCESS)
+    {
+        reporter.addFailure(result, "cudppPlan failed");
+        return false;
+    }
+    size_t after = deviceMemoryInUse();
+    result.planBytes = (after > before) ? after - before : 0;
+    return true;
+}
+
+/** @brief Times a case and reports it */
+static void reportBenchmark(BenchmarkCase &benchmark, benchmarkResult &result,
+                            const benchmarkOptions &options,
+                            BenchmarkReporter &reporter)
+{
+    timeBenchmark(benchmark, options, result.times);
+    if (benchmark.m_result != CUDPP_SUCCESS)
+        reporter.addFailure(result, "call failed");
+    else
+        reporter.add(result);
+}
+
+/** @returns the largest size in \a sizes, or 0 if there are none */
+static size_t maxSize(const std::vector<size_t> &sizes)
+{
+    return sizes.empty() ? 0 : sizes.back();
+}
+
+/** @returns a random index below \a n, from the C library generator */
+static unsigned int randomIndex(size_t n)
+{
+    unsigned int r = ((unsigned int)rand() << 15) ^ (unsigned int)rand();
+    return (unsigned int)(r % n);
+}
+
+/** @brief Copies \a bytes of a device array from a pristine copy before
+ *  each run of an in-place case */
+static void restore(void *d_data, const void *d_pristine, size_t bytes)
+{
+    if (bytes)
+        CUDA_SAFE_CALL(cudaMemcpy(d_data, d_pristine, bytes,
+                                  cudaMemcpyDeviceToDevice));
+}
+
+// ---------------------------------------------------------------------------
+// Scan, segmented scan, compact, reduce
+// ---------------------------------------------------------------------------
+
+static const CUDPPOperator allOperators[] =
+    { CUDPP_ADD, CUDPP_MULTIPLY, CUDPP_MIN, CUDPP_MAX };
+
+static const unsigned int scanOptions[] =
+{
+    CUDPP_OPTION_FORWARD  | CUDPP_OPTION_EXCLUSIVE,
+    CUDPP_OPTION_FORWARD  | CUDPP_OPTION_INCLUSIVE,
+    CUDPP_OPTION_BACKWARD | CUDPP_OPTION_EXCLUSIVE,
+    CUDPP_OPTION_BACKWARD | CUDPP_OPTION_INCLUSIVE,
+};
+
+class ScanCase : public BenchmarkCase
+{
+public:
+    ScanCase(CUDPPHandle plan, void *d_out, const void *d_in, size_t n)
+    : m_plan(plan), m_out(d_out), m_in(d_in), m_n(n) {}
+    void run() { check(cudppScan(m_plan, m_out, m_in, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_out; const void *m_in; size_t m_n;
+};
+
+/** Scan of every scan datatype, operator and direction */
+void benchmarkScan(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                   BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT, CUDPP_DOUBLE,
+          CUDPP_LONGLONG, CUDPP_ULONGLONG };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, (size_t)-1);
+    if (sizes.empty())
+        return;
+
+    void *d_in, *d_out;
+    CUDA_SAFE_CALL(cudaMalloc(&d_in, maxSize(sizes) * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, maxSize(sizes) * sizeof(double)));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        fillDeviceRandom(d_in, maxSize(sizes), datatypes[d]);
+
+        for (size_t o = 0; o < sizeof(allOperators) / sizeof(allOperators[0]); o++)
+        {
+            if (!runOperator(options, allOperators[o]))
+                continue;
+            for (size_t s = 0; s < sizeof(scanOptions) / sizeof(scanOptions[0]); s++)
+            {
+                for (size_t k = 0; k < sizes.size(); k++)
+                {
+                    CUDPPConfiguration config =
+                        { CUDPP_SCAN, allOperators[o], datatypes[d], scanOptions[s] };
+                    benchmarkResult result;
+                    initResult(result, "scan", "scan", config, sizes[k],
+                               2.0 * datatypeSize(datatypes[d]));
+
+                    CUDPPHandle plan;
+                    if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                                       result, reporter))
+                        continue;
+                    ScanCase benchmark(plan, d_out, d_in, sizes[k]);
+                    reportBenchmark(benchmark, result, options, reporter);
+                    cudppDestroyPlan(plan);
+                }
+            }
+        }
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_out);
+}
+
+class SegmentedScanCase : public BenchmarkCase
+{
+public:
+    SegmentedScanCase(CUDPPHandle plan, void *d_out, const void *d_in,
+                      const unsigned int *d_flags, size_t n)
+    : m_plan(plan), m_out(d_out), m_in(d_in), m_flags(d_flags), m_n(n) {}
+    void run() { check(cudppSegmentedScan(m_plan, m_out, m_in, m_flags, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_out; const void *m_in;
+    const unsigned int *m_flags; size_t m_n;
+};
+
+/** Segmented scan of every datatype, operator and direction, with
+ *  segments of 1024 elements on average */
+void benchmarkSegmentedScan(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                            BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT, CUDPP_DOUBLE,
+          CUDPP_LONGLONG, CUDPP_ULONGLONG };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, INT_MAX);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    srand(42);
+    std::vector<unsigned int> flags(n);
+    for (size_t i = 0; i < n; i++)
+        flags[i] = (randomIndex(1024) == 0) ? 1 : 0;
+
+    void *d_in, *d_out;
+    unsigned int *d_flags;
+    CUDA_SAFE_CALL(cudaMalloc(&d_in, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_flags, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_flags, &flags[0], n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        fillDeviceRandom(d_in, n, datatypes[d]);
+
+        for (size_t o = 0; o < sizeof(allOperators) / sizeof(allOperators[0]); o++)
+        {
+            if (!runOperator(options, allOperators[o]))
+                continue;
+            for (size_t s = 0; s < sizeof(scanOptions) / sizeof(scanOptions[0]); s++)
+            {
+                for (size_t k = 0; k < sizes.size(); k++)
+                {
+                    CUDPPConfiguration config =
+                        { CUDPP_SEGMENTED_SCAN, allOperators[o], datatypes[d],
+                          scanOptions[s] };
+                    benchmarkResult result;
+                    initResult(result, "segscan", "segmented_scan", config, sizes[k],
+                               2.0 * datatypeSize(datatypes[d]) + sizeof(unsigned int));
+
+                    CUDPPHandle plan;
+                    if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                                       result, reporter))
+                        continue;
+                    SegmentedScanCase benchmark(plan, d_out, d_in, d_flags, sizes[k]);
+                    reportBenchmark(benchmark, result, options, reporter);
+                    cudppDestroyPlan(plan);
+                }
+            }
+        }
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_out);
+    cudaFree(d_flags);
+}
+
+class CompactCase : public BenchmarkCase
+{
+public:
+    CompactCase(CUDPPHandle plan, void *d_out, size_t *d_numValid,
+                const void *d_in, const unsigned int *d_isValid, size_t n,
+                bool partition)
+    : m_plan(plan), m_out(d_out), m_numValid(d_numValid), m_in(d_in),
+      m_isValid(d_isValid), m_n(n), m_partition(partition) {}
+    void run()
+    {
+        if (m_partition)
+            check(cudppPartition(m_plan, m_out, m_numValid, m_in, m_isValid, m_n));
+        else
+            check(cudppCompact(m_plan, m_out, m_numValid, m_in, m_isValid, m_n));
+    }
+private:
+    CUDPPHandle m_plan; void *m_out; size_t *m_numValid; const void *m_in;
+    const unsigned int *m_isValid; size_t m_n; bool m_partition;
+};
+
+/** Compact and partition of every datatype in both directions, keeping
+ *  half the elements */
+void benchmarkCompact(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                      BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_CHAR, CUDPP_UCHAR, CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT,
+          CUDPP_DOUBLE, CUDPP_LONGLONG, CUDPP_ULONGLONG };
+    static const unsigned int compactOptions[] =
+        { CUDPP_OPTION_FORWARD, CUDPP_OPTION_BACKWARD };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, (size_t)-1);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    srand(42);
+    std::vector<unsigned int> isValid(n);
+    for (size_t i = 0; i < n; i++)
+        isValid[i] = rand() & 1;
+
+    void *d_in, *d_out;
+    unsigned int *d_isValid;
+    size_t *d_numValid;
+    CUDA_SAFE_CALL(cudaMalloc(&d_in, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_isValid, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_numValid, sizeof(size_t)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_isValid, &isValid[0], n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        fillDeviceRandom(d_in, n, datatypes[d]);
+
+        for (size_t s = 0; s < sizeof(compactOptions) / sizeof(compactOptions[0]); s++)
+        {
+            for (int partition = 0; partition < 2; partition++)
+            {
+                for (size_t k = 0; k < sizes.size(); k++)
+                {
+                    CUDPPConfiguration config =
+                        { CUDPP_COMPACT, CUDPP_OPERATOR_INVALID, datatypes[d],
+                          compactOptions[s] };
+                    benchmarkResult result;
+                    initResult(result, "compact", partition ? "partition" : "compact",
+                               config, sizes[k],
+                               (partition ? 2.0 : 1.5) * datatypeSize(datatypes[d]) + 
+                               sizeof(unsigned int));
+
+                    CUDPPHandle plan;
+                    if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                                       result, reporter))
+                        continue;
+                    CompactCase benchmark(plan, d_out, d_numValid, d_in, d_isValid,
+                                          sizes[k], partition != 0);
+                    reportBenchmark(benchmark, result, options, reporter);
+                    cudppDestroyPlan(plan);
+                }
+            }
+        }
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_out);
+    cudaFree(d_isValid);
+    cudaFree(d_numValid);
+}
+
+class ReduceCase : public BenchmarkCase
+{
+public:
+    ReduceCase(CUDPPHandle plan, void *d_out, const void *d_in, size_t n)
+    : m_plan(plan), m_out(d_out), m_in(d_in), m_n(n) {}
+    void run() { check(cudppReduce(m_plan, m_out, m_in, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_out; const void *m_in; size_t m_n;
+};
+
+/** Reduction of every datatype and operator */
+void benchmarkReduce(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                     BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_CHAR, CUDPP_UCHAR, CUDPP_SHORT, CUDPP_USHORT, CUDPP_INT,
+          CUDPP_UINT, CUDPP_FLOAT, CUDPP_DOUBLE, CUDPP_LONGLONG,
+          CUDPP_ULONGLONG };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, (size_t)-1);
+    if (sizes.empty())
+        return;
+
+    void *d_in, *d_out;
+    CUDA_SAFE_CALL(cudaMalloc(&d_in, maxSize(sizes) * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, sizeof(double)));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        fillDeviceRandom(d_in, maxSize(sizes), datatypes[d]);
+
+        for (size_t o = 0; o < sizeof(allOperators) / sizeof(allOperators[0]); o++)
+        {
+            if (!runOperator(options, allOperators[o]))
+                continue;
+            for (size_t k = 0; k < sizes.size(); k++)
+            {
+                CUDPPConfiguration config =
+                    { CUDPP_REDUCE, allOperators[o], datatypes[d], 0 };
+                benchmarkResult result;
+                initResult(result, "reduce", "reduce", config, sizes[k],
+                           (double)datatypeSize(datatypes[d]));
+
+                CUDPPHandle plan;
+                if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                                   result, reporter))
+                    continue;
+                ReduceCase benchmark(plan, d_out, d_in, sizes[k]);
+                reportBenchmark(benchmark, result, options, reporter);
+                cudppDestroyPlan(plan);
+            }
+        }
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_out);
+}
+
+// ---------------------------------------------------------------------------
+// Sorts
+// ---------------------------------------------------------------------------
+
+/** In-place sort; the keys and values are restored before each run */
+class SortCase : public BenchmarkCase
+{
+public:
+    SortCase(CUDPPHandle plan, bool isMerge, void *d_keys, void *d_values,
+             const void *d_keysIn, const void *d_valuesIn,
+             size_t keyBytes, size_t valueBytes, size_t n)
+    : m_plan(plan), m_isMerge(isMerge), m_keys(d_keys), m_values(d_values),
+      m_keysIn(d_keysIn), m_valuesIn(d_valuesIn), m_keyBytes(keyBytes),
+      m_valueBytes(valueBytes), m_n(n) {}
+    void prepare()
+    {
+        restore(m_keys, m_keysIn, m_n * m_keyBytes);
+        restore(m_values, m_valuesIn, m_n * m_valueBytes);
+    }
+    void run()
+    {
+        if (m_isMerge)
+            check(cudppMergeSort(m_plan, m_keys, m_values, m_n));
+        else
+            check(cudppRadixSort(m_plan, m_keys, m_valueBytes ? m_values : 0, m_n));
+    }
+private:
+    CUDPPHandle m_plan; bool m_isMerge; void *m_keys; void *m_values;
+    const void *m_keysIn; const void *m_valuesIn;
+    size_t m_keyBytes; size_t m_valueBytes; size_t m_n;
+};
+
+/** Shared by the radix and merge sort benchmarks */
+static void benchmarkSort(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                          BenchmarkReporter &reporter, CUDPPAlgorithm algorithm,
+                          const CUDPPDatatype *datatypes, size_t numDatatypes,
+                          const unsigned int *sortOptions, size_t numOptions,
+                          size_t maxElements)
+{
+    bool isMerge = (algorithm == CUDPP_SORT_MERGE);
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, maxElements);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    void *d_keys, *d_values, *d_keysIn, *d_valuesIn;
+    CUDA_SAFE_CALL(cudaMalloc(&d_keys, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_values, n * sizeof(unsigned long long)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_keysIn, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_valuesIn, n * sizeof(unsigned long long)));
+    fillDeviceRandom(d_valuesIn, n, CUDPP_ULONGLONG);
+
+    for (size_t d = 0; d < numDatatypes; d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        fillDeviceRandom(d_keysIn, n, datatypes[d]);
+
+        for (size_t s = 0; s < numOptions; s++)
+        {
+            size_t keyBytes = datatypeSize(datatypes[d]);
+            size_t valueBytes = 0;
+            if (sortOptions[s] & CUDPP_OPTION_KEY_VALUE_PAIRS)
+                valueBytes = (sortOptions[s] & CUDPP_OPTION_64BIT_VALUES) ?
+                    sizeof(unsigned long long) : sizeof(unsigned int);
+
+            for (size_t k = 0; k < sizes.size(); k++)
+            {
+                CUDPPConfiguration config =
+                    { algorithm, CUDPP_OPERATOR_INVALID, datatypes[d], sortOptions[s] };
+                benchmarkResult result;
+                initResult(result, isMerge ? "mergesort" : "radixsort",
+                           isMerge ? "merge_sort" : "radix_sort", config, sizes[k],
+                           2.0 * (keyBytes + valueBytes));
+
+                CUDPPHandle plan;
+                if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                                   result, reporter))
+                    continue;
+                SortCase benchmark(plan, isMerge, d_keys, d_values, d_keysIn,
+                                   d_valuesIn, keyBytes, valueBytes, sizes[k]);
+                reportBenchmark(benchmark, result, options, reporter);
+                cudppDestroyPlan(plan);
+            }
+        }
+    }
+
+    cudaFree(d_keys);
+    cudaFree(d_values);
+    cudaFree(d_keysIn);
+    cudaFree(d_valuesIn);
+}
+
+/** Radix sort of every key type, keys only and with 32- and 64-bit values */
+void benchmarkRadixSort(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                        BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_CHAR, CUDPP_UCHAR, CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT,
+          CUDPP_DOUBLE, CUDPP_LONGLONG, CUDPP_ULONGLONG };
+    static const unsigned int sortOptions[] =
+        { CUDPP_OPTION_KEYS_ONLY,
+          CUDPP_OPTION_KEY_VALUE_PAIRS,
+          CUDPP_OPTION_KEY_VALUE_PAIRS | CUDPP_OPTION_64BIT_VALUES };
+
+    benchmarkSort(theCudpp, options, reporter, CUDPP_SORT_RADIX,
+                  datatypes, sizeof(datatypes) / sizeof(datatypes[0]),
+                  sortOptions, sizeof(sortOptions) / sizeof(sortOptions[0]),
+                  (size_t)-1);
+}
+
+/** Merge sort of every key type, with 32-bit values */
+void benchmarkMergeSort(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                        BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT };
+    static const unsigned int sortOptions[] = { CUDPP_OPTION_KEY_VALUE_PAIRS };
+
+    benchmarkSort(theCudpp, options, reporter, CUDPP_SORT_MERGE,
+                  datatypes, sizeof(datatypes) / sizeof(datatypes[0]),
+                  sortOptions, sizeof(sortOptions) / sizeof(sortOptions[0]),
+                  INT_MAX);
+}
+
+class StringSortCase : public BenchmarkCase
+{
+public:
+    StringSortCase(CUDPPHandle plan, unsigned int *d_keys, unsigned int *d_values,
+                   const unsigned int *d_keysIn, const unsigned int *d_valuesIn,
+                   unsigned int *d_strings, size_t n, size_t stringWords)
+    : m_plan(plan), m_keys(d_keys), m_values(d_values), m_keysIn(d_keysIn),
+      m_valuesIn(d_valuesIn), m_strings(d_strings), m_n(n),
+      m_stringWords(stringWords) {}
+    void prepare()
+    {
+        restore(m_keys, m_keysIn, m_n * sizeof(unsigned int));
+        restore(m_values, m_valuesIn, m_n * sizeof(unsigned int));
+    }
+    void run()
+    {
+        check(cudppStringSort(m_plan, m_keys, m_values, m_strings, m_n,
+                              m_stringWords));
+    }
+private:
+    CUDPPHandle m_plan; unsigned int *m_keys; unsigned int *m_values;
+    const unsigned int *m_keysIn; const unsigned int *m_valuesIn;
+    unsigned int *m_strings; size_t m_n; size_t m_stringWords;
+};
+
+/** String sort of random strings of 5 to 17 characters */
+void benchmarkStringSort(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                         BenchmarkReporter &reporter)
+{
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, 1 << 22);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    // strings are packed four characters to a word, and end with a zero
+    // character; the key is the first word and the value the address
+    srand(42);
+    std::vector<unsigned int> keys(n), addresses(n), strings;
+    for (size_t i = 0; i < n; i++)
+    {
+        unsigned int words = 2 + randomIndex(4);
+        addresses[i] = (unsigned int)strings.size();
+        for (unsigned int w = 0; w < words; w++)
+        {
+            unsigned int word = 0;
+            for (int c = 0; c < 4; c++)
+                word = (word << 8) | (1 + randomIndex(255));
+            if (w == words - 1)
+                word &= 0xFFFFFF00;
+            strings.push_back(word);
+        }
+        keys[i] = strings[addresses[i]];
+    }
+
+    unsigned int *d_keys, *d_values, *d_keysIn, *d_valuesIn, *d_strings;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keys, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_values, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keysIn, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_valuesIn, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_strings, strings.size() * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_keysIn, &keys[0], n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(d_valuesIn, &addresses[0], n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(d_strings, &strings[0],
+                              strings.size() * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+
+    if (runDatatype(options, CUDPP_UINT))
+    {
+        for (size_t k = 0; k < sizes.size(); k++)
+        {
+            CUDPPConfiguration config =
+                { CUDPP_SORT_STRING, CUDPP_OPERATOR_INVALID, CUDPP_UINT,
+                  CUDPP_OPTION_FORWARD };
+            benchmarkResult result;
+            initResult(result, "stringsort", "string_sort", config, sizes[k],
+                       4.0 * sizeof(unsigned int));
+
+            CUDPPHandle plan;
+            if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                               result, reporter))
+                continue;
+            StringSortCase benchmark(plan, d_keys, d_values, d_keysIn, d_valuesIn,
+                                     d_strings, sizes[k], strings.size());
+            reportBenchmark(benchmark, result, options, reporter);
+            cudppDestroyPlan(plan);
+        }
+    }
+
+    cudaFree(d_keys);
+    cudaFree(d_values);
+    cudaFree(d_keysIn);
+    cudaFree(d_valuesIn);
+    cudaFree(d_strings);
+}
+
+// ---------------------------------------------------------------------------
+// Sparse matrices
+// ---------------------------------------------------------------------------
+
+class SpmvCase : public BenchmarkCase
+{
+public:
+    SpmvCase(CUDPPHandle matrix, void *d_y, const void *d_x)
+    : m_matrix(matrix), m_y(d_y), m_x(d_x) {}
+    void run() { check(cudppSparseMatrixVectorMultiply(m_matrix, m_y, m_x)); }
+private:
+    CUDPPHandle m_matrix; void *m_y; const void *m_x;
+};
+
+/** Builds a random square CSR matrix with \a rowLength nonzeros per row,
+ *  each row's columns sorted */
+template <typename T>
+static void randomCsrMatrix(std::vector<T> &values, std::vector<unsigned int> &rowOffsets,
+                            std::vector<unsigned int> &colIndices, size_t numRows,
+                            unsigned int rowLength)
+{
+    values.resize(numRows * rowLength);
+    colIndices.resize(numRows * rowLength);
+    rowOffsets.resize(numRows + 1);
+    for (size_t r = 0; r <= numRows; r++)
+        rowOffsets[r] = (unsigned int)(r * rowLength);
+    for (size_t r = 0; r < numRows; r++)
+    {
+        for (unsigned int j = 0; j < rowLength; j++)
+        {
+            colIndices[r * rowLength + j] = randomIndex(numRows);
+            values[r * rowLength + j] = (T)(1 + randomIndex(100)) / 100;
+        }
+        std::sort(colIndices.begin() + r * rowLength,
+                  colIndices.begin() + (r + 1) * rowLength);
+    }
+}
+
+template <typename T>
+static void benchmarkSpmvType(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                              BenchmarkReporter &reporter, CUDPPDatatype datatype,
+                              const unsigned int *formats, size_t numFormats,
+                              const std::vector<size_t> &sizes)
+{
+    const unsigned int rowLength = 16;
+    size_t maxRows = maxSize(sizes) / rowLength;
+
+    T *d_x, *d_y;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_x, maxRows * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_y, maxRows * sizeof(T)));
+    fillDeviceRandom(d_x, maxRows, datatype);
+
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        size_t numRows = sizes[k] / rowLength;
+        std::vector<T> values;
+        std::vector<unsigned int> rowOffsets, colIndices;
+        srand(42);
+        randomCsrMatrix(values, rowOffsets, colIndices, numRows, rowLength);
+
+        for (size_t f = 0; f < numFormats; f++)
+        {
+            CUDPPConfiguration config =
+                { CUDPP_SPMVMULT, CUDPP_OPERATOR_INVALID, datatype, formats[f] };
+            benchmarkResult result;
+            initResult(result, "spmv", "multiply", config, values.size(),
+                       2.0 * sizeof(T) + sizeof(unsigned int));
+
+            // the matrix handle takes the place of a plan
+            CUDPPHandle matrix;
+            size_t before = deviceMemoryInUse();
+            if (cudppSparseMatrix(theCudpp, &matrix, config, values.size(), numRows,
+                                  &values[0], &rowOffsets[0], &colIndices[0])
+                != CUDPP_SUCCESS)
+            {
+                reporter.addFailure(result, "cudppSparseMatrix failed");
+                continue;
+            }
+            size_t after = deviceMemoryInUse();
+            result.planBytes = (after > before) ? after - before : 0;
+
+            SpmvCase benchmark(matrix, d_y, d_x);
+            reportBenchmark(benchmark, result, options, reporter);
+            cudppDestroySparseMatrix(matrix);
+        }
+    }
+
+    cudaFree(d_x);
+    cudaFree(d_y);
+}
+
+/** Sparse matrix-vector multiply of random matrices with 16 nonzeros per
+ *  row, in every value and index format.  The size is the number of
+ *  nonzeros. */
+void benchmarkSpmv(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                   BenchmarkReporter &reporter)
+{
+    static const unsigned int formats[] =
+        { 0,
+          CUDPP_OPTION_SPMV_HALF_VALUES,
+          CUDPP_OPTION_SPMV_BFLOAT16_VALUES,
+          CUDPP_OPTION_SPMV_16BIT_INDICES,
+          CUDPP_OPTION_SPMV_HALF_VALUES | CUDPP_OPTION_SPMV_16BIT_INDICES };
+    static const unsigned int doubleFormats[] =
+        { 0, CUDPP_OPTION_SPMV_HALF_VALUES };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 16, UINT_MAX);
+    if (sizes.empty())
+        return;
+
+    if (runDatatype(options, CUDPP_FLOAT))
+        benchmarkSpmvType<float>(theCudpp, options, reporter, CUDPP_FLOAT, formats,
+                                 sizeof(formats) / sizeof(formats[0]), sizes);
+    if (runDatatype(options, CUDPP_DOUBLE))
+        benchmarkSpmvType<double>(theCudpp, options, reporter, CUDPP_DOUBLE,
+                                  doubleFormats,
+                                  sizeof(doubleFormats) / sizeof(doubleFormats[0]),
+                                  sizes);
+}
+
+class CooToCsrCase : public BenchmarkCase
+{
+public:
+    CooToCsrCase(CUDPPHandle plan, unsigned int *d_offsets, unsigned int *d_cols,
+                 void *d_values, const unsigned int *d_cooRows,
+                 const unsigned int *d_cooCols, const void *d_cooValues,
+                 size_t nnz, size_t numRows)
+    : m_plan(plan), m_offsets(d_offsets), m_cols(d_cols), m_values(d_values),
+      m_cooRows(d_cooRows), m_cooCols(d_cooCols), m_cooValues(d_cooValues),
+      m_nnz(nnz), m_numRows(numRows) {}
+    void run()
+    {
+        check(cudppSparseCooToCsr(m_plan, m_offsets, m_cols, m_values, m_cooRows,
+                                  m_cooCols, m_cooValues, m_nnz, m_numRows));
+    }
+private:
+    CUDPPHandle m_plan; unsigned int *m_offsets; unsigned int *m_cols;
+    void *m_values; const unsigned int *m_cooRows; const unsigned int *m_cooCols;
+    const void *m_cooValues; size_t m_nnz; size_t m_numRows;
+};
+
+class TransposeCase : public BenchmarkCase
+{
+public:
+    TransposeCase(CUDPPHandle plan, unsigned int *d_tOffsets, unsigned int *d_tCols,
+                  void *d_tValues, const unsigned int *d_offsets,
+                  const unsigned int *d_cols, const void *d_values,
+                  size_t numRows, size_t nnz)
+    : m_plan(plan), m_tOffsets(d_tOffsets), m_tCols(d_tCols), m_tValues(d_tValues),
+      m_offsets(d_offsets), m_cols(d_cols), m_values(d_values),
+      m_numRows(numRows), m_nnz(nnz) {}
+    void run()
+    {
+        check(cudppSparseTranspose(m_plan, m_tOffsets, m_tCols, m_tValues,
+                                   m_offsets, m_cols, m_values, m_numRows,
+                                   m_numRows, m_nnz));
+    }
+private:
+    CUDPPHandle m_plan; unsigned int *m_tOffsets; unsigned int *m_tCols;
+    void *m_tValues; const unsigned int *m_offsets; const unsigned int *m_cols;
+    const void *m_values; size_t m_numRows; size_t m_nnz;
+};
+
+/** COO to CSR conversion of unordered random nonzeros, and transpose of
+ *  the result, for square matrices with 16 nonzeros per row on average.
+ *  The size is the number of nonzeros. */
+void benchmarkSparseConvert(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                            BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT, CUDPP_DOUBLE,
+          CUDPP_LONGLONG, CUDPP_ULONGLONG };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 16, UINT_MAX);
+    if (sizes.empty())
+        return;
+    size_t nnz = maxSize(sizes);
+    size_t maxRows = nnz / 16;
+
+    unsigned int *d_cooRows, *d_cooCols, *d_offsets, *d_cols, *d_tOffsets, *d_tCols;
+    void *d_cooValues, *d_values, *d_tValues;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_cooRows, nnz * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_cooCols, nnz * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_cols, nnz * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_tCols, nnz * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_offsets, (maxRows + 1) * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_tOffsets, (maxRows + 1) * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_cooValues, nnz * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_values, nnz * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_tValues, nnz * sizeof(double)));
+
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        size_t numRows = sizes[k] / 16;
+        srand(42);
+        std::vector<unsigned int> rows(sizes[k]), cols(sizes[k]);
+        for (size_t i = 0; i < sizes[k]; i++)
+        {
+            rows[i] = randomIndex(numRows);
+            cols[i] = randomIndex(numRows);
+        }
+        CUDA_SAFE_CALL(cudaMemcpy(d_cooRows, &rows[0], sizes[k] * sizeof(unsigned int),
+                                  cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL(cudaMemcpy(d_cooCols, &cols[0], sizes[k] * sizeof(unsigned int),
+                                  cudaMemcpyHostToDevice));
+
+        for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+        {
+            if (!runDatatype(options, datatypes[d]))
+                continue;
+            fillDeviceRandom(d_cooValues, sizes[k], datatypes[d]);
+            size_t valueBytes = datatypeSize(datatypes[d]);
+
+            CUDPPConfiguration config =
+                { CUDPP_SPARSE_CONVERT, CUDPP_OPERATOR_INVALID, datatypes[d], 0 };
+            benchmarkResult result;
+            initResult(result, "sparseconvert", "coo_to_csr", config, sizes[k],
+                       3.0 * sizeof(unsigned int) + 2.0 * valueBytes);
+
+            CUDPPHandle plan;
+            if (!planBenchmark(theCudpp, plan, config, sizes[k], numRows, 0,
+                               result, reporter))
+                continue;
+
+            CooToCsrCase cooToCsr(plan, d_offsets, d_cols, d_values, d_cooRows,
+                                  d_cooCols, d_cooValues, sizes[k], numRows);
+            reportBenchmark(cooToCsr, result, options, reporter);
+
+            // the CSR matrix just built is the input of the transpose
+            initResult(result, "sparseconvert", "transpose", config, sizes[k],
+                       4.0 * sizeof(unsigned int) + 2.0 * valueBytes);
+            if (cooToCsr.m_result == CUDPP_SUCCESS)
+            {
+                TransposeCase transpose(plan, d_tOffsets, d_tCols, d_tValues,
+                                        d_offsets, d_cols, d_values, numRows,
+                                        sizes[k]);
+                reportBenchmark(transpose, result, options, reporter);
+            }
+            else
+                reporter.addFailure(result, "no input");
+            cudppDestroyPlan(plan);
+        }
+    }
+
+    cudaFree(d_cooRows);
+    cudaFree(d_cooCols);
+    cudaFree(d_cols);
+    cudaFree(d_tCols);
+    cudaFree(d_offsets);
+    cudaFree(d_tOffsets);
+    cudaFree(d_cooValues);
+    cudaFree(d_values);
+    cudaFree(d_tValues);
+}
+
+// ---------------------------------------------------------------------------
+// Random numbers
+// ---------------------------------------------------------------------------
+
+class RandCase : public BenchmarkCase
+{
+public:
+    RandCase(CUDPPHandle plan, void *d_out, size_t n)
+    : m_plan(plan), m_out(d_out), m_n(n) {}
+    void run() { check(cudppRand(m_plan, m_out, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_out; size_t m_n;
+};
+
+/** Shared by the MD5 and Philox benchmarks */
+static void benchmarkRand(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                          BenchmarkReporter &reporter, const char *name,
+                          const CUDPPConfiguration *configs,
+                          size_t numConfigs)
+{
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, (size_t)-1);
+    if (sizes.empty())
+        return;
+
+    void *d_out;
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, maxSize(sizes) * sizeof(double)));
+
+    for (size_t c = 0; c < numConfigs; c++)
+    {
+        if (!runDatatype(options, configs[c].datatype))
+            continue;
+        for (size_t k = 0; k < sizes.size(); k++)
+        {
+            benchmarkResult result;
+            initResult(result, name, "rand", configs[c], sizes[k],
+                       (double)datatypeSize(configs[c].datatype));
+
+            CUDPPHandle plan;
+            if (!planBenchmark(theCudpp, plan, configs[c], sizes[k], 1, 0,
+                               result, reporter))
+                continue;
+            cudppRandSeed(plan, 42);
+            RandCase benchmark(plan, d_out, sizes[k]);
+            reportBenchmark(benchmark, result, options, reporter);
+            cudppDestroyPlan(plan);
+        }
+    }
+
+    cudaFree(d_out);
+}
+
+/** MD5 random number generation */
+void benchmarkRandMd5(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                      BenchmarkReporter &reporter)
+{
+    static const CUDPPConfiguration configs[] =
+    {
+        { CUDPP_RAND_MD5, CUDPP_OPERATOR_INVALID, CUDPP_UINT, 0 },
+    };
+    benchmarkRand(theCudpp, options, reporter, "rand", configs,
+                  sizeof(configs) / sizeof(configs[0]));
+}
+
+/** Philox random bits and every floating point distribution */
+void benchmarkRandPhilox(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                         BenchmarkReporter &reporter)
+{
+    static const CUDPPConfiguration configs[] =
+    {
+        { CUDPP_RAND_PHILOX, CUDPP_OPERATOR_INVALID, CUDPP_UINT,   0 },
+        { CUDPP_RAND_PHILOX, CUDPP_OPERATOR_INVALID, CUDPP_FLOAT,  0 },
+        { CUDPP_RAND_PHILOX, CUDPP_OPERATOR_INVALID, CUDPP_FLOAT,  CUDPP_OPTION_RAND_NORMAL },
+        { CUDPP_RAND_PHILOX, CUDPP_OPERATOR_INVALID, CUDPP_FLOAT,  CUDPP_OPTION_RAND_EXPONENTIAL },
+        { CUDPP_RAND_PHILOX, CUDPP_OPERATOR_INVALID, CUDPP_DOUBLE, 0 },
+        { CUDPP_RAND_PHILOX, CUDPP_OPERATOR_INVALID, CUDPP_DOUBLE, CUDPP_OPTION_RAND_NORMAL },
+        { CUDPP_RAND_PHILOX, CUDPP_OPERATOR_INVALID, CUDPP_DOUBLE, CUDPP_OPTION_RAND_EXPONENTIAL },
+    };
+    benchmarkRand(theCudpp, options, reporter, "philox", configs,
+                  sizeof(configs) / sizeof(configs[0]));
+}
+
+// ---------------------------------------------------------------------------
+// Tridiagonal
+// ---------------------------------------------------------------------------
+
+class TridiagonalCase : public BenchmarkCase
+{
+public:
+    TridiagonalCase(CUDPPHandle plan, void *a, void *b, void *c, void *d, void *x,
+                    int systemSize, int numSystems)
+    : m_plan(plan), m_a(a), m_b(b), m_c(c), m_d(d), m_x(x),
+      m_systemSize(systemSize), m_numSystems(numSystems) {}
+    void run()
+    {
+        check(cudppTridiagonal(m_plan, m_a, m_b, m_c, m_d, m_x,
+                               m_systemSize, m_numSystems));
+    }
+private:
+    CUDPPHandle m_plan; void *m_a; void *m_b; void *m_c; void *m_d; void *m_x;
+    int m_systemSize; int m_numSystems;
+};
+
+template <typename T>
+static void uploadConstant(void *d_data, size_t n, T value)
+{
+    std::vector<T> h_data(n, value);
+    CUDA_SAFE_CALL(cudaMemcpy(d_data, &h_data[0], n * sizeof(T),
+                              cudaMemcpyHostToDevice));
+}
+
+/** Diagonally dominant systems of 512 equations, periodic and not.  The
+ *  size is the total number of equations. */
+void benchmarkTridiagonal(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                          BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] = { CUDPP_FLOAT, CUDPP_DOUBLE };
+    static const unsigned int tridiagonalOptions[] = { 0, CUDPP_OPTION_PERIODIC };
+    const int systemSize = 512;
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, systemSize, (size_t)INT_MAX * systemSize);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    void *d_a, *d_b, *d_c, *d_d, *d_x;
+    CUDA_SAFE_CALL(cudaMalloc(&d_a, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_b, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_c, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_d, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_x, n * sizeof(double)));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        if (datatypes[d] == CUDPP_FLOAT)
+        {
+            uploadConstant<float>(d_a, n, 1.0f);
+            uploadConstant<float>(d_b, n, 4.0f);
+            uploadConstant<float>(d_c, n, 1.0f);
+        }
+        else
+        {
+            uploadConstant<double>(d_a, n, 1.0);
+            uploadConstant<double>(d_b, n, 4.0);
+            uploadConstant<double>(d_c, n, 1.0);
+        }
+        fillDeviceRandom(d_d, n, datatypes[d]);
+
+        for (size_t s = 0; s < sizeof(tridiagonalOptions) / sizeof(tridiagonalOptions[0]); s++)
+        {
+            CUDPPConfiguration config =
+                { CUDPP_TRIDIAGONAL, CUDPP_OPERATOR_INVALID, datatypes[d],
+                  tridiagonalOptions[s] };
+
+            for (size_t k = 0; k < sizes.size(); k++)
+            {
+                int numSystems = (int)(sizes[k] / systemSize);
+                benchmarkResult result;
+                initResult(result, "tridiagonal", "solve", config,
+                           (size_t)numSystems * systemSize,
+                           5.0 * datatypeSize(datatypes[d]));
+
+                CUDPPHandle plan;
+                if (!planBenchmark(theCudpp, plan, config, 0, 0, 0, result, reporter))
+                    continue;
+                TridiagonalCase benchmark(plan, d_a, d_b, d_c, d_d, d_x,
+                                          systemSize, numSystems);
+                reportBenchmark(benchmark, result, options, reporter);
+                cudppDestroyPlan(plan);
+            }
+        }
+    }
+
+    cudaFree(d_a);
+    cudaFree(d_b);
+    cudaFree(d_c);
+    cudaFree(d_d);
+    cudaFree(d_x);
+}
+
+// ---------------------------------------------------------------------------
+// List ranking and trees
+// ---------------------------------------------------------------------------
+
+class ListRankCase : public BenchmarkCase
+{
+public:
+    ListRankCase(CUDPPHandle plan, void *d_out, void *d_values, int *d_next,
+                 size_t head, size_t n)
+    : m_plan(plan), m_out(d_out), m_values(d_values), m_next(d_next),
+      m_head(head), m_n(n) {}
+    void run()
+    {
+        check(cudppListRank(m_plan, m_out, m_values, m_next, m_head, m_n));
+    }
+private:
+    CUDPPHandle m_plan; void *m_out; void *m_values; int *m_next;
+    size_t m_head; size_t m_n;
+};
+
+/** Ranking of randomly ordered lists of every value type */
+void benchmarkListRank(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                       BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] =
+        { CUDPP_CHAR, CUDPP_UCHAR, CUDPP_SHORT, CUDPP_USHORT, CUDPP_INT,
+          CUDPP_UINT, CUDPP_FLOAT, CUDPP_DOUBLE, CUDPP_LONGLONG,
+          CUDPP_ULONGLONG };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, INT_MAX);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    void *d_values, *d_out;
+    int *d_next;
+    CUDA_SAFE_CALL(cudaMalloc(&d_values, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_next, n * sizeof(int)));
+
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        // visit the nodes in a random order
+        srand(42);
+        std::vector<int> order(sizes[k]), next(sizes[k]);
+        for (size_t i = 0; i < sizes[k]; i++)
+            order[i] = (int)i;
+        for (size_t i = sizes[k] - 1; i > 0; i--)
+            std::swap(order[i], order[randomIndex(i + 1)]);
+        for (size_t i = 0; i + 1 < sizes[k]; i++)
+            next[order[i]] = order[i + 1];
+        next[order[sizes[k] - 1]] = -1;
+        CUDA_SAFE_CALL(cudaMemcpy(d_next, &next[0], sizes[k] * sizeof(int),
+                                  cudaMemcpyHostToDevice));
+
+        for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+        {
+            if (!runDatatype(options, datatypes[d]))
+                continue;
+            fillDeviceRandom(d_values, sizes[k], datatypes[d]);
+
+            CUDPPConfiguration config =
+                { CUDPP_LISTRANK, CUDPP_OPERATOR_INVALID, datatypes[d], 0 };
+            benchmarkResult result;
+            initResult(result, "listrank", "rank", config, sizes[k],
+                       2.0 * datatypeSize(datatypes[d]) + sizeof(int));
+
+            CUDPPHandle plan;
+            if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                               result, reporter))
+                continue;
+            ListRankCase benchmark(plan, d_out, d_values, d_next, order[0], sizes[k]);
+            reportBenchmark(benchmark, result, options, reporter);
+            cudppDestroyPlan(plan);
+        }
+    }
+
+    cudaFree(d_values);
+    cudaFree(d_out);
+    cudaFree(d_next);
+}
+
+class EulerTourCase : public BenchmarkCase
+{
+public:
+    EulerTourCase(CUDPPHandle plan, int *d_depth, unsigned int *d_preorder,
+                  unsigned int *d_subtreeSize, unsigned int *d_tour,
+                  const int *d_parent, size_t n)
+    : m_plan(plan), m_depth(d_depth), m_preorder(d_preorder),
+      m_subtreeSize(d_subtreeSize), m_tour(d_tour), m_parent(d_parent), m_n(n) {}
+    void run()
+    {
+        check(cudppEulerTour(m_plan, m_depth, m_preorder, m_subtreeSize, m_tour,
+                             m_parent, m_n));
+    }
+private:
+    CUDPPHandle m_plan; int *m_depth; unsigned int *m_preorder;
+    unsigned int *m_subtreeSize; unsigned int *m_tour; const int *m_parent;
+    size_t m_n;
+};
+
+/** Euler tour of random recursive trees (each node's parent is a random
+ *  earlier node), computing every output */
+void benchmarkEulerTour(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                        BenchmarkReporter &reporter)
+{
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, INT_MAX / 2);
+    if (sizes.empty() || !runDatatype(options, CUDPP_INT))
+        return;
+    size_t n = maxSize(sizes);
+
+    int *d_parent, *d_depth;
+    unsigned int *d_preorder, *d_subtreeSize, *d_tour;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_parent, n * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_depth, n * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_preorder, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_subtreeSize, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_tour, 2 * n * sizeof(unsigned int)));
+
+    srand(42);
+    std::vector<int> parent(n);
+    parent[0] = -1;
+    for (size_t i = 1; i < n; i++)
+        parent[i] = (int)randomIndex(i);
+    CUDA_SAFE_CALL(cudaMemcpy(d_parent, &parent[0], n * sizeof(int),
+                              cudaMemcpyHostToDevice));
+
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        // a prefix of a random recursive tree is also one
+        CUDPPConfiguration config =
+            { CUDPP_EULER_TOUR, CUDPP_OPERATOR_INVALID, CUDPP_INT, 0 };
+        benchmarkResult result;
+        initResult(result, "eulertour", "tour", config, sizes[k],
+                   6.0 * sizeof(int));
+
+        CUDPPHandle plan;
+        if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0, result, reporter))
+            continue;
+        EulerTourCase benchmark(plan, d_depth, d_preorder, d_subtreeSize, d_tour,
+                                d_parent, sizes[k]);
+        reportBenchmark(benchmark, result, options, reporter);
+        cudppDestroyPlan(plan);
+    }
+
+    cudaFree(d_parent);
+    cudaFree(d_depth);
+    cudaFree(d_preorder);
+    cudaFree(d_subtreeSize);
+    cudaFree(d_tour);
+}
+
+// ---------------------------------------------------------------------------
+// Compression
+// ---------------------------------------------------------------------------
+
+/** @brief Uploads \a n random symbols below \a alphabetSize, skewed toward
+ *  small values so that they compress */
+template <typename T>
+static void uploadSymbols(T *d_data, size_t n, unsigned int alphabetSize)
+{
+    std::vector<T> symbols(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        unsigned int r = randomIndex(alphabetSize);
+        symbols[i] = (T)((r * (unsigned long long)r) / alphabetSize);
+    }
+    CUDA_SAFE_CALL(cudaMemcpy(d_data, &symbols[0], n * sizeof(T),
+                              cudaMemcpyHostToDevice));
+}
+
+class BwtCase : public BenchmarkCase
+{
+public:
+    BwtCase(CUDPPHandle plan, void *d_in, void *d_out, void *d_index, size_t n)
+    : m_plan(plan), m_in(d_in), m_out(d_out), m_index(d_index), m_n(n) {}
+    void run() { check(cudppBurrowsWheelerTransform(m_plan, m_in, m_out, m_index, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_in; void *m_out; void *m_index; size_t m_n;
+};
+
+/** Burrows-Wheeler transform of skewed random bytes */
+void benchmarkBwt(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                  BenchmarkReporter &reporter)
+{
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, 1 << 26);
+    if (sizes.empty() || !runDatatype(options, CUDPP_UCHAR))
+        return;
+    size_t n = maxSize(sizes);
+
+    unsigned char *d_in, *d_out;
+    int *d_index;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_in, n));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_out, n));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_index, sizeof(int)));
+    srand(42);
+    uploadSymbols(d_in, n, 256);
+
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        CUDPPConfiguration config =
+            { CUDPP_BWT, CUDPP_OPERATOR_INVALID, CUDPP_UCHAR, 0 };
+        benchmarkResult result;
+        initResult(result, "bwt", "forward", config, sizes[k], 2.0);
+
+        CUDPPHandle plan;
+        if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0, result, reporter))
+            continue;
+        BwtCase benchmark(plan, d_in, d_out, d_index, sizes[k]);
+        reportBenchmark(benchmark, result, options, reporter);
+        cudppDestroyPlan(plan);
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_out);
+    cudaFree(d_index);
+}
+
+class MtfCase : public BenchmarkCase
+{
+public:
+    MtfCase(CUDPPHandle plan, bool inverse, void *d_in, void *d_out, size_t n)
+    : m_plan(plan), m_inverse(inverse), m_in(d_in), m_out(d_out), m_n(n) {}
+    void run()
+    {
+        if (m_inverse)
+            check(cudppInverseMoveToFrontTransform(m_plan, m_in, m_out, m_n));
+        else
+            check(cudppMoveToFrontTransform(m_plan, m_in, m_out, m_n));
+    }
+private:
+    CUDPPHandle m_plan; bool m_inverse; void *m_in; void *m_out; size_t m_n;
+};
+
+/** Move-to-front transform of skewed random bytes, and its inverse */
+void benchmarkMtf(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                  BenchmarkReporter &reporter)
+{
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, UINT_MAX);
+    if (sizes.empty() || !runDatatype(options, CUDPP_UCHAR))
+        return;
+    size_t n = maxSize(sizes);
+
+    unsigned char *d_in, *d_mtf, *d_out;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_in, n));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_mtf, n));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_out, n));
+    srand(42);
+    uploadSymbols(d_in, n, 256);
+
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        CUDPPConfiguration config =
+            { CUDPP_MTF, CUDPP_OPERATOR_INVALID, CUDPP_UCHAR, 0 };
+        benchmarkResult result;
+        initResult(result, "mtf", "forward", config, sizes[k], 2.0);
+
+        CUDPPHandle plan;
+        if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0, result, reporter))
+            continue;
+        MtfCase forward(plan, false, d_in, d_mtf, sizes[k]);
+        reportBenchmark(forward, result, options, reporter);
+
+        initResult(result, "mtf", "inverse", config, sizes[k], 2.0);
+        MtfCase inverse(plan, true, d_mtf, d_out, sizes[k]);
+        reportBenchmark(inverse, result, options, reporter);
+        cudppDestroyPlan(plan);
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_mtf);
+    cudaFree(d_out);
+}
+
+class CompressCase : public BenchmarkCase
+{
+public:
+    CompressCase(CUDPPHandle plan, void *d_in, void *d_bwtIndex, void *d_codeLengths,
+                 void *d_offsets, void *d_size, void *d_compressed, size_t n)
+    : m_plan(plan), m_in(d_in), m_bwtIndex(d_bwtIndex), m_codeLengths(d_codeLengths),
+      m_offsets(d_offsets), m_size(d_size), m_compressed(d_compressed), m_n(n) {}
+    void run()
+    {
+        check(cudppCompress(m_plan, m_in, m_bwtIndex, 0, m_codeLengths, m_offsets,
+                            m_size, m_compressed, m_n));
+    }
+private:
+    CUDPPHandle m_plan; void *m_in; void *m_bwtIndex; void *m_codeLengths;
+    void *m_offsets; void *m_size; void *m_compressed; size_t m_n;
+};
+
+/** The full BWT, MTF and Huffman compression pipeline on skewed random
+ *  bytes */
+void benchmarkCompress(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                       BenchmarkReporter &reporter)
+{
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, 1 << 26);
+    if (sizes.empty() || !runDatatype(options, CUDPP_UCHAR))
+        return;
+    size_t n = maxSize(sizes);
+    size_t numSubBlocks =
+        (n + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+
+    unsigned char *d_in, *d_codeLengths;
+    int *d_bwtIndex;
+    unsigned int *d_offsets, *d_size, *d_compressed;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_in, n));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_bwtIndex, sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_codeLengths, 256));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_offsets, (numSubBlocks + 1) * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_size, sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_compressed,
+                              CUDPP_HUFFMAN_MAX_WORDS(n) * sizeof(unsigned int)));
+    srand(42);
+    uploadSymbols(d_in, n, 256);
+
+    for (size_t k = 0; k < sizes.size(); k++)
+    {
+        CUDPPConfiguration config =
+            { CUDPP_COMPRESS, CUDPP_OPERATOR_INVALID, CUDPP_UCHAR, 0 };
+        benchmarkResult result;
+        initResult(result, "compress", "compress", config, sizes[k], 2.0);
+
+        CUDPPHandle plan;
+        if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0, result, reporter))
+            continue;
+        CompressCase benchmark(plan, d_in, d_bwtIndex, d_codeLengths, d_offsets,
+                               d_size, d_compressed, sizes[k]);
+        reportBenchmark(benchmark, result, options, reporter);
+        cudppDestroyPlan(plan);
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_bwtIndex);
+    cudaFree(d_codeLengths);
+    cudaFree(d_offsets);
+    cudaFree(d_size);
+    cudaFree(d_compressed);
+}
+
+class HuffmanCase : public BenchmarkCase
+{
+public:
+    HuffmanCase(CUDPPHandle plan, bool decode, void *d_symbols,
+                unsigned int *d_compressed, unsigned char *d_codeLengths,
+                unsigned int *d_offsets, size_t n)
+    : m_plan(plan), m_decode(decode), m_symbols(d_symbols),
+      m_compressed(d_compressed), m_codeLengths(d_codeLengths),
+      m_offsets(d_offsets), m_n(n) {}
+    void run()
+    {
+        if (m_decode)
+            check(cudppHuffmanDecode(m_plan, m_symbols, m_compressed,
+                                     m_codeLengths, m_offsets, m_n));
+        else
+            check(cudppHuffmanEncode(m_plan, m_compressed, m_codeLengths,
+                                     m_offsets, m_symbols, m_n));
+    }
+private:
+    CUDPPHandle m_plan; bool m_decode; void *m_symbols; unsigned int *m_compressed;
+    unsigned char *m_codeLengths; unsigned int *m_offsets; size_t m_n;
+};
+
+/** Huffman encoding and decoding of skewed random byte and 16-bit
+ *  symbols */
+void benchmarkHuffman(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                      BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] = { CUDPP_UCHAR, CUDPP_USHORT };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, INT_MAX);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+    size_t numSubBlocks =
+        (n + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+
+    void *d_in, *d_out;
+    unsigned char *d_codeLengths;
+    unsigned int *d_offsets, *d_compressed;
+    CUDA_SAFE_CALL(cudaMalloc(&d_in, n * sizeof(unsigned short)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, n * sizeof(unsigned short)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_codeLengths, 65536));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_offsets, (numSubBlocks + 1) * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_compressed,
+                              CUDPP_HUFFMAN_MAX_WORDS(n) * sizeof(unsigned int)));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        srand(42);
+        if (datatypes[d] == CUDPP_UCHAR)
+            uploadSymbols((unsigned char*)d_in, n, 256);
+        else
+            uploadSymbols((unsigned short*)d_in, n, 65536);
+
+        for (size_t k = 0; k < sizes.size(); k++)
+        {
+            CUDPPConfiguration config =
+                { CUDPP_HUFFMAN, CUDPP_OPERATOR_INVALID, datatypes[d], 0 };
+            benchmarkResult result;
+            initResult(result, "huffman", "encode", config, sizes[k],
+                       (double)datatypeSize(datatypes[d]));
+
+            CUDPPHandle plan;
+            if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                               result, reporter))
+                continue;
+            HuffmanCase encode(plan, false, d_in, d_compressed, d_codeLengths,
+                               d_offsets, sizes[k]);
+            reportBenchmark(encode, result, options, reporter);
+
+            // decode the stream the last encode left behind
+            initResult(result, "huffman", "decode", config, sizes[k],
+                       (double)datatypeSize(datatypes[d]));
+            if (encode.m_result == CUDPP_SUCCESS)
+            {
+                HuffmanCase decode(plan, true, d_out, d_compressed, d_codeLengths,
+                                   d_offsets, sizes[k]);
+                reportBenchmark(decode, result, options, reporter);
+            }
+            else
+                reporter.addFailure(result, "no input");
+            cudppDestroyPlan(plan);
+        }
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_out);
+    cudaFree(d_codeLengths);
+    cudaFree(d_offsets);
+    cudaFree(d_compressed);
+}
+
+// ---------------------------------------------------------------------------
+// Histogram
+// ---------------------------------------------------------------------------
+
+class HistogramCase : public BenchmarkCase
+{
+public:
+    HistogramCase(CUDPPHandle plan, unsigned int *d_histogram, const void *d_in, size_t n)
+    : m_plan(plan), m_histogram(d_histogram), m_in(d_in), m_n(n) {}
+    void run() { check(cudppHistogram(m_plan, m_histogram, m_in, m_n)); }
+private:
+    CUDPPHandle m_plan; unsigned int *m_histogram; const void *m_in; size_t m_n;
+};
+
+/** Histograms of skewed random bytes (256 bins) and 16-bit values (65536
+ *  bins, counted by sorting), and of random floats in 256 uniform bins
+ *  and 64 bins between edges */
+void benchmarkHistogram(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                        BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] = { CUDPP_UCHAR, CUDPP_USHORT, CUDPP_FLOAT };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, UINT_MAX);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    void *d_in;
+    unsigned int *d_histogram;
+    CUDA_SAFE_CALL(cudaMalloc(&d_in, n * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_histogram, 65536 * sizeof(unsigned int)));
+
+    std::vector<float> edges(65);
+    for (size_t i = 0; i < edges.size(); i++)
+        edges[i] = (float)(i * i) / (64 * 64);
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        srand(42);
+        if (datatypes[d] == CUDPP_UCHAR)
+            uploadSymbols((unsigned char*)d_in, n, 256);
+        else if (datatypes[d] == CUDPP_USHORT)
+            uploadSymbols((unsigned short*)d_in, n, 65536);
+        else
+        {
+            std::vector<float> values(n);
+            for (size_t i = 0; i < n; i++)
+                values[i] = (float)randomIndex(1u << 24) / (1u << 24);
+            CUDA_SAFE_CALL(cudaMemcpy(d_in, &values[0], n * sizeof(float),
+                                      cudaMemcpyHostToDevice));
+        }
+
+        for (size_t k = 0; k < sizes.size(); k++)
+        {
+            CUDPPConfiguration config =
+                { CUDPP_HISTOGRAM, CUDPP_OPERATOR_INVALID, datatypes[d], 0 };
+            benchmarkResult result;
+
+            // byte and 16-bit plans count one bin per value; float plans
+            // get uniform bins, then bins between edges
+            for (int edgeBins = 0; edgeBins < ((datatypes[d] == CUDPP_FLOAT) ? 2 : 1); edgeBins++)
+            {
+                initResult(result, "histogram",
+                           (datatypes[d] != CUDPP_FLOAT) ? "keys" : edgeBins ? "edges" : "uniform",
+                           config, sizes[k], (double)datatypeSize(datatypes[d]));
+
+                CUDPPHandle plan;
+                if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0,
+                                   result, reporter))
+                    continue;
+                if (datatypes[d] == CUDPP_FLOAT && edgeBins)
+                    cudppHistogramBinEdges(plan, 64, &edges[0]);
+                else if (datatypes[d] == CUDPP_FLOAT)
+                    cudppHistogramUniformBins(plan, 256, 0, 1);
+                HistogramCase benchmark(plan, d_histogram, d_in, sizes[k]);
+                reportBenchmark(benchmark, result, options, reporter);
+                cudppDestroyPlan(plan);
+            }
+        }
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_histogram);
+}
+
+// ---------------------------------------------------------------------------
+// Run-length encoding
+// ---------------------------------------------------------------------------
+
+class RunLengthEncodeCase : public BenchmarkCase
+{
+public:
+    RunLengthEncodeCase(CUDPPHandle plan, void *d_values, unsigned int *d_runLengths,
+                        size_t *d_numRuns, const void *d_in, size_t n)
+    : m_plan(plan), m_values(d_values), m_runLengths(d_runLengths),
+      m_numRuns(d_numRuns), m_in(d_in), m_n(n) {}
+    void run() { check(cudppRunLengthEncode(m_plan, m_values, m_runLengths,
+                                            m_numRuns, m_in, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_values; unsigned int *m_runLengths;
+    size_t *m_numRuns; const void *m_in; size_t m_n;
+};
+
+class RunLengthDecodeCase : public BenchmarkCase
+{
+public:
+    RunLengthDecodeCase(CUDPPHandle plan, void *d_out, const void *d_values,
+                        const unsigned int *d_runLengths, size_t numRuns, size_t n)
+    : m_plan(plan), m_out(d_out), m_values(d_values), m_runLengths(d_runLengths),
+      m_numRuns(numRuns), m_n(n) {}
+    void run() { check(cudppRunLengthDecode(m_plan, m_out, m_values, m_runLengths,
+                                            m_numRuns, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_out; const void *m_values;
+    const unsigned int *m_runLengths; size_t m_numRuns; size_t m_n;
+};
+
+/** Upload \a n values of type \a T in runs of 1 to 64 values */
+template <class T>
+static void uploadRuns(T *d_data, size_t n)
+{
+    std::vector<T> values(n);
+    T value = 0;
+    for (size_t i = 0; i < n; )
+    {
+        size_t length = 1 + randomIndex(64);
+        value = (T)(value + 1 + randomIndex(3));
+        for (size_t j = 0; j < length && i < n; j++)
+            values[i++] = value;
+    }
+    CUDA_SAFE_CALL(cudaMemcpy(d_data, &values[0], n * sizeof(T),
+                              cudaMemcpyHostToDevice));
+}
+
+/** Run-length encoding and decoding of bytes and 32- and 64-bit values in
+ *  runs of 1 to 64 values */
+void benchmarkRunLength(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                        BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] = { CUDPP_UCHAR, CUDPP_UINT, CUDPP_ULONGLONG };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, UINT_MAX);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    void *d_in, *d_values, *d_out;
+    unsigned int *d_runLengths;
+    size_t *d_numRuns;
+    CUDA_SAFE_CALL(cudaMalloc(&d_in, n * sizeof(unsigned long long)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_values, n * sizeof(unsigned long long)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_out, n * sizeof(unsigned long long)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_runLengths, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_numRuns, sizeof(size_t)));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        srand(42);
+        if (datatypes[d] == CUDPP_UCHAR)
+            uploadRuns((unsigned char*)d_in, n);
+        else if (datatypes[d] == CUDPP_UINT)
+            uploadRuns((unsigned int*)d_in, n);
+        else
+            uploadRuns((unsigned long long*)d_in, n);
+
+        for (size_t k = 0; k < sizes.size(); k++)
+        {
+            CUDPPConfiguration config =
+                { CUDPP_RLE, CUDPP_OPERATOR_INVALID, datatypes[d], 0 };
+            benchmarkResult result;
+
+            initResult(result, "rle", "encode", config, sizes[k],
+                       (double)datatypeSize(datatypes[d]));
+            CUDPPHandle plan;
+            if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0, result, reporter))
+                continue;
+            RunLengthEncodeCase encode(plan, d_values, d_runLengths, d_numRuns,
+                                       d_in, sizes[k]);
+            reportBenchmark(encode, result, options, reporter);
+
+            // decode the runs the encoder just wrote
+            size_t numRuns = 0;
+            CUDA_SAFE_CALL(cudaMemcpy(&numRuns, d_numRuns, sizeof(size_t),
+                                      cudaMemcpyDeviceToHost));
+            initResult(result, "rle", "decode", config, sizes[k],
+                       (double)datatypeSize(datatypes[d]));
+            RunLengthDecodeCase decode(plan, d_out, d_values, d_runLengths,
+                                       numRuns, sizes[k]);
+            reportBenchmark(decode, result, options, reporter);
+            cudppDestroyPlan(plan);
+        }
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_values);
+    cudaFree(d_out);
+    cudaFree(d_runLengths);
+    cudaFree(d_numRuns);
+}
+
+// ---------------------------------------------------------------------------
+// Reduce by key
+// ---------------------------------------------------------------------------
+
+class ReduceByKeyCase : public BenchmarkCase
+{
+public:
+    ReduceByKeyCase(CUDPPHandle plan, void *d_keysOut, void *d_valuesOut,
+                    unsigned int *d_counts, size_t *d_numUnique, const void *d_keys,
+                    const void *d_values, size_t n)
+    : m_plan(plan), m_keysOut(d_keysOut), m_valuesOut(d_valuesOut), m_counts(d_counts),
+      m_numUnique(d_numUnique), m_keys(d_keys), m_values(d_values), m_n(n) {}
+    void run() { check(cudppReduceByKey(m_plan, m_keysOut, m_valuesOut, m_counts,
+                                        m_numUnique, m_keys, m_values, m_n)); }
+private:
+    CUDPPHandle m_plan; void *m_keysOut; void *m_valuesOut; unsigned int *m_counts;
+    size_t *m_numUnique; const void *m_keys; const void *m_values; size_t m_n;
+};
+
+/** Sums of float and double values over random 32-bit keys, with about
+ *  16 keys per group, sorted and unsorted */
+void benchmarkReduceByKey(CUDPPHandle theCudpp, const benchmarkOptions &options,
+                          BenchmarkReporter &reporter)
+{
+    static const CUDPPDatatype datatypes[] = { CUDPP_FLOAT, CUDPP_DOUBLE };
+
+    std::vector<size_t> sizes;
+    benchmarkSizes(sizes, options, 1, UINT_MAX);
+    if (sizes.empty())
+        return;
+    size_t n = maxSize(sizes);
+
+    void *d_values, *d_valuesOut;
+    unsigned int *d_keys, *d_sortedKeys, *d_keysOut, *d_counts;
+    size_t *d_numUnique;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keys, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_sortedKeys, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keysOut, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_counts, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_numUnique, sizeof(size_t)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_values, n * sizeof(double)));
+    CUDA_SAFE_CALL(cudaMalloc(&d_valuesOut, n * sizeof(double)));
+
+    srand(42);
+    std::vector<unsigned int> keys(n);
+    for (size_t i = 0; i < n; i++)
+        keys[i] = randomIndex(n / 16 + 1) * 0x9E3779B1u;
+    CUDA_SAFE_CALL(cudaMemcpy(d_keys, &keys[0], n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+    std::sort(keys.begin(), keys.end());
+    CUDA_SAFE_CALL(cudaMemcpy(d_sortedKeys, &keys[0], n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+
+    for (size_t d = 0; d < sizeof(datatypes) / sizeof(datatypes[0]); d++)
+    {
+        if (!runDatatype(options, datatypes[d]))
+            continue;
+        if (datatypes[d] == CUDPP_FLOAT)
+            uploadConstant(d_values, n, 1.0f);
+        else
+            uploadConstant(d_values, n, 1.0);
+
+        for (size_t k = 0; k < sizes.size(); k++)
+        {
+            for (int unsorted = 0; unsorted < 2; unsorted++)
+            {
+                CUDPPConfiguration config =
+                    { CUDPP_REDUCE_BY_KEY, CUDPP_ADD, datatypes[d],
+                      unsorted ? (unsigned int)CUDPP_OPTION_UNSORTED_KEYS : 0 };
+                benchmarkResult result;
+                initResult(result, "reducebykey", unsorted ? "unsorted" : "sorted", config,
+                           sizes[k], (double)(sizeof(unsigned int) + datatypeSize(datatypes[d])));
+
+                CUDPPHandle plan;
+                if (!planBenchmark(theCudpp, plan, config, sizes[k], 1, 0, result, reporter))
+                    continue;
+                ReduceByKeyCase benchmark(plan, d_keysOut, d_valuesOut, d_counts, d_numUnique,
+                                          unsorted ? d_keys : d_sortedKeys, d_values, sizes[k]);
+                reportBenchmark(benchmark, result, options, reporter);
+                cudppDestroyPlan(plan);
+            }
+        }
+    }
+
+    cudaFree(d_keys);
+    cudaFree(d_sortedKeys);
+    cudaFree(d_keysOut);
+    cudaFree(d_counts);
+    cudaFree(d_numUnique);
+    cudaFree(d_values);
+    cudaFree(d_valuesOut);
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
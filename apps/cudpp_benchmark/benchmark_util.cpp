@@ -0,0 +1,283 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * benchmark_util.cpp
+ *
+ * @brief Timing, size sweeps, input generation and naming shared by the
+ * benchmarks.
+ */
+
+#include <cuda_runtime_api.h>
+#include <cstring>
+#include <vector>
+
+#include "cudpp_benchmark.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+
+using namespace cudpp_app;
+
+/**
+ * @brief Times a benchmark case
+ *
+ * Runs the case options.warmup times untimed, then times each of
+ * options.repetitions runs separately.  The device is synchronized after
+ * every run, so each time is the latency of one call, including any host
+ * work the call does.
+ *
+ * @param[in]  benchmark The case to time
+ * @param[in]  options   Warmup and repetition counts
+ * @param[out] times     The time of each repetition, in ms
+ */
+void timeBenchmark(BenchmarkCase &benchmark, const benchmarkOptions &options,
+                   std::vector<float> &times)
+{
+    StopWatch timer;
+
+    for (int i = 0; i < options.warmup; i++)
+    {
+        benchmark.prepare();
+        benchmark.run();
+    }
+
+    times.clear();
+    for (int i = 0; i < options.repetitions; i++)
+    {
+        benchmark.prepare();
+        CUDA_SAFE_CALL(cudaThreadSynchronize());
+
+        timer.reset();
+        timer.start();
+        benchmark.run();
+        CUDA_SAFE_CALL(cudaThreadSynchronize());
+        timer.stop();
+
+        times.push_back(timer.getTime());
+    }
+}
+
+/** @returns the device memory currently allocated, in bytes */
+size_t deviceMemoryInUse()
+{
+    size_t freeMem = 0, totalMem = 0;
+    CUDA_SAFE_CALL(cudaMemGetInfo(&freeMem, &totalMem));
+    return totalMem - freeMem;
+}
+
+/**
+ * @brief Computes the sizes to benchmark an algorithm at
+ *
+ * The default sweep is 2^10 elements and every 16 times larger size up to
+ * the smaller of options.maxElements and \a maxSize, which is always
+ * included.  A size given with -n replaces the sweep, but is skipped by
+ * algorithms that do not support it.
+ *
+ * @param[out] sizes    The sizes, in increasing order
+ * @param[in]  options  Benchmark options
+ * @param[in]  minSize  Smallest size the algorithm supports
+ * @param[in]  maxSize  Largest size the algorithm supports
+ */
+void benchmarkSizes(std::vector<size_t> &sizes, const benchmarkOptions &options,
+                    size_t minSize, size_t maxSize)
+{
+    sizes.clear();
+
+    if (options.numElements)
+    {
+        if (options.numElements >= minSize && options.numElements <= maxSize)
+            sizes.push_back(options.numElements);
+        return;
+    }
+
+    size_t limit = (options.maxElements < maxSize) ? options.maxElements : maxSize;
+    size_t n = (minSize > 1024) ? minSize : 1024;
+    for (; n < limit; n *= 16)
+        sizes.push_back(n);
+    if (limit >= minSize)
+        sizes.push_back(limit);
+}
+
+/** @returns true if \a datatype was not filtered out with -datatype and
+ *  the device supports it */
+bool runDatatype(const benchmarkOptions &options, CUDPPDatatype datatype)
+{
+    if (datatype == CUDPP_DOUBLE && !options.supportsDouble)
+        return false;
+    return options.datatype.empty() || options.datatype == datatypeName(datatype);
+}
+
+/** @returns true if \a op was not filtered out with -op */
+bool runOperator(const benchmarkOptions &options, CUDPPOperator op)
+{
+    return options.op.empty() || options.op == operatorName(op);
+}
+
+/** @returns the size of one element of \a datatype, in bytes */
+size_t datatypeSize(CUDPPDatatype datatype)
+{
+    switch (datatype)
+    {
+    case CUDPP_CHAR:      return sizeof(char);
+    case CUDPP_UCHAR:     return sizeof(unsigned char);
+    case CUDPP_SHORT:     return sizeof(short);
+    case CUDPP_USHORT:    return sizeof(unsigned short);
+    case CUDPP_INT:       return sizeof(int);
+    case CUDPP_UINT:      return sizeof(unsigned int);
+    case CUDPP_FLOAT:     return sizeof(float);
+    case CUDPP_DOUBLE:    return sizeof(double);
+    case CUDPP_LONGLONG:  return sizeof(long long);
+    case CUDPP_ULONGLONG: return sizeof(unsigned long long);
+    default:              return 0;
+    }
+}
+
+/* Make sure this tracks CUDPPDatatype in cudpp.h! */
+const char *datatypeName(CUDPPDatatype datatype)
+{
+    static const char *names[] =
+    {
+        "char",
+        "uchar",
+        "short",
+        "ushort",
+        "int",
+        "uint",
+        "float",
+        "double",
+        "longlong",
+        "ulonglong",
+        "datatype_invalid",
+    };
+    return names[(int)datatype];
+}
+
+/* Make sure this tracks CUDPPOperator in cudpp.h! */
+const char *operatorName(CUDPPOperator op)
+{
+    static const char *names[] =
+    {
+        "sum",
+        "multiply",
+        "min",
+        "max",
+        "none",
+    };
+    return names[(int)op];
+}
+
+/** @returns the names of the bits set in \a options, separated by '|',
+ *  or "none" */
+std::string optionsName(unsigned int options)
+{
+    static const struct
+    {
+        unsigned int option;
+        const char  *name;
+    } names[] =
+    {
+        { CUDPP_OPTION_FORWARD,              "forward" },
+        { CUDPP_OPTION_BACKWARD,             "backward" },
+        { CUDPP_OPTION_EXCLUSIVE,            "exclusive" },
+        { CUDPP_OPTION_INCLUSIVE,            "inclusive" },
+        { CUDPP_OPTION_CTA_LOCAL,            "cta_local" },
+        { CUDPP_OPTION_KEYS_ONLY,            "keys_only" },
+        { CUDPP_OPTION_KEY_VALUE_PAIRS,      "key_value_pairs" },
+        { CUDPP_OPTION_64BIT_VALUES,         "64bit_values" },
+        { CUDPP_OPTION_PERIODIC,             "periodic" },
+        { CUDPP_OPTION_BLOCK_2X2,            "block_2x2" },
+        { CUDPP_OPTION_BLOCK_4X4,            "block_4x4" },
+        { CUDPP_OPTION_RAND_NORMAL,          "rand_normal" },
+        { CUDPP_OPTION_RAND_EXPONENTIAL,     "rand_exponential" },
+        { CUDPP_OPTION_SPMV_HALF_VALUES,     "spmv_half_values" },
+        { CUDPP_OPTION_SPMV_BFLOAT16_VALUES, "spmv_bfloat16_values" },
+        { CUDPP_OPTION_SPMV_16BIT_INDICES,   "spmv_16bit_indices" },
+    };
+
+    std::string name;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+    {
+        if (options & names[i].option)
+        {
+            if (!name.empty())
+                name += "|";
+            name += names[i].name;
+        }
+    }
+    return name.empty() ? "none" : name;
+}
+
+/** Deterministic 64-bit generator (xorshift64*), so every run of the
+ *  benchmark sees the same inputs */
+static unsigned long long nextRandom()
+{
+    static unsigned long long state = 0x9E3779B97F4A7C15ULL;
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 2685821657736338717ULL;
+}
+
+template <typename T>
+static void fillRandomIntegers(void *h_data, size_t numElements)
+{
+    T *data = (T*)h_data;
+    for (size_t i = 0; i < numElements; i++)
+        data[i] = (T)nextRandom();
+}
+
+template <typename T>
+static void fillRandomReals(void *h_data, size_t numElements)
+{
+    T *data = (T*)h_data;
+    for (size_t i = 0; i < numElements; i++)
+        data[i] = (T)((nextRandom() >> 11) * (1.0 / 9007199254740992.0));
+}
+
+/**
+ * @brief Fills a device array with random values
+ *
+ * Integers take every bit pattern; floating point values are uniform in
+ * [0, 1).
+ *
+ * @param[out] d_data      The device array
+ * @param[in]  numElements Number of elements to fill
+ * @param[in]  datatype    Datatype of the elements
+ */
+void fillDeviceRandom(void *d_data, size_t numElements, CUDPPDatatype datatype)
+{
+    std::vector<char> h_data(numElements * datatypeSize(datatype) + 1);
+    void *p = &h_data[0];
+
+    switch (datatype)
+    {
+    case CUDPP_CHAR:      fillRandomIntegers<char>(p, numElements); break;
+    case CUDPP_UCHAR:     fillRandomIntegers<unsigned char>(p, numElements); break;
+    case CUDPP_SHORT:     fillRandomIntegers<short>(p, numElements); break;
+    case CUDPP_USHORT:    fillRandomIntegers<unsigned short>(p, numElements); break;
+    case CUDPP_INT:       fillRandomIntegers<int>(p, numElements); break;
+    case CUDPP_UINT:      fillRandomIntegers<unsigned int>(p, numElements); break;
+    case CUDPP_LONGLONG:  fillRandomIntegers<long long>(p, numElements); break;
+    case CUDPP_ULONGLONG: fillRandomIntegers<unsigned long long>(p, numElements); break;
+    case CUDPP_FLOAT:     fillRandomReals<float>(p, numElements); break;
+    case CUDPP_DOUBLE:    fillRandomReals<double>(p, numElements); break;
+    default:              break;
+    }
+
+    CUDA_SAFE_CALL(cudaMemcpy(d_data, p, numElements * datatypeSize(datatype),
+                              cudaMemcpyHostToDevice));
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
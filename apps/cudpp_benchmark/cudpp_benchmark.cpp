@@ -0,0 +1,342 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_benchmark.cpp
+ *
+ * @brief Benchmark driver for every CUDPP algorithm, with CSV or JSON
+ * output for tracking performance over time.
+ */
+
+#include <cuda_runtime_api.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "cudpp.h"
+#include "cudpp_benchmark.h"
+
+#define CUDPP_APP_COMMON_IMPL
+#include "stopwatch.h"
+#include "commandline.h"
+
+using namespace cudpp_app;
+
+/** @brief A benchmark and the algorithm it covers */
+struct benchmarkEntry
+{
+    CUDPPAlgorithm    algorithm; //!< The algorithm benchmarked
+    const char       *name;      //!< Name used with -algorithm
+    BenchmarkFunction function;  //!< Runs the benchmark
+};
+
+/** One benchmark per algorithm, in CUDPPAlgorithm order */
+static const benchmarkEntry benchmarks[] =
+{
+    { CUDPP_SCAN,           "scan",          benchmarkScan },
+    { CUDPP_SEGMENTED_SCAN, "segscan",       benchmarkSegmentedScan },
+    { CUDPP_COMPACT,        "compact",       benchmarkCompact },
+    { CUDPP_REDUCE,         "reduce",        benchmarkReduce },
+    { CUDPP_SORT_RADIX,     "radixsort",     benchmarkRadixSort },
+    { CUDPP_SORT_MERGE,     "mergesort",     benchmarkMergeSort },
+    { CUDPP_SORT_STRING,    "stringsort",    benchmarkStringSort },
+    { CUDPP_SPMVMULT,       "spmv",          benchmarkSpmv },
+    { CUDPP_RAND_MD5,       "rand",          benchmarkRandMd5 },
+    { CUDPP_TRIDIAGONAL,    "tridiagonal",   benchmarkTridiagonal },
+    { CUDPP_COMPRESS,       "compress",      benchmarkCompress },
+    { CUDPP_LISTRANK,       "listrank",      benchmarkListRank },
+    { CUDPP_BWT,            "bwt",           benchmarkBwt },
+    { CUDPP_MTF,            "mtf",           benchmarkMtf },
+    { CUDPP_RAND_PHILOX,    "philox",        benchmarkRandPhilox },
+    { CUDPP_SPARSE_CONVERT, "sparseconvert", benchmarkSparseConvert },
+    { CUDPP_EULER_TOUR,     "eulertour",     benchmarkEulerTour },
+    { CUDPP_HUFFMAN,        "huffman",       benchmarkHuffman },
+    { CUDPP_HISTOGRAM,      "histogram",     benchmarkHistogram },
+    { CUDPP_RLE,            "rle",           benchmarkRunLength },
+    { CUDPP_REDUCE_BY_KEY,  "reducebykey",   benchmarkReduceByKey },
+};
+
+static const size_t numBenchmarks = sizeof(benchmarks) / sizeof(benchmarks[0]);
+
+// fails to compile if an algorithm is added without a benchmark
+typedef char benchmarkForEveryAlgorithm[(numBenchmarks == CUDPP_ALGORITHM_INVALID) ? 1 : -1];
+
+/** @returns the time at fraction \a p (0 to 1) of the sorted \a times,
+ *  by the nearest-rank method */
+static float percentile(const std::vector<float> &times, double p)
+{
+    size_t rank = (size_t)(p * times.size() + 0.999999);
+    if (rank < 1) rank = 1;
+    if (rank > times.size()) rank = times.size();
+    return times[rank - 1];
+}
+
+/** @returns \a s with JSON special characters escaped */
+static std::string jsonString(const std::string &s)
+{
+    std::string out = "\"";
+    for (size_t i = 0; i < s.size(); i++)
+    {
+        if (s[i] == '"' || s[i] == '\\')
+            out += '\\';
+        out += s[i];
+    }
+    return out + "\"";
+}
+
+BenchmarkReporter::BenchmarkReporter(const benchmarkOptions &options, FILE *out)
+: m_options(options),
+  m_out(out),
+  m_numResults(0),
+  m_numFailed(0)
+{
+}
+
+/** @brief Writes the CSV header, or opens the JSON document */
+void BenchmarkReporter::begin(const char *deviceName)
+{
+    if (m_options.format == "json")
+    {
+        fprintf(m_out, "{\n  \"device\": %s,\n  \"warmup\": %d,\n"
+                "  \"repetitions\": %d,\n  \"results\": [",
+                jsonString(deviceName).c_str(), m_options.warmup,
+                m_options.repetitions);
+    }
+    else
+    {
+        fprintf(m_out, "algorithm,variant,datatype,op,options,elements,"
+                "min_ms,mean_ms,p50_ms,p90_ms,p99_ms,max_ms,"
+                "elements_per_s,gb_per_s,plan_bytes\n");
+    }
+    fflush(m_out);
+}
+
+/**
+ * @brief Writes one result
+ *
+ * Throughput is computed from the median time; GB/s counts the nominal
+ * bytes read and written per element by the algorithm.
+ */
+void BenchmarkReporter::add(const benchmarkResult &result)
+{
+    std::vector<float> times = result.times;
+    if (times.empty())
+        return;
+    std::sort(times.begin(), times.end());
+
+    double mean = 0;
+    for (size_t i = 0; i < times.size(); i++)
+        mean += times[i];
+    mean /= times.size();
+
+    float p50 = percentile(times, 0.5);
+    double seconds = (p50 > 0) ? p50 * 1.0e-3 : 1.0e-9;
+    double elementsPerSecond = result.numElements / seconds;
+    double gbPerSecond =
+        1.0e-9 * result.numElements * result.bytesPerElement / seconds;
+
+    if (m_options.format == "json")
+    {
+        fprintf(m_out, "%s\n    {\"algorithm\": %s, \"variant\": %s, "
+                "\"datatype\": %s, \"op\": %s, \"options\": %s, "
+                "\"elements\": %llu, \"min_ms\": %g, \"mean_ms\": %g, "
+                "\"p50_ms\": %g, \"p90_ms\": %g, \"p99_ms\": %g, "
+                "\"max_ms\": %g, \"elements_per_s\": %g, \"gb_per_s\": %g, "
+                "\"plan_bytes\": %llu}",
+                m_numResults ? "," : "",
+                jsonString(result.algorithm).c_str(),
+                jsonString(result.variant).c_str(),
+                jsonString(result.datatype).c_str(),
+                jsonString(result.op).c_str(),
+                jsonString(result.options).c_str(),
+                (unsigned long long)result.numElements,
+                times.front(), mean, p50, percentile(times, 0.9),
+                percentile(times, 0.99), times.back(),
+                elementsPerSecond, gbPerSecond,
+                (unsigned long long)result.planBytes);
+    }
+    else
+    {
+        fprintf(m_out, "%s,%s,%s,%s,%s,%llu,%g,%g,%g,%g,%g,%g,%g,%g,%llu\n",
+                result.algorithm.c_str(), result.variant.c_str(),
+                result.datatype.c_str(), result.op.c_str(),
+                result.options.c_str(),
+                (unsigned long long)result.numElements,
+                times.front(), mean, p50, percentile(times, 0.9),
+                percentile(times, 0.99), times.back(),
+                elementsPerSecond, gbPerSecond,
+                (unsigned long long)result.planBytes);
+    }
+    fflush(m_out);
+    m_numResults++;
+}
+
+/** @brief Reports a configuration that could not be planned or run */
+void BenchmarkReporter::addFailure(const benchmarkResult &result, const char *reason)
+{
+    fprintf(stderr, "error: %s %s %s %s %s n=%llu: %s\n",
+            result.algorithm.c_str(), result.variant.c_str(),
+            result.datatype.c_str(), result.op.c_str(),
+            result.options.c_str(), (unsigned long long)result.numElements,
+            reason);
+    m_numFailed++;
+}
+
+/** @brief Closes the JSON document */
+void BenchmarkReporter::end()
+{
+    if (m_options.format == "json")
+        fprintf(m_out, "\n  ],\n  \"failures\": %d\n}\n", m_numFailed);
+    fflush(m_out);
+}
+
+static void printUsage()
+{
+    printf("Usage: \"cudpp_benchmark -<option>=<value>\"\n\n");
+    printf("-algorithm=<names>: comma-separated benchmarks to run "
+           "(default all):\n   ");
+    for (size_t i = 0; i < numBenchmarks; i++)
+        printf(" %s", benchmarks[i].name);
+    printf("\n");
+    printf("-datatype=<name>: only run this datatype (e.g. float, uint)\n");
+    printf("-op=<name>: only run this operator (sum, multiply, min, max)\n");
+    printf("-n=#: only run this size\n");
+    printf("-max=#: largest size of the default sweep (default 16777216)\n");
+    printf("-warmup=#: untimed runs before timing (default 2)\n");
+    printf("-repetitions=#: timed runs of each configuration (default 10)\n");
+    printf("-format=<csv|json>: output format (default csv)\n");
+    printf("-output=<file>: write results to a file instead of stdout\n");
+    printf("-device=#: CUDA device to run on (default 0)\n");
+}
+
+/** @returns true if benchmark \a name is in the comma-separated \a list */
+static bool isSelected(const std::string &list, const char *name)
+{
+    if (list.empty() || list == "all")
+        return true;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        if (list.compare(start, end - start, name) == 0)
+            return true;
+        start = end + 1;
+    }
+    return false;
+}
+
+/**
+ * Main benchmark driver.  Runs the selected benchmarks and writes one
+ * line (CSV) or object (JSON) per configuration.  Progress and errors go
+ * to stderr, so the output can be redirected to a file.
+ *
+ * @returns 0 if every configuration ran, 1 otherwise
+ */
+int main(int argc, const char **argv)
+{
+    if (checkCommandLineFlag(argc, argv, "help"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    int deviceCount;
+    cudaGetDeviceCount(&deviceCount);
+    if (deviceCount == 0) {
+        fprintf(stderr, "error: no devices supporting CUDA.\n");
+        exit(EXIT_FAILURE);
+    }
+    int dev = 0;
+    commandLineArg(dev, argc, argv, "device");
+    if (dev < 0) dev = 0;
+    if (dev > deviceCount-1) dev = deviceCount - 1;
+    cudaSetDevice(dev);
+
+    cudaDeviceProp devProps;
+    cudaGetDeviceProperties(&devProps, dev);
+
+    benchmarkOptions options;
+    options.algorithm = "all";
+    commandLineArg(options.algorithm, argc, argv, "algorithm");
+    commandLineArg(options.datatype, argc, argv, "datatype");
+    commandLineArg(options.op, argc, argv, "op");
+    options.format = "csv";
+    commandLineArg(options.format, argc, argv, "format");
+    commandLineArg(options.output, argc, argv, "output");
+    options.warmup = 2;
+    commandLineArg(options.warmup, argc, argv, "warmup");
+    options.repetitions = 10;
+    commandLineArg(options.repetitions, argc, argv, "repetitions");
+
+    unsigned long long size = 0;
+    commandLineArg(size, argc, argv, "n");
+    options.numElements = (size_t)size;
+    size = 1 << 24;
+    commandLineArg(size, argc, argv, "max");
+    options.maxElements = (size_t)size;
+
+    options.supportsDouble = (devProps.major * 10 + devProps.minor >= 13);
+
+    if ((options.format != "csv" && options.format != "json") ||
+        options.repetitions < 1 || options.warmup < 0)
+    {
+        printUsage();
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (!options.output.empty())
+    {
+        out = fopen(options.output.c_str(), "w");
+        if (!out)
+        {
+            fprintf(stderr, "error: cannot open %s\n", options.output.c_str());
+            return 1;
+        }
+    }
+
+    CUDPPHandle theCudpp;
+    if (cudppCreate(&theCudpp) != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    BenchmarkReporter reporter(options, out);
+    reporter.begin(devProps.name);
+
+    for (size_t i = 0; i < numBenchmarks; i++)
+    {
+        if (!isSelected(options.algorithm, benchmarks[i].name))
+            continue;
+        fprintf(stderr, "Running %s benchmarks\n", benchmarks[i].name);
+        benchmarks[i].function(theCudpp, options, reporter);
+    }
+
+    reporter.end();
+
+    cudppDestroy(theCudpp);
+    if (out != stdout)
+        fclose(out);
+
+    return reporter.numFailed() ? 1 : 0;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -0,0 +1,162 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision: $
+// $Date: $
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt in
+// the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_benchmark.h
+ *
+ * @brief Declarations shared by the cudpp_benchmark driver and the
+ * per-algorithm benchmarks.
+ *
+ * Every benchmark sweeps sizes, datatypes, operators and options of one
+ * CUDPPAlgorithm.  Each configuration is planned once per size, run a
+ * number of untimed warmup times and then timed one repetition at a time,
+ * so that latency percentiles as well as throughput can be reported.
+ */
+
+#ifndef __CUDPP_BENCHMARK_H__
+#define __CUDPP_BENCHMARK_H__
+
+#include <cudpp.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Options of a benchmark run, set from the command line
+ */
+struct benchmarkOptions
+{
+    std::string algorithm;   //!< Benchmark to run ("all" for every algorithm)
+    std::string datatype;    //!< Only run this datatype, if not empty
+    std::string op;          //!< Only run this operator, if not empty
+    std::string format;      //!< Output format: "csv" or "json"
+    std::string output;      //!< Output file; standard output if empty
+    int    warmup;           //!< Untimed runs before the timed repetitions
+    int    repetitions;      //!< Timed repetitions of each configuration
+    size_t numElements;      //!< Only run this size, if not 0
+    size_t maxElements;      //!< Largest size of the default sweep
+    bool   supportsDouble;   //!< The device supports double precision
+};
+
+/**
+ * @brief One benchmarked configuration and its per-repetition times
+ */
+struct benchmarkResult
+{
+    std::string algorithm;       //!< Benchmark name, e.g. "scan"
+    std::string variant;         //!< Entry point or mode, e.g. "inverse"
+    std::string datatype;        //!< Datatype name
+    std::string op;              //!< Operator name, or "none"
+    std::string options;         //!< Options, '|'-separated, or "none"
+    size_t      numElements;     //!< Elements processed per call
+    double      bytesPerElement; //!< Nominal bytes read and written per element
+    size_t      planBytes;       //!< Device memory taken by the plan
+    std::vector<float> times;    //!< Time of each repetition in ms
+};
+
+/**
+ * @brief A configuration to time
+ *
+ * prepare() is called, untimed, before every run(), so that in-place
+ * algorithms (sorts, for example) always see the same input.  run() 
+ * passes the result of the CUDPP call to check(), so failures are 
+ * reported instead of timed.
+ */
+class BenchmarkCase
+{
+public:
+    BenchmarkCase() : m_result(CUDPP_SUCCESS) {}
+    virtual ~BenchmarkCase() {}
+    virtual void prepare() {}  //!< Restore the input (not timed)
+    virtual void run() = 0;    //!< The call being timed
+
+    CUDPPResult m_result;      //!< First error returned by a call, if any
+
+protected:
+    void check(CUDPPResult result)
+    {
+        if (m_result == CUDPP_SUCCESS)
+            m_result = result;
+    }
+};
+
+/**
+ * @brief Collects results and writes them as CSV or JSON
+ */
+class BenchmarkReporter
+{
+public:
+    BenchmarkReporter(const benchmarkOptions &options, FILE *out);
+
+    void begin(const char *deviceName);
+    void add(const benchmarkResult &result);
+    void end();
+
+    //! @returns the number of configurations that could not be run
+    int numFailed() const { return m_numFailed; }
+    void addFailure(const benchmarkResult &result, const char *reason);
+
+private:
+    const benchmarkOptions &m_options;
+    FILE *m_out;
+    int   m_numResults;
+    int   m_numFailed;
+};
+
+// benchmark_util.cpp
+void timeBenchmark(BenchmarkCase &benchmark, const benchmarkOptions &options,
+                   std::vector<float> &times);
+size_t deviceMemoryInUse();
+void benchmarkSizes(std::vector<size_t> &sizes, const benchmarkOptions &options,
+                    size_t minSize, size_t maxSize);
+bool runDatatype(const benchmarkOptions &options, CUDPPDatatype datatype);
+bool runOperator(const benchmarkOptions &options, CUDPPOperator op);
+size_t datatypeSize(CUDPPDatatype datatype);
+const char *datatypeName(CUDPPDatatype datatype);
+const char *operatorName(CUDPPOperator op);
+std::string optionsName(unsigned int options);
+void fillDeviceRandom(void *d_data, size_t numElements, CUDPPDatatype datatype);
+
+/** @brief Runs every configuration of one algorithm and reports the results */
+typedef void (*BenchmarkFunction)(CUDPPHandle theCudpp,
+                                  const benchmarkOptions &options,
+                                  BenchmarkReporter &reporter);
+
+// benchmark_algorithms.cpp
+void benchmarkScan(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkSegmentedScan(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkCompact(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkReduce(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkRadixSort(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkMergeSort(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkStringSort(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkSpmv(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkRandMd5(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkTridiagonal(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkCompress(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkListRank(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkBwt(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkMtf(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkRandPhilox(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkSparseConvert(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkEulerTour(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkHuffman(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkHistogram(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkRunLength(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+void benchmarkReduceByKey(CUDPPHandle, const benchmarkOptions&, BenchmarkReporter&);
+
+#endif // __CUDPP_BENCHMARK_H__
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -52,6 +52,35 @@ compactGold( T* reference, const T* idata,
     return count;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Compute reference data set for a stable partition: the valid elements, 
+//! as compactGold() places them, followed by the invalid elements in the 
+//! same order
+//! @param reference  reference data, computed but preallocated (len elements)
+//! @param idata      const input data as provided to device
+//! @param isValid    valid flags
+//! @param len        number of elements in reference / idata
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+unsigned int
+partitionGold( T* reference, const T* idata, 
+               const unsigned int *isValid, const unsigned int len,
+               const CUDPPConfiguration & config) 
+{
+    unsigned int numValidElements = compactGold(reference, idata, isValid, len, config);
+    bool isBackward = (config.options & CUDPP_OPTION_BACKWARD) != 0;
+
+    unsigned int count = numValidElements;
+    for( unsigned int j = 0; j < len; ++j) 
+    {
+        unsigned int i = isBackward ? len - 1 - j : j;
+        if (isValid[i] == 0)
+            reference[count++] = idata[i];
+    }
+
+    return numValidElements;
+}
+
 
 // Leave this at the end of the file
 // Local Variables:
@@ -47,14 +47,23 @@ int testCompact(int argc, const char ** argv, const CUDPPConfiguration *config);
 int testRadixSort(int argc, const char ** argv, const CUDPPConfiguration *config);
 int testReduce(int argc, const char ** argv, const CUDPPConfiguration *config);
 int testSparseMatrixVectorMultiply(int argc, const char ** argv);
+int testSparseConvert(int argc, const char ** argv);
+int testEulerTour(int argc, const char ** argv);
+int testHistogram(int argc, const char ** argv);
+int testRunLength(int argc, const char ** argv);
+int testReduceByKey(int argc, const char ** argv);
 int testMergeSort(int argc, const char ** argv, const CUDPPConfiguration *config);
 int testStringSort(int argc, const char ** argv, const CUDPPConfiguration *config);
 int testRandMD5(int argc, const char ** argv);
+int testRandPhilox(int argc, const char ** argv);
 int testTridiagonal(int argc, const char** argv, const CUDPPConfiguration *config);
 int testMtf(int argc, const char** argv, const CUDPPConfiguration *config);
 int testBwt(int argc, const char** argv, const CUDPPConfiguration *config);
 int testCompress(int argc, const char** argv, const CUDPPConfiguration *config);
+int testHuffman(int argc, const char** argv, const CUDPPConfiguration *config);
 int testListRank(int argc, const char** argv, const CUDPPConfiguration *config);
+int testExternalSort(int argc, const char** argv, const CUDPPConfiguration *config);
+int testLargeArrays(int argc, const char** argv);
 
 int testAllDatatypes(int argc, 
                      const char** argv, 
@@ -66,13 +75,19 @@ int testAllDatatypes(int argc,
 
     if (config.algorithm == CUDPP_TRIDIAGONAL)
     {
-        config.datatype = CUDPP_FLOAT;
-        retval += testTridiagonal(argc, argv, &config);
-
-        if (supportsDouble)
+        unsigned int variants[] = { 0, CUDPP_OPTION_PERIODIC, 
+                                    CUDPP_OPTION_BLOCK_2X2, CUDPP_OPTION_BLOCK_4X4 };
+        for (unsigned int v = 0; v < sizeof(variants) / sizeof(variants[0]); v++)
         {
-            config.datatype = CUDPP_DOUBLE;
-            retval += testTridiagonal(argc, argv, &config);      
+            config.options = variants[v];
+            config.datatype = CUDPP_FLOAT;
+            retval += testTridiagonal(argc, argv, &config);
+
+            if (supportsDouble)
+            {
+                config.datatype = CUDPP_DOUBLE;
+                retval += testTridiagonal(argc, argv, &config);      
+            }
         }
         return retval;
     }
@@ -98,6 +113,15 @@ int testAllDatatypes(int argc,
         return retval;
     }
 
+    if (config.algorithm == CUDPP_HUFFMAN)
+    {
+        config.datatype = CUDPP_UCHAR;
+        retval += testHuffman(argc, argv, &config);
+        config.datatype = CUDPP_USHORT;
+        retval += testHuffman(argc, argv, &config);
+        return retval;
+    }
+
     if(config.algorithm == CUDPP_SORT_STRING)
     {		
         config.datatype = CUDPP_UINT;
@@ -257,7 +281,13 @@ int testAllOptionsAndDatatypes(int argc,
  * - --mergesort calls the merge sort regression routine
  * - --stringsort calls the string sort regression routine
  * - --spmvmult calls the sparse matrix-vector routine
+ * - --sparseconvert calls the sparse matrix conversion routine
+ * - --eulertour calls the Euler tour tree routine
+ * - --histogram calls the histogram routine
+ * - --rle calls the run-length encoding routine
+ * - --reducebykey calls the reduce by key and unique routine
  * - --reduce calls the reduce regression routine
+ *   - Use --autotune to run it with plans tuned by cudppAutotune()
  * - --n=# sets the size of the dataset
  * - --iterations=# sets the number of iterations to run
  */ 
@@ -287,7 +317,6 @@ int main(int argc, const char** argv)
 
     int computeVersion = devProps.major * 10 + devProps.minor;
     bool supportsDouble = (computeVersion >= 13);
-    bool supports48KBInShared = (computeVersion >= 20);
 
     int retval = 0;
 
@@ -306,12 +335,19 @@ int main(int argc, const char** argv)
         printf("reduce: Run reduce test(s)\n\n");
         printf("rand: Run random number generator test(s)\n\n");
         printf("tridiagonal: Run tridiagonal solver test(s)\n\n");
-        printf("mtf: Run move-to-front transform test(s) "
-               "(compute 2.0+ only)\n\n"); 
-        printf("bwt: Run Burrows-Wheeler transform test(s) "
-               "(compute 2.0+ only)\n\n");
-        printf("compress: Run compression test(s) (compute 2.0+ only)\n\n");
+        printf("mtf: Run move-to-front transform and inverse test(s)\n\n"); 
+        printf("bwt: Run Burrows-Wheeler transform test(s)\n\n");
+        printf("compress: Run compression test(s)\n\n");
+        printf("huffman: Run canonical Huffman encode and decode test(s)\n\n");
         printf("listrank: Run list ranking test(s)\n\n");
+        printf("externalsort: Run out-of-core sort test(s)\n\n");
+        printf("sparseconvert: Run sparse matrix conversion and transpose test(s)\n\n");
+        printf("eulertour: Run Euler tour, depth, preorder and subtree size test(s)\n\n");
+        printf("histogram: Run device and host histogram test(s)\n\n");
+        printf("rle: Run device and host run-length encoding test(s)\n\n");
+        printf("reducebykey: Run device and host reduce by key and unique test(s)\n\n");
+        printf("large: Run scan, reduce, compact and radix sort on more than 2^32 "
+               "elements (not part of all; needs a large device)\n\n");
         printf("--- Global Options ---\n");
         printf("iterations=<N>: Number of times to run each test\n");
         printf("n=<N>: Number of values to use in a single test\n");
@@ -335,6 +371,9 @@ int main(int argc, const char** argv)
         printf("backward: Run backward sorts (DOES NOT WORK YET)\n");
         printf("--- Sparse Matrix-Vector Multiply Options ---\n");
         printf("mat=<File Name>: File containing sparse matrix in Matrix Market format\n");
+        printf("                 or the binary format written with --cache\n");
+        printf("cache=<File Name>: Write the --mat matrix to File Name in binary format\n");
+        printf("                 (if omitted, generated matrices are tested)\n");
         printf("--- Rand Options ---\n");
         printf("dir=<directory>: Directory containing all the random number regression tests\n");
     }
@@ -349,30 +388,20 @@ int main(int argc, const char** argv)
     bool runMergeSort = runAll || checkCommandLineFlag(argc, argv, "mergesort");
     bool runStringSort = runAll || checkCommandLineFlag(argc, argv, "stringsort");
     bool runRand = runAll || checkCommandLineFlag(argc, argv, "rand");
-    bool runSpmv = checkCommandLineFlag(argc, argv, "spmv");
+    bool runSpmv = runAll || checkCommandLineFlag(argc, argv, "spmv");
+    bool runSparseConvert = runAll || checkCommandLineFlag(argc, argv, "sparseconvert");
+    bool runEulerTour = runAll || checkCommandLineFlag(argc, argv, "eulertour");
+    bool runHistogram = runAll || checkCommandLineFlag(argc, argv, "histogram");
+    bool runRle = runAll || checkCommandLineFlag(argc, argv, "rle");
+    bool runReduceByKey = runAll || checkCommandLineFlag(argc, argv, "reducebykey");
     bool runTridiagonal = runAll ||  checkCommandLineFlag(argc, argv, "tridiagonal");
     bool runMtf = runAll || checkCommandLineFlag(argc, argv, "mtf");
     bool runListRank = runAll || checkCommandLineFlag(argc, argv, "listrank");
-    if (!supports48KBInShared && runMtf)
-    {
-        fprintf(stderr, "MTF is only supported on devices with "
-                "compute capability 2.0+\n");
-        runMtf = false;
-    }
+    bool runExternalSort = runAll || checkCommandLineFlag(argc, argv, "externalsort");
+    bool runLargeArrays = checkCommandLineFlag(argc, argv, "large");
     bool runBwt = runAll || checkCommandLineFlag(argc, argv, "bwt");
-    if (!supports48KBInShared && runBwt)
-    {
-        fprintf(stderr, "BWT is only supported on devices with "
-                "compute capability 2.0+\n");
-        runBwt = false;
-    }
     bool runCompress = runAll || checkCommandLineFlag(argc, argv, "compress");
-    if (!supports48KBInShared && runCompress)
-    {
-        fprintf(stderr, "Compress is only supported on devices with "
-                "compute capability 2.0+\n");
-        runCompress = false;
-    }
+    bool runHuffman = runAll || checkCommandLineFlag(argc, argv, "huffman");
     
     bool hasopts = hasOptions(argc, argv);
 
@@ -391,7 +420,9 @@ int main(int argc, const char** argv)
         if (runMtf)       retval += testMtf(argc, argv, NULL);
         if (runBwt)       retval += testBwt(argc, argv, NULL);
         if (runCompress)  retval += testCompress(argc, argv, NULL);
+        if (runHuffman)   retval += testHuffman(argc, argv, NULL);
         if (runListRank)  retval += testListRank(argc, argv, NULL);
+        if (runExternalSort) retval += testExternalSort(argc, argv, NULL);
     }
     else
     {
@@ -461,11 +492,33 @@ int main(int argc, const char** argv)
             retval += testAllDatatypes(argc, argv, config, supportsDouble, false);
         }
 
+        if (runHuffman) {
+            config.algorithm = CUDPP_HUFFMAN;
+            retval += testAllDatatypes(argc, argv, config, supportsDouble, false);
+        }
+
         if (runListRank) {
             config.algorithm = CUDPP_LISTRANK;
             retval += testAllDatatypes(argc, argv, config, supportsDouble, false);
         }
 
+        if (runExternalSort) {
+            CUDPPDatatype types[] = { CUDPP_UINT, CUDPP_FLOAT, CUDPP_ULONGLONG };
+            config.algorithm = CUDPP_SORT_RADIX;
+            for (int t = 0; t < 3; t++)
+            {
+                config.datatype = types[t];
+                config.options = CUDPP_OPTION_KEY_VALUE_PAIRS | CUDPP_OPTION_FORWARD;
+                retval += testExternalSort(argc, argv, &config);
+                config.options = CUDPP_OPTION_KEYS_ONLY | CUDPP_OPTION_BACKWARD;
+                retval += testExternalSort(argc, argv, &config);
+            }
+            config.algorithm = CUDPP_SORT_MERGE;
+            config.datatype = CUDPP_UINT;
+            config.options = CUDPP_OPTION_KEY_VALUE_PAIRS | CUDPP_OPTION_FORWARD;
+            retval += testExternalSort(argc, argv, &config);
+        }
+
     }
 
     if (runSpmv)
@@ -473,10 +526,40 @@ int main(int argc, const char** argv)
         retval += testSparseMatrixVectorMultiply(argc, argv);
     }    
 
+    if (runSparseConvert)
+    {
+        retval += testSparseConvert(argc, argv);
+    }
+
+    if (runEulerTour)
+    {
+        retval += testEulerTour(argc, argv);
+    }
+
+    if (runHistogram)
+    {
+        retval += testHistogram(argc, argv);
+    }
+
+    if (runRle)
+    {
+        retval += testRunLength(argc, argv);
+    }
+
+    if (runReduceByKey)
+    {
+        retval += testReduceByKey(argc, argv);
+    }
+
+    if (runLargeArrays)
+    {
+        retval += testLargeArrays(argc, argv);
+    }
+
     if (runRand)
     {
-        //in the future we need to add so that it tests other random numbers as well
         retval += testRandMD5(argc, argv);
+        retval += testRandPhilox(argc, argv);
     }
 
     if (retval)
@@ -50,6 +50,10 @@ void setOptions(int argc, const char **argv, testrigOptions &testOptions)
         testOptions.algorithm = "bwt";
     else if (checkCommandLineFlag(argc, argv, "compress"))
         testOptions.algorithm = "compress";
+    else if (checkCommandLineFlag(argc, argv, "huffman"))
+        testOptions.algorithm = "huffman";
+    else if (checkCommandLineFlag(argc, argv, "externalsort"))
+        testOptions.algorithm = "externalsort";
             
     testOptions.op = "sum";
     commandLineArg(testOptions.op, argc, argv, "op");
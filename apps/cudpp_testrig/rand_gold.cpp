@@ -12,7 +12,7 @@
  * @file
  * rand_gold.cu
  *
- * @brief Host testrig routines to execute MD5
+ * @brief Host testrig routines to execute MD5 and Philox
  */
 
 #include <math.h>
@@ -301,5 +301,99 @@ namespace testrig {
 
         printf("\n\n");
     }//end randMD5CPUDispatch
-}
 
+    /** Philox4x32-10, independent host implementation of the Random123 reference */
+    void philox4x32CPU(unsigned int ctr[4], unsigned int key0, unsigned int key1)
+    {
+        for (int r = 0; r < 10; r++)
+        {
+            unsigned long long p0 = (unsigned long long)0xD2511F53U * ctr[0];
+            unsigned long long p1 = (unsigned long long)0xCD9E8D57U * ctr[2];
+            unsigned int n0 = (unsigned int)(p1 >> 32) ^ ctr[1] ^ key0;
+            unsigned int n1 = (unsigned int)p1;
+            unsigned int n2 = (unsigned int)(p0 >> 32) ^ ctr[3] ^ key1;
+            unsigned int n3 = (unsigned int)p0;
+            ctr[0] = n0; ctr[1] = n1; ctr[2] = n2; ctr[3] = n3;
+            key0 += 0x9E3779B9U;
+            key1 += 0xBB67AE85U;
+        }
+    }
+
+    void philoxValuesCPU(const unsigned int r[4], unsigned int *v, int /*dist*/)
+    {
+        for (int i = 0; i < 4; i++)
+            v[i] = r[i];
+    }
+
+    void philoxValuesCPU(const unsigned int r[4], float *v, int dist)
+    {
+        for (int i = 0; i < 4; i++)
+            v[i] = ((r[i] >> 8) + 1) * (1.0f / 16777216.0f);
+        if (dist == 1)
+        {
+            for (int i = 0; i < 4; i += 2)
+            {
+                float rad = sqrtf(-2.0f * logf(v[i]));
+                float theta = 6.2831853071795865f * v[i+1];
+                v[i]   = rad * cosf(theta);
+                v[i+1] = rad * sinf(theta);
+            }
+        }
+        else if (dist == 2)
+        {
+            for (int i = 0; i < 4; i++)
+                v[i] = -logf(v[i]);
+        }
+    }
+
+    void philoxValuesCPU(const unsigned int r[4], double *v, int dist)
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            unsigned long long x = ((unsigned long long)(r[2*i] >> 11) << 32) | r[2*i+1];
+            v[i] = (x + 1) * (1.0 / 9007199254740992.0);
+        }
+        if (dist == 1)
+        {
+            double rad = sqrt(-2.0 * log(v[0]));
+            double theta = 6.2831853071795865 * v[1];
+            v[0] = rad * cos(theta);
+            v[1] = rad * sin(theta);
+        }
+        else if (dist == 2)
+        {
+            v[0] = -log(v[0]);
+            v[1] = -log(v[1]);
+        }
+    }
+
+    /**
+     * Generates elements [offset, offset + numElements) of the Philox stream
+     * with key (seed, stream), with the same layout as cudppRand:
+     * dist is 0 (uniform / raw bits), 1 (normal) or 2 (exponential).
+     */
+    template <typename T>
+    void randPhiloxCPU(T *data, size_t numElements, unsigned long long offset,
+                       unsigned int seed, unsigned int stream, int dist)
+    {
+        const unsigned int V = 16 / sizeof(T);
+        T v[4];
+        for (size_t i = 0; i < numElements; )
+        {
+            unsigned long long e = offset + i;
+            unsigned long long block = e / V;
+            unsigned int ctr[4] = { (unsigned int)block, (unsigned int)(block >> 32), 0, 0 };
+            philox4x32CPU(ctr, seed, stream);
+            philoxValuesCPU(ctr, v, dist);
+            for (unsigned int j = (unsigned int)(e % V); j < V && i < numElements; j++)
+                data[i++] = v[j];
+        }
+    }
+
+    template void randPhiloxCPU<unsigned int>(unsigned int*, size_t, unsigned long long,
+                                              unsigned int, unsigned int, int);
+    template void randPhiloxCPU<float>(float*, size_t, unsigned long long,
+                                       unsigned int, unsigned int, int);
+    template void randPhiloxCPU<double>(double*, size_t, unsigned long long,
+                                        unsigned int, unsigned int, int);
+}
@@ -202,6 +202,26 @@ int compactTest(int argc, const char **argv,
                 printf("test %s\n", result ? "PASSED" : "FAILED");
             }
         }
+
+        // a partition with the same plan writes the invalid elements too,
+        // after the valid ones
+        size_t c_numPartitionValid =
+            partitionGold( reference, h_data, h_isValid, test[k], config);
+        CUDA_SAFE_CALL( cudaMemset(d_odata, 0, sizeof(T) * test[k]));
+        cudppPartition(plan, d_odata, d_numValid, d_idata, d_isValid, test[k]);
+        CUDA_SAFE_CALL( cudaMemcpy(&numValidElements, d_numValid, sizeof(size_t), 
+                                   cudaMemcpyDeviceToHost) );
+        T* p_data = (T*) malloc( sizeof(T) * test[k]);
+        CUDA_SAFE_CALL(cudaMemcpy(p_data, d_odata, sizeof(T) * test[k],
+                                  cudaMemcpyDeviceToHost));
+        bool partitioned = (c_numPartitionValid == numValidElements) &&
+            compareArrays( reference, p_data, test[k], 0.001f);
+        free(p_data);
+
+        retval += partitioned ? 0 : 1;
+        if (!quiet)
+            printf("partition test %s\n", partitioned ? "PASSED" : "FAILED");
+
         if (!quiet)
         {
             printf("Average execution time: %f ms\n",
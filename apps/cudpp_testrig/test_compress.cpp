@@ -19,6 +19,10 @@
 #include <iostream>
 #include <cuda_runtime_api.h>
 #include <time.h>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
 
 #include "cudpp.h"
 #include "cudpp_testrig_options.h"
@@ -28,55 +32,12 @@
 #include "commandline.h"
 #include "comparearrays.h"
 
-#define NONE    -1
-#define NUM_CHARS           257     /* 256 bytes + EOF */
-#define EOF_CHAR    (NUM_CHARS - 1) /* index used for EOF */
-#define COMPOSITE_NODE      -1      /* node represents multiple characters */
-#define THREADS_PER_BLOCK 128
-#define WORK_PER_THREAD 32
-#define BLOCK_CHARS (THREADS_PER_BLOCK*WORK_PER_THREAD)
-
-typedef struct my_huffman_node_t
-{
-    int value;          /* character(s) represented by this entry */
-    unsigned int count;      /* number of occurrences of value (probability) */
-
-    char ignore;        /* TRUE -> already handled or no need to handle */
-    int level;          /* depth in tree (root is 0) */
-    unsigned int iter;
-    int left, right, parent;
-} my_huffman_node_t;
-
 using namespace cudpp_app;
 unsigned int blockSize;
 unsigned char *block;
 
 #define Wrap(value, limit) (((value) < (limit)) ? (value) : ((value) - (limit)))
 
-int FindMinimumCountTest(my_huffman_node_t* ht, int elements)
-{
-    int i;                          // array index
-    int currentIndex = NONE;        // index with lowest count seen so far
-    int currentCount = INT_MAX;     // lowest count seen so far
-    int currentLevel = INT_MAX;     // level of lowest count seen so far
-
-    // sequentially search array
-    for (i = 0; i < elements; i++)
-    {
-        // check for lowest count (or equally as low, but not as deep)
-        if( (!ht[i].ignore) &&
-            (ht[i].count < (unsigned int)currentCount ||
-             (ht[i].count == currentCount && ht[i].level < currentLevel)) )
-        {
-            currentIndex = i;
-            currentCount = ht[i].count;
-            currentLevel = ht[i].level;
-        }
-    }
-
-    return currentIndex;
-}
-
 int ComparePresorted(const void *s1, const void *s2)
 {
     int offset1, offset2;
@@ -225,6 +186,36 @@ void computeBwtGold(unsigned char *block_out, int &s0Idx,
     delete [] offsetTable;
 }
 
+/** Check a BWT index by inverting the transform: starting from the row
+ *  of the index, each step to the previous character of the input is a
+ *  stable sort of the transformed characters. */
+bool checkBwtIndex(const unsigned char *bwtOut, int bwtIndex,
+                   const unsigned char *input, unsigned int numElements)
+{
+    if (bwtIndex < 0 || (unsigned int)bwtIndex >= numElements)
+        return false;
+
+    unsigned int counts[256] = {0};
+    std::vector<unsigned int> prev(numElements);
+    for (unsigned int i = 0; i < numElements; i++)
+        counts[bwtOut[i]]++;
+    unsigned int offsets[256];
+    offsets[0] = 0;
+    for (int c = 1; c < 256; c++)
+        offsets[c] = offsets[c - 1] + counts[c - 1];
+    for (unsigned int i = 0; i < numElements; i++)
+        prev[i] = offsets[bwtOut[i]]++;
+
+    unsigned int row = bwtIndex;
+    for (unsigned int i = numElements; i > 0; i--)
+    {
+        if (bwtOut[row] != input[i - 1])
+            return false;
+        row = prev[row];
+    }
+    return true;
+}
+
 void computeMtfGold( unsigned char* out, const unsigned char* idata, 
                      const unsigned int len)
 {
@@ -259,174 +250,131 @@ void computeMtfGold( unsigned char* out, const unsigned char* idata,
     delete [] list;
 }
 
-void huffman_build_tree_cpu(my_huffman_node_t* tree, unsigned int nNodes, 
-                            int &head)
+/** Decode a canonical Huffman stream bit by bit, independently of the
+ *  library's decoders.  Codes are assigned in order of length, then of
+ *  symbol, and each sub-block of ::CUDPP_HUFFMAN_SUBBLOCK_SIZE symbols 
+ *  starts on the word given by \a offsets, most significant bit first.
+ *  Returns false if a code does not decode or a sub-block overruns. */
+template <class T>
+bool huffmanDecodeGold(T                   *out,
+                       const unsigned int  *compressed,
+                       const unsigned char *codeLengths,
+                       const unsigned int  *offsets,
+                       size_t              numElements,
+                       unsigned int        alphabetSize)
 {
-    int min1, min2;     // two nodes with the lowest count
-
-    // keep looking until no more nodes can be found
-    for (;;)
+    // (length, code) -> symbol
+    std::map<std::pair<unsigned int, unsigned int>, unsigned int> codes;
+    unsigned int code = 0;
+    for (unsigned int len = 1; len <= CUDPP_HUFFMAN_MAX_CODE_LENGTH; ++len)
     {
-        // find node with lowest count
-        min1 = FindMinimumCountTest(&tree[0], nNodes);
-        if (min1 == NONE) break; // No more nodes to combine
-
-        tree[min1].ignore = 1;    // remove from consideration
-
-        // find node with second lowest count
-        min2 = FindMinimumCountTest(&tree[0], nNodes);
-        if (min2 == NONE) break; // No more nodes to combine
-
-        // Move min1 to the next available slots
-        tree[min1].ignore = 0;
-        unsigned char min1_replacement = 0;
-
-        for(int i = (int)nNodes; i<(NUM_CHARS*2-1); i++)
+        for (unsigned int s = 0; s < alphabetSize; ++s)
         {
-            if(tree[i].count==0)
-            {
-                tree[i] = tree[min1];
-                tree[i].iter = (unsigned int)i;
-                tree[i].ignore = 1;
-                tree[i].parent = tree[min1].iter;
-
-                if(tree[i].left >= 0)
-                    tree[tree[i].left].parent = i;
-                if(tree[i].right >= 0)
-                    tree[tree[i].right].parent = i;
-
-                tree[min1].left = i;
-
-                min1_replacement = 1;
-                break;
-            }
+            if (codeLengths[s] == len)
+                codes[std::make_pair(len, code++)] = s;
         }
+        code <<= 1;
+    }
 
-        if(min1_replacement == 0)
+    size_t numSubBlocks = 
+        (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+    for (size_t b = 0; b < numSubBlocks; ++b)
+    {
+        size_t bit = 32 * (size_t)offsets[b];
+        size_t endBit = 32 * (size_t)offsets[b + 1];
+        size_t end = std::min(numElements, (b + 1) * CUDPP_HUFFMAN_SUBBLOCK_SIZE);
+        for (size_t i = b * CUDPP_HUFFMAN_SUBBLOCK_SIZE; i < end; ++i)
         {
-            printf("ERROR: Tree size too small\n");
-            break;
+            unsigned int len = 0;
+            code = 0;
+            std::map<std::pair<unsigned int, unsigned int>, unsigned int>::const_iterator it;
+            do
+            {
+                if (bit == endBit || len == CUDPP_HUFFMAN_MAX_CODE_LENGTH)
+                    return false;
+                code = (code << 1) | ((compressed[bit / 32] >> (31 - bit % 32)) & 1);
+                ++bit;
+                ++len;
+                it = codes.find(std::make_pair(len, code));
+            } while (it == codes.end());
+            out[i] = (T)it->second;
         }
-
-        tree[min2].ignore = 1;
-
-        // Combines both nodes into composite node
-        tree[min1].value = COMPOSITE_NODE;
-        tree[min1].ignore = 0;
-        tree[min1].count = tree[min1].count + tree[min2].count;
-        tree[min1].level = max(tree[min1].level, tree[min2].level) + 1;
-
-        tree[min1].right = tree[min2].iter;
-        tree[min2].parent =  tree[min1].iter;
-        tree[min1].parent = -1;
     }
-
-    head = min1;
+    return true;
 }
 
-void computeCompressGold(unsigned char* reference,
-                         int h_bwtIndex,
-                         unsigned int* h_hist,
-                         unsigned int* h_encodeOffset,
-                         size_t h_compressedSize,
-                         unsigned int* h_compressed,
-                         size_t numElements)
+/** Size in bits of an optimal code for \a histogram whose codes are at 
+ *  most ::CUDPP_HUFFMAN_MAX_CODE_LENGTH bits.  Package-merge on weights 
+ *  alone: the lightest 2n - 2 items of the final list, packages counted
+ *  at their total weight, cost exactly the optimal code. */
+unsigned long long huffmanCostGold(const std::vector<unsigned int> &histogram)
 {
-    // Host tree
-    my_huffman_node_t* h_huffmanArray = new my_huffman_node_t[NUM_CHARS*2-1];
-    int head;
-    
-    // Set all iterations of the tree
-    unsigned int nNodes = 0;
-    for(int j=0; j<NUM_CHARS; j++) {
-        h_huffmanArray[j].iter = (unsigned int)j;
-        h_huffmanArray[j].value = j;
-        h_huffmanArray[j].ignore = true;      // will be FALSE if one is found
-        h_huffmanArray[j].count = 0;
-        h_huffmanArray[j].level = 0;
-        h_huffmanArray[j].left = -1;
-        h_huffmanArray[j].right = -1;
-        h_huffmanArray[j].parent = -1;
-    }
-    for(int j=NUM_CHARS; j<NUM_CHARS*2-1; j++) {
-        h_huffmanArray[j].iter = (unsigned int)j;
-        h_huffmanArray[j].value = 0;
-        h_huffmanArray[j].ignore = true;      // will be FALSE if one is found
-        h_huffmanArray[j].count = 0;
-        h_huffmanArray[j].level = 0;
-        h_huffmanArray[j].left = -1;
-        h_huffmanArray[j].right = -1;
-        h_huffmanArray[j].parent = -1;
-    }
-
-    h_hist[EOF_CHAR] = 1;
-    for(int j=0; j<(NUM_CHARS); j++)
-    {
-        if(h_hist[j] > 0)
-        {
-            h_huffmanArray[nNodes].count = h_hist[j];
-            h_huffmanArray[nNodes].ignore = 0;
-            h_huffmanArray[nNodes].value = j;
-            nNodes++;
-        }
+    std::vector<unsigned long long> leaves;
+    for (size_t s = 0; s < histogram.size(); ++s)
+    {
+        if (histogram[s] > 0)
+            leaves.push_back(histogram[s]);
     }
 
-    huffman_build_tree_cpu(h_huffmanArray, nNodes, head);
+    // a single symbol still takes one bit
+    if (leaves.size() <= 1)
+        return leaves.empty() ? 0 : leaves[0];
 
-    for(int i=0; i<256; i++)
+    std::sort(leaves.begin(), leaves.end());
+    std::vector<unsigned long long> items(leaves), packages;
+    for (int d = 1; d < CUDPP_HUFFMAN_MAX_CODE_LENGTH; ++d)
     {
-        unsigned int my_offset = h_encodeOffset[i];
-        unsigned char buffer = 32;
-        unsigned int section = 1+my_offset;
-        unsigned int n_found_chars = 0;
-        unsigned char c=0;
-        unsigned int encoded_val = h_compressed[section];
+        packages.clear();
+        for (size_t i = 0; i + 1 < items.size(); i += 2)
+            packages.push_back(items[i] + items[i + 1]);
+        items.resize(leaves.size() + packages.size());
+        std::merge(leaves.begin(), leaves.end(), packages.begin(), packages.end(),
+                   items.begin());
+    }
 
-        int currentNode = head;
+    unsigned long long cost = 0;
+    for (size_t i = 0; i < 2 * leaves.size() - 2; ++i)
+        cost += items[i];
+    return cost;
+}
 
-        while(n_found_chars < BLOCK_CHARS)
+/** Check that \a codeLengths give every symbol of \a histogram a code of
+ *  at most ::CUDPP_HUFFMAN_MAX_CODE_LENGTH bits, and no other symbol a
+ *  code, and that their Kraft sum is 1, or 1/2 for a single symbol. */
+bool huffmanLengthsGold(const unsigned char             *codeLengths,
+                        const std::vector<unsigned int> &histogram)
+{
+    const unsigned int L = CUDPP_HUFFMAN_MAX_CODE_LENGTH;
+    unsigned long long kraft = 0; // in units of 2^-L
+    unsigned int numSymbols = 0;
+    for (size_t s = 0; s < histogram.size(); ++s)
+    {
+        if ((histogram[s] > 0) != (codeLengths[s] > 0) || codeLengths[s] > L)
+            return false;
+        if (codeLengths[s] > 0)
         {
-            buffer--;
-            c = (encoded_val >> buffer) & 0x00000001;
-
-            if(buffer == 0) {
-                buffer = 32;
-                section++;
-                encoded_val = h_compressed[section];
-            }
-
-            // traverse the tree finding matches for our characters
-            if (c != 0)
-            {
-                currentNode = h_huffmanArray[currentNode].right;
-            }
-            else
-            {
-                currentNode = h_huffmanArray[currentNode].left;
-            }
-
-            if (h_huffmanArray[currentNode].value != COMPOSITE_NODE)
-            {
-                // we've found a character
-                if (h_huffmanArray[currentNode].value == EOF_CHAR)
-                {
-                    // we've just read the EOF
-                    currentNode = head;
-                    break;
-                }
-
-                // write out character
-                reference[i*BLOCK_CHARS+n_found_chars] = 
-                    (unsigned char)h_huffmanArray[currentNode].value;
-
-                n_found_chars++;
-
-                // back to top of tree
-                currentNode = head;
-            }
+            kraft += 1ull << (L - codeLengths[s]);
+            numSymbols++;
         }
-
     }
+    if (numSymbols == 0)
+        return true;
+    return kraft == ((numSymbols == 1) ? (1ull << (L - 1)) : (1ull << L));
+}
+
+/** Decompress the output of cudppCompress on the host: decode the
+ *  Huffman stream with huffmanDecodeGold(), then invert the MTF and the 
+ *  BWT. */
+bool computeCompressGold(unsigned char* reference,
+                         int h_bwtIndex,
+                         const unsigned char* h_codeLengths,
+                         const unsigned int* h_encodeOffset,
+                         const unsigned int* h_compressed,
+                         size_t numElements)
+{
+    if (!huffmanDecodeGold(reference, h_compressed, h_codeLengths, h_encodeOffset,
+                           numElements, 256))
+        return false;
 
     //Reverse  MTF
     unsigned char* mtfOut = new unsigned char[numElements];
@@ -490,7 +438,6 @@ void computeCompressGold(unsigned char* reference,
     }
 
     // Free
-    delete [] h_huffmanArray;
     delete [] mtfOut;
     delete [] mtfList;
     delete [] h_values;
@@ -498,6 +445,7 @@ void computeCompressGold(unsigned char* reference,
     cudaFree(d_values);
     cudppDestroyPlan(plan);
     cudppDestroy(theCudpp);
+    return true;
 }
 
 int mtfTest(int argc, const char **argv, const CUDPPConfiguration &config,
@@ -509,8 +457,8 @@ int mtfTest(int argc, const char **argv, const CUDPPConfiguration &config,
 
     bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
 
-    unsigned int test[] = {39, 128, 256, 512, 1000, 1024, 1025, 32768, 45537, 65536, 131072,
-        262144, 500001, 524288, 1048577, 1048576, 1048581};
+    unsigned int test[] = {1, 39, 128, 256, 512, 1000, 1024, 1025, 32768, 45537, 65536, 131072,
+        262144, 500001, 524288, 1048577, 1048576, 1048581, 4194305};
     int numTests = sizeof(test) / sizeof(test[0]);
     int numElements = test[numTests-1]; // maximum test size
 
@@ -596,6 +544,30 @@ int mtfTest(int argc, const char **argv, const CUDPPConfiguration &config,
 
         bool result = compareArrays<unsigned char>( reference, o_data, test[k]);
 
+        // the host transforms match the device: the host MTF of the input
+        // is the device output, and its inverse recovers the input
+        unsigned char* h_data = (unsigned char*) malloc( sizeof(unsigned char) * test[k]);
+        bool hostResult = 
+            cudppMoveToFrontTransformHost(h_data, i_data, test[k]) == CUDPP_SUCCESS &&
+            compareArrays<unsigned char>( o_data, h_data, test[k]);
+        hostResult = hostResult &&
+            cudppInverseMoveToFrontTransformHost(h_data, o_data, test[k]) == CUDPP_SUCCESS &&
+            compareArrays<unsigned char>( i_data, h_data, test[k]);
+        if (!hostResult && !quiet)
+            printf("host MTF differs from the device\n");
+        result = result && hostResult;
+        free(h_data);
+
+        // the inverse transform recovers the input
+        CUDA_SAFE_CALL( cudaMemset(d_idata, 0, sizeof(unsigned char) * test[k]) );
+        cudppInverseMoveToFrontTransform(plan, d_odata, d_idata, test[k]);
+        CUDA_SAFE_CALL(cudaMemcpy( o_data, d_idata, sizeof(unsigned char) * test[k],
+            cudaMemcpyDeviceToHost));
+        bool inverseResult = compareArrays<unsigned char>( i_data, o_data, test[k]);
+        if (!inverseResult && !quiet)
+            printf("inverse MTF differs from the input\n");
+        result = result && inverseResult;
+
         free(o_data);
 
         retval += result ? 0 : 1;
@@ -612,6 +584,54 @@ int mtfTest(int argc, const char **argv, const CUDPPConfiguration &config,
             printf("\t%10d\t%0.4f\n", test[k], timer.getTime() / testOptions.numIterations);
     }
 
+    // the output does not depend on the chunk size
+    if (!oneTest)
+    {
+        unsigned int chunkTestSize = 100003;
+        unsigned int chunkSizes[] = {1, 7, 255, 4096, 200000};
+        CUDPPHandle chunkPlan;
+        result = cudppPlan(theCudpp, &chunkPlan, config, chunkTestSize, 1, 0);
+        if (result != CUDPP_SUCCESS)
+        {
+            if (!quiet)
+                fprintf(stderr, "Error creating plan for MTF\n");
+            retval++;
+        }
+        else
+        {
+            VectorSupport<unsigned char>::fillVector(i_data, chunkTestSize, 4.0f);
+            computeMtfGold( reference, i_data, chunkTestSize);
+            CUDA_SAFE_CALL( cudaMemcpy(d_idata, i_data, chunkTestSize, cudaMemcpyHostToDevice) );
+
+            unsigned char* o_data = new unsigned char[chunkTestSize];
+            for (unsigned int c = 0; c < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++c)
+            {
+                bool passed = (cudppMoveToFrontChunkSize(chunkPlan, chunkSizes[c]) == CUDPP_SUCCESS);
+                cudppMoveToFrontTransform(chunkPlan, d_idata, d_odata, chunkTestSize);
+                CUDA_SAFE_CALL(cudaMemcpy( o_data, d_odata, chunkTestSize, cudaMemcpyDeviceToHost));
+                passed = passed && compareArrays<unsigned char>( reference, o_data, chunkTestSize);
+
+                cudppInverseMoveToFrontTransform(chunkPlan, d_odata, d_odata, chunkTestSize);
+                CUDA_SAFE_CALL(cudaMemcpy( o_data, d_odata, chunkTestSize, cudaMemcpyDeviceToHost));
+                passed = passed && compareArrays<unsigned char>( i_data, o_data, chunkTestSize);
+
+                retval += passed ? 0 : 1;
+                if (!quiet)
+                    printf("MTF of %u elements in chunks of %u: test %s\n",
+                           chunkTestSize, chunkSizes[c], passed ? "PASSED" : "FAILED");
+            }
+            delete [] o_data;
+
+            if (cudppMoveToFrontChunkSize(chunkPlan, 0) != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+            {
+                if (!quiet)
+                    printf("cudppMoveToFrontChunkSize accepted a chunk size of 0: test FAILED\n");
+                retval++;
+            }
+            cudppDestroyPlan(chunkPlan);
+        }
+    }
+
     result = cudppDestroyPlan(plan);
     if (result != CUDPP_SUCCESS)
     {
@@ -637,11 +657,22 @@ int bwtTest(int argc, const char **argv, const CUDPPConfiguration &config,
             const testrigOptions &testOptions)
 {
     int retval = 0;
-    int numElements = 1048576; // test size
+
+    cudpp_app::StopWatch timer;
 
     bool quiet = checkCommandLineFlag(argc, argv, "quiet");
-    int numTests = 1;
-    bool oneTest = true;
+
+    unsigned int test[] = {1, 2, 3, 5, 39, 1000, 4096, 65536, 100003, 1048576, 1048577, 4194305};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numElements = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numElements, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numElements;
+    }
 
     // Initialize CUDPP
     CUDPPHandle plan;
@@ -660,8 +691,7 @@ int bwtTest(int argc, const char **argv, const CUDPPConfiguration &config,
     if(result != CUDPP_SUCCESS)
     {
         printf("Error in plan creation\n");
-        retval = numTests;
-        cudppDestroyPlan(plan);
+        retval = (oneTest) ? 1 : numTests;
         cudppDestroy(theCudpp);
         return retval;
     }
@@ -670,18 +700,8 @@ int bwtTest(int argc, const char **argv, const CUDPPConfiguration &config,
     
     // allocate host memory to store the input data
     unsigned char* i_data = new unsigned char[numElements];
-
-    // initialize the input data on the host
-    float range = (float)(sizeof(unsigned char)*8);
-        
-    //VectorSupport<unsigned char>::fillVector(i_data, numElements, range);
-    srand(95835);
-    for(int j = 0; j < numElements; j++)
-    {
-        i_data[j] = (unsigned char)(rand()%245+1);
-    }
-    
     unsigned char* reference = new unsigned char[numElements];
+    unsigned char* o_data = new unsigned char[numElements];
     int ref_index;
 
     // allocate device memory input and output arrays
@@ -693,60 +713,140 @@ int bwtTest(int argc, const char **argv, const CUDPPConfiguration &config,
     CUDA_SAFE_CALL( cudaMalloc( (void **) &d_odata, memSize));
     CUDA_SAFE_CALL( cudaMalloc( (void **) &d_oindex, sizeof(int)));
 
-    CUDA_SAFE_CALL( cudaMemcpy(d_idata, i_data, memSize, 
-                               cudaMemcpyHostToDevice) );
-    CUDA_SAFE_CALL( cudaMemset(d_odata, 0, memSize) );
-
-    char dt[10];
-    strcpy(dt, "uchar");
+    // random text, then inputs with long repeats, which take more rounds
+    // of prefix doubling and have identical rotations
+    const char *inputNames[] = {"random", "low-entropy", "periodic", "constant"};
+    int numInputs = (oneTest) ? 1 : 4;
+    srand(95835);
 
-    if (!quiet)
+    for (int k = 0; k < numTests; ++k)
     {
-        printf("Running a bwt of %d %s elements\n", 
-               numElements, dt);
-        fflush(stdout);
-    }
+        for (int input = 0; input < numInputs; ++input)
+        {
+            unsigned int n = test[k];
+
+            // the gold compares long repeats one character at a time, so
+            // periodic and constant inputs are kept small
+            if (input > 1 && n > 4096)
+                continue;
 
-    block = i_data;
-    computeBwtGold( reference, ref_index, numElements);
+            for (unsigned int j = 0; j < n; j++)
+            {
+                switch (input)
+                {
+                case 0:  i_data[j] = (unsigned char)(rand()%245+1); break;
+                case 1:  i_data[j] = (unsigned char)('a' + rand()%3); break;
+                case 2:  i_data[j] = (unsigned char)("abracad"[j % 7]); break;
+                default: i_data[j] = 'z'; break;
+                }
+            }
 
-    // Run the BWT
-    // run once to avoid timing startup overhead.
-    result = cudppBurrowsWheelerTransform(plan, d_idata, d_odata, d_oindex, 
-                                          (unsigned int)numElements);
+            if (!quiet)
+            {
+                printf("Running a bwt of %u %s uchar elements\n", n, inputNames[input]);
+                fflush(stdout);
+            }
 
-    if (result != CUDPP_SUCCESS)
-    {   
-        if(!quiet)
-            printf("Error destroying cudppBurrowsWheelerTransform for BWT\n");
-        retval = numTests;
-    }
+            block = i_data;
+            computeBwtGold( reference, ref_index, n);
 
-    // copy result from device to host
-    unsigned char* o_data = new unsigned char[numElements];
-    int o_index;
-    CUDA_SAFE_CALL(cudaMemcpy( o_data, d_odata, memSize, 
-                               cudaMemcpyDeviceToHost));
-    CUDA_SAFE_CALL(cudaMemcpy( &o_index, d_oindex, sizeof(int), 
-                               cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL( cudaMemcpy(d_idata, i_data, n, cudaMemcpyHostToDevice) );
+            CUDA_SAFE_CALL( cudaMemset(d_odata, 0, n) );
+
+            // Run the BWT
+            // run once to avoid timing startup overhead.
+            result = cudppBurrowsWheelerTransform(plan, d_idata, d_odata, d_oindex, n);
+
+            timer.reset();
+            timer.start();
+            for (int i = 0; i < testOptions.numIterations; i++)
+            {
+                cudppBurrowsWheelerTransform(plan, d_idata, d_odata, d_oindex, n);
+            }
+            cudaThreadSynchronize();
+            timer.stop();
+
+            int o_index;
+            CUDA_SAFE_CALL(cudaMemcpy( o_data, d_odata, n, cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy( &o_index, d_oindex, sizeof(int), 
+                                       cudaMemcpyDeviceToHost));
+
+            // identical rotations may sort in any order, so the index is
+            // checked by inverting the transform
+            bool passed = (result == CUDPP_SUCCESS) &&
+                compareArrays<unsigned char>( reference, o_data, n) &&
+                checkBwtIndex(o_data, o_index, i_data, n);
+
+            // the transform may be done in place
+            if (passed && input == 0)
+            {
+                cudppBurrowsWheelerTransform(plan, d_idata, d_idata, d_oindex, n);
+                CUDA_SAFE_CALL(cudaMemcpy( o_data, d_idata, n, cudaMemcpyDeviceToHost));
+                passed = compareArrays<unsigned char>( reference, o_data, n);
+                if (!passed && !quiet)
+                    printf("in-place bwt differs\n");
+            }
+
+            // the host transform matches the device, and transforms
+            // blocks independently
+            if (passed)
+            {
+                int hostIndex[3];
+                result = cudppBurrowsWheelerTransformHost(o_data, hostIndex, i_data, n, 0);
+                passed = (result == CUDPP_SUCCESS) &&
+                    compareArrays<unsigned char>( reference, o_data, n) &&
+                    checkBwtIndex(o_data, hostIndex[0], i_data, n);
+
+                unsigned int hostBlockSize = (n + 2) / 3;
+                if (passed && input == 0)
+                {
+                    result = cudppBurrowsWheelerTransformHost(o_data, hostIndex, i_data,
+                                                              n, hostBlockSize);
+                    passed = (result == CUDPP_SUCCESS);
+                    for (unsigned int b = 0; passed && b * hostBlockSize < n; b++)
+                    {
+                        unsigned int begin = b * hostBlockSize;
+                        unsigned int length = std::min(hostBlockSize, n - begin);
+                        block = i_data + begin;
+                        computeBwtGold( reference + begin, ref_index, length);
+                        passed = compareArrays<unsigned char>( reference + begin,
+                                                               o_data + begin, length) &&
+                            checkBwtIndex(o_data + begin, hostIndex[b], i_data + begin, length);
+                    }
+                }
+                if (!passed && !quiet)
+                    printf("host bwt differs\n");
+            }
+
+            retval += passed ? 0 : 1;
+            if (!quiet)
+            {
+                printf("test %s\n", passed ? "PASSED" : "FAILED");
+                printf("Average execution time: %f ms\n",
+                       timer.getTime() / testOptions.numIterations);
+            }
+            else
+                printf("\t%10u\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+        }
+    }
 
-    // check results
-    bool error = false;
-    for(int i=0; i<numElements; i++)
+    // sizes beyond the plan, or beyond 64 MB, are rejected
+    if (!oneTest)
     {
-        if(o_data[i] != reference[i])
+        result = cudppBurrowsWheelerTransform(plan, d_idata, d_odata, d_oindex, 
+                                              numElements + 1);
+        CUDPPHandle bigPlan;
+        CUDPPResult bigResult = cudppPlan(theCudpp, &bigPlan, config, (1 << 26) + 1, 1, 0);
+        if (bigResult == CUDPP_SUCCESS)
+            cudppDestroyPlan(bigPlan);
+        if (result != CUDPP_ERROR_ILLEGAL_CONFIGURATION || 
+            bigResult != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
         {
-            error = true;
-            retval = 1;
-            break;
+            if (!quiet)
+                printf("bwt accepted an illegal size: test FAILED\n");
+            retval++;
         }
     }
-    if(o_index != ref_index) {
-        error = true;
-        retval = 1;
-    }
-
-    printf("test %s\n", (error) ? "FAILED" : "PASSED");
 
     result = cudppDestroyPlan(plan);
 
@@ -777,11 +877,20 @@ int compressTest(int argc, const char **argv, const CUDPPConfiguration &config,
                  const testrigOptions &testOptions)
 {
     int retval = 0;
-    int numElements = 1048576; // test size
 
     bool quiet = checkCommandLineFlag(argc, argv, "quiet");
-    int numTests = 1;
-    bool oneTest = true;
+
+    unsigned int test[] = {1, 1000, 65537, 1048576, 1048581};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numElements = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numElements, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numElements;
+    }
 
     // Initialize CUDPP
     CUDPPHandle plan;
@@ -800,125 +909,135 @@ int compressTest(int argc, const char **argv, const CUDPPConfiguration &config,
     if(result != CUDPP_SUCCESS)
     {
         printf("Error in plan creation\n");
-        retval = numTests;
-        cudppDestroyPlan(plan);
+        retval = (oneTest) ? 1 : numTests;
         cudppDestroy(theCudpp);
         return retval;
     }
     
+    size_t maxWords = CUDPP_HUFFMAN_MAX_WORDS((size_t)numElements);
+    size_t maxSubBlocks = 
+        (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+
     // allocate host memory to store the input data
     unsigned char* i_data = new unsigned char[numElements];
 
-    // initialize the input data on the host
-    srand(95835);
-    for(int j = 0; j < numElements; j++)
-    {
-        i_data[j] = (unsigned char)(rand()%15+1);
-    }
-
     // host ptrs
     int h_bwtIndex;
-    unsigned int* h_hist = new unsigned int[256];
-    unsigned int* h_encodeOffset = new unsigned int[256];
-    size_t        h_compressedSize = 0;
-    unsigned int* h_compressed = new unsigned int[numElements/4];
+    unsigned char* h_codeLengths = new unsigned char[256];
+    unsigned int* h_encodeOffset = new unsigned int[maxSubBlocks + 1];
+    unsigned int  h_compressedSize = 0;
+    unsigned int* h_compressed = new unsigned int[maxWords];
     unsigned char* reference = new unsigned char[numElements];
 
     // allocate device memory input and output arrays
     unsigned char  *d_uncompressed;         // user provides
-    int            *d_bwtIndex;             // sizeof(uint)
+    int            *d_bwtIndex;             // sizeof(int)
     unsigned int   *d_histSize;             // ignored
-    unsigned int   *d_hist;                 // 256*sizeof(uint)
-    unsigned int   *d_encodeOffset;         // 256*sizeof(uint)
+    unsigned char  *d_codeLengths;          // 256*sizeof(uchar)
+    unsigned int   *d_encodeOffset;         // (sub-blocks+1)*sizeof(uint)
     unsigned int   *d_compressedSize;       // sizeof(uint)
-    unsigned int   *d_compressed;           // d_compressedSize*sizeof(uint)
+    unsigned int   *d_compressed;           // CUDPP_HUFFMAN_MAX_WORDS(n)*sizeof(uint)
 
     CUDA_SAFE_CALL(cudaMalloc( (void**)&d_uncompressed, 
                                numElements*sizeof(unsigned char) ));
     CUDA_SAFE_CALL(cudaMalloc( (void**)&d_bwtIndex, sizeof(int) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**)&d_hist, 256*sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaMalloc( (void**)&d_codeLengths, 256*sizeof(unsigned char) ));
     CUDA_SAFE_CALL(cudaMalloc( (void**)&d_encodeOffset, 
-                               256*sizeof(unsigned int) ));
+                               (maxSubBlocks + 1)*sizeof(unsigned int) ));
     CUDA_SAFE_CALL(cudaMalloc( (void**)&d_compressedSize, 
                                sizeof(unsigned int) ));
     CUDA_SAFE_CALL(cudaMalloc( (void**)&d_compressed, 
-                               (1536+1)*256*sizeof(unsigned int) ));
+                               maxWords*sizeof(unsigned int) ));
     d_histSize = (unsigned int*)NULL;
 
-    CUDA_SAFE_CALL(cudaMemcpy(d_uncompressed, i_data, 
-                              numElements*sizeof(unsigned char), 
-                              cudaMemcpyHostToDevice));
-
-    char dt[10];
-    strcpy(dt, "uchar");
+    srand(95835);
 
-    if (!quiet)
+    for (int k = 0; k < numTests; ++k)
     {
-        printf("Running a compress of %d %s elements\n", 
-               numElements, dt);
-        fflush(stdout);
-    }
+        unsigned int n = test[k];
+
+        // initialize the input data on the host
+        for (unsigned int j = 0; j < n; j++)
+        {
+            i_data[j] = (unsigned char)(rand()%15+1);
+        }
+
+        CUDA_SAFE_CALL(cudaMemcpy(d_uncompressed, i_data, 
+                                  n*sizeof(unsigned char), 
+                                  cudaMemcpyHostToDevice));
 
-    // clear buffers
-    CUDA_SAFE_CALL(cudaMemset( (void*)d_encodeOffset, 0,
-                               256*sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMemset( (void*)d_compressedSize, 0,
-                               sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMemset( (void*)d_compressed,  0,
-                               (1536+1)*256*sizeof(unsigned int) ));
-
-    // Run the compression
-    // run once to avoid timing startup overhead.
-    result = cudppCompress(plan, (void*)d_uncompressed, (void*)d_bwtIndex, 
-                           (void*)d_histSize, (void*)d_hist, 
-                           (void*)d_encodeOffset, (void*)d_compressedSize, 
-                           (void*)d_compressed, numElements);
-    
-    if (result != CUDPP_SUCCESS)
-    {
         if (!quiet)
-            printf("Error calling cudppCompress for compression\n");
-        retval = numTests;
-    } else {
-        // Copy from device back to host
-        CUDA_SAFE_CALL(cudaMemcpy(&h_bwtIndex, d_bwtIndex, sizeof(int), 
-                                  cudaMemcpyDeviceToHost));
-        CUDA_SAFE_CALL(cudaMemcpy(h_hist, d_hist, 256*sizeof(unsigned int), 
-                                  cudaMemcpyDeviceToHost));
-        CUDA_SAFE_CALL(cudaMemcpy(h_encodeOffset, d_encodeOffset, 
-                                  256*sizeof(unsigned int), 
-                                  cudaMemcpyDeviceToHost));
-        CUDA_SAFE_CALL(cudaMemcpy(&h_compressedSize, d_compressedSize, 
-                                  sizeof(unsigned int), 
-                                  cudaMemcpyDeviceToHost));
-        CUDA_SAFE_CALL(cudaMemcpy(h_compressed, d_compressed, 
-                                  h_compressedSize*sizeof(unsigned int), 
-                                  cudaMemcpyDeviceToHost));
-
-        // Decompress on the CPU
-        computeCompressGold( reference, h_bwtIndex, h_hist, h_encodeOffset, 
-                             h_compressedSize, h_compressed, numElements);
-    }
-
-    // check results
-    bool error = false;
-    for(int i=0; i<numElements; i++)
-    {
-        if(i_data[i] != reference[i])
         {
-            error = true;
-            retval = 1;
-            break;
+            printf("Running a compress of %u uchar elements\n", n);
+            fflush(stdout);
         }
+
+        // Run the compression
+        result = cudppCompress(plan, (void*)d_uncompressed, (void*)d_bwtIndex, 
+                               (void*)d_histSize, (void*)d_codeLengths, 
+                               (void*)d_encodeOffset, (void*)d_compressedSize, 
+                               (void*)d_compressed, n);
+    
+        bool passed = (result == CUDPP_SUCCESS);
+        if (!passed)
+        {
+            if (!quiet)
+                printf("Error calling cudppCompress for compression\n");
+        } 
+        else 
+        {
+            size_t numSubBlocks = 
+                (n + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+
+            // Copy from device back to host
+            CUDA_SAFE_CALL(cudaMemcpy(&h_bwtIndex, d_bwtIndex, sizeof(int), 
+                                      cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(h_codeLengths, d_codeLengths, 256, 
+                                      cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(h_encodeOffset, d_encodeOffset, 
+                                      (numSubBlocks + 1)*sizeof(unsigned int), 
+                                      cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(&h_compressedSize, d_compressedSize, 
+                                      sizeof(unsigned int), 
+                                      cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(h_compressed, d_compressed, 
+                                      h_compressedSize*sizeof(unsigned int), 
+                                      cudaMemcpyDeviceToHost));
+
+            // Decompress on the CPU
+            passed = (h_compressedSize == h_encodeOffset[numSubBlocks]) &&
+                computeCompressGold( reference, h_bwtIndex, h_codeLengths, 
+                                     h_encodeOffset, h_compressed, n) &&
+                compareArrays<unsigned char>( i_data, reference, n);
+
+            if (!quiet)
+                printf("compressed to %u bytes\n", 4 * h_compressedSize);
+        }
+
+        retval += passed ? 0 : 1;
+        printf("test %s\n", passed ? "PASSED" : "FAILED");
     }
 
-    printf("test %s\n", (error) ? "FAILED" : "PASSED");
+    // sizes beyond the plan are rejected
+    if (!oneTest)
+    {
+        result = cudppCompress(plan, (void*)d_uncompressed, (void*)d_bwtIndex, 
+                               (void*)d_histSize, (void*)d_codeLengths, 
+                               (void*)d_encodeOffset, (void*)d_compressedSize, 
+                               (void*)d_compressed, numElements + 1);
+        if (result != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+        {
+            if (!quiet)
+                printf("cudppCompress accepted more elements than the plan: test FAILED\n");
+            retval++;
+        }
+    }
 
     result = cudppDestroyPlan(plan);
 
     if (result != CUDPP_SUCCESS)
     {   
-        printf("Error destroying CUDPPPlan for MTF\n");
+        printf("Error destroying CUDPPPlan for compress\n");
         retval = numTests;
     }
 
@@ -931,11 +1050,12 @@ int compressTest(int argc, const char **argv, const CUDPPConfiguration &config,
     }
 
     delete [] reference;
-    delete [] h_hist;
+    delete [] h_codeLengths;
     delete [] h_encodeOffset;
     delete [] h_compressed;
     delete [] i_data;
-    CUDA_SAFE_CALL(cudaFree(d_hist));
+    CUDA_SAFE_CALL(cudaFree(d_uncompressed));
+    CUDA_SAFE_CALL(cudaFree(d_codeLengths));
     CUDA_SAFE_CALL(cudaFree(d_encodeOffset));
     CUDA_SAFE_CALL(cudaFree(d_compressedSize));
     CUDA_SAFE_CALL(cudaFree(d_bwtIndex));
@@ -943,6 +1063,258 @@ int compressTest(int argc, const char **argv, const CUDPPConfiguration &config,
     return retval;
 }
 
+template <class T>
+int huffmanTest(int argc, const char **argv, const CUDPPConfiguration &config,
+                const testrigOptions &testOptions)
+{
+    int retval = 0;
+
+    cudpp_app::StopWatch timer;
+
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    unsigned int test[] = {0, 1, 2, 255, 256, 257, 1000, 65536, 100003, 1048576, 4194305};
+    int numTests = sizeof(test) / sizeof(test[0]);
+    int numElements = test[numTests-1]; // maximum test size
+
+    bool oneTest = false;
+    if (commandLineArg(numElements, argc, (const char**) argv, "n"))
+    {
+        oneTest = true;
+        numTests = 1;
+        test[0] = numElements;
+    }
+
+    unsigned int alphabetSize = 1u << (8 * sizeof(T));
+    const char *typeName = datatypeToString(config.datatype);
+
+    // Initialize CUDPP
+    CUDPPHandle plan;
+    CUDPPResult result = CUDPP_SUCCESS;
+    CUDPPHandle theCudpp;
+    result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error initializing CUDPP Library\n");
+        retval = 1;
+        return retval;
+    }
+
+    result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+
+    if(result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        retval = (oneTest) ? 1 : numTests;
+        cudppDestroy(theCudpp);
+        return retval;
+    }
+
+    size_t numAlloc = std::max(numElements, 1);
+    size_t maxWords = CUDPP_HUFFMAN_MAX_WORDS(numAlloc);
+    size_t maxSubBlocks = 
+        (numAlloc + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+
+    std::vector<T> i_data(numAlloc), o_data(numAlloc);
+    std::vector<unsigned int> refCompressed(maxWords), compressed(maxWords);
+    std::vector<unsigned int> refOffsets(maxSubBlocks + 1), offsets(maxSubBlocks + 1);
+    std::vector<unsigned char> refLengths(alphabetSize), lengths(alphabetSize);
+
+    T *d_in, *d_out;
+    unsigned int *d_compressed, *d_offsets;
+    unsigned char *d_lengths;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_in, numAlloc * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_out, numAlloc * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_compressed, maxWords * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_offsets, (maxSubBlocks + 1) * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_lengths, alphabetSize));
+
+    // uniform symbols, then geometric symbols, whose unlimited Huffman 
+    // code is deeper than the length limit on large inputs
+    const char *inputNames[] = {"uniform", "geometric", "constant"};
+    int numInputs = (oneTest) ? 1 : 3;
+    srand(40);
+
+    for (int k = 0; k < numTests; ++k)
+    {
+        for (int input = 0; input < numInputs; ++input)
+        {
+            unsigned int n = test[k];
+            size_t numSubBlocks = 
+                (n + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+
+            std::vector<unsigned int> histogram(alphabetSize, 0);
+            for (unsigned int j = 0; j < n; j++)
+            {
+                unsigned int s = 0;
+                switch (input)
+                {
+                case 0:  
+                    s = (((unsigned int)rand() << 15) ^ rand()) % alphabetSize;
+                    break;
+                case 1:  
+                    while (s < alphabetSize - 1 && (rand() & 1)) 
+                        s++;
+                    break;
+                default: 
+                    s = alphabetSize / 3; 
+                    break;
+                }
+                i_data[j] = (T)s;
+                histogram[s]++;
+            }
+
+            if (!quiet)
+            {
+                printf("Running a huffman encode and decode of %u %s %s elements\n", 
+                       n, inputNames[input], typeName);
+                fflush(stdout);
+            }
+
+            cudppHuffmanEncodeHost(&refCompressed[0], &refLengths[0], &refOffsets[0],
+                                   &i_data[0], n, config.datatype);
+
+            CUDA_SAFE_CALL(cudaMemcpy(d_in, &i_data[0], n * sizeof(T), 
+                                      cudaMemcpyHostToDevice));
+
+            // run once to avoid timing startup overhead.
+            result = cudppHuffmanEncode(plan, d_compressed, d_lengths, d_offsets, d_in, n);
+
+            timer.reset();
+            timer.start();
+            for (int i = 0; i < testOptions.numIterations; i++)
+            {
+                cudppHuffmanEncode(plan, d_compressed, d_lengths, d_offsets, d_in, n);
+            }
+            cudaThreadSynchronize();
+            timer.stop();
+
+            // the device stream is bit-exact with the host encoder
+            CUDA_SAFE_CALL(cudaMemcpy(&lengths[0], d_lengths, alphabetSize, 
+                                      cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(&offsets[0], d_offsets, 
+                                      (numSubBlocks + 1) * sizeof(unsigned int), 
+                                      cudaMemcpyDeviceToHost));
+            bool passed = (result == CUDPP_SUCCESS) && (lengths == refLengths) &&
+                std::equal(offsets.begin(), offsets.begin() + numSubBlocks + 1, 
+                           refOffsets.begin());
+            unsigned int numWords = refOffsets[numSubBlocks];
+            if (passed && numWords > 0)
+            {
+                CUDA_SAFE_CALL(cudaMemcpy(&compressed[0], d_compressed, 
+                                          numWords * sizeof(unsigned int), 
+                                          cudaMemcpyDeviceToHost));
+                passed = std::equal(compressed.begin(), compressed.begin() + numWords,
+                                    refCompressed.begin());
+            }
+            else
+            {
+                // otherwise check the host stream below
+                compressed = refCompressed;
+                offsets = refOffsets;
+                lengths = refLengths;
+            }
+            if (!passed && !quiet)
+                printf("device stream differs from the host encoder\n");
+
+            // the code lengths are a complete prefix code within the limit,
+            // and as short as the optimal length-limited code
+            unsigned long long numBits = 0;
+            for (unsigned int s = 0; s < alphabetSize; ++s)
+                numBits += (unsigned long long)histogram[s] * refLengths[s];
+            unsigned long long optimalBits = huffmanCostGold(histogram);
+            bool optimal = huffmanLengthsGold(&refLengths[0], histogram) && 
+                (numBits == optimalBits);
+            if (!optimal && !quiet)
+                printf("code is not optimal: %llu bits, optimal %llu bits\n", 
+                       numBits, optimalBits);
+            passed = passed && optimal;
+
+            // the stream decodes to the input independently of the library,
+            // and the device and host decoders recover the input
+            if (n > 0)
+            {
+                std::fill(o_data.begin(), o_data.end(), 0);
+                bool decoded = 
+                    huffmanDecodeGold(&o_data[0], &compressed[0], &lengths[0], 
+                                      &offsets[0], n, alphabetSize) &&
+                    std::equal(i_data.begin(), i_data.begin() + n, o_data.begin());
+
+                CUDA_SAFE_CALL(cudaMemset(d_out, 0, n * sizeof(T)));
+                result = cudppHuffmanDecode(plan, d_out, d_compressed, d_lengths, 
+                                            d_offsets, n);
+                CUDA_SAFE_CALL(cudaMemcpy(&o_data[0], d_out, n * sizeof(T), 
+                                          cudaMemcpyDeviceToHost));
+                decoded = decoded && (result == CUDPP_SUCCESS) && 
+                    std::equal(i_data.begin(), i_data.begin() + n, o_data.begin());
+
+                std::fill(o_data.begin(), o_data.end(), 0);
+                result = cudppHuffmanDecodeHost(&o_data[0], &refCompressed[0], 
+                                                &refLengths[0], &refOffsets[0], 
+                                                n, config.datatype);
+                decoded = decoded && (result == CUDPP_SUCCESS) &&
+                    std::equal(i_data.begin(), i_data.begin() + n, o_data.begin());
+                if (!decoded && !quiet)
+                    printf("decoded symbols differ from the input\n");
+                passed = passed && decoded;
+            }
+
+            retval += passed ? 0 : 1;
+            if (!quiet)
+            {
+                printf("%llu bits (%0.3f per symbol): test %s\n", numBits, 
+                       n ? (double)numBits / n : 0.0, passed ? "PASSED" : "FAILED");
+                printf("Average encode time: %f ms\n",
+                       timer.getTime() / testOptions.numIterations);
+            }
+            else
+                printf("\t%10u\t%0.4f\n", n, timer.getTime() / testOptions.numIterations);
+        }
+    }
+
+    // sizes beyond the plan, and code lengths that are not a prefix code,
+    // are rejected
+    if (!oneTest)
+    {
+        CUDA_SAFE_CALL(cudaMemset(d_lengths, 0, alphabetSize));
+        CUDPPResult encodeResult = 
+            cudppHuffmanEncode(plan, d_compressed, d_lengths, d_offsets, d_in,
+                               numElements + 1);
+        CUDPPResult decodeResult = 
+            cudppHuffmanDecode(plan, d_out, d_compressed, d_lengths, d_offsets, 1);
+        if (encodeResult != CUDPP_ERROR_ILLEGAL_CONFIGURATION || 
+            decodeResult != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+        {
+            if (!quiet)
+                printf("huffman accepted an illegal size or code: test FAILED\n");
+            retval++;
+        }
+    }
+
+    result = cudppDestroyPlan(plan);
+
+    if (result != CUDPP_SUCCESS)
+    {   
+        printf("Error destroying CUDPPPlan for Huffman\n");
+        retval = numTests;
+    }
+
+    result = cudppDestroy(theCudpp);
+
+    if (result != CUDPP_SUCCESS)
+    {   
+        printf("Error shutting down CUDPP Library.\n");
+        retval = numTests;
+    }
+
+    cudaFree(d_in);
+    cudaFree(d_out);
+    cudaFree(d_compressed);
+    cudaFree(d_offsets);
+    cudaFree(d_lengths);
+    return retval;
+}
+
 int testMtf(int argc, const char **argv, const CUDPPConfiguration *configPtr)
 {
     testrigOptions testOptions;
@@ -1008,6 +1380,32 @@ int testCompress(int argc, const char **argv,
     return compressTest(argc, argv, config, testOptions);
 }
 
+int testHuffman(int argc, const char **argv, 
+                const CUDPPConfiguration *configPtr)
+{
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_HUFFMAN;
+    config.op = CUDPP_OPERATOR_INVALID;
+    config.options = 0;
+
+    if (configPtr != NULL)
+    {
+        config = *configPtr;
+    }
+    else
+    {
+        config.datatype = checkCommandLineFlag(argc, argv, "ushort") ? 
+            CUDPP_USHORT : CUDPP_UCHAR;
+    }
+
+    if (config.datatype == CUDPP_USHORT)
+        return huffmanTest<unsigned short>(argc, argv, config, testOptions);
+    else
+        return huffmanTest<unsigned char>(argc, argv, config, testOptions);
+}
 
 // Leave this at the end of the file
 // Local Variables:
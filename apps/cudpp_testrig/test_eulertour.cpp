@@ -0,0 +1,341 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_eulertour.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's Euler tour tree functionality.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+#include "cudpp_testrig_options.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace cudpp_app;
+
+/** Shape of a generated forest */
+enum TreeShape
+{
+    TREE_RANDOM, //!< Each node hangs off a random earlier node
+    TREE_FOREST, //!< Random trees, with about 1% of the nodes roots
+    TREE_CHAIN,  //!< A single path, as deep as possible
+    TREE_STAR    //!< One root with every other node a child
+};
+
+const char *treeShapeName(TreeShape shape)
+{
+    switch (shape)
+    {
+    case TREE_RANDOM: return "random tree";
+    case TREE_FOREST: return "random forest";
+    case TREE_CHAIN:  return "chain";
+    case TREE_STAR:   return "star";
+    }
+    return "unknown";
+}
+
+/** Generate the parents of a forest of \a numNodes nodes.  The nodes are
+ *  numbered in a random order, so parents are not smaller than children. */
+void generateForest(std::vector<int> &parent, TreeShape shape, unsigned int numNodes)
+{
+    std::vector<int> order(numNodes);
+    for (unsigned int i = 0; i < numNodes; ++i)
+        order[i] = i;
+    for (unsigned int i = 1; i < numNodes; ++i)
+        std::swap(order[i], order[rand() % (i + 1)]);
+
+    parent.assign(numNodes, -1);
+    for (unsigned int k = 1; k < numNodes; ++k)
+    {
+        int p;
+        switch (shape)
+        {
+        case TREE_FOREST:
+            p = (rand() % 100 == 0) ? -1 : order[rand() % k];
+            break;
+        case TREE_CHAIN:
+            p = order[k - 1];
+            break;
+        case TREE_STAR:
+            p = order[0];
+            break;
+        default:
+            p = order[rand() % k];
+            break;
+        }
+        parent[order[k]] = p;
+    }
+}
+
+/** Walk a forest depth first on the host, visiting children in index
+ *  order and trees in root order, to compute the reference results. */
+void eulerTourGold(std::vector<int> &depth, std::vector<unsigned int> &preorder,
+                   std::vector<unsigned int> &subtreeSize, std::vector<unsigned int> &tour,
+                   const std::vector<int> &parent)
+{
+    unsigned int numNodes = (unsigned int)parent.size();
+    std::vector<std::vector<unsigned int> > children(numNodes);
+    std::vector<unsigned int> roots;
+    for (unsigned int i = 0; i < numNodes; ++i)
+    {
+        if (parent[i] < 0)
+            roots.push_back(i);
+        else
+            children[parent[i]].push_back(i);
+    }
+
+    depth.assign(numNodes, 0);
+    preorder.assign(numNodes, 0);
+    subtreeSize.assign(numNodes, 1);
+    tour.clear();
+
+    // (node, leaving) pairs; an explicit stack, since chains are deep
+    std::vector<std::pair<unsigned int, bool> > stack;
+    unsigned int count = 0;
+    for (size_t r = 0; r < roots.size(); ++r)
+    {
+        stack.push_back(std::make_pair(roots[r], false));
+        while (!stack.empty())
+        {
+            unsigned int v = stack.back().first;
+            bool leaving = stack.back().second;
+            stack.pop_back();
+            tour.push_back(v);
+            if (leaving)
+            {
+                if (parent[v] >= 0)
+                    subtreeSize[parent[v]] += subtreeSize[v];
+                continue;
+            }
+            if (parent[v] >= 0)
+                depth[v] = depth[parent[v]] + 1;
+            preorder[v] = count++;
+            stack.push_back(std::make_pair(v, true));
+            for (size_t c = children[v].size(); c > 0; --c)
+                stack.push_back(std::make_pair(children[v][c - 1], false));
+        }
+    }
+}
+
+/** Compute the Euler tour of a generated forest and check every output */
+int eulerTourTest(CUDPPHandle plan, TreeShape shape, unsigned int numNodes,
+                  const testrigOptions &testOptions, bool quiet)
+{
+    std::vector<int> parent;
+    generateForest(parent, shape, numNodes);
+
+    std::vector<int> refDepth;
+    std::vector<unsigned int> refPreorder, refSubtreeSize, refTour;
+    eulerTourGold(refDepth, refPreorder, refSubtreeSize, refTour, parent);
+
+    size_t numAlloc = std::max(numNodes, 1u);
+    int *d_parent, *d_depth;
+    unsigned int *d_preorder, *d_subtreeSize, *d_tour;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_parent, numAlloc * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_depth, numAlloc * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_preorder, numAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_subtreeSize, numAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_tour, 2 * numAlloc * sizeof(unsigned int)));
+    if (numNodes > 0)
+        CUDA_SAFE_CALL(cudaMemcpy(d_parent, &parent[0], numNodes * sizeof(int),
+                                  cudaMemcpyHostToDevice));
+
+    // run once to avoid timing startup overhead.
+    CUDPPResult result = cudppEulerTour(plan, d_depth, d_preorder, d_subtreeSize,
+                                        d_tour, d_parent, numNodes);
+
+    cudpp_app::StopWatch timer;
+    timer.reset();
+    timer.start();
+    for (int i = 0; i < testOptions.numIterations; i++)
+    {
+        cudppEulerTour(plan, d_depth, d_preorder, d_subtreeSize, d_tour, d_parent, numNodes);
+    }
+    cudaThreadSynchronize();
+    timer.stop();
+
+    int failed = (result != CUDPP_SUCCESS) ? 1 : 0;
+    if (!failed && numNodes > 0)
+    {
+        std::vector<int> depth(numNodes);
+        std::vector<unsigned int> preorder(numNodes), subtreeSize(numNodes), tour(2 * numNodes);
+        CUDA_SAFE_CALL(cudaMemcpy(&depth[0], d_depth, numNodes * sizeof(int),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(&preorder[0], d_preorder, numNodes * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(&subtreeSize[0], d_subtreeSize,
+                                  numNodes * sizeof(unsigned int), cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(&tour[0], d_tour, 2 * numNodes * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+
+        if (depth != refDepth)
+        {
+            failed = 1;
+            if (!quiet) printf("depths differ\n");
+        }
+        if (preorder != refPreorder)
+        {
+            failed = 1;
+            if (!quiet) printf("preorder indices differ\n");
+        }
+        if (subtreeSize != refSubtreeSize)
+        {
+            failed = 1;
+            if (!quiet) printf("subtree sizes differ\n");
+        }
+        if (tour != refTour)
+        {
+            failed = 1;
+            if (!quiet) printf("Euler tours differ\n");
+        }
+    }
+
+    // outputs that are not needed may be null
+    if (!failed && numNodes > 0)
+    {
+        CUDA_SAFE_CALL(cudaMemset(d_depth, 0, numNodes * sizeof(int)));
+        result = cudppEulerTour(plan, d_depth, NULL, NULL, NULL, d_parent, numNodes);
+        std::vector<int> depth(numNodes);
+        CUDA_SAFE_CALL(cudaMemcpy(&depth[0], d_depth, numNodes * sizeof(int),
+                                  cudaMemcpyDeviceToHost));
+        if (result != CUDPP_SUCCESS || depth != refDepth)
+        {
+            failed = 1;
+            if (!quiet) printf("depths differ without the other outputs\n");
+        }
+    }
+
+    if (!quiet)
+    {
+        printf("%s of %u nodes: %f ms: test %s\n", treeShapeName(shape), numNodes,
+               timer.getTime() / testOptions.numIterations, failed ? "FAILED" : "PASSED");
+    }
+    else
+        printf("\t%10u\t%0.4f\n", numNodes, timer.getTime() / testOptions.numIterations);
+
+    CUDA_SAFE_CALL(cudaFree(d_parent));
+    CUDA_SAFE_CALL(cudaFree(d_depth));
+    CUDA_SAFE_CALL(cudaFree(d_preorder));
+    CUDA_SAFE_CALL(cudaFree(d_subtreeSize));
+    CUDA_SAFE_CALL(cudaFree(d_tour));
+
+    return failed;
+}
+
+/**
+ * testEulerTour tests cudpp's Euler tour, depth, preorder and subtree
+ * size computation on generated forests.
+ * Possible command line arguments:
+ * - --n=#, number of nodes (default: a set of sizes)
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppEulerTour
+ */
+int testEulerTour(int argc, const char **argv)
+{
+    int retval = 0;
+    int cmdVal;
+
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    unsigned int test[] = { 0, 1, 2, 33, 1000, 65537, 1000000, 4194305 };
+    unsigned int numTests = sizeof(test) / sizeof(test[0]);
+    unsigned int maxNodes = test[numTests - 1];
+
+    if (commandLineArg(cmdVal, argc, (const char**)argv, "n"))
+    {
+        test[0] = maxNodes = cmdVal;
+        numTests = 1;
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_EULER_TOUR;
+    config.op = CUDPP_OPERATOR_INVALID;
+    config.datatype = CUDPP_INT;
+    config.options = 0;
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, maxNodes, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        cudppDestroy(theCudpp);
+        return 1;
+    }
+
+    TreeShape shapes[] = { TREE_RANDOM, TREE_FOREST, TREE_CHAIN, TREE_STAR };
+    srand(37);
+
+    for (unsigned int k = 0; k < numTests; ++k)
+    {
+        for (unsigned int s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s)
+        {
+            retval += eulerTourTest(plan, shapes[s], test[k], testOptions, quiet);
+        }
+    }
+
+    // sizes beyond the plan are rejected
+    result = cudppEulerTour(plan, NULL, NULL, NULL, NULL, NULL, maxNodes + 1);
+    if (result != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        if (!quiet)
+            printf("cudppEulerTour accepted more nodes than the plan: test FAILED\n");
+        retval++;
+    }
+    printf("\n");
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for Euler tour\n");
+        retval++;
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -0,0 +1,425 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_externalsort.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's out-of-core sort.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+#ifdef WIN32
+#undef min
+#undef max
+#endif
+
+#include <limits>
+
+using namespace cudpp_app;
+
+/** In-memory source and sink for cudppExternalSort callbacks */
+template <typename T>
+struct ExternalSortBuffer
+{
+    T            *keys;
+    unsigned int *values;
+    size_t        numElements;
+    size_t        offset;
+};
+
+template <typename T>
+size_t readExternalSortBuffer(void *userData, void *h_keys,
+                              unsigned int *h_values, size_t maxElements)
+{
+    ExternalSortBuffer<T> *buf = (ExternalSortBuffer<T>*)userData;
+    size_t n = std::min(maxElements, buf->numElements - buf->offset);
+    memcpy(h_keys, buf->keys + buf->offset, n * sizeof(T));
+    if (h_values)
+        memcpy(h_values, buf->values + buf->offset, n * sizeof(unsigned int));
+    buf->offset += n;
+    return n;
+}
+
+template <typename T>
+size_t writeExternalSortBuffer(void *userData, const void *h_keys,
+                               const unsigned int *h_values, size_t numElements)
+{
+    ExternalSortBuffer<T> *buf = (ExternalSortBuffer<T>*)userData;
+    size_t n = std::min(numElements, buf->numElements - buf->offset);
+    memcpy(buf->keys + buf->offset, h_keys, n * sizeof(T));
+    if (h_values)
+        memcpy(buf->values + buf->offset, h_values, n * sizeof(unsigned int));
+    buf->offset += n;
+    return n;
+}
+
+template <typename T>
+int externalSortTest(CUDPPHandle theCudpp, CUDPPConfiguration config,
+                     size_t chunkElements, size_t *tests, unsigned int numTests,
+                     testrigOptions testOptions, bool quiet)
+{
+    int retval = 0;
+    bool keyValue = (config.options & CUDPP_OPTION_KEYS_ONLY) == 0;
+
+    size_t numElements = 0;
+    for (unsigned int k = 0; k < numTests; ++k)
+        numElements = std::max(numElements, tests[k]);
+
+    T *h_keys       = (T*)malloc(numElements * sizeof(T));
+    T *h_keysSorted = (T*)malloc(numElements * sizeof(T));
+    unsigned int *h_values = 0, *h_valuesSorted = 0;
+
+    if (keyValue)
+    {
+        h_values       = (unsigned int*)malloc(numElements * sizeof(unsigned int));
+        h_valuesSorted = (unsigned int*)malloc(numElements * sizeof(unsigned int));
+        for (size_t i = 0; i < numElements; ++i)
+            h_values[i] = (unsigned int)i;
+    }
+
+    if (config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE)
+        VectorSupport<T>::fillVectorKeys(h_keys, numElements, 32);
+    else
+        VectorSupport<T>::fillVector(h_keys, numElements, std::numeric_limits<float>::max());
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, chunkElements, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        return numTests;
+    }
+
+    cudpp_app::StopWatch timer;
+
+    for (unsigned int k = 0; k < numTests; ++k)
+    {
+        if (!quiet)
+        {
+            printf("Running a %s external sort of %ld %s %s in chunks of %ld\n",
+                   (config.options & CUDPP_OPTION_BACKWARD) ? "backward" : "forward",
+                   tests[k], datatypeToString(config.datatype),
+                   keyValue ? "key-value pairs" : "keys", chunkElements);
+            fflush(stdout);
+        }
+
+        ExternalSortBuffer<T> in  = { h_keys, h_values, tests[k], 0 };
+        ExternalSortBuffer<T> out = { h_keysSorted, h_valuesSorted, tests[k], 0 };
+
+        timer.reset();
+        timer.start();
+        result = cudppExternalSort(plan, readExternalSortBuffer<T>, &in,
+                                   writeExternalSortBuffer<T>, &out, NULL);
+        timer.stop();
+
+        int failed = 0;
+        if (result != CUDPP_SUCCESS || out.offset != tests[k])
+        {
+            if (!quiet)
+                printf("cudppExternalSort returned %d after writing %ld elements\n",
+                       (int)result, out.offset);
+            failed = 1;
+        }
+        else
+        {
+            failed = VectorSupport<T>::verifySort(h_keysSorted,
+                                                  keyValue ? h_valuesSorted : 0,
+                                                  h_keys, tests[k],
+                                                  (config.options & CUDPP_OPTION_BACKWARD) != 0);
+        }
+        retval += failed;
+
+        if (!quiet)
+        {
+            printf("test %s\n", failed ? "FAILED" : "PASSED");
+            printf("Execution time: %f ms\n", timer.getTime());
+        }
+        else
+            printf("\t%10ld\t%0.4f\n", tests[k], timer.getTime());
+    }
+    printf("\n");
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for external sort\n");
+        retval = numTests;
+    }
+
+    free(h_keys);
+    free(h_keysSorted);
+    free(h_values);
+    free(h_valuesSorted);
+
+    return retval;
+}
+
+/**
+ * Sorts raw binary files end to end with cudppExternalSortFile, in chunks
+ * small enough that the runs are merged in more than one pass, and checks
+ * that a value file shorter than the key file is reported.
+ *
+ * @return 0 if the test passed, 1 otherwise
+ */
+template <typename T>
+int externalSortFileTest(CUDPPHandle theCudpp, CUDPPConfiguration config, bool quiet)
+{
+    bool keyValue = (config.options & CUDPP_OPTION_KEYS_ONLY) == 0;
+
+    // more runs than one merge pass takes
+    const size_t chunkElements = 8192;
+    const size_t numElements = 150 * chunkElements + 7;
+    const char *keysIn = "cudpp_extsort_test_keys.in";
+    const char *valuesIn = "cudpp_extsort_test_values.in";
+    const char *keysOut = "cudpp_extsort_test_keys.out";
+    const char *valuesOut = "cudpp_extsort_test_values.out";
+
+    T *h_keys       = (T*)malloc(numElements * sizeof(T));
+    T *h_keysSorted = (T*)malloc(numElements * sizeof(T));
+    unsigned int *h_values       = (unsigned int*)malloc(numElements * sizeof(unsigned int));
+    unsigned int *h_valuesSorted = (unsigned int*)malloc(numElements * sizeof(unsigned int));
+    for (size_t i = 0; i < numElements; ++i)
+        h_values[i] = (unsigned int)i;
+
+    if (config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE)
+        VectorSupport<T>::fillVectorKeys(h_keys, numElements, 32);
+    else
+        VectorSupport<T>::fillVector(h_keys, numElements, std::numeric_limits<float>::max());
+
+    CUDPPHandle plan;
+    if (cudppPlan(theCudpp, &plan, config, chunkElements, 1, 0) != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        free(h_keys);
+        free(h_keysSorted);
+        free(h_values);
+        free(h_valuesSorted);
+        return 1;
+    }
+
+    if (!quiet)
+    {
+        printf("Running a file external sort of %ld %s %s in chunks of %ld\n",
+               (long)numElements, datatypeToString(config.datatype),
+               keyValue ? "key-value pairs" : "keys", (long)chunkElements);
+        fflush(stdout);
+    }
+
+    FILE *fp = fopen(keysIn, "wb");
+    bool written = fp && fwrite(h_keys, sizeof(T), numElements, fp) == numElements;
+    if (fp) fclose(fp);
+    fp = fopen(valuesIn, "wb");
+    written = written && fp && 
+        fwrite(h_values, sizeof(unsigned int), numElements, fp) == numElements;
+    if (fp) fclose(fp);
+
+    int failed = written ? 0 : 1;
+    CUDPPResult result = CUDPP_SUCCESS;
+    if (!failed)
+    {
+        result = cudppExternalSortFile(plan, keysIn, valuesIn, keysOut, valuesOut, NULL);
+
+        size_t numKeys = 0, numValues = numElements;
+        fp = fopen(keysOut, "rb");
+        if (fp)
+        {
+            numKeys = fread(h_keysSorted, sizeof(T), numElements, fp);
+            fclose(fp);
+        }
+        if (keyValue)
+        {
+            numValues = 0;
+            fp = fopen(valuesOut, "rb");
+            if (fp)
+            {
+                numValues = fread(h_valuesSorted, sizeof(unsigned int), numElements, fp);
+                fclose(fp);
+            }
+        }
+
+        if (result != CUDPP_SUCCESS || numKeys != numElements || numValues != numElements)
+        {
+            if (!quiet)
+                printf("cudppExternalSortFile returned %d after writing %ld elements\n",
+                       (int)result, (long)numKeys);
+            failed = 1;
+        }
+        else
+        {
+            failed = VectorSupport<T>::verifySort(h_keysSorted,
+                                                  keyValue ? h_valuesSorted : 0,
+                                                  h_keys, numElements,
+                                                  (config.options & CUDPP_OPTION_BACKWARD) != 0);
+        }
+    }
+
+    // a key without a value must fail the sort rather than be dropped
+    if (!failed && keyValue)
+    {
+        fp = fopen(valuesIn, "wb");
+        written = fp && fwrite(h_values, sizeof(unsigned int), numElements - 1, fp) == numElements - 1;
+        if (fp) fclose(fp);
+        result = cudppExternalSortFile(plan, keysIn, valuesIn, keysOut, valuesOut, NULL);
+        if (!written || result != CUDPP_ERROR_UNKNOWN)
+        {
+            if (!quiet)
+                printf("cudppExternalSortFile returned %d for a short value file\n", (int)result);
+            failed = 1;
+        }
+    }
+
+    if (!quiet)
+        printf("test %s\n\n", failed ? "FAILED" : "PASSED");
+
+    remove(keysIn);
+    remove(valuesIn);
+    remove(keysOut);
+    remove(valuesOut);
+
+    if (cudppDestroyPlan(plan) != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for external sort\n");
+        failed = 1;
+    }
+
+    free(h_keys);
+    free(h_keysSorted);
+    free(h_values);
+    free(h_valuesSorted);
+
+    return failed;
+}
+
+/**
+ * testExternalSort tests cudpp's out-of-core sort
+ * Possible command line arguments:
+ * - --keysonly, tests only a set of keys
+ * - --backward, sorts in descending order
+ * - --n=#, number of elements in sort
+ * - --chunk=#, number of elements sorted in-core at a time (the plan size)
+ *
+ * Also sorts files with cudppExternalSortFile, in small chunks so that the
+ * runs are merged in several passes.
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @param configPtr Configuration for the in-core sort, set by caller
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppExternalSort
+*/
+int testExternalSort(int argc, const char **argv, const CUDPPConfiguration *configPtr)
+{
+    int retval = 0;
+    int cmdVal;
+
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_SORT_RADIX;
+    config.datatype = CUDPP_UINT;
+    config.options = CUDPP_OPTION_KEY_VALUE_PAIRS;
+
+    // include sizes below, at, and well above one chunk, and a ragged last chunk
+    size_t chunkElements = 1048576;
+    size_t test[] = {1000, 1048576, 1048577, 3145728, 5767169};
+    unsigned int numTests = sizeof(test) / sizeof(test[0]);
+
+    if (configPtr != NULL)
+    {
+        config = *configPtr;
+    }
+    else
+    {
+        config.datatype = getDatatypeFromArgv(argc, argv);
+        if (checkCommandLineFlag(argc, argv, "mergesort"))
+            config.algorithm = CUDPP_SORT_MERGE;
+        if (checkCommandLineFlag(argc, argv, "keysonly"))
+            config.options = CUDPP_OPTION_KEYS_ONLY;
+        if (checkCommandLineFlag(argc, argv, "backward"))
+            config.options |= CUDPP_OPTION_BACKWARD;
+    }
+
+    if (commandLineArg(cmdVal, argc, (const char**)argv, "chunk"))
+        chunkElements = cmdVal;
+
+    if (commandLineArg(cmdVal, argc, (const char**)argv, "n"))
+    {
+        test[0] = cmdVal;
+        numTests = 1;
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return numTests;
+    }
+
+    switch (config.datatype)
+    {
+    case CUDPP_INT:
+        retval = externalSortTest<int>(theCudpp, config, chunkElements, test, numTests, testOptions, quiet);
+        retval += externalSortFileTest<int>(theCudpp, config, quiet);
+        break;
+    case CUDPP_UINT:
+        retval = externalSortTest<unsigned int>(theCudpp, config, chunkElements, test, numTests, testOptions, quiet);
+        retval += externalSortFileTest<unsigned int>(theCudpp, config, quiet);
+        break;
+    case CUDPP_FLOAT:
+        retval = externalSortTest<float>(theCudpp, config, chunkElements, test, numTests, testOptions, quiet);
+        retval += externalSortFileTest<float>(theCudpp, config, quiet);
+        break;
+    case CUDPP_DOUBLE:
+        retval = externalSortTest<double>(theCudpp, config, chunkElements, test, numTests, testOptions, quiet);
+        retval += externalSortFileTest<double>(theCudpp, config, quiet);
+        break;
+    case CUDPP_LONGLONG:
+        retval = externalSortTest<long long>(theCudpp, config, chunkElements, test, numTests, testOptions, quiet);
+        retval += externalSortFileTest<long long>(theCudpp, config, quiet);
+        break;
+    case CUDPP_ULONGLONG:
+        retval = externalSortTest<unsigned long long>(theCudpp, config, chunkElements, test, numTests, testOptions, quiet);
+        retval += externalSortFileTest<unsigned long long>(theCudpp, config, quiet);
+        break;
+    default:
+        break;
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        retval = numTests;
+    }
+
+    return retval;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -0,0 +1,410 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_histogram.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's histogram functionality.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+#include "cudpp_testrig_options.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace cudpp_app;
+
+/** Reference histogram with one bin per key from \a firstKey */
+template <class T>
+void keyHistogramGold(std::vector<unsigned int> &ref, const std::vector<T> &values,
+                      unsigned int numBins, long long firstKey)
+{
+    ref.assign(numBins, 0);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        long long key = (long long)values[i];
+        if (key >= firstKey && key - firstKey < (long long)numBins)
+            ref[key - firstKey]++;
+    }
+}
+
+/** Reference histogram with \a numBins equal bins over [lower, upper) */
+template <class T>
+void uniformHistogramGold(std::vector<unsigned int> &ref, const std::vector<T> &values,
+                          unsigned int numBins, double lower, double upper)
+{
+    ref.assign(numBins, 0);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        double bin = floor(((double)values[i] - lower) * numBins / (upper - lower));
+        if (bin >= 0 && bin < numBins)
+            ref[(unsigned int)bin]++;
+    }
+}
+
+/** Reference histogram with bins between sorted \a edges */
+template <class T>
+void edgeHistogramGold(std::vector<unsigned int> &ref, const std::vector<T> &values,
+                       const std::vector<T> &edges)
+{
+    unsigned int numBins = (unsigned int)edges.size() - 1;
+    ref.assign(numBins, 0);
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (values[i] < edges[0] || !(values[i] < edges[numBins]))
+            continue;
+        size_t bin = std::upper_bound(edges.begin(), edges.end(), values[i]) - edges.begin() - 1;
+        ref[bin]++;
+    }
+}
+
+/** Generate \a n values uniformly in [lower, upper), truncated for
+ *  integer types */
+template <class T>
+void generateHistogramValues(std::vector<T> &values, size_t n, double lower, double upper)
+{
+    values.resize(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        double r = (rand() / (RAND_MAX + 1.0) + rand()) / (RAND_MAX + 1.0);
+        values[i] = (T)(lower + r * (upper - lower));
+    }
+}
+
+/** Compute the histogram of \a values on the device and on the host with
+ *  the plan's bins, and compare both with \a ref.  \a offset values are
+ *  skipped, to test misaligned inputs.
+ *  @returns 1 if the test fails, 0 if it passes */
+template <class T>
+int histogramTest(CUDPPHandle plan, const char *binningName, const char *typeName,
+                  const std::vector<T> &values, size_t offset,
+                  const std::vector<unsigned int> &ref,
+                  testrigOptions &testOptions, bool quiet)
+{
+    size_t numElements = values.size() - offset;
+    size_t numBins = ref.size();
+
+    T *d_in;
+    unsigned int *d_histogram;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_in, std::max(values.size(), (size_t)1) * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_histogram, numBins * sizeof(unsigned int)));
+    if (!values.empty())
+        CUDA_SAFE_CALL(cudaMemcpy(d_in, &values[0], values.size() * sizeof(T),
+                                  cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemset(d_histogram, 0xff, numBins * sizeof(unsigned int)));
+
+    // run once to avoid timing startup overhead.
+    CUDPPResult result = cudppHistogram(plan, d_histogram, d_in + offset, numElements);
+
+    cudpp_app::StopWatch timer;
+    timer.reset();
+    timer.start();
+    for (int i = 0; i < testOptions.numIterations; i++)
+    {
+        cudppHistogram(plan, d_histogram, d_in + offset, numElements);
+    }
+    cudaThreadSynchronize();
+    timer.stop();
+
+    int failed = (result != CUDPP_SUCCESS) ? 1 : 0;
+    if (!failed)
+    {
+        std::vector<unsigned int> histogram(numBins);
+        CUDA_SAFE_CALL(cudaMemcpy(&histogram[0], d_histogram, numBins * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        if (histogram != ref)
+        {
+            failed = 1;
+            if (!quiet) printf("device histogram differs\n");
+        }
+    }
+
+    std::vector<unsigned int> hostHistogram(numBins, ~0u);
+    result = cudppHistogramHost(plan, &hostHistogram[0],
+                                values.empty() ? NULL : &values[0] + offset, numElements);
+    if (result != CUDPP_SUCCESS || hostHistogram != ref)
+    {
+        failed = 1;
+        if (!quiet) printf("host histogram differs\n");
+    }
+
+    if (!quiet)
+    {
+        printf("%s histogram of %lu %s values (%lu bins%s): %f ms: test %s\n",
+               binningName, (unsigned long)numElements, typeName, (unsigned long)numBins,
+               offset ? ", misaligned" : "", timer.getTime() / testOptions.numIterations,
+               failed ? "FAILED" : "PASSED");
+    }
+    else
+        printf("\t%10lu\t%0.4f\n", (unsigned long)numElements,
+               timer.getTime() / testOptions.numIterations);
+
+    CUDA_SAFE_CALL(cudaFree(d_in));
+    CUDA_SAFE_CALL(cudaFree(d_histogram));
+
+    return failed;
+}
+
+/** Test every binning of one datatype on values in [lower, upper) */
+template <class T>
+int histogramTypeTests(CUDPPHandle theCudpp, CUDPPDatatype datatype, const char *typeName,
+                       double lower, double upper, const size_t *sizes, unsigned int numSizes,
+                       testrigOptions &testOptions, bool quiet)
+{
+    int retval = 0;
+    bool isInteger = (datatype != CUDPP_FLOAT && datatype != CUDPP_DOUBLE);
+    size_t maxElements = sizes[numSizes - 1] + 1;
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_HISTOGRAM;
+    config.op = CUDPP_OPERATOR_INVALID;
+    config.datatype = datatype;
+    config.options = 0;
+
+    // byte and 16-bit plans start with one bin per value; defaultPlan
+    // keeps those bins, while plan is given each binning in turn
+    CUDPPHandle plan, defaultPlan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, maxElements, 1, 0);
+    if (result == CUDPP_SUCCESS)
+        result = cudppPlan(theCudpp, &defaultPlan, config, maxElements, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        return 1;
+    }
+
+    // the shared-memory counts (up to 256 bins) and the sorted counts
+    unsigned int binCounts[] = { 7, 256, 1000 };
+    unsigned int numBinCounts = sizeof(binCounts) / sizeof(binCounts[0]);
+
+    for (unsigned int k = 0; k < numSizes; ++k)
+    {
+        std::vector<T> values;
+        std::vector<unsigned int> ref;
+        generateHistogramValues(values, sizes[k] + 1, lower, upper);
+
+        // the default bins, on aligned and misaligned values
+        if (sizeof(T) <= 2)
+        {
+            unsigned int numBins = 1u << (8 * sizeof(T));
+            long long firstKey = (lower < 0) ? -(long long)numBins / 2 : 0;
+            std::vector<T> tail(values.begin() + 1, values.end());
+            keyHistogramGold(ref, tail, numBins, firstKey);
+            retval += histogramTest(defaultPlan, "default", typeName, values, 1, ref,
+                                    testOptions, quiet);
+            values.pop_back();
+            keyHistogramGold(ref, values, numBins, firstKey);
+            retval += histogramTest(defaultPlan, "default", typeName, values, 0, ref,
+                                    testOptions, quiet);
+        }
+        else
+            values.pop_back();
+
+        for (unsigned int b = 0; b < numBinCounts; ++b)
+        {
+            unsigned int numBins = binCounts[b];
+
+            if (isInteger)
+            {
+                long long firstKey = (long long)(lower + (upper - lower) / 4);
+                cudppHistogramKeyBins(plan, numBins, firstKey);
+                keyHistogramGold(ref, values, numBins, firstKey);
+                retval += histogramTest(plan, "key", typeName, values, 0, ref,
+                                        testOptions, quiet);
+            }
+
+            double uniformLower = lower + (upper - lower) / 8;
+            double uniformUpper = upper - (upper - lower) / 8;
+            cudppHistogramUniformBins(plan, numBins, uniformLower, uniformUpper);
+            uniformHistogramGold(ref, values, numBins, uniformLower, uniformUpper);
+            retval += histogramTest(plan, "uniform", typeName, values, 0, ref,
+                                    testOptions, quiet);
+
+            std::vector<T> edges;
+            generateHistogramValues(edges, numBins + 1, lower, upper);
+            std::sort(edges.begin(), edges.end());
+            cudppHistogramBinEdges(plan, numBins, &edges[0]);
+            edgeHistogramGold(ref, values, edges);
+            retval += histogramTest(plan, "edge", typeName, values, 0, ref,
+                                    testOptions, quiet);
+        }
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result == CUDPP_SUCCESS)
+        result = cudppDestroyPlan(defaultPlan);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for histogram\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+/** Check that invalid bins and calls are rejected.
+ *  @returns the number of checks that fail */
+int histogramErrorTests(CUDPPHandle theCudpp, bool quiet)
+{
+    int failed = 0;
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_HISTOGRAM;
+    config.op = CUDPP_OPERATOR_INVALID;
+    config.datatype = CUDPP_FLOAT;
+    config.options = 0;
+
+    CUDPPHandle plan;
+    if (cudppPlan(theCudpp, &plan, config, 1000, 1, 0) != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        return 1;
+    }
+
+    unsigned int histogram[4];
+    float values[4] = { 0, 1, 2, 3 };
+    float decreasing[3] = { 0, 2, 1 };
+
+    // float plans have no bins until they are set, and no key bins
+    if (cudppHistogramHost(plan, histogram, values, 4) != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        failed++;
+        if (!quiet) printf("cudppHistogramHost accepted a plan without bins: test FAILED\n");
+    }
+    if (cudppHistogramKeyBins(plan, 4, 0) != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        failed++;
+        if (!quiet) printf("cudppHistogramKeyBins accepted float keys: test FAILED\n");
+    }
+    if (cudppHistogramUniformBins(plan, 4, 1, 1) != CUDPP_ERROR_ILLEGAL_CONFIGURATION ||
+        cudppHistogramUniformBins(plan, 0, 0, 1) != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        failed++;
+        if (!quiet) printf("cudppHistogramUniformBins accepted empty bins: test FAILED\n");
+    }
+    if (cudppHistogramBinEdges(plan, 2, decreasing) != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        failed++;
+        if (!quiet) printf("cudppHistogramBinEdges accepted decreasing edges: test FAILED\n");
+    }
+
+    // sizes beyond the plan are rejected
+    cudppHistogramUniformBins(plan, 4, 0, 4);
+    if (cudppHistogram(plan, NULL, NULL, 1001) != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        failed++;
+        if (!quiet) printf("cudppHistogram accepted more values than the plan: test FAILED\n");
+    }
+
+    // values on the upper edge are not counted
+    cudppHistogramUniformBins(plan, 3, 0, 3);
+    if (cudppHistogramHost(plan, histogram, values, 4) != CUDPP_SUCCESS ||
+        histogram[0] != 1 || histogram[1] != 1 || histogram[2] != 1)
+    {
+        failed++;
+        if (!quiet) printf("cudppHistogramHost uniform bins: test FAILED\n");
+    }
+
+    cudppDestroyPlan(plan);
+    return failed;
+}
+
+/**
+ * testHistogram tests cudpp's histogram with key, uniform and edge bins,
+ * on the device and on the host, for every datatype.
+ * Possible command line arguments:
+ * - --n=#, number of values (default: a set of sizes)
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppHistogram, cudppHistogramHost
+ */
+int testHistogram(int argc, const char **argv)
+{
+    int retval = 0;
+    int cmdVal;
+
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    size_t test[] = { 0, 1, 3, 1000, 65537, 1000003 };
+    unsigned int numTests = sizeof(test) / sizeof(test[0]);
+
+    if (commandLineArg(cmdVal, argc, (const char**)argv, "n"))
+    {
+        test[0] = cmdVal;
+        numTests = 1;
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    srand(41);
+
+    retval += histogramTypeTests<char>(theCudpp, CUDPP_CHAR, "char", -128, 128,
+                                       test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<unsigned char>(theCudpp, CUDPP_UCHAR, "uchar", 0, 256,
+                                                test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<short>(theCudpp, CUDPP_SHORT, "short", -32768, 32768,
+                                        test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<unsigned short>(theCudpp, CUDPP_USHORT, "ushort", 0, 65536,
+                                                 test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<int>(theCudpp, CUDPP_INT, "int", -3000, 3000,
+                                      test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<unsigned int>(theCudpp, CUDPP_UINT, "uint", 0, 6000,
+                                               test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<float>(theCudpp, CUDPP_FLOAT, "float", -1.5, 1.5,
+                                        test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<double>(theCudpp, CUDPP_DOUBLE, "double", -1.5, 1.5,
+                                         test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<long long>(theCudpp, CUDPP_LONGLONG, "longlong", -3000, 3000,
+                                            test, numTests, testOptions, quiet);
+    retval += histogramTypeTests<unsigned long long>(theCudpp, CUDPP_ULONGLONG, "ulonglong",
+                                                     0, 6000, test, numTests,
+                                                     testOptions, quiet);
+
+    retval += histogramErrorTests(theCudpp, quiet);
+    printf("\n");
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -0,0 +1,439 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_largearrays.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's scan, compact, reduce
+ * and radix sort on arrays of more than 2^32 elements.
+ *
+ * Inputs are generated from the element index, and results are copied back
+ * and checked one chunk at a time, so host memory use is independent of the
+ * array size.  Each test is skipped if the device does not have enough free
+ * memory for it.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+#include "cudpp_testrig_options.h"
+#include "cudpp_testrig_utils.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+using namespace cudpp_app;
+
+/** Number of elements transferred and checked on the host at a time */
+const size_t LARGE_TEST_CHUNK = 1 << 24;
+
+/** Pseudo-random byte for element \a i of the input */
+inline unsigned char largeTestValue(size_t i)
+{
+    return (unsigned char)(((unsigned long long)i * 0x9E3779B97F4A7C15ULL) >> 56);
+}
+
+/** Compact flag for element \a i of the input (about 5/8 of elements are valid) */
+inline unsigned int largeTestFlag(size_t i)
+{
+    return largeTestValue(i) < 160 ? 1 : 0;
+}
+
+/** Returns true (and prints a note) if the device has room for \a bytes */
+bool largeTestFits(size_t bytes, const char *name, bool quiet)
+{
+    size_t freeMem = 0, totalMem = 0;
+    CUDA_SAFE_CALL(cudaMemGetInfo(&freeMem, &totalMem));
+    if (bytes > freeMem)
+    {
+        if (!quiet)
+            printf("Skipping large %s test: needs %lu MB of device memory, %lu MB free\n",
+                   name, (unsigned long)(bytes >> 20), (unsigned long)(freeMem >> 20));
+        return false;
+    }
+    return true;
+}
+
+/** Fill d_data with largeTestValue(), one chunk at a time */
+void uploadLargeTestValues(unsigned char *d_data, size_t numElements, unsigned char *h_chunk)
+{
+    for (size_t start = 0; start < numElements; start += LARGE_TEST_CHUNK)
+    {
+        size_t n = std::min(LARGE_TEST_CHUNK, numElements - start);
+        for (size_t i = 0; i < n; i++)
+            h_chunk[i] = largeTestValue(start + i);
+        CUDA_SAFE_CALL(cudaMemcpy(d_data + start, h_chunk, n, cudaMemcpyHostToDevice));
+    }
+}
+
+/** Check an in-place 8-bit sum scan (forward inclusive and backward exclusive) */
+int largeScanTest(CUDPPHandle theCudpp, size_t numElements, bool backward, bool quiet)
+{
+    if (!largeTestFits(numElements + (64 << 20), "scan", quiet))
+        return 0;
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_SCAN;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_UCHAR;
+    config.options = backward ?
+        (CUDPP_OPTION_BACKWARD | CUDPP_OPTION_EXCLUSIVE) :
+        (CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE);
+
+    unsigned char *h_chunk = (unsigned char*)malloc(LARGE_TEST_CHUNK);
+    unsigned char *d_data;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_data, numElements));
+    uploadLargeTestValues(d_data, numElements, h_chunk);
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error creating large scan plan\n");
+        cudaFree(d_data);
+        free(h_chunk);
+        return 1;
+    }
+
+    cudpp_app::StopWatch timer;
+    timer.start();
+    result = cudppScan(plan, d_data, d_data, numElements);
+    CUDA_SAFE_CALL(cudaThreadSynchronize());
+    timer.stop();
+
+    // the 8-bit sum wraps identically on the host and device
+    size_t numErrors = 0, firstError = 0;
+    unsigned char sum = 0;
+    size_t numChunks = (numElements + LARGE_TEST_CHUNK - 1) / LARGE_TEST_CHUNK;
+    for (size_t c = 0; c < numChunks; c++)
+    {
+        size_t chunk = backward ? numChunks - 1 - c : c;
+        size_t start = chunk * LARGE_TEST_CHUNK;
+        size_t n = std::min(LARGE_TEST_CHUNK, numElements - start);
+        CUDA_SAFE_CALL(cudaMemcpy(h_chunk, d_data + start, n, cudaMemcpyDeviceToHost));
+        for (size_t k = 0; k < n; k++)
+        {
+            size_t j = backward ? n - 1 - k : k;
+            if (!backward) sum += largeTestValue(start + j);
+            if (h_chunk[j] != sum && numErrors++ == 0)
+                firstError = start + j;
+            if (backward) sum += largeTestValue(start + j);
+        }
+    }
+
+    int failed = (result != CUDPP_SUCCESS || numErrors > 0) ? 1 : 0;
+    if (!quiet)
+    {
+        printf("%s scan of %lu uchars: test %s\n", backward ? "Backward exclusive" : "Forward inclusive",
+               (unsigned long)numElements, failed ? "FAILED" : "PASSED");
+        if (numErrors)
+            printf("%lu errors, first at element %lu\n",
+                   (unsigned long)numErrors, (unsigned long)firstError);
+        printf("Execution time: %f ms\n", timer.getTime());
+    }
+
+    cudppDestroyPlan(plan);
+    cudaFree(d_data);
+    free(h_chunk);
+    return failed;
+}
+
+/** Check a reduction of 8-bit values (the sum wraps identically on host and device) */
+int largeReduceTest(CUDPPHandle theCudpp, size_t numElements, bool quiet)
+{
+    if (!largeTestFits(numElements + (64 << 20), "reduce", quiet))
+        return 0;
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_REDUCE;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_UCHAR;
+    config.options = 0;
+
+    unsigned char *h_chunk = (unsigned char*)malloc(LARGE_TEST_CHUNK);
+    unsigned char *d_data, *d_sum;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_data, numElements));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_sum, 1));
+    uploadLargeTestValues(d_data, numElements, h_chunk);
+
+    unsigned char gold = 0;
+    for (size_t i = 0; i < numElements; i++)
+        gold += largeTestValue(i);
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+    int failed = 1;
+    if (result == CUDPP_SUCCESS)
+    {
+        result = cudppReduce(plan, d_sum, d_data, numElements);
+        unsigned char sum = 0;
+        CUDA_SAFE_CALL(cudaMemcpy(&sum, d_sum, 1, cudaMemcpyDeviceToHost));
+        failed = (result != CUDPP_SUCCESS || sum != gold) ? 1 : 0;
+        cudppDestroyPlan(plan);
+
+        if (!quiet)
+            printf("Reduce of %lu uchars: %u (gold %u) test %s\n", (unsigned long)numElements,
+                   (unsigned)sum, (unsigned)gold, failed ? "FAILED" : "PASSED");
+    }
+    else
+        printf("Error creating large reduce plan\n");
+
+    cudaFree(d_data);
+    cudaFree(d_sum);
+    free(h_chunk);
+    return failed;
+}
+
+/** Check a compact whose input has more than 2^32 elements */
+int largeCompactTest(CUDPPHandle theCudpp, size_t numElements, bool backward, bool quiet)
+{
+    // input, output, flags, plus one segment of indices
+    if (!largeTestFits(numElements * (2 + sizeof(unsigned int)) + (512 << 20), "compact", quiet))
+        return 0;
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_COMPACT;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_UCHAR;
+    config.options = backward ? CUDPP_OPTION_BACKWARD : CUDPP_OPTION_FORWARD;
+
+    unsigned char *h_chunk = (unsigned char*)malloc(LARGE_TEST_CHUNK);
+    unsigned int *h_flags = (unsigned int*)malloc(LARGE_TEST_CHUNK * sizeof(unsigned int));
+    unsigned char *d_in, *d_out;
+    unsigned int *d_isValid;
+    size_t *d_numValid;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_in, numElements));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_out, numElements));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_isValid, numElements * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_numValid, sizeof(size_t)));
+    uploadLargeTestValues(d_in, numElements, h_chunk);
+
+    size_t goldNumValid = 0;
+    for (size_t start = 0; start < numElements; start += LARGE_TEST_CHUNK)
+    {
+        size_t n = std::min(LARGE_TEST_CHUNK, numElements - start);
+        for (size_t i = 0; i < n; i++)
+        {
+            h_flags[i] = largeTestFlag(start + i);
+            goldNumValid += h_flags[i];
+        }
+        CUDA_SAFE_CALL(cudaMemcpy(d_isValid + start, h_flags, n * sizeof(unsigned int),
+                                  cudaMemcpyHostToDevice));
+    }
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error creating large compact plan\n");
+        cudaFree(d_in); cudaFree(d_out); cudaFree(d_isValid); cudaFree(d_numValid);
+        free(h_chunk); free(h_flags);
+        return 1;
+    }
+
+    cudpp_app::StopWatch timer;
+    timer.start();
+    result = cudppCompact(plan, d_out, d_numValid, d_in, d_isValid, numElements);
+    CUDA_SAFE_CALL(cudaThreadSynchronize());
+    timer.stop();
+
+    size_t numValid = 0;
+    CUDA_SAFE_CALL(cudaMemcpy(&numValid, d_numValid, sizeof(size_t), cudaMemcpyDeviceToHost));
+
+    // compact is order-preserving in both directions, so walk the input and
+    // the output together
+    size_t numErrors = 0;
+    if (numValid == goldNumValid)
+    {
+        size_t i = 0;
+        for (size_t start = 0; start < numValid; start += LARGE_TEST_CHUNK)
+        {
+            size_t n = std::min(LARGE_TEST_CHUNK, numValid - start);
+            CUDA_SAFE_CALL(cudaMemcpy(h_chunk, d_out + start, n, cudaMemcpyDeviceToHost));
+            for (size_t k = 0; k < n; k++, i++)
+            {
+                while (!largeTestFlag(i)) i++;
+                if (h_chunk[k] != largeTestValue(i)) numErrors++;
+            }
+        }
+    }
+
+    int failed = (result != CUDPP_SUCCESS || numValid != goldNumValid || numErrors > 0) ? 1 : 0;
+    if (!quiet)
+    {
+        printf("%s compact of %lu uchars to %lu (gold %lu): test %s\n",
+               backward ? "Backward" : "Forward", (unsigned long)numElements,
+               (unsigned long)numValid, (unsigned long)goldNumValid,
+               failed ? "FAILED" : "PASSED");
+        if (numErrors)
+            printf("%lu errors\n", (unsigned long)numErrors);
+        printf("Execution time: %f ms\n", timer.getTime());
+    }
+
+    cudppDestroyPlan(plan);
+    cudaFree(d_in);
+    cudaFree(d_out);
+    cudaFree(d_isValid);
+    cudaFree(d_numValid);
+    free(h_chunk);
+    free(h_flags);
+    return failed;
+}
+
+/** Check a key-index radix sort with 64-bit values */
+int largeRadixSortTest(CUDPPHandle theCudpp, size_t numElements, bool quiet)
+{
+    // keys, values, and the sort's temporary copy of both
+    if (!largeTestFits(2 * numElements * (1 + sizeof(unsigned long long)) + (512 << 20),
+                       "radix sort", quiet))
+        return 0;
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_SORT_RADIX;
+    config.op = CUDPP_ADD;
+    config.datatype = CUDPP_UCHAR;
+    config.options = CUDPP_OPTION_KEY_VALUE_PAIRS | CUDPP_OPTION_64BIT_VALUES;
+
+    unsigned char *h_chunk = (unsigned char*)malloc(LARGE_TEST_CHUNK);
+    unsigned long long *h_values =
+        (unsigned long long*)malloc(LARGE_TEST_CHUNK * sizeof(unsigned long long));
+    unsigned char *d_keys;
+    unsigned long long *d_values;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keys, numElements));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_values, numElements * sizeof(unsigned long long)));
+    uploadLargeTestValues(d_keys, numElements, h_chunk);
+
+    // values are the original index of each key
+    for (size_t start = 0; start < numElements; start += LARGE_TEST_CHUNK)
+    {
+        size_t n = std::min(LARGE_TEST_CHUNK, numElements - start);
+        for (size_t i = 0; i < n; i++)
+            h_values[i] = start + i;
+        CUDA_SAFE_CALL(cudaMemcpy(d_values + start, h_values, n * sizeof(unsigned long long),
+                                  cudaMemcpyHostToDevice));
+    }
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error creating large radix sort plan\n");
+        cudaFree(d_keys); cudaFree(d_values);
+        free(h_chunk); free(h_values);
+        return 1;
+    }
+
+    cudpp_app::StopWatch timer;
+    timer.start();
+    result = cudppRadixSort(plan, d_keys, d_values, numElements);
+    CUDA_SAFE_CALL(cudaThreadSynchronize());
+    timer.stop();
+
+    // keys must be non-decreasing, each value must index its own key, equal
+    // keys keep their input order, and every index must appear exactly once
+    unsigned char *seen = (unsigned char*)calloc((numElements + 7) / 8, 1);
+    size_t numErrors = 0;
+    unsigned char prevKey = 0;
+    unsigned long long prevValue = 0;
+    for (size_t start = 0; start < numElements; start += LARGE_TEST_CHUNK)
+    {
+        size_t n = std::min(LARGE_TEST_CHUNK, numElements - start);
+        CUDA_SAFE_CALL(cudaMemcpy(h_chunk, d_keys + start, n, cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(h_values, d_values + start, n * sizeof(unsigned long long),
+                                  cudaMemcpyDeviceToHost));
+        for (size_t k = 0; k < n; k++)
+        {
+            unsigned long long v = h_values[k];
+            bool ok = v < numElements && h_chunk[k] == largeTestValue((size_t)v) &&
+                      !(seen[v >> 3] & (1 << (v & 7)));
+            if (ok && start + k > 0)
+                ok = prevKey < h_chunk[k] || (prevKey == h_chunk[k] && prevValue < v);
+            if (!ok)
+                numErrors++;
+            else
+                seen[v >> 3] |= (unsigned char)(1 << (v & 7));
+            prevKey = h_chunk[k];
+            prevValue = v;
+        }
+    }
+
+    int failed = (result != CUDPP_SUCCESS || numErrors > 0) ? 1 : 0;
+    if (!quiet)
+    {
+        printf("Radix sort of %lu uchar keys with 64-bit values: test %s\n",
+               (unsigned long)numElements, failed ? "FAILED" : "PASSED");
+        if (numErrors)
+            printf("%lu errors\n", (unsigned long)numErrors);
+        printf("Execution time: %f ms\n", timer.getTime());
+    }
+
+    cudppDestroyPlan(plan);
+    cudaFree(d_keys);
+    cudaFree(d_values);
+    free(h_chunk);
+    free(h_values);
+    free(seen);
+    return failed;
+}
+
+/**
+ * testLargeArrays exercises scan, reduce, compact and radix sort on arrays
+ * of more than 2^32 elements, checking every result element.
+ * Possible command line arguments:
+ * - --n=#: number of elements (default 2^32 + 12345)
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppScan, cudppReduce, cudppCompact, cudppRadixSort
+ */
+int testLargeArrays(int argc, const char **argv)
+{
+    int retval = 0;
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    unsigned long long numElements = (1ULL << 32) + 12345;
+    commandLineArg(numElements, argc, (const char**)argv, "n");
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    retval += largeScanTest(theCudpp, (size_t)numElements, false, quiet);
+    retval += largeScanTest(theCudpp, (size_t)numElements, true, quiet);
+    retval += largeReduceTest(theCudpp, (size_t)numElements, quiet);
+    retval += largeCompactTest(theCudpp, (size_t)numElements, false, quiet);
+    retval += largeCompactTest(theCudpp, (size_t)numElements, true, quiet);
+    retval += largeRadixSortTest(theCudpp, (size_t)numElements, quiet);
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
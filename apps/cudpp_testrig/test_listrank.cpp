@@ -55,8 +55,8 @@ int listRankTest(int argc, const char **argv, const CUDPPConfiguration &config,
 
     bool quiet = checkCommandLineFlag(argc, (const char**)argv, "quiet");   
 
-    unsigned int test[] = {39, 128, 256, 512, 1000, 1024, 1025, 32768, 45537, 65536, 131072,
-        262144, 500001, 524288, 1048577, 1048576, 1048581};
+    unsigned int test[] = {1, 2, 33, 39, 128, 256, 512, 1000, 1024, 1025, 32768, 45537, 65536, 
+        131072, 262144, 500001, 524288, 1048577, 1048576, 1048581, 4194305};
     int numTests = sizeof(test) / sizeof(test[0]);
     int numElements = test[numTests-1]; // maximum test size
 
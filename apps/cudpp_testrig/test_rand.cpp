@@ -17,6 +17,8 @@
 
 #include <cstdio>
 #include <cstring>
+#include <cmath>
+#include <algorithm>
 #include <cuda_runtime_api.h>
 #include "cudpp_testrig_options.h"
 #include "cudpp_testrig_utils.h"
@@ -372,3 +374,203 @@ testRandMD5(int argc, const char** argv)
     return retval;
 }
 
+
+namespace testrig {
+    void philox4x32CPU(unsigned int ctr[4], unsigned int key0, unsigned int key1);
+    template <typename T>
+    void randPhiloxCPU(T *data, size_t numElements, unsigned long long offset,
+                       unsigned int seed, unsigned int stream, int dist);
+}
+
+/** Exact comparison for raw bits and uniform values; relative tolerance
+  * for distributions computed with transcendental functions */
+template <typename T>
+int comparePhilox(const T *gpu, const T *cpu, size_t numElements, bool exact)
+{
+    int numFailed = 0;
+    for (size_t j = 0; j < numElements; j++)
+    {
+        if (exact)
+        {
+            if (gpu[j] != cpu[j])
+                numFailed++;
+        }
+        else
+        {
+            double diff = fabs((double)gpu[j] - (double)cpu[j]);
+            double tol = (sizeof(T) == sizeof(float) ? 1e-5 : 1e-12) * 
+                         std::max(1.0, fabs((double)cpu[j]));
+            if (!(diff <= tol))
+                numFailed++;
+        }
+    }
+    return numFailed;
+}
+
+template <typename T>
+int randPhiloxTest(CUDPPHandle theCudpp, CUDPPConfiguration config, 
+                   const char *name, bool quiet)
+{
+    int retval = 0;
+    const unsigned int seed = 9999, stream = 7;
+    const int dist = (config.options & CUDPP_OPTION_RAND_NORMAL) ? 1 :
+                     (config.options & CUDPP_OPTION_RAND_EXPONENTIAL) ? 2 : 0;
+
+    size_t test[] = {1, 39, 1000, 1025, 65536, 1048577};
+    int numTests = sizeof(test) / sizeof(test[0]);
+
+    StopWatch timer;
+
+    for (int i = 0; i < numTests; i++)
+    {
+        const size_t n = test[i];
+        T *d_out, *h_out, *h_shard, *h_gold;
+        CUDA_SAFE_CALL(cudaMalloc((void**)&d_out, n * sizeof(T)));
+        h_out   = (T*) malloc(n * sizeof(T));
+        h_shard = (T*) malloc(n * sizeof(T));
+        h_gold  = (T*) malloc(n * sizeof(T));
+
+        CUDPPHandle randPlan = 0;
+        CUDPPResult result = cudppPlan(theCudpp, &randPlan, config, n, 1, 0);
+        if (CUDPP_SUCCESS != result)
+        {
+            printf("Error creating CUDPPPlan\n");
+            exit(-1);
+        }
+
+        cudppRandSeed(randPlan, seed);
+        cudppRandStream(randPlan, stream);
+
+        timer.reset();
+        timer.start();
+        cudppRand(randPlan, d_out, n);
+        cudaThreadSynchronize();
+        timer.stop();
+
+        CUDA_SAFE_CALL(cudaMemcpy(h_out, d_out, n * sizeof(T), cudaMemcpyDeviceToHost));
+
+        // the same stream generated in two shards: the first part by a
+        // call continuing from position 0, the second after a skip-ahead
+        const size_t split = n / 3;
+        cudppRandStream(randPlan, stream);
+        cudppRand(randPlan, d_out, split);
+        CUDA_SAFE_CALL(cudaMemcpy(h_shard, d_out, split * sizeof(T), cudaMemcpyDeviceToHost));
+        cudppRandStream(randPlan, stream);
+        cudppRandSkipAhead(randPlan, split);
+        cudppRand(randPlan, d_out, n - split);
+        CUDA_SAFE_CALL(cudaMemcpy(h_shard + split, d_out, (n - split) * sizeof(T), 
+                                  cudaMemcpyDeviceToHost));
+
+        testrig::randPhiloxCPU<T>(h_gold, n, 0, seed, stream, dist);
+
+        int numFailed = comparePhilox(h_out, h_gold, n, dist == 0);
+        int shardFailed = comparePhilox(h_shard, h_out, n, true);
+
+        if (!quiet)
+        {
+            printf("Generated %lu %s Philox values in %f ms\n", 
+                   (unsigned long)n, name, timer.getTime());
+            if (numFailed)
+                printf("%d values differ from the host reference\n", numFailed);
+            if (shardFailed)
+                printf("%d values differ between one call and two shards\n", shardFailed);
+            printf("Test %s\n\n", (numFailed || shardFailed) ? "FAILED" : "PASSED");
+        }
+        else
+            printf("\t%10lu\t%0.4f\n", (unsigned long)n, timer.getTime());
+
+        if (numFailed || shardFailed)
+            retval++;
+
+        result = cudppDestroyPlan(randPlan);
+        if (CUDPP_SUCCESS != result)
+        {
+            printf("Error destroying CUDPPPlan\n");
+            exit(-1);
+        }
+        CUDA_SAFE_CALL(cudaFree(d_out));
+        free(h_out);
+        free(h_shard);
+        free(h_gold);
+    }
+
+    return retval;
+}
+
+/**
+ * testRandPhilox tests the counter-based Philox generator against a host
+ * reference (checked first against the Random123 known-answer vectors),
+ * for raw 32-bit values and for uniform, normal and exponential floats
+ * and doubles, and checks that generating in shards with
+ * cudppRandSkipAhead reproduces a single call.
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppRand, cudppRandStream, cudppRandSkipAhead
+ */
+int testRandPhilox(int argc, const char** argv)
+{
+    int retval = 0;
+    bool quiet = checkCommandLineFlag(argc, (const char**) argv, "quiet");
+
+    // Random123 known-answer tests for philox4x32-10
+    const unsigned int kat[3][10] = {
+        { 0, 0, 0, 0, 0, 0, 
+          0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+        { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff,
+          0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+        { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344, 0xa4093822, 0x299f31d0,
+          0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } };
+    for (int k = 0; k < 3; k++)
+    {
+        unsigned int ctr[4] = { kat[k][0], kat[k][1], kat[k][2], kat[k][3] };
+        testrig::philox4x32CPU(ctr, kat[k][4], kat[k][5]);
+        if (memcmp(ctr, &kat[k][6], sizeof(ctr)) != 0)
+        {
+            printf("Philox host reference fails known-answer test %d\n", k);
+            return 1;
+        }
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    CUDPPConfiguration config;
+    config.op = CUDPP_ADD;
+    config.algorithm = CUDPP_RAND_PHILOX;
+    config.options = 0;
+
+    config.datatype = CUDPP_UINT;
+    retval += randPhiloxTest<unsigned int>(theCudpp, config, "uint", quiet);
+
+    const unsigned int dists[] = { 0, CUDPP_OPTION_RAND_NORMAL, CUDPP_OPTION_RAND_EXPONENTIAL };
+    const char *floatNames[] = { "uniform float", "normal float", "exponential float" };
+    const char *doubleNames[] = { "uniform double", "normal double", "exponential double" };
+    for (int d = 0; d < 3; d++)
+    {
+        config.options = dists[d];
+        config.datatype = CUDPP_FLOAT;
+        retval += randPhiloxTest<float>(theCudpp, config, floatNames[d], quiet);
+        config.datatype = CUDPP_DOUBLE;
+        retval += randPhiloxTest<double>(theCudpp, config, doubleNames[d], quiet);
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (CUDPP_SUCCESS != result)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        exit(-1);
+    }
+
+    if(!quiet)
+        printf("%u total tests failed in Philox rand test.\n", retval);
+
+    return retval;
+}
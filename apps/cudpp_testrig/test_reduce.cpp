@@ -15,8 +15,11 @@
  * @brief Host testrig routines to exercise cudpp's reduction functionality.
  */
 
+#include <cfloat>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <vector>
 #include <cuda_runtime_api.h>
 
 #include "cudpp.h"
@@ -40,6 +43,97 @@ void computeReduceGold( T* out, const T* idata, const unsigned int len)
     *out = sum;
 }
 
+/**
+ * @brief Computes a CUDPP_OPTION_DETERMINISTIC reduction on the host, 
+ * combining the elements in exactly the order the device does.
+ *
+ * Each pass splits its input among blocks of 256 (REDUCE_CTA_SIZE) threads,
+ * at most 65535 (REDUCE_DETERMINISTIC_MAX_BLOCKS) of them, each thread
+ * combining the elements it reads in order and each block combining its
+ * threads in a halving tree.  Passes repeat until one block is left.
+ */
+template <class Oper, typename T>
+void computeDeterministicReduceGold(T* out, const T* idata, const unsigned int len)
+{
+    const size_t ctaSize = 256;
+    const size_t maxBlocks = 65535;
+    Oper op;
+
+    std::vector<T> input(idata, idata + len);
+    for (;;)
+    {
+        size_t n = input.size();
+        size_t numThreads = ctaSize;
+        if (n <= 2 * ctaSize)
+            for (numThreads = 1; 2 * numThreads < n; numThreads *= 2) ;
+        size_t numBlocks = (n + 2 * ctaSize - 1) / (2 * ctaSize);
+        if (numBlocks > maxBlocks)
+            numBlocks = maxBlocks;
+
+        std::vector<T> blockSums(numBlocks);
+        std::vector<T> sdata(numThreads);
+        for (size_t b = 0; b < numBlocks; b++)
+        {
+            for (size_t tid = 0; tid < numThreads; tid++)
+            {
+                T sum = op.identity();
+                for (size_t i = b * 2 * numThreads + tid; i < n; 
+                     i += 2 * numThreads * numBlocks)
+                {
+                    sum = op(sum, input[i]);
+                    if (i + numThreads < n)
+                        sum = op(sum, input[i + numThreads]);
+                }
+                sdata[tid] = sum;
+            }
+            for (size_t stride = numThreads / 2; stride > 0; stride /= 2)
+                for (size_t tid = 0; tid < stride; tid++)
+                    sdata[tid] = op(sdata[tid], sdata[tid + stride]);
+            blockSums[b] = sdata[0];
+        }
+
+        if (numBlocks == 1)
+        {
+            *out = blockSums[0];
+            return;
+        }
+        input.swap(blockSums);
+    }
+}
+
+template <class Oper, typename T>
+bool checkDeterministicReduce(CUDPPHandle plan, T *d_odata, const T *d_idata,
+                              const T *i_data, unsigned int numElements)
+{
+    T reference = 0, o_data = 0;
+    computeDeterministicReduceGold<Oper, T>(&reference, i_data, numElements);
+    cudppReduce(plan, d_odata, d_idata, numElements);
+    CUDA_SAFE_CALL(cudaMemcpy(&o_data, d_odata, sizeof(T), cudaMemcpyDeviceToHost));
+    // bit-identical, not just within a tolerance
+    return memcmp(&o_data, &reference, sizeof(T)) == 0;
+}
+
+/**
+ * @brief Checks a float sum with CUDPP_OPTION_ACCUMULATE_DOUBLE against a
+ * sum computed in double precision on the host.
+ *
+ * Only the final rounding to float is allowed, so the result must be
+ * within one float epsilon of the reference, whatever the size.
+ */
+bool checkAccumulateDoubleReduce(CUDPPHandle plan, float *d_odata, 
+                                 const float *d_idata, const float *i_data, 
+                                 unsigned int numElements)
+{
+    double reference = 0;
+    for (unsigned int i = 0; i < numElements; i++)
+        reference += i_data[i];
+
+    float o_data = 0;
+    cudppReduce(plan, d_odata, d_idata, numElements);
+    CUDA_SAFE_CALL(cudaMemcpy(&o_data, d_odata, sizeof(float), cudaMemcpyDeviceToHost));
+    return fabs(reference - (double)o_data) <= fabs(reference) * FLT_EPSILON;
+}
+
 template <typename T>
 int reduceTest(int argc, const char **argv, const CUDPPConfiguration &config,
                const testrigOptions &testOptions)
@@ -77,6 +171,25 @@ int reduceTest(int argc, const char **argv, const CUDPPConfiguration &config,
         return retval;
     }
 
+    // with -autotune, the plan uses the fastest measured parameters, 
+    // read back from a saved tuning database
+    if (checkCommandLineFlag(argc, argv, "autotune"))
+    {
+        const char *tuningFile = "cudpp_reduce_tuning.txt";
+        result = cudppAutotune(theCudpp, &config, numElements);
+        if (result == CUDPP_SUCCESS)
+            result = cudppSaveTuningDatabase(theCudpp, tuningFile);
+        if (result == CUDPP_SUCCESS)
+            result = cudppLoadTuningDatabase(theCudpp, tuningFile);
+        remove(tuningFile);
+        if (result != CUDPP_SUCCESS)
+        {
+            printf("Error in autotuning\n");
+            cudppDestroy(theCudpp);
+            return numTests;
+        }
+    }
+
     CUDPPHandle plan;
 
     result = cudppPlan(theCudpp, &plan, config, numElements, 1, 0);
@@ -90,6 +203,42 @@ int reduceTest(int argc, const char **argv, const CUDPPConfiguration &config,
         return retval;
     }
 
+    CUDPPHandle deterministicPlan = 0;
+    if ((config.datatype == CUDPP_FLOAT || config.datatype == CUDPP_DOUBLE) &&
+        !(config.options & CUDPP_OPTION_DETERMINISTIC))
+    {
+        CUDPPConfiguration deterministicConfig = config;
+        deterministicConfig.options |= CUDPP_OPTION_DETERMINISTIC;
+        result = cudppPlan(theCudpp, &deterministicPlan, deterministicConfig, 
+                           numElements, 1, 0);
+        if (result != CUDPP_SUCCESS)
+        {
+            printf("Error in deterministic plan creation\n");
+            cudppDestroyPlan(plan);
+            cudppDestroy(theCudpp);
+            return numTests;
+        }
+    }
+
+    CUDPPHandle accumulatePlan = 0;
+    if (config.datatype == CUDPP_FLOAT && config.op == CUDPP_ADD &&
+        !(config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE))
+    {
+        CUDPPConfiguration accumulateConfig = config;
+        accumulateConfig.options |= CUDPP_OPTION_ACCUMULATE_DOUBLE;
+        result = cudppPlan(theCudpp, &accumulatePlan, accumulateConfig, 
+                           numElements, 1, 0);
+        if (result != CUDPP_SUCCESS)
+        {
+            printf("Error in double accumulation plan creation\n");
+            if (deterministicPlan != 0)
+                cudppDestroyPlan(deterministicPlan);
+            cudppDestroyPlan(plan);
+            cudppDestroy(theCudpp);
+            return numTests;
+        }
+    }
+
     unsigned int memSize = sizeof(T) * numElements;
 
     // allocate host memory to store the input data
@@ -211,6 +360,51 @@ int reduceTest(int argc, const char **argv, const CUDPPConfiguration &config,
         double threshold = (config.op == CUDPP_MULTIPLY && (config.datatype == CUDPP_FLOAT || config.datatype == CUDPP_DOUBLE)) ? 1 : test[k] * 5e-6;
         bool correct = (fabs((double)reference - (double)o_data) < threshold);
 
+        // the same reduction issued on a stream must give the same result
+        T o_dataAsync = 0;
+        cudaStream_t stream;
+        CUDA_SAFE_CALL(cudaStreamCreate(&stream));
+        CUDA_SAFE_CALL(cudaMemsetAsync(d_odata, 0, sizeof(T), stream));
+        cudppReduceAsync(plan, stream, d_odata, d_idata, test[k]);
+        CUDA_SAFE_CALL(cudaMemcpyAsync(&o_dataAsync, d_odata, sizeof(T), 
+                                       cudaMemcpyDeviceToHost, stream));
+        CUDA_SAFE_CALL(cudaStreamSynchronize(stream));
+        CUDA_SAFE_CALL(cudaStreamDestroy(stream));
+        correct = correct && (o_dataAsync == o_data);
+
+        // floating-point reductions with CUDPP_OPTION_DETERMINISTIC must
+        // match the host emulation of their fixed reduction order exactly
+        if (deterministicPlan != 0)
+        {
+            bool exact = false;
+            if (config.op == CUDPP_ADD)
+                exact = checkDeterministicReduce<OperatorAdd<T>, T>(
+                    deterministicPlan, d_odata, d_idata, i_data, test[k]);
+            else if (config.op == CUDPP_MULTIPLY)
+                exact = checkDeterministicReduce<OperatorMultiply<T>, T>(
+                    deterministicPlan, d_odata, d_idata, i_data, test[k]);
+            else if (config.op == CUDPP_MAX)
+                exact = checkDeterministicReduce<OperatorMax<T>, T>(
+                    deterministicPlan, d_odata, d_idata, i_data, test[k]);
+            else if (config.op == CUDPP_MIN)
+                exact = checkDeterministicReduce<OperatorMin<T>, T>(
+                    deterministicPlan, d_odata, d_idata, i_data, test[k]);
+            if (!exact && !quiet)
+                printf("deterministic reduction is not reproducible\n");
+            correct = correct && exact;
+        }
+
+        // float sums accumulated in double must be correctly rounded
+        if (accumulatePlan != 0)
+        {
+            bool accurate = checkAccumulateDoubleReduce(
+                accumulatePlan, (float*)d_odata, (const float*)d_idata, 
+                (const float*)i_data, test[k]);
+            if (!accurate && !quiet)
+                printf("double accumulation is not accurate\n");
+            correct = correct && accurate;
+        }
+
         // correct result?
         retval += (correct) ? 0 : 1;
 
@@ -229,6 +423,11 @@ int reduceTest(int argc, const char **argv, const CUDPPConfiguration &config,
         }
     }
 
+    if (deterministicPlan != 0)
+        cudppDestroyPlan(deterministicPlan);
+    if (accumulatePlan != 0)
+        cudppDestroyPlan(accumulatePlan);
+
     result = cudppDestroyPlan(plan);
 
     if (result != CUDPP_SUCCESS)
@@ -0,0 +1,455 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_reducebykey.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's reduce by key and unique.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+#include "cudpp_testrig_options.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+using namespace cudpp_app;
+
+/** Combine two values with \a op */
+template <class T>
+T combineGold(CUDPPOperator op, T a, T b)
+{
+    switch (op)
+    {
+    case CUDPP_ADD:      return a + b;
+    case CUDPP_MULTIPLY: return a * b;
+    case CUDPP_MIN:      return std::min(a, b);
+    case CUDPP_MAX:      return std::max(a, b);
+    default:             return a;
+    }
+}
+
+/** Reference reduce by key: groups of adjacent equal keys, or with
+ *  \a unsorted, all equal keys in increasing key order */
+template <class K, class T>
+void reduceByKeyGold(std::vector<K> &keysOut, std::vector<T> &valuesOut,
+                     std::vector<unsigned int> &counts, const std::vector<K> &keys,
+                     const std::vector<T> &values, CUDPPOperator op, bool unsorted)
+{
+    keysOut.clear();
+    valuesOut.clear();
+    counts.clear();
+    if (unsorted)
+    {
+        std::map<K, std::pair<T, unsigned int> > groups;
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            typename std::map<K, std::pair<T, unsigned int> >::iterator it = groups.find(keys[i]);
+            if (it == groups.end())
+                groups[keys[i]] = std::make_pair(values[i], 1u);
+            else
+            {
+                it->second.first = combineGold(op, it->second.first, values[i]);
+                it->second.second++;
+            }
+        }
+        for (typename std::map<K, std::pair<T, unsigned int> >::iterator it = groups.begin();
+             it != groups.end(); ++it)
+        {
+            keysOut.push_back(it->first);
+            valuesOut.push_back(it->second.first);
+            counts.push_back(it->second.second);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            if (i == 0 || keys[i] != keys[i - 1])
+            {
+                keysOut.push_back(keys[i]);
+                valuesOut.push_back(values[i]);
+                counts.push_back(1);
+            }
+            else
+            {
+                valuesOut.back() = combineGold(op, valuesOut.back(), values[i]);
+                counts.back()++;
+            }
+        }
+    }
+}
+
+/** Generate \a n keys from about n / 8 distinct keys, sorted unless
+ *  \a unsorted, and small integer values, whose float sums are exact */
+template <class K, class T>
+void generateKeys(std::vector<K> &keys, std::vector<T> &values, size_t n, bool unsorted)
+{
+    keys.resize(n);
+    values.resize(n);
+    unsigned int numDistinct = (unsigned int)(n / 8 + 1);
+    for (size_t i = 0; i < n; i++)
+    {
+        // spread the keys over the high bits too
+        K key = (K)(rand() % numDistinct);
+        keys[i] = (K)(key * (K)0x9E3779B1u);
+        values[i] = (T)(rand() % 16);
+    }
+    if (!unsorted)
+        std::sort(keys.begin(), keys.end());
+}
+
+/** Compare \a numUnique results with the reference
+ *  @returns true if they are equal */
+template <class K, class T>
+bool checkGroups(const K *keysOut, const T *valuesOut, const unsigned int *counts,
+                 size_t numUnique, const std::vector<K> &refKeys,
+                 const std::vector<T> &refValues, const std::vector<unsigned int> &refCounts)
+{
+    if (numUnique != refKeys.size())
+        return false;
+    for (size_t g = 0; g < numUnique; g++)
+    {
+        if (keysOut[g] != refKeys[g] ||
+            (valuesOut && valuesOut[g] != refValues[g]) ||
+            (counts && counts[g] != refCounts[g]))
+            return false;
+    }
+    return true;
+}
+
+/** Reduce by key and unique on the device and on the host, compared with
+ *  the reference.
+ *  @returns the number of failures */
+template <class K, class T>
+int reduceByKeyTest(CUDPPHandle theCudpp, CUDPPDatatype datatype, CUDPPOperator op,
+                    bool unsorted, const char *name, const size_t *sizes,
+                    unsigned int numSizes, testrigOptions &testOptions, bool quiet)
+{
+    int retval = 0;
+    size_t maxElements = 0;
+    for (unsigned int k = 0; k < numSizes; ++k)
+        maxElements = std::max(maxElements, sizes[k]);
+    size_t numAlloc = std::max(maxElements, (size_t)1);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_REDUCE_BY_KEY;
+    config.op = op;
+    config.datatype = datatype;
+    config.options = (sizeof(K) == 8 ? CUDPP_OPTION_64BIT_KEYS : 0) |
+                     (unsorted ? CUDPP_OPTION_UNSORTED_KEYS : 0);
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, maxElements, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        return 1;
+    }
+
+    K *d_keys, *d_keysOut;
+    T *d_values, *d_valuesOut;
+    unsigned int *d_counts;
+    size_t *d_numUnique;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keys, numAlloc * sizeof(K)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keysOut, numAlloc * sizeof(K)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_values, numAlloc * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_valuesOut, numAlloc * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_counts, numAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_numUnique, sizeof(size_t)));
+
+    for (unsigned int k = 0; k < numSizes; ++k)
+    {
+        size_t n = sizes[k];
+        std::vector<K> keys;
+        std::vector<T> values;
+        generateKeys(keys, values, n, unsorted);
+
+        std::vector<K> refKeys;
+        std::vector<T> refValues;
+        std::vector<unsigned int> refCounts;
+        reduceByKeyGold(refKeys, refValues, refCounts, keys, values, op, unsorted);
+
+        if (n > 0)
+        {
+            CUDA_SAFE_CALL(cudaMemcpy(d_keys, &keys[0], n * sizeof(K),
+                                      cudaMemcpyHostToDevice));
+            CUDA_SAFE_CALL(cudaMemcpy(d_values, &values[0], n * sizeof(T),
+                                      cudaMemcpyHostToDevice));
+        }
+
+        // run once to avoid timing startup overhead.
+        result = cudppReduceByKey(plan, d_keysOut, d_valuesOut, d_counts, d_numUnique,
+                                  d_keys, d_values, n);
+
+        cudpp_app::StopWatch timer;
+        timer.reset();
+        timer.start();
+        for (int i = 0; i < testOptions.numIterations; i++)
+        {
+            cudppReduceByKey(plan, d_keysOut, d_valuesOut, d_counts, d_numUnique,
+                             d_keys, d_values, n);
+        }
+        cudaThreadSynchronize();
+        timer.stop();
+
+        bool failed = (result != CUDPP_SUCCESS);
+        size_t numUnique = 0;
+        std::vector<K> keysOut(numAlloc);
+        std::vector<T> valuesOut(numAlloc);
+        std::vector<unsigned int> counts(numAlloc);
+        CUDA_SAFE_CALL(cudaMemcpy(&numUnique, d_numUnique, sizeof(size_t),
+                                  cudaMemcpyDeviceToHost));
+        if (!failed && numUnique == refKeys.size() && numUnique > 0)
+        {
+            CUDA_SAFE_CALL(cudaMemcpy(&keysOut[0], d_keysOut, numUnique * sizeof(K),
+                                      cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(&valuesOut[0], d_valuesOut, numUnique * sizeof(T),
+                                      cudaMemcpyDeviceToHost));
+            CUDA_SAFE_CALL(cudaMemcpy(&counts[0], d_counts, numUnique * sizeof(unsigned int),
+                                      cudaMemcpyDeviceToHost));
+        }
+        if (failed || !checkGroups(&keysOut[0], &valuesOut[0], &counts[0], numUnique,
+                                   refKeys, refValues, refCounts))
+        {
+            failed = true;
+            if (!quiet) printf("device groups differ\n");
+        }
+
+        // unique keys only
+        result = cudppUnique(plan, d_keysOut, d_numUnique, d_keys, n);
+        CUDA_SAFE_CALL(cudaMemcpy(&numUnique, d_numUnique, sizeof(size_t),
+                                  cudaMemcpyDeviceToHost));
+        if (result == CUDPP_SUCCESS && numUnique == refKeys.size() && numUnique > 0)
+            CUDA_SAFE_CALL(cudaMemcpy(&keysOut[0], d_keysOut, numUnique * sizeof(K),
+                                      cudaMemcpyDeviceToHost));
+        if (result != CUDPP_SUCCESS ||
+            !checkGroups(&keysOut[0], (const T*)0, (const unsigned int*)0, numUnique,
+                         refKeys, refValues, refCounts))
+        {
+            failed = true;
+            if (!quiet) printf("cudppUnique keys differ\n");
+        }
+
+        // the host version
+        numUnique = 0;
+        result = cudppReduceByKeyHost(plan, &keysOut[0], &valuesOut[0], &counts[0], &numUnique,
+                                      n ? &keys[0] : NULL, n ? &values[0] : NULL, n);
+        if (result != CUDPP_SUCCESS ||
+            !checkGroups(&keysOut[0], &valuesOut[0], &counts[0], numUnique,
+                         refKeys, refValues, refCounts))
+        {
+            failed = true;
+            if (!quiet) printf("host groups differ\n");
+        }
+
+        if (!quiet)
+        {
+            printf("%s, %lu keys, %lu groups: %f ms: test %s\n", name, (unsigned long)n,
+                   (unsigned long)refKeys.size(), timer.getTime() / testOptions.numIterations,
+                   failed ? "FAILED" : "PASSED");
+        }
+        else
+            printf("\t%10lu\t%0.4f\n", (unsigned long)n,
+                   timer.getTime() / testOptions.numIterations);
+
+        retval += failed ? 1 : 0;
+    }
+
+    // values and outputs go together; sizes beyond the plan are rejected
+    if (cudppReduceByKey(plan, d_keysOut, NULL, d_counts, d_numUnique, d_keys, d_values, 1) !=
+            CUDPP_ERROR_ILLEGAL_CONFIGURATION ||
+        cudppReduceByKey(plan, d_keysOut, d_valuesOut, d_counts, d_numUnique, d_keys, d_values,
+                         maxElements + 1) != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        if (!quiet) printf("%s: invalid arguments accepted: test FAILED\n", name);
+        retval++;
+    }
+
+    CUDA_SAFE_CALL(cudaFree(d_keys));
+    CUDA_SAFE_CALL(cudaFree(d_keysOut));
+    CUDA_SAFE_CALL(cudaFree(d_values));
+    CUDA_SAFE_CALL(cudaFree(d_valuesOut));
+    CUDA_SAFE_CALL(cudaFree(d_counts));
+    CUDA_SAFE_CALL(cudaFree(d_numUnique));
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for reduce by key\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+/** Count the keys of each group with a plan without an operator, which
+ *  must reject values.
+ *  @returns the number of failures */
+int reduceByKeyCountTest(CUDPPHandle theCudpp, bool quiet)
+{
+    int retval = 0;
+    const size_t n = 100000;
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_REDUCE_BY_KEY;
+    config.op = CUDPP_OPERATOR_INVALID;
+    config.datatype = CUDPP_UINT;
+    config.options = CUDPP_OPTION_UNSORTED_KEYS;
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, n, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        return 1;
+    }
+
+    std::vector<unsigned int> keys, values;
+    generateKeys(keys, values, n, true);
+    std::vector<unsigned int> refKeys, refValues, refCounts;
+    reduceByKeyGold(refKeys, refValues, refCounts, keys, values, CUDPP_ADD, true);
+
+    unsigned int *d_keys, *d_keysOut, *d_counts;
+    size_t *d_numUnique;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keys, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keysOut, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_counts, n * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_numUnique, sizeof(size_t)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_keys, &keys[0], n * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+
+    result = cudppReduceByKey(plan, d_keysOut, NULL, d_counts, d_numUnique, d_keys, NULL, n);
+    size_t numUnique = 0;
+    std::vector<unsigned int> keysOut(n), counts(n);
+    CUDA_SAFE_CALL(cudaMemcpy(&numUnique, d_numUnique, sizeof(size_t), cudaMemcpyDeviceToHost));
+    if (result == CUDPP_SUCCESS && numUnique == refKeys.size())
+    {
+        CUDA_SAFE_CALL(cudaMemcpy(&keysOut[0], d_keysOut, numUnique * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(&counts[0], d_counts, numUnique * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+    }
+    bool failed = result != CUDPP_SUCCESS ||
+        !checkGroups(&keysOut[0], (const unsigned int*)0, &counts[0], numUnique,
+                     refKeys, refValues, refCounts);
+
+    // a plan without an operator has no values to reduce
+    if (cudppReduceByKey(plan, d_keysOut, d_keysOut, d_counts, d_numUnique, d_keys, d_keys, n) !=
+        CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+        failed = true;
+
+    if (!quiet)
+        printf("uint keys, counts only, %lu keys, %lu groups: test %s\n", (unsigned long)n,
+               (unsigned long)refKeys.size(), failed ? "FAILED" : "PASSED");
+    retval += failed ? 1 : 0;
+
+    CUDA_SAFE_CALL(cudaFree(d_keys));
+    CUDA_SAFE_CALL(cudaFree(d_keysOut));
+    CUDA_SAFE_CALL(cudaFree(d_counts));
+    CUDA_SAFE_CALL(cudaFree(d_numUnique));
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for reduce by key\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+/**
+ * testReduceByKey tests cudpp's reduce by key and unique for sorted and
+ * unsorted 32- and 64-bit keys, on the device and on the host.
+ * Possible command line arguments:
+ * - --n=#, number of keys (default: a set of sizes)
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppReduceByKey, cudppUnique, cudppReduceByKeyHost
+ */
+int testReduceByKey(int argc, const char **argv)
+{
+    int retval = 0;
+    int cmdVal;
+
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    size_t test[] = { 0, 1, 2, 1000, 65537, 1000003 };
+    unsigned int numTests = sizeof(test) / sizeof(test[0]);
+
+    if (commandLineArg(cmdVal, argc, (const char**)argv, "n"))
+    {
+        test[0] = cmdVal;
+        numTests = 1;
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    srand(47);
+
+    retval += reduceByKeyTest<unsigned int, int>(theCudpp, CUDPP_INT, CUDPP_ADD, false,
+                                                 "sorted uint keys, int add",
+                                                 test, numTests, testOptions, quiet);
+    retval += reduceByKeyTest<unsigned int, float>(theCudpp, CUDPP_FLOAT, CUDPP_ADD, true,
+                                                   "unsorted uint keys, float add",
+                                                   test, numTests, testOptions, quiet);
+    retval += reduceByKeyTest<unsigned int, double>(theCudpp, CUDPP_DOUBLE, CUDPP_MAX, false,
+                                                    "sorted uint keys, double max",
+                                                    test, numTests, testOptions, quiet);
+    retval += reduceByKeyTest<unsigned long long, long long>(theCudpp, CUDPP_LONGLONG, CUDPP_MIN,
+                                                             true, "unsorted ulonglong keys, "
+                                                             "longlong min",
+                                                             test, numTests, testOptions, quiet);
+    retval += reduceByKeyTest<unsigned long long, unsigned int>(theCudpp, CUDPP_UINT, CUDPP_ADD,
+                                                                false, "sorted ulonglong keys, "
+                                                                "uint add",
+                                                                test, numTests, testOptions,
+                                                                quiet);
+    retval += reduceByKeyCountTest(theCudpp, quiet);
+    printf("\n");
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -0,0 +1,358 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_rle.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's run-length encoding.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+#include "cudpp_testrig_options.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+#include <vector>
+
+using namespace cudpp_app;
+
+/** Shape of the runs of a generated input */
+enum RunShape
+{
+    RUNS_MIXED,    //!< Runs of 1 to 1000 values, mostly short
+    RUNS_SINGLE,   //!< Every value differs from the previous one
+    RUNS_CONSTANT  //!< A single run
+};
+
+const char *runShapeName(RunShape shape)
+{
+    switch (shape)
+    {
+    case RUNS_MIXED:    return "mixed runs";
+    case RUNS_SINGLE:   return "single-value runs";
+    case RUNS_CONSTANT: return "one run";
+    }
+    return "unknown";
+}
+
+/** Generate \a n values with runs of the given shape */
+template <class T>
+void generateRuns(std::vector<T> &values, RunShape shape, size_t n)
+{
+    values.resize(n);
+    size_t i = 0;
+    T value = 0;
+    while (i < n)
+    {
+        size_t length = 1;
+        if (shape == RUNS_CONSTANT)
+            length = n;
+        else if (shape == RUNS_MIXED)
+            length = 1 + (rand() % 1000) * (rand() % 1000) / 1000;
+
+        // change the value, so runs do not merge
+        value = (T)(value + 1 + rand() % 3);
+        for (size_t j = 0; j < length && i < n; j++)
+            values[i++] = value;
+    }
+}
+
+/** Reference run-length encoding */
+template <class T>
+void runLengthGold(std::vector<T> &runValues, std::vector<unsigned int> &runLengths,
+                   const std::vector<T> &values)
+{
+    runValues.clear();
+    runLengths.clear();
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        if (i == 0 || memcmp(&values[i], &values[i - 1], sizeof(T)) != 0)
+        {
+            runValues.push_back(values[i]);
+            runLengths.push_back(0);
+        }
+        runLengths.back()++;
+    }
+}
+
+/** Encode and decode \a values on the device and on the host, and compare
+ *  with the reference encoding and the input.
+ *  @returns 1 if the test fails, 0 if it passes */
+template <class T>
+int runLengthTest(CUDPPHandle plan, CUDPPDatatype datatype, const char *typeName,
+                  const char *shapeName, const std::vector<T> &values,
+                  testrigOptions &testOptions, bool quiet)
+{
+    size_t numElements = values.size();
+    size_t numAlloc = std::max(numElements, (size_t)1);
+
+    std::vector<T> refValues;
+    std::vector<unsigned int> refLengths;
+    runLengthGold(refValues, refLengths, values);
+    size_t refRuns = refValues.size();
+
+    T *d_in, *d_values, *d_out;
+    unsigned int *d_runLengths;
+    size_t *d_numRuns;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_in, numAlloc * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_values, numAlloc * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_out, numAlloc * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_runLengths, numAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_numRuns, sizeof(size_t)));
+    if (numElements > 0)
+        CUDA_SAFE_CALL(cudaMemcpy(d_in, &values[0], numElements * sizeof(T),
+                                  cudaMemcpyHostToDevice));
+
+    // run once to avoid timing startup overhead.
+    CUDPPResult result = cudppRunLengthEncode(plan, d_values, d_runLengths, d_numRuns,
+                                              d_in, numElements);
+
+    cudpp_app::StopWatch timer;
+    timer.reset();
+    timer.start();
+    for (int i = 0; i < testOptions.numIterations; i++)
+    {
+        cudppRunLengthEncode(plan, d_values, d_runLengths, d_numRuns, d_in, numElements);
+    }
+    cudaThreadSynchronize();
+    timer.stop();
+
+    int failed = (result != CUDPP_SUCCESS) ? 1 : 0;
+    size_t numRuns = 0;
+    CUDA_SAFE_CALL(cudaMemcpy(&numRuns, d_numRuns, sizeof(size_t), cudaMemcpyDeviceToHost));
+    if (!failed && numRuns != refRuns)
+    {
+        failed = 1;
+        if (!quiet) printf("number of runs %lu, expected %lu\n",
+                           (unsigned long)numRuns, (unsigned long)refRuns);
+    }
+    if (!failed && numRuns > 0)
+    {
+        std::vector<T> runValues(numRuns);
+        std::vector<unsigned int> runLengths(numRuns);
+        CUDA_SAFE_CALL(cudaMemcpy(&runValues[0], d_values, numRuns * sizeof(T),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(&runLengths[0], d_runLengths,
+                                  numRuns * sizeof(unsigned int), cudaMemcpyDeviceToHost));
+        if (memcmp(&runValues[0], &refValues[0], numRuns * sizeof(T)) != 0 ||
+            runLengths != refLengths)
+        {
+            failed = 1;
+            if (!quiet) printf("device runs differ\n");
+        }
+    }
+
+    // decode the device encoding
+    if (!failed && numElements > 0)
+    {
+        CUDA_SAFE_CALL(cudaMemset(d_out, 0, numElements * sizeof(T)));
+        result = cudppRunLengthDecode(plan, d_out, d_values, d_runLengths,
+                                      numRuns, numElements);
+        std::vector<T> decoded(numElements);
+        CUDA_SAFE_CALL(cudaMemcpy(&decoded[0], d_out, numElements * sizeof(T),
+                                  cudaMemcpyDeviceToHost));
+        if (result != CUDPP_SUCCESS ||
+            memcmp(&decoded[0], &values[0], numElements * sizeof(T)) != 0)
+        {
+            failed = 1;
+            if (!quiet) printf("device decode differs\n");
+        }
+    }
+
+    // the host encoder and decoder
+    std::vector<T> hostValues(numAlloc), hostDecoded(numAlloc);
+    std::vector<unsigned int> hostLengths(numAlloc);
+    size_t hostRuns = ~(size_t)0;
+    result = cudppRunLengthEncodeHost(&hostValues[0], &hostLengths[0], &hostRuns,
+                                      numElements ? &values[0] : NULL, numElements, datatype);
+    hostValues.resize(hostRuns == ~(size_t)0 ? 0 : hostRuns);
+    hostLengths.resize(hostValues.size());
+    if (result != CUDPP_SUCCESS || hostRuns != refRuns || hostLengths != refLengths ||
+        (refRuns && memcmp(&hostValues[0], &refValues[0], refRuns * sizeof(T)) != 0))
+    {
+        failed = 1;
+        if (!quiet) printf("host runs differ\n");
+    }
+    else if (numElements > 0)
+    {
+        result = cudppRunLengthDecodeHost(&hostDecoded[0], &refValues[0], &refLengths[0],
+                                          refRuns, datatype);
+        if (result != CUDPP_SUCCESS ||
+            memcmp(&hostDecoded[0], &values[0], numElements * sizeof(T)) != 0)
+        {
+            failed = 1;
+            if (!quiet) printf("host decode differs\n");
+        }
+    }
+
+    if (!quiet)
+    {
+        printf("%s, %s, %lu values, %lu runs: %f ms: test %s\n", typeName, shapeName,
+               (unsigned long)numElements, (unsigned long)refRuns,
+               timer.getTime() / testOptions.numIterations, failed ? "FAILED" : "PASSED");
+    }
+    else
+        printf("\t%10lu\t%0.4f\n", (unsigned long)numElements,
+               timer.getTime() / testOptions.numIterations);
+
+    CUDA_SAFE_CALL(cudaFree(d_in));
+    CUDA_SAFE_CALL(cudaFree(d_values));
+    CUDA_SAFE_CALL(cudaFree(d_out));
+    CUDA_SAFE_CALL(cudaFree(d_runLengths));
+    CUDA_SAFE_CALL(cudaFree(d_numRuns));
+
+    return failed;
+}
+
+/** Run every run shape and size for one datatype */
+template <class T>
+int runLengthTypeTests(CUDPPHandle theCudpp, CUDPPDatatype datatype, const char *typeName,
+                       const size_t *sizes, unsigned int numSizes,
+                       testrigOptions &testOptions, bool quiet)
+{
+    int retval = 0;
+    size_t maxElements = 0;
+    for (unsigned int k = 0; k < numSizes; ++k)
+        maxElements = std::max(maxElements, sizes[k]);
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_RLE;
+    config.op = CUDPP_OPERATOR_INVALID;
+    config.datatype = datatype;
+    config.options = 0;
+
+    CUDPPHandle plan;
+    CUDPPResult result = cudppPlan(theCudpp, &plan, config, maxElements, 1, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        return 1;
+    }
+
+    RunShape shapes[] = { RUNS_MIXED, RUNS_SINGLE, RUNS_CONSTANT };
+
+    for (unsigned int k = 0; k < numSizes; ++k)
+    {
+        for (unsigned int s = 0; s < sizeof(shapes) / sizeof(shapes[0]); ++s)
+        {
+            std::vector<T> values;
+            generateRuns(values, shapes[s], sizes[k]);
+            retval += runLengthTest(plan, datatype, typeName, runShapeName(shapes[s]),
+                                    values, testOptions, quiet);
+        }
+    }
+
+    // runs of floats are runs of identical bits: 0 and -0 differ, NaNs match
+    if (datatype == CUDPP_FLOAT && maxElements >= 6)
+    {
+        float zero = 0.0f;
+        float nan = zero / zero;
+        float special[] = { 0.0f, -0.0f, -0.0f, nan, nan, 1.0f };
+        std::vector<T> values(special, special + 6);
+        retval += runLengthTest(plan, datatype, typeName, "signed zeros and NaNs",
+                                values, testOptions, quiet);
+    }
+
+    // sizes beyond the plan are rejected
+    result = cudppRunLengthEncode(plan, NULL, NULL, NULL, NULL, maxElements + 1);
+    if (result != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        if (!quiet)
+            printf("cudppRunLengthEncode accepted more values than the plan: test FAILED\n");
+        retval++;
+    }
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for run-length encoding\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+/**
+ * testRunLength tests cudpp's run-length encoding and decoding, on the
+ * device and on the host, for values of every size.
+ * Possible command line arguments:
+ * - --n=#, number of values (default: a set of sizes)
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppRunLengthEncode, cudppRunLengthDecode
+ */
+int testRunLength(int argc, const char **argv)
+{
+    int retval = 0;
+    int cmdVal;
+
+    testrigOptions testOptions;
+    setOptions(argc, argv, testOptions);
+
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    size_t test[] = { 0, 1, 2, 63, 64, 65, 1000, 65537, 1000003 };
+    unsigned int numTests = sizeof(test) / sizeof(test[0]);
+
+    if (commandLineArg(cmdVal, argc, (const char**)argv, "n"))
+    {
+        test[0] = cmdVal;
+        numTests = 1;
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    srand(43);
+
+    retval += runLengthTypeTests<unsigned char>(theCudpp, CUDPP_UCHAR, "uchar",
+                                                test, numTests, testOptions, quiet);
+    retval += runLengthTypeTests<short>(theCudpp, CUDPP_SHORT, "short",
+                                        test, numTests, testOptions, quiet);
+    retval += runLengthTypeTests<int>(theCudpp, CUDPP_INT, "int",
+                                      test, numTests, testOptions, quiet);
+    retval += runLengthTypeTests<float>(theCudpp, CUDPP_FLOAT, "float",
+                                        test, numTests, testOptions, quiet);
+    retval += runLengthTypeTests<double>(theCudpp, CUDPP_DOUBLE, "double",
+                                         test, numTests, testOptions, quiet);
+    retval += runLengthTypeTests<unsigned long long>(theCudpp, CUDPP_ULONGLONG, "ulonglong",
+                                                     test, numTests, testOptions, quiet);
+    printf("\n");
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -18,7 +18,11 @@
 #include <stdio.h>
 #include <time.h>
 #include <limits.h>
+#include <float.h>
+#include <math.h>
 #include <cstring>
+#include <algorithm>
+#include <vector>
 #include <cuda_runtime_api.h>
 
 #include "cudpp.h"
@@ -33,6 +37,120 @@
 
 using namespace cudpp_app;
 
+//! Largest error of an element of checkAccumulateDoubleScan()
+static double accumulateTolerance(double reference, double maxValue)
+{
+    // the inputs are positive, so the magnitudes summed into an element
+    // are at most its reference plus the largest input
+    const double maxRoundings = 32;
+    return FLT_EPSILON * (fabs(reference) + 
+                          0.5 * maxRoundings * (fabs(reference) + maxValue));
+}
+
+/**
+ * @brief Checks a float sum scan or segmented sum scan with 
+ * CUDPP_OPTION_ACCUMULATE_DOUBLE against a scan computed in double 
+ * precision on the host.
+ *
+ * The input repeats 1.1, 1.2, ..., 1.7 over 8M elements, in segments of
+ * millions for a segmented scan.  A float running sum of it drifts by
+ * over a hundred thousand, since every addition rounds by up to half the
+ * spacing of floats near the sum; this is checked too, so the input 
+ * cannot silently become too easy.  With double accumulation only the scan within a block of
+ * 1024 elements (SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE) and the final 
+ * rounding are in float.  A block's scan rounds fewer than 32 times on
+ * the way to an element (8 sequential steps per thread, then a tree over
+ * the threads), each time by at most half an epsilon of the magnitudes
+ * combined, so the error of an element is bounded by epsilon times its
+ * magnitude plus 16 epsilons of the magnitudes summed into it.
+ *
+ * @returns true if the scan is within the tolerance
+ */
+bool checkAccumulateDoubleScan(CUDPPHandle theCudpp, 
+                               const CUDPPConfiguration &config, bool quiet)
+{
+    const unsigned int numElements = 8388608;
+
+    CUDPPConfiguration accumulateConfig = config;
+    accumulateConfig.options |= CUDPP_OPTION_ACCUMULATE_DOUBLE;
+    CUDPPHandle plan;
+    if (cudppPlan(theCudpp, &plan, accumulateConfig, numElements, 1, 0) != 
+        CUDPP_SUCCESS)
+    {
+        if (!quiet)
+            printf("Error in double accumulation plan creation\n");
+        return false;
+    }
+
+    std::vector<float> i_data(numElements), o_data(numElements);
+    std::vector<double> input(numElements), reference(numElements);
+    std::vector<unsigned int> i_flags(numElements, 0);
+    double maxValue = 0;
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        i_data[i] = 1.1f + 0.1f * (i % 7);
+        input[i] = i_data[i];
+        maxValue = std::max(maxValue, input[i]);
+    }
+    i_flags[numElements / 3] = 1;
+    i_flags[2 * numElements / 3] = 1;
+
+    // a float running sum of the input must drift beyond the tolerance
+    float floatSum = 0;
+    double sum = 0, drift = 0;
+    bool drifts = false;
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        floatSum += i_data[i];
+        sum += input[i];
+        drift = std::max(drift, fabs(sum - (double)floatSum));
+        drifts = drifts || fabs(sum - (double)floatSum) > accumulateTolerance(sum, maxValue);
+    }
+
+    float *d_idata, *d_odata;
+    unsigned int *d_iflags = 0;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_idata, numElements * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_odata, numElements * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_idata, &i_data[0], numElements * sizeof(float),
+                              cudaMemcpyHostToDevice));
+    if (config.algorithm == CUDPP_SEGMENTED_SCAN)
+    {
+        CUDA_SAFE_CALL(cudaMalloc((void**)&d_iflags, numElements * sizeof(unsigned int)));
+        CUDA_SAFE_CALL(cudaMemcpy(d_iflags, &i_flags[0], 
+                                  numElements * sizeof(unsigned int),
+                                  cudaMemcpyHostToDevice));
+        cudppSegmentedScan(plan, d_odata, d_idata, d_iflags, numElements);
+        computeSegmentedSumScanGold(&reference[0], &input[0], &i_flags[0],
+                                    numElements, config);
+    }
+    else
+    {
+        cudppScan(plan, d_odata, d_idata, numElements);
+        computeSumScanGold(&reference[0], &input[0], numElements, config);
+    }
+    CUDA_SAFE_CALL(cudaMemcpy(&o_data[0], d_odata, numElements * sizeof(float),
+                              cudaMemcpyDeviceToHost));
+
+    double maxError = 0;
+    bool accurate = true;
+    for (unsigned int i = 0; i < numElements; i++)
+    {
+        double error = fabs((double)o_data[i] - reference[i]);
+        maxError = std::max(maxError, error);
+        accurate = accurate && (error <= accumulateTolerance(reference[i], maxValue));
+    }
+    if (!quiet)
+        printf("double accumulation: max error %g, float running sum drift %g\n",
+               maxError, drift);
+
+    cudaFree(d_idata);
+    cudaFree(d_odata);
+    if (d_iflags) 
+        cudaFree(d_iflags);
+    cudppDestroyPlan(plan);
+    return accurate && drifts;
+}
+
 /**
  * testScan exercises cudpp's unsegmented scan functionality.
  * Possible command line arguments:
@@ -266,6 +384,45 @@ int scanTest(int argc, const char **argv, const CUDPPConfiguration &config,
         // check if the result is equivalent to the expected solution
         bool result = compareArrays( reference, o_data, test[k], 0.001f);
 
+        // the same scan issued on a stream must give the same result
+        cudaStream_t stream;
+        CUDA_SAFE_CALL(cudaStreamCreate(&stream));
+        CUDA_SAFE_CALL(cudaMemsetAsync(d_odata, 0, sizeof(T) * test[k], stream));
+        if (config.algorithm == CUDPP_SEGMENTED_SCAN)
+            cudppSegmentedScanAsync(plan, stream, d_odata, d_idata, d_iflags, test[k]);
+        else
+            cudppScanAsync(plan, stream, d_odata, d_idata, test[k]);
+        CUDA_SAFE_CALL(cudaMemcpyAsync(o_data, d_odata, sizeof(T) * test[k],
+                                       cudaMemcpyDeviceToHost, stream));
+        CUDA_SAFE_CALL(cudaStreamSynchronize(stream));
+        CUDA_SAFE_CALL(cudaStreamDestroy(stream));
+        result = result && compareArrays( reference, o_data, test[k], 0.001f);
+
+        // an instrumented scan is counted once, with the bytes of its input
+        CUDPPStatistics stats, planBefore, planAfter;
+        cudppResetStatistics(theCudpp);
+        cudppGetPlanStatistics(plan, &planBefore);
+        cudppEnableStatistics(theCudpp, 1);
+        if (config.algorithm == CUDPP_SEGMENTED_SCAN)
+            cudppSegmentedScan(plan, d_odata, d_idata, d_iflags, test[k]);
+        else
+            cudppScan(plan, d_odata, d_idata, test[k]);
+        cudppEnableStatistics(theCudpp, 0);
+        cudppGetStatistics(theCudpp, config.algorithm, &stats);
+        cudppGetPlanStatistics(plan, &planAfter);
+        bool counted = (stats.calls == 1 && stats.iterations >= 1 &&
+                        stats.bytesIn >= sizeof(T) * test[k] &&
+                        planAfter.calls == planBefore.calls + 1);
+        // a null counters pointer is rejected, not dereferenced
+        counted = counted &&
+            cudppGetPlanStatistics(plan, NULL) ==
+                CUDPP_ERROR_ILLEGAL_CONFIGURATION &&
+            cudppGetStatistics(theCudpp, config.algorithm, NULL) ==
+                CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (!counted && !quiet)
+            printf("statistics not recorded\n");
+        result = result && counted;
+
         retval += result ? 0 : 1;
         if (!quiet)
         {
@@ -284,6 +441,16 @@ int scanTest(int argc, const char **argv, const CUDPPConfiguration &config,
             printArray(o_data, numElements);
         }
     }
+    // float sums combined in double stay accurate where float ones drift
+    if (!oneTest && config.datatype == CUDPP_FLOAT && config.op == CUDPP_ADD &&
+        !(config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE))
+    {
+        bool accurate = checkAccumulateDoubleScan(theCudpp, config, quiet);
+        retval += accurate ? 0 : 1;
+        if (!quiet)
+            printf("double accumulation test %s\n", accurate ? "PASSED" : "FAILED");
+    }
+
     if (!quiet)
         printf("\n");
 
@@ -0,0 +1,407 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * test_sparseconvert.cpp
+ *
+ * @brief Host testrig routines to exercise cudpp's sparse matrix conversions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <cuda_runtime_api.h>
+
+#include "cudpp.h"
+#include "cudpp_testrig_options.h"
+#include "cuda_util.h"
+#include "stopwatch.h"
+#include "commandline.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+using namespace cudpp_app;
+
+/** Distribution of the nonzeros of a generated COO matrix */
+enum SparseConvertPattern
+{
+    SPARSE_UNIFORM,   //!< Rows and columns uniformly distributed
+    SPARSE_POWER_LAW, //!< Most nonzeros in a few low-numbered rows
+    SPARSE_EMPTY_ROWS //!< Only every fourth row has nonzeros
+};
+
+const char *sparseConvertPatternName(SparseConvertPattern pattern)
+{
+    switch (pattern)
+    {
+    case SPARSE_UNIFORM:    return "uniform";
+    case SPARSE_POWER_LAW:  return "power-law";
+    case SPARSE_EMPTY_ROWS: return "empty-rows";
+    }
+    return "unknown";
+}
+
+/** Generate \a nnz COO nonzeros of a \a numRows x \a numCols matrix, with
+ *  some duplicated entries.  Each value is its position in the input, so
+ *  the permutation applied by a conversion can be checked exactly. */
+void generateCoo(std::vector<unsigned int> &rows, std::vector<unsigned int> &cols,
+                 std::vector<float> &values, SparseConvertPattern pattern,
+                 unsigned int numRows, unsigned int numCols, unsigned int nnz)
+{
+    rows.resize(nnz);
+    cols.resize(nnz);
+    values.resize(nnz);
+
+    for (unsigned int i = 0; i < nnz; ++i)
+    {
+        double u = rand() / ((double)RAND_MAX + 1);
+        unsigned int r;
+        if (pattern == SPARSE_POWER_LAW)
+            r = (unsigned int)(numRows * u * u * u);
+        else if (pattern == SPARSE_EMPTY_ROWS)
+            r = ((unsigned int)(numRows * u) / 4) * 4;
+        else
+            r = (unsigned int)(numRows * u);
+
+        if (i > 0 && i % 10 == 0)
+        {
+            // duplicate an earlier entry
+            unsigned int j = rand() % i;
+            rows[i] = rows[j];
+            cols[i] = cols[j];
+        }
+        else
+        {
+            rows[i] = std::min(r, numRows - 1);
+            cols[i] = rand() % numCols;
+        }
+        values[i] = (float)i;
+    }
+}
+
+/** Compress COO nonzeros to CSR on the host with a stable counting sort.
+ *  Returns the nonzeros of each row in their input order. */
+void cooToCsrGold(std::vector<unsigned int> &offsets, std::vector<unsigned int> &cols,
+                  std::vector<float> &values, const std::vector<unsigned int> &cooRows,
+                  const std::vector<unsigned int> &cooCols,
+                  const std::vector<float> &cooValues, unsigned int numRows)
+{
+    size_t nnz = cooRows.size();
+    offsets.assign(numRows + 1, 0);
+    cols.resize(nnz);
+    values.resize(nnz);
+
+    for (size_t i = 0; i < nnz; ++i)
+        offsets[cooRows[i] + 1]++;
+    for (unsigned int r = 0; r < numRows; ++r)
+        offsets[r + 1] += offsets[r];
+
+    std::vector<unsigned int> next(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < nnz; ++i)
+    {
+        unsigned int k = next[cooRows[i]]++;
+        cols[k] = cooCols[i];
+        values[k] = cooValues[i];
+    }
+}
+
+/** Compare two CSR matrices row by row.  The nonzeros of a row are
+ *  compared as (column, value) sets, since duplicate entries may come in
+ *  any order; the columns of \a cols must also be sorted within each row. */
+int compareCsr(const std::vector<unsigned int> &offsets, const std::vector<unsigned int> &cols,
+               const std::vector<float> &values, const std::vector<unsigned int> &refOffsets,
+               const std::vector<unsigned int> &refCols, const std::vector<float> &refValues,
+               bool quiet)
+{
+    if (offsets != refOffsets)
+    {
+        if (!quiet)
+            printf("row offsets differ\n");
+        return 1;
+    }
+
+    for (size_t r = 0; r + 1 < offsets.size(); ++r)
+    {
+        std::vector<std::pair<unsigned int, float> > a, b;
+        for (unsigned int k = offsets[r]; k < offsets[r + 1]; ++k)
+        {
+            if (k > offsets[r] && cols[k] < cols[k - 1])
+            {
+                if (!quiet)
+                    printf("columns of row %ld are not sorted\n", (long)r);
+                return 1;
+            }
+            a.push_back(std::make_pair(cols[k], values[k]));
+            b.push_back(std::make_pair(refCols[k], refValues[k]));
+        }
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        if (a != b)
+        {
+            if (!quiet)
+                printf("nonzeros of row %ld differ\n", (long)r);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** Copy a CSR matrix in device memory to the host */
+void copyCsrToHost(std::vector<unsigned int> &offsets, std::vector<unsigned int> &cols,
+                   std::vector<float> &values, const unsigned int *d_offsets,
+                   const unsigned int *d_cols, const float *d_values,
+                   unsigned int numRows, unsigned int nnz)
+{
+    offsets.resize(numRows + 1);
+    cols.resize(nnz);
+    values.resize(nnz);
+    CUDA_SAFE_CALL(cudaMemcpy(&offsets[0], d_offsets, (numRows + 1) * sizeof(unsigned int),
+                              cudaMemcpyDeviceToHost));
+    if (nnz > 0)
+    {
+        CUDA_SAFE_CALL(cudaMemcpy(&cols[0], d_cols, nnz * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL(cudaMemcpy(&values[0], d_values, nnz * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
+    }
+}
+
+/** Convert a generated COO matrix to CSR, transpose it, and transpose it
+ *  back, checking each result against the host reference. */
+int sparseConvertTest(CUDPPHandle plan, SparseConvertPattern pattern,
+                      unsigned int numRows, unsigned int numCols, unsigned int nnz,
+                      bool quiet)
+{
+    std::vector<unsigned int> cooRows, cooCols;
+    std::vector<float> cooValues;
+    generateCoo(cooRows, cooCols, cooValues, pattern, numRows, numCols, nnz);
+
+    size_t nnzAlloc = std::max(nnz, 1u);
+    unsigned int maxDim = std::max(numRows, numCols);
+    unsigned int *d_cooRows, *d_cooCols, *d_offsets, *d_cols, *d_tOffsets, *d_tCols;
+    float *d_cooValues, *d_values, *d_tValues;
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_cooRows, nnzAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_cooCols, nnzAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_cooValues, nnzAlloc * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_cols, nnzAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_values, nnzAlloc * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_tCols, nnzAlloc * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_tValues, nnzAlloc * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_offsets, (maxDim + 1) * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_tOffsets, (maxDim + 1) * sizeof(unsigned int)));
+
+    if (nnz > 0)
+    {
+        CUDA_SAFE_CALL(cudaMemcpy(d_cooRows, &cooRows[0], nnz * sizeof(unsigned int),
+                                  cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL(cudaMemcpy(d_cooCols, &cooCols[0], nnz * sizeof(unsigned int),
+                                  cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL(cudaMemcpy(d_cooValues, &cooValues[0], nnz * sizeof(float),
+                                  cudaMemcpyHostToDevice));
+    }
+
+    cudpp_app::StopWatch timer;
+    int failed = 0;
+
+    // COO to CSR
+    std::vector<unsigned int> refOffsets, refCols, offsets, cols;
+    std::vector<float> refValues, values;
+    cooToCsrGold(refOffsets, refCols, refValues, cooRows, cooCols, cooValues, numRows);
+
+    timer.reset();
+    timer.start();
+    CUDPPResult result = cudppSparseCooToCsr(plan, d_offsets, d_cols, d_values,
+                                             d_cooRows, d_cooCols, d_cooValues,
+                                             nnz, numRows);
+    cudaThreadSynchronize();
+    timer.stop();
+    float cooTime = timer.getTime();
+
+    if (result != CUDPP_SUCCESS)
+        failed = 1;
+    else
+    {
+        copyCsrToHost(offsets, cols, values, d_offsets, d_cols, d_values, numRows, nnz);
+        failed = compareCsr(offsets, cols, values, refOffsets, refCols, refValues, quiet);
+    }
+
+    // transpose, against a CSR conversion of the swapped COO input
+    std::vector<unsigned int> refTOffsets, refTCols, tOffsets, tCols;
+    std::vector<float> refTValues, tValues;
+    cooToCsrGold(refTOffsets, refTCols, refTValues, cooCols, cooRows, cooValues, numCols);
+
+    timer.reset();
+    timer.start();
+    result = cudppSparseTranspose(plan, d_tOffsets, d_tCols, d_tValues,
+                                  d_offsets, d_cols, d_values, numRows, numCols, nnz);
+    cudaThreadSynchronize();
+    timer.stop();
+    float transposeTime = timer.getTime();
+
+    if (!failed)
+    {
+        if (result != CUDPP_SUCCESS)
+            failed = 1;
+        else
+        {
+            copyCsrToHost(tOffsets, tCols, tValues, d_tOffsets, d_tCols, d_tValues,
+                          numCols, nnz);
+            failed = compareCsr(tOffsets, tCols, tValues, refTOffsets, refTCols,
+                                refTValues, quiet);
+        }
+    }
+
+    // the transpose of the transpose is the original matrix
+    if (!failed)
+    {
+        result = cudppSparseTranspose(plan, d_offsets, d_cols, d_values,
+                                      d_tOffsets, d_tCols, d_tValues, numCols, numRows, nnz);
+        if (result != CUDPP_SUCCESS)
+            failed = 1;
+        else
+        {
+            copyCsrToHost(offsets, cols, values, d_offsets, d_cols, d_values, numRows, nnz);
+            failed = compareCsr(offsets, cols, values, refOffsets, refCols, refValues, quiet);
+        }
+    }
+
+    if (!quiet)
+    {
+        printf("%s %u x %u, %u nonzeros: COO to CSR %f ms, transpose %f ms: test %s\n",
+               sparseConvertPatternName(pattern), numRows, numCols, nnz,
+               cooTime, transposeTime, failed ? "FAILED" : "PASSED");
+    }
+
+    CUDA_SAFE_CALL(cudaFree(d_cooRows));
+    CUDA_SAFE_CALL(cudaFree(d_cooCols));
+    CUDA_SAFE_CALL(cudaFree(d_cooValues));
+    CUDA_SAFE_CALL(cudaFree(d_cols));
+    CUDA_SAFE_CALL(cudaFree(d_values));
+    CUDA_SAFE_CALL(cudaFree(d_tCols));
+    CUDA_SAFE_CALL(cudaFree(d_tValues));
+    CUDA_SAFE_CALL(cudaFree(d_offsets));
+    CUDA_SAFE_CALL(cudaFree(d_tOffsets));
+
+    return failed;
+}
+
+/**
+ * testSparseConvert tests cudpp's COO to CSR conversion and CSR transpose.
+ * Possible command line arguments:
+ * - --n=#, number of nonzeros (default: a set of sizes and patterns)
+ * @param argc Number of arguments on the command line, passed
+ * directly from main
+ * @param argv Array of arguments on the command line, passed directly
+ * from main
+ * @return Number of tests that failed regression (0 for all pass)
+ * @see cudppSparseCooToCsr, cudppSparseTranspose
+ */
+int testSparseConvert(int argc, const char **argv)
+{
+    int retval = 0;
+    int cmdVal;
+
+    bool quiet = checkCommandLineFlag(argc, argv, "quiet");
+
+    // nonzeros, rows and columns; includes an empty matrix, a square and a
+    // wide and tall rectangular matrix
+    unsigned int test[][3] = { {       0,     100,    100 },
+                               {    1000,     100,    300 },
+                               {  100000,   20000,  20000 },
+                               { 1000000,    5000, 300000 },
+                               { 1000000,  300000,   5000 } };
+    unsigned int numTests = sizeof(test) / sizeof(test[0]);
+
+    if (commandLineArg(cmdVal, argc, (const char**)argv, "n"))
+    {
+        test[0][0] = cmdVal;
+        test[0][1] = test[0][2] = std::max(cmdVal / 10, 1);
+        numTests = 1;
+    }
+
+    unsigned int maxNonZeros = 0, maxDim = 0;
+    for (unsigned int k = 0; k < numTests; ++k)
+    {
+        maxNonZeros = std::max(maxNonZeros, test[k][0]);
+        maxDim = std::max(maxDim, std::max(test[k][1], test[k][2]));
+    }
+
+    CUDPPHandle theCudpp;
+    CUDPPResult result = cudppCreate(&theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_SPARSE_CONVERT;
+    config.op = CUDPP_OPERATOR_INVALID;
+    config.datatype = CUDPP_FLOAT;
+    config.options = 0;
+
+    CUDPPHandle plan;
+    result = cudppPlan(theCudpp, &plan, config, maxNonZeros, maxDim, 0);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error in plan creation\n");
+        cudppDestroy(theCudpp);
+        return 1;
+    }
+
+    SparseConvertPattern patterns[] = { SPARSE_UNIFORM, SPARSE_POWER_LAW, SPARSE_EMPTY_ROWS };
+    srand(44);
+
+    for (unsigned int k = 0; k < numTests; ++k)
+    {
+        for (unsigned int p = 0; p < sizeof(patterns) / sizeof(patterns[0]); ++p)
+        {
+            retval += sparseConvertTest(plan, patterns[p], test[k][1], test[k][2],
+                                        test[k][0], quiet);
+        }
+    }
+
+    // sizes beyond the plan are rejected
+    result = cudppSparseCooToCsr(plan, NULL, NULL, NULL, NULL, NULL, NULL,
+                                 maxNonZeros + 1, maxDim);
+    if (result != CUDPP_ERROR_ILLEGAL_CONFIGURATION)
+    {
+        if (!quiet)
+            printf("cudppSparseCooToCsr accepted more nonzeros than the plan: test FAILED\n");
+        retval++;
+    }
+    printf("\n");
+
+    result = cudppDestroyPlan(plan);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error destroying CUDPPPlan for sparse conversion\n");
+        retval++;
+    }
+
+    result = cudppDestroy(theCudpp);
+    if (result != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+        retval++;
+    }
+
+    return retval;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -16,12 +16,16 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 #include <limits.h>
+#include <float.h>
+#include <math.h>
+#include <algorithm>
 #include <cuda_runtime_api.h>
 
 #include "cudpp.h"
-#include "sparse.h"
 #include "cudpp_testrig_options.h"
 #include "cudpp_testrig_utils.h"
 #include "cuda_util.h"
@@ -32,9 +36,6 @@
 
 using namespace cudpp_app;
 
-extern "C" void sparseMatrixVectorMultiplyGold(const MMMatrix * m, const float * x, float * y);
-extern "C" void readMatrixMarket(MMMatrix * m, const char * filename);
-
 /** just plain fopen, but if it doesn't work, lop off subdirectories 
  * until it does */
 /*std::string findValidFile(const std::string &fileName)
@@ -66,10 +67,702 @@ extern "C" void readMatrixMarket(MMMatrix * m, const char * filename);
 }*/
 
 
+/** Row-length patterns of the generated test matrices, chosen so that
+ *  each of the sparse matrix-vector kernels is selected */
+enum SpmvTestPattern
+{
+    SPMV_TEST_SHORT_ROWS,   //!< 0-5 nonzeros per row: one thread per row
+    SPMV_TEST_BANDED,       //!< 9 diagonals: a vector of threads per row
+    SPMV_TEST_WIDE_BAND,    //!< 41 diagonals: a warp per row
+    SPMV_TEST_POWER_LAW     //!< Mostly short rows, a few very long ones: merge path
+};
+
+static const char *spmvTestPatternNames[] = 
+    { "short rows", "banded", "wide band", "power-law" };
+
+/**
+ * Generates a square CSR matrix with the given row-length pattern.  Values
+ * are small integers so that results are exact regardless of summation
+ * order, and also when the values are stored as half or bfloat16.  The
+ * arrays are allocated with malloc.
+ *
+ * @param pattern The row-length pattern of the matrix
+ * @param rows The number of rows (and columns) of the matrix
+ * @param[out] rowPtr The start of each row, with rows + 1 entries
+ * @param[out] A The nonzero values
+ * @param[out] indx The column index of each nonzero
+ * @return The number of nonzeros
+ */
+template <typename T>
+unsigned int generateSparseMatrix(SpmvTestPattern pattern, unsigned int rows,
+                                  unsigned int *&rowPtr, T *&A, 
+                                  unsigned int *&indx)
+{
+    const unsigned int halfBand = (pattern == SPMV_TEST_BANDED) ? 4 : 20;
+
+    rowPtr = (unsigned int *) malloc(sizeof(unsigned int) * (rows + 1));
+    rowPtr[0] = 0;
+    for (unsigned int r = 0; r < rows; r++)
+    {
+        unsigned int length = 0;
+        switch (pattern)
+        {
+        case SPMV_TEST_SHORT_ROWS:
+            length = rand() % 6;
+            break;
+        case SPMV_TEST_BANDED:
+        case SPMV_TEST_WIDE_BAND:
+            length = std::min(r + halfBand, rows - 1) + 1 - 
+                     ((r > halfBand) ? r - halfBand : 0);
+            break;
+        case SPMV_TEST_POWER_LAW:
+            // one row spanning many CTAs, a few long rows, many short or empty
+            if (r == rows / 2)
+                length = 4 * rows;
+            else if (rand() % 1000 == 0)
+                length = rand() % rows;
+            else
+                length = rand() % 4;
+            break;
+        }
+        rowPtr[r + 1] = rowPtr[r] + length;
+    }
+
+    const unsigned int entries = rowPtr[rows];
+
+    A = (T *) malloc(sizeof(T) * entries);
+    indx = (unsigned int *) malloc(sizeof(unsigned int) * entries);
+
+    for (unsigned int r = 0; r < rows; r++)
+    {
+        for (unsigned int j = rowPtr[r]; j < rowPtr[r + 1]; j++)
+        {
+            A[j] = (T)(j % 4 + 1);
+            if (pattern == SPMV_TEST_BANDED || pattern == SPMV_TEST_WIDE_BAND)
+                indx[j] = ((r > halfBand) ? r - halfBand : 0) + (j - rowPtr[r]);
+            else
+                indx[j] = rand() % rows;
+        }
+    }
+
+    return entries;
+}
+
+/**
+ * Host reference for the storage cudppSparseMatrix chooses: the bytes of
+ * matrix data (values, column indices and row offsets) read per nonzero
+ * by a multiply.  16-bit indices are used only if the columns of every
+ * block of 256 nonzeros span at most 65535.
+ *
+ * @param config The sparse matrix configuration
+ * @param indx The column index of each nonzero
+ * @param entries The number of nonzeros
+ * @param rows The number of rows
+ * @return Matrix bytes per nonzero
+ */
+double spmvBytesPerNonZero(const CUDPPConfiguration &config, const unsigned int *indx,
+                           unsigned int entries, unsigned int rows)
+{
+    const unsigned int indexBlock = 256;
+    double valueBytes = 
+        (config.options & (CUDPP_OPTION_SPMV_HALF_VALUES | CUDPP_OPTION_SPMV_BFLOAT16_VALUES)) ?
+        2 : (config.datatype == CUDPP_DOUBLE ? 8 : 4);
+
+    bool compressed = (config.options & CUDPP_OPTION_SPMV_16BIT_INDICES) != 0;
+    for (unsigned int b = 0; compressed && b < entries; b += indexBlock)
+    {
+        unsigned int lo = indx[b], hi = indx[b];
+        for (unsigned int j = b; j < std::min(b + indexBlock, entries); j++)
+        {
+            lo = std::min(lo, indx[j]);
+            hi = std::max(hi, indx[j]);
+        }
+        compressed = (hi - lo <= 0xffff);
+    }
+    double indexBytes = compressed ? 2 + 4.0 / indexBlock : 4;
+
+    // row start and end offsets
+    return valueBytes + indexBytes + 8.0 * rows / entries;
+}
+
+/** Short description of the value and index storage of a configuration */
+const char * spmvFormatName(const CUDPPConfiguration &config)
+{
+    bool idx16 = (config.options & CUDPP_OPTION_SPMV_16BIT_INDICES) != 0;
+    if (config.options & CUDPP_OPTION_SPMV_HALF_VALUES)
+        return idx16 ? "half values, 16-bit indices" : "half values";
+    if (config.options & CUDPP_OPTION_SPMV_BFLOAT16_VALUES)
+        return idx16 ? "bfloat16 values, 16-bit indices" : "bfloat16 values";
+    return idx16 ? "16-bit indices" : "full precision";
+}
+
+/**
+ * Multiplies a generated matrix with the given row-length pattern and 
+ * compares against a CPU reference.  y starts nonzero since the multiply
+ * accumulates into it.  Also reports the matrix bytes read per nonzero
+ * for the storage format and the resulting bandwidth.
+ *
+ * @param theCudpp The CUDPP library handle
+ * @param config The sparse matrix configuration (datatype and storage options)
+ * @param pattern The row-length pattern of the matrix
+ * @param rows The number of rows (and columns) of the matrix
+ * @param testOptions The testrig options
+ * @return 0 if the test passed, 1 otherwise
+ */
+template <typename T>
+int spmvGeneratedTest(CUDPPHandle theCudpp, CUDPPConfiguration config, 
+                      SpmvTestPattern pattern, unsigned int rows, 
+                      const testrigOptions &testOptions)
+{
+    unsigned int * rowPtr;
+    T * A;
+    unsigned int * indx;
+    const unsigned int entries = generateSparseMatrix(pattern, rows, rowPtr, A, indx);
+
+    T * x = (T *) malloc(sizeof(T) * rows);
+    T * y = (T *) malloc(sizeof(T) * rows);
+    T * reference = (T *) malloc(sizeof(T) * rows);
+
+    for (unsigned int i = 0; i < rows; i++)
+    {
+        x[i] = (T)(i % 3 + 1);
+        y[i] = (T)(i % 5);
+    }
+
+    for (unsigned int r = 0; r < rows; r++)
+    {
+        reference[r] = y[r];
+        for (unsigned int j = rowPtr[r]; j < rowPtr[r + 1]; j++)
+            reference[r] += A[j] * x[indx[j]];
+    }
+
+    printf("Running %s %s sparse matrix-vector multiply (%s): "
+           "Rows = %d Non-zero entries = %d\n",
+           spmvTestPatternNames[pattern], datatypeToString(config.datatype),
+           spmvFormatName(config), rows, entries);
+
+    T * d_y;
+    T * d_x;
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_x, rows * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_y, rows * sizeof(T)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_x, x, rows * sizeof(T),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(d_y, y, rows * sizeof(T),
+                              cudaMemcpyHostToDevice));
+
+    int retval = 0;
+    CUDPPHandle sparseMatrixHandle;
+    CUDPPResult result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, 
+                                           entries, rows, (void *)A, rowPtr, indx);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error creating Sparse matrix object\n");
+        retval = 1;
+    }
+    else
+    {
+        cudpp_app::StopWatch timer;
+        timer.start();
+        cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
+        cudaThreadSynchronize();
+        timer.stop();
+
+        CUDA_SAFE_CALL(cudaMemcpy(y, d_y, rows * sizeof(T),
+                                  cudaMemcpyDeviceToHost));
+
+        bool spmv_result = compareArrays(reference, y, rows);
+        retval = spmv_result ? 0 : 1;
+
+        if (testOptions.debug)
+        {
+            for (unsigned int i = 0; i < rows; i++)
+            {
+                printf("i: %d\tref: %f\ty: %f\n", i, (double)reference[i], (double)y[i]);
+            }
+        }
+
+        double bytesPerNonZero = spmvBytesPerNonZero(config, indx, entries, rows);
+        printf("sparsemv %s test %s\n", spmvTestPatternNames[pattern],
+               spmv_result ? "PASSED" : "FAILED");
+        printf("Execution time: %f ms, matrix bytes per nonzero: %.2f (%.2f GB/s)\n",
+               timer.getTime(), bytesPerNonZero,
+               bytesPerNonZero * entries / (timer.getTime() * 1.0e6));
+
+        cudppDestroySparseMatrix(sparseMatrixHandle);
+    }
+
+    CUDA_SAFE_CALL(cudaFree(d_x));
+    CUDA_SAFE_CALL(cudaFree(d_y));
+    free(rowPtr);
+    free(A);
+    free(indx);
+    free(x);
+    free(y);
+    free(reference);
+
+    return retval;
+}
+
+/**
+ * Multiplies a generated float matrix with CUDPP_OPTION_ACCUMULATE_DOUBLE
+ * and compares against a double reference.  The values are chosen so that
+ * float dot products visibly drift from that reference on some rows; the
+ * double accumulation must instead be within the final rounding to float
+ * of every row.
+ *
+ * @param theCudpp The CUDPP library handle
+ * @param pattern The row-length pattern of the matrix
+ * @param rows The number of rows (and columns) of the matrix
+ * @param testOptions The testrig options
+ * @return 0 if the test passed, 1 otherwise
+ */
+int spmvAccumulateDoubleTest(CUDPPHandle theCudpp, SpmvTestPattern pattern, 
+                             unsigned int rows, const testrigOptions &testOptions)
+{
+    unsigned int * rowPtr;
+    float * A;
+    unsigned int * indx;
+    const unsigned int entries = generateSparseMatrix(pattern, rows, rowPtr, A, indx);
+
+    // none of these values is exact in float, so every product rounds
+    for (unsigned int j = 0; j < entries; j++)
+        A[j] = 1.1f + 0.1f * (j % 7);
+
+    float * x = (float *) malloc(sizeof(float) * rows);
+    float * y = (float *) malloc(sizeof(float) * rows);
+    double * reference = (double *) malloc(sizeof(double) * rows);
+
+    for (unsigned int i = 0; i < rows; i++)
+    {
+        x[i] = 1.1f + 0.3f * (i % 3);
+        y[i] = 0.7f * (i % 5);
+    }
+
+    // the terms are positive, so the result of a double accumulation is
+    // within half a float ulp of the reference, plus the (much smaller)
+    // rounding of the double sum itself
+    unsigned int drifting = 0;
+    for (unsigned int r = 0; r < rows; r++)
+    {
+        double sum = y[r];
+        float floatSum = y[r];
+        for (unsigned int j = rowPtr[r]; j < rowPtr[r + 1]; j++)
+        {
+            sum += (double)A[j] * (double)x[indx[j]];
+            floatSum += A[j] * x[indx[j]];
+        }
+        reference[r] = sum;
+        double tolerance = 
+            (0.5 * FLT_EPSILON + DBL_EPSILON * (rowPtr[r + 1] - rowPtr[r])) * fabs(sum);
+        if (fabs(floatSum - sum) > tolerance)
+            drifting++;
+    }
+
+    printf("Running %s float sparse matrix-vector multiply (double accumulation): "
+           "Rows = %d Non-zero entries = %d\n",
+           spmvTestPatternNames[pattern], rows, entries);
+
+    float * d_y;
+    float * d_x;
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_x, rows * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_y, rows * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_x, x, rows * sizeof(float),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(d_y, y, rows * sizeof(float),
+                              cudaMemcpyHostToDevice));
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_SPMVMULT;
+    config.datatype = CUDPP_FLOAT;
+    config.options = CUDPP_OPTION_ACCUMULATE_DOUBLE;
+
+    int retval = 0;
+    CUDPPHandle sparseMatrixHandle;
+    CUDPPResult result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, 
+                                           entries, rows, (void *)A, rowPtr, indx);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error creating Sparse matrix object\n");
+        retval = 1;
+    }
+    else
+    {
+        cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
+        CUDA_SAFE_CALL(cudaMemcpy(y, d_y, rows * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
+
+        unsigned int wrong = 0;
+        double maxError = 0;
+        for (unsigned int r = 0; r < rows; r++)
+        {
+            double error = fabs(y[r] - reference[r]);
+            double tolerance = 
+                (0.5 * FLT_EPSILON + DBL_EPSILON * (rowPtr[r + 1] - rowPtr[r])) * 
+                fabs(reference[r]);
+            maxError = std::max(maxError, error / std::max(fabs(reference[r]), DBL_MIN));
+            if (error > tolerance)
+            {
+                if (testOptions.debug)
+                    printf("row %d: ref %.9g y %.9g\n", r, reference[r], (double)y[r]);
+                wrong++;
+            }
+        }
+
+        // the check only means something if float accumulation drifts
+        bool passed = (wrong == 0 && drifting > 0);
+        retval = passed ? 0 : 1;
+
+        printf("rows beyond a float rounding: %d (float accumulation: %d), "
+               "largest relative error %g\n", wrong, drifting, maxError);
+        printf("sparsemv %s double accumulation test %s\n", 
+               spmvTestPatternNames[pattern], passed ? "PASSED" : "FAILED");
+
+        cudppDestroySparseMatrix(sparseMatrixHandle);
+    }
+
+    CUDA_SAFE_CALL(cudaFree(d_x));
+    CUDA_SAFE_CALL(cudaFree(d_y));
+    free(rowPtr);
+    free(A);
+    free(indx);
+    free(x);
+    free(y);
+    free(reference);
+
+    return retval;
+}
+
+/**
+ * Multiplies a generated matrix by a row-major block of \a numVectors
+ * vectors with cudppSparseMatrixMatrixMultiply and compares against a CPU
+ * reference.
+ *
+ * @param theCudpp The CUDPP library handle
+ * @param pattern The row-length pattern of the matrix
+ * @param rows The number of rows (and columns) of the matrix
+ * @param numVectors The number of columns of X and Y
+ * @param testOptions The testrig options
+ * @return 0 if the test passed, 1 otherwise
+ */
+int spmmGeneratedTest(CUDPPHandle theCudpp, SpmvTestPattern pattern, 
+                      unsigned int rows, unsigned int numVectors,
+                      const testrigOptions &testOptions)
+{
+    unsigned int * rowPtr;
+    float * A;
+    unsigned int * indx;
+    const unsigned int entries = generateSparseMatrix(pattern, rows, rowPtr, A, indx);
+
+    const size_t blockSize = (size_t)rows * numVectors;
+    float * X = (float *) malloc(sizeof(float) * blockSize);
+    float * Y = (float *) malloc(sizeof(float) * blockSize);
+    float * reference = (float *) malloc(sizeof(float) * blockSize);
+
+    for (size_t i = 0; i < blockSize; i++)
+    {
+        X[i] = (float)(i % 3 + 1);
+        Y[i] = (float)(i % 5);
+    }
+
+    for (unsigned int r = 0; r < rows; r++)
+    {
+        for (unsigned int v = 0; v < numVectors; v++)
+        {
+            float sum = Y[(size_t)r * numVectors + v];
+            for (unsigned int j = rowPtr[r]; j < rowPtr[r + 1]; j++)
+                sum += A[j] * X[(size_t)indx[j] * numVectors + v];
+            reference[(size_t)r * numVectors + v] = sum;
+        }
+    }
+
+    printf("Running %s sparse matrix-matrix multiply: "
+           "Rows = %d Non-zero entries = %d Vectors = %d\n",
+           spmvTestPatternNames[pattern], rows, entries, numVectors);
+
+    float * d_X;
+    float * d_Y;
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_X, blockSize * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &d_Y, blockSize * sizeof(float)));
+    CUDA_SAFE_CALL(cudaMemcpy(d_X, X, blockSize * sizeof(float),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(d_Y, Y, blockSize * sizeof(float),
+                              cudaMemcpyHostToDevice));
+
+    CUDPPConfiguration config;
+    config.datatype = CUDPP_FLOAT;
+    config.options = (CUDPPOption)0;
+    config.algorithm = CUDPP_SPMVMULT;
+
+    int retval = 0;
+    CUDPPHandle sparseMatrixHandle;
+    CUDPPResult result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, 
+                                           entries, rows, (void *)A, rowPtr, indx);
+
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error creating Sparse matrix object\n");
+        retval = 1;
+    }
+    else
+    {
+        cudpp_app::StopWatch timer;
+        timer.start();
+        result = cudppSparseMatrixMatrixMultiply(sparseMatrixHandle, d_Y, d_X, numVectors);
+        cudaThreadSynchronize();
+        timer.stop();
+
+        CUDA_SAFE_CALL(cudaMemcpy(Y, d_Y, blockSize * sizeof(float),
+                                  cudaMemcpyDeviceToHost));
+
+        bool spmm_result = (result == CUDPP_SUCCESS) && 
+                           compareArrays(reference, Y, (unsigned int)blockSize);
+        retval = spmm_result ? 0 : 1;
+
+        if (testOptions.debug)
+        {
+            for (size_t i = 0; i < blockSize; i++)
+            {
+                printf("i: %ld\tref: %f\tY: %f\n", i, reference[i], Y[i]);
+            }
+        }
+
+        printf("sparsemm %s test %s\n", spmvTestPatternNames[pattern],
+               spmm_result ? "PASSED" : "FAILED");
+        printf("Execution time: %f ms\n", timer.getTime());
+
+        cudppDestroySparseMatrix(sparseMatrixHandle);
+    }
+
+    CUDA_SAFE_CALL(cudaFree(d_X));
+    CUDA_SAFE_CALL(cudaFree(d_Y));
+    free(rowPtr);
+    free(A);
+    free(indx);
+    free(X);
+    free(Y);
+    free(reference);
+
+    return retval;
+}
+
+/**
+ * Writes a generated matrix as a Matrix Market file with its rows in
+ * reverse order, reads it back with cudppReadSparseMatrixFile(), and 
+ * checks the CSR arrays, which must have the columns of each row sorted
+ * with duplicates in file order.  The result is then written as a binary
+ * CSR file and read back.  Finally, a value with trailing characters in
+ * the text file, decreasing row offsets and an out-of-range column index
+ * in the binary file must each be rejected.  The files are removed
+ * afterwards.
+ *
+ * @return Number of tests that failed regression (0 for all pass)
+ */
+int sparseFileTest()
+{
+    const char *textFile = "cudpp_sparse_test.mtx";
+    const char *binaryFile = "cudpp_sparse_test.csr";
+    const unsigned int rows = 1000;
+
+    unsigned int *rowPtr, *indx;
+    float *A;
+    unsigned int entries = 
+        generateSparseMatrix<float>(SPMV_TEST_SHORT_ROWS, rows, rowPtr, A, indx);
+
+    FILE *fp = fopen(textFile, "w");
+    if (!fp)
+    {
+        printf("Cannot write %s\n", textFile);
+        return 1;
+    }
+    fprintf(fp, "%%%%MatrixMarket matrix coordinate real general\n");
+    fprintf(fp, "%% rows in reverse order\n%u %u %u\n", rows, rows, entries);
+    for (unsigned int r = rows; r-- > 0; )
+    {
+        for (unsigned int j = rowPtr[r]; j < rowPtr[r + 1]; j++)
+            fprintf(fp, "%u %u %g\n", r + 1, indx[j] + 1, A[j]);
+    }
+    fclose(fp);
+
+    // reference: stable sort of each row by column
+    for (unsigned int r = 0; r < rows; r++)
+    {
+        for (unsigned int j = rowPtr[r] + 1; j < rowPtr[r + 1]; j++)
+        {
+            for (unsigned int k = j; k > rowPtr[r] && indx[k - 1] > indx[k]; k--)
+            {
+                std::swap(indx[k - 1], indx[k]);
+                std::swap(A[k - 1], A[k]);
+            }
+        }
+    }
+
+    int retval = 0;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        const char *file = pass ? binaryFile : textFile;
+        CUDPPSparseMatrixData m;
+        CUDPPResult result = cudppReadSparseMatrixFile(file, CUDPP_FLOAT, &m);
+
+        bool passed = (result == CUDPP_SUCCESS && m.numRows == rows && 
+                       m.numCols == rows && m.numNonZeroElements == entries &&
+                       memcmp(m.rowOffsets, rowPtr, (rows + 1) * sizeof(unsigned int)) == 0 &&
+                       memcmp(m.colIndices, indx, entries * sizeof(unsigned int)) == 0 &&
+                       memcmp(m.values, A, entries * sizeof(float)) == 0);
+        if (passed && pass == 0)
+            passed = (cudppWriteSparseMatrixFile(binaryFile, &m) == CUDPP_SUCCESS);
+        cudppFreeSparseMatrixData(&m);
+
+        retval += passed ? 0 : 1;
+        printf("sparse matrix %s file test %s\n", pass ? "binary" : "Matrix Market",
+               passed ? "PASSED" : "FAILED");
+    }
+
+    // malformed files: the binary header is 40 bytes, followed by the row
+    // offsets and then the column indices
+    const long offsetsStart = 40;
+    const long indicesStart = offsetsStart + (rows + 1) * sizeof(unsigned int);
+    for (int corruption = 0; corruption < 3; corruption++)
+    {
+        const char *file = corruption ? binaryFile : textFile;
+        if (corruption == 0)
+        {
+            fp = fopen(textFile, "w");
+            if (fp)
+            {
+                fprintf(fp, "%%%%MatrixMarket matrix coordinate real general\n");
+                fprintf(fp, "2 2 2\n1 1 1.0\n2 2 1.5abc\n");
+                fclose(fp);
+            }
+        }
+        else if ((fp = fopen(binaryFile, "r+b")) != NULL)
+        {
+            // a decreasing offset in row 1, or a column index of numCols
+            unsigned int bad = (corruption == 1) ? rowPtr[2] + 1 : rows;
+            fseek(fp, (corruption == 1) ? offsetsStart + sizeof(unsigned int) 
+                                        : indicesStart, SEEK_SET);
+            fwrite(&bad, sizeof(bad), 1, fp);
+            fclose(fp);
+        }
+        if (corruption == 2)
+        {
+            // restore the offset of row 1 corrupted above
+            if ((fp = fopen(binaryFile, "r+b")) != NULL)
+            {
+                fseek(fp, offsetsStart + sizeof(unsigned int), SEEK_SET);
+                fwrite(&rowPtr[1], sizeof(unsigned int), 1, fp);
+                fclose(fp);
+            }
+        }
+
+        CUDPPSparseMatrixData m;
+        bool passed = (fp != NULL && cudppReadSparseMatrixFile(file, CUDPP_FLOAT, &m) ==
+                                     CUDPP_ERROR_ILLEGAL_CONFIGURATION);
+        if (fp != NULL)
+            cudppFreeSparseMatrixData(&m);
+
+        retval += passed ? 0 : 1;
+        printf("sparse matrix malformed file test %d %s\n", corruption,
+               passed ? "PASSED" : "FAILED");
+    }
+
+    remove(textFile);
+    remove(binaryFile);
+    free(rowPtr);
+    free(A);
+    free(indx);
+
+    return retval;
+}
+
+/**
+ * Runs spmvGeneratedTest() for each row-length pattern and storage format,
+ * over a small matrix and one large enough to need many CTAs,
+ * spmvAccumulateDoubleTest() for each pattern, and spmmGeneratedTest() for
+ * several block widths.
+ *
+ * @param testOptions The testrig options
+ * @return Number of tests that failed regression (0 for all pass)
+ */
+int testGeneratedSparseMatrices(const testrigOptions &testOptions)
+{
+    CUDPPHandle theCudpp;
+    if (cudppCreate(&theCudpp) != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error initializing CUDPP Library.\n");
+        return 1;
+    }
+
+    const unsigned int sizes[] = { 37, 200000 };
+    const SpmvTestPattern patterns[] = 
+        { SPMV_TEST_SHORT_ROWS, SPMV_TEST_BANDED, SPMV_TEST_WIDE_BAND, SPMV_TEST_POWER_LAW };
+
+    // full-precision float, then each compressed storage format; double
+    // with full and half-precision values
+    const unsigned int formats[] = 
+        { 0,
+          CUDPP_OPTION_SPMV_HALF_VALUES,
+          CUDPP_OPTION_SPMV_BFLOAT16_VALUES,
+          CUDPP_OPTION_SPMV_16BIT_INDICES,
+          CUDPP_OPTION_SPMV_HALF_VALUES | CUDPP_OPTION_SPMV_16BIT_INDICES };
+    const unsigned int doubleFormats[] = { 0, CUDPP_OPTION_SPMV_HALF_VALUES };
+
+    CUDPPConfiguration config;
+    config.algorithm = CUDPP_SPMVMULT;
+
+    int retval = sparseFileTest();
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        for (unsigned int p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++)
+        {
+            config.datatype = CUDPP_FLOAT;
+            for (unsigned int f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+            {
+                config.options = (CUDPPOption)formats[f];
+                retval += spmvGeneratedTest<float>(theCudpp, config, patterns[p], 
+                                                   sizes[s], testOptions);
+            }
+
+            config.datatype = CUDPP_DOUBLE;
+            for (unsigned int f = 0; f < sizeof(doubleFormats) / sizeof(doubleFormats[0]); f++)
+            {
+                config.options = (CUDPPOption)doubleFormats[f];
+                retval += spmvGeneratedTest<double>(theCudpp, config, patterns[p], 
+                                                    sizes[s], testOptions);
+            }
+        }
+    }
+
+    // float products accumulated in double, on rows long enough to drift
+    for (unsigned int p = 0; p < sizeof(patterns) / sizeof(patterns[0]); p++)
+        retval += spmvAccumulateDoubleTest(theCudpp, patterns[p], 200000, testOptions);
+
+    // SpMM: narrow blocks, one pass of the register tile, and several passes;
+    // the long rows of the power-law matrix are split into pieces
+    const unsigned int numVectors[] = { 1, 3, 32, 100, 257 };
+    for (unsigned int v = 0; v < sizeof(numVectors) / sizeof(numVectors[0]); v++)
+    {
+        retval += spmmGeneratedTest(theCudpp, SPMV_TEST_BANDED, 20000, numVectors[v], testOptions);
+        retval += spmmGeneratedTest(theCudpp, SPMV_TEST_POWER_LAW, 20000, numVectors[v], testOptions);
+    }
+
+    if (cudppDestroy(theCudpp) != CUDPP_SUCCESS)
+    {
+        printf("Error shutting down CUDPP Library.\n");
+    }
+
+    return retval;
+}
+
 /**
  * testSparseMatrixVectorMultiply exercises cudpp's sparse matrix-vector functionality.
  * Possible command line arguments:
- * - --mat=filename: path to filename with matrix in MatrixMarket format
+ * - --mat=filename: path to filename with matrix in MatrixMarket format,
+ *   or in the binary format written by cudppWriteSparseMatrixFile().
+ *   Without it, generated matrices that exercise each kernel are tested.
+ * - --cache=filename: write the matrix read with --mat to filename in the
+ *   binary format, for faster loading by later runs.
  * - Also "global" options (see setOptions)
  * @param argc Number of arguments on the command line, passed
  * directly from main
@@ -92,8 +785,7 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
 
     if (!commandLineArg(mfile, argc, (const char**) argv, "mat"))
     {
-        fprintf(stderr, "Error: Must specify matrix with --mat=MATNAME\n");
-        exit(1);
+        return testGeneratedSparseMatrices(testOptions);
     }
 
     char* foundMfile = NULL;
@@ -103,19 +795,34 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
         exit(1);
     }
 
-    MMMatrix m;
-    readMatrixMarket(&m, foundMfile);
+    CUDPPSparseMatrixData m;
+    timer.start();
+    CUDPPResult result = cudppReadSparseMatrixFile(foundMfile, CUDPP_FLOAT, &m);
+    timer.stop();
+    if (result != CUDPP_SUCCESS)
+    {
+        fprintf(stderr, "Error: Unable to read sparse matrix %s\n", foundMfile);
+        cudppFreeSparseMatrixData(&m);
+        return 1;
+    }
+    printf("Read %s in %f ms\n", foundMfile, timer.getTime());
+    timer.reset();
+
+    std::string cacheFile;
+    if (commandLineArg(cacheFile, argc, (const char**) argv, "cache"))
+    {
+        if (cudppWriteSparseMatrixFile(cacheFile.c_str(), &m) != CUDPP_SUCCESS)
+            fprintf(stderr, "Error: Unable to write %s\n", cacheFile.c_str());
+    }
 
-    const unsigned int cols = m.getCols();
-    const unsigned int rows = m.getRows();
-    const unsigned int entries = m.getNumEntries();
+    const unsigned int cols = (unsigned int)m.numCols;
+    const unsigned int rows = (unsigned int)m.numRows;
+    const unsigned int entries = (unsigned int)m.numNonZeroElements;
+    const float * A = (const float *)m.values;
 
     printf("Rows = %d Cols = %d Non-zero entries = %d\n", rows, cols, entries);
     
     float * reference = (float *) malloc(sizeof(float) * rows);
-    float * A = (float *) malloc(sizeof(float) * entries);
-    unsigned int * indx = 
-        (unsigned int *) malloc(sizeof(unsigned int) * entries);
     float * y = (float *) malloc(sizeof(float) * rows);
     float * x = (float *) malloc(sizeof(float) * cols);
 
@@ -130,12 +837,6 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
         reference[i] = 0.0f;
     }
 
-    for (unsigned i = 0; i < entries; i++)
-    {
-        A[i] = m[i].getEntry();
-        indx[i] = m[i].getCol();
-    }
-
     // allocate device memory input, output, and temp arrays
     float * d_y;
     float * d_x;
@@ -153,7 +854,6 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
     config.options = (CUDPPOption)0;
     config.algorithm = CUDPP_SPMVMULT;
 
-    CUDPPResult result = CUDPP_SUCCESS;
     CUDPPHandle theCudpp;
     result = cudppCreate(&theCudpp);
     
@@ -166,7 +866,7 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
     CUDPPHandle sparseMatrixHandle;
     
     result = cudppSparseMatrix(theCudpp, &sparseMatrixHandle, config, entries, 
-                               rows, (void *)A, m.getRowPtrs(), indx);
+                               rows, A, m.rowOffsets, m.colIndices);
 
     if (result != CUDPP_SUCCESS)
     {
@@ -178,7 +878,11 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
     cudppSparseMatrixVectorMultiply(sparseMatrixHandle, d_y, d_x);
     
     // Compute gold comparison
-    sparseMatrixVectorMultiplyGold(&m, x, reference);
+    for (unsigned int i = 0; i < rows; i++)
+    {
+        for (unsigned int j = m.rowOffsets[i]; j < m.rowOffsets[i + 1]; j++)
+            reference[i] += A[j] * x[m.colIndices[j]];
+    }
     
     for (int i = 0; i < testOptions.numIterations; i++)
     {
@@ -235,9 +939,8 @@ testSparseMatrixVectorMultiply(int argc, const char** argv)
 
     free(reference);
     free(y);
-    free(A);
     free(x);
-    free(indx);
+    cudppFreeSparseMatrixData(&m);
 
     CUDA_SAFE_CALL(cudaFree(d_x));
     CUDA_SAFE_CALL(cudaFree(d_y));
@@ -67,33 +67,84 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
     {
         oneTest = true;
     }
-
-    int systemSizes[] = { 5, 32, 39, 128, 177, 255, 256, 500, 512 };
+    commandLineArg(numSystems, argc, argv, "numsystems");
+
+    // sizes cover the one-thread-per-system Thomas solver (<= 64), CR-PCR
+    // (powers of two), CR-Thomas (other sizes that fit in shared memory)
+    // and the partitioned solver (larger systems, including a last
+    // partition one equation longer than the rest); the final test uses
+    // more systems than fit in a 1D grid
+    int systemSizes[] = { 1, 5, 17, 32, 39, 64, 65, 128, 177, 255, 256, 500, 
+                          512, 1000, 1025, 4000, 4033, 20000, 17 };
+    int systemCounts[] = { 512, 512, 512, 512, 512, 512, 512, 512, 512, 512, 
+                           512, 512, 512, 512, 512, 512, 512, 64, 70000 };
 
     int numTests = sizeof(systemSizes) / sizeof(int);
 
+    // block-tridiagonal systems are solved one per thread, so the sizes
+    // are smaller
+    int blockSystemSizes[] = { 1, 5, 17, 100, 1000, 17 };
+    int blockSystemCounts[] = { 512, 512, 512, 512, 64, 70000 };
+
+    const bool periodic = (config.options & CUDPP_OPTION_PERIODIC) != 0;
+    const int blockSize = (config.options & CUDPP_OPTION_BLOCK_2X2) ? 2 :
+                          (config.options & CUDPP_OPTION_BLOCK_4X4) ? 4 : 1;
+
+    int *sizes = systemSizes;
+    int *counts = systemCounts;
+    if (blockSize > 1)
+    {
+        sizes = blockSystemSizes;
+        counts = blockSystemCounts;
+        numTests = sizeof(blockSystemSizes) / sizeof(int);
+    }
+    else if (periodic)
+    {
+        // periodic systems need at least 3 equations
+        sizes++;
+        counts++;
+        numTests--;
+    }
+
     if (oneTest)
     {
-        systemSizes[0] = systemSize;
+        sizes[0] = systemSize;
+        counts[0] = numSystems;
         numTests = 1;
     }
 
+    const char *variant = periodic ? "periodic " : 
+        (blockSize == 2) ? "2x2 block " : (blockSize == 4) ? "4x4 block " : "";
+
     for (int k = 0; k < numTests; k++)
     {
-        systemSize = systemSizes[k];
-        const unsigned int memSize = sizeof(T)*numSystems*systemSize;
-
-        T* a = (T*) malloc(memSize);
-        T* b = (T*) malloc(memSize);
-        T* c = (T*) malloc(memSize);
-        T* d = (T*) malloc(memSize);
-        T* x1 = (T*) malloc(memSize);
-        T* x2 = (T*) malloc(memSize);
+        systemSize = sizes[k];
+        numSystems = counts[k];
+        const size_t vecSize = sizeof(T)*(size_t)numSystems*systemSize*blockSize;
+        const size_t matSize = vecSize*blockSize;
+
+        T* a = (T*) malloc(matSize);
+        T* b = (T*) malloc(matSize);
+        T* c = (T*) malloc(matSize);
+        T* d = (T*) malloc(vecSize);
+        T* x1 = (T*) malloc(vecSize);
+        T* x2 = (T*) malloc(vecSize);
 
         for (int i = 0; i < numSystems; i++)
         {
-            testGeneration(&a[i*systemSize], &b[i*systemSize], &c[i*systemSize], &d[i*systemSize], &x1[i*systemSize], systemSize);
+            size_t offset = (size_t)i*systemSize*blockSize;
+            if (blockSize > 1)
+                blockTestGeneration(&a[offset*blockSize], &b[offset*blockSize], 
+                                    &c[offset*blockSize], &d[offset], &x1[offset], 
+                                    systemSize, blockSize);
+            else if (periodic)
+                periodicTestGeneration(&a[offset], &b[offset], &c[offset], &d[offset], &x1[offset], systemSize);
+            else
+                testGeneration(&a[offset], &b[offset], &c[offset], &d[offset], &x1[offset], systemSize);
         }
+        // the Sherman-Morrison setup must not divide by a zero b[0]
+        if (periodic)
+            b[0] = 0;
 
         // allocate device memory input and output arrays
         T* d_a;
@@ -102,18 +153,18 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
         T* d_d;
         T* d_x;
 
-        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_a,memSize));
-        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_b,memSize));
-        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_c,memSize));
-        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_d,memSize));
-        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_x,memSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_a,matSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_b,matSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_c,matSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_d,vecSize));
+        CUDA_SAFE_CALL( cudaMalloc( (void**) &d_x,vecSize));
 
        // copy host memory to device input array
-        CUDA_SAFE_CALL( cudaMemcpy( d_a, a, memSize, cudaMemcpyHostToDevice));
-        CUDA_SAFE_CALL( cudaMemcpy( d_b, b, memSize, cudaMemcpyHostToDevice));
-        CUDA_SAFE_CALL( cudaMemcpy( d_c, c, memSize, cudaMemcpyHostToDevice));
-        CUDA_SAFE_CALL( cudaMemcpy( d_d, d, memSize, cudaMemcpyHostToDevice));
-        CUDA_SAFE_CALL( cudaMemcpy( d_x, x1, memSize, cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL( cudaMemcpy( d_a, a, matSize, cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL( cudaMemcpy( d_b, b, matSize, cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL( cudaMemcpy( d_c, c, matSize, cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL( cudaMemcpy( d_d, d, vecSize, cudaMemcpyHostToDevice));
+        CUDA_SAFE_CALL( cudaMemcpy( d_x, x1, vecSize, cudaMemcpyHostToDevice));
 
         // warm up the GPU to avoid the overhead time for the next timing
         CUDPPResult err = cudppTridiagonal(tridiagonalPlan, 
@@ -139,10 +190,10 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
        }
         
         if (!quiet)
-            printf("Running a %s CR-PCR tridiagonal solver solving %d "
+            printf("Running a %s %stridiagonal solver solving %d "
                    "systems of %d equations\n", 
                    config.datatype == CUDPP_FLOAT ? "fp32" : "fp64",
-                   numSystems, systemSize);
+                   variant, numSystems, systemSize);
         
         cudpp_app::StopWatch timer;
         timer.reset();
@@ -172,7 +223,7 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
             printf("%f\n", timer.getTime());
         
         // copy result from device to host
-        CUDA_SAFE_CALL( cudaMemcpy(x2, d_x, memSize, cudaMemcpyDeviceToHost));
+        CUDA_SAFE_CALL( cudaMemcpy(x2, d_x, vecSize, cudaMemcpyDeviceToHost));
 
         // cleanup memory
         CUDA_SAFE_CALL(cudaFree(d_a));
@@ -181,17 +232,48 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
         CUDA_SAFE_CALL(cudaFree(d_d));
         CUDA_SAFE_CALL(cudaFree(d_x));
 
+        // the host solver, run before the reference overwrites c and d;
+        // block systems are not supported on the host
+        T* x3 = (T*) malloc(vecSize);
+        timer.reset();
+        timer.start();
+        CUDPPResult hostErr = cudppTridiagonalHost(tridiagonalPlan, a, b, c, d, x3,
+                                                   systemSize, numSystems);
+        timer.stop();
+        if (!quiet && blockSize == 1)
+            printf("Host solver execution time: %f ms\n", timer.getTime());
+
         timer.reset();
         timer.start();
         
-        serialManySystems<T>(a,b,c,d,x1,systemSize,numSystems);
+        for (int i = 0; i < numSystems && blockSize > 1; i++)
+        {
+            size_t offset = (size_t)i*systemSize*blockSize;
+            serialBlock<T>(&a[offset*blockSize], &b[offset*blockSize], 
+                           &c[offset*blockSize], &d[offset], &x1[offset], 
+                           systemSize, blockSize);
+        }
+        for (int i = 0; i < numSystems && periodic; i++)
+        {
+            size_t offset = (size_t)i*systemSize;
+            serialPeriodic<T>(&a[offset], &b[offset], &c[offset], &d[offset], 
+                              &x1[offset], systemSize);
+        }
+        if (blockSize == 1 && !periodic)
+            serialManySystems<T>(a,b,c,d,x1,systemSize,numSystems);
 
         timer.stop();            
         if (!quiet)
             printf("CPU execution time: %f ms\n", timer.getTime());
         
-        int failed = compareManySystems<T>(x1, x2, systemSize, numSystems, 0.001f);
+        int failed = compareManySystems<T>(x1, x2, systemSize*blockSize, numSystems, 0.001f);
         retval += failed;
+
+        int hostFailed = (blockSize > 1) ? (hostErr != CUDPP_ERROR_ILLEGAL_CONFIGURATION) :
+            (hostErr != CUDPP_SUCCESS) ? 1 :
+            compareManySystems<T>(x1, x3, systemSize, numSystems, 0.001f);
+        retval += hostFailed;
+        failed += hostFailed;
         
         if (!quiet)
         {
@@ -208,6 +290,7 @@ int testTridiagonalDataType(int argc, const char** argv, CUDPPConfiguration &con
         free(d);
         free(x1);
         free(x2);
+        free(x3);
     }
 
     return retval;
@@ -232,6 +315,12 @@ int testTridiagonal(int argc, const char** argv, const CUDPPConfiguration *confi
     else
     {    
         config.datatype = getDatatypeFromArgv(argc, argv);
+        if (checkCommandLineFlag(argc, argv, "periodic"))
+            config.options |= CUDPP_OPTION_PERIODIC;
+        if (checkCommandLineFlag(argc, argv, "block2"))
+            config.options |= CUDPP_OPTION_BLOCK_2X2;
+        if (checkCommandLineFlag(argc, argv, "block4"))
+            config.options |= CUDPP_OPTION_BLOCK_4X4;
     }
     
     
@@ -22,6 +22,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <vector>
+#include <algorithm>
 using namespace std;
 
 template <class T>
@@ -76,6 +78,129 @@ void testGeneration(T *a, T *b, T *c, T *d, T *x, int systemSize)
     c[systemSize-1] = 0;
 }
 
+template <class T>
+void serialPeriodic(const T *a, const T *b, const T *c, const T *d, T *x, int n)
+{
+    // Sherman-Morrison: A = A' + u v^T with u = (gamma, 0, ..., c[n-1])
+    // and v = (1, 0, ..., a[0] / gamma); gamma must not be zero
+    T gamma = (b[0] != 0) ? -b[0] : 1;
+    vector<T> bb(b, b + n), cc(c, c + n), cc2(c, c + n);
+    vector<T> aa(a, a + n), aa2(a, a + n), bb2(n), dd(d, d + n), u(n, 0), z(n);
+    bb[0] = b[0] - gamma;
+    bb[n-1] = b[n-1] - c[n-1] * a[0] / gamma;
+    bb2 = bb;
+    u[0] = gamma;
+    u[n-1] = c[n-1];
+
+    serial(&aa[0], &bb[0], &cc[0], &dd[0], x, n);
+    serial(&aa2[0], &bb2[0], &cc2[0], &u[0], &z[0], n);
+
+    T factor = (x[0] + a[0] * x[n-1] / gamma) / 
+               (1 + z[0] + a[0] * z[n-1] / gamma);
+    for (int i = 0; i < n; i++)
+        x[i] -= factor * z[i];
+}
+
+template <class T>
+void periodicTestGeneration(T *a, T *b, T *c, T *d, T *x, int systemSize)
+{
+    testGeneration(a, b, c, d, x, systemSize);
+    a[0] = 3 + rand01<T>();
+    c[systemSize-1] = 2 + rand01<T>();
+}
+
+/** Solves L X = R for an m x m matrix L and m x k right hand sides R */
+template <class T>
+void denseSolve(T *L, T *R, int m, int k)
+{
+    for (int p = 0; p < m; p++)
+    {
+        int piv = p;
+        for (int r = p + 1; r < m; r++)
+            if (fabs(L[r*m+p]) > fabs(L[piv*m+p])) piv = r;
+        for (int j = 0; j < m; j++) std::swap(L[p*m+j], L[piv*m+j]);
+        for (int j = 0; j < k; j++) std::swap(R[p*k+j], R[piv*k+j]);
+        for (int r = p + 1; r < m; r++)
+        {
+            T f = L[r*m+p] / L[p*m+p];
+            for (int j = p; j < m; j++) L[r*m+j] -= f * L[p*m+j];
+            for (int j = 0; j < k; j++) R[r*k+j] -= f * R[p*k+j];
+        }
+    }
+    for (int p = m - 1; p >= 0; p--)
+    {
+        for (int j = 0; j < k; j++)
+        {
+            T v = R[p*k+j];
+            for (int r = p + 1; r < m; r++) v -= L[p*m+r] * R[r*k+j];
+            R[p*k+j] = v / L[p*m+p];
+        }
+    }
+}
+
+/** Block Thomas with m x m row-major blocks */
+template <class T>
+void serialBlock(const T *a, const T *b, const T *c, const T *d, T *x, 
+                 int n, int m)
+{
+    vector<T> cp(n * m * m), L(m * m), R(m * (m + 1));
+    for (int j = 0; j < n; j++)
+    {
+        for (int r = 0; r < m; r++)
+        {
+            for (int k = 0; k < m; k++)
+            {
+                L[r*m+k] = b[(j*m+r)*m+k];
+                R[r*(m+1)+k] = (j == n - 1) ? 0 : c[(j*m+r)*m+k];
+            }
+            R[r*(m+1)+m] = d[j*m+r];
+            if (j > 0)
+            {
+                for (int l = 0; l < m; l++)
+                {
+                    T arl = a[(j*m+r)*m+l];
+                    for (int k = 0; k < m; k++)
+                        L[r*m+k] -= arl * cp[((j-1)*m+l)*m+k];
+                    R[r*(m+1)+m] -= arl * x[(j-1)*m+l];
+                }
+            }
+        }
+        denseSolve(&L[0], &R[0], m, m + 1);
+        for (int r = 0; r < m; r++)
+        {
+            for (int k = 0; k < m; k++)
+                cp[(j*m+r)*m+k] = R[r*(m+1)+k];
+            x[j*m+r] = R[r*(m+1)+m];
+        }
+    }
+    for (int j = n - 2; j >= 0; j--)
+        for (int r = 0; r < m; r++)
+            for (int k = 0; k < m; k++)
+                x[j*m+r] -= cp[(j*m+r)*m+k] * x[(j+1)*m+k];
+}
+
+template <class T>
+void blockTestGeneration(T *a, T *b, T *c, T *d, T *x, int n, int m)
+{
+    // block diagonally dominant: the diagonal of each b block dominates
+    // the rest of its row in a, b and c
+    for (int j = 0; j < n; j++)
+    {
+        for (int r = 0; r < m; r++)
+        {
+            for (int k = 0; k < m; k++)
+            {
+                int i = (j*m+r)*m+k;
+                a[i] = (j == 0) ? 0 : rand01<T>() - T(0.5);
+                b[i] = (r == k) ? 8 + rand01<T>() : rand01<T>() - T(0.5);
+                c[i] = (j == n - 1) ? 0 : rand01<T>() - T(0.5);
+            }
+            d[j*m+r] = 5 + rand01<T>();
+            x[j*m+r] = 0;
+        }
+    }
+}
+
 template <class T>
 T compare(T *x1, T *x2, int numElements)
 {
@@ -100,20 +100,32 @@
  * to the maximum size.  Also, for things like 32-bit integer scans, 
  * precision often limits the useful maximum size.
  *
- * - CUDPP_SCAN               67,107,840 elements
+ * - CUDPP_SCAN               NO LIMIT (single-row scans); 67,107,840 elements per row
+ *                            (cudppMultiScan)
  * - CUDPP_SEGMENTED_SCAN     67,107,840 elements
- * - CUDPP_COMPACT            67,107,840 elements
- * - CUDPP_COMPRESS           1,048,576 elements
- * - CUDPP_LISTRANK           NO LIMIT
- * - CUDPP_MTF                1,048,576 elements
- * - CUDPP_BWT                1,048,576 elements
- * - CUDPP_SORT               2,147,450,880 elements
+ * - CUDPP_COMPACT            NO LIMIT
+ * - CUDPP_COMPRESS           67,108,864 elements (64 MB)
+ * - CUDPP_LISTRANK           2,147,483,647 elements (next indices are int)
+ * - CUDPP_MTF                4,294,967,295 elements
+ * - CUDPP_BWT                67,108,864 elements (64 MB)
+ * - CUDPP_HUFFMAN            2,147,483,647 elements
+ * - CUDPP_SORT_RADIX         NO LIMIT (use CUDPP_OPTION_64BIT_VALUES for key-value
+ *                            sorts of more than 2^32 elements)
+ * - CUDPP_SORT_MERGE, 
+ *   CUDPP_SORT_STRING        2,147,450,880 elements
+ * - cudppExternalSort        NO LIMIT (sorts chunks of at most the plan size)
  * - CUDPP_REDUCE             NO LIMIT
- * - CUDPP_RAND               33,554,432 elements
- * - CUDPP_SPMVMULT           67,107,840 non-zero elements
+ * - CUDPP_RAND_MD5           33,554,432 elements
+ * - CUDPP_RAND_PHILOX        NO LIMIT
+ * - CUDPP_SPMVMULT           2^32-1 non-zero elements and rows
+ * - CUDPP_SPARSE_CONVERT     2^32-1 non-zero elements; 2^32-2 rows and columns
+ * - CUDPP_EULER_TOUR         1,073,741,823 nodes (the tour of 2n events is list ranked)
+ * - CUDPP_HISTOGRAM          4,294,967,295 elements (counts are unsigned int)
+ * - CUDPP_RLE                4,294,967,295 elements (run lengths are unsigned int)
+ * - CUDPP_REDUCE_BY_KEY      4,294,967,295 elements (groups and counts are unsigned int)
  * - CUDPP_HASH               See \ref hash_space_limitations
- * - CUDPP_TRIDIAGONAL        65535 systems, 1024 equations per system (Compute capability 2.x),
- *                                           512 equations per system (Compute capability < 2.0)
+ * - CUDPP_TRIDIAGONAL        2^31-1 systems of up to 2^31-1 equations (limited by
+ *                            device memory)
  * 
  * \section opSys Operating System Support and Requirements
  * 
@@ -429,6 +441,64 @@ enum CUDPPOption
     CUDPP_OPTION_KEYS_ONLY = 0x20, /**< No associated value to a key 
                                     * (for global radix sort) */
     CUDPP_OPTION_KEY_VALUE_PAIRS = 0x40, /**< Each key has an associated value */
+    CUDPP_OPTION_64BIT_VALUES = 0x80, /**< The values associated with keys are
+                                       * 64-bit (unsigned long long) rather
+                                       * than unsigned int, so that key-index
+                                       * sorts of more than 2^32 elements can
+                                       * be performed (for radix sort only) */
+    CUDPP_OPTION_PERIODIC = 0x100,    /**< The systems are periodic (cyclic):
+                                       * the first equation is coupled to the
+                                       * last unknown and the last equation
+                                       * to the first (for tridiagonal solver
+                                       * only) */
+    CUDPP_OPTION_BLOCK_2X2 = 0x200,   /**< The systems are block-tridiagonal
+                                       * with 2x2 blocks (for tridiagonal
+                                       * solver only) */
+    CUDPP_OPTION_BLOCK_4X4 = 0x400,   /**< The systems are block-tridiagonal
+                                       * with 4x4 blocks (for tridiagonal
+                                       * solver only) */
+    CUDPP_OPTION_RAND_NORMAL = 0x800,      /**< Generate standard normal
+                                            * values (for CUDPP_RAND_PHILOX
+                                            * with float or double only) */
+    CUDPP_OPTION_RAND_EXPONENTIAL = 0x1000,/**< Generate exponential values
+                                            * with rate 1 (for
+                                            * CUDPP_RAND_PHILOX with float
+                                            * or double only) */
+    CUDPP_OPTION_SPMV_HALF_VALUES = 0x2000,    /**< Store sparse matrix values
+                                                * as IEEE half precision and
+                                                * accumulate in the datatype
+                                                * (float or double only) */
+    CUDPP_OPTION_SPMV_BFLOAT16_VALUES = 0x4000,/**< Store sparse matrix values
+                                                * as bfloat16 and accumulate in
+                                                * the datatype (float or double
+                                                * only) */
+    CUDPP_OPTION_SPMV_16BIT_INDICES = 0x8000,  /**< Store sparse matrix column
+                                                * indices as 16-bit offsets from
+                                                * a per-block base column, where
+                                                * the columns allow it */
+    CUDPP_OPTION_DETERMINISTIC = 0x10000,      /**< Combine partial results in
+                                                * an order that depends only on
+                                                * the number of elements, so
+                                                * floating-point results are
+                                                * bit-identical on every device
+                                                * and for every tuning (for
+                                                * scan, segmented scan and
+                                                * reduce; scans always are) */
+    CUDPP_OPTION_ACCUMULATE_DOUBLE = 0x20000,  /**< Keep float inputs and
+                                                * outputs, but combine partial
+                                                * results in double precision
+                                                * (for float scan, segmented
+                                                * scan, reduce and sparse
+                                                * matrix multiply only) */
+    CUDPP_OPTION_64BIT_KEYS = 0x40000,         /**< Keys are 64-bit words rather
+                                                * than 32-bit (for reduce by
+                                                * key only) */
+    CUDPP_OPTION_UNSORTED_KEYS = 0x80000,      /**< Equal keys need not be
+                                                * adjacent: keys are grouped
+                                                * by sorting them, and groups
+                                                * are output in increasing
+                                                * order of their key bits
+                                                * (for reduce by key only) */
 };
 
 
@@ -491,6 +561,13 @@ enum CUDPPAlgorithm
     CUDPP_LISTRANK,          //!< List ranking
     CUDPP_BWT,               //!< Burrows-Wheeler transform
     CUDPP_MTF,               //!< Move-to-Front transform
+    CUDPP_RAND_PHILOX,       //!< Counter-based pseudorandom number generator (Philox4x32-10)
+    CUDPP_SPARSE_CONVERT,    //!< Sparse matrix format conversion (COO to CSR, CSR transpose)
+    CUDPP_EULER_TOUR,        //!< Euler tour, depth, preorder and subtree size of a forest
+    CUDPP_HUFFMAN,           //!< Canonical Huffman coding in independently decodable sub-blocks
+    CUDPP_HISTOGRAM,         //!< Histogram of keys, uniform bins or bins between given edges
+    CUDPP_RLE,               //!< Run-length encoding and decoding
+    CUDPP_REDUCE_BY_KEY,     //!< Reduction of the values of equal keys, and unique keys
     CUDPP_ALGORITHM_INVALID, //!< Placeholder at end of enum
 };
 
@@ -511,6 +588,133 @@ struct CUDPPConfiguration
 #define CUDPP_INVALID_HANDLE 0xC0DABAD1
 typedef size_t CUDPPHandle;
 
+/** @brief Stream on which the asynchronous CUDPP calls issue their work.
+ *
+ * The same type as cudaStream_t, so a stream created by cudaStreamCreate()
+ * can be passed directly; 0 is the default stream.
+ *
+ * @see cudppScanAsync */
+struct CUstream_st;
+typedef struct CUstream_st *CUDPPStream;
+
+/** Symbols per Huffman sub-block.  Each sub-block starts on a word 
+ *  boundary of the encoded stream, so sub-blocks decode in parallel. */
+#define CUDPP_HUFFMAN_SUBBLOCK_SIZE 256
+
+/** Longest Huffman code, in bits.  Codes are length-limited to this. */
+#define CUDPP_HUFFMAN_MAX_CODE_LENGTH 20
+
+/** Words sufficient for the Huffman encoding of \a n symbols */
+#define CUDPP_HUFFMAN_MAX_WORDS(n) \
+    (((n) * CUDPP_HUFFMAN_MAX_CODE_LENGTH + 31) / 32 + \
+     ((n) + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE)
+
+/**
+ * @brief Callback used by cudppExternalSort() to read the next chunk of input.
+ *
+ * Copies up to \a maxElements keys into \a h_keys and, for key-value sorts
+ * (\a h_values is non-null), the same number of values into \a h_values.
+ * Both buffers are in host memory.  Calls are never concurrent, but they
+ * may come from a thread other than the one that called cudppExternalSort().
+ *
+ * @returns the number of elements read; 0 signals the end of the input.
+ *
+ * @see cudppExternalSort
+ */
+typedef size_t (*CUDPPExternalSortReader)(void         *userData,
+                                          void         *h_keys,
+                                          unsigned int *h_values,
+                                          size_t       maxElements);
+
+/**
+ * @brief Callback used by cudppExternalSort() to write the next block of 
+ * sorted output.
+ *
+ * \a h_values is null for keys-only sorts.  Calls are never concurrent,
+ * but during the merge they may come from a thread other than the one
+ * that called cudppExternalSort().
+ *
+ * @returns the number of elements written; anything less than 
+ * \a numElements aborts the sort.
+ *
+ * @see cudppExternalSort
+ */
+typedef size_t (*CUDPPExternalSortWriter)(void               *userData,
+                                          const void         *h_keys,
+                                          const unsigned int *h_values,
+                                          size_t             numElements);
+
+/**
+ * @brief A sparse matrix in compressed sparse row (CSR) format, in host memory.
+ *
+ * Row r holds the nonzeros rowOffsets[r] to rowOffsets[r+1] - 1 of 
+ * \a colIndices and \a values.
+ *
+ * @see cudppReadSparseMatrixFile, cudppSparseMatrix
+ */
+struct CUDPPSparseMatrixData
+{
+    CUDPPDatatype datatype;           //!< The datatype of the values
+    size_t        numRows;            //!< The number of rows
+    size_t        numCols;            //!< The number of columns
+    size_t        numNonZeroElements; //!< The number of nonzeros
+    unsigned int  *rowOffsets;        //!< The first nonzero of each row (numRows + 1 entries)
+    unsigned int  *colIndices;        //!< The column of each nonzero
+    void          *values;            //!< The value of each nonzero
+};
+
+/**
+ * @brief Performance counters of a plan, or of all the plans of an
+ * algorithm.
+ *
+ * Counters are only updated while statistics or tracing are enabled on 
+ * the CUDPP instance (see cudppEnableStatistics()).  Bytes are those of 
+ * the caller's arrays that a call reads and writes, computed from its 
+ * arguments; for outputs of data-dependent size (compressed streams, 
+ * compacted arrays) they are the space the call may write.
+ *
+ * @see cudppGetStatistics, cudppGetPlanStatistics
+ */
+struct CUDPPStatistics
+{
+    unsigned long long calls;        //!< Number of calls
+    double             time;         //!< Device time of the calls, in milliseconds
+    unsigned long long bytesIn;      //!< Bytes read from the caller's arrays
+    unsigned long long bytesOut;     //!< Bytes written to the caller's arrays
+    unsigned long long scratchBytes; //!< Device memory held by the plans for intermediate storage
+    unsigned long long iterations;   //!< Passes over the data: scan levels, merge passes, BWT doubling rounds, list ranking levels, hash table build attempts
+    unsigned long long restarts;     //!< Hash table builds restarted with new hash functions
+};
+
+/**
+ * @brief A call reported to the trace callbacks.
+ *
+ * The begin callback is called before the call issues any work, with
+ * \a startTime, \a time and \a counters zero.  The end callback is called
+ * after the work has completed.
+ *
+ * @see cudppSetTraceCallbacks
+ */
+struct CUDPPTraceEvent
+{
+    const char      *name;        //!< The CUDPP function called, e.g. "cudppScan"
+    CUDPPAlgorithm  algorithm;    //!< Algorithm of the plan (CUDPP_ALGORITHM_INVALID for hash tables)
+    CUDPPHandle     plan;         //!< The plan, sparse matrix or hash table the call used
+    size_t          numElements;  //!< The number of elements the call was given
+    double          startTime;    //!< Start on the device, in milliseconds since instrumentation was enabled
+    double          time;         //!< Device time of the call, in milliseconds
+    CUDPPStatistics counters;     //!< What this call added to the counters of its plan
+};
+
+/**
+ * @brief Callback called at the start and end of each CUDPP call while 
+ * tracing.
+ *
+ * @see cudppSetTraceCallbacks
+ */
+typedef void (*CUDPPTraceCallback)(const CUDPPTraceEvent *event, 
+                                   void                  *userData);
+
 #include "cudpp_config.h"
 
 #ifdef WIN32
@@ -575,12 +779,60 @@ CUDPPResult cudppCompact(const CUDPPHandle  planHandle,
                          const unsigned int *d_isValid,
                          size_t             numElements);
 
+CUDPP_DLL
+CUDPPResult cudppPartition(const CUDPPHandle  planHandle,
+                           void               *d_out, 
+                           size_t             *d_numValidElements,
+                           const void         *d_in, 
+                           const unsigned int *d_isValid,
+                           size_t             numElements);
+
 CUDPP_DLL
 CUDPPResult cudppReduce(const CUDPPHandle planHandle,
                         void              *d_out,
                         const void        *d_in,
                         size_t            numElements);
 
+// Asynchronous variants, which issue all work on a stream
+CUDPP_DLL
+CUDPPResult cudppScanAsync(const CUDPPHandle planHandle,
+                           CUDPPStream       stream,
+                           void              *d_out, 
+                           const void        *d_in, 
+                           size_t            numElements);
+
+CUDPP_DLL
+CUDPPResult cudppMultiScanAsync(const CUDPPHandle planHandle,
+                                CUDPPStream       stream,
+                                void              *d_out, 
+                                const void        *d_in, 
+                                size_t            numElements,
+                                size_t            numRows);
+
+CUDPP_DLL
+CUDPPResult cudppSegmentedScanAsync(const CUDPPHandle  planHandle,
+                                    CUDPPStream        stream,
+                                    void               *d_out, 
+                                    const void         *d_idata,
+                                    const unsigned int *d_iflags,
+                                    size_t             numElements);
+
+CUDPP_DLL
+CUDPPResult cudppCompactAsync(const CUDPPHandle  planHandle,
+                              CUDPPStream        stream,
+                              void               *d_out, 
+                              size_t             *d_numValidElements,
+                              const void         *d_in, 
+                              const unsigned int *d_isValid,
+                              size_t             numElements);
+
+CUDPP_DLL
+CUDPPResult cudppReduceAsync(const CUDPPHandle planHandle,
+                             CUDPPStream       stream,
+                             void              *d_out,
+                             const void        *d_in,
+                             size_t            numElements);
+
 CUDPP_DLL
 CUDPPResult cudppRadixSort(const CUDPPHandle planHandle,
                       void              *d_keys,                                          
@@ -600,6 +852,37 @@ CUDPPResult cudppStringSort(const CUDPPHandle planHandle,
 						   void              *stringVals,		      
 						   size_t            numElements,
 						   size_t            stringArrayLength);
+
+// Out-of-core sort algorithms
+CUDPP_DLL
+CUDPPResult cudppExternalSort(const CUDPPHandle       planHandle,
+                              CUDPPExternalSortReader reader,
+                              void                    *readerData,
+                              CUDPPExternalSortWriter writer,
+                              void                    *writerData,
+                              const char              *tempDir);
+
+CUDPP_DLL
+CUDPPResult cudppExternalSortFile(const CUDPPHandle planHandle,
+                                  const char        *keysIn,
+                                  const char        *valuesIn,
+                                  const char        *keysOut,
+                                  const char        *valuesOut,
+                                  const char        *tempDir);
+
+// Sparse matrix files
+CUDPP_DLL
+CUDPPResult cudppReadSparseMatrixFile(const char            *filename,
+                                      CUDPPDatatype         datatype,
+                                      CUDPPSparseMatrixData *matrix);
+
+CUDPP_DLL
+CUDPPResult cudppWriteSparseMatrixFile(const char                  *filename,
+                                       const CUDPPSparseMatrixData *matrix);
+
+CUDPP_DLL
+CUDPPResult cudppFreeSparseMatrixData(CUDPPSparseMatrixData *matrix);
+
 // Sparse matrix allocation
 
 CUDPP_DLL
@@ -622,6 +905,36 @@ CUDPPResult cudppSparseMatrixVectorMultiply(const CUDPPHandle sparseMatrixHandle
                                             void        *d_y,
                                             const void  *d_x);
 
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixMatrixMultiply(const CUDPPHandle sparseMatrixHandle,
+                                            void        *d_Y,
+                                            const void  *d_X,
+                                            size_t      numVectors);
+
+// sparse matrix format conversion
+CUDPP_DLL
+CUDPPResult cudppSparseCooToCsr(const CUDPPHandle  planHandle,
+                                unsigned int       *d_rowOffsets,
+                                unsigned int       *d_colIndices,
+                                void               *d_values,
+                                const unsigned int *d_cooRows,
+                                const unsigned int *d_cooCols,
+                                const void         *d_cooValues,
+                                size_t             numNonZeroElements,
+                                size_t             numRows);
+
+CUDPP_DLL
+CUDPPResult cudppSparseTranspose(const CUDPPHandle  planHandle,
+                                 unsigned int       *d_tRowOffsets,
+                                 unsigned int       *d_tColIndices,
+                                 void               *d_tValues,
+                                 const unsigned int *d_rowOffsets,
+                                 const unsigned int *d_colIndices,
+                                 const void         *d_values,
+                                 size_t             numRows,
+                                 size_t             numCols,
+                                 size_t             numNonZeroElements);
+
 // random number generation algorithms
 CUDPP_DLL
 CUDPPResult cudppRand(const CUDPPHandle planHandle,
@@ -632,6 +945,14 @@ CUDPP_DLL
 CUDPPResult cudppRandSeed(const CUDPPHandle planHandle, 
                           unsigned int      seed);
 
+CUDPP_DLL
+CUDPPResult cudppRandStream(const CUDPPHandle planHandle, 
+                            unsigned int      stream);
+
+CUDPP_DLL
+CUDPPResult cudppRandSkipAhead(const CUDPPHandle  planHandle, 
+                               unsigned long long numElements);
+
 // tridiagonal solver algorithms
 CUDPP_DLL
 CUDPPResult cudppTridiagonal(CUDPPHandle planHandle, 
@@ -643,6 +964,16 @@ CUDPPResult cudppTridiagonal(CUDPPHandle planHandle,
                              int systemSize, 
                              int numSystems);
 
+CUDPP_DLL
+CUDPPResult cudppTridiagonalHost(CUDPPHandle planHandle, 
+                                 const void *a, 
+                                 const void *b, 
+                                 const void *c, 
+                                 const void *d, 
+                                 void *x, 
+                                 int systemSize, 
+                                 int numSystems);
+
 // lossless data compression algorithms
 CUDPP_DLL
 CUDPPResult cudppCompress(CUDPPHandle planHandle, 
@@ -655,6 +986,39 @@ CUDPPResult cudppCompress(CUDPPHandle planHandle,
                           void *d_yy,
                           size_t numElements);
 
+// Huffman coding
+CUDPP_DLL
+CUDPPResult cudppHuffmanEncode(CUDPPHandle   planHandle,
+                               unsigned int  *d_compressed,
+                               unsigned char *d_codeLengths,
+                               unsigned int  *d_subBlockOffsets,
+                               const void    *d_in,
+                               size_t        numElements);
+
+CUDPP_DLL
+CUDPPResult cudppHuffmanDecode(CUDPPHandle         planHandle,
+                               void                *d_out,
+                               const unsigned int  *d_compressed,
+                               const unsigned char *d_codeLengths,
+                               const unsigned int  *d_subBlockOffsets,
+                               size_t              numElements);
+
+CUDPP_DLL
+CUDPPResult cudppHuffmanEncodeHost(unsigned int  *compressed,
+                                   unsigned char *codeLengths,
+                                   unsigned int  *subBlockOffsets,
+                                   const void    *in,
+                                   size_t        numElements,
+                                   CUDPPDatatype datatype);
+
+CUDPP_DLL
+CUDPPResult cudppHuffmanDecodeHost(void                *out,
+                                   const unsigned int  *compressed,
+                                   const unsigned char *codeLengths,
+                                   const unsigned int  *subBlockOffsets,
+                                   size_t              numElements,
+                                   CUDPPDatatype       datatype);
+
 // Burrows-Wheeler Transform
 CUDPP_DLL
 CUDPPResult cudppBurrowsWheelerTransform(CUDPPHandle planHandle,
@@ -663,6 +1027,13 @@ CUDPPResult cudppBurrowsWheelerTransform(CUDPPHandle planHandle,
                                          void *d_y,
                                          size_t numElements);
 
+CUDPP_DLL
+CUDPPResult cudppBurrowsWheelerTransformHost(unsigned char       *out,
+                                             int                 *indices,
+                                             const unsigned char *in,
+                                             size_t              numElements,
+                                             size_t              blockSize);
+
 // Move-to-Front Transform
 CUDPP_DLL
 CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
@@ -670,6 +1041,26 @@ CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
                                       void *d_x,
                                       size_t numElements);
 
+CUDPP_DLL
+CUDPPResult cudppInverseMoveToFrontTransform(CUDPPHandle planHandle,
+                                             void *d_a,
+                                             void *d_x,
+                                             size_t numElements);
+
+CUDPP_DLL
+CUDPPResult cudppMoveToFrontChunkSize(CUDPPHandle planHandle,
+                                      unsigned int chunkSize);
+
+CUDPP_DLL
+CUDPPResult cudppMoveToFrontTransformHost(unsigned char       *out,
+                                          const unsigned char *in,
+                                          size_t              numElements);
+
+CUDPP_DLL
+CUDPPResult cudppInverseMoveToFrontTransformHost(unsigned char       *out,
+                                                 const unsigned char *in,
+                                                 size_t              numElements);
+
 // List ranking
 CUDPP_DLL
 CUDPPResult cudppListRank(CUDPPHandle planHandle, 
@@ -679,6 +1070,149 @@ CUDPPResult cudppListRank(CUDPPHandle planHandle,
                           size_t head,
                           size_t numElements);
 
+// Euler tours of trees
+CUDPP_DLL
+CUDPPResult cudppEulerTour(CUDPPHandle  planHandle,
+                           int          *d_depth,
+                           unsigned int *d_preorder,
+                           unsigned int *d_subtreeSize,
+                           unsigned int *d_eulerTour,
+                           const int    *d_parent,
+                           size_t       numNodes);
+
+// Histograms
+CUDPP_DLL
+CUDPPResult cudppHistogram(CUDPPHandle  planHandle,
+                           unsigned int *d_histogram,
+                           const void   *d_in,
+                           size_t       numElements);
+
+CUDPP_DLL
+CUDPPResult cudppHistogramHost(CUDPPHandle  planHandle,
+                               unsigned int *h_histogram,
+                               const void   *h_in,
+                               size_t       numElements);
+
+CUDPP_DLL
+CUDPPResult cudppHistogramKeyBins(CUDPPHandle  planHandle,
+                                  unsigned int numBins,
+                                  long long    firstKey);
+
+CUDPP_DLL
+CUDPPResult cudppHistogramUniformBins(CUDPPHandle  planHandle,
+                                      unsigned int numBins,
+                                      double       lowerLevel,
+                                      double       upperLevel);
+
+CUDPP_DLL
+CUDPPResult cudppHistogramBinEdges(CUDPPHandle  planHandle,
+                                   unsigned int numBins,
+                                   const void   *h_edges);
+
+// Run-length encoding
+CUDPP_DLL
+CUDPPResult cudppRunLengthEncode(CUDPPHandle  planHandle,
+                                 void         *d_values,
+                                 unsigned int *d_runLengths,
+                                 size_t       *d_numRuns,
+                                 const void   *d_in,
+                                 size_t       numElements);
+
+CUDPP_DLL
+CUDPPResult cudppRunLengthDecode(CUDPPHandle        planHandle,
+                                 void               *d_out,
+                                 const void         *d_values,
+                                 const unsigned int *d_runLengths,
+                                 size_t             numRuns,
+                                 size_t             numElements);
+
+CUDPP_DLL
+CUDPPResult cudppRunLengthEncodeHost(void          *values,
+                                     unsigned int  *runLengths,
+                                     size_t        *numRuns,
+                                     const void    *in,
+                                     size_t        numElements,
+                                     CUDPPDatatype datatype);
+
+CUDPP_DLL
+CUDPPResult cudppRunLengthDecodeHost(void               *out,
+                                     const void         *values,
+                                     const unsigned int *runLengths,
+                                     size_t             numRuns,
+                                     CUDPPDatatype      datatype);
+
+// Reduce by key
+CUDPP_DLL
+CUDPPResult cudppReduceByKey(CUDPPHandle  planHandle,
+                             void         *d_keysOut,
+                             void         *d_valuesOut,
+                             unsigned int *d_counts,
+                             size_t       *d_numUnique,
+                             const void   *d_keys,
+                             const void   *d_values,
+                             size_t       numElements);
+
+CUDPP_DLL
+CUDPPResult cudppUnique(CUDPPHandle planHandle,
+                        void        *d_keysOut,
+                        size_t      *d_numUnique,
+                        const void  *d_keys,
+                        size_t      numElements);
+
+CUDPP_DLL
+CUDPPResult cudppReduceByKeyHost(CUDPPHandle  planHandle,
+                                 void         *h_keysOut,
+                                 void         *h_valuesOut,
+                                 unsigned int *h_counts,
+                                 size_t       *numUnique,
+                                 const void   *h_keys,
+                                 const void   *h_values,
+                                 size_t       numElements);
+
+// Instrumentation
+CUDPP_DLL
+CUDPPResult cudppEnableStatistics(CUDPPHandle theCudpp,
+                                  int         enable);
+
+CUDPP_DLL
+CUDPPResult cudppResetStatistics(CUDPPHandle theCudpp);
+
+CUDPP_DLL
+CUDPPResult cudppGetStatistics(CUDPPHandle     theCudpp,
+                               CUDPPAlgorithm  algorithm,
+                               CUDPPStatistics *stats);
+
+CUDPP_DLL
+CUDPPResult cudppGetPlanStatistics(CUDPPHandle     planHandle,
+                                   CUDPPStatistics *stats);
+
+CUDPP_DLL
+CUDPPResult cudppSetTraceCallbacks(CUDPPHandle        theCudpp,
+                                   CUDPPTraceCallback begin,
+                                   CUDPPTraceCallback end,
+                                   void               *userData);
+
+CUDPP_DLL
+CUDPPResult cudppStartTrace(CUDPPHandle theCudpp,
+                            const char  *filename);
+
+CUDPP_DLL
+CUDPPResult cudppStopTrace(CUDPPHandle theCudpp);
+
+// Autotuning
+CUDPP_DLL
+CUDPPResult cudppAutotune(CUDPPHandle              theCudpp,
+                          const CUDPPConfiguration *config,
+                          size_t                   numElements);
+
+CUDPP_DLL
+CUDPPResult cudppLoadTuningDatabase(CUDPPHandle theCudpp,
+                                    const char  *filename);
+
+CUDPP_DLL
+CUDPPResult cudppSaveTuningDatabase(CUDPPHandle theCudpp,
+                                    const char  *filename);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +49,9 @@
   * which do nothing or have a thread which will process less than
   * SCAN_ELTS_PER_THREAD elements.
   *
+  * The calculation uses integer arithmetic so that it is exact for any
+  * \a numElements; compactArray() never passes more than 
+  * ::SCAN_MAX_SEGMENT_SIZE elements, so the results fit in 32 bits.
   *
   * @param[in]  numElements Number of elements to sort
   * @param[out] numThreads Number of threads in each block
@@ -56,14 +59,16 @@
   * @param[out] numEltsPerBlock Number of elements processed per block
   *
   */
-void calculateCompactLaunchParams(const unsigned int numElements,
+void calculateCompactLaunchParams(const size_t numElements,
                  unsigned int       &numThreads, 
                  unsigned int       &numBlocks,
                  unsigned int       &numEltsPerBlock)
 {
-    numBlocks = 
-        max(1, (int)ceil((float)numElements / 
-                         ((float)SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE)));
+    const size_t eltsPerBlock = SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE;
+
+    numBlocks = (unsigned int)((numElements + eltsPerBlock - 1) / eltsPerBlock);
+    if (numBlocks < 1) 
+        numBlocks = 1;
 
     if (numBlocks > 1)
     {  
@@ -71,7 +76,8 @@ void calculateCompactLaunchParams(const unsigned int numElements,
     }    
     else
     {
-        numThreads = (unsigned int)ceil((float)numElements / (float)SCAN_ELTS_PER_THREAD);
+        numThreads = (unsigned int)((numElements + SCAN_ELTS_PER_THREAD - 1) / 
+                                    SCAN_ELTS_PER_THREAD);
     }
 
     numEltsPerBlock = numThreads * SCAN_ELTS_PER_THREAD;
@@ -83,14 +89,27 @@ void calculateCompactLaunchParams(const unsigned int numElements,
   * which does not have null (zero) elements. Also ouputs the number of non-zero 
   * elements in the compacted array. Called by ::cudppCompactDispatch().
   *
-  * The algorithm is straightforward, involving two steps (most of the 
-  * complexity is hidden in scan, invoked with cudppScanDispatch() ).
+  * If \a isPartition, the null elements are not dropped but written after
+  * all the non-null ones, in the same order, so \a d_out is a stable 
+  * partition of \a d_in.  Called by ::cudppPartitionDispatch().
+  *
+  * The input is divided into tiles of SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE
+  * elements, and the flags are read twice without storing any per-element
+  * intermediate:
+  *
+  * -# compactCountValid() counts the valid elements of each tile.
+  * -# scanArray() performs a prefix sum on the (few) tile counts, invoked 
+  *    with cudppScanDispatch(), to compute the output offset of each tile.
+  * -# compactScatter() scans the flags of each tile in shared memory and
+  *    writes each element of \a d_in to its tile's offset plus its rank.
   *
-  * -# scanArray() performs a prefix sum on \a d_isValid to compute output 
-  *                indices.
-  * -# compactData() takes \a d_in and an intermediate array of output indices
-  *    as input and writes the values with valid flags in \a d_isValid into 
-  *    \a d_out using the output indices.
+  * Inputs longer than ::SCAN_MAX_SEGMENT_SIZE are compacted one segment at a
+  * time.  Each segment's output positions are relative to a 64-bit
+  * output offset kept in device memory, which is advanced by the number of
+  * valid elements after each segment, so outputs may exceed 2^32 elements.
+  * Backward compacts process segments from the end of the input.  
+  * Partitions of more than one segment first count the valid elements of
+  * all segments, since the invalid elements are placed after all of them.
   *
   * @param[out] d_out         Array of compacted non-null elements
   * @param[out] d_numValidElements Pointer to unsigned int to store number of 
@@ -102,7 +121,7 @@ void calculateCompactLaunchParams(const unsigned int numElements,
   * @param[in]  plan          Pointer to the plan object used for this compact
   *
   */
-template<class T>
+template<class T, bool isPartition>
 void compactArray(T                      *d_out, 
                   size_t                 *d_numValidElements,
                   const T                *d_in, 
@@ -110,33 +129,146 @@ void compactArray(T                      *d_out,
                   size_t                 numElements,
                   const CUDPPCompactPlan *plan)
 {
+    bool isBackward = (plan->m_config.options & CUDPP_OPTION_BACKWARD) != 0;
+    cudaStream_t stream = plan->m_launchStream;
+
+    // the scan of the tile counts runs on the same stream as the compaction
+    plan->m_scanPlan->m_launchStream = stream;
+
+    size_t numSegments = 
+        (numElements + SCAN_MAX_SEGMENT_SIZE - 1) / SCAN_MAX_SEGMENT_SIZE;
+    if (numSegments < 1)
+        numSegments = 1;
+
     unsigned int numThreads = 0;
     unsigned int numBlocks = 0;
     unsigned int numEltsPerBlock = 0;
 
-    // Calculate CUDA launch parameters - number of blocks, number of threads
-    // @todo What is numEltsPerBlock doing here?
-    calculateCompactLaunchParams((unsigned)numElements, numThreads, numBlocks, numEltsPerBlock);
-
-    // Run prefix sum on isValid array to find the addresses in the compacted
-    // output array where each non-null element of d_in will go to
-    cudppScanDispatch((void*)plan->m_d_outputIndices, (void*)d_isValid, 
-                      numElements, 1, plan->m_scanPlan);
-
-    // For every non-null element in d_in write it to its proper place in the
-    // d_out. This is indicated by the corresponding element in isValid array
-    if (plan->m_config.options & CUDPP_OPTION_BACKWARD)
-        compactData<T, true><<<numBlocks, numThreads>>>(d_out,
-                                                        d_numValidElements,
-                                                        plan->m_d_outputIndices, 
-                                                        d_isValid, d_in, (unsigned)numElements);
-    else
-        compactData<T, false><<<numBlocks, numThreads>>>(d_out, 
-                                                         d_numValidElements,
-                                                         plan->m_d_outputIndices, 
-                                                         d_isValid, d_in, (unsigned)numElements);
+    // the output offset is only needed once there is more than one segment
+    size_t *d_outputBase = 0;
+    size_t *d_numValidTotal = 0;
+    if (numSegments > 1)
+    {
+        d_outputBase = plan->m_d_outputBase;
+        CUDA_SAFE_CALL(cudaMemsetAsync(d_outputBase, 0, sizeof(size_t), stream));
+
+        if (isPartition)
+        {
+            d_numValidTotal = plan->m_d_numValidTotal;
+            CUDA_SAFE_CALL(cudaMemsetAsync(d_numValidTotal, 0, sizeof(size_t), stream));
+
+            for (size_t segment = 0; segment < numSegments; segment++)
+            {
+                size_t start  = segment * SCAN_MAX_SEGMENT_SIZE;
+                size_t length = numElements - start;
+                if (length > SCAN_MAX_SEGMENT_SIZE)
+                    length = SCAN_MAX_SEGMENT_SIZE;
+
+                calculateCompactLaunchParams(length, numThreads, numBlocks, numEltsPerBlock);
+                compactCountValid<<<numBlocks, numThreads, 0, stream>>>
+                    (plan->m_d_blockCounts, d_isValid + start, (unsigned)length);
+                compactAddValidTotal<<<1, SCAN_CTA_SIZE, 0, stream>>>
+                    (d_numValidTotal, plan->m_d_blockCounts, numBlocks);
+                CUDA_CHECK_ERROR("compactArray -- compactAddValidTotal");
+            }
+        }
+    }
+
+    for (size_t i = 0; i < numSegments; i++)
+    {
+        size_t segment = isBackward ? numSegments - 1 - i : i;
+        size_t start   = segment * SCAN_MAX_SEGMENT_SIZE;
+        size_t length  = numElements - start;
+        if (length > SCAN_MAX_SEGMENT_SIZE)
+            length = SCAN_MAX_SEGMENT_SIZE;
+
+        // elements of the segments processed before this one
+        size_t numPreceding = isBackward ? numElements - start - length : start;
+
+        // Calculate CUDA launch parameters - number of blocks, number of threads
+        calculateCompactLaunchParams(length, numThreads, numBlocks, numEltsPerBlock);
+
+        // Count the valid elements of each tile, and run a prefix sum on the
+        // counts to find the output offset of each tile
+        compactCountValid<<<numBlocks, numThreads, 0, stream>>>
+            (plan->m_d_blockCounts, d_isValid + start, (unsigned)length);
+        CUDA_CHECK_ERROR("compactArray -- compactCountValid");
+
+        cudppScanDispatch((void*)plan->m_d_blockOffsets, (void*)plan->m_d_blockCounts, 
+                          numBlocks, 1, plan->m_scanPlan);
+
+        // For every non-null element in d_in write it to its proper place in the
+        // d_out. This is indicated by the corresponding element in isValid array.
+        // The segment processed last writes the final count.
+        if (isBackward)
+            compactScatter<T, true, isPartition><<<numBlocks, numThreads, 0, stream>>>
+                (d_out, d_numValidElements, d_outputBase, 
+                 plan->m_d_blockOffsets, plan->m_d_blockCounts, d_numValidTotal, 
+                 numPreceding, d_isValid + start, d_in + start, (unsigned)length);
+        else
+            compactScatter<T, false, isPartition><<<numBlocks, numThreads, 0, stream>>>
+                (d_out, d_numValidElements, d_outputBase, 
+                 plan->m_d_blockOffsets, plan->m_d_blockCounts, d_numValidTotal, 
+                 numPreceding, d_isValid + start, d_in + start, (unsigned)length);
                                                          
-    CUDA_CHECK_ERROR("compactArray -- compactData");
+        CUDA_CHECK_ERROR("compactArray -- compactScatter");
+
+        // the count so far is the output offset of the next segment
+        if (i < numSegments - 1)
+            CUDA_SAFE_CALL(cudaMemcpyAsync(d_outputBase, d_numValidElements, sizeof(size_t),
+                                           cudaMemcpyDeviceToDevice, stream));
+    }
+}
+
+/** @brief Run compactArray() for the datatype of the plan */
+template <bool isPartition>
+void compactDispatch(void                   *d_out, 
+                     size_t                 *d_numValidElements,
+                     const void             *d_in, 
+                     const unsigned int     *d_isValid,
+                     size_t                 numElements,
+                     const CUDPPCompactPlan *plan)
+{
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+        compactArray<char, isPartition>((char*)d_out, d_numValidElements, 
+                                        (const char*)d_in, d_isValid, numElements, plan);
+        break;
+    case CUDPP_UCHAR:
+        compactArray<unsigned char, isPartition>((unsigned char*)d_out, d_numValidElements, 
+                                                 (const unsigned char*)d_in, d_isValid, 
+                                                 numElements, plan);
+        break;
+    case CUDPP_INT:
+        compactArray<int, isPartition>((int*)d_out, d_numValidElements, 
+                                       (const int*)d_in, d_isValid, numElements, plan);
+        break;
+    case CUDPP_UINT:
+        compactArray<unsigned int, isPartition>((unsigned int*)d_out, d_numValidElements, 
+                                                (const unsigned int*)d_in, d_isValid, 
+                                                numElements, plan);
+        break;
+    case CUDPP_FLOAT:
+        compactArray<float, isPartition>((float*)d_out, d_numValidElements, 
+                                         (const float*)d_in, d_isValid, numElements, plan);
+        break;
+    case CUDPP_DOUBLE:
+        compactArray<double, isPartition>((double*)d_out, d_numValidElements, 
+                                          (const double*)d_in, d_isValid, numElements, plan);
+        break;
+    case CUDPP_LONGLONG:
+        compactArray<long long, isPartition>((long long*)d_out, d_numValidElements, 
+                                             (const long long*)d_in, d_isValid, numElements, plan);
+        break;
+    case CUDPP_ULONGLONG:
+        compactArray<unsigned long long, isPartition>((unsigned long long*)d_out, d_numValidElements, 
+                                                      (const unsigned long long*)d_in, d_isValid, 
+                                                      numElements, plan);
+        break;
+    default:
+        break;
+    }
 }
 
 #ifdef __cplusplus
@@ -147,26 +279,47 @@ extern "C"
 /** @brief Allocate intermediate arrays used by cudppCompact().
   *
   * In addition to the internal CUDPPScanPlan contained in CUDPPCompactPlan,
-  * CUDPPCompact also needs a temporary device array of output indices, which
-  * is allocated by this function.
+  * CUDPPCompact also needs temporary device arrays of the valid element 
+  * count and output offset of each tile, which are allocated by this 
+  * function.
   *
   * @param plan Pointer to CUDPPCompactPlan object within which intermediate 
   *             storage is allocated.
   */
 void allocCompactStorage(CUDPPCompactPlan *plan)
 {
-    CUDA_SAFE_CALL( cudaMalloc((void**)&plan->m_d_outputIndices, sizeof(unsigned int) * plan->m_numElements) );
+    size_t numSegmentElements = plan->m_numElements;
+    if (numSegmentElements > SCAN_MAX_SEGMENT_SIZE)
+    {
+        // tiles are counted one segment at a time (see compactArray())
+        numSegmentElements = SCAN_MAX_SEGMENT_SIZE;
+        CUDA_SAFE_CALL( cudaMalloc((void**)&plan->m_d_outputBase, sizeof(size_t)) );
+        CUDA_SAFE_CALL( cudaMalloc((void**)&plan->m_d_numValidTotal, sizeof(size_t)) );
+    }
+
+    unsigned int numThreads = 0;
+    unsigned int numBlocks = 0;
+    unsigned int numEltsPerBlock = 0;
+    calculateCompactLaunchParams(numSegmentElements, numThreads, numBlocks, numEltsPerBlock);
+
+    CUDA_SAFE_CALL( cudaMalloc((void**)&plan->m_d_blockCounts, sizeof(unsigned int) * numBlocks) );
+    CUDA_SAFE_CALL( cudaMalloc((void**)&plan->m_d_blockOffsets, sizeof(unsigned int) * numBlocks) );
 }
 
 /** @brief Deallocate intermediate storage used by cudppCompact().
   *
-  * Deallocates the output indices array allocated by allocCompactStorage().
+  * Deallocates the tile arrays allocated by allocCompactStorage().
   *
   * @param plan Pointer to CUDPPCompactPlan object initialized by allocCompactStorage().
   */
 void freeCompactStorage(CUDPPCompactPlan *plan)
 {
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_outputIndices));
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_blockCounts));
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_blockOffsets));
+    if (plan->m_d_outputBase)
+        CUDA_SAFE_CALL( cudaFree(plan->m_d_outputBase));
+    if (plan->m_d_numValidTotal)
+        CUDA_SAFE_CALL( cudaFree(plan->m_d_numValidTotal));
 }
 
 /** @brief Dispatch compactArray for the specified datatype.
@@ -192,45 +345,34 @@ void cudppCompactDispatch(void                   *d_out,
                           size_t                 numElements,
                           const CUDPPCompactPlan *plan)
 {
-    switch (plan->m_config.datatype)
-    {
-    case CUDPP_CHAR:
-        compactArray<char>((char*)d_out, d_numValidElements, 
-                           (const char*)d_in, d_isValid, numElements, plan);
-        break;
-    case CUDPP_UCHAR:
-        compactArray<unsigned char>((unsigned char*)d_out, d_numValidElements, 
-                                    (const unsigned char*)d_in, d_isValid, 
-                                    numElements, plan);
-        break;
-    case CUDPP_INT:
-        compactArray<int>((int*)d_out, d_numValidElements, 
-                          (const int*)d_in, d_isValid, numElements, plan);
-        break;
-    case CUDPP_UINT:
-        compactArray<unsigned int>((unsigned int*)d_out, d_numValidElements, 
-                                   (const unsigned int*)d_in, d_isValid, 
-                                   numElements, plan);
-        break;
-    case CUDPP_FLOAT:
-        compactArray<float>((float*)d_out, d_numValidElements, 
-                            (const float*)d_in, d_isValid, numElements, plan);
-        break;
-    case CUDPP_DOUBLE:
-        compactArray<double>((double*)d_out, d_numValidElements, 
-                            (const double*)d_in, d_isValid, numElements, plan);
-        break;
-    case CUDPP_LONGLONG:
-        compactArray<long long>((long long*)d_out, d_numValidElements, 
-                            (const long long*)d_in, d_isValid, numElements, plan);
-        break;
-    case CUDPP_ULONGLONG:
-        compactArray<unsigned long long>((unsigned long long*)d_out, d_numValidElements, 
-                                         (const unsigned long long*)d_in, d_isValid, numElements, plan);
-        break;
-    default:
-        break;
-    }
+    compactDispatch<false>(d_out, d_numValidElements, d_in, d_isValid, 
+                           numElements, plan);
+}
+
+/** @brief Dispatch a stable partition for the specified datatype.
+ *
+ * Like cudppCompactDispatch(), but the elements whose flags are not set
+ * are written to \a d_out too, after all of those whose flags are set.
+ * This is the app-level interface used by cudppPartition().
+ *
+ * @param[out] d_out         Partitioned array, valid elements first
+ * @param[out] d_numValidElements Pointer to a size_t to store the 
+ *                                 number of valid elements
+ * @param[in]  d_in          Input array 
+ * @param[in]  d_isValid     Array of boolean valid flags with same length as 
+ *                           \a d_in
+ * @param[in]  numElements   Number of elements to partition
+ * @param[in]  plan          Pointer to plan object for this partition
+ */
+void cudppPartitionDispatch(void                   *d_out, 
+                            size_t                 *d_numValidElements,
+                            const void             *d_in, 
+                            const unsigned int     *d_isValid,
+                            size_t                 numElements,
+                            const CUDPPCompactPlan *plan)
+{
+    compactDispatch<true>(d_out, d_numValidElements, d_in, d_isValid, 
+                          numElements, plan);
 }
 
 #ifdef __cplusplus
@@ -10,12 +10,19 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <assert.h>
+#include <algorithm>
+#include <vector>
 
 #include "cuda_util.h"
 #include "cudpp_globals.h"
 #include "cudpp.h"
 #include "cudpp_util.h"
 #include "cudpp_plan.h"
+#include "cudpp_manager.h"
+#include "cudpp_scan.h"
+#include "cudpp_radixsort.h"
+#include "cudpp_compress.h"
 
 #include "kernel/compress_kernel.cuh"
 
@@ -34,91 +41,245 @@
  * @{
  */
 
-/** @brief Perform Huffman encoding
- * 
+/** @brief Number of CTAs for a grid-stride Huffman kernel over \a numItems items
  *
- * Performs Huffman encoding on the input data stream. The input data
- * stream is the output data stream from the previous stage (MTF) in our
- * compress stream.
+ * @param[in] numItems Number of items to be processed
+ * @param[in] ctaSize Threads per CTA
+ * @returns The number of CTAs, between 1 and 65535
+ */
+inline unsigned int huffmanNumCTAs(size_t numItems, unsigned int ctaSize)
+{
+    size_t numCTAs = (numItems + ctaSize - 1) / ctaSize;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Perform canonical Huffman encoding
+ *
+ * The symbols are counted by sorting them and finding the bounds of each
+ * symbol's run, and the length-limited code lengths are computed on the
+ * host by package-merge (huffmanCodeLengths()), which is serial but only
+ * touches the alphabet.  The codes are canonical, so the code lengths are
+ * all a decoder needs.  The input is encoded in independent sub-blocks of
+ * ::CUDPP_HUFFMAN_SUBBLOCK_SIZE symbols, one thread each: a first pass
+ * counts the words of each sub-block, a scan places them, and a second
+ * pass writes them.
+ *
+ * @param[out] d_compressed      The encoded stream
+ * @param[out] d_codeLengths     The code length of each symbol of the alphabet
+ * @param[out] d_subBlockOffsets The first word of each sub-block, then the total
+ * @param[in]  d_in              The symbols to encode
+ * @param[in]  numElements       Number of symbols
+ * @param[in]  plan              Pointer to the plan object used for this encoding
+ */
+template <class T>
+void huffmanEncode(unsigned int           *d_compressed,
+                   unsigned char          *d_codeLengths,
+                   unsigned int           *d_subBlockOffsets,
+                   const T                *d_in,
+                   size_t                 numElements,
+                   const CUDPPHuffmanPlan *plan)
+{
+    unsigned int alphabetSize = plan->m_alphabetSize;
+    if (numElements == 0)
+    {
+        CUDA_SAFE_CALL(cudaMemset(d_codeLengths, 0, alphabetSize));
+        CUDA_SAFE_CALL(cudaMemset(d_subBlockOffsets, 0, sizeof(unsigned int)));
+        return;
+    }
+
+    uint n = (uint)numElements;
+    uint numSubBlocks = (uint)((numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) /
+                               CUDPP_HUFFMAN_SUBBLOCK_SIZE);
+    unsigned int ctaSize = plan->m_ctaSize;
+
+    // 1) count the symbols
+    huffmanSymbolKeys<T><<<huffmanNumCTAs(n, ctaSize), ctaSize>>>
+        (plan->m_d_keys, d_in, n);
+    CUDA_CHECK_ERROR("huffmanSymbolKeys");
+
+    cudppRadixSortDispatch(plan->m_d_keys, 0, n, plan->m_sortPlan);
+
+    CUDA_SAFE_CALL(cudaMemset(plan->m_d_runBounds, 0, 2 * alphabetSize * sizeof(uint)));
+    huffmanRunBounds<<<huffmanNumCTAs(n, ctaSize), ctaSize>>>
+        (plan->m_d_runBounds, plan->m_d_keys, n, alphabetSize);
+    CUDA_CHECK_ERROR("huffmanRunBounds");
+
+    // 2) build the canonical code
+    std::vector<unsigned int> bounds(2 * alphabetSize), codes(alphabetSize);
+    std::vector<unsigned char> codeLengths(alphabetSize);
+    CUDA_SAFE_CALL(cudaMemcpy(&bounds[0], plan->m_d_runBounds, 
+                              2 * alphabetSize * sizeof(uint), cudaMemcpyDeviceToHost));
+    for (unsigned int s = 0; s < alphabetSize; ++s)
+        bounds[s] = bounds[alphabetSize + s] - bounds[s];
+    huffmanCodeLengths(&codeLengths[0], &bounds[0], alphabetSize);
+    huffmanCanonicalCodes(&codes[0], &codeLengths[0], alphabetSize);
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_codes, &codes[0], alphabetSize * sizeof(uint),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(d_codeLengths, &codeLengths[0], alphabetSize,
+                              cudaMemcpyHostToDevice));
+
+    // 3) place the sub-blocks
+    huffmanSubBlockWords<T><<<huffmanNumCTAs(numSubBlocks, ctaSize), ctaSize>>>
+        (plan->m_d_blockWords, d_in, d_codeLengths, n, numSubBlocks);
+    CUDA_CHECK_ERROR("huffmanSubBlockWords");
+
+    cudppScanDispatch(d_subBlockOffsets, plan->m_d_blockWords, numSubBlocks + 1, 1,
+                      plan->m_scanPlan);
+
+    // 4) encode them
+    huffmanEncodeSubBlocks<T><<<huffmanNumCTAs(numSubBlocks, ctaSize), ctaSize>>>
+        (d_compressed, d_subBlockOffsets, d_in, plan->m_d_codes, d_codeLengths,
+         n, numSubBlocks);
+    CUDA_CHECK_ERROR("huffmanEncodeSubBlocks");
+}
+
+/** @brief Decode a canonical Huffman stream
+ *
+ * The decoder tables are built on the host from the code lengths
+ * (huffmanDecodeTables()), and each sub-block is decoded by its own
+ * thread with the table-driven decoder.
+ *
+ * @param[out] d_out             The decoded symbols
+ * @param[in]  d_compressed      The encoded stream
+ * @param[in]  d_codeLengths     The code length of each symbol of the alphabet
+ * @param[in]  d_subBlockOffsets The first word of each sub-block, then the total
+ * @param[in]  numElements       Number of symbols
+ * @param[in]  plan              Pointer to the plan object used for this decoding
+ * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION if the code lengths are not 
+ *          those of a prefix code or the stream does not decode,
+ *          otherwise CUDPP_SUCCESS
+ */
+template <class T>
+CUDPPResult huffmanDecode(T                      *d_out,
+                          const unsigned int     *d_compressed,
+                          const unsigned char    *d_codeLengths,
+                          const unsigned int     *d_subBlockOffsets,
+                          size_t                 numElements,
+                          const CUDPPHuffmanPlan *plan)
+{
+    if (numElements == 0)
+        return CUDPP_SUCCESS;
+
+    unsigned int alphabetSize = plan->m_alphabetSize;
+    uint n = (uint)numElements;
+    uint numSubBlocks = (uint)((numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) /
+                               CUDPP_HUFFMAN_SUBBLOCK_SIZE);
+    unsigned int ctaSize = plan->m_ctaSize;
+
+    std::vector<unsigned char> codeLengths(alphabetSize);
+    std::vector<huffman_table_entry> table(1 << HUFF_TABLE_BITS);
+    std::vector<unsigned short> sortedSymbols(alphabetSize);
+    unsigned int firstCode[CUDPP_HUFFMAN_MAX_CODE_LENGTH + 2];
+    unsigned int firstIndex[CUDPP_HUFFMAN_MAX_CODE_LENGTH + 2];
+    CUDA_SAFE_CALL(cudaMemcpy(&codeLengths[0], d_codeLengths, alphabetSize,
+                              cudaMemcpyDeviceToHost));
+    if (!huffmanDecodeTables(&table[0], firstCode, firstIndex, &sortedSymbols[0],
+                             &codeLengths[0], alphabetSize))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_decodeTable, &table[0],
+                              table.size() * sizeof(huffman_table_entry),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_firstCode, firstCode, sizeof(firstCode),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_firstIndex, firstIndex, sizeof(firstIndex),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_sortedSymbols, &sortedSymbols[0],
+                              alphabetSize * sizeof(unsigned short),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemset(plan->m_d_decodeError, 0, sizeof(unsigned int)));
+
+    huffmanDecodeSubBlocks<T><<<huffmanNumCTAs(numSubBlocks, ctaSize), ctaSize>>>
+        (d_out, plan->m_d_decodeError, d_compressed, d_subBlockOffsets,
+         plan->m_d_decodeTable, plan->m_d_firstCode, plan->m_d_firstIndex,
+         plan->m_d_sortedSymbols, n, numSubBlocks);
+    CUDA_CHECK_ERROR("huffmanDecodeSubBlocks");
+
+    unsigned int error;
+    CUDA_SAFE_CALL(cudaMemcpy(&error, plan->m_d_decodeError, sizeof(unsigned int),
+                              cudaMemcpyDeviceToHost));
+    return error ? CUDPP_ERROR_ILLEGAL_CONFIGURATION : CUDPP_SUCCESS;
+}
+
+
+/** @brief Number of CTAs for a grid-stride launch over \a numItems items
  *
- * The input is given by the output of the Move-to-Front transform (MTF).
- * There are a few things that need to be store along with the compressed
- * data. We also store the word offset of the compressed data stream because
- * our data is compressed into indepedent blocks (word granularity) so that
- * they can be encoded and decoded in parallel. The number of independent blocks
- * is HUFF_THREADS_PER_BLOCK*HUFF_WORK_PER_THREAD.
+ * @param[in] numItems Number of items to be processed
+ * @returns The number of CTAs, between 1 and 65535
+ */
+inline unsigned int mtfNumCTAs(size_t numItems)
+{
+    size_t numCTAs = (numItems + MTF_CTA_SIZE - 1) / MTF_CTA_SIZE;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Number of chunk states, over all levels of the state scan
  *
+ * @param[in] numElements Number of symbols
+ * @param[in] chunkSize Number of symbols per chunk
+ * @returns The number of 256-byte states the MTF transforms need
+ */
+inline size_t mtfNumStates(size_t numElements, unsigned int chunkSize)
+{
+    size_t numStates = std::max((size_t)1, (numElements + chunkSize - 1) / chunkSize);
+    size_t total = numStates;
+    while (numStates > 1)
+    {
+        numStates = (numStates + MTF_SCAN_GROUP_SIZE - 1) / MTF_SCAN_GROUP_SIZE;
+        total += numStates;
+    }
+    return total;
+}
+
+/** @brief Replace the state of each chunk by the MTF list before it
  *
- * @param[out] d_hist           Histogram array of the input data stream used for decoding.
- * @param[out] d_encodeOffset   An array of the word offsets of the independent compressed data blocks.
- * @param[out] d_compressedSize Pointer to the total size in words of all compressed data blocks combined.
- * @param[out] d_compressed     A pointer to the compressed data blocks.
- * @param[in]  numElements      Total number of input elements to compress.
- * @param[in]  plan             Pointer to the plan object used for this compress.
+ * An exclusive scan of the chunk states with \a Op::combine, starting 
+ * from the list 0..255.  Groups of ::MTF_SCAN_GROUP_SIZE states are 
+ * combined, one group per thread, into the states of the next level, 
+ * until one state is left; its list is 0..255, and the lists are swept
+ * back down the levels.  The levels follow the chunk states in 
+ * \a d_lists and \a d_sizes.
  *
+ * @param[in,out] d_lists The state of each chunk, then the levels above
+ * @param[in,out] d_sizes The number of symbols in each state
+ * @param[in]     numChunks Number of chunks
  */
-void huffmanEncoding(unsigned int               *d_hist,
-                     unsigned int               *d_encodeOffset,
-                     unsigned int               *d_compressedSize,
-                     unsigned int               *d_compressed,
-                     size_t                     numElements,
-                     const CUDPPCompressPlan    *plan)
+template <class Op>
+void mtfScanStates(unsigned char  *d_lists,
+                   unsigned short *d_sizes,
+                   unsigned int   numChunks)
 {
-    unsigned char* d_input  = plan->m_d_mtfOut;
-    //d_hist                  = plan->m_d_histogram;
-    //d_encodeOffset          = plan->m_d_encodeOffset;
-    //d_compressedSize        = plan->m_d_totalEncodedSize;
-    //d_compressed            = plan->m_d_encodedData;
-
-    // Set work dimensions
-    size_t nCodesPacked = 0;
-    size_t histBlocks = (numElements%(HUFF_WORK_PER_THREAD_HIST*HUFF_THREADS_PER_BLOCK_HIST)==0) ?
-        numElements/(HUFF_WORK_PER_THREAD_HIST*HUFF_THREADS_PER_BLOCK_HIST) : numElements%(HUFF_WORK_PER_THREAD_HIST*HUFF_THREADS_PER_BLOCK_HIST)+1;
-    size_t tThreads = ((numElements%HUFF_WORK_PER_THREAD) == 0) ? numElements/HUFF_WORK_PER_THREAD : numElements/HUFF_WORK_PER_THREAD+1;
-    size_t nBlocks = ( (tThreads%HUFF_THREADS_PER_BLOCK) == 0) ? tThreads/HUFF_THREADS_PER_BLOCK : tThreads/HUFF_THREADS_PER_BLOCK+1;
-
-    dim3 grid_hist(histBlocks, 1, 1);
-    dim3 threads_hist(HUFF_THREADS_PER_BLOCK_HIST, 1, 1);
-
-    dim3 grid_tree(1, 1, 1);
-    dim3 threads_tree(128, 1, 1);
-
-    dim3 grid_huff(nBlocks, 1, 1);
-    dim3 threads_huff(HUFF_THREADS_PER_BLOCK, 1, 1);
-
-    //---------------------------------------
-    //  1) Build histogram from MTF output
-    //---------------------------------------
-    huffman_build_histogram_kernel<<< grid_hist, threads_hist>>>
-        ((unsigned int*)d_input, plan->m_d_histograms, numElements);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-    //----------------------------------------------------
-    //  2) Compute final Histogram + Build Huffman codes
-    //----------------------------------------------------
-    huffman_build_tree_kernel<<< grid_tree, threads_tree>>>
-        (d_input, plan->m_d_huffCodesPacked, plan->m_d_huffCodeLocations, plan->m_d_huffCodeLengths, plan->m_d_histograms,
-         d_hist, plan->m_d_nCodesPacked, d_compressedSize, histBlocks, numElements);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-    //----------------------------------------------
-    //  3) Main Huffman encoding step (encode data)
-    //----------------------------------------------
-    CUDA_SAFE_CALL(cudaMemcpy((void*)&nCodesPacked,  plan->m_d_nCodesPacked, sizeof(size_t), cudaMemcpyDeviceToHost));
-    huffman_kernel_en<<< grid_huff, threads_huff, nCodesPacked*sizeof(unsigned char)>>>
-        ((uchar4*)d_input, plan->m_d_huffCodesPacked, plan->m_d_huffCodeLocations, plan->m_d_huffCodeLengths,
-         plan->m_d_encoded, nCodesPacked, tThreads);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-    //--------------------------------------------------
-    //  4) Pack together encoded data to determine how
-    //     much encoded data needs to be transferred
-    //--------------------------------------------------
-    huffman_datapack_kernel<<<grid_huff, threads_huff>>>
-        (plan->m_d_encoded, d_compressed, d_compressedSize, d_encodeOffset);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
-}
+    // each level is at least MTF_SCAN_GROUP_SIZE times smaller
+    const int maxLevels = 32;
+    size_t offsets[maxLevels];
+    unsigned int counts[maxLevels];
+    int numLevels = 0;
+
+    offsets[0] = 0;
+    counts[0] = numChunks;
+    while (counts[numLevels] > 1)
+    {
+        assert(numLevels + 1 < maxLevels);
+        offsets[numLevels + 1] = offsets[numLevels] + counts[numLevels];
+        counts[numLevels + 1] = 
+            (counts[numLevels] + MTF_SCAN_GROUP_SIZE - 1) / MTF_SCAN_GROUP_SIZE;
+        mtfReduceStates<Op><<<mtfNumCTAs(counts[numLevels + 1]), MTF_CTA_SIZE>>>
+            (d_lists + 256 * offsets[numLevels + 1], d_sizes + offsets[numLevels + 1],
+             d_lists + 256 * offsets[numLevels], d_sizes + offsets[numLevels],
+             counts[numLevels]);
+        CUDA_CHECK_ERROR("mtfReduceStates");
+        numLevels++;
+    }
 
+    mtfInitialList<<<1, 256>>>(d_lists + 256 * offsets[numLevels]);
+    for (int l = numLevels - 1; l >= 0; --l)
+    {
+        mtfDownsweepStates<Op><<<mtfNumCTAs(counts[l + 1]), MTF_CTA_SIZE>>>
+            (d_lists + 256 * offsets[l], d_sizes + offsets[l],
+             d_lists + 256 * offsets[l + 1], counts[l]);
+        CUDA_CHECK_ERROR("mtfDownsweepStates");
+    }
+}
 
 /** @brief Perform the Move-to-Front Transform (MTF)
  * 
@@ -127,6 +288,12 @@ void huffmanEncoding(unsigned int               *d_hist,
  * MTF manipulates the input data stream to improve the performance of
  * entropy encoding.
  *
+ * The input is split into chunks of the plan's chunk size.  The partial
+ * MTF list of each chunk is computed in parallel, the lists are scanned
+ * with mtfScanStates() to give the complete list before each chunk, and
+ * each chunk is encoded from its list.  The output does not depend on 
+ * the chunk size.
+ *
  * @param[in]  d_mtfIn      An array of the input data stream to perform the MTF transform on.
  * @param[out] d_mtfOut     An array to store the output of the MTF transform.
  * @param[in]  numElements  Total number of input elements of the MTF transform.
@@ -139,97 +306,71 @@ void moveToFrontTransform(unsigned char             *d_mtfIn,
                           size_t                    numElements,
                           const T                   *plan)
 {
-    unsigned int npad = numElements-1;
-    npad |= npad >> 1;
-    npad |= npad >> 2;
-    npad |= npad >> 4;
-    npad |= npad >> 8;
-    npad |= npad >> 16;
-    npad++;
-
-    unsigned int nThreads = MTF_THREADS_BLOCK; 
-    unsigned int nLists = npad/MTF_PER_THREAD;
-    unsigned int tThreads = npad/MTF_PER_THREAD;
-    unsigned int offset = 2;
-
-    bool fullBlocks = (tThreads%nThreads == 0);
-    unsigned int nBlocks = (fullBlocks) ? (tThreads/nThreads) : (tThreads/nThreads + 1);
-
-    //-------------------------------------------
-    //  Initial MTF lists + Initial Reduction
-    //-------------------------------------------
-
-    // Set work-item dimensions
-    dim3 grid(nBlocks, 1, 1);
-    dim3 threads(nThreads, 1, 1);
-
-    // Kernel call
-    mtf_reduction_kernel<<< grid, threads>>>
-        (d_mtfIn, plan->m_d_lists, plan->m_d_list_sizes, nLists, offset, numElements);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-    if(nBlocks > 1) 
-    {
-        //----------------------
-        //  MTF Global Reduce
-        //----------------------
-
-        unsigned int init_offset = offset * nThreads;
-        offset = init_offset;
-        tThreads = nBlocks/2;
-        fullBlocks = (tThreads%nThreads == 0);
-        nBlocks = (fullBlocks) ? (tThreads/nThreads) : (tThreads/nThreads + 1);
+    if (numElements == 0)
+        return;
 
-        // Set work dimensions
-        dim3 grid_GLred(nBlocks, 1, 1);
-        dim3 threads_GLred(nThreads, 1, 1);
-
-        while(offset <= nLists)
-        {
-            mtf_GLreduction_kernel<<< grid_GLred, threads_GLred>>>
-                (plan->m_d_lists, plan->m_d_list_sizes, offset, tThreads, nLists);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-            offset *= 2*nThreads;
-        }
+    unsigned int chunkSize = plan->m_mtfChunkSize;
+    unsigned int numChunks = (unsigned int)((numElements + chunkSize - 1) / chunkSize);
 
-        //-----------------------------
-        //  MTF Global Down-sweep
-        //-----------------------------
-        offset = nLists/4;
-        unsigned int lastLevel = 0;
+    mtfEncodeStates<<<mtfNumCTAs(numChunks), MTF_CTA_SIZE>>>
+        (plan->m_d_lists, plan->m_d_list_sizes, d_mtfIn, (unsigned int)numElements,
+         chunkSize, numChunks);
+    CUDA_CHECK_ERROR("mtfEncodeStates");
 
-        // Work-dimensions
-        dim3 grid_GLsweep(nBlocks, 1, 1);
-        dim3 threads_GLsweep(nThreads, 1, 1);
+    mtfScanStates<MtfEncodeOp>(plan->m_d_lists, plan->m_d_list_sizes, numChunks);
 
-        while(offset >= init_offset/2)
-        {
-            lastLevel = offset/nThreads;
-            lastLevel = (lastLevel>=(init_offset/2)) ? lastLevel : init_offset/2;
+    mtfEncodeChunks<<<mtfNumCTAs(numChunks), MTF_CTA_SIZE>>>
+        (d_mtfOut, d_mtfIn, plan->m_d_lists, (unsigned int)numElements, 
+         chunkSize, numChunks);
+    CUDA_CHECK_ERROR("mtfEncodeChunks");
+}
 
-            mtf_GLdownsweep_kernel<<< grid_GLsweep, threads_GLsweep>>>
-                (plan->m_d_lists, plan->m_d_list_sizes, offset, lastLevel, nLists, tThreads);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
+/** @brief Perform the inverse Move-to-Front Transform
+ * 
+ * Like moveToFrontTransform(), but the state of a chunk is the 
+ * permutation its indices apply to the positions of the MTF list, which
+ * is found by decoding the chunk from the list 0..255.
+ *
+ * @param[in]  d_mtfIn      An array of MTF indices.
+ * @param[out] d_mtfOut     An array to store the decoded symbols.
+ * @param[in]  numElements  Total number of input elements.
+ * @param[in]  plan         Pointer to the plan object used for this MTF transform.
+ */
+template <class T>
+void inverseMoveToFrontTransform(unsigned char             *d_mtfIn,
+                                 unsigned char             *d_mtfOut,
+                                 size_t                    numElements,
+                                 const T                   *plan)
+{
+    if (numElements == 0)
+        return;
 
-            offset = lastLevel/2;
-        }
-    }
+    unsigned int chunkSize = plan->m_mtfChunkSize;
+    unsigned int numChunks = (unsigned int)((numElements + chunkSize - 1) / chunkSize);
 
-    //------------------------
-    //      Local Scan
-    //------------------------
-    tThreads = npad/MTF_PER_THREAD;
-    offset = 2;
-    fullBlocks = (tThreads%nThreads == 0);
-    nBlocks = (fullBlocks) ? (tThreads/nThreads) : (tThreads/nThreads + 1);
+    mtfDecodeStates<<<mtfNumCTAs(numChunks), MTF_CTA_SIZE>>>
+        (plan->m_d_lists, plan->m_d_list_sizes, d_mtfIn, (unsigned int)numElements,
+         chunkSize, numChunks);
+    CUDA_CHECK_ERROR("mtfDecodeStates");
 
-    dim3 grid_loc(nBlocks, 1, 1);
-    dim3 threads_loc(nThreads, 1, 1);
+    mtfScanStates<MtfDecodeOp>(plan->m_d_lists, plan->m_d_list_sizes, numChunks);
 
-    mtf_localscan_lists_kernel<<< grid_loc, threads_loc>>>
-        (d_mtfIn, d_mtfOut, plan->m_d_lists, plan->m_d_list_sizes, nLists, offset, numElements);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
+    mtfDecodeChunks<<<mtfNumCTAs(numChunks), MTF_CTA_SIZE>>>
+        (d_mtfOut, d_mtfIn, plan->m_d_lists, (unsigned int)numElements, 
+         chunkSize, numChunks);
+    CUDA_CHECK_ERROR("mtfDecodeChunks");
+}
 
+/** @brief Number of CTAs for a grid-stride BWT kernel over \a numItems items
+ *
+ * @param[in] numItems Number of items to be processed
+ * @param[in] ctaSize Threads per CTA
+ * @returns The number of CTAs, between 1 and 65535
+ */
+inline unsigned int bwtNumCTAs(size_t numItems, unsigned int ctaSize)
+{
+    size_t numCTAs = (numItems + ctaSize - 1) / ctaSize;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
 }
 
 /** @brief Perform the Burrows-Wheeler Transform (BWT)
@@ -241,6 +382,20 @@ void moveToFrontTransform(unsigned char             *d_mtfIn,
  * runs of repeated characters. This bodes well for later stages in
  * compression pipelines which perform better with repeated characters.
  *
+ * The cyclic rotations of the input are sorted by prefix doubling (see
+ * compress_kernel.cuh): each round is a radix sort of 64-bit rank pairs
+ * and a scan that ranks them, and doubles the number of characters
+ * compared.  The work is O(n log n) in the worst case, but the rounds
+ * stop as soon as every rotation has a distinct rank, which for most
+ * inputs takes a few rounds.  Identical rotations of periodic inputs
+ * sort in any order, which does not change the output.
+ *
+ * The number of distinct ranks is copied to pinned host memory without
+ * waiting, and read after the next round's sort has been issued, so the
+ * device is not drained every round to test for convergence.  A round
+ * that follows convergence sorts the rotations in the same order, so at
+ * most one extra sort is done.
+ *
  *
  * @param[in]  d_uncompressed       A char array of the input data stream to perform the BWT on.
  * @param[out] d_bwtIndex           The index at which the original string in the BWT sorts to.
@@ -257,118 +412,68 @@ void burrowsWheelerTransform(unsigned char              *d_uncompressed,
                              size_t                     numElements,
                              const T    *plan)
 {
-    size_t tThreads = (numElements%4 == 0) ? numElements/4 : numElements/4 + 1;
-    size_t nThreads = BWT_CTA_BLOCK;
-    bool fullBlocks = (tThreads%nThreads == 0);
-    uint nBlocks = (fullBlocks) ? (tThreads/nThreads) : (tThreads/nThreads+1);
-    dim3 grid_construct(nBlocks, 1, 1);
-    dim3 threads_construct(nThreads, 1, 1);
-    int numThreads = 64;
-    int secondBlocks;
-    size_t count;
-    size_t mult;
-    size_t numBlocks;
-    int initSubPartitions;
-    int subPartitions;
-    int step;
-
-    // Massage input to create sorting key-value pairs
-    bwt_keys_construct_kernel<<< grid_construct, threads_construct >>>
-        ((uchar4*)d_uncompressed, plan->m_d_bwtInRef,
-         plan->m_d_keys, plan->m_d_values, plan->m_d_bwtInRef2, tThreads);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-    // First satge -- block sort
-    nBlocks = numElements/BWT_BLOCKSORT_SIZE;
-    dim3 grid_blocksort(nBlocks, 1, 1);
-    dim3 threads_blocksort(BWT_CTA_BLOCK, 1, 1);
-
-    blockWiseStringSort<unsigned int, 8><<<grid_blocksort, threads_blocksort>>>
-        (plan->m_d_keys, plan->m_d_values, (const unsigned int*)plan->m_d_bwtInRef, plan->m_d_bwtInRef2, BWT_BLOCKSORT_SIZE, numElements);
-    CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-    // Start merging blocks
-    // Second stage -- merge sorted blocks using simple merge
-    count = 0;
-    mult = 1;
-    numBlocks = nBlocks;
-
-    while(count < 6)
+    if (numElements == 0)
+        return;
+
+    uint n = (uint)numElements;
+    unsigned int ctaSize = plan->m_bwtCtaSize;
+    unsigned int numCTAs = bwtNumCTAs(n, ctaSize);
+
+    bwtInitialRanks<<<numCTAs, ctaSize>>>(plan->m_d_ranks, d_uncompressed, n);
+    CUDA_CHECK_ERROR("bwtInitialRanks");
+
+    // ranks compare the first h characters of each rotation
+    bool numRanksPending = false;
+    for (size_t h = 4; ; h *= 2)
     {
-        if(count%2 == 0)
-        {
-            simpleStringMerge<unsigned int, 2><<<numBlocks, BWT_CTASIZE_simple, sizeof(unsigned int)*(2*BWT_INTERSECT_B_BLOCK_SIZE_simple+2)>>>
-                (plan->m_d_keys, plan->m_d_keys_dev, plan->m_d_values, plan->m_d_values_dev,
-                 plan->m_d_bwtInRef, BWT_BLOCKSORT_SIZE*mult, numBlocks*BWT_BLOCKSORT_SIZE, plan->m_d_bwtInRef2, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
+        plan->m_planManager->addIterations(1);
 
-        }
-        else
-        {
-            simpleStringMerge<unsigned int, 2><<<numBlocks, BWT_CTASIZE_simple, sizeof(unsigned int)*(2*BWT_INTERSECT_B_BLOCK_SIZE_simple+2)>>>
-                (plan->m_d_keys_dev, plan->m_d_keys, plan->m_d_values_dev, plan->m_d_values,
-                 plan->m_d_bwtInRef, BWT_BLOCKSORT_SIZE*mult, numBlocks*BWT_BLOCKSORT_SIZE, plan->m_d_bwtInRef2, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-        }
+        bwtDoublingKeys<<<numCTAs, ctaSize>>>
+            (plan->m_d_keys, plan->m_d_values, plan->m_d_ranks, (uint)(h % n), n);
+        CUDA_CHECK_ERROR("bwtDoublingKeys");
 
-        mult*=2;
-        count++;
-        numBlocks /= 2;
-    }
+        cudppRadixSortDispatch(plan->m_d_keys, plan->m_d_values, n, plan->m_sortPlan);
 
-    // Third stage -- merge remaining blocks using multi-merge
-    initSubPartitions = 2;
-    subPartitions = initSubPartitions;
-    secondBlocks = (2*numBlocks*initSubPartitions+numThreads-1)/numThreads;
-    step = 1;
+        // the sorted rotations now compare 2h characters, all of them
+        // once 2h >= n
+        if (2 * h >= numElements)
+            break;
 
-    while (numBlocks > 1)
-    {
-        if(count%2 == 1)
-        {
-            findMultiPartitions<unsigned int><<<secondBlocks, numThreads>>>
-                (plan->m_d_keys_dev, subPartitions, numBlocks, BWT_BLOCKSORT_SIZE*mult,
-                 plan->m_d_partitionBeginA, plan->m_d_partitionSizeA, plan->m_d_partitionBeginB, plan->m_d_partitionSizeB, BWT_SIZE);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-            stringMergeMulti<unsigned int, 2><<<numBlocks*subPartitions, BWT_CTASIZE_multi, (2*BWT_INTERSECT_B_BLOCK_SIZE_multi+5)*sizeof(unsigned int)>>>
-                (plan->m_d_keys_dev, plan->m_d_keys, plan->m_d_values_dev, plan->m_d_values, plan->m_d_bwtInRef2, subPartitions, numBlocks,
-                 plan->m_d_partitionBeginA, plan->m_d_partitionSizeA, plan->m_d_partitionBeginB, plan->m_d_partitionSizeB, BWT_BLOCKSORT_SIZE*mult, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-        }
-        else
+        // if the ranks of the last round were all distinct, this round 
+        // kept their order, which is final
+        if (numRanksPending)
         {
-            findMultiPartitions<unsigned int><<<secondBlocks, numThreads>>>
-                (plan->m_d_keys, subPartitions, numBlocks, BWT_BLOCKSORT_SIZE*mult,
-                 plan->m_d_partitionBeginA, plan->m_d_partitionSizeA, plan->m_d_partitionBeginB, plan->m_d_partitionSizeB, BWT_SIZE);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-
-            stringMergeMulti<unsigned int, 2><<<numBlocks*subPartitions, BWT_CTASIZE_multi, (2*BWT_INTERSECT_B_BLOCK_SIZE_multi+5)*sizeof(unsigned int)>>>
-                (plan->m_d_keys, plan->m_d_keys_dev, plan->m_d_values, plan->m_d_values_dev, plan->m_d_bwtInRef2, subPartitions, numBlocks,
-                 plan->m_d_partitionBeginA, plan->m_d_partitionSizeA, plan->m_d_partitionBeginB, plan->m_d_partitionSizeB, BWT_BLOCKSORT_SIZE*mult, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
+            CUDA_SAFE_CALL(cudaEventSynchronize(plan->m_numRanksEvent));
+            if (*plan->m_h_numRanks == n)
+                break;
         }
-        numBlocks/=2;
-        subPartitions*=2;
-        count++;
-        mult*=2;
-        step++;
-    }
 
-    // Final stage -- compute BWT and BWT Index using sorted values
-    if(count%2 == 0)
-    {
-        bwt_compute_final_kernel<<< grid_construct, threads_construct >>>
-            (d_uncompressed, plan->m_d_values, d_bwtIndex, d_bwtOut, numElements, tThreads);
-        CUDA_SAFE_CALL(cudaThreadSynchronize());
-    }
-    else
-    {
-        bwt_compute_final_kernel<<< grid_construct, threads_construct >>>
-            (d_uncompressed, plan->m_d_values_dev, d_bwtIndex, d_bwtOut, numElements, tThreads);
-        CUDA_SAFE_CALL(cudaThreadSynchronize());
+        bwtRankFlags<<<numCTAs, ctaSize>>>(plan->m_d_sortRanks, plan->m_d_keys, n);
+        CUDA_CHECK_ERROR("bwtRankFlags");
+
+        cudppScanDispatch(plan->m_d_sortRanks, plan->m_d_sortRanks, n, 1, plan->m_scanPlan);
+
+        CUDA_SAFE_CALL(cudaMemcpyAsync(plan->m_h_numRanks, plan->m_d_sortRanks + n - 1, 
+                                       sizeof(uint), cudaMemcpyDeviceToHost, 0));
+        CUDA_SAFE_CALL(cudaEventRecord(plan->m_numRanksEvent, 0));
+        numRanksPending = true;
+
+        bwtScatterRanks<<<numCTAs, ctaSize>>>
+            (plan->m_d_ranks, plan->m_d_values, plan->m_d_sortRanks, n);
+        CUDA_CHECK_ERROR("bwtScatterRanks");
     }
 
+    // Final stage -- compute BWT and BWT Index using sorted values.  The
+    // ranks are free by now, so an in-place transform is staged there.
+    unsigned char *d_out = (d_bwtOut == d_uncompressed) ? 
+        (unsigned char*)plan->m_d_ranks : d_bwtOut;
+    bwt_compute_final_kernel<<<numCTAs, ctaSize>>>
+        (d_uncompressed, plan->m_d_values, d_bwtIndex, d_out, n,
+         numCTAs * ctaSize);
+    CUDA_CHECK_ERROR("bwt_compute_final_kernel");
+
+    if (d_out != d_bwtOut)
+        CUDA_SAFE_CALL(cudaMemcpy(d_bwtOut, d_out, numElements, cudaMemcpyDeviceToDevice));
 }
 
 /** @brief Wrapper for calling the Burrows-Wheeler Transform (BWT).
@@ -471,18 +576,12 @@ void allocBwtStorage(CUDPPBwtPlan *plan)
     size_t numElts = plan->m_numElements;
     
     // BWT
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_keys), numElts*sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_keys), numElts*sizeof(unsigned long long) ));
     CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_values), numElts*sizeof(unsigned int) ));
-    
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_bwtInRef), numElts*sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_bwtInRef2), numElts*sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_keys_dev), numElts*sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_values_dev), numElts*sizeof(unsigned int) ));
-    
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionBeginA), 1024*sizeof(int)) );
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionSizeA), 1024*sizeof(int)) );
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionBeginB), 1024*sizeof(int)) );
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionSizeB), 1024*sizeof(int)) );
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_ranks), numElts*sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_sortRanks), numElts*sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaMallocHost((void**) &(plan->m_h_numRanks), sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaEventCreateWithFlags(&(plan->m_numRanksEvent), cudaEventDisableTiming));
 }
     
 /** @brief Allocate intermediate arrays used by MTF.
@@ -495,23 +594,43 @@ void allocBwtStorage(CUDPPBwtPlan *plan)
  */
 void allocMtfStorage(CUDPPMtfPlan *plan)
 {
-    // Number of padding
-    size_t tmp = plan->m_numElements-1;
-    tmp |= tmp >> 1;
-    tmp |= tmp >> 2;
-    tmp |= tmp >> 4;
-    tmp |= tmp >> 8;
-    tmp |= tmp >> 16;
-    tmp++;
-    plan->npad = tmp;
-
     // MTF
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_lists), (tmp/MTF_PER_THREAD)*256*sizeof(unsigned char)));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_list_sizes), (tmp/MTF_PER_THREAD)*sizeof(unsigned short)));
-    CUDA_SAFE_CALL(cudaMemset(plan->m_d_lists, 0, (tmp/MTF_PER_THREAD)*256*sizeof(unsigned char)));
-    CUDA_SAFE_CALL(cudaMemset(plan->m_d_list_sizes, 0, (tmp/MTF_PER_THREAD)*sizeof(unsigned short)));
+    size_t numStates = mtfNumStates(plan->m_numElements, plan->m_mtfChunkSize);
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_lists), numStates*256*sizeof(unsigned char)));
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_list_sizes), numStates*sizeof(unsigned short)));
 }
     
+/** @brief Allocate intermediate arrays used by Huffman coding.
+ *
+ *
+ * @param [in,out] plan Pointer to CUDPPHuffmanPlan object containing
+ *                      options and number of elements, which is used
+ *                      to compute storage requirements, and within
+ *                      which intermediate storage is allocated.
+ */
+void allocHuffmanStorage(CUDPPHuffmanPlan *plan)
+{
+    size_t numElts = std::max((size_t)1, plan->m_numElements);
+    size_t numSubBlocks = 
+        (numElts + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+    size_t alphabetSize = plan->m_alphabetSize;
+
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_keys), numElts*sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_runBounds), 2*alphabetSize*sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_codes), alphabetSize*sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_blockWords), (numSubBlocks+1)*sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_decodeTable), 
+                              (1 << HUFF_TABLE_BITS)*sizeof(huffman_table_entry)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_firstCode), 
+                              (CUDPP_HUFFMAN_MAX_CODE_LENGTH+2)*sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_firstIndex), 
+                              (CUDPP_HUFFMAN_MAX_CODE_LENGTH+2)*sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_sortedSymbols), alphabetSize*sizeof(unsigned short)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_decodeError), sizeof(unsigned int)));
+
+    CUDA_CHECK_ERROR("allocHuffmanStorage");
+}
+
 /** @brief Allocate intermediate arrays used by compression.
  *
  *
@@ -524,47 +643,22 @@ void allocMtfStorage(CUDPPMtfPlan *plan)
 void allocCompressStorage(CUDPPCompressPlan *plan)
 {
     size_t numElts = plan->m_numElements;
-    plan->npad = numElts;
     
     // BWT
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_keys), numElts*sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_keys), numElts*sizeof(unsigned long long) ));
     CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_values), numElts*sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_ranks), numElts*sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_sortRanks), numElts*sizeof(unsigned int) ));
     CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_bwtOut), numElts*sizeof(unsigned char) ));
-    
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_bwtInRef), numElts*sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_bwtInRef2), numElts*sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_keys_dev), numElts*sizeof(unsigned int) ));
-    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_values_dev), numElts*sizeof(unsigned int) ));
-    
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionBeginA), 1024*sizeof(int)) );
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionSizeA), 1024*sizeof(int)) );
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionBeginB), 1024*sizeof(int)) );
-    CUDA_SAFE_CALL(cudaMalloc((void**)&(plan->m_d_partitionSizeB), 1024*sizeof(int)) );
+    CUDA_SAFE_CALL(cudaMallocHost((void**) &(plan->m_h_numRanks), sizeof(unsigned int) ));
+    CUDA_SAFE_CALL(cudaEventCreateWithFlags(&(plan->m_numRanksEvent), cudaEventDisableTiming));
     
     // MTF
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_lists), (numElts/MTF_PER_THREAD)*256*sizeof(unsigned char)));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_list_sizes), (numElts/MTF_PER_THREAD)*sizeof(unsigned short)));
+    size_t numStates = mtfNumStates(numElts, plan->m_mtfChunkSize);
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_lists), numStates*256*sizeof(unsigned char)));
+    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_list_sizes), numStates*sizeof(unsigned short)));
     CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_mtfOut), numElts*sizeof(unsigned char) ));
     
-    // Huffman
-    size_t numBitsAlloc = HUFF_NUM_CHARS*(HUFF_NUM_CHARS+1)/2;
-    size_t numCharsAlloc = (numBitsAlloc%8 == 0) ? numBitsAlloc/8 : numBitsAlloc/8 + 1;
-    size_t histBlocks = (numElts%(HUFF_WORK_PER_THREAD_HIST*HUFF_THREADS_PER_BLOCK_HIST)==0) ?
-        numElts/(HUFF_WORK_PER_THREAD_HIST*HUFF_THREADS_PER_BLOCK_HIST) : numElts%(HUFF_WORK_PER_THREAD_HIST*HUFF_THREADS_PER_BLOCK_HIST)+1;
-    size_t tThreads = ((numElts%HUFF_WORK_PER_THREAD) == 0) ? numElts/HUFF_WORK_PER_THREAD : numElts/HUFF_WORK_PER_THREAD+1;
-    size_t nBlocks = ( (tThreads%HUFF_THREADS_PER_BLOCK) == 0) ? tThreads/HUFF_THREADS_PER_BLOCK : tThreads/HUFF_THREADS_PER_BLOCK+1;
-    
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_huffCodesPacked), numCharsAlloc*sizeof(unsigned char) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_huffCodeLocations), HUFF_NUM_CHARS*sizeof(size_t) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_huffCodeLengths), HUFF_NUM_CHARS*sizeof(unsigned char) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_histograms), histBlocks*256*sizeof(size_t) ));
-    //CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_histogram), 256*sizeof(size_t) ));
-    //CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_totalEncodedSize), sizeof(size_t)));
-    //CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_encodedData), sizeof(size_t)*(HUFF_CODE_BYTES+1)*nBlocks));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_nCodesPacked), sizeof(size_t)));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_encoded), sizeof(encoded)*nBlocks));
-    //CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_encodeOffset), sizeof(size_t)*nBlocks));
-    
     CUDA_CHECK_ERROR("allocCompressStorage");
 }
     
@@ -578,38 +672,40 @@ void freeCompressStorage(CUDPPCompressPlan *plan)
     // BWT
     CUDA_SAFE_CALL( cudaFree(plan->m_d_keys));
     CUDA_SAFE_CALL( cudaFree(plan->m_d_values));
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_ranks));
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_sortRanks));
     CUDA_SAFE_CALL( cudaFree(plan->m_d_bwtOut));
-    
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_bwtInRef));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_bwtInRef2));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_keys_dev));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_values_dev));
-    
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionBeginA));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionSizeA));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionBeginB));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionSizeB));
+    CUDA_SAFE_CALL( cudaFreeHost(plan->m_h_numRanks));
+    CUDA_SAFE_CALL( cudaEventDestroy(plan->m_numRanksEvent));
 
     // MTF
     CUDA_SAFE_CALL( cudaFree(plan->m_d_lists));
     CUDA_SAFE_CALL( cudaFree(plan->m_d_list_sizes));
     CUDA_SAFE_CALL( cudaFree(plan->m_d_mtfOut));
 
-    // Huffman
-    CUDA_SAFE_CALL(cudaFree(plan->m_d_histograms));
-    //CUDA_SAFE_CALL(cudaFree(plan->m_d_histogram));
-    CUDA_SAFE_CALL(cudaFree(plan->m_d_huffCodeLengths));
-    CUDA_SAFE_CALL(cudaFree(plan->m_d_huffCodesPacked));
-    CUDA_SAFE_CALL(cudaFree(plan->m_d_huffCodeLocations));
-    //CUDA_SAFE_CALL(cudaFree(plan->m_d_totalEncodedSize));
-    //CUDA_SAFE_CALL(cudaFree(plan->m_d_encodedData));
-    CUDA_SAFE_CALL(cudaFree(plan->m_d_nCodesPacked));
-    CUDA_SAFE_CALL(cudaFree(plan->m_d_encoded));
-    //CUDA_SAFE_CALL(cudaFree(plan->m_d_encodeOffset));
-
     CUDA_CHECK_ERROR("freeCompressStorage");
 }
 
+/** @brief Deallocate intermediate block arrays in a CUDPPHuffmanPlan object.
+ *
+ *
+ * @param[in,out] plan Pointer to CUDPPHuffmanPlan object initialized by allocHuffmanStorage().
+ */
+void freeHuffmanStorage(CUDPPHuffmanPlan *plan)
+{
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_keys));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_runBounds));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_codes));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_blockWords));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_decodeTable));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_firstCode));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_firstIndex));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_sortedSymbols));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_decodeError));
+
+    CUDA_CHECK_ERROR("freeHuffmanStorage");
+}
+
 /** @brief Deallocate intermediate block arrays in a CUDPPBwtPlan object.
  *
  *
@@ -620,16 +716,10 @@ void freeBwtStorage(CUDPPBwtPlan *plan)
     // BWT
     CUDA_SAFE_CALL( cudaFree(plan->m_d_keys));
     CUDA_SAFE_CALL( cudaFree(plan->m_d_values));
-
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_bwtInRef));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_bwtInRef2));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_keys_dev));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_values_dev));
-
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionBeginA));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionSizeA));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionBeginB));
-    CUDA_SAFE_CALL( cudaFree(plan->m_d_partitionSizeB));
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_ranks));
+    CUDA_SAFE_CALL( cudaFree(plan->m_d_sortRanks));
+    CUDA_SAFE_CALL( cudaFreeHost(plan->m_h_numRanks));
+    CUDA_SAFE_CALL( cudaEventDestroy(plan->m_numRanksEvent));
 }
 
 /** @brief Deallocate intermediate block arrays in a CUDPPMtfPlan object.
@@ -650,10 +740,10 @@ void freeMtfStorage(CUDPPMtfPlan *plan)
  * 
  * @param[in]  d_uncompressed Uncompressed data
  * @param[out] d_bwtIndex BWT Index
- * @param[out] d_histSize Histogram size
- * @param[out] d_hist Histogram
- * @param[out] d_encodeOffset Encoded offset table
- * @param[out] d_compressedSize Size of compressed data
+ * @param[out] d_histSize Ignored
+ * @param[out] d_hist Huffman code length of each byte (256 unsigned chars)
+ * @param[out] d_encodeOffset First word of each Huffman sub-block
+ * @param[out] d_compressedSize Size of compressed data in words
  * @param[out] d_compressed Compressed data
  * @param[in]  numElements Number of elements to compress
  * @param[in]  plan     Pointer to CUDPPCompressPlan object containing
@@ -677,8 +767,16 @@ void cudppCompressDispatch(void *d_uncompressed,
     moveToFrontTransformWrapper(numElements, plan);
 
     // Call to perform the Huffman encoding
-    huffmanEncoding((unsigned int*)d_hist, (unsigned int*)d_encodeOffset,
-                    (unsigned int*)d_compressedSize, (unsigned int*)d_compressed, numElements, plan);
+    huffmanEncode<unsigned char>((unsigned int*)d_compressed, (unsigned char*)d_hist,
+                                 (unsigned int*)d_encodeOffset, plan->m_d_mtfOut,
+                                 numElements, plan->m_huffmanPlan);
+
+    // the last sub-block offset is the total size
+    size_t numSubBlocks = 
+        (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+    CUDA_SAFE_CALL(cudaMemcpy(d_compressedSize, 
+                              (unsigned int*)d_encodeOffset + numSubBlocks,
+                              sizeof(unsigned int), cudaMemcpyDeviceToDevice));
 }
 
 
@@ -719,11 +817,85 @@ void cudppMtfDispatch(void *d_mtfIn,
                       size_t numElements,
                       const CUDPPMtfPlan *plan)
 {
-    // Call to perform the Burrows-Wheeler transform
+    // Call to perform the move-to-front transform
     moveToFrontTransformWrapper((unsigned char*) d_mtfIn, 
                                 (unsigned char*) d_mtfOut, numElements, plan);
 }
 
+/** @brief Dispatch function to perform the inverse Move-to-Front transform
+ *
+ * 
+ * @param[in]  d_mtfIn     MTF indices
+ * @param[out] d_mtfOut    Decoded data
+ * @param[in]  numElements Number of elements to decode
+ * @param[in]  plan        Pointer to CUDPPMtfPlan object containing
+ *                         intermediate storage
+ */
+void cudppInverseMtfDispatch(void *d_mtfIn,
+                             void *d_mtfOut,
+                             size_t numElements,
+                             const CUDPPMtfPlan *plan)
+{
+    inverseMoveToFrontTransform<CUDPPMtfPlan>((unsigned char*) d_mtfIn, 
+                                              (unsigned char*) d_mtfOut, 
+                                              numElements, plan);
+}
+
+/** @brief Dispatch function to Huffman encode an array
+ *
+ *
+ * @param[out] d_compressed      The encoded stream
+ * @param[out] d_codeLengths     The code length of each symbol of the alphabet
+ * @param[out] d_subBlockOffsets The first word of each sub-block, then the total
+ * @param[in]  d_in              The symbols to encode
+ * @param[in]  numElements       Number of symbols
+ * @param[in]  plan              Pointer to CUDPPHuffmanPlan object containing
+ *                               the alphabet and intermediate storage
+ */
+void cudppHuffmanEncodeDispatch(unsigned int  *d_compressed,
+                                unsigned char *d_codeLengths,
+                                unsigned int  *d_subBlockOffsets,
+                                const void    *d_in,
+                                size_t        numElements,
+                                const CUDPPHuffmanPlan *plan)
+{
+    if (plan->m_config.datatype == CUDPP_USHORT)
+        huffmanEncode<unsigned short>(d_compressed, d_codeLengths, d_subBlockOffsets,
+                                      (const unsigned short*)d_in, numElements, plan);
+    else
+        huffmanEncode<unsigned char>(d_compressed, d_codeLengths, d_subBlockOffsets,
+                                     (const unsigned char*)d_in, numElements, plan);
+}
+
+/** @brief Dispatch function to decode a Huffman encoded array
+ *
+ *
+ * @param[out] d_out             The decoded symbols
+ * @param[in]  d_compressed      The encoded stream
+ * @param[in]  d_codeLengths     The code length of each symbol of the alphabet
+ * @param[in]  d_subBlockOffsets The first word of each sub-block, then the total
+ * @param[in]  numElements       Number of symbols
+ * @param[in]  plan              Pointer to CUDPPHuffmanPlan object containing
+ *                               the alphabet and intermediate storage
+ * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION if the stream does not decode
+ */
+CUDPPResult cudppHuffmanDecodeDispatch(void                *d_out,
+                                       const unsigned int  *d_compressed,
+                                       const unsigned char *d_codeLengths,
+                                       const unsigned int  *d_subBlockOffsets,
+                                       size_t              numElements,
+                                       const CUDPPHuffmanPlan *plan)
+{
+    if (plan->m_config.datatype == CUDPP_USHORT)
+        return huffmanDecode<unsigned short>((unsigned short*)d_out, d_compressed,
+                                             d_codeLengths, d_subBlockOffsets,
+                                             numElements, plan);
+    else
+        return huffmanDecode<unsigned char>((unsigned char*)d_out, d_compressed,
+                                            d_codeLengths, d_subBlockOffsets,
+                                            numElements, plan);
+}
+
 #ifdef __cplusplus
 }
 #endif
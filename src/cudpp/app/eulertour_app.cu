@@ -0,0 +1,157 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt 
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_scan.h"
+#include "cudpp_listrank.h"
+#include "cudpp_sparseconvert.h"
+#include "cudpp_eulertour.h"
+
+#include "kernel/eulertour_kernel.cuh"
+
+#include <algorithm>
+
+/**
+ * @file
+ * eulertour_app.cu
+ * 
+ * @brief CUDPP application-level Euler tour tree routines
+ */
+
+/** \addtogroup cudpp_app 
+ * @{
+ */
+
+/** @name Euler Tour Functions
+ * @{
+ */
+
+/** @brief Number of CTAs for a grid-stride launch over \a numItems items
+  *
+  * @param[in] numItems Number of items to be processed
+  * @returns The number of CTAs, between 1 and 65535
+  */
+inline unsigned int eulerTourNumCTAs(size_t numItems)
+{
+    size_t numCTAs = (numItems + EULER_TOUR_CTA_SIZE - 1) / EULER_TOUR_CTA_SIZE;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+#ifdef __cplusplus
+extern "C" 
+{
+#endif
+
+/** @brief Allocate intermediate storage for Euler tours
+  *
+  * The arrays used to build the tour are dead once it is linked, so the
+  * ranks and depths of the tour reuse their storage.  The pool holds:
+  * - [0, 2n): the parent and index of each node, then the rank of each event
+  * - [2n, 5n+2): the child offsets, children and child positions, then 
+  *   the depths of the tour
+  * - [5n+2, 7n+3): the next event of each event, and the head of the tour
+  *
+  * @param[in,out] plan Pointer to the CUDPPEulerTourPlan object
+  */
+void allocEulerTourStorage(CUDPPEulerTourPlan *plan)
+{
+    size_t numNodes = plan->m_numElements;
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_storage,
+                              (7 * numNodes + 3) * sizeof(unsigned int)));
+}
+
+/** @brief Deallocate intermediate storage for Euler tours
+  *
+  * @param[in,out] plan Pointer to the CUDPPEulerTourPlan object
+  */
+void freeEulerTourStorage(CUDPPEulerTourPlan *plan)
+{
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_storage));
+}
+
+/** @brief Compute the Euler tour of a forest and the per-node results
+  *
+  * The children of each node are grouped with a COO to CSR conversion of
+  * the (parent, child) pairs, and the 2n enter and leave events of the 
+  * tour are linked into a list, which is ranked.  The steps of +1 and -1
+  * are scattered to their place in the tour and scanned, which gives the
+  * depth, from which the preorder index follows; subtree sizes follow
+  * from the ranks.  Everything stays on the device.  Called by 
+  * ::cudppEulerTour().
+  *
+  * @param[out] d_depth The depth of each node, or null
+  * @param[out] d_preorder The preorder index of each node, or null
+  * @param[out] d_subtreeSize The number of nodes in the subtree of each node, or null
+  * @param[out] d_eulerTour The node of each of the 2 * \a numNodes events
+  *             of the tour, or null
+  * @param[in] d_parent The parent of each node, negative for roots
+  * @param[in] numNodes The number of nodes
+  * @param[in] plan Pointer to the CUDPPEulerTourPlan object
+  */
+void cudppEulerTourDispatch(int          *d_depth,
+                            unsigned int *d_preorder,
+                            unsigned int *d_subtreeSize,
+                            unsigned int *d_eulerTour,
+                            const int    *d_parent,
+                            size_t       numNodes,
+                            const CUDPPEulerTourPlan *plan)
+{
+    if (numNodes == 0)
+        return;
+
+    unsigned int n = (unsigned int)numNodes;
+    unsigned int *d_rows     = plan->m_d_storage;
+    unsigned int *d_cols     = d_rows + n;
+    unsigned int *d_offsets  = d_rows + 2 * n;
+    unsigned int *d_children = d_offsets + n + 2;
+    unsigned int *d_childPos = d_children + n;
+    int          *d_next     = (int*)(d_childPos + n);
+    int          *d_head     = d_next + 2 * n;
+    unsigned int *d_ranks    = d_rows;
+    int          *d_depths   = (int*)d_offsets;
+
+    treeParentRows<<<eulerTourNumCTAs(n), EULER_TOUR_CTA_SIZE>>>
+        (d_rows, d_cols, d_parent, n);
+    CUDA_CHECK_ERROR("treeParentRows");
+
+    // the roots are the children of the virtual node n
+    cudppSparseCooToCsrDispatch(d_offsets, d_children, NULL, d_rows, d_cols, 
+                                NULL, n, n + 1, plan->m_convertPlan);
+
+    treeChildPositions<<<eulerTourNumCTAs(n), EULER_TOUR_CTA_SIZE>>>
+        (d_childPos, d_children, n);
+    treeEulerLinks<<<eulerTourNumCTAs(2 * n), EULER_TOUR_CTA_SIZE>>>
+        (d_next, d_head, d_parent, d_offsets, d_children, d_childPos, n);
+    CUDA_CHECK_ERROR("treeEulerLinks");
+
+    listRankOffsets(d_ranks, d_next, d_head, 2 * n, plan->m_listRankPlan);
+
+    treeEulerSteps<<<eulerTourNumCTAs(2 * n), EULER_TOUR_CTA_SIZE>>>
+        (d_depths, d_eulerTour, d_ranks, n);
+    CUDA_CHECK_ERROR("treeEulerSteps");
+
+    cudppScanDispatch(d_depths, d_depths, 2 * n, 1, plan->m_scanPlan);
+
+    treeEulerResults<<<eulerTourNumCTAs(n), EULER_TOUR_CTA_SIZE>>>
+        (d_depth, d_preorder, d_subtreeSize, d_ranks, d_depths, n);
+    CUDA_CHECK_ERROR("treeEulerResults");
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end Euler tour functions
+/** @} */ // end cudpp_app
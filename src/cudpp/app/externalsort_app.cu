@@ -0,0 +1,966 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * externalsort_app.cu
+ *
+ * @brief CUDPP application-level out-of-core (external) sorting routines
+ */
+
+/** @addtogroup cudpp_app
+ * @{
+ */
+
+/** @name ExternalSort Functions
+ * @{
+ */
+
+// Run files larger than 2 GB need a 64-bit off_t for fseeko()
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "cuda_util.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_radixsort.h"
+#include "cudpp_mergesort.h"
+#include "cudpp_externalsort.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <queue>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/** @brief A sorted run spilled to a temporary file by externalSortRuns().
+ *
+ * The file holds the \a numElements sorted keys followed by their
+ * \a numElements values (if the plan sorts key-value pairs).
+ */
+struct ExternalSortRun
+{
+    std::string path;        //!< Temporary file holding the run
+    size_t      numElements; //!< Number of key (and value) elements in the run
+};
+
+/** @brief Names the run files of one external sort (see createRunFile()). */
+struct ExternalSortRunNames
+{
+    const char   *tempDir; //!< Directory of the run files (null means the current directory)
+    unsigned int  counter; //!< Run files created so far
+};
+
+/** @brief Double-buffered reader over one spilled run, used by
+ * externalSortMerge().
+ *
+ * The merge consumes the front block while the back block is read from
+ * disk.  \a count of the back block stays 0 until the read has completed.
+ */
+template <typename T>
+struct ExternalSortRunReader
+{
+    FILE         *keyFile;    //!< Positioned at the next unread key
+    FILE         *valueFile;  //!< Positioned at the next unread value (or null)
+    T            *keys[2];    //!< Blocks of keys read from the run
+    unsigned int *values[2];  //!< Blocks of values read from the run (or null)
+    size_t        count[2];   //!< Elements held in each block
+    int           front;      //!< Block being merged
+    size_t        pos;        //!< Next element of the front block to merge
+    size_t        remaining;  //!< Elements of the run not yet read from disk
+
+    /** @brief Reads the next \a n elements of the run into block \a b.
+     * Does not update \a count or \a remaining.
+     * @returns false if the read failed */
+    bool read(int b, size_t n)
+    {
+        if (fread(keys[b], sizeof(T), n, keyFile) != n)
+            return false;
+        if (valueFile && fread(values[b], sizeof(unsigned int), n, valueFile) != n)
+            return false;
+        return true;
+    }
+
+    /** @brief Returns the next key to merge */
+    T key() const { return keys[front][pos]; }
+};
+
+/** @brief Heap ordering for the k-way merge in externalSortMerge().
+ *
+ * std::priority_queue keeps the "largest" element on top, so this returns
+ * true when run \a a should be emitted after run \a b.  Ties are broken
+ * by run index so that the merge is stable with respect to input order.
+ */
+template <typename T>
+struct ExternalSortMergeOrder
+{
+    const std::vector<ExternalSortRunReader<T> > *readers;
+    bool backward;
+
+    bool operator()(int a, int b) const
+    {
+        T ka = (*readers)[a].key();
+        T kb = (*readers)[b].key();
+        if (ka == kb)
+            return a > b;
+        return backward ? (ka < kb) : (kb < ka);
+    }
+};
+
+/** @brief Seeks to a byte offset that may exceed 2 GB.
+ * @returns 0 on success */
+static int externalSortSeek(FILE *fp, unsigned long long offset)
+{
+#ifdef _WIN32
+    return _fseeki64(fp, (__int64)offset, SEEK_SET);
+#else
+    if ((unsigned long long)(off_t)offset != offset)
+        return -1;
+    return fseeko(fp, (off_t)offset, SEEK_SET);
+#endif
+}
+
+/** @brief Creates a new, uniquely named run file.
+ *
+ * The name is built from the process id, the address of \a names (which
+ * belongs to one sort, so concurrent sorts in a process differ) and the
+ * sort's own counter.  The file is created exclusively, retrying with the
+ * next counter on a clash, so that concurrent sorts (in this or another
+ * process) sharing a temporary directory never open each other's runs.
+ *
+ * @param[out] path Name of the created file
+ * @param[in,out] names Directory and counter of the calling sort
+ * @returns the file opened for binary writing, or null on failure
+ */
+static FILE* createRunFile(std::string &path, ExternalSortRunNames &names)
+{
+#ifdef _WIN32
+    unsigned int pid = (unsigned int)_getpid();
+#else
+    unsigned int pid = (unsigned int)getpid();
+#endif
+
+    for (int attempt = 0; attempt < 100; ++attempt)
+    {
+        char name[96];
+        sprintf(name, "cudpp_extsort_%u_%lx_%u.run", pid,
+                (unsigned long)(size_t)&names, names.counter++);
+        path = std::string(names.tempDir ? names.tempDir : ".") + "/" + name;
+
+#ifdef _WIN32
+        int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_EXCL | _O_BINARY,
+                       _S_IREAD | _S_IWRITE);
+        if (fd >= 0)
+        {
+            FILE *fp = _fdopen(fd, "wb");
+            if (!fp)
+                _close(fd);
+            return fp;
+        }
+#else
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+        if (fd >= 0)
+        {
+            FILE *fp = fdopen(fd, "wb");
+            if (!fp)
+                close(fd);
+            return fp;
+        }
+#endif
+        if (errno != EEXIST)
+            break;
+    }
+    path.clear();
+    return 0;
+}
+
+/** @brief Raw binary key and value files, read and written by
+ * externalSortFileReader() and externalSortFileWriter().
+ *
+ * Used for the input and output of cudppExternalSortFileDispatch() and
+ * for the runs written by intermediate merge passes.
+ */
+struct ExternalSortFiles
+{
+    FILE   *keyFile;   //!< Key file
+    FILE   *valueFile; //!< Value file (null for keys-only sorts)
+    size_t  keySize;   //!< Size of one key in bytes
+    bool    truncated; //!< Set when the value file ended before the key file
+};
+
+/** @brief CUDPPExternalSortReader that reads from an ExternalSortFiles.
+ *
+ * Ends the input, and sets \a truncated, if there are fewer values than
+ * keys, rather than dropping the keys that have no value.
+ */
+static size_t externalSortFileReader(void *userData, void *h_keys,
+                                     unsigned int *h_values, size_t maxElements)
+{
+    ExternalSortFiles *files = (ExternalSortFiles*)userData;
+    size_t n = fread(h_keys, files->keySize, maxElements, files->keyFile);
+    if (files->valueFile && h_values && 
+        fread(h_values, sizeof(unsigned int), n, files->valueFile) != n)
+    {
+        files->truncated = true;
+        return 0;
+    }
+    return n;
+}
+
+/** @brief CUDPPExternalSortWriter that writes to an ExternalSortFiles. */
+static size_t externalSortFileWriter(void *userData, const void *h_keys,
+                                     const unsigned int *h_values, size_t numElements)
+{
+    ExternalSortFiles *files = (ExternalSortFiles*)userData;
+    size_t n = fwrite(h_keys, files->keySize, numElements, files->keyFile);
+    if (files->valueFile && h_values)
+        n = fwrite(h_values, sizeof(unsigned int), n, files->valueFile);
+    return n;
+}
+
+/** @brief Device side of one round of run generation: copies a chunk to
+ * the GPU, sorts it with the in-core sort selected by \a plan and copies
+ * it back.  Returns when the sorted chunk is in \a h_keys / \a h_values.
+ */
+template <typename T>
+void externalSortChunk(T            *h_keys,
+                       unsigned int *h_values,
+                       T            *d_keys,
+                       unsigned int *d_values,
+                       size_t       numElements,
+                       const CUDPPPlan *plan)
+{
+    CUDA_SAFE_CALL(cudaMemcpy(d_keys, h_keys, numElements * sizeof(T),
+                              cudaMemcpyHostToDevice));
+    if (h_values)
+        CUDA_SAFE_CALL(cudaMemcpy(d_values, h_values, numElements * sizeof(unsigned int),
+                                  cudaMemcpyHostToDevice));
+
+    if (plan->m_config.algorithm == CUDPP_SORT_RADIX)
+        cudppRadixSortDispatch(d_keys, d_values, numElements,
+                               static_cast<const CUDPPRadixSortPlan*>(plan));
+    else
+        cudppMergeSortDispatch(d_keys, d_values, numElements,
+                               static_cast<const CUDPPMergeSortPlan*>(plan));
+
+    CUDA_SAFE_CALL(cudaMemcpy(h_keys, d_keys, numElements * sizeof(T),
+                              cudaMemcpyDeviceToHost));
+    if (h_values)
+        CUDA_SAFE_CALL(cudaMemcpy(h_values, d_values, numElements * sizeof(unsigned int),
+                                  cudaMemcpyDeviceToHost));
+}
+
+/** @brief Writes a sorted chunk to a new temporary run file.
+ *
+ * @returns false if the file could not be created or written
+ */
+template <typename T>
+bool spillRun(std::vector<ExternalSortRun> &runs,
+              ExternalSortRunNames         &names,
+              const T                      *h_keys,
+              const unsigned int           *h_values,
+              size_t                       numElements)
+{
+    ExternalSortRun run;
+    run.numElements = numElements;
+
+    FILE *fp = createRunFile(run.path, names);
+    if (!fp)
+        return false;
+
+    bool ok = (fwrite(h_keys, sizeof(T), numElements, fp) == numElements);
+    if (ok && h_values)
+        ok = (fwrite(h_values, sizeof(unsigned int), numElements, fp) == numElements);
+    ok = (fclose(fp) == 0) && ok;
+
+    runs.push_back(run);
+    return ok;
+}
+
+/** @brief Disk side of one round of run generation: spills the previous
+ * sorted chunk, if any, to a new run, then reads the next chunk into the
+ * same buffers.
+ *
+ * @param[out] count Elements read into \a h_keys / \a h_values
+ * @returns false if the run could not be created or written
+ */
+template <typename T>
+bool externalSortRunIO(std::vector<ExternalSortRun> &runs,
+                       ExternalSortRunNames         &names,
+                       T                            *h_keys,
+                       unsigned int                 *h_values,
+                       size_t                       numPending,
+                       CUDPPExternalSortReader      reader,
+                       void                         *readerData,
+                       size_t                       chunkElements,
+                       size_t                       &count)
+{
+    count = 0;
+    if (numPending > 0 && !spillRun(runs, names, h_keys, h_values, numPending))
+        return false;
+    count = reader(readerData, h_keys, h_values, chunkElements);
+    return true;
+}
+
+/** @brief Run generation phase of the external sort.
+ *
+ * Streams chunks of \a plan->m_numElements elements from \a reader, sorts
+ * each one on the GPU with the in-core sort of \a plan and spills it to a
+ * temporary run file.  Two pinned host buffers are used.  While the
+ * calling thread copies chunk <i>i</i> to the GPU, sorts it and copies it
+ * back (the sorts block the host until they finish), a second OpenMP
+ * thread writes run <i>i-1</i> and reads chunk <i>i+1</i> into the other
+ * buffer.  Without OpenMP the two halves of a round run one after the
+ * other.  \a reader is never called concurrently, but may be called from
+ * a thread other than the caller's.
+ *
+ * If the whole input fits in a single chunk, it is sent straight to
+ * \a writer and no run files are created.
+ *
+ * @param[out] runs Runs spilled to disk
+ * @param[out] done Set to true if the input was sorted in a single chunk
+ *                  and has already been written to \a writer
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult externalSortRuns(std::vector<ExternalSortRun> &runs,
+                             bool                         &done,
+                             CUDPPExternalSortReader      reader,
+                             void                         *readerData,
+                             CUDPPExternalSortWriter      writer,
+                             void                         *writerData,
+                             ExternalSortRunNames         &names,
+                             const CUDPPPlan              *plan)
+{
+    CUDPPResult result = CUDPP_SUCCESS;
+    size_t chunkElements = plan->m_numElements;
+    bool keyValue = (plan->m_config.options & CUDPP_OPTION_KEYS_ONLY) == 0;
+    // merge sort always permutes a value array, so give it scratch space
+    bool deviceValues = keyValue || (plan->m_config.algorithm == CUDPP_SORT_MERGE);
+
+    T            *h_keys[2]   = { 0, 0 };
+    unsigned int *h_values[2] = { 0, 0 };
+    T            *d_keys      = 0;
+    unsigned int *d_values    = 0;
+    size_t        count[2]    = { 0, 0 };
+
+    for (int b = 0; b < 2; ++b)
+    {
+        CUDA_SAFE_CALL(cudaMallocHost((void**)&h_keys[b], chunkElements * sizeof(T)));
+        if (keyValue)
+            CUDA_SAFE_CALL(cudaMallocHost((void**)&h_values[b],
+                                          chunkElements * sizeof(unsigned int)));
+    }
+    CUDA_SAFE_CALL(cudaMalloc((void**)&d_keys, chunkElements * sizeof(T)));
+    if (deviceValues)
+        CUDA_SAFE_CALL(cudaMalloc((void**)&d_values, chunkElements * sizeof(unsigned int)));
+
+    done = false;
+    int cur = 0;
+    size_t pending = 0; // sorted elements in h_keys[1-cur] not yet spilled
+    count[cur] = reader(readerData, h_keys[cur], h_values[cur], chunkElements);
+
+    while (count[cur] > 0)
+    {
+        size_t n = count[cur];
+        int other = 1 - cur;
+        bool ioOk = true;
+
+        // The GPU work stays on the calling thread, whose device and
+        // context the plan was created with
+#pragma omp parallel num_threads(2)
+        {
+            int thread = 0;
+            int numThreads = 1;
+#ifdef _OPENMP
+            thread = omp_get_thread_num();
+            numThreads = omp_get_num_threads();
+#endif
+            if (thread == 0)
+                externalSortChunk<T>(h_keys[cur], h_values[cur], d_keys, d_values, n, plan);
+            if (thread == numThreads - 1)
+                ioOk = externalSortRunIO<T>(runs, names, h_keys[other], h_values[other],
+                                            pending, reader, readerData, chunkElements,
+                                            count[other]);
+        }
+
+        if (!ioOk)
+        {
+            result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+            break;
+        }
+        pending = n;
+        cur = other;
+    }
+
+    if (result == CUDPP_SUCCESS && pending > 0)
+    {
+        int last = 1 - cur;
+        if (runs.empty())
+        {
+            // Only one chunk: no merge is needed
+            if (writer(writerData, h_keys[last], h_values[last], pending) != pending)
+                result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+            done = true;
+        }
+        else if (!spillRun(runs, names, h_keys[last], h_values[last], pending))
+            result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+    else if (result == CUDPP_SUCCESS)
+        done = true; // empty input
+
+    CUDA_SAFE_CALL(cudaFree(d_keys));
+    if (d_values)
+        CUDA_SAFE_CALL(cudaFree(d_values));
+    for (int b = 0; b < 2; ++b)
+    {
+        CUDA_SAFE_CALL(cudaFreeHost(h_keys[b]));
+        if (h_values[b])
+            CUDA_SAFE_CALL(cudaFreeHost(h_values[b]));
+    }
+
+    return result;
+}
+
+/** @brief Status returned by externalSortMergeStep(). */
+enum ExternalSortMergeStatus
+{
+    EXTSORT_MERGE_DONE,       //!< All runs have been merged
+    EXTSORT_MERGE_OUT_FULL,   //!< The output block is full
+    EXTSORT_MERGE_NEED_BLOCK  //!< A run needs a block that is still being read
+};
+
+/** @brief Merges run heads into \a outKeys / \a outValues until the output
+ * block fills, all runs are exhausted, or a run's next block has not been
+ * read yet.
+ *
+ * Only touches the front blocks of the runs and blocks whose \a count is
+ * already set, so it can run concurrently with externalSortMergeIO().
+ *
+ * @param[in,out] stalled Run waiting for its next block, or -1
+ */
+template <typename T>
+ExternalSortMergeStatus
+externalSortMergeStep(std::vector<ExternalSortRunReader<T> >                               &readers,
+                      std::priority_queue<int, std::vector<int>, ExternalSortMergeOrder<T> > &heap,
+                      int          &stalled,
+                      T            *outKeys,
+                      unsigned int *outValues,
+                      size_t       &numOut,
+                      size_t       blockElements)
+{
+    if (stalled >= 0)
+    {
+        ExternalSortRunReader<T> &rd = readers[stalled];
+        int back = 1 - rd.front;
+        if (rd.count[back] == 0)
+            return EXTSORT_MERGE_NEED_BLOCK;
+        rd.count[rd.front] = 0;
+        rd.front = back;
+        rd.pos = 0;
+        heap.push(stalled);
+        stalled = -1;
+    }
+
+    while (!heap.empty())
+    {
+        if (numOut == blockElements)
+            return EXTSORT_MERGE_OUT_FULL;
+
+        int r = heap.top();
+        heap.pop();
+
+        ExternalSortRunReader<T> &rd = readers[r];
+        outKeys[numOut] = rd.keys[rd.front][rd.pos];
+        if (outValues)
+            outValues[numOut] = rd.values[rd.front][rd.pos];
+        ++numOut;
+
+        if (++rd.pos < rd.count[rd.front])
+            heap.push(r);
+        else
+        {
+            int back = 1 - rd.front;
+            if (rd.count[back] > 0)
+            {
+                rd.count[rd.front] = 0;
+                rd.front = back;
+                rd.pos = 0;
+                heap.push(r);
+            }
+            else if (rd.remaining > 0)
+            {
+                stalled = r;
+                return EXTSORT_MERGE_NEED_BLOCK;
+            }
+        }
+    }
+    return (numOut == blockElements) ? EXTSORT_MERGE_OUT_FULL : EXTSORT_MERGE_DONE;
+}
+
+/** @brief Disk side of one merge round: writes the previously completed
+ * output block, then reads the next block of each run in \a fill into its
+ * back block.
+ *
+ * @returns CUDPP_ERROR_INSUFFICIENT_RESOURCES if the write failed, and
+ * CUDPP_ERROR_UNKNOWN if a run file held fewer keys or values than it
+ * was written with
+ */
+template <typename T>
+CUDPPResult externalSortMergeIO(std::vector<ExternalSortRunReader<T> > &readers,
+                         const std::vector<int>                 &fill,
+                         const std::vector<size_t>              &fillCount,
+                         CUDPPExternalSortWriter                writer,
+                         void                                   *writerData,
+                         const T                                *pendingKeys,
+                         const unsigned int                     *pendingValues,
+                         size_t                                 numPending)
+{
+    if (numPending > 0 &&
+        writer(writerData, pendingKeys, pendingValues, numPending) != numPending)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    for (size_t i = 0; i < fill.size(); ++i)
+    {
+        ExternalSortRunReader<T> &rd = readers[fill[i]];
+        if (!rd.read(1 - rd.front, fillCount[i]))
+            return CUDPP_ERROR_UNKNOWN;
+    }
+    return CUDPP_SUCCESS;
+}
+
+/** @brief Merge phase of the external sort.
+ *
+ * Performs a k-way merge of \a runs (at most ::EXTSORT_MAX_MERGE_RUNS,
+ * see externalSortMergePasses()) using a binary heap of run heads.  A
+ * short read of a run, including a key whose value is missing, fails the
+ * merge with CUDPP_ERROR_UNKNOWN.  The host memory used is bounded by the
+ * same budget as run
+ * generation (two chunks): it is divided into two read blocks per run plus
+ * two output blocks, so each run file is read sequentially in large blocks.
+ *
+ * The merge proceeds in rounds.  In each round the merge of the front
+ * blocks overlaps, on a second OpenMP thread, with writing the output
+ * block completed in the previous round and reading the next block of
+ * every run whose back block is empty.  Without OpenMP the two halves of
+ * a round run one after the other.  \a writer is never called
+ * concurrently, but may be called from a thread other than the caller's.
+ *
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult externalSortMerge(const std::vector<ExternalSortRun> &runs,
+                              CUDPPExternalSortWriter            writer,
+                              void                               *writerData,
+                              const CUDPPPlan                    *plan)
+{
+    CUDPPResult result = CUDPP_SUCCESS;
+    bool keyValue = (plan->m_config.options & CUDPP_OPTION_KEYS_ONLY) == 0;
+    size_t numRuns = runs.size();
+
+    size_t blockElements = plan->m_numElements / (numRuns + 1);
+    if (blockElements < EXTSORT_MIN_MERGE_BLOCK)
+        blockElements = EXTSORT_MIN_MERGE_BLOCK;
+
+    std::vector<ExternalSortRunReader<T> > readers(numRuns);
+    for (size_t r = 0; r < numRuns; ++r)
+    {
+        ExternalSortRunReader<T> &rd = readers[r];
+        for (int b = 0; b < 2; ++b)
+        {
+            rd.keys[b] = (T*)malloc(blockElements * sizeof(T));
+            rd.values[b] = keyValue ?
+                (unsigned int*)malloc(blockElements * sizeof(unsigned int)) : 0;
+            rd.count[b] = 0;
+        }
+        rd.front = 0;
+        rd.pos = 0;
+        rd.keyFile = fopen(runs[r].path.c_str(), "rb");
+        rd.valueFile = keyValue ? fopen(runs[r].path.c_str(), "rb") : 0;
+        rd.remaining = runs[r].numElements;
+        if (!rd.keyFile || (keyValue && !rd.valueFile))
+            result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+        else if (keyValue &&
+                 externalSortSeek(rd.valueFile,
+                                  (unsigned long long)runs[r].numElements * sizeof(T)) != 0)
+            result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+    T *outKeys[2];
+    unsigned int *outValues[2];
+    for (int b = 0; b < 2; ++b)
+    {
+        outKeys[b] = (T*)malloc(blockElements * sizeof(T));
+        outValues[b] = keyValue ?
+            (unsigned int*)malloc(blockElements * sizeof(unsigned int)) : 0;
+    }
+
+    if (result == CUDPP_SUCCESS)
+    {
+        ExternalSortMergeOrder<T> order;
+        order.readers = &readers;
+        order.backward = (plan->m_config.options & CUDPP_OPTION_BACKWARD) != 0;
+        std::priority_queue<int, std::vector<int>, ExternalSortMergeOrder<T> > heap(order);
+
+        // The first block of each run is read before merging starts
+        for (size_t r = 0; r < numRuns && result == CUDPP_SUCCESS; ++r)
+        {
+            ExternalSortRunReader<T> &rd = readers[r];
+            size_t n = (rd.remaining < blockElements) ? rd.remaining : blockElements;
+            if (n == 0)
+                continue;
+            if (!rd.read(0, n))
+                result = CUDPP_ERROR_UNKNOWN;
+            rd.count[0] = n;
+            rd.remaining -= n;
+            heap.push((int)r);
+        }
+
+        std::vector<int> fill;
+        std::vector<size_t> fillCount;
+        ExternalSortMergeStatus status = EXTSORT_MERGE_NEED_BLOCK;
+        int stalled = -1;
+        int cur = 0;          // output block being merged into
+        size_t numOut = 0;    // elements in outKeys[cur]
+        size_t numPending = 0; // elements in outKeys[1-cur] not yet written
+
+        while (result == CUDPP_SUCCESS && status != EXTSORT_MERGE_DONE)
+        {
+            fill.clear();
+            fillCount.clear();
+            for (size_t r = 0; r < numRuns; ++r)
+            {
+                ExternalSortRunReader<T> &rd = readers[r];
+                if (rd.count[1 - rd.front] == 0 && rd.remaining > 0)
+                {
+                    fill.push_back((int)r);
+                    fillCount.push_back((rd.remaining < blockElements) ?
+                                        rd.remaining : blockElements);
+                }
+            }
+
+            CUDPPResult ioResult = CUDPP_SUCCESS;
+#pragma omp parallel sections num_threads(2)
+            {
+#pragma omp section
+                status = externalSortMergeStep<T>(readers, heap, stalled, outKeys[cur],
+                                                  outValues[cur], numOut, blockElements);
+#pragma omp section
+                ioResult = externalSortMergeIO<T>(readers, fill, fillCount, writer, writerData,
+                                                  outKeys[1 - cur], outValues[1 - cur],
+                                                  numPending);
+            }
+
+            if (ioResult != CUDPP_SUCCESS)
+            {
+                result = ioResult;
+                break;
+            }
+
+            // Publish the blocks read this round
+            for (size_t i = 0; i < fill.size(); ++i)
+            {
+                ExternalSortRunReader<T> &rd = readers[fill[i]];
+                rd.count[1 - rd.front] = fillCount[i];
+                rd.remaining -= fillCount[i];
+            }
+
+            numPending = 0;
+            if (numOut == blockElements)
+            {
+                numPending = numOut;
+                numOut = 0;
+                cur = 1 - cur;
+            }
+        }
+
+        if (result == CUDPP_SUCCESS && numPending > 0 &&
+            writer(writerData, outKeys[1 - cur], outValues[1 - cur], numPending) != numPending)
+            result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+        if (result == CUDPP_SUCCESS && numOut > 0 &&
+            writer(writerData, outKeys[cur], outValues[cur], numOut) != numOut)
+            result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+    for (size_t r = 0; r < numRuns; ++r)
+    {
+        if (readers[r].keyFile)   fclose(readers[r].keyFile);
+        if (readers[r].valueFile) fclose(readers[r].valueFile);
+        for (int b = 0; b < 2; ++b)
+        {
+            free(readers[r].keys[b]);
+            free(readers[r].values[b]);
+        }
+    }
+    for (int b = 0; b < 2; ++b)
+    {
+        free(outKeys[b]);
+        free(outValues[b]);
+    }
+
+    return result;
+}
+
+/** @brief Merges \a group into a new run file, written as keys followed by
+ * values like the runs of spillRun().
+ *
+ * @param[out] run The new run; its \a path is set if the file was created
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult externalSortMergeToRun(ExternalSortRun                    &run,
+                                   const std::vector<ExternalSortRun> &group,
+                                   ExternalSortRunNames               &names,
+                                   const CUDPPPlan                    *plan)
+{
+    bool keyValue = (plan->m_config.options & CUDPP_OPTION_KEYS_ONLY) == 0;
+
+    run.numElements = 0;
+    for (size_t r = 0; r < group.size(); ++r)
+        run.numElements += group[r].numElements;
+
+    ExternalSortFiles out = { 0, 0, sizeof(T), false };
+    out.keyFile = createRunFile(run.path, names);
+    if (!out.keyFile)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    CUDPPResult result = CUDPP_SUCCESS;
+    if (keyValue)
+    {
+        // the values follow the keys, through a second handle on the file
+        out.valueFile = fopen(run.path.c_str(), "r+b");
+        if (!out.valueFile ||
+            externalSortSeek(out.valueFile, 
+                             (unsigned long long)run.numElements * sizeof(T)) != 0)
+            result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+    if (result == CUDPP_SUCCESS)
+        result = externalSortMerge<T>(group, externalSortFileWriter, &out, plan);
+
+    if (fclose(out.keyFile) != 0 && result == CUDPP_SUCCESS)
+        result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    if (out.valueFile && fclose(out.valueFile) != 0 && result == CUDPP_SUCCESS)
+        result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    return result;
+}
+
+/** @brief Merges groups of ::EXTSORT_MAX_MERGE_RUNS consecutive runs into
+ * longer runs until at most that many are left, so that the final merge
+ * and each intermediate one keep a bounded number of files open.
+ *
+ * Groups are consecutive and keep their order, so the merge stays stable.
+ * Merged runs are removed as soon as their group is written.  On failure,
+ * \a runs lists every run file that may still exist.
+ *
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult externalSortMergePasses(std::vector<ExternalSortRun> &runs,
+                                    ExternalSortRunNames         &names,
+                                    const CUDPPPlan              *plan)
+{
+    const size_t fanIn = EXTSORT_MAX_MERGE_RUNS;
+
+    while (runs.size() > fanIn)
+    {
+        std::vector<ExternalSortRun> merged;
+        for (size_t first = 0; first < runs.size(); first += fanIn)
+        {
+            size_t last = (first + fanIn < runs.size()) ? first + fanIn : runs.size();
+            if (last - first == 1)
+            {
+                merged.push_back(runs[first]);
+                continue;
+            }
+
+            std::vector<ExternalSortRun> group(runs.begin() + first, runs.begin() + last);
+            ExternalSortRun run;
+            CUDPPResult result = externalSortMergeToRun<T>(run, group, names, plan);
+            if (!run.path.empty())
+                merged.push_back(run);
+            if (result != CUDPP_SUCCESS)
+            {
+                // runs of earlier groups are already removed; removing them
+                // again is harmless
+                runs.insert(runs.end(), merged.begin(), merged.end());
+                return result;
+            }
+            for (size_t r = first; r < last; ++r)
+                remove(runs[r].path.c_str());
+        }
+        runs.swap(merged);
+    }
+    return CUDPP_SUCCESS;
+}
+
+/** @brief Performs an external sort with key type \a T: run generation,
+ * merge passes down to ::EXTSORT_MAX_MERGE_RUNS runs and a final k-way
+ * merge, then removes the temporary run files.
+ */
+template <typename T>
+CUDPPResult runExternalSort(CUDPPExternalSortReader reader,
+                            void                    *readerData,
+                            CUDPPExternalSortWriter writer,
+                            void                    *writerData,
+                            const char              *tempDir,
+                            const CUDPPPlan         *plan)
+{
+    std::vector<ExternalSortRun> runs;
+    ExternalSortRunNames names = { tempDir, 0 };
+    bool done = false;
+
+    CUDPPResult result = externalSortRuns<T>(runs, done, reader, readerData,
+                                             writer, writerData, names, plan);
+
+    if (result == CUDPP_SUCCESS && !done)
+        result = externalSortMergePasses<T>(runs, names, plan);
+    if (result == CUDPP_SUCCESS && !done)
+        result = externalSortMerge<T>(runs, writer, writerData, plan);
+
+    for (size_t r = 0; r < runs.size(); ++r)
+        remove(runs[r].path.c_str());
+
+    return result;
+}
+
+/** @brief Dispatch function to perform an external sort with the
+ * in-core sort configured in \a plan.
+ *
+ * The plan must be a radix sort or merge sort plan.  Its \a numElements
+ * (the maximum in-core sort size) is used as the chunk size, so the GPU
+ * and pinned host memory used is bounded regardless of the input size.
+ *
+ * @param[in] reader Callback that supplies input chunks
+ * @param[in] readerData Opaque pointer passed to \a reader
+ * @param[in] writer Callback that consumes sorted output
+ * @param[in] writerData Opaque pointer passed to \a writer
+ * @param[in] tempDir Directory in which sorted runs are spilled
+ * @param[in] plan Configuration information for the in-core sort
+ * @returns CUDPPResult indicating success or error condition
+ **/
+CUDPPResult cudppExternalSortDispatch(CUDPPExternalSortReader reader,
+                                      void                    *readerData,
+                                      CUDPPExternalSortWriter writer,
+                                      void                    *writerData,
+                                      const char              *tempDir,
+                                      const CUDPPPlan         *plan)
+{
+    switch(plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+        return runExternalSort<char>(reader, readerData, writer, writerData, tempDir, plan);
+    case CUDPP_UCHAR:
+        return runExternalSort<unsigned char>(reader, readerData, writer, writerData, tempDir, plan);
+    case CUDPP_INT:
+        return runExternalSort<int>(reader, readerData, writer, writerData, tempDir, plan);
+    case CUDPP_UINT:
+        return runExternalSort<unsigned int>(reader, readerData, writer, writerData, tempDir, plan);
+    case CUDPP_FLOAT:
+        return runExternalSort<float>(reader, readerData, writer, writerData, tempDir, plan);
+    case CUDPP_DOUBLE:
+        return runExternalSort<double>(reader, readerData, writer, writerData, tempDir, plan);
+    case CUDPP_LONGLONG:
+        return runExternalSort<long long>(reader, readerData, writer, writerData, tempDir, plan);
+    case CUDPP_ULONGLONG:
+        return runExternalSort<unsigned long long>(reader, readerData, writer, writerData, tempDir, plan);
+    default:
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+}
+
+/** @brief Returns the size in bytes of one key of the plan's datatype. */
+static size_t externalSortKeySize(CUDPPDatatype datatype)
+{
+    switch(datatype)
+    {
+    case CUDPP_CHAR:
+    case CUDPP_UCHAR:     return sizeof(char);
+    case CUDPP_SHORT:
+    case CUDPP_USHORT:    return sizeof(short);
+    case CUDPP_INT:
+    case CUDPP_UINT:      return sizeof(int);
+    case CUDPP_FLOAT:     return sizeof(float);
+    case CUDPP_DOUBLE:    return sizeof(double);
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG: return sizeof(long long);
+    default:              return 0;
+    }
+}
+
+/** @brief Dispatch function to perform an external sort of raw binary files.
+ *
+ * Keys (and, for key-value sorts, unsigned int values) are read from
+ * \a keysIn / \a valuesIn and the sorted result is written to \a keysOut /
+ * \a valuesOut.  The value file names are ignored for keys-only plans.
+ *
+ * @returns CUDPPResult indicating success or error condition;
+ * CUDPP_ERROR_UNKNOWN if \a valuesIn holds fewer values than \a keysIn
+ * holds keys
+ **/
+CUDPPResult cudppExternalSortFileDispatch(const char      *keysIn,
+                                          const char      *valuesIn,
+                                          const char      *keysOut,
+                                          const char      *valuesOut,
+                                          const char      *tempDir,
+                                          const CUDPPPlan *plan)
+{
+    bool keyValue = (plan->m_config.options & CUDPP_OPTION_KEYS_ONLY) == 0;
+
+    ExternalSortFiles in  = { 0, 0, externalSortKeySize(plan->m_config.datatype), false };
+    ExternalSortFiles out = { 0, 0, in.keySize, false };
+
+    CUDPPResult result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    in.keyFile  = fopen(keysIn, "rb");
+    out.keyFile = fopen(keysOut, "wb");
+    if (keyValue && valuesIn && valuesOut)
+    {
+        in.valueFile  = fopen(valuesIn, "rb");
+        out.valueFile = fopen(valuesOut, "wb");
+    }
+
+    if (in.keyFile && out.keyFile && 
+        (!keyValue || (in.valueFile && out.valueFile)))
+    {
+        result = cudppExternalSortDispatch(externalSortFileReader, &in,
+                                           externalSortFileWriter, &out,
+                                           tempDir, plan);
+        if (result == CUDPP_SUCCESS && in.truncated)
+            result = CUDPP_ERROR_UNKNOWN;
+    }
+
+    if (in.keyFile)    fclose(in.keyFile);
+    if (in.valueFile)  fclose(in.valueFile);
+    if (out.keyFile && fclose(out.keyFile) != 0)
+        result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    if (out.valueFile && fclose(out.valueFile) != 0)
+        result = CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    return result;
+}
+
+/** @} */ // end externalsort functions
+/** @} */ // end cudpp_app
@@ -0,0 +1,467 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_radixsort.h"
+#include "cudpp_histogram.h"
+
+#include "kernel/histogram_kernel.cuh"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @file
+ * histogram_app.cu
+ *
+ * @brief CUDPP application-level histogram routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Histogram Functions
+ * @{
+ */
+
+/** @brief Number of CTAs for a grid-stride launch over \a numItems items
+  *
+  * @param[in] numItems Number of items to be processed
+  * @returns The number of CTAs, between 1 and 65535
+  */
+inline unsigned int histogramNumCTAs(size_t numItems)
+{
+    size_t numCTAs = (numItems + HISTOGRAM_REDUCE_CTA_SIZE - 1) / HISTOGRAM_REDUCE_CTA_SIZE;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Histogram of device values, in shared memory or by sorting
+  *
+  * Up to ::HISTOGRAM_SHARED_BINS bins, each CTA counts its values in
+  * per-thread sub-histograms in shared memory (see
+  * histogramSharedCounts()), and the histograms of the CTAs are added
+  * up.  With more bins, a CTA's sub-histograms would not fit in shared
+  * memory, so the bins of the values are radix sorted and each bin's
+  * count is the length of its run.
+  *
+  * @param[out] d_histogram The histogram
+  * @param[in]  d_in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  bins The binning
+  * @param[in]  plan Pointer to the CUDPPHistogramPlan object
+  */
+template <class T, class Bins>
+void histogramDevice(unsigned int             *d_histogram,
+                     const T                  *d_in,
+                     size_t                   numElements,
+                     Bins                     bins,
+                     const CUDPPHistogramPlan *plan)
+{
+    unsigned int numBins = plan->m_numBins;
+
+    if (numElements == 0)
+    {
+        CUDA_SAFE_CALL(cudaMemset(d_histogram, 0, numBins * sizeof(unsigned int)));
+        return;
+    }
+
+    if (numBins <= HISTOGRAM_SHARED_BINS)
+    {
+        // bytes are loaded four at a time when they are aligned
+        bool byteLoads = (sizeof(T) == 1 && numElements >= 4 &&
+                          ((size_t)d_in & 3) == 0);
+        size_t numLoads = byteLoads ? numElements / 4 : numElements;
+        unsigned int numThreads = plan->m_numThreads;
+        unsigned int numBlocks = (unsigned int)
+            std::min((size_t)plan->m_numBlocks, (numLoads + numThreads - 1) / numThreads);
+        size_t sharedBytes = Bins::sharedBytes(numBins) + numBins * sizeof(unsigned int) +
+            numThreads * 4 * ((numBins + 3) / 4);
+
+        if (byteLoads)
+            histogramSharedCounts<T, Bins, 4><<<numBlocks, numThreads, sharedBytes>>>
+                (plan->m_d_partials, d_in, numElements, bins);
+        else
+            histogramSharedCounts<T, Bins, 1><<<numBlocks, numThreads, sharedBytes>>>
+                (plan->m_d_partials, d_in, numElements, bins);
+        CUDA_CHECK_ERROR("histogramSharedCounts");
+
+        histogramSumPartials<<<histogramNumCTAs(numBins), HISTOGRAM_REDUCE_CTA_SIZE>>>
+            (d_histogram, plan->m_d_partials, numBins, numBlocks);
+        CUDA_CHECK_ERROR("histogramSumPartials");
+    }
+    else
+    {
+        unsigned int n = (unsigned int)numElements;
+
+        histogramBinKeys<<<histogramNumCTAs(n), HISTOGRAM_REDUCE_CTA_SIZE>>>
+            (plan->m_d_keys, d_in, n, bins);
+        CUDA_CHECK_ERROR("histogramBinKeys");
+
+        cudppRadixSortDispatch(plan->m_d_keys, 0, n, plan->m_sortPlan);
+
+        CUDA_SAFE_CALL(cudaMemset(plan->m_d_bounds, 0, 2 * (size_t)numBins * sizeof(unsigned int)));
+        histogramRunBounds<<<histogramNumCTAs(n), HISTOGRAM_REDUCE_CTA_SIZE>>>
+            (plan->m_d_bounds, plan->m_d_keys, n, numBins);
+        histogramRunLengths<<<histogramNumCTAs(numBins), HISTOGRAM_REDUCE_CTA_SIZE>>>
+            (d_histogram, plan->m_d_bounds, numBins);
+        CUDA_CHECK_ERROR("histogramRunLengths");
+    }
+}
+
+/** @brief Histogram of host values
+  *
+  * The values are split into one contiguous chunk per thread, and each
+  * thread counts its chunk into its own sub-histograms, so the threads
+  * share no counters.  Within a chunk, consecutive values are counted in
+  * ::HISTOGRAM_HOST_LANES separate sub-histograms, so that the increments
+  * of a run of equal values do not wait on each other.  Each
+  * sub-histogram has an extra bin for the values that are not counted,
+  * so the inner loop has no branches.  The sub-histograms of all threads
+  * are added up at the end, with the bins split among the threads.
+  *
+  * A thread is only used for at least ::HISTOGRAM_HOST_GRAIN values, and
+  * for at least as many values as it has counters to clear and add up.
+  *
+  * @param[out] h_histogram The histogram
+  * @param[in]  h_in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  bins The binning
+  */
+template <class T, class Bins>
+void histogramHost(unsigned int *h_histogram,
+                   const T      *h_in,
+                   size_t       numElements,
+                   Bins         bins)
+{
+    const size_t lanes = HISTOGRAM_HOST_LANES;
+    const size_t laneSize = (size_t)bins.numBins + 1;
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    const size_t threadElements = std::max((size_t)HISTOGRAM_HOST_GRAIN, lanes * laneSize);
+    numThreads = (int)std::min((size_t)omp_get_max_threads(),
+                               std::max((size_t)1, numElements / threadElements));
+#endif
+
+    std::vector<unsigned int> counts((size_t)numThreads * lanes * laneSize, 0);
+    const size_t chunkSize = numElements / numThreads;
+
+    // one chunk per iteration, whatever the size of the team
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+    for (int chunk = 0; chunk < numThreads; chunk++)
+    {
+        unsigned int *chunkCounts = &counts[(size_t)chunk * lanes * laneSize];
+        const size_t begin = chunk * chunkSize;
+        const size_t end = (chunk == numThreads - 1) ? numElements : begin + chunkSize;
+
+        size_t i = begin;
+        for (; i + lanes <= end; i += lanes)
+        {
+            for (size_t lane = 0; lane < lanes; lane++)
+                chunkCounts[lane * laneSize + bins(h_in[i + lane])]++;
+        }
+        for (; i < end; i++)
+            chunkCounts[bins(h_in[i])]++;
+    }
+
+    const size_t numLanes = (size_t)numThreads * lanes;
+#pragma omp parallel for num_threads(numThreads)
+    for (int b = 0; b < (int)bins.numBins; b++)
+    {
+        unsigned int sum = 0;
+        for (size_t lane = 0; lane < numLanes; lane++)
+            sum += counts[lane * laneSize + b];
+        h_histogram[b] = sum;
+    }
+}
+
+/** @brief Histogram with the plan's binning, on the device or the host
+  *
+  * @param[out] histogram The histogram
+  * @param[in]  in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  onHost True if \a histogram and \a in are host arrays
+  * @param[in]  plan Pointer to the CUDPPHistogramPlan object
+  */
+template <class T>
+void histogramBinned(unsigned int             *histogram,
+                     const void               *in,
+                     size_t                   numElements,
+                     bool                     onHost,
+                     const CUDPPHistogramPlan *plan)
+{
+    const T *values = (const T*)in;
+
+    switch (plan->m_binning)
+    {
+    case CUDPP_HISTOGRAM_KEYS:
+        {
+            HistogramKeyBins<T> bins;
+            bins.numBins = plan->m_numBins;
+            bins.firstKey = plan->m_firstKey;
+            if (onHost)
+                histogramHost(histogram, values, numElements, bins);
+            else
+                histogramDevice(histogram, values, numElements, bins, plan);
+            break;
+        }
+    case CUDPP_HISTOGRAM_UNIFORM:
+        {
+            HistogramUniformBins<T> bins;
+            bins.numBins = plan->m_numBins;
+            bins.lowerLevel = plan->m_lowerLevel;
+            bins.range = plan->m_upperLevel - plan->m_lowerLevel;
+            if (onHost)
+                histogramHost(histogram, values, numElements, bins);
+            else
+                histogramDevice(histogram, values, numElements, bins, plan);
+            break;
+        }
+    case CUDPP_HISTOGRAM_EDGES:
+        {
+            HistogramEdgeBins<T> bins;
+            bins.numBins = plan->m_numBins;
+            bins.edges = (const T*)(onHost ? plan->m_h_edges : plan->m_d_edges);
+            if (onHost)
+                histogramHost(histogram, values, numElements, bins);
+            else
+                histogramDevice(histogram, values, numElements, bins, plan);
+            break;
+        }
+    }
+}
+
+/** @brief Histogram with the plan's datatype and binning
+  *
+  * @param[out] histogram The histogram
+  * @param[in]  in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  onHost True if \a histogram and \a in are host arrays
+  * @param[in]  plan Pointer to the CUDPPHistogramPlan object
+  */
+void histogramDispatch(unsigned int             *histogram,
+                       const void               *in,
+                       size_t                   numElements,
+                       bool                     onHost,
+                       const CUDPPHistogramPlan *plan)
+{
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+        histogramBinned<char>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_UCHAR:
+        histogramBinned<unsigned char>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_SHORT:
+        histogramBinned<short>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_USHORT:
+        histogramBinned<unsigned short>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_INT:
+        histogramBinned<int>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_UINT:
+        histogramBinned<unsigned int>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_FLOAT:
+        histogramBinned<float>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_DOUBLE:
+        histogramBinned<double>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_LONGLONG:
+        histogramBinned<long long>(histogram, in, numElements, onHost, plan);
+        break;
+    case CUDPP_ULONGLONG:
+        histogramBinned<unsigned long long>(histogram, in, numElements, onHost, plan);
+        break;
+    default:
+        break;
+    }
+}
+
+/** @brief True if \a numBins + 1 edges are nondecreasing, and not NaN
+  *
+  * @param[in] h_edges The edges
+  * @param[in] numBins Number of bins
+  */
+template <class T>
+bool histogramEdgesSorted(const T *h_edges, unsigned int numBins)
+{
+    for (unsigned int i = 0; i < numBins; i++)
+    {
+        if (!(h_edges[i] <= h_edges[i + 1]))
+            return false;
+    }
+    return true;
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate storage for histograms
+  *
+  * Up to ::HISTOGRAM_SHARED_BINS bins, the storage is the histogram of
+  * each CTA.  The CTA size is the largest multiple of 16, up to
+  * ::HISTOGRAM_CTA_SIZE, whose 8-bit sub-histograms fit in
+  * ::HISTOGRAM_COUNTER_BYTES.  With more bins it is the bin of each value
+  * and the bounds of the run of each bin.  Nothing is allocated until the
+  * plan has bins.
+  *
+  * @param[in,out] plan Pointer to the CUDPPHistogramPlan object
+  */
+void allocHistogramStorage(CUDPPHistogramPlan *plan)
+{
+    unsigned int numBins = plan->m_numBins;
+
+    if (numBins == 0)
+        return;
+
+    if (plan->m_binning == CUDPP_HISTOGRAM_EDGES)
+    {
+        CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_edges, plan->m_edgeBytes));
+        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_edges, plan->m_h_edges, plan->m_edgeBytes,
+                                  cudaMemcpyHostToDevice));
+    }
+
+    if (numBins <= HISTOGRAM_SHARED_BINS)
+    {
+        unsigned int wordsPerThread = (numBins + 3) / 4;
+        plan->m_numThreads = std::min((unsigned int)HISTOGRAM_CTA_SIZE,
+                                      (HISTOGRAM_COUNTER_BYTES / (4 * wordsPerThread)) & ~15u);
+        size_t numLoads = (plan->m_numElements + plan->m_numThreads - 1) / plan->m_numThreads;
+        plan->m_numBlocks = (unsigned int)
+            std::max((size_t)1, std::min(numLoads, (size_t)HISTOGRAM_MAX_BLOCKS));
+
+        CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_partials,
+                                  (size_t)plan->m_numBlocks * numBins * sizeof(unsigned int)));
+    }
+    else
+    {
+        CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_keys,
+                                  std::max(plan->m_numElements, (size_t)1) * sizeof(unsigned int)));
+        CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_bounds,
+                                  2 * (size_t)numBins * sizeof(unsigned int)));
+    }
+}
+
+/** @brief Deallocate intermediate storage for histograms
+  *
+  * @param[in,out] plan Pointer to the CUDPPHistogramPlan object
+  */
+void freeHistogramStorage(CUDPPHistogramPlan *plan)
+{
+    if (plan->m_d_edges)
+        CUDA_SAFE_CALL(cudaFree(plan->m_d_edges));
+    if (plan->m_d_partials)
+        CUDA_SAFE_CALL(cudaFree(plan->m_d_partials));
+    if (plan->m_d_keys)
+        CUDA_SAFE_CALL(cudaFree(plan->m_d_keys));
+    if (plan->m_d_bounds)
+        CUDA_SAFE_CALL(cudaFree(plan->m_d_bounds));
+
+    plan->m_d_edges = 0;
+    plan->m_d_partials = 0;
+    plan->m_d_keys = 0;
+    plan->m_d_bounds = 0;
+}
+
+/** @brief Check that histogram bin edges are nondecreasing
+  *
+  * @param[in] h_edges \a numBins + 1 edges of type \a datatype
+  * @param[in] numBins Number of bins
+  * @param[in] datatype Type of the edges
+  * @returns True if the edges are nondecreasing and none is NaN
+  */
+bool histogramValidEdges(const void    *h_edges,
+                         unsigned int  numBins,
+                         CUDPPDatatype datatype)
+{
+    switch (datatype)
+    {
+    case CUDPP_CHAR:
+        return histogramEdgesSorted((const char*)h_edges, numBins);
+    case CUDPP_UCHAR:
+        return histogramEdgesSorted((const unsigned char*)h_edges, numBins);
+    case CUDPP_SHORT:
+        return histogramEdgesSorted((const short*)h_edges, numBins);
+    case CUDPP_USHORT:
+        return histogramEdgesSorted((const unsigned short*)h_edges, numBins);
+    case CUDPP_INT:
+        return histogramEdgesSorted((const int*)h_edges, numBins);
+    case CUDPP_UINT:
+        return histogramEdgesSorted((const unsigned int*)h_edges, numBins);
+    case CUDPP_FLOAT:
+        return histogramEdgesSorted((const float*)h_edges, numBins);
+    case CUDPP_DOUBLE:
+        return histogramEdgesSorted((const double*)h_edges, numBins);
+    case CUDPP_LONGLONG:
+        return histogramEdgesSorted((const long long*)h_edges, numBins);
+    case CUDPP_ULONGLONG:
+        return histogramEdgesSorted((const unsigned long long*)h_edges, numBins);
+    default:
+        return false;
+    }
+}
+
+/** @brief Compute the histogram of device values. Called by
+  * ::cudppHistogram().
+  *
+  * @param[out] d_histogram The histogram, one count per bin
+  * @param[in]  d_in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  plan Pointer to the CUDPPHistogramPlan object
+  */
+void cudppHistogramDispatch(unsigned int             *d_histogram,
+                            const void               *d_in,
+                            size_t                   numElements,
+                            const CUDPPHistogramPlan *plan)
+{
+    histogramDispatch(d_histogram, d_in, numElements, false, plan);
+}
+
+/** @brief Compute the histogram of host values. Called by
+  * ::cudppHistogramHost().
+  *
+  * The bins are those of the device histogram, computed by the same
+  * code, so both count every value in the same bin.
+  *
+  * @param[out] h_histogram The histogram, one count per bin
+  * @param[in]  h_in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  plan Pointer to the CUDPPHistogramPlan object
+  */
+void cudppHistogramHostDispatch(unsigned int             *h_histogram,
+                                const void               *h_in,
+                                size_t                   numElements,
+                                const CUDPPHistogramPlan *plan)
+{
+    histogramDispatch(h_histogram, h_in, numElements, true, plan);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end histogram functions
+/** @} */ // end cudpp_app
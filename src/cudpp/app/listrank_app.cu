@@ -10,12 +10,15 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <assert.h>
+#include <algorithm>
 
 #include "cuda_util.h"
 #include "cudpp_globals.h"
 #include "cudpp.h"
 #include "cudpp_util.h"
 #include "cudpp_plan.h"
+#include "cudpp_manager.h"
 
 #include "kernel/listrank_kernel.cuh"
 
@@ -34,11 +37,135 @@
  * @{
  */
 
+/** @brief Per-level state of a list ranking: the list being cut into
+ * sublists, and the splitters that start them, which form the list of
+ * the next level
+ */
+struct ListRankLevel
+{
+    unsigned int numNodes;          //!< Number of nodes in the list
+    unsigned int numSplitters;      //!< Number of sublists
+    int          *d_sublist;        //!< Sublist of each node
+    unsigned int *d_local;          //!< Weight before each node within its sublist
+    int          *d_splitterNode;   //!< First node of each sublist
+    unsigned int *d_splitterTotal;  //!< Total weight of each sublist
+    int          *d_splitterNext;   //!< Sublist after each sublist, or -1
+    unsigned int *d_splitterOffset; //!< Weight before each sublist in the whole list
+};
+
+/** @brief Number of CTAs for a grid-stride launch over \a numItems items
+ *
+ * @param[in] numItems Number of items to be processed
+ * @returns The number of CTAs, between 1 and 65535
+ */
+inline unsigned int listRankNumCTAs(size_t numItems)
+{
+    size_t numCTAs = (numItems + LISTRANK_CTA_SIZE - 1) / LISTRANK_CTA_SIZE;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Number of sublists a list of \a numNodes nodes is cut into
+ *
+ * @param[in] numNodes Number of nodes in the list
+ * @param[in] sublistSize Mean number of nodes per sublist
+ * @returns The number of splitters, at least 1
+ */
+inline unsigned int listRankNumSplitters(size_t numNodes, unsigned int sublistSize)
+{
+    return (unsigned int)std::max((size_t)1, 
+        (numNodes + sublistSize - 1) / sublistSize);
+}
+
+/** @brief Rank the nodes of a list by recursive sublist ranking
+ *
+ * The list is cut at pseudo-randomly chosen splitters into sublists of
+ * about plan->m_sublistSize nodes (::LISTRANK_SUBLIST_SIZE unless tuned
+ * with cudppAutotune()), which are walked in parallel, one per thread,
+ * to find the rank of each node within its sublist and the
+ * length of each sublist.  The sublists form a list that is ranked the
+ * same way, weighted by their lengths, until one sublist is left; the
+ * offsets are then broadcast back down.  Each level does work linear in
+ * its number of nodes and each level is the sublist size times 
+ * shorter than the one before, so the total work is O(n), compared to 
+ * O(n log n) for pointer jumping.
+ *
+ * On return, the rank of node i is levels[0].d_local[i] plus
+ * levels[0].d_splitterOffset[levels[0].d_sublist[i]].
+ *
+ * @param[out] levels The levels of sublists; levels[0] describes the list
+ * @param[in]  d_next_indices Next indices array
+ * @param[in]  head Head pointer index, used if \a d_head is null
+ * @param[in]  d_head Head pointer index in device memory, or null
+ * @param[in]  numElements Number of nodes to rank (at least 1)
+ * @param[in]  plan Pointer to CUDPPListRankPlan object containing
+ *                  intermediate storage
+ */
+void listRankSublists(ListRankLevel           *levels,
+                      const int               *d_next_indices,
+                      size_t                  head,
+                      const int               *d_head,
+                      size_t                  numElements,
+                      const CUDPPListRankPlan *plan)
+{
+    unsigned int numLevels = 0;
+
+    int *d_storage = plan->m_d_storage;
+    unsigned int numNodes = (unsigned int)numElements;
+    const int *d_next = d_next_indices;
+    const unsigned int *d_weights = NULL;
+    int listHead = (int)head;
+
+    // cut the list into sublists, and the list of sublists, until one is left
+    do
+    {
+        assert(numLevels < LISTRANK_MAX_LEVELS);
+        ListRankLevel &level = levels[numLevels];
+        level.numNodes = numNodes;
+        level.numSplitters = listRankNumSplitters(numNodes, plan->m_sublistSize);
+        level.d_sublist = d_storage;                          d_storage += numNodes;
+        level.d_local = (unsigned int*)d_storage;             d_storage += numNodes;
+        level.d_splitterNode = d_storage;                     d_storage += level.numSplitters;
+        level.d_splitterTotal = (unsigned int*)d_storage;     d_storage += level.numSplitters;
+        level.d_splitterNext = d_storage;                     d_storage += level.numSplitters;
+        level.d_splitterOffset = (unsigned int*)d_storage;    d_storage += level.numSplitters;
+
+        listRankClearMarks<<<listRankNumCTAs(numNodes), LISTRANK_CTA_SIZE>>>
+            (plan->m_d_mark, numNodes);
+        listRankPickSplitters<<<listRankNumCTAs(level.numSplitters), LISTRANK_CTA_SIZE>>>
+            (plan->m_d_mark, level.d_splitterNode, numNodes, level.numSplitters,
+             listHead, d_head, numLevels * 0x9e3779b9);
+        listRankWalk<<<listRankNumCTAs(level.numSplitters), LISTRANK_CTA_SIZE>>>
+            (level.d_sublist, level.d_local, level.d_splitterTotal, level.d_splitterNext,
+             d_next, d_weights, plan->m_d_mark, level.d_splitterNode, level.numSplitters);
+        CUDA_CHECK_ERROR("listRankWalk");
+
+        // the sublists form the next list, starting at the head's sublist
+        numNodes = level.numSplitters;
+        d_next = level.d_splitterNext;
+        d_weights = level.d_splitterTotal;
+        listHead = 0;
+        d_head = NULL;
+        numLevels++;
+    } while (numNodes > 1);
+    plan->m_planManager->addIterations(numLevels);
+
+    // the last level has one sublist, at offset 0; the sublist offsets of
+    // each level are the node offsets of the level below
+    CUDA_SAFE_CALL(cudaMemset(levels[numLevels - 1].d_splitterOffset, 0, sizeof(unsigned int)));
+    for (unsigned int l = numLevels - 1; l > 0; --l)
+    {
+        listRankBroadcast<<<listRankNumCTAs(levels[l].numNodes), LISTRANK_CTA_SIZE>>>
+            (levels[l - 1].d_splitterOffset, levels[l].d_sublist, levels[l].d_local,
+             levels[l].d_splitterOffset, levels[l].numNodes);
+    }
+}
+
 /** @brief Launch list ranking
  * 
  * Given two inputs arrays, \a d_unranked_values and \a d_next_indices,
  * listRank() outputs a ranked version of the unranked values by traversing
  * the next indices. The head index is \a head. Called by ::cudppListRankDispatch().
+ * The nodes are ranked by listRankSublists().
  *
  * @param[out] d_ranked_values Ranked values array
  * @param[in]  d_unranked_values Unranked values array
@@ -50,70 +177,22 @@
  */
 template <typename T>
 void listRank(T                         *d_ranked_values,
-              T                         *d_unranked_values,
-              int                       *d_next_indices,
+              const T                   *d_unranked_values,
+              const int                 *d_next_indices,
               size_t                    head,
               size_t                    numElements,
               const CUDPPListRankPlan   *plan)
 {
-    int step = 1;
-    int cnt = 1;
-    int* d_tmp = d_next_indices;
-
-    // thread info -- kernel1
-    int nThreads = LISTRANK_CTA_BLOCK;
-    int tThreads = LISTRANK_TOTAL;
-    int nBlocks  = tThreads/LISTRANK_CTA_BLOCK;
-
-    dim3 grid_construct   (nBlocks,  1, 1);
-    dim3 threads_construct(nThreads, 1, 1);
-
-    // thread info -- kernel2
-    tThreads = LISTRANK_MAX;
-    nBlocks = tThreads/LISTRANK_CTA_BLOCK;
-    dim3 grid_construct2   (nBlocks,  1, 1);
-    dim3 threads_construct2(nThreads, 1, 1);
-
-
-    while(step<LISTRANK_MAX)
-    {
-        // Each step doubles the number of threads added to pointer "chase"
-        if(cnt%2 == 1)
-        {
-            // ping
-            list_rank_kernel_soa_1<T><<< grid_construct, threads_construct >>>
-                (d_ranked_values, d_unranked_values, d_tmp,
-                plan->m_d_tmp1, plan->m_d_tmp2, step, head, numElements);
-            d_tmp = plan->m_d_tmp3;
-        }
-        else
-        {
-            // pong
-            list_rank_kernel_soa_1<T><<< grid_construct, threads_construct >>>
-                (d_ranked_values, d_unranked_values, plan->m_d_tmp1,
-                d_tmp, plan->m_d_tmp2, step, head, numElements);
-        }
-        step *= 2;
-        cnt++;
-    }
+    if (numElements == 0)
+        return;
+
+    ListRankLevel levels[LISTRANK_MAX_LEVELS];
+    listRankSublists(levels, d_next_indices, head, NULL, numElements, plan);
 
-    // Out of threads to dispatch, each thread now keeps chasing pointer until
-    // all lists are ranked
-    if(LISTRANK_MAX < numElements)
-    {
-        if(cnt%2 == 0)
-        {
-            list_rank_kernel_soa_2<T><<< grid_construct2, threads_construct2 >>>
-                (d_ranked_values, d_unranked_values, plan->m_d_tmp1, plan->m_d_tmp2, head, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-        }
-        else
-        {
-            list_rank_kernel_soa_2<T><<< grid_construct2, threads_construct2 >>>
-                (d_ranked_values, d_unranked_values, d_tmp, plan->m_d_tmp2, head, numElements);
-            CUDA_SAFE_CALL(cudaThreadSynchronize());
-        }
-    }
+    listRankScatter<T><<<listRankNumCTAs(numElements), LISTRANK_CTA_SIZE>>>
+        (d_ranked_values, d_unranked_values, levels[0].d_sublist, levels[0].d_local,
+         levels[0].d_splitterOffset, (unsigned int)numElements);
+    CUDA_CHECK_ERROR("listRankScatter");
 }
 
 #ifdef __cplusplus
@@ -123,8 +202,9 @@ extern "C"
 
 /** @brief Allocate intermediate arrays used by ListRank.
  *
- * CUDPPListRank needs temporary device arrays to store next indices
- * so that it does not overwrite the original array.
+ * CUDPPListRank needs, for the list and for each shorter list of sublists,
+ * the sublist and local rank of each node and four arrays per sublist,
+ * plus one array of splitter marks for the longest list.
  *
  * @param [in,out] plan Pointer to CUDPPListRankPlan object containing
  *                      options and number of elements, which is used
@@ -133,27 +213,65 @@ extern "C"
  */
 void allocListRankStorage(CUDPPListRankPlan *plan)
 {
-    size_t numElts = plan->m_numElements;
+    size_t numNodes = std::max(plan->m_numElements, (size_t)1);
+    size_t storageSize = 0;
+    do
+    {
+        size_t numSplitters = listRankNumSplitters(numNodes, plan->m_sublistSize);
+        storageSize += 2 * numNodes + 4 * numSplitters;
+        numNodes = numSplitters;
+    } while (numNodes > 1);
 
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_tmp1),     numElts*sizeof(int) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_tmp2),     numElts*sizeof(int) ));
-    CUDA_SAFE_CALL(cudaMalloc( (void**) &(plan->m_d_tmp3),     numElts*sizeof(int) ));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_mark), 
+                              std::max(plan->m_numElements, (size_t)1) * sizeof(int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**) &(plan->m_d_storage), storageSize * sizeof(int)));
 }
 
 /** @brief Deallocate intermediate block arrays in a CUDPPListRankPlan object.
  *
- * Deallocates the output indices array allocated by allocListRankStorage().
+ * Deallocates the arrays allocated by allocListRankStorage().
  *
  * @param[in,out] plan Pointer to CUDPPListRankPlan object initialized by allocListRankStorage().
  */
 void freeListRankStorage(CUDPPListRankPlan *plan)
 {
-    if(plan->m_d_tmp1 != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_tmp1));
-    if(plan->m_d_tmp2 != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_tmp2));
-    if(plan->m_d_tmp3 != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_tmp3));
+    if(plan->m_d_mark != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_mark));
+    if(plan->m_d_storage != NULL) CUDA_SAFE_CALL(cudaFree(plan->m_d_storage));
 }
 
 
+/** @brief Compute the rank of each node of a linked list
+ *
+ * Like list ranking with cudppListRank(), but writes the position of 
+ * each node in the list instead of permuting values, and takes the head
+ * in device memory, so other algorithms can rank lists they build on 
+ * the device.
+ *
+ * @param[out] d_ranks The position of each node in the list
+ * @param[in]  d_next_indices Next indices array, -1 at the tail
+ * @param[in]  d_head Head pointer index, in device memory
+ * @param[in]  numElements Number of nodes; all must be in the list
+ * @param[in]  plan Pointer to CUDPPListRankPlan object for at least
+ *                  \a numElements elements
+ */
+void listRankOffsets(unsigned int            *d_ranks,
+                     const int               *d_next_indices,
+                     const int               *d_head,
+                     size_t                  numElements,
+                     const CUDPPListRankPlan *plan)
+{
+    if (numElements == 0)
+        return;
+
+    ListRankLevel levels[LISTRANK_MAX_LEVELS];
+    listRankSublists(levels, d_next_indices, 0, d_head, numElements, plan);
+
+    listRankBroadcast<<<listRankNumCTAs(numElements), LISTRANK_CTA_SIZE>>>
+        (d_ranks, levels[0].d_sublist, levels[0].d_local, levels[0].d_splitterOffset,
+         (unsigned int)numElements);
+    CUDA_CHECK_ERROR("listRankOffsets");
+}
+
 /** @brief Dispatch function to perform parallel list ranking on a
  * linked-list with the specified configuration.
  *
@@ -196,6 +314,7 @@ CUDPPResult cudppListRankDispatch(void *d_ranked_values,
     case CUDPP_USHORT:
         listRank<unsigned short>((unsigned short*) d_ranked_values, (unsigned short*) d_unranked_values,
                                (int*) d_next_indices, head, numElements, plan);
+        break;
     case CUDPP_INT:
         listRank<int>((int*) d_ranked_values, (int*) d_unranked_values,
                       (int*) d_next_indices, head, numElements, plan);
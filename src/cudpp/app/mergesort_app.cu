@@ -27,6 +27,7 @@
 #include "cudpp.h"
 #include "cudpp_util.h"
 #include "cudpp_mergesort.h"
+#include "cudpp_manager.h"
 #include "kernel/mergesort_kernel.cuh"
 #include "limits.h"
 
@@ -181,6 +182,8 @@ void runMergeSort(T *pkeys,
 	}	
 	
 	
+	plan->m_planManager->addIterations(count);
+
 	if(count%2==1)
 	{
 		cudaMemcpy(pkeys, temp_keys, numElements*sizeof(T), cudaMemcpyDeviceToDevice);
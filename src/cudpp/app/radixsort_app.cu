@@ -946,14 +946,14 @@ void freeRadixSortStorage(CUDPPRadixSortPlan* plan)
 #include <thrust/sort.h>
 #include <thrust/device_ptr.h>
 #include <thrust/reverse.h>
-template<typename T>
+template<typename T, typename V>
 void runSort(T *pkeys, 
-             unsigned int *pvals,
+             V *pvals,
              size_t numElements, 
              const CUDPPRadixSortPlan *plan)
 {
     thrust::device_ptr<T> keys((T*)pkeys);
-    thrust::device_ptr<unsigned int> vals((unsigned int*)pvals);
+    thrust::device_ptr<V> vals((V*)pvals);
 
     if (plan->m_bKeysOnly)
         thrust::sort(keys, keys + numElements);
@@ -970,50 +970,75 @@ void runSort(T *pkeys,
     CUDA_CHECK_ERROR("cudppRadixSortDispatch");
 }
 
-/** @brief Dispatch function to perform a sort on an array with 
- * a specified configuration.
+/** @brief Dispatch runSort() for the key datatype of the plan.
  *
- * This is the dispatch routine which calls radixSort...() with 
- * appropriate template parameters and arguments as specified by 
- * the plan.
+ * Template parameter \a V is the value type: unsigned int, or
+ * unsigned long long for plans created with CUDPP_OPTION_64BIT_VALUES.
  * @param[in,out] keys Keys to be sorted.
  * @param[in,out] values Associated values to be sorted (through keys).
  * @param[in] numElements Number of elements in the sort.
  * @param[in] plan Configuration information for RadixSort.
 **/
-
-void cudppRadixSortDispatch(void  *keys,
-                            void  *values,
-                            size_t numElements,
-                            const CUDPPRadixSortPlan *plan)
+template<typename V>
+void runSortDatatype(void  *keys,
+                     V     *values,
+                     size_t numElements,
+                     const CUDPPRadixSortPlan *plan)
 {
     switch(plan->m_config.datatype)
     {
     case CUDPP_CHAR:
-        runSort<char>((char*)keys, (unsigned int*)values, numElements, plan);
+        runSort<char>((char*)keys, values, numElements, plan);
         break;
     case CUDPP_UCHAR:
-        runSort<unsigned char>((unsigned char*)keys, (unsigned int*)values, numElements, plan);
+        runSort<unsigned char>((unsigned char*)keys, values, numElements, plan);
         break;
     case CUDPP_INT:
-        runSort<int>((int*)keys, (unsigned int*)values, numElements, plan);
+        runSort<int>((int*)keys, values, numElements, plan);
         break;
     case CUDPP_UINT:
-        runSort<unsigned int>((unsigned int*)keys, (unsigned int*)values, numElements, plan);
+        runSort<unsigned int>((unsigned int*)keys, values, numElements, plan);
         break;
     case CUDPP_FLOAT:
-        runSort<float>((float*)keys, (unsigned int*)values, numElements, plan);
+        runSort<float>((float*)keys, values, numElements, plan);
         break;
     case CUDPP_DOUBLE:
-        runSort<double>((double*)keys, (unsigned int*)values, numElements, plan);
+        runSort<double>((double*)keys, values, numElements, plan);
         break;
     case CUDPP_LONGLONG:
-        runSort<long long>((long long*)keys, (unsigned int*)values, numElements, plan);        
+        runSort<long long>((long long*)keys, values, numElements, plan);        
         break;
     case CUDPP_ULONGLONG:
-        runSort<unsigned long long>((unsigned long long*)keys, (unsigned int*)values, numElements, plan);
+        runSort<unsigned long long>((unsigned long long*)keys, values, numElements, plan);
+        break;
+    default:
         break;
     }
+}
+
+/** @brief Dispatch function to perform a sort on an array with 
+ * a specified configuration.
+ *
+ * This is the dispatch routine which calls radixSort...() with 
+ * appropriate template parameters and arguments as specified by 
+ * the plan.
+ * @param[in,out] keys Keys to be sorted.
+ * @param[in,out] values Associated values to be sorted (through keys).
+ * @param[in] numElements Number of elements in the sort.
+ * @param[in] plan Configuration information for RadixSort.
+**/
+
+void cudppRadixSortDispatch(void  *keys,
+                            void  *values,
+                            size_t numElements,
+                            const CUDPPRadixSortPlan *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_64BIT_VALUES)
+        runSortDatatype<unsigned long long>(keys, (unsigned long long*)values, 
+                                            numElements, plan);
+    else
+        runSortDatatype<unsigned int>(keys, (unsigned int*)values, 
+                                      numElements, plan);
 
     /*if (plan->m_bKeysOnly)
     {
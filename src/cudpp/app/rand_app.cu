@@ -10,9 +10,9 @@
 
 /**
  * @file
- * rand_md5_app.cu
+ * rand_app.cu
  *
- * @brief CUDPP application-level rand routine for MD5
+ * @brief CUDPP application-level rand routines for MD5 and Philox
  */
 
 #include "cuda_util.h"
@@ -23,6 +23,7 @@
 #include <cstdlib>
 #include <cstdio>
 #include <assert.h>
+#include <algorithm>
 
 #include "cta/rand_cta.cuh"
 #include "kernel/rand_kernel.cuh"
@@ -73,17 +74,17 @@ void launchRandMD5Kernel(unsigned int * d_out, unsigned int seed,
     uint4 * dev_output;
 
     //figure out how many elements are needed in this array
-    unsigned int devOutputsize = (unsigned int)(numElements / 4);
+    size_t devOutputsize = numElements / 4;
     devOutputsize += (numElements %4 == 0) ? 0 : 1; //used for overflow
-    unsigned int memSize = devOutputsize * sizeof(uint4);
+    size_t memSize = devOutputsize * sizeof(uint4);
 
 
     //now figure out block size
     unsigned int blockSize = RAND_CTA_SIZE;
-    if(devOutputsize < RAND_CTA_SIZE) blockSize = devOutputsize;
+    if(devOutputsize < RAND_CTA_SIZE) blockSize = (unsigned int)devOutputsize;
 
-    unsigned int n_blocks = 
-            devOutputsize/blockSize + (devOutputsize%blockSize == 0 ? 0:1);  
+    unsigned int n_blocks = (unsigned int)
+            (devOutputsize/blockSize + (devOutputsize%blockSize == 0 ? 0:1));  
 
     //printf("Generating %u random numbers using %u blocks and %u threads per block\n", numElements, n_blocks, blockSize);
 /*  old debug code now removed.
@@ -112,6 +113,49 @@ void launchRandMD5Kernel(unsigned int * d_out, unsigned int seed,
     CUDA_SAFE_CALL( cudaFree(dev_output));
 }//end launchRandMD5Kernel
 
+/**@brief Launches the Philox random number generator kernel
+ *
+ * Generates \a numElements values of the stream selected by the plan's
+ * seed and stream, starting at the plan's current offset.  The values are
+ * unsigned ints (raw bits), floats or doubles depending on \a T; the
+ * distribution of floating point values is selected by the plan options.
+ * The grid is capped at 65535 CTAs; threads loop over the remaining work.
+ *
+ * @param[out] d_out the output array allocated on device memory
+ * @param[in] numElements the number of elements in \a d_out
+ * @param[in] plan pointer to CUDPPRandPlan with the key and offset
+ * @see gen_randPhilox()
+ * @see cudppRand()
+ */
+template <class T>
+void launchRandPhiloxKernel(T * d_out, size_t numElements,
+                            const CUDPPRandPlan * plan)
+{
+    if (numElements == 0)
+        return;
+
+    PhiloxDistribution dist = PHILOX_UNIFORM;
+    if (plan->m_config.options & CUDPP_OPTION_RAND_NORMAL)
+        dist = PHILOX_NORMAL;
+    else if (plan->m_config.options & CUDPP_OPTION_RAND_EXPONENTIAL)
+        dist = PHILOX_EXPONENTIAL;
+
+    const unsigned int valuesPerBlock = 16 / sizeof(T);
+    const unsigned long long numBlocks = 
+        (plan->m_offset + numElements - 1) / valuesPerBlock 
+        - plan->m_offset / valuesPerBlock + 1;
+
+    unsigned int n_blocks = (unsigned int)
+        std::min((numBlocks + RAND_CTA_SIZE - 1) / RAND_CTA_SIZE, 
+                 (unsigned long long)65535);
+
+    gen_randPhilox<T><<<n_blocks, RAND_CTA_SIZE>>>
+        (d_out, numElements, plan->m_offset, 
+         make_uint2(plan->m_seed, plan->m_stream), dist);
+
+    CUDA_CHECK_ERROR("gen_randPhilox");
+}
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -124,7 +168,7 @@ extern "C"
  *
  * @param[out] d_out the array allocated on device memory where the random 
  * numbers will be stored
- * must be of type unsigned int
+ * must be of type unsigned int for MD5, or of the plan datatype for Philox
  * @param[in] numElements the number of elements in the array d_out
  * @param[in] plan pointer to CUDPPRandPlan which contains the algorithm to run
  */
@@ -138,6 +182,22 @@ void cudppRandDispatch(void * d_out, size_t numElements,
         //run the md5 algorithm here
         launchRandMD5Kernel( (unsigned int *) d_out, plan->m_seed, numElements);
         break;
+    case CUDPP_RAND_PHILOX:
+        switch(plan->m_config.datatype)
+        {
+        case CUDPP_UINT:
+            launchRandPhiloxKernel<unsigned int>((unsigned int *) d_out, numElements, plan);
+            break;
+        case CUDPP_FLOAT:
+            launchRandPhiloxKernel<float>((float *) d_out, numElements, plan);
+            break;
+        case CUDPP_DOUBLE:
+            launchRandPhiloxKernel<double>((double *) d_out, numElements, plan);
+            break;
+        default:
+            break;
+        }
+        break;
     default:
         break;
     }//end switch
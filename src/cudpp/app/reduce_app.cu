@@ -30,56 +30,75 @@
  * @{
  */
 
+/**
+  * @brief Number of thread blocks to launch for a reduction
+  *
+  * Computed in 64-bit arithmetic so that it is correct for arrays of more
+  * than 2^32 elements; the result never exceeds the plan's maximum.
+  *
+  * @param[in] numElements   The number of elements to be reduced.
+  * @param[in] eltsPerBlock  The number of elements assigned to each block.
+  * @param[in] plan          A pointer to the plan structure for the reduction.
+  * @returns The number of blocks, at most plan->m_maxBlocks.
+*/
+inline unsigned int numReduceBlocks(size_t numElements, unsigned int eltsPerBlock,
+                                    const CUDPPReducePlan *plan)
+{
+    size_t numBlocks = (numElements + eltsPerBlock - 1) / eltsPerBlock;
+    return (unsigned int)((numBlocks < plan->m_maxBlocks) ? numBlocks : plan->m_maxBlocks);
+}
+
 /**
   * @brief Per-block reduction function
   *
   * This function dispatches the appropriate reduction kernel given the size of the blocks.
+  * The kernel is launched on the plan's stream (see cudppReduceAsync()).
+  *
+  * Template parameter \a T is the type in which elements are combined; the
+  * input and output may be of another type (see reduceArrayAccumulate()).
   *
   * @param[out] d_odata The output data pointer.  Each block writes a single output element.
   * @param[in]  d_idata The input data pointer.  
   * @param[in]  numElements The number of elements to be reduced.
   * @param[in]  plan A pointer to the plan structure for the reduction.
 */
-template <class T, class Oper>
-void reduceBlocks(T *d_odata, const T *d_idata, size_t numElements, const CUDPPReducePlan *plan)
+template <class T, class Oper, class TOut, class TIn>
+void reduceBlocks(TOut *d_odata, const TIn *d_idata, size_t numElements, const CUDPPReducePlan *plan)
 {
-    unsigned int numThreads = (unsigned int)(((unsigned int)numElements > 2 * plan->m_threadsPerBlock) ?
+    unsigned int numThreads = (unsigned int)((numElements > 2 * plan->m_threadsPerBlock) ?
         plan->m_threadsPerBlock : ceilPow2((unsigned int)numElements) / 2);
     dim3 dimBlock(numThreads, 1, 1);
-    unsigned int numBlocks =
-        min(plan->m_maxBlocks,
-        ((unsigned int)(numElements) +
-         (2*plan->m_threadsPerBlock - 1)) / (2*plan->m_threadsPerBlock));
+    unsigned int numBlocks = numReduceBlocks(numElements, 2*plan->m_threadsPerBlock, plan);
 
     dim3 dimGrid(numBlocks, 1, 1);
     int smemSize = plan->m_threadsPerBlock * sizeof(T);
 
     // choose which of the optimized versions of reduction to launch
     
-    if (isPowerOfTwo((unsigned int)numElements))
+    if ((numElements & (numElements - 1)) == 0)
     {
         switch (dimBlock.x)
         {
         case 512:
-            reduce<T, Oper, 512, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 512, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 256:
-            reduce<T, Oper, 256, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 256, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 128:
-            reduce<T, Oper, 128, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 128, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 64:
-            reduce<T, Oper, 64, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 64, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 32:
-            reduce<T, Oper, 32, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 32, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 16:
-            reduce<T, Oper, 16, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 16, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  8:
-            reduce<T, Oper,  8, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,  8, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  4:
-            reduce<T, Oper,  4, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,  4, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  2:
-            reduce<T, Oper,  2, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,  2, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  1:
-            reduce<T, Oper,  1, true><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,  1, true, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         }
     }
     else
@@ -87,25 +106,25 @@ void reduceBlocks(T *d_odata, const T *d_idata, size_t numElements, const CUDPPR
         switch (dimBlock.x)
         {
         case 512:
-            reduce<T, Oper, 512, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 512, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 256:
-            reduce<T, Oper, 256, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 256, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 128:
-            reduce<T, Oper, 128, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper, 128, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 64:
-            reduce<T, Oper,  64, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,  64, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 32:
-            reduce<T, Oper,  32, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,  32, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case 16:
-            reduce<T, Oper,  16, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,  16, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  8:
-            reduce<T, Oper,   8, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,   8, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  4:
-            reduce<T, Oper,   4, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,   4, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  2:
-            reduce<T, Oper,   2, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,   2, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         case  1:
-            reduce<T, Oper,   1, false><<< dimGrid, dimBlock, smemSize >>>(d_odata, d_idata, (unsigned)numElements); break;
+            reduce<T, Oper,   1, false, TIn, TOut><<< dimGrid, dimBlock, smemSize, plan->m_launchStream >>>(d_odata, d_idata, numElements); break;
         }
     }
 
@@ -114,30 +133,69 @@ void reduceBlocks(T *d_odata, const T *d_idata, size_t numElements, const CUDPPR
 /**
   * @brief Array reduction function.
   *
-  * Performs multi-level reduction on large arrays using reduceBlocks().  
+  * Performs multi-level reduction on large arrays using reduceBlocks(): 
+  * each pass reduces its input to one partial result per block, until a 
+  * single block is left.  With the default plan parameters there are at
+  * most two passes.
+  *
+  * With CUDPP_OPTION_DETERMINISTIC the plan uses REDUCE_CTA_SIZE threads
+  * and up to REDUCE_DETERMINISTIC_MAX_BLOCKS blocks regardless of tuning,
+  * so the shape of every pass's tree, and hence the floating-point result,
+  * depends only on \a numElements.
+  *
+  * Template parameter \a A is the type in which elements are combined and
+  * partial results are stored, on which \a Oper operates: \a T, or double
+  * for float reductions with CUDPP_OPTION_ACCUMULATE_DOUBLE.  Only the 
+  * final result is rounded to \a T.
   *
   * @param [out] d_odata The output data pointer.  This is a pointer to a single element.
   * @param [in]  d_idata The input data pointer.  
   * @param [in]  numElements The number of elements to be reduced.
   * @param [in]  plan A pointer to the plan structure for the reduction.
 */
-template <class Oper, class T>
-void reduceArray(T *d_odata, const T *d_idata, size_t numElements, const CUDPPReducePlan *plan)
+template <class A, class Oper, class T>
+void reduceArrayAccumulate(T *d_odata, const T *d_idata, size_t numElements, const CUDPPReducePlan *plan)
 {
-    unsigned int numBlocks =
-        min(plan->m_maxBlocks,
-        ((unsigned int)(numElements) +
-         (2*plan->m_threadsPerBlock - 1)) / (2*plan->m_threadsPerBlock));
+    A *d_blockSums = (A*)plan->m_blockSums;
+    unsigned int numBlocks = numReduceBlocks(numElements, 2*plan->m_threadsPerBlock, plan);
 
-    if (numBlocks > 1)
+    if (numBlocks == 1)
     {
-        reduceBlocks<T, Oper>((T*)plan->m_blockSums, d_idata, numElements, plan);
-        reduceBlocks<T, Oper>(d_odata, (const T*)plan->m_blockSums, numBlocks, plan);
+        reduceBlocks<A, Oper>(d_odata, d_idata, numElements, plan);
+        return;
     }
-    else
+
+    // the first pass reads the input; later passes read the partial 
+    // results of the previous pass, stored after each other
+    reduceBlocks<A, Oper>(d_blockSums, d_idata, numElements, plan);
+    const A *d_partials = d_blockSums;
+    d_blockSums += numBlocks;
+    numElements = numBlocks;
+    numBlocks = numReduceBlocks(numElements, 2*plan->m_threadsPerBlock, plan);
+
+    while (numBlocks > 1)
     {
-        reduceBlocks<T, Oper>(d_odata, d_idata, numElements, plan);
+        reduceBlocks<A, Oper>(d_blockSums, d_partials, numElements, plan);
+        d_partials = d_blockSums;
+        d_blockSums += numBlocks;
+        numElements = numBlocks;
+        numBlocks = numReduceBlocks(numElements, 2*plan->m_threadsPerBlock, plan);
     }
+    reduceBlocks<A, Oper>(d_odata, d_partials, numElements, plan);
+}
+
+/**
+  * @brief Array reduction function, combining elements in their datatype.
+  *
+  * @param [out] d_odata The output data pointer.  This is a pointer to a single element.
+  * @param [in]  d_idata The input data pointer.  
+  * @param [in]  numElements The number of elements to be reduced.
+  * @param [in]  plan A pointer to the plan structure for the reduction.
+*/
+template <class Oper, class T>
+void reduceArray(T *d_odata, const T *d_idata, size_t numElements, const CUDPPReducePlan *plan)
+{
+    reduceArrayAccumulate<T, Oper>(d_odata, d_idata, numElements, plan);
 }
 
 /** @brief Allocate intermediate arrays used by reductions.
@@ -145,7 +203,8 @@ void reduceArray(T *d_odata, const T *d_idata, size_t numElements, const CUDPPRe
   * Reductions of large arrays must be split into multiple blocks, 
   * where each block is reduced by a single CUDA thread block.  
   * Each block writes its partial sum to global memory where it is reduced
-  * to a single element in a second pass.
+  * to a single element in the next pass.  Each pass but the last writes 
+  * its partial sums after those of the previous pass.
   *
   * @param [in,out] plan Pointer to CUDPPReducePlan object containing options and number 
   *                      of elements, which is used to compute storage requirements, and
@@ -153,13 +212,24 @@ void reduceArray(T *d_odata, const T *d_idata, size_t numElements, const CUDPPRe
   */
 void allocReduceStorage(CUDPPReducePlan *plan)
 {
-    unsigned int blocks =
-        min(plan->m_maxBlocks,
-        ((unsigned int)(plan->m_numElements) +
-         plan->m_threadsPerBlock - 1) / plan->m_threadsPerBlock);
+    size_t blocks = 1;
+    size_t numElements = plan->m_numElements;
+    unsigned int numBlocks = numReduceBlocks(numElements, 2*plan->m_threadsPerBlock, plan);
+    while (numBlocks > 1)
+    {
+        blocks += numBlocks;
+        numElements = numBlocks;
+        numBlocks = numReduceBlocks(numElements, 2*plan->m_threadsPerBlock, plan);
+    }
   
     switch (plan->m_config.datatype)
     {
+    case CUDPP_CHAR:
+        cudaMalloc(&plan->m_blockSums, blocks * sizeof(char));
+        break;
+    case CUDPP_UCHAR:
+        cudaMalloc(&plan->m_blockSums, blocks * sizeof(unsigned char));
+        break;
     case CUDPP_INT:
         cudaMalloc(&plan->m_blockSums, blocks * sizeof(int));
         break;
@@ -173,7 +243,10 @@ void allocReduceStorage(CUDPPReducePlan *plan)
         cudaMalloc(&plan->m_blockSums, blocks * sizeof(unsigned short));
         break;    
     case CUDPP_FLOAT:
-        cudaMalloc(&plan->m_blockSums, blocks * sizeof(float));
+        if (plan->m_config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+            cudaMalloc(&plan->m_blockSums, blocks * sizeof(double));
+        else
+            cudaMalloc(&plan->m_blockSums, blocks * sizeof(float));
         break;
     case CUDPP_DOUBLE:
         cudaMalloc(&plan->m_blockSums, blocks * sizeof(double));
@@ -334,6 +407,26 @@ void cudppReduceDispatch(void *d_odata, const void *d_idata, size_t numElements,
         }
         break;
     case CUDPP_FLOAT:
+        if (plan->m_config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+        {
+            switch (plan->m_config.op)
+            {
+            case CUDPP_ADD:
+            default:
+                reduceArrayAccumulate< double, OperatorAdd<double> >((float*)d_odata, (float*)d_idata, numElements, plan);
+                break;
+            case CUDPP_MULTIPLY:
+                reduceArrayAccumulate< double, OperatorMultiply<double> >((float*)d_odata, (float*)d_idata, numElements, plan);
+                break;
+            case CUDPP_MAX:
+                reduceArrayAccumulate< double, OperatorMax<double> >((float*)d_odata, (float*)d_idata, numElements, plan);
+                break;
+            case CUDPP_MIN:
+                reduceArrayAccumulate< double, OperatorMin<double> >((float*)d_odata, (float*)d_idata, numElements, plan);
+                break;
+            }
+            break;
+        }
         switch (plan->m_config.op)
         {
         case CUDPP_ADD:
@@ -0,0 +1,643 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_scan.h"
+#include "cudpp_segscan.h"
+#include "cudpp_radixsort.h"
+#include "cudpp_reducebykey.h"
+
+#include "kernel/reducebykey_kernel.cuh"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * @file
+ * reducebykey_app.cu
+ *
+ * @brief CUDPP application-level reduce-by-key and unique routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Reduce By Key Functions
+ * @{
+ */
+
+/** @brief Number of CTAs for a grid-stride launch over \a numItems items
+  *
+  * @param[in] numItems Number of items to be processed
+  * @returns The number of CTAs, between 1 and 65535
+  */
+inline unsigned int reduceByKeyNumCTAs(size_t numItems)
+{
+    size_t numCTAs = (numItems + REDUCE_BY_KEY_CTA_SIZE - 1) / REDUCE_BY_KEY_CTA_SIZE;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Size in bytes of the values of a plan
+  *
+  * @param[in] plan Pointer to the CUDPPReduceByKeyPlan object
+  * @returns 4 or 8, or 0 for a plan without an operator
+  */
+inline size_t reduceByKeyValueBytes(const CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_config.op == CUDPP_OPERATOR_INVALID)
+        return 0;
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG:
+        return 8;
+    default:
+        return 4;
+    }
+}
+
+/** @brief Reduce the values of each group of equal keys on the device
+  *
+  * Keys of type \a K are compared bitwise.  The first key of each group
+  * is flagged, the flags are scanned to number the groups, and the heads
+  * scattered to their group.  The values are reduced by a segmented scan
+  * over the same flags, whose last value in each group is the group's
+  * reduction; the group sizes follow from the starts of the groups.
+  * Unsorted keys are first radix sorted with their positions, which then
+  * gather the values.  \a V is an unsigned word of the size of the values;
+  * the segmented scan applies the plan's operator and datatype.
+  *
+  * @param[out] d_keysOut The key of each group
+  * @param[out] d_valuesOut The reduced value of each group, or NULL
+  * @param[out] d_counts The number of keys in each group, or NULL
+  * @param[out] d_numUnique The number of groups
+  * @param[in]  d_keys The keys
+  * @param[in]  d_values The values, or NULL
+  * @param[in]  numElements Number of keys
+  * @param[in]  plan Pointer to the CUDPPReduceByKeyPlan object
+  */
+template <class K, class V>
+void reduceByKey(K                          *d_keysOut,
+                 V                          *d_valuesOut,
+                 unsigned int               *d_counts,
+                 size_t                     *d_numUnique,
+                 const K                    *d_keys,
+                 const V                    *d_values,
+                 size_t                     numElements,
+                 const CUDPPReduceByKeyPlan *plan)
+{
+    if (numElements == 0)
+    {
+        CUDA_SAFE_CALL(cudaMemset(d_numUnique, 0, sizeof(size_t)));
+        return;
+    }
+
+    unsigned int n = (unsigned int)numElements;
+    unsigned int *d_flags = plan->m_d_flags;
+    unsigned int *d_ranks = plan->m_d_ranks;
+
+    if (plan->m_bUnsorted)
+    {
+        K *d_sortKeys = (K*)plan->m_d_sortKeys;
+        CUDA_SAFE_CALL(cudaMemcpy(d_sortKeys, d_keys, n * sizeof(K),
+                                  cudaMemcpyDeviceToDevice));
+        reduceByKeyIndices<<<reduceByKeyNumCTAs(n), REDUCE_BY_KEY_CTA_SIZE>>>
+            (plan->m_d_indices, n);
+        CUDA_CHECK_ERROR("reduceByKeyIndices");
+
+        cudppRadixSortDispatch(d_sortKeys, plan->m_d_indices, n, plan->m_sortPlan);
+        d_keys = d_sortKeys;
+
+        if (d_values)
+        {
+            reduceByKeyGather<<<reduceByKeyNumCTAs(n), REDUCE_BY_KEY_CTA_SIZE>>>
+                ((V*)plan->m_d_sortValues, d_values, plan->m_d_indices, n);
+            CUDA_CHECK_ERROR("reduceByKeyGather");
+            d_values = (const V*)plan->m_d_sortValues;
+        }
+    }
+
+    reduceByKeyFlagHeads<<<reduceByKeyNumCTAs(n), REDUCE_BY_KEY_CTA_SIZE>>>
+        (d_flags, d_keys, n);
+    CUDA_CHECK_ERROR("reduceByKeyFlagHeads");
+
+    cudppScanDispatch(d_ranks, d_flags, n, 1, plan->m_scanPlan);
+
+    reduceByKeyScatterHeads<<<reduceByKeyNumCTAs(n), REDUCE_BY_KEY_CTA_SIZE>>>
+        (d_keysOut, d_counts, d_numUnique, d_flags, d_ranks, d_keys, n);
+    CUDA_CHECK_ERROR("reduceByKeyScatterHeads");
+
+    if (d_values)
+        cudppSegmentedScanDispatch(plan->m_d_scanned, d_values, d_flags, n,
+                                   plan->m_segScanPlan);
+
+    if (d_values || d_counts)
+    {
+        reduceByKeyScatterTails<<<reduceByKeyNumCTAs(n), REDUCE_BY_KEY_CTA_SIZE>>>
+            (d_values ? d_valuesOut : (V*)0, d_counts, (const V*)plan->m_d_scanned,
+             d_flags, d_ranks, n);
+        CUDA_CHECK_ERROR("reduceByKeyScatterTails");
+    }
+}
+
+/** @brief Dispatch reduceByKey() for the size of the values
+  *
+  * @param[out] d_keysOut The key of each group
+  * @param[out] d_valuesOut The reduced value of each group, or NULL
+  * @param[out] d_counts The number of keys in each group, or NULL
+  * @param[out] d_numUnique The number of groups
+  * @param[in]  d_keys The keys
+  * @param[in]  d_values The values, or NULL
+  * @param[in]  numElements Number of keys
+  * @param[in]  plan Pointer to the CUDPPReduceByKeyPlan object
+  */
+template <class K>
+void reduceByKeyValues(K                          *d_keysOut,
+                       void                       *d_valuesOut,
+                       unsigned int               *d_counts,
+                       size_t                     *d_numUnique,
+                       const K                    *d_keys,
+                       const void                 *d_values,
+                       size_t                     numElements,
+                       const CUDPPReduceByKeyPlan *plan)
+{
+    if (d_values && reduceByKeyValueBytes(plan) == 8)
+        reduceByKey(d_keysOut, (unsigned long long*)d_valuesOut, d_counts, d_numUnique,
+                    d_keys, (const unsigned long long*)d_values, numElements, plan);
+    else
+        reduceByKey(d_keysOut, (unsigned int*)d_valuesOut, d_counts, d_numUnique,
+                    d_keys, (const unsigned int*)d_values, numElements, plan);
+}
+
+/** @brief Combine two host values with \a op */
+template <class T>
+inline T reduceByKeyCombine(CUDPPOperator op, T a, T b)
+{
+    switch (op)
+    {
+    case CUDPP_ADD:      return a + b;
+    case CUDPP_MULTIPLY: return a * b;
+    case CUDPP_MIN:      return (b < a) ? b : a;
+    case CUDPP_MAX:      return (a < b) ? b : a;
+    default:             return a;
+    }
+}
+
+/** @brief Hash of a 32- or 64-bit key for host aggregation */
+template <class K>
+inline size_t reduceByKeyHash(K key)
+{
+    unsigned long long h = (unsigned long long)key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+/** @brief Orders host groups by their key */
+template <class K>
+struct ReduceByKeyGroupLess
+{
+    const K *keys; //!< The key of each group
+    bool operator()(unsigned int a, unsigned int b) const { return keys[a] < keys[b]; }
+};
+
+/** @brief Reduce the values of each group of equal adjacent host keys
+  *
+  * @returns The number of groups
+  */
+template <class K, class T>
+size_t reduceByKeyHostSorted(K             *keysOut,
+                             T             *valuesOut,
+                             unsigned int  *counts,
+                             const K       *keys,
+                             const T       *values,
+                             size_t        numElements,
+                             CUDPPOperator op)
+{
+    size_t numUnique = 0;
+    for (size_t i = 0; i < numElements; i++)
+    {
+        if (i == 0 || keys[i] != keys[i - 1])
+        {
+            keysOut[numUnique] = keys[i];
+            if (values)
+                valuesOut[numUnique] = values[i];
+            if (counts)
+                counts[numUnique] = 0;
+            numUnique++;
+        }
+        else if (values)
+            valuesOut[numUnique - 1] = reduceByKeyCombine(op, valuesOut[numUnique - 1], values[i]);
+        if (counts)
+            counts[numUnique - 1]++;
+    }
+    return numUnique;
+}
+
+/** @brief Open-addressing hash table, probed linearly, of host groups
+  *
+  * Used by reduceByKeyHostUnsorted() both for the keys of one chunk and
+  * for merging the groups of all chunks.
+  */
+template <class K, class T>
+struct ReduceByKeyHostTable
+{
+    std::vector<unsigned int> slots;       //!< The group of each slot plus one, 0 if empty
+    std::vector<K>            groupKeys;   //!< The key of each group
+    std::vector<T>            groupValues; //!< The reduced value of each group, if any
+    std::vector<unsigned int> groupCounts; //!< The number of keys of each group
+    size_t                    mask;        //!< The number of slots minus one
+
+    /** Allocate slots for up to \a numKeys groups */
+    void init(size_t numKeys)
+    {
+        size_t numSlots = 1;
+        while (numSlots < numKeys * REDUCE_BY_KEY_HOST_LOAD_FACTOR)
+            numSlots <<= 1;
+        slots.assign(numSlots, 0);
+        mask = numSlots - 1;
+    }
+
+    /** Add \a count keys equal to \a key whose values reduce to
+     *  \a *value (\a value is NULL without values) */
+    void insert(K key, const T *value, unsigned int count, CUDPPOperator op)
+    {
+        size_t slot = reduceByKeyHash(key) & mask;
+        while (slots[slot] != 0 && groupKeys[slots[slot] - 1] != key)
+            slot = (slot + 1) & mask;
+
+        if (slots[slot] == 0)
+        {
+            groupKeys.push_back(key);
+            if (value)
+                groupValues.push_back(*value);
+            groupCounts.push_back(count);
+            slots[slot] = (unsigned int)groupKeys.size();
+        }
+        else
+        {
+            unsigned int group = slots[slot] - 1;
+            if (value)
+                groupValues[group] = reduceByKeyCombine(op, groupValues[group], *value);
+            groupCounts[group] += count;
+        }
+    }
+};
+
+/** @brief The key range of \a key among those split by \a splitters */
+template <class K>
+inline int reduceByKeyHostPart(const std::vector<K> &splitters, K key)
+{
+    return (int)(std::upper_bound(splitters.begin(), splitters.end(), key) - 
+                 splitters.begin());
+}
+
+/** @brief Reduce the values of each group of equal host keys, in any order
+  *
+  * The keys are split into one contiguous chunk per thread, and each
+  * thread aggregates its chunk in its own hash table.  The key space is
+  * split into as many ranges, at splitters taken from a sorted sample of
+  * the keys, and each thread then merges the groups of all chunks that
+  * fall in one range into a second table, and sorts them by key.  The
+  * ranges are in key order, so each one writes its groups to a
+  * contiguous part of the output, in increasing key order as on the
+  * device.
+  *
+  * Values are combined in input order within a chunk, and the partial
+  * reductions of the chunks are combined in chunk order.  A thread is
+  * only used for at least ::REDUCE_BY_KEY_HOST_GRAIN keys.
+  *
+  * @returns The number of groups
+  */
+template <class K, class T>
+size_t reduceByKeyHostUnsorted(K             *keysOut,
+                               T             *valuesOut,
+                               unsigned int  *counts,
+                               const K       *keys,
+                               const T       *values,
+                               size_t        numElements,
+                               CUDPPOperator op)
+{
+    typedef ReduceByKeyHostTable<K, T> Table;
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = (int)std::min((size_t)omp_get_max_threads(),
+                               std::max((size_t)1, numElements / REDUCE_BY_KEY_HOST_GRAIN));
+#endif
+    const int numParts = numThreads;
+
+    std::vector<K> splitters;
+    if (numParts > 1)
+    {
+        std::vector<K> sample((size_t)numParts * REDUCE_BY_KEY_HOST_OVERSAMPLING);
+        const size_t stride = numElements / sample.size();
+        for (size_t s = 0; s < sample.size(); s++)
+            sample[s] = keys[s * stride];
+        std::sort(sample.begin(), sample.end());
+        for (int p = 1; p < numParts; p++)
+            splitters.push_back(sample[(size_t)p * REDUCE_BY_KEY_HOST_OVERSAMPLING]);
+    }
+
+    // aggregate each chunk, and list its groups by key range
+    std::vector<Table> chunkTables(numThreads);
+    std::vector<std::vector<unsigned int> > chunkGroups(numThreads);
+    std::vector<size_t> chunkPartStart((size_t)numThreads * (numParts + 1), 0);
+    const size_t chunkSize = numElements / numThreads;
+
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+    for (int chunk = 0; chunk < numThreads; chunk++)
+    {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = (chunk == numThreads - 1) ? numElements : begin + chunkSize;
+
+        Table &table = chunkTables[chunk];
+        table.init(end - begin);
+        for (size_t i = begin; i < end; i++)
+            table.insert(keys[i], values ? &values[i] : 0, 1, op);
+
+        if (numParts > 1)
+        {
+            const size_t numGroups = table.groupKeys.size();
+            size_t *partStart = &chunkPartStart[(size_t)chunk * (numParts + 1)];
+            std::vector<int> groupPart(numGroups);
+            for (size_t g = 0; g < numGroups; g++)
+            {
+                groupPart[g] = reduceByKeyHostPart(splitters, table.groupKeys[g]);
+                partStart[groupPart[g] + 1]++;
+            }
+            for (int p = 0; p < numParts; p++)
+                partStart[p + 1] += partStart[p];
+
+            std::vector<size_t> next(partStart, partStart + numParts);
+            chunkGroups[chunk].resize(numGroups);
+            for (size_t g = 0; g < numGroups; g++)
+                chunkGroups[chunk][next[groupPart[g]]++] = (unsigned int)g;
+        }
+    }
+
+    // merge the groups of each key range, and sort them by key
+    std::vector<Table> partTables(numParts > 1 ? numParts : 0);
+    std::vector<const Table*> merged(numParts);
+    std::vector<std::vector<unsigned int> > order(numParts);
+    std::vector<size_t> partOut(numParts + 1, 0);
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(numThreads)
+    for (int p = 0; p < numParts; p++)
+    {
+        if (numParts > 1)
+        {
+            Table &table = partTables[p];
+            size_t numKeys = 0;
+            for (int chunk = 0; chunk < numThreads; chunk++)
+            {
+                const size_t *partStart = &chunkPartStart[(size_t)chunk * (numParts + 1)];
+                numKeys += partStart[p + 1] - partStart[p];
+            }
+            table.init(numKeys);
+
+            for (int chunk = 0; chunk < numThreads; chunk++)
+            {
+                const Table &chunkTable = chunkTables[chunk];
+                const size_t *partStart = &chunkPartStart[(size_t)chunk * (numParts + 1)];
+                for (size_t j = partStart[p]; j < partStart[p + 1]; j++)
+                {
+                    unsigned int g = chunkGroups[chunk][j];
+                    table.insert(chunkTable.groupKeys[g], 
+                                 values ? &chunkTable.groupValues[g] : 0,
+                                 chunkTable.groupCounts[g], op);
+                }
+            }
+            merged[p] = &table;
+        }
+        else
+            merged[p] = &chunkTables[0];
+
+        const size_t numGroups = merged[p]->groupKeys.size();
+        order[p].resize(numGroups);
+        for (size_t g = 0; g < numGroups; g++)
+            order[p][g] = (unsigned int)g;
+        if (numGroups > 0)
+        {
+            ReduceByKeyGroupLess<K> less = { &merged[p]->groupKeys[0] };
+            std::sort(order[p].begin(), order[p].end(), less);
+        }
+        partOut[p + 1] = numGroups;
+    }
+
+    for (int p = 0; p < numParts; p++)
+        partOut[p + 1] += partOut[p];
+
+#pragma omp parallel for num_threads(numThreads)
+    for (int p = 0; p < numParts; p++)
+    {
+        const Table &table = *merged[p];
+        for (size_t g = 0; g < order[p].size(); g++)
+        {
+            const size_t out = partOut[p] + g;
+            keysOut[out] = table.groupKeys[order[p][g]];
+            if (values)
+                valuesOut[out] = table.groupValues[order[p][g]];
+            if (counts)
+                counts[out] = table.groupCounts[order[p][g]];
+        }
+    }
+    return partOut[numParts];
+}
+
+/** @brief Reduce by key on the host, for sorted or unsorted keys
+  *
+  * @returns The number of groups
+  */
+template <class K, class T>
+size_t reduceByKeyHost(K                          *keysOut,
+                       T                          *valuesOut,
+                       unsigned int               *counts,
+                       const K                    *keys,
+                       const T                    *values,
+                       size_t                     numElements,
+                       const CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_bUnsorted)
+        return reduceByKeyHostUnsorted(keysOut, valuesOut, counts, keys, values,
+                                       numElements, plan->m_config.op);
+    else
+        return reduceByKeyHostSorted(keysOut, valuesOut, counts, keys, values,
+                                     numElements, plan->m_config.op);
+}
+
+/** @brief Dispatch reduceByKeyHost() for the datatype of the values
+  *
+  * @returns The number of groups
+  */
+template <class K>
+size_t reduceByKeyHostValues(K                          *keysOut,
+                             void                       *valuesOut,
+                             unsigned int               *counts,
+                             const K                    *keys,
+                             const void                 *values,
+                             size_t                     numElements,
+                             const CUDPPReduceByKeyPlan *plan)
+{
+    if (values)
+    {
+        switch (plan->m_config.datatype)
+        {
+        case CUDPP_INT:
+            return reduceByKeyHost(keysOut, (int*)valuesOut, counts, keys,
+                                   (const int*)values, numElements, plan);
+        case CUDPP_UINT:
+            return reduceByKeyHost(keysOut, (unsigned int*)valuesOut, counts, keys,
+                                   (const unsigned int*)values, numElements, plan);
+        case CUDPP_FLOAT:
+            return reduceByKeyHost(keysOut, (float*)valuesOut, counts, keys,
+                                   (const float*)values, numElements, plan);
+        case CUDPP_DOUBLE:
+            return reduceByKeyHost(keysOut, (double*)valuesOut, counts, keys,
+                                   (const double*)values, numElements, plan);
+        case CUDPP_LONGLONG:
+            return reduceByKeyHost(keysOut, (long long*)valuesOut, counts, keys,
+                                   (const long long*)values, numElements, plan);
+        case CUDPP_ULONGLONG:
+            return reduceByKeyHost(keysOut, (unsigned long long*)valuesOut, counts, keys,
+                                   (const unsigned long long*)values, numElements, plan);
+        default:
+            break;
+        }
+    }
+    return reduceByKeyHost(keysOut, (unsigned int*)0, counts, keys,
+                           (const unsigned int*)0, numElements, plan);
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate storage for reduce by key
+  *
+  * The head flags and their scan are always needed, the segmented scan
+  * of the values only with an operator, and the sorted keys, their
+  * positions and the gathered values only for unsorted keys.
+  *
+  * @param[in,out] plan Pointer to the CUDPPReduceByKeyPlan object
+  */
+void allocReduceByKeyStorage(CUDPPReduceByKeyPlan *plan)
+{
+    size_t numElements = std::max(plan->m_numElements, (size_t)1);
+    size_t keyBytes = plan->m_b64BitKeys ? sizeof(unsigned long long) : sizeof(unsigned int);
+    size_t valueBytes = reduceByKeyValueBytes(plan);
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_flags, numElements * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_ranks, numElements * sizeof(unsigned int)));
+    if (valueBytes)
+        CUDA_SAFE_CALL(cudaMalloc(&plan->m_d_scanned, numElements * valueBytes));
+
+    if (plan->m_bUnsorted)
+    {
+        CUDA_SAFE_CALL(cudaMalloc(&plan->m_d_sortKeys, numElements * keyBytes));
+        CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_indices,
+                                  numElements * sizeof(unsigned int)));
+        if (valueBytes)
+            CUDA_SAFE_CALL(cudaMalloc(&plan->m_d_sortValues, numElements * valueBytes));
+    }
+}
+
+/** @brief Deallocate intermediate storage for reduce by key
+  *
+  * @param[in,out] plan Pointer to the CUDPPReduceByKeyPlan object
+  */
+void freeReduceByKeyStorage(CUDPPReduceByKeyPlan *plan)
+{
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_flags));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_ranks));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_scanned));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_sortKeys));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_indices));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_sortValues));
+}
+
+/** @brief Reduce the values of each group of equal keys. Called by
+  * ::cudppReduceByKey() and ::cudppUnique().
+  *
+  * @param[out] d_keysOut The key of each group
+  * @param[out] d_valuesOut The reduced value of each group, or NULL
+  * @param[out] d_counts The number of keys in each group, or NULL
+  * @param[out] d_numUnique The number of groups
+  * @param[in]  d_keys The keys
+  * @param[in]  d_values The values, or NULL
+  * @param[in]  numElements Number of keys
+  * @param[in]  plan Pointer to the CUDPPReduceByKeyPlan object
+  */
+void cudppReduceByKeyDispatch(void                       *d_keysOut,
+                              void                       *d_valuesOut,
+                              unsigned int               *d_counts,
+                              size_t                     *d_numUnique,
+                              const void                 *d_keys,
+                              const void                 *d_values,
+                              size_t                     numElements,
+                              const CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_b64BitKeys)
+        reduceByKeyValues((unsigned long long*)d_keysOut, d_valuesOut, d_counts, d_numUnique,
+                          (const unsigned long long*)d_keys, d_values, numElements, plan);
+    else
+        reduceByKeyValues((unsigned int*)d_keysOut, d_valuesOut, d_counts, d_numUnique,
+                          (const unsigned int*)d_keys, d_values, numElements, plan);
+}
+
+/** @brief Reduce the values of each group of equal host keys. Called by
+  * ::cudppReduceByKeyHost().
+  *
+  * @param[out] h_keysOut The key of each group
+  * @param[out] h_valuesOut The reduced value of each group, or NULL
+  * @param[out] h_counts The number of keys in each group, or NULL
+  * @param[out] numUnique The number of groups
+  * @param[in]  h_keys The keys
+  * @param[in]  h_values The values, or NULL
+  * @param[in]  numElements Number of keys
+  * @param[in]  plan Pointer to the CUDPPReduceByKeyPlan object
+  */
+void cudppReduceByKeyHostDispatch(void                       *h_keysOut,
+                                  void                       *h_valuesOut,
+                                  unsigned int               *h_counts,
+                                  size_t                     *numUnique,
+                                  const void                 *h_keys,
+                                  const void                 *h_values,
+                                  size_t                     numElements,
+                                  const CUDPPReduceByKeyPlan *plan)
+{
+    if (plan->m_b64BitKeys)
+        *numUnique = reduceByKeyHostValues((unsigned long long*)h_keysOut, h_valuesOut,
+                                           h_counts, (const unsigned long long*)h_keys,
+                                           h_values, numElements, plan);
+    else
+        *numUnique = reduceByKeyHostValues((unsigned int*)h_keysOut, h_valuesOut,
+                                           h_counts, (const unsigned int*)h_keys,
+                                           h_values, numElements, plan);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end reduce by key functions
+/** @} */ // end cudpp_app
@@ -0,0 +1,263 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_scan.h"
+#include "cudpp_rle.h"
+
+#include "kernel/rle_kernel.cuh"
+
+#include <algorithm>
+
+/**
+ * @file
+ * rle_app.cu
+ *
+ * @brief CUDPP application-level run-length encoding routines
+ */
+
+/** \addtogroup cudpp_app
+ * @{
+ */
+
+/** @name Run-Length Encoding Functions
+ * @{
+ */
+
+/** @brief Number of CTAs for a grid-stride launch over \a numItems items
+  *
+  * @param[in] numItems Number of items to be processed
+  * @returns The number of CTAs, between 1 and 65535
+  */
+inline unsigned int rleNumCTAs(size_t numItems)
+{
+    size_t numCTAs = (numItems + RLE_CTA_SIZE - 1) / RLE_CTA_SIZE;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Run-length encode values of type \a T
+  *
+  * The first value of each run is flagged, the flags are scanned to
+  * number the runs, and the heads are scattered to their run.  The
+  * lengths follow from the starts of consecutive runs.
+  *
+  * @param[out] d_values The value of each run
+  * @param[out] d_runLengths The length of each run
+  * @param[out] d_numRuns The number of runs
+  * @param[in]  d_in The values to encode
+  * @param[in]  numElements Number of values
+  * @param[in]  plan Pointer to the CUDPPRunLengthPlan object
+  */
+template <class T>
+void runLengthEncode(T                        *d_values,
+                     unsigned int             *d_runLengths,
+                     size_t                   *d_numRuns,
+                     const T                  *d_in,
+                     size_t                   numElements,
+                     const CUDPPRunLengthPlan *plan)
+{
+    if (numElements == 0)
+    {
+        CUDA_SAFE_CALL(cudaMemset(d_numRuns, 0, sizeof(size_t)));
+        return;
+    }
+
+    unsigned int n = (unsigned int)numElements;
+    unsigned int *d_flags = plan->m_d_flags;
+    unsigned int *d_ranks = plan->m_d_ranks;
+
+    rleFlagHeads<<<rleNumCTAs(n), RLE_CTA_SIZE>>>(d_flags, d_in, n);
+    CUDA_CHECK_ERROR("rleFlagHeads");
+
+    cudppScanDispatch(d_ranks, d_flags, n, 1, plan->m_scanPlan);
+
+    rleScatterHeads<<<rleNumCTAs(n), RLE_CTA_SIZE>>>
+        (d_values, d_runLengths, d_numRuns, d_flags, d_ranks, d_in, n);
+    rleRunLengths<<<rleNumCTAs(n), RLE_CTA_SIZE>>>
+        (d_runLengths, d_flags, d_ranks, n);
+    CUDA_CHECK_ERROR("rleRunLengths");
+}
+
+/** @brief Expand runs of values of type \a T
+  *
+  * The run lengths are scanned to find where each run starts, the index
+  * of each run is written at its start, and a max-scan carries it over
+  * the rest of the run; each output position then gathers its value.
+  *
+  * @param[out] d_out The decoded values
+  * @param[in]  d_values The value of each run
+  * @param[in]  d_runLengths The length of each run
+  * @param[in]  numRuns Number of runs
+  * @param[in]  numElements Number of decoded values
+  * @param[in]  plan Pointer to the CUDPPRunLengthPlan object
+  */
+template <class T>
+void runLengthDecode(T                        *d_out,
+                     const T                  *d_values,
+                     const unsigned int       *d_runLengths,
+                     size_t                   numRuns,
+                     size_t                   numElements,
+                     const CUDPPRunLengthPlan *plan)
+{
+    if (numElements == 0 || numRuns == 0)
+        return;
+
+    unsigned int n = (unsigned int)numElements;
+    unsigned int *d_offsets = plan->m_d_ranks;
+    unsigned int *d_runIndex = plan->m_d_flags;
+
+    cudppScanDispatch(d_offsets, d_runLengths, numRuns, 1, plan->m_scanPlan);
+
+    CUDA_SAFE_CALL(cudaMemset(d_runIndex, 0, n * sizeof(unsigned int)));
+    rleMarkRuns<<<rleNumCTAs(numRuns), RLE_CTA_SIZE>>>
+        (d_runIndex, d_offsets, d_runLengths, (unsigned int)numRuns, n);
+    CUDA_CHECK_ERROR("rleMarkRuns");
+
+    cudppScanDispatch(d_runIndex, d_runIndex, n, 1, plan->m_maxScanPlan);
+
+    rleExpand<<<rleNumCTAs(n), RLE_CTA_SIZE>>>(d_out, d_values, d_runIndex, n);
+    CUDA_CHECK_ERROR("rleExpand");
+}
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** @brief Allocate intermediate storage for run-length encoding
+  *
+  * The encoder uses the two arrays for the run head flags and their
+  * scan; the decoder for the scanned run lengths and the run index of
+  * each output position.
+  *
+  * @param[in,out] plan Pointer to the CUDPPRunLengthPlan object
+  */
+void allocRunLengthStorage(CUDPPRunLengthPlan *plan)
+{
+    size_t numElements = std::max(plan->m_numElements, (size_t)1);
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_flags, numElements * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_ranks, numElements * sizeof(unsigned int)));
+}
+
+/** @brief Deallocate intermediate storage for run-length encoding
+  *
+  * @param[in,out] plan Pointer to the CUDPPRunLengthPlan object
+  */
+void freeRunLengthStorage(CUDPPRunLengthPlan *plan)
+{
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_flags));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_ranks));
+}
+
+/** @brief Run-length encode an array. Called by ::cudppRunLengthEncode().
+  *
+  * Values are compared as unsigned integers of the datatype's size, so
+  * floating-point runs are runs of identical bits.
+  *
+  * @param[out] d_values The value of each run
+  * @param[out] d_runLengths The length of each run
+  * @param[out] d_numRuns The number of runs
+  * @param[in]  d_in The values to encode
+  * @param[in]  numElements Number of values
+  * @param[in]  plan Pointer to the CUDPPRunLengthPlan object
+  */
+void cudppRunLengthEncodeDispatch(void                     *d_values,
+                                  unsigned int             *d_runLengths,
+                                  size_t                   *d_numRuns,
+                                  const void               *d_in,
+                                  size_t                   numElements,
+                                  const CUDPPRunLengthPlan *plan)
+{
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+    case CUDPP_UCHAR:
+        runLengthEncode((unsigned char*)d_values, d_runLengths, d_numRuns,
+                        (const unsigned char*)d_in, numElements, plan);
+        break;
+    case CUDPP_SHORT:
+    case CUDPP_USHORT:
+        runLengthEncode((unsigned short*)d_values, d_runLengths, d_numRuns,
+                        (const unsigned short*)d_in, numElements, plan);
+        break;
+    case CUDPP_INT:
+    case CUDPP_UINT:
+    case CUDPP_FLOAT:
+        runLengthEncode((unsigned int*)d_values, d_runLengths, d_numRuns,
+                        (const unsigned int*)d_in, numElements, plan);
+        break;
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG:
+        runLengthEncode((unsigned long long*)d_values, d_runLengths, d_numRuns,
+                        (const unsigned long long*)d_in, numElements, plan);
+        break;
+    default:
+        break;
+    }
+}
+
+/** @brief Expand a run-length encoded array. Called by
+  * ::cudppRunLengthDecode().
+  *
+  * @param[out] d_out The decoded values
+  * @param[in]  d_values The value of each run
+  * @param[in]  d_runLengths The length of each run
+  * @param[in]  numRuns Number of runs
+  * @param[in]  numElements Number of decoded values, the sum of the run lengths
+  * @param[in]  plan Pointer to the CUDPPRunLengthPlan object
+  */
+void cudppRunLengthDecodeDispatch(void                     *d_out,
+                                  const void               *d_values,
+                                  const unsigned int       *d_runLengths,
+                                  size_t                   numRuns,
+                                  size_t                   numElements,
+                                  const CUDPPRunLengthPlan *plan)
+{
+    switch (plan->m_config.datatype)
+    {
+    case CUDPP_CHAR:
+    case CUDPP_UCHAR:
+        runLengthDecode((unsigned char*)d_out, (const unsigned char*)d_values,
+                        d_runLengths, numRuns, numElements, plan);
+        break;
+    case CUDPP_SHORT:
+    case CUDPP_USHORT:
+        runLengthDecode((unsigned short*)d_out, (const unsigned short*)d_values,
+                        d_runLengths, numRuns, numElements, plan);
+        break;
+    case CUDPP_INT:
+    case CUDPP_UINT:
+    case CUDPP_FLOAT:
+        runLengthDecode((unsigned int*)d_out, (const unsigned int*)d_values,
+                        d_runLengths, numRuns, numElements, plan);
+        break;
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG:
+        runLengthDecode((unsigned long long*)d_out, (const unsigned long long*)d_values,
+                        d_runLengths, numRuns, numElements, plan);
+        break;
+    default:
+        break;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end run-length encoding functions
+/** @} */ // end cudpp_app
@@ -37,6 +37,7 @@
 #include "cudpp.h"
 #include "cudpp_util.h"
 #include "cudpp_plan.h"
+#include "cudpp_manager.h"
 #include "kernel/scan_kernel.cuh"
 #include "kernel/vector_kernel.cuh"
 
@@ -66,15 +67,18 @@
   * @param[in]  rowPitches  Array of row pitches (one array per recursive level, allocated by 
   *                         allocScanStorage())
   * @param[in]  level       The current recursive level of the scan
+  * @param[in]  stream      The stream on which all work of the scan is issued
+  * @returns the number of levels scanned, this one included
   */
 template <class T, bool isBackward, bool isExclusive, class Op>
-void scanArrayRecursive(T                   *d_out, 
+unsigned int scanArrayRecursive(T                   *d_out, 
                         const T             *d_in, 
                         T                   **d_blockSums,
                         size_t              numElements,
                         size_t              numRows,
                         const size_t        *rowPitches,
-                        int                 level)
+                        int                 level,
+                        cudaStream_t        stream)
 {
     unsigned int numBlocks = 
         max(1, (unsigned int)ceil((double)numElements / ((double)SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE)));
@@ -111,42 +115,42 @@ void scanArrayRecursive(T                   *d_out,
     {
     case 0: // single block, single row, non-full block
         scan4<T, ScanTraits<T, Op, isBackward, isExclusive, false, false, false> >
-               <<< grid, threads, sharedMemSize >>>
+               <<< grid, threads, sharedMemSize, stream >>>
                (d_out, d_in, 0, (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     case 1: // multiblock, single row, non-full block
         scan4< T, ScanTraits<T, Op, isBackward, isExclusive, false, true, false> >
-               <<< grid, threads, sharedMemSize >>>
+               <<< grid, threads, sharedMemSize, stream >>>
                (d_out, d_in, d_blockSums[level], (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     case 2: // single block, multirow, non-full block
         scan4<T, ScanTraits<T, Op, isBackward, isExclusive, true, false, false> >
-                <<< grid, threads, sharedMemSize >>>
+                <<< grid, threads, sharedMemSize, stream >>>
                 (d_out, d_in, 0, (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     case 3: // multiblock, multirow, non-full block
         scan4<T, ScanTraits<T, Op, isBackward, isExclusive, true, true, false> >
-                <<< grid, threads, sharedMemSize >>>
+                <<< grid, threads, sharedMemSize, stream >>>
                 (d_out, d_in, d_blockSums[level], (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     case 4: // single block, single row, full block
         scan4<T, ScanTraits<T, Op, isBackward, isExclusive, false, false, true> >
-               <<< grid, threads, sharedMemSize >>>
+               <<< grid, threads, sharedMemSize, stream >>>
                (d_out, d_in, 0, (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     case 5: // multiblock, single row, full block
         scan4< T, ScanTraits<T, Op, isBackward, isExclusive, false, true, true> >
-               <<< grid, threads, sharedMemSize >>>
+               <<< grid, threads, sharedMemSize, stream >>>
                (d_out, d_in, d_blockSums[level], (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     case 6: // single block, multirow, full block
         scan4<T, ScanTraits<T, Op, isBackward, isExclusive, true, false, true> >
-                <<< grid, threads, sharedMemSize >>>
+                <<< grid, threads, sharedMemSize, stream >>>
                 (d_out, d_in, 0, (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     case 7: // multiblock, multirow, full block
         scan4<T, ScanTraits<T, Op, isBackward, isExclusive, true, true, true> >
-                <<< grid, threads, sharedMemSize >>>
+                <<< grid, threads, sharedMemSize, stream >>>
                 (d_out, d_in, d_blockSums[level], (unsigned)numElements, rowPitch, blockSumRowPitch);
         break;
     }
@@ -160,21 +164,22 @@ void scanArrayRecursive(T                   *d_out,
         // sub-blocks and scan those. This will give us a new value
         // that must be sdded to each block to get the final results.
 
-        scanArrayRecursive<T, isBackward, true, Op>
+        unsigned int numLevels = 1 + scanArrayRecursive<T, isBackward, true, Op>
             ((T*)d_blockSums[level], (const T*)d_blockSums[level],
-             (T**)d_blockSums, numBlocks, numRows, rowPitches, level + 1); // recursive (CPU) call
+             (T**)d_blockSums, numBlocks, numRows, rowPitches, level + 1,
+             stream); // recursive (CPU) call
         
         if (fullBlock)
-            vectorAddUniform4<T, Op, SCAN_ELTS_PER_THREAD, true>
-                <<< grid, threads >>>(d_out, 
+            vectorAddUniform4<T, T, Op, SCAN_ELTS_PER_THREAD, true>
+                <<< grid, threads, 0, stream >>>(d_out, 
                                       (T*)d_blockSums[level], 
                                       (unsigned)numElements,
                                       rowPitch*4,
                                       blockSumRowPitch*4,
                                       0, 0);
         else
-            vectorAddUniform4<T, Op, SCAN_ELTS_PER_THREAD, false>
-                <<< grid, threads >>>(d_out, 
+            vectorAddUniform4<T, T, Op, SCAN_ELTS_PER_THREAD, false>
+                <<< grid, threads, 0, stream >>>(d_out, 
                                       (T*)d_blockSums[level], 
                                       (unsigned)numElements,
                                       rowPitch*4,
@@ -182,6 +187,202 @@ void scanArrayRecursive(T                   *d_out,
                                       0, 0);
        
         CUDA_CHECK_ERROR("vectorAddUniform");
+        return numLevels;
+    }
+    return 1;
+}
+
+/** @brief Perform a scan of arbitrary length by scanning segments
+  *
+  * Single-row scans longer than ::SCAN_MAX_SEGMENT_SIZE are split into
+  * segments that are each scanned by scanArrayRecursive().  The running total
+  * of all preceding segments (the carry) is kept in device memory and
+  * combined with each segment after it is scanned, so no host synchronization
+  * is needed and all indices inside the kernels stay 32-bit regardless of the
+  * total length.  Backward scans process segments from the end of the array
+  * toward the start.  Shorter scans and multi-row scans call
+  * scanArrayRecursive() directly.  All work is issued on the plan's 
+  * stream (see cudppScanAsync()).
+  *
+  * @param[out] d_out       The output array for the scan results
+  * @param[in]  d_in        The input array to be scanned (may equal \a d_out)
+  * @param[in]  numElements The number of elements in the array to scan
+  * @param[in]  numRows     The number of rows in the array to scan
+  * @param[in]  plan        Pointer to CUDPPScanPlan object containing
+  *                         intermediate storage
+  */
+template <class T, bool isBackward, bool isExclusive, class Op>
+void scanArray(T                   *d_out,
+               const T             *d_in,
+               size_t              numElements,
+               size_t              numRows,
+               const CUDPPScanPlan *plan)
+{
+    cudaStream_t stream = plan->m_launchStream;
+
+    if (numRows > 1 || numElements <= SCAN_MAX_SEGMENT_SIZE)
+    {
+        unsigned int numLevels = scanArrayRecursive<T, isBackward, isExclusive, Op>
+            (d_out, d_in, (T**)plan->m_blockSums,
+             numElements, numRows, plan->m_rowPitches, 0, stream);
+        plan->m_planManager->addIterations(numLevels);
+        return;
+    }
+
+    T *d_carry = (T*)plan->m_d_carry;
+    size_t numSegments = 
+        (numElements + SCAN_MAX_SEGMENT_SIZE - 1) / SCAN_MAX_SEGMENT_SIZE;
+
+    for (size_t i = 0; i < numSegments; i++)
+    {
+        size_t segment = isBackward ? numSegments - 1 - i : i;
+        size_t start   = segment * SCAN_MAX_SEGMENT_SIZE;
+        size_t length  = numElements - start;
+        if (length > SCAN_MAX_SEGMENT_SIZE) 
+            length = SCAN_MAX_SEGMENT_SIZE;
+        size_t last    = isBackward ? start : start + length - 1;
+
+        // an in-place scan overwrites the last input, which the exclusive
+        // carry needs, so save it first
+        if (isExclusive && i < numSegments - 1)
+            CUDA_SAFE_CALL(cudaMemcpyAsync(d_carry + 1, d_in + last, sizeof(T),
+                                           cudaMemcpyDeviceToDevice, stream));
+
+        unsigned int numLevels = scanArrayRecursive<T, isBackward, isExclusive, Op>
+            (d_out + start, d_in + start, (T**)plan->m_blockSums,
+             length, 1, plan->m_rowPitches, 0, stream);
+        plan->m_planManager->addIterations(numLevels);
+
+        if (i > 0)
+        {
+            unsigned int numBlocks = (unsigned int)
+                ((length + SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE - 1) /
+                 (SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE));
+            vectorAddUniformValue<T, Op, SCAN_ELTS_PER_THREAD>
+                <<< numBlocks, SCAN_CTA_SIZE, 0, stream >>>(d_out + start, d_carry, 
+                                                            (unsigned int)length);
+            CUDA_CHECK_ERROR("vectorAddUniformValue");
+        }
+
+        if (i < numSegments - 1)
+        {
+            scanSegmentCarry<T, Op, isExclusive><<< 1, 1, 0, stream >>>
+                (d_carry, d_out + last);
+            CUDA_CHECK_ERROR("scanSegmentCarry");
+        }
+    }
+}
+
+/** @brief Perform a scan whose block sums are combined in a wider type
+  *
+  * With ::CUDPP_OPTION_ACCUMULATE_DOUBLE only the first level of the scan
+  * hierarchy, in which each block combines at most SCAN_ELTS_PER_THREAD * 
+  * SCAN_CTA_SIZE elements, is computed in the datatype \a T.  The block
+  * sums are widened to \a A and scanned in \a A by scanArrayRecursive(),
+  * the carry between the segments of long scans is kept in \a A, and the
+  * prefix of each block is combined with its elements in \a A before they 
+  * are rounded back to \a T.  The rounding error of an element therefore
+  * depends on its position within its block, not on its position in the
+  * array, while the data read and written are still of type \a T.
+  *
+  * Template parameter \a Op is the scan operator on \a T and \a AccumOp
+  * the same operator on \a A.
+  *
+  * @param[out] d_out       The output array for the scan results
+  * @param[in]  d_in        The input array to be scanned (may equal \a d_out)
+  * @param[in]  numElements The number of elements in the array to scan
+  * @param[in]  plan        Pointer to CUDPPScanPlan object containing
+  *                         intermediate storage
+  */
+template <class T, class A, bool isBackward, bool isExclusive, class Op, class AccumOp>
+void scanArrayAccumulate(T                   *d_out,
+                         const T             *d_in,
+                         size_t              numElements,
+                         const CUDPPScanPlan *plan)
+{
+    const unsigned int eltsPerBlock = SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE;
+
+    // a single block has no block sums to widen
+    if (numElements <= eltsPerBlock)
+    {
+        scanArray<T, isBackward, isExclusive, Op>(d_out, d_in, numElements, 1, plan);
+        return;
+    }
+
+    cudaStream_t stream = plan->m_launchStream;
+    T *d_firstLevelSums = (T*)plan->m_firstLevelSums;
+    A **d_blockSums = (A**)plan->m_blockSums;
+    A *d_carry = (A*)plan->m_d_carry;
+    size_t numSegments = 
+        (numElements + SCAN_MAX_SEGMENT_SIZE - 1) / SCAN_MAX_SEGMENT_SIZE;
+
+    for (size_t i = 0; i < numSegments; i++)
+    {
+        size_t segment = isBackward ? numSegments - 1 - i : i;
+        size_t start   = segment * SCAN_MAX_SEGMENT_SIZE;
+        size_t length  = numElements - start;
+        if (length > SCAN_MAX_SEGMENT_SIZE) 
+            length = SCAN_MAX_SEGMENT_SIZE;
+
+        unsigned int numBlocks = (unsigned int)((length + eltsPerBlock - 1) / eltsPerBlock);
+        unsigned int lastBlock = isBackward ? 0 : numBlocks - 1;
+        bool fullBlock = (length == (size_t)numBlocks * eltsPerBlock);
+
+        dim3 grid(numBlocks, 1, 1);
+        dim3 threads(SCAN_CTA_SIZE, 1, 1);
+        unsigned int sharedMemSize = sizeof(T) * SCAN_CTA_SIZE * 2;
+
+        // scan each block in T, writing its sum even if it is the only block
+        if (fullBlock)
+            scan4<T, ScanTraits<T, Op, isBackward, isExclusive, false, true, true> >
+                <<< grid, threads, sharedMemSize, stream >>>
+                (d_out + start, d_in + start, d_firstLevelSums, (unsigned)length, 1, 1);
+        else
+            scan4<T, ScanTraits<T, Op, isBackward, isExclusive, false, true, false> >
+                <<< grid, threads, sharedMemSize, stream >>>
+                (d_out + start, d_in + start, d_firstLevelSums, (unsigned)length, 1, 1);
+        CUDA_CHECK_ERROR("prescan");
+
+        vectorConvert<T, A>
+            <<< (numBlocks + SCAN_CTA_SIZE - 1) / SCAN_CTA_SIZE, SCAN_CTA_SIZE, 0, stream >>>
+            (d_blockSums[0], d_firstLevelSums, numBlocks);
+        CUDA_CHECK_ERROR("vectorConvert");
+
+        // the segment's total is the prefix of its last block combined with
+        // that block's sum, which the in-place scan of the sums overwrites
+        if (i < numSegments - 1)
+            CUDA_SAFE_CALL(cudaMemcpyAsync(d_carry + 1, d_blockSums[0] + lastBlock, sizeof(A),
+                                           cudaMemcpyDeviceToDevice, stream));
+
+        unsigned int numLevels = 1 + scanArrayRecursive<A, isBackward, true, AccumOp>
+            (d_blockSums[0], d_blockSums[0], d_blockSums, numBlocks, 1, 
+             plan->m_rowPitches, 1, stream);
+        plan->m_planManager->addIterations(numLevels);
+
+        if (i > 0)
+        {
+            vectorAddUniformValue<A, AccumOp, SCAN_ELTS_PER_THREAD>
+                <<< (numBlocks + eltsPerBlock - 1) / eltsPerBlock, SCAN_CTA_SIZE, 0, stream >>>
+                (d_blockSums[0], d_carry, numBlocks);
+            CUDA_CHECK_ERROR("vectorAddUniformValue");
+        }
+
+        if (fullBlock)
+            vectorAddUniform4<T, A, AccumOp, SCAN_ELTS_PER_THREAD, true>
+                <<< grid, threads, 0, stream >>>(d_out + start, d_blockSums[0], 
+                                                 (unsigned)length, 0, 0, 0, 0);
+        else
+            vectorAddUniform4<T, A, AccumOp, SCAN_ELTS_PER_THREAD, false>
+                <<< grid, threads, 0, stream >>>(d_out + start, d_blockSums[0], 
+                                                 (unsigned)length, 0, 0, 0, 0);
+        CUDA_CHECK_ERROR("vectorAddUniform");
+
+        if (i < numSegments - 1)
+        {
+            scanSegmentCarry<A, AccumOp, true><<< 1, 1, 0, stream >>>
+                (d_carry, d_blockSums[0] + lastBlock);
+            CUDA_CHECK_ERROR("scanSegmentCarry");
+        }
     }
 }
 
@@ -208,7 +409,14 @@ void allocScanStorage(CUDPPScanPlan *plan)
 {
     plan->m_numEltsAllocated = plan->m_numElements;
 
-    size_t numElts = plan->m_numElements;
+    // long single-row scans are performed in segments (see scanArray()), so 
+    // the block sums only need to cover one segment, plus a carry between
+    // segments
+    size_t numSegmentElts = plan->m_numElements;
+    if (plan->m_numRows == 1 && numSegmentElts > SCAN_MAX_SEGMENT_SIZE)
+        numSegmentElts = SCAN_MAX_SEGMENT_SIZE;
+
+    size_t numElts = numSegmentElts;
     
     size_t level = 0;
 
@@ -252,6 +460,21 @@ void allocScanStorage(CUDPPScanPlan *plan)
         elementSize = sizeof(unsigned int);
         break;
     case CUDPP_FLOAT:
+        // block sums and the carry are double with CUDPP_OPTION_ACCUMULATE_DOUBLE
+        // (see scanArrayAccumulate()), and only the first level's sums are float
+        if (plan->m_config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+        {
+            plan->m_blockSums = (void**) malloc(level * sizeof(double*));
+            elementSize = sizeof(double);
+            if (level > 0)
+            {
+                size_t numBlocks = (numSegmentElts + SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE - 1) /
+                                   (SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE);
+                CUDA_SAFE_CALL(cudaMalloc(&plan->m_firstLevelSums, 
+                                          numBlocks * sizeof(float)));
+            }
+            break;
+        }
         plan->m_blockSums = (void**) malloc(level * sizeof(float*));
         elementSize = sizeof(float);
         break;
@@ -272,7 +495,7 @@ void allocScanStorage(CUDPPScanPlan *plan)
     }
 
     plan->m_numLevelsAllocated = level;
-    numElts = plan->m_numElements;
+    numElts = numSegmentElts;
     size_t numRows = plan->m_numRows;
     plan->m_numRowsAllocated = numRows;
     plan->m_rowPitches = 0;
@@ -311,6 +534,12 @@ void allocScanStorage(CUDPPScanPlan *plan)
         numElts = numBlocks;
     } while (numElts > 1);
 
+    plan->m_d_carry = 0;
+    if (numSegmentElts < plan->m_numElements)
+    {
+        CUDA_SAFE_CALL(cudaMalloc(&plan->m_d_carry, 2 * elementSize));
+    }
+
     CUDA_CHECK_ERROR("allocScanStorage");
 }
 
@@ -333,8 +562,14 @@ void freeScanStorage(CUDPPScanPlan *plan)
     free((void**)plan->m_blockSums);
     if (plan->m_numRows > 1)
         free((void*)plan->m_rowPitches);
+    if (plan->m_d_carry)
+        cudaFree(plan->m_d_carry);
+    if (plan->m_firstLevelSums)
+        cudaFree(plan->m_firstLevelSums);
 
     plan->m_blockSums = 0;
+    plan->m_d_carry = 0;
+    plan->m_firstLevelSums = 0;
     plan->m_numEltsAllocated = 0;
     plan->m_numLevelsAllocated = 0;
 }
@@ -353,28 +588,49 @@ void cudppScanDispatchOperator(void                *d_out,
     switch(plan->m_config.op)
     {
     case CUDPP_ADD:
-        scanArrayRecursive<T, isBackward, isExclusive, OperatorAdd<T> >
-            ((T*)d_out, (const T*)d_in, 
-            (T**)plan->m_blockSums, 
-            numElements, numRows, plan->m_rowPitches, 0);
+        scanArray<T, isBackward, isExclusive, OperatorAdd<T> >
+            ((T*)d_out, (const T*)d_in, numElements, numRows, plan);
         break;
     case CUDPP_MULTIPLY:
-        scanArrayRecursive<T, isBackward, isExclusive, OperatorMultiply<T> >
-            ((T*)d_out, (const T*)d_in, 
-            (T**)plan->m_blockSums, 
-            numElements, numRows, plan->m_rowPitches, 0);
+        scanArray<T, isBackward, isExclusive, OperatorMultiply<T> >
+            ((T*)d_out, (const T*)d_in, numElements, numRows, plan);
         break;
     case CUDPP_MAX:
-        scanArrayRecursive<T, isBackward, isExclusive, OperatorMax<T> >
-            ((T*)d_out, (const T*)d_in, 
-            (T**)plan->m_blockSums, 
-            numElements, numRows, plan->m_rowPitches, 0);
+        scanArray<T, isBackward, isExclusive, OperatorMax<T> >
+            ((T*)d_out, (const T*)d_in, numElements, numRows, plan);
         break;
     case CUDPP_MIN:
-        scanArrayRecursive<T, isBackward, isExclusive, OperatorMin<T> >
-            ((T*)d_out, (const T*)d_in, 
-            (T**)plan->m_blockSums, 
-            numElements, numRows, plan->m_rowPitches, 0);
+        scanArray<T, isBackward, isExclusive, OperatorMin<T> >
+            ((T*)d_out, (const T*)d_in, numElements, numRows, plan);
+        break;
+    default:
+        break;
+    }
+}
+
+template <typename T, typename A, bool isBackward, bool isExclusive>
+void cudppScanDispatchAccumulate(void                *d_out, 
+                                 const void          *d_in, 
+                                 size_t              numElements,
+                                 const CUDPPScanPlan *plan)
+{    
+    switch(plan->m_config.op)
+    {
+    case CUDPP_ADD:
+        scanArrayAccumulate<T, A, isBackward, isExclusive, OperatorAdd<T>, OperatorAdd<A> >
+            ((T*)d_out, (const T*)d_in, numElements, plan);
+        break;
+    case CUDPP_MULTIPLY:
+        scanArrayAccumulate<T, A, isBackward, isExclusive, OperatorMultiply<T>, OperatorMultiply<A> >
+            ((T*)d_out, (const T*)d_in, numElements, plan);
+        break;
+    case CUDPP_MAX:
+        scanArrayAccumulate<T, A, isBackward, isExclusive, OperatorMax<T>, OperatorMax<A> >
+            ((T*)d_out, (const T*)d_in, numElements, plan);
+        break;
+    case CUDPP_MIN:
+        scanArrayAccumulate<T, A, isBackward, isExclusive, OperatorMin<T>, OperatorMin<A> >
+            ((T*)d_out, (const T*)d_in, numElements, plan);
         break;
     default:
         break;
@@ -427,10 +683,16 @@ void cudppScanDispatchType(void                *d_out,
                                                numRows, plan);
         break;
     case CUDPP_FLOAT:
-        cudppScanDispatchOperator<float, 
-                                  isBackward, 
-                                  isExclusive>(d_out, d_in, numElements, 
-                                               numRows, plan);
+        if (plan->m_config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+            cudppScanDispatchAccumulate<float, double,
+                                        isBackward, 
+                                        isExclusive>(d_out, d_in, numElements, 
+                                                     plan);
+        else
+            cudppScanDispatchOperator<float, 
+                                      isBackward, 
+                                      isExclusive>(d_out, d_in, numElements, 
+                                                   numRows, plan);
         break;
     case CUDPP_DOUBLE:
         cudppScanDispatchOperator<double, 
@@ -80,9 +80,11 @@
 * @param[in] numElements The number of elements in the array to scan
 * @param[in] level The current recursive level of the scan
 * @param[in] sm12OrBetterHw True if running on sm_12 or higher GPU, false otherwise
+* @param[in] stream The stream on which all work of the segmented scan is issued
+* @returns the number of levels scanned, this one included
 */
 template <typename T, class Op, bool isBackward, bool isExclusive, bool doShiftFlagsLeft>
-void segmentedScanArrayRecursive(T                  *d_out, 
+unsigned int segmentedScanArrayRecursive(T                  *d_out, 
                                  const T            *d_idata, 
                                  const unsigned int *d_iflags,
                                  T                  **d_blockSums,
@@ -90,7 +92,8 @@ void segmentedScanArrayRecursive(T                  *d_out,
                                  unsigned int       **d_blockIndices,
                                  int                numElements,
                                  int                level,
-                                 bool               sm12OrBetterHw)
+                                 bool               sm12OrBetterHw,
+                                 cudaStream_t       stream)
 {
     unsigned int numBlocks = 
         max(1, (int)ceil((double)numElements / 
@@ -131,13 +134,13 @@ void segmentedScanArrayRecursive(T                  *d_out,
     case 0: // single block, single row, non-full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, false, false,
                        false> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements, 0, 0, 0);
         break;
     case 1: // multi block, single row, non-full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, false, true,
                        false> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements,
             d_blockSums[level], d_blockFlags[level],
             d_blockIndices[level]);
@@ -145,13 +148,13 @@ void segmentedScanArrayRecursive(T                  *d_out,
     case 2: // single block, single row, full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, true, false,
                        false> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements, 0, 0, 0);
         break;
     case 3: // multi block, single row, full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, true, true,
                        false> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements,
             d_blockSums[level], d_blockFlags[level],
             d_blockIndices[level]);
@@ -159,13 +162,13 @@ void segmentedScanArrayRecursive(T                  *d_out,
     case 4: // single block, single row, non-full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, false, false,
                        true> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements, 0, 0, 0);
         break;
     case 5: // multi block, single row, non-full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, false, true,
                        true> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements,
             d_blockSums[level], d_blockFlags[level],
             d_blockIndices[level]);
@@ -173,13 +176,13 @@ void segmentedScanArrayRecursive(T                  *d_out,
     case 6: // single block, single row, full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, true, false,
                        true> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements, 0, 0, 0);
         break;
     case 7: // multi block, single row, full last block
         segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, doShiftFlagsLeft, true, true,
                        true> >
-            <<< grid, threads, sharedMemSize >>>
+            <<< grid, threads, sharedMemSize, stream >>>
             (d_out, d_idata, d_iflags, numElements,
             d_blockSums[level], d_blockFlags[level],
             d_blockIndices[level]);
@@ -195,37 +198,165 @@ void segmentedScanArrayRecursive(T                  *d_out,
         // sub-blocks and segment scan those. This will give us a new value
         // that must be sdded to the first segment of each block to get 
         // the final results.
-        segmentedScanArrayRecursive<T, Op, isBackward, false, false>
+        unsigned int numLevels = 1 + segmentedScanArrayRecursive<T, Op, isBackward, false, false>
             ((T*)d_blockSums[level], (const T*)d_blockSums[level], 
             d_blockFlags[level], (T **)d_blockSums,
             d_blockFlags, d_blockIndices,
-            numBlocks, level + 1, sm12OrBetterHw);
+            numBlocks, level + 1, sm12OrBetterHw, stream);
             
         if (isBackward)
         {
             if (fullBlock)
-                vectorSegmentedAddUniformToRight4<T, Op, true><<<grid, threads>>>
+                vectorSegmentedAddUniformToRight4<T, T, Op, true><<<grid, threads, 0, stream>>>
                 (d_out, d_blockSums[level], d_blockIndices[level], 
                 numElements, 0, 0);
             else
-                vectorSegmentedAddUniformToRight4<T, Op, false><<<grid, threads>>>
+                vectorSegmentedAddUniformToRight4<T, T, Op, false><<<grid, threads, 0, stream>>>
                 (d_out, d_blockSums[level], d_blockIndices[level], 
                 numElements, 0, 0);
         }
         else
         {
             if (fullBlock)
-                vectorSegmentedAddUniform4<T, Op, true><<<grid, threads>>>
+                vectorSegmentedAddUniform4<T, T, Op, true><<<grid, threads, 0, stream>>>
                 (d_out, d_blockSums[level], d_blockIndices[level], 
                 numElements, 0, 0);
             else
-                vectorSegmentedAddUniform4<T, Op, false><<<grid, threads>>>
+                vectorSegmentedAddUniform4<T, T, Op, false><<<grid, threads, 0, stream>>>
                 (d_out, d_blockSums[level], d_blockIndices[level], 
                 numElements, 0, 0);
         }
 
         CUDA_CHECK_ERROR("vectorSegmentedAddUniform4");
+        return numLevels;
     }
+    return 1;
+}
+
+/** @brief Perform a segmented scan whose block sums are combined in a 
+* wider type
+*
+* With ::CUDPP_OPTION_ACCUMULATE_DOUBLE only the first level of the
+* hierarchy is scanned in the datatype \a T.  Its block sums are widened
+* to \a A, segmented-scanned in \a A by segmentedScanArrayRecursive() and
+* combined with the first segment of each block in \a A before the
+* results are rounded back to \a T (see scanArrayAccumulate()).
+*
+* Template parameter \a Op is the operator on \a T and \a AccumOp the 
+* same operator on \a A.
+*
+* @param[out] d_out The output array for the segmented scan results
+* @param[in] d_idata The input array to be scanned
+* @param[in] d_iflags The input flags vector which specifies the segments
+* @param[in] numElements The number of elements in the array to scan
+* @param[in] sm12OrBetterHw True if running on sm_12 or higher GPU, false otherwise
+* @param[in] plan Pointer to the CUDPPSegmentedScanPlan object containing
+* intermediate storage
+* @returns the number of levels scanned
+*/
+template <typename T, typename A, class Op, class AccumOp, bool isBackward, bool isExclusive>
+unsigned int segmentedScanArrayAccumulate(T                            *d_out, 
+                                          const T                      *d_idata, 
+                                          const unsigned int           *d_iflags,
+                                          int                          numElements,
+                                          bool                         sm12OrBetterHw,
+                                          const CUDPPSegmentedScanPlan *plan)
+{
+    unsigned int numBlocks = 
+        max(1, (int)ceil((double)numElements / 
+        ((double)SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE)));
+
+    // a single block has no block sums to widen
+    if (numBlocks == 1)
+        return segmentedScanArrayRecursive<T, Op, isBackward, isExclusive, isBackward>
+            (d_out, d_idata, d_iflags, (T **)plan->m_blockSums, plan->m_blockFlags,
+            plan->m_blockIndices, numElements, 0, sm12OrBetterHw, plan->m_launchStream);
+
+    cudaStream_t stream = plan->m_launchStream;
+    T *d_firstLevelSums = (T*)plan->m_firstLevelSums;
+    A **d_blockSums = (A**)plan->m_blockSums;
+
+    // shared memory for the values, the flags and the indices, as in
+    // segmentedScanArrayRecursive()
+    unsigned int numEltsPerBlock = SCAN_CTA_SIZE * 2;
+    unsigned int sharedMemSize = 
+        (sizeof(T) + 2 * sizeof(unsigned int)) * numEltsPerBlock;
+
+    dim3  grid(numBlocks, 1, 1);
+    dim3  threads(SCAN_CTA_SIZE, 1, 1);
+
+    bool fullBlock = (numElements == 
+        (numBlocks * SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE));    
+
+    unsigned int traitsCode = 0;
+    if (fullBlock)      traitsCode |= 1;
+    if (sm12OrBetterHw) traitsCode |= 2;
+
+    switch(traitsCode)
+    {
+    case 0: // multi block, single row, non-full last block
+        segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, isBackward, false, true,
+                       false> >
+            <<< grid, threads, sharedMemSize, stream >>>
+            (d_out, d_idata, d_iflags, numElements,
+            d_firstLevelSums, plan->m_blockFlags[0], plan->m_blockIndices[0]);
+        break;
+    case 1: // multi block, single row, full last block
+        segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, isBackward, true, true,
+                       false> >
+            <<< grid, threads, sharedMemSize, stream >>>
+            (d_out, d_idata, d_iflags, numElements,
+            d_firstLevelSums, plan->m_blockFlags[0], plan->m_blockIndices[0]);
+        break;
+    case 2: // multi block, single row, non-full last block
+        segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, isBackward, false, true,
+                       true> >
+            <<< grid, threads, sharedMemSize, stream >>>
+            (d_out, d_idata, d_iflags, numElements,
+            d_firstLevelSums, plan->m_blockFlags[0], plan->m_blockIndices[0]);
+        break;
+    case 3: // multi block, single row, full last block
+        segmentedScan4<T, SegmentedScanTraits<T, Op, isBackward, isExclusive, isBackward, true, true,
+                       true> >
+            <<< grid, threads, sharedMemSize, stream >>>
+            (d_out, d_idata, d_iflags, numElements,
+            d_firstLevelSums, plan->m_blockFlags[0], plan->m_blockIndices[0]);
+        break;
+    }
+
+    CUDA_CHECK_ERROR("segmentedScanArrayAccumulate after block level scans");
+
+    vectorConvert<T, A>
+        <<< (numBlocks + SCAN_CTA_SIZE - 1) / SCAN_CTA_SIZE, SCAN_CTA_SIZE, 0, stream >>>
+        (d_blockSums[0], d_firstLevelSums, numBlocks);
+
+    unsigned int numLevels = 1 + segmentedScanArrayRecursive<A, AccumOp, isBackward, false, false>
+        (d_blockSums[0], (const A*)d_blockSums[0], 
+        plan->m_blockFlags[0], d_blockSums,
+        plan->m_blockFlags, plan->m_blockIndices,
+        numBlocks, 1, sm12OrBetterHw, stream);
+
+    if (isBackward)
+    {
+        if (fullBlock)
+            vectorSegmentedAddUniformToRight4<T, A, AccumOp, true><<<grid, threads, 0, stream>>>
+            (d_out, d_blockSums[0], plan->m_blockIndices[0], numElements, 0, 0);
+        else
+            vectorSegmentedAddUniformToRight4<T, A, AccumOp, false><<<grid, threads, 0, stream>>>
+            (d_out, d_blockSums[0], plan->m_blockIndices[0], numElements, 0, 0);
+    }
+    else
+    {
+        if (fullBlock)
+            vectorSegmentedAddUniform4<T, A, AccumOp, true><<<grid, threads, 0, stream>>>
+            (d_out, d_blockSums[0], plan->m_blockIndices[0], numElements, 0, 0);
+        else
+            vectorSegmentedAddUniform4<T, A, AccumOp, false><<<grid, threads, 0, stream>>>
+            (d_out, d_blockSums[0], plan->m_blockIndices[0], numElements, 0, 0);
+    }
+
+    CUDA_CHECK_ERROR("vectorSegmentedAddUniform4");
+    return numLevels;
 }
 
 #ifdef __cplusplus
@@ -285,6 +416,21 @@ extern "C"
             elementSize = sizeof(unsigned int);
             break;
         case CUDPP_FLOAT:
+            // block sums are double with CUDPP_OPTION_ACCUMULATE_DOUBLE (see
+            // segmentedScanArrayAccumulate()), except for the first level's
+            if (plan->m_config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+            {
+                plan->m_blockSums = (void**) malloc(level * sizeof(double*));
+                elementSize = sizeof(double);
+                if (level > 0)
+                {
+                    size_t numBlocks = (plan->m_numElements + SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE - 1) /
+                                       (SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE);
+                    CUDA_SAFE_CALL(cudaMalloc(&plan->m_firstLevelSums, 
+                                              numBlocks * sizeof(float)));
+                }
+                break;
+            }
             plan->m_blockSums = (void**) malloc(level * sizeof(float*));
             elementSize = sizeof(float);
             break;
@@ -358,8 +504,11 @@ extern "C"
         free((void**)plan->m_blockSums);
         free((void**)plan->m_blockFlags);
         free((void**)plan->m_blockIndices);
+        if (plan->m_firstLevelSums)
+            cudaFree(plan->m_firstLevelSums);
 
         plan->m_blockSums = 0;
+        plan->m_firstLevelSums = 0;
         plan->m_blockFlags = 0;
         plan->m_blockIndices = 0;
         plan->m_numEltsAllocated = 0;
@@ -384,31 +533,72 @@ void cudppSegmentedScanDispatchOperator(void                         *d_out,
     if ((deviceProp.major * 10 + deviceProp.minor) >= 12)
         sm12OrBetterHw = true;
     
+    unsigned int numLevels = 0;
     switch(plan->m_config.op)
     {
     case CUDPP_MAX:
-        segmentedScanArrayRecursive<T, OperatorMax<T>, isBackward, isExclusive, isBackward>
+        numLevels = segmentedScanArrayRecursive<T, OperatorMax<T>, isBackward, isExclusive, isBackward>
             ((T *)d_out, (const T *)d_in, d_iflags, (T **)plan->m_blockSums, plan->m_blockFlags,
-            plan->m_blockIndices, numElements, 0, sm12OrBetterHw);
+            plan->m_blockIndices, numElements, 0, sm12OrBetterHw, plan->m_launchStream);
         break;
     case CUDPP_ADD:
-        segmentedScanArrayRecursive<T, OperatorAdd<T>, isBackward, isExclusive, isBackward>
+        numLevels = segmentedScanArrayRecursive<T, OperatorAdd<T>, isBackward, isExclusive, isBackward>
             ((T *)d_out, (const T *)d_in, d_iflags, (T **)plan->m_blockSums, plan->m_blockFlags,
-            plan->m_blockIndices, numElements, 0, sm12OrBetterHw);
+            plan->m_blockIndices, numElements, 0, sm12OrBetterHw, plan->m_launchStream);
         break;
     case CUDPP_MULTIPLY:
-        segmentedScanArrayRecursive<T, OperatorMultiply<T>, isBackward, isExclusive, isBackward>
+        numLevels = segmentedScanArrayRecursive<T, OperatorMultiply<T>, isBackward, isExclusive, isBackward>
             ((T *)d_out, (const T *)d_in, d_iflags, (T **)plan->m_blockSums, plan->m_blockFlags,
-            plan->m_blockIndices, numElements, 0, sm12OrBetterHw);
+            plan->m_blockIndices, numElements, 0, sm12OrBetterHw, plan->m_launchStream);
         break;
     case CUDPP_MIN:
-        segmentedScanArrayRecursive<T, OperatorMin<T>, isBackward, isExclusive, isBackward>
+        numLevels = segmentedScanArrayRecursive<T, OperatorMin<T>, isBackward, isExclusive, isBackward>
             ((T *)d_out, (const T *)d_in, d_iflags, (T **)plan->m_blockSums, plan->m_blockFlags,
-            plan->m_blockIndices, numElements, 0, sm12OrBetterHw);
+            plan->m_blockIndices, numElements, 0, sm12OrBetterHw, plan->m_launchStream);
+        break;
+    default:
+        break;
+    }
+    plan->m_planManager->addIterations(numLevels);
+}
+
+template <typename T, typename A, bool isBackward, bool isExclusive>
+void cudppSegmentedScanDispatchAccumulate(void                         *d_out, 
+                                          const void                   *d_in,
+                                          const unsigned int           *d_iflags,
+                                          int                          numElements,
+                                          const CUDPPSegmentedScanPlan *plan
+                                          )
+{
+    cudaDeviceProp deviceProp;
+    plan->m_planManager->getDeviceProps(deviceProp);
+    bool sm12OrBetterHw = false;
+    if ((deviceProp.major * 10 + deviceProp.minor) >= 12)
+        sm12OrBetterHw = true;
+    
+    unsigned int numLevels = 0;
+    switch(plan->m_config.op)
+    {
+    case CUDPP_MAX:
+        numLevels = segmentedScanArrayAccumulate<T, A, OperatorMax<T>, OperatorMax<A>, isBackward, isExclusive>
+            ((T *)d_out, (const T *)d_in, d_iflags, numElements, sm12OrBetterHw, plan);
+        break;
+    case CUDPP_ADD:
+        numLevels = segmentedScanArrayAccumulate<T, A, OperatorAdd<T>, OperatorAdd<A>, isBackward, isExclusive>
+            ((T *)d_out, (const T *)d_in, d_iflags, numElements, sm12OrBetterHw, plan);
+        break;
+    case CUDPP_MULTIPLY:
+        numLevels = segmentedScanArrayAccumulate<T, A, OperatorMultiply<T>, OperatorMultiply<A>, isBackward, isExclusive>
+            ((T *)d_out, (const T *)d_in, d_iflags, numElements, sm12OrBetterHw, plan);
+        break;
+    case CUDPP_MIN:
+        numLevels = segmentedScanArrayAccumulate<T, A, OperatorMin<T>, OperatorMin<A>, isBackward, isExclusive>
+            ((T *)d_out, (const T *)d_in, d_iflags, numElements, sm12OrBetterHw, plan);
         break;
     default:
         break;
     }
+    plan->m_planManager->addIterations(numLevels);
 }
 
 template <bool isBackward, bool isExclusive>
@@ -430,8 +620,12 @@ void cudppSegmentedScanDispatchType(void                         *d_out,
             (d_out, d_in, d_iflags, numElements, plan);
         break;
     case CUDPP_FLOAT:
-        cudppSegmentedScanDispatchOperator<float, isBackward, isExclusive>
-            (d_out, d_in, d_iflags, numElements, plan);
+        if (plan->m_config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+            cudppSegmentedScanDispatchAccumulate<float, double, isBackward, isExclusive>
+                (d_out, d_in, d_iflags, numElements, plan);
+        else
+            cudppSegmentedScanDispatchOperator<float, isBackward, isExclusive>
+                (d_out, d_in, d_iflags, numElements, plan);
         break;
     case CUDPP_DOUBLE:
         cudppSegmentedScanDispatchOperator<double, isBackward, isExclusive>
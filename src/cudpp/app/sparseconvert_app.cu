@@ -0,0 +1,217 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt 
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+#include "cuda_util.h"
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_util.h"
+#include "cudpp_plan.h"
+#include "cudpp_radixsort.h"
+#include "cudpp_sparseconvert.h"
+
+#include "kernel/sparseconvert_kernel.cuh"
+
+#include <algorithm>
+
+/**
+ * @file
+ * sparseconvert_app.cu
+ * 
+ * @brief CUDPP application-level sparse matrix format conversion routines
+ */
+
+/** \addtogroup cudpp_app 
+ * @{
+ */
+
+/** @name Sparse Matrix Conversion Functions
+ * @{
+ */
+
+/** @brief Number of CTAs for a grid-stride launch over \a numItems items
+  *
+  * @param[in] numItems Number of items to be processed
+  * @returns The number of CTAs, between 1 and 65535
+  */
+inline unsigned int sparseConvertNumCTAs(size_t numItems)
+{
+    size_t numCTAs = (numItems + SPARSE_CONVERT_CTA_SIZE - 1) / SPARSE_CONVERT_CTA_SIZE;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Sort (major, minor, value) triples into compressed form
+  *
+  * Sorts the nonzeros by major and then minor index with the plan's radix
+  * sort, computes the \a numMajor + 1 offsets from the sorted keys, and
+  * writes the minor indices and permuted values.  Both conversions reduce
+  * to this: COO to CSR sorts by (row, column), and a CSR transpose, which
+  * is also a CSR to CSC conversion, sorts by (column, row).
+  *
+  * @param[out] d_offsets The offsets of the output (\a numMajor + 1 entries)
+  * @param[out] d_minorOut The minor index of each sorted nonzero
+  * @param[out] d_valuesOut The sorted values, or null
+  * @param[in] d_major The major index of each input nonzero
+  * @param[in] d_minor The minor index of each input nonzero
+  * @param[in] d_values The input values, or null
+  * @param[in] numNonZeroElements The number of nonzeros
+  * @param[in] numMajor The number of rows of the output
+  * @param[in] plan Pointer to the CUDPPSparseConvertPlan object
+  */
+void sparseCompress(unsigned int       *d_offsets,
+                    unsigned int       *d_minorOut,
+                    void               *d_valuesOut,
+                    const unsigned int *d_major,
+                    const unsigned int *d_minor,
+                    const void         *d_values,
+                    size_t             numNonZeroElements,
+                    size_t             numMajor,
+                    const CUDPPSparseConvertPlan *plan)
+{
+    unsigned int numCTAs = sparseConvertNumCTAs(numNonZeroElements);
+
+    sparseMakeKeys<<<numCTAs, SPARSE_CONVERT_CTA_SIZE>>>
+        (plan->m_d_keys, plan->m_d_permutation, d_major, d_minor,
+         (unsigned int)numNonZeroElements);
+    CUDA_CHECK_ERROR("sparseMakeKeys");
+
+    cudppRadixSortDispatch(plan->m_d_keys, plan->m_d_permutation,
+                           numNonZeroElements, plan->m_sortPlan);
+
+    sparseOffsetsFromKeys<<<sparseConvertNumCTAs(numNonZeroElements + 1),
+                            SPARSE_CONVERT_CTA_SIZE>>>
+        (d_offsets, plan->m_d_keys, (unsigned int)numNonZeroElements,
+         (unsigned int)numMajor);
+    CUDA_CHECK_ERROR("sparseOffsetsFromKeys");
+
+    // values are moved, not interpreted, so only their size matters
+    if (d_values != NULL &&
+        (plan->m_config.datatype == CUDPP_DOUBLE || 
+         plan->m_config.datatype == CUDPP_LONGLONG ||
+         plan->m_config.datatype == CUDPP_ULONGLONG))
+    {
+        sparseGatherSorted<unsigned long long><<<numCTAs, SPARSE_CONVERT_CTA_SIZE>>>
+            (d_minorOut, (unsigned long long*)d_valuesOut, plan->m_d_keys,
+             plan->m_d_permutation, (const unsigned long long*)d_values,
+             (unsigned int)numNonZeroElements);
+    }
+    else
+    {
+        sparseGatherSorted<unsigned int><<<numCTAs, SPARSE_CONVERT_CTA_SIZE>>>
+            (d_minorOut, (unsigned int*)d_valuesOut, plan->m_d_keys,
+             plan->m_d_permutation, (const unsigned int*)d_values,
+             (unsigned int)numNonZeroElements);
+    }
+    CUDA_CHECK_ERROR("sparseGatherSorted");
+}
+
+#ifdef __cplusplus
+extern "C" 
+{
+#endif
+
+/** @brief Allocate intermediate storage for sparse matrix conversion
+  *
+  * @param[in,out] plan Pointer to the CUDPPSparseConvertPlan object
+  */
+void allocSparseConvertStorage(CUDPPSparseConvertPlan *plan)
+{
+    size_t numElements = std::max(plan->m_numElements, (size_t)1);
+
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_keys,
+                              numElements * sizeof(unsigned long long)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_permutation,
+                              numElements * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void**)&plan->m_d_rows,
+                              numElements * sizeof(unsigned int)));
+}
+
+/** @brief Deallocate intermediate storage for sparse matrix conversion
+  *
+  * @param[in,out] plan Pointer to the CUDPPSparseConvertPlan object
+  */
+void freeSparseConvertStorage(CUDPPSparseConvertPlan *plan)
+{
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_keys));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_permutation));
+    CUDA_SAFE_CALL(cudaFree(plan->m_d_rows));
+}
+
+/** @brief Convert a matrix in coordinate (COO) format to CSR
+  *
+  * Called by ::cudppSparseCooToCsr().
+  *
+  * @param[out] d_rowOffsets The CSR row offsets (\a numRows + 1 entries)
+  * @param[out] d_colIndices The CSR column indices
+  * @param[out] d_values The CSR values, or null
+  * @param[in] d_cooRows The row of each nonzero
+  * @param[in] d_cooCols The column of each nonzero
+  * @param[in] d_cooValues The value of each nonzero, or null
+  * @param[in] numNonZeroElements The number of nonzeros
+  * @param[in] numRows The number of rows of the matrix
+  * @param[in] plan Pointer to the CUDPPSparseConvertPlan object
+  */
+void cudppSparseCooToCsrDispatch(unsigned int       *d_rowOffsets,
+                                 unsigned int       *d_colIndices,
+                                 void               *d_values,
+                                 const unsigned int *d_cooRows,
+                                 const unsigned int *d_cooCols,
+                                 const void         *d_cooValues,
+                                 size_t             numNonZeroElements,
+                                 size_t             numRows,
+                                 const CUDPPSparseConvertPlan *plan)
+{
+    sparseCompress(d_rowOffsets, d_colIndices, d_values, d_cooRows, d_cooCols,
+                   d_cooValues, numNonZeroElements, numRows, plan);
+}
+
+/** @brief Transpose a CSR matrix
+  *
+  * Expands the row offsets to a row index per nonzero, which makes the
+  * matrix a COO matrix, and compresses it by column.  Called by 
+  * ::cudppSparseTranspose().
+  *
+  * @param[out] d_tRowOffsets The row offsets of the transpose (\a numCols + 1 entries)
+  * @param[out] d_tColIndices The column indices of the transpose
+  * @param[out] d_tValues The values of the transpose, or null
+  * @param[in] d_rowOffsets The row offsets of the matrix (\a numRows + 1 entries)
+  * @param[in] d_colIndices The column indices of the matrix
+  * @param[in] d_values The values of the matrix, or null
+  * @param[in] numRows The number of rows of the matrix
+  * @param[in] numCols The number of columns of the matrix
+  * @param[in] numNonZeroElements The number of nonzeros
+  * @param[in] plan Pointer to the CUDPPSparseConvertPlan object
+  */
+void cudppSparseTransposeDispatch(unsigned int       *d_tRowOffsets,
+                                  unsigned int       *d_tColIndices,
+                                  void               *d_tValues,
+                                  const unsigned int *d_rowOffsets,
+                                  const unsigned int *d_colIndices,
+                                  const void         *d_values,
+                                  size_t             numRows,
+                                  size_t             numCols,
+                                  size_t             numNonZeroElements,
+                                  const CUDPPSparseConvertPlan *plan)
+{
+    sparseExpandRows<<<sparseConvertNumCTAs(numNonZeroElements), 
+                       SPARSE_CONVERT_CTA_SIZE>>>
+        (plan->m_d_rows, d_rowOffsets, (unsigned int)numRows, 
+         (unsigned int)numNonZeroElements);
+    CUDA_CHECK_ERROR("sparseExpandRows");
+
+    sparseCompress(d_tRowOffsets, d_tColIndices, d_tValues, d_colIndices,
+                   plan->m_d_rows, d_values, numNonZeroElements, numCols, plan);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */ // end sparse matrix conversion functions
+/** @} */ // end cudpp_app
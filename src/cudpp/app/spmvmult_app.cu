@@ -12,7 +12,7 @@
  * @file
  * spmvmult_app.cu
  *
- * @brief CUDPP application-level scan routines
+ * @brief CUDPP application-level sparse matrix-vector multiply routines
  */
 
 /** \addtogroup cudpp_app
@@ -21,7 +21,10 @@
 
 #include <cstdlib>
 #include <cstdio>
+#include <cstring>
 #include <assert.h>
+#include <algorithm>
+#include <vector>
 
 #include "cuda_util.h"
 #include "cudpp.h"
@@ -30,86 +33,397 @@
 #include "cudpp_globals.h"
 #include "kernel/spmvmult_kernel.cuh"
 
-extern "C"
-void cudppSegmentedScanDispatch (void                   *d_out, 
-                                 const void             *d_idata,
-                                 const unsigned int     *d_iflags,
-                                 int                    numElements,
-                                 const CUDPPSegmentedScanPlan *plan
-                                );
-
 /** @name Sparse Matrix-Vector Multiply Functions
  * @{
  */
 
-/** @brief Perform matrix-vector multiply for sparse matrices and vectors of arbitrary size.
+/** @brief Number of CTAs for a grid-stride loop over \a numItems items
+  * of \a itemsPerCTA each, limited to the maximum 1D grid size. */
+inline unsigned int spmvNumCTAs(size_t numItems, size_t itemsPerCTA)
+{
+    size_t numCTAs = (numItems + itemsPerCTA - 1) / itemsPerCTA;
+    return (unsigned int)std::max((size_t)1, std::min(numCTAs, (size_t)65535));
+}
+
+/** @brief Launch the vector-per-row kernel with a compile-time vector size
   *
-  * This function performs the sparse matrix-vector multiply by executing four steps. 
+  * @param[out] d_y The output array for the sparse matrix-vector multiply (y vector)
+  * @param[in] d_x The input x vector
+  * @param[in] d_A The matrix values, in their storage format
+  * @param[in] d_index The column indices, 32-bit or 16-bit
+  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object
+  */
+template <class T, class V, class I, class Acc, unsigned int vectorSize>
+void spmvVectorPerRowLaunch(T                                         *d_y,
+                            const T                                   *d_x,
+                            const V                                   *d_A,
+                            const I                                   *d_index,
+                            const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    unsigned int numCTAs = spmvNumCTAs(plan->m_numRows, SPMV_CTA_SIZE / vectorSize);
+    spmvVectorPerRow<T, V, I, Acc, vectorSize>
+        <<<numCTAs, SPMV_CTA_SIZE, SPMV_CTA_SIZE * sizeof(Acc)>>>
+        (d_y, d_A, d_index, plan->m_d_indexBase, plan->m_d_rowIndex,
+         plan->m_d_rowFinalIndex, d_x, (unsigned int)plan->m_numRows);
+}
+
+/** @brief Perform matrix-vector multiply for sparse matrices and vectors of arbitrary size.
   *
-  * 1. The sparseMatrixVectorFetchAndMultiply() kernel does an element-wise multiplication of a
-  *    each element e in CUDPPSparseMatrixVectorMultiplyPlan::m_d_A with the corresponding 
-  *    (i.e. in the same row as the column index of e in CUDPPSparseMatrixVectorMultiplyPlan::m_d_A) 
-  *    element in d_x and stores the product in CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod. It 
-  *    also sets all elements of CUDPPSparseMatrixVectorMultiplyPlan::m_d_flags to 0.
+  * Computes y += A * x with the kernel chosen for the matrix when it was
+  * created (see CUDPPSparseMatrixVectorMultiplyPlan):
   *
-  * 2. The sparseMatrixVectorSetFlags() kernel iterates over each element in 
-  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowIndex and sets 
-  *    the corresponding position (indicated by CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowIndex) in 
-  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_flags to 1.
+  * - ::CUDPP_SPMV_ROW_PER_THREAD runs spmvRowPerThread(), one thread per row,
+  *   for short rows.
+  * - ::CUDPP_SPMV_VECTOR_PER_ROW runs spmvVectorPerRow() with
+  *   CUDPPSparseMatrixVectorMultiplyPlan::m_vectorSize threads per row, for
+  *   longer rows of similar length (e.g. banded matrices).
+  * - ::CUDPP_SPMV_MERGE_PATH runs spmvMergePath() and spmvMergePathFixup(),
+  *   which split the rows and nonzeros evenly among threads, for matrices
+  *   whose row lengths are highly skewed (e.g. power-law graphs).
   *
-  * 3. Perform a segmented scan on CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod with 
-  *    CUDPPSparseMatrixVectorMultiplyPlan::m_d_flags as the flag vector. The output is 
-  *    stored in CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod.
+  * Each kernel reads every nonzero once.  Empty rows leave y unchanged.
   *
-  * 4. The yGather() kernel goes over each element in CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowFinalIndex 
-  *    and picks the corresponding element (indicated by CUDPPSparseMatrixVectorMultiplyPlan::m_d_rowFinalIndex) 
-  *    element from CUDPPSparseMatrixVectorMultiplyPlan::m_d_prod and stores it in d_y.
+  * Template parameter \a T is the datatype of x and y, \a V the storage
+  * type of the matrix values, \a I the type of the column indices and
+  * \a Acc the type of accumulation.
   *
-  * @param[out] d_y The output array for the sparse matrix-vector multiply (y vector)
+  * @param[in,out] d_y The output array for the sparse matrix-vector multiply (y vector)
   * @param[in] d_x The input x vector
+  * @param[in] d_A The matrix values, in their storage format
+  * @param[in] d_index The column indices, 32-bit or 16-bit
   * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object which stores the 
   *                 configuration and pointers to temporary buffers needed by this routine
   */
-template <class T>
+template <class T, class V, class I, class Acc>
 void sparseMatrixVectorMultiply(
                                  T                       *d_y, 
                                  const T                 *d_x,  
+                                 const V                 *d_A,
+                                 const I                 *d_index,
                                  const CUDPPSparseMatrixVectorMultiplyPlan *plan
                                 )
 {
-    unsigned int numEltsBlocks = 
-        max(1, (int)ceil((double)plan->m_numNonZeroElements / 
-                         ((double)SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE)));
-    
-    bool fullBlock = 
-        (plan->m_numNonZeroElements == (numEltsBlocks * SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE));  
-
-    dim3  gridElts(max(1, numEltsBlocks), 1, 1);
-    dim3  threads(SCAN_CTA_SIZE, 1, 1);
-
-    if (fullBlock)
-        sparseMatrixVectorFetchAndMultiply<T, true><<<gridElts, threads>>>
-            (plan->m_d_flags, (T*)plan->m_d_prod, (T*)plan->m_d_A, d_x, plan->m_d_index, (unsigned)plan->m_numNonZeroElements);
+    unsigned int numRows = (unsigned int)plan->m_numRows;
+
+    switch (plan->m_strategy)
+    {
+    case CUDPP_SPMV_ROW_PER_THREAD:
+        spmvRowPerThread<T, V, I, Acc><<<spmvNumCTAs(numRows, SPMV_CTA_SIZE), SPMV_CTA_SIZE>>>
+            (d_y, d_A, d_index, plan->m_d_indexBase, plan->m_d_rowIndex,
+             plan->m_d_rowFinalIndex, d_x, numRows);
+        break;
+    case CUDPP_SPMV_VECTOR_PER_ROW:
+        switch (plan->m_vectorSize)
+        {
+        case 2:
+            spmvVectorPerRowLaunch<T, V, I, Acc, 2>(d_y, d_x, d_A, d_index, plan);
+            break;
+        case 4:
+            spmvVectorPerRowLaunch<T, V, I, Acc, 4>(d_y, d_x, d_A, d_index, plan);
+            break;
+        case 8:
+            spmvVectorPerRowLaunch<T, V, I, Acc, 8>(d_y, d_x, d_A, d_index, plan);
+            break;
+        case 16:
+            spmvVectorPerRowLaunch<T, V, I, Acc, 16>(d_y, d_x, d_A, d_index, plan);
+            break;
+        default:
+            spmvVectorPerRowLaunch<T, V, I, Acc, WARP_SIZE>(d_y, d_x, d_A, d_index, plan);
+            break;
+        }
+        break;
+    case CUDPP_SPMV_MERGE_PATH:
+        {
+            unsigned int numCarries = 2 * plan->m_numTiles;
+            spmvMergePath<T, V, I, Acc>
+                <<<spmvNumCTAs(plan->m_numTiles, 1), SPMV_CTA_SIZE, 
+                   2 * SPMV_CTA_SIZE * sizeof(Acc)>>>
+                (d_y, (Acc*)plan->m_d_carryValue, plan->m_d_carryRow, d_A, d_index,
+                 plan->m_d_indexBase, plan->m_d_rowIndex, plan->m_d_rowFinalIndex, d_x,
+                 numRows, (unsigned int)plan->m_numNonZeroElements, plan->m_numTiles);
+            spmvMergePathFixup<T, Acc><<<spmvNumCTAs(numCarries, SPMV_CTA_SIZE), SPMV_CTA_SIZE>>>
+                (d_y, (const Acc*)plan->m_d_carryValue, plan->m_d_carryRow, numCarries,
+                 numRows);
+        }
+        break;
+    }
+    CUDA_CHECK_ERROR("sparseMatrixVectorMultiply");
+}
+
+/** @brief Perform sparse matrix-dense matrix multiply Y += A * X.
+  *
+  * Runs spmmRowBlock() with the threads of each row spanning the columns
+  * of X: a power of two no larger than ::WARP_SIZE that covers
+  * \a numVectors, so that narrow blocks do not leave most threads idle.
+  * The remaining threads of the CTA process further rows.
+  *
+  * The strategy chosen for the matrix is honored as follows.  Rows of
+  * ::CUDPP_SPMV_ROW_PER_THREAD and ::CUDPP_SPMV_VECTOR_PER_ROW matrices have
+  * similar lengths, so each row of threads takes one row of A.  For
+  * ::CUDPP_SPMV_MERGE_PATH matrices, rows longer than
+  * ::SPMM_ROW_PIECE_LENGTH are instead split into pieces that are spread
+  * over the CTAs by spmmRowPieces() and summed by spmmRowPiecesFixup(), in
+  * passes of ::SPMM_CARRY_VECTORS columns.
+  *
+  * Template parameter \a T is the datatype of X and Y, \a V the storage
+  * type of the matrix values, \a I the type of the column indices and
+  * \a Acc the type of accumulation.
+  *
+  * @param[in,out] d_Y The output matrix, numRows x \a numVectors, row-major
+  * @param[in] d_X The input matrix, numRows x \a numVectors, row-major
+  * @param[in] numVectors The number of columns of X and Y
+  * @param[in] d_A The matrix values, in their storage format
+  * @param[in] d_index The column indices, 32-bit or 16-bit
+  * @param[in] plan Pointer to the CUDPPSparseMatrixVectorMultiplyPlan object
+  */
+template <class T, class V, class I, class Acc>
+void sparseMatrixMatrixMultiply(T                                         *d_Y,
+                                const T                                   *d_X,
+                                unsigned int                              numVectors,
+                                const V                                   *d_A,
+                                const I                                   *d_index,
+                                const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    unsigned int columnThreads = 1;
+    while (columnThreads < WARP_SIZE && 
+           columnThreads * SPMM_VECTORS_PER_THREAD < numVectors)
+        columnThreads <<= 1;
+
+    dim3 threads(columnThreads, SPMV_CTA_SIZE / columnThreads, 1);
+    unsigned int numCTAs = spmvNumCTAs(plan->m_numRows, threads.y);
+    unsigned int maxRowLength = plan->m_numRowPieces ? SPMM_ROW_PIECE_LENGTH : 0xffffffff;
+
+    spmmRowBlock<T, V, I, Acc><<<numCTAs, threads>>>
+        (d_Y, d_A, d_index, plan->m_d_indexBase, plan->m_d_rowIndex,
+         plan->m_d_rowFinalIndex, d_X, (unsigned int)plan->m_numRows, numVectors,
+         maxRowLength);
+
+    for (unsigned int first = 0; plan->m_numRowPieces && first < numVectors; 
+         first += SPMM_CARRY_VECTORS)
+    {
+        unsigned int tileVectors = std::min(numVectors - first, (unsigned int)SPMM_CARRY_VECTORS);
+
+        spmmRowPieces<T, V, I, Acc><<<spmvNumCTAs(plan->m_numRowPieces, threads.y), threads>>>
+            ((Acc*)plan->m_d_pieceCarry, d_A, d_index, plan->m_d_indexBase,
+             plan->m_d_pieceStart, plan->m_d_pieceEnd, d_X, plan->m_numRowPieces,
+             numVectors, first, tileVectors);
+        spmmRowPiecesFixup<T, Acc><<<spmvNumCTAs(plan->m_numLongRows, threads.y), threads>>>
+            (d_Y, (const Acc*)plan->m_d_pieceCarry, plan->m_d_longRow,
+             plan->m_d_longRowPieces, plan->m_numLongRows, numVectors, first, tileVectors);
+    }
+
+    CUDA_CHECK_ERROR("sparseMatrixMatrixMultiply");
+}
+
+/** @brief Matrix-vector multiply entry point for spmvDispatch() */
+template <class T, class V, class I, class Acc>
+struct SpmvMultiply
+{
+    static void run(T *d_y, const T *d_x, size_t /*numVectors*/, const V *d_A,
+                    const I *d_index, const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+    {
+        sparseMatrixVectorMultiply<T, V, I, Acc>(d_y, d_x, d_A, d_index, plan);
+    }
+};
+
+/** @brief Matrix-matrix multiply entry point for spmvDispatch() */
+template <class T, class V, class I, class Acc>
+struct SpmmMultiply
+{
+    static void run(T *d_Y, const T *d_X, size_t numVectors, const V *d_A,
+                    const I *d_index, const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+    {
+        sparseMatrixMatrixMultiply<T, V, I, Acc>(d_Y, d_X, (unsigned int)numVectors, 
+                                            d_A, d_index, plan);
+    }
+};
+
+/** @brief Select the column index type: 16-bit if the plan compressed them */
+template <template <class, class, class, class> class Op, class T, class V, class Acc>
+void spmvDispatchIndex(void *d_y, const void *d_x, size_t numVectors,
+                       const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    if (plan->m_d_indexDelta)
+        Op<T, V, unsigned short, Acc>::run((T*)d_y, (const T*)d_x, numVectors, 
+                                           (const V*)plan->m_d_A, plan->m_d_indexDelta, plan);
+    else
+        Op<T, V, unsigned int, Acc>::run((T*)d_y, (const T*)d_x, numVectors, 
+                                         (const V*)plan->m_d_A, plan->m_d_index, plan);
+}
+
+/** @brief Select the value storage type of a floating-point matrix */
+template <template <class, class, class, class> class Op, class T, class Acc>
+void spmvDispatchValues(void *d_y, const void *d_x, size_t numVectors,
+                        const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    if (plan->m_config.options & CUDPP_OPTION_SPMV_HALF_VALUES)
+        spmvDispatchIndex<Op, T, spmvHalf, Acc>(d_y, d_x, numVectors, plan);
+    else if (plan->m_config.options & CUDPP_OPTION_SPMV_BFLOAT16_VALUES)
+        spmvDispatchIndex<Op, T, spmvBfloat16, Acc>(d_y, d_x, numVectors, plan);
+    else
+        spmvDispatchIndex<Op, T, T, Acc>(d_y, d_x, numVectors, plan);
+}
+
+/** @brief Run \a Op with the datatype, value storage, index and accumulation
+  * type of the plan */
+template <template <class, class, class, class> class Op>
+void spmvDispatch(void *d_y, const void *d_x, size_t numVectors,
+                  const CUDPPSparseMatrixVectorMultiplyPlan *plan)
+{
+    switch(plan->m_config.datatype)
+    {
+    case CUDPP_INT:
+        spmvDispatchIndex<Op, int, int, int>(d_y, d_x, numVectors, plan);
+        break;
+    case CUDPP_UINT:
+        spmvDispatchIndex<Op, unsigned int, unsigned int, unsigned int>(d_y, d_x, numVectors, plan);
+        break;
+    case CUDPP_FLOAT:
+        if (plan->m_config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+            spmvDispatchValues<Op, float, double>(d_y, d_x, numVectors, plan);
+        else
+            spmvDispatchValues<Op, float, float>(d_y, d_x, numVectors, plan);
+        break;
+    case CUDPP_DOUBLE:
+        spmvDispatchValues<Op, double, double>(d_y, d_x, numVectors, plan);
+        break;
+    default:
+        break;
+    }
+}
+
+/** @brief Round a double to the nearest value of a 16-bit IEEE-style
+  * format (ties to even), working on the bits of the double so that it
+  * is rounded only once
+  *
+  * @param[in] d The value
+  * @param[in] exponentBits Exponent bits of the format (5 for half, 8 for bfloat16)
+  * @param[in] mantissaBits Stored mantissa bits of the format (10 for half, 7 for bfloat16)
+  * @returns The bits of the rounded value
+  */
+static unsigned short spmvRoundTo16Bits(double d, int exponentBits, int mantissaBits)
+{
+    unsigned long long x;
+    memcpy(&x, &d, sizeof(x));
+
+    const int maxExponent = (1 << exponentBits) - 1;
+    const unsigned int sign = (unsigned int)(x >> 63) << (exponentBits + mantissaBits);
+    const unsigned int infinity = (unsigned int)maxExponent << mantissaBits;
+    const int biasedExponent = (int)((x >> 52) & 0x7ff);
+    unsigned long long mantissa = x & 0xfffffffffffffULL;
+
+    if (biasedExponent == 0x7ff)        // infinity or NaN
+        return (unsigned short)(sign | infinity | (mantissa ? 1u << (mantissaBits - 1) : 0));
+    if (biasedExponent == 0)            // zero or double subnormal: too small for 16 bits
+        return (unsigned short)sign;
+
+    int exponent = biasedExponent - 1023 + (maxExponent >> 1);
+    int shift = 52 - mantissaBits;
+    unsigned long long h;
+
+    if (exponent >= maxExponent)        // overflow
+        return (unsigned short)(sign | infinity);
+    if (exponent <= 0)                  // subnormal or zero
+    {
+        if (exponent < -mantissaBits)
+            return (unsigned short)sign;
+        mantissa |= 1ULL << 52;
+        shift += 1 - exponent;
+        h = mantissa >> shift;
+    }
     else
-        sparseMatrixVectorFetchAndMultiply<T, false><<<gridElts, threads>>>
-            (plan->m_d_flags, (T*)plan->m_d_prod, (T*)plan->m_d_A, d_x, plan->m_d_index, (unsigned)plan->m_numNonZeroElements);
+        h = ((unsigned long long)exponent << mantissaBits) | (mantissa >> shift);
+
+    // rounding may carry into the exponent, which is still correct
+    unsigned long long rem = mantissa & ((1ULL << shift) - 1);
+    unsigned long long halfway = 1ULL << (shift - 1);
+    if (rem > halfway || (rem == halfway && (h & 1)))
+        ++h;
+    return (unsigned short)(sign | h);
+}
+
+/** @brief Convert the matrix values to 16-bit storage on the host
+  *
+  * @param[out] h_values The 16-bit values
+  * @param[in] A The values in the plan datatype (float or double)
+  * @param[in] numNonZeroElements The number of values
+  * @param[in] config The plan configuration, selecting half or bfloat16
+  */
+template <class T>
+void spmvCompressValues(unsigned short *h_values, const T *A, size_t numNonZeroElements,
+                        const CUDPPConfiguration &config)
+{
+    bool half = (config.options & CUDPP_OPTION_SPMV_HALF_VALUES) != 0;
+    int exponentBits = half ? 5 : 8;
+    int mantissaBits = half ? 10 : 7;
+    for (size_t i = 0; i < numNonZeroElements; ++i)
+        h_values[i] = spmvRoundTo16Bits((double)A[i], exponentBits, mantissaBits);
+}
+
+/** @brief Split the long rows of a skewed matrix into pieces for SpMM
+  *
+  * Rows longer than ::SPMM_ROW_PIECE_LENGTH are cut into pieces of that
+  * many nonzeros (the last may be shorter).  The pieces, the rows they
+  * belong to and a carry array of ::SPMM_CARRY_VECTORS partial products
+  * per piece are allocated on the device.  Nothing is allocated if no row
+  * is that long.
+  *
+  * @param[in,out] plan The sparse matrix plan
+  * @param[in] rowindx The indices of elements in A which are the first element of their row
+  * @param[in] carrySize The size of the accumulation type
+  */
+static void allocSparseMatrixRowPieces(CUDPPSparseMatrixVectorMultiplyPlan *plan,
+                                       const unsigned int                  *rowindx,
+                                       size_t                              carrySize)
+{
+    std::vector<unsigned int> longRow, longRowPieces, pieceStart, pieceEnd;
 
-    unsigned int numRowBlocks = 
-        max(1, (int)ceil((double)plan->m_numRows / 
-                         ((double)SEGSCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE)));
+    for (size_t row = 0; row < plan->m_numRows; ++row)
+    {
+        unsigned int start = rowindx[row];
+        unsigned int end = plan->m_rowFinalIndex[row];
+        if (end - start <= SPMM_ROW_PIECE_LENGTH)
+            continue;
+
+        longRow.push_back((unsigned int)row);
+        longRowPieces.push_back((unsigned int)pieceStart.size());
+        for (unsigned int j = start; j < end; j += SPMM_ROW_PIECE_LENGTH)
+        {
+            pieceStart.push_back(j);
+            pieceEnd.push_back(std::min(j + SPMM_ROW_PIECE_LENGTH, end));
+        }
+    }
 
-    dim3  gridRows(max(1, numRowBlocks), 1, 1);
+    if (longRow.empty())
+        return;
 
-    sparseMatrixVectorSetFlags<<<gridRows, threads>>>
-        (plan->m_d_flags, plan->m_d_rowIndex, (unsigned)plan->m_numRows);
+    longRowPieces.push_back((unsigned int)pieceStart.size());
+    plan->m_numLongRows = (unsigned int)longRow.size();
+    plan->m_numRowPieces = (unsigned int)pieceStart.size();
 
-    cudppSegmentedScanDispatch ((T*)plan->m_d_prod, 
-                                (const T*)plan->m_d_prod,
-                                plan->m_d_flags,
-                                (unsigned)plan->m_numNonZeroElements, plan->m_segmentedScanPlan);
+    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_longRow),
+                              longRow.size() * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_longRowPieces),
+                              longRowPieces.size() * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_pieceStart),
+                              pieceStart.size() * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_pieceEnd),
+                              pieceEnd.size() * sizeof(unsigned int)));
+    CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_pieceCarry),
+                              pieceStart.size() * SPMM_CARRY_VECTORS * carrySize));
 
-    yGather<<<gridRows, threads>>>
-        (d_y, (T*)plan->m_d_prod, plan->m_d_rowFinalIndex, (unsigned)plan->m_numRows); 
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_longRow, &longRow[0],
+                              longRow.size() * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_longRowPieces, &longRowPieces[0],
+                              longRowPieces.size() * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_pieceStart, &pieceStart[0],
+                              pieceStart.size() * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
+    CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_pieceEnd, &pieceEnd[0],
+                              pieceEnd.size() * sizeof(unsigned int),
+                              cudaMemcpyHostToDevice));
 }
 
 #ifdef __cplusplus
@@ -118,9 +432,18 @@ extern "C"
 #endif
 
 // file scope
-/** @brief Allocate intermediate product, flags and rowFindx (index of the last
-  *        element of each row) array .
+/** @brief Allocate the device copy of the matrix and the merge-path carries.
   *  
+  * Copies the matrix values, column indices and row start and end indices
+  * to the device.  With ::CUDPP_OPTION_SPMV_HALF_VALUES or
+  * ::CUDPP_OPTION_SPMV_BFLOAT16_VALUES the values are rounded to 16 bits
+  * first.  With ::CUDPP_OPTION_SPMV_16BIT_INDICES each block of
+  * ::SPMV_INDEX_BLOCK_SIZE nonzeros stores its smallest column as a 32-bit
+  * base and the columns as 16-bit offsets from it; if the columns of some
+  * block span more than 65535 the 32-bit indices are kept.  For the
+  * ::CUDPP_SPMV_MERGE_PATH strategy the per-tile carry arrays and the
+  * pieces of long rows used by SpMM are also allocated.
+  *
   * @param[in] plan Pointer to CUDPPSparseMatrixVectorMultiplyPlan class containing sparse 
   *             matrix-vector multiply options, number of non-zero elements and number 
   *             of rows which is used to compute storage requirements
@@ -133,44 +456,101 @@ void allocSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan
                                             const unsigned int *rowindx, 
                                             const unsigned int *indx)
 {
-    
-    switch(plan->m_config.datatype)
+    const size_t numNonZeroElements = plan->m_numNonZeroElements;
+    const CUDPPConfiguration &config = plan->m_config;
+
+    size_t elementSize = 0;
+    switch(config.datatype)
     {
     case CUDPP_INT:
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_prod),  
-                                  plan->m_numNonZeroElements * sizeof(int)));
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A),  
-                                  plan->m_numNonZeroElements * sizeof(int)));
-        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, (int *)A, 
-                                  plan->m_numNonZeroElements * sizeof(int),
-                                  cudaMemcpyHostToDevice) );
+        elementSize = sizeof(int);
         break;
     case CUDPP_UINT:
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_prod),  
-                                  plan->m_numNonZeroElements * sizeof(unsigned int)));
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A),  
-                                  plan->m_numNonZeroElements * sizeof(unsigned int)));
-        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, (unsigned int *)A, 
-                                  plan->m_numNonZeroElements * sizeof(unsigned int),
-                                  cudaMemcpyHostToDevice) );
+        elementSize = sizeof(unsigned int);
         break;
     case CUDPP_FLOAT:
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_prod),  
-                                  plan->m_numNonZeroElements * sizeof(float)));
-        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A),  
-                                  plan->m_numNonZeroElements * sizeof(float)));
-        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, (float *)A, 
-                                  plan->m_numNonZeroElements * sizeof(float),
-                                  cudaMemcpyHostToDevice) );
+        elementSize = sizeof(float);
+        break;
+    case CUDPP_DOUBLE:
+        elementSize = sizeof(double);
         break;
     default:
         break;
     }
 
-    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_flags),  
-                              plan->m_numNonZeroElements * sizeof(unsigned int)));
-    CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_index),  
-                              plan->m_numNonZeroElements * sizeof(unsigned int)));
+    if (config.options & (CUDPP_OPTION_SPMV_HALF_VALUES | CUDPP_OPTION_SPMV_BFLOAT16_VALUES))
+    {
+        unsigned short *h_values = new unsigned short[numNonZeroElements];
+        if (config.datatype == CUDPP_DOUBLE)
+            spmvCompressValues(h_values, (const double*)A, numNonZeroElements, config);
+        else
+            spmvCompressValues(h_values, (const float*)A, numNonZeroElements, config);
+
+        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A), 
+                                  numNonZeroElements * sizeof(unsigned short)));
+        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, h_values, 
+                                  numNonZeroElements * sizeof(unsigned short),
+                                  cudaMemcpyHostToDevice) );
+        delete [] h_values;
+    }
+    else
+    {
+        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_A),  
+                                  numNonZeroElements * elementSize));
+        CUDA_SAFE_CALL(cudaMemcpy(plan->m_d_A, A, 
+                                  numNonZeroElements * elementSize,
+                                  cudaMemcpyHostToDevice) );
+    }
+
+    bool compressIndices = (config.options & CUDPP_OPTION_SPMV_16BIT_INDICES) != 0;
+    size_t numIndexBlocks = (numNonZeroElements + SPMV_INDEX_BLOCK_SIZE - 1) / SPMV_INDEX_BLOCK_SIZE;
+    unsigned int *h_indexBase = 0;
+
+    if (compressIndices)
+    {
+        h_indexBase = new unsigned int[numIndexBlocks];
+        for (size_t b = 0; b < numIndexBlocks && compressIndices; ++b)
+        {
+            size_t end = std::min((b + 1) * SPMV_INDEX_BLOCK_SIZE, numNonZeroElements);
+            unsigned int lo = indx[b * SPMV_INDEX_BLOCK_SIZE], hi = lo;
+            for (size_t j = b * SPMV_INDEX_BLOCK_SIZE; j < end; ++j)
+            {
+                lo = std::min(lo, indx[j]);
+                hi = std::max(hi, indx[j]);
+            }
+            h_indexBase[b] = lo;
+            compressIndices = (hi - lo <= 0xffff);
+        }
+    }
+
+    if (compressIndices)
+    {
+        unsigned short *h_delta = new unsigned short[numNonZeroElements];
+        for (size_t j = 0; j < numNonZeroElements; ++j)
+            h_delta[j] = (unsigned short)(indx[j] - h_indexBase[j / SPMV_INDEX_BLOCK_SIZE]);
+
+        CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_indexDelta),  
+                                  numNonZeroElements * sizeof(unsigned short)));
+        CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_indexBase),  
+                                  numIndexBlocks * sizeof(unsigned int)));
+        CUDA_SAFE_CALL( cudaMemcpy(plan->m_d_indexDelta, h_delta, 
+                                   numNonZeroElements * sizeof(unsigned short),
+                                   cudaMemcpyHostToDevice) );
+        CUDA_SAFE_CALL( cudaMemcpy(plan->m_d_indexBase, h_indexBase, 
+                                   numIndexBlocks * sizeof(unsigned int),
+                                   cudaMemcpyHostToDevice) );
+        delete [] h_delta;
+    }
+    else
+    {
+        CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_index),  
+                                  numNonZeroElements * sizeof(unsigned int)));
+        CUDA_SAFE_CALL( cudaMemcpy(plan->m_d_index, indx, 
+                                   numNonZeroElements * sizeof(unsigned int),
+                                   cudaMemcpyHostToDevice) );
+    }
+    delete [] h_indexBase;
+
     CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_rowFinalIndex),  
                               plan->m_numRows * sizeof(unsigned int)));
     CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_rowIndex),  
@@ -182,16 +562,25 @@ void allocSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan
     CUDA_SAFE_CALL( cudaMemcpy(plan->m_d_rowIndex, rowindx, 
                                plan->m_numRows * sizeof(unsigned int),
                                cudaMemcpyHostToDevice) );
-    CUDA_SAFE_CALL( cudaMemcpy(plan->m_d_index, indx, 
-                               plan->m_numNonZeroElements * sizeof(unsigned int),
-                               cudaMemcpyHostToDevice) );
 
+    if (plan->m_strategy == CUDPP_SPMV_MERGE_PATH)
+    {
+        // carries are kept in the accumulation type
+        size_t carrySize = elementSize;
+        if (config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+            carrySize = sizeof(double);
+        CUDA_SAFE_CALL(cudaMalloc(&(plan->m_d_carryValue),
+                                  2 * plan->m_numTiles * carrySize));
+        CUDA_SAFE_CALL(cudaMalloc((void **)&(plan->m_d_carryRow),
+                                  2 * plan->m_numTiles * sizeof(unsigned int)));
+
+        allocSparseMatrixRowPieces(plan, rowindx, carrySize);
+    }
 
     CUDA_CHECK_ERROR("allocSparseMatrixVectorMultiplyStorage");
 }
 
-/** @brief Deallocate intermediate product, flags and rowFindx (index of the last
-  *        element of each row) array .
+/** @brief Deallocate the device copy of the matrix and the merge-path carries.
   *
   * These arrays must have been allocated by allocSparseMatrixVectorMultiplyStorage(), which is called
   * by the constructor of CUDPPSparseMatrixVectorMultiplyPlan.  
@@ -202,19 +591,35 @@ void freeSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan *
 {
     CUDA_CHECK_ERROR("freeSparseMatrixVectorMultiply");
 
-    cudaFree(plan->m_d_prod);
     cudaFree(plan->m_d_A);
-    cudaFree((void*)plan->m_d_flags);
     cudaFree((void*)plan->m_d_index);
+    cudaFree((void*)plan->m_d_indexDelta);
+    cudaFree((void*)plan->m_d_indexBase);
     cudaFree((void*)plan->m_d_rowFinalIndex);
     cudaFree((void*)plan->m_d_rowIndex);
+    cudaFree(plan->m_d_carryValue);
+    cudaFree((void*)plan->m_d_carryRow);
+    cudaFree((void*)plan->m_d_longRow);
+    cudaFree((void*)plan->m_d_longRowPieces);
+    cudaFree((void*)plan->m_d_pieceStart);
+    cudaFree((void*)plan->m_d_pieceEnd);
+    cudaFree(plan->m_d_pieceCarry);
 
-    plan->m_d_prod = 0;
     plan->m_d_A = 0;
-    plan->m_d_flags = 0;
     plan->m_d_index = 0;
+    plan->m_d_indexDelta = 0;
+    plan->m_d_indexBase = 0;
     plan->m_d_rowFinalIndex = 0;
     plan->m_d_rowIndex = 0;
+    plan->m_d_carryValue = 0;
+    plan->m_d_carryRow = 0;
+    plan->m_d_longRow = 0;
+    plan->m_d_longRowPieces = 0;
+    plan->m_d_pieceStart = 0;
+    plan->m_d_pieceEnd = 0;
+    plan->m_d_pieceCarry = 0;
+    plan->m_numLongRows = 0;
+    plan->m_numRowPieces = 0;
     plan->m_numNonZeroElements = 0;
     plan->m_numRows = 0;
 }
@@ -225,8 +630,8 @@ void freeSparseMatrixVectorMultiplyStorage(CUDPPSparseMatrixVectorMultiplyPlan *
   * This is the dispatch routine which calls sparseMatrixVectorMultiply() with 
   * appropriate template parameters and arguments
   * 
-  * @param[out] d_y The output vector for y = A*x
-  * @param[in]  d_x The x vector for y = A*x
+  * @param[in,out] d_y The output vector for y += A*x
+  * @param[in]  d_x The x vector for y += A*x
   * @param[in]  plan The sparse matrix plan and data
   */
 void cudppSparseMatrixVectorMultiplyDispatch (
@@ -235,21 +640,28 @@ void cudppSparseMatrixVectorMultiplyDispatch (
                                               const CUDPPSparseMatrixVectorMultiplyPlan *plan
                                              )                            
 {    
-    switch(plan->m_config.datatype)
-    {
-        case CUDPP_INT:
-            sparseMatrixVectorMultiply<int>((int *)d_y, (int *)d_x, plan);
-            break;
-        case CUDPP_UINT:
-            sparseMatrixVectorMultiply<unsigned int>((unsigned int *)d_y, (unsigned int *)d_x, 
-                                                      plan);
-                break;
-        case CUDPP_FLOAT:
-            sparseMatrixVectorMultiply<float>((float *)d_y, (float *)d_x, plan);
-                break;
-        default:
-            break;
-    }
+    spmvDispatch<SpmvMultiply>(d_y, d_x, 1, plan);
+}
+
+/** @brief Dispatch function to perform a sparse matrix-dense matrix multiply
+  * with the specified configuration.
+  *
+  * This is the dispatch routine which calls sparseMatrixMatrixMultiply() with 
+  * appropriate template parameters and arguments
+  * 
+  * @param[in,out] d_Y The output matrix for Y += A*X
+  * @param[in]  d_X The X matrix for Y += A*X
+  * @param[in]  numVectors The number of columns of X and Y
+  * @param[in]  plan The sparse matrix plan and data
+  */
+void cudppSparseMatrixMatrixMultiplyDispatch (
+                                              void                                      *d_Y,
+                                              const void                                *d_X,
+                                              size_t                                    numVectors,
+                                              const CUDPPSparseMatrixVectorMultiplyPlan *plan
+                                             )
+{
+    spmvDispatch<SpmmMultiply>(d_Y, d_X, numVectors, plan);
 }
 
 #ifdef __cplusplus
@@ -27,6 +27,7 @@
 #include "cudpp.h"
 #include "cudpp_util.h"
 #include "cudpp_stringsort.h"
+#include "cudpp_manager.h"
 #include "kernel/stringsort_kernel.cuh"
 #include "kernel/mergesort_kernel.cuh" //for simpleCopy
 #include "limits.h"
@@ -55,10 +56,12 @@ void runStringSort(unsigned int *pkeys,
 {
 
 	//printf("start\n");
-	int numPartitions = (numElements+BLOCKSORT_SIZE-1)/BLOCKSORT_SIZE;
-	int numBlocks = numPartitions/2;
-	int partitionSize = BLOCKSORT_SIZE;
-	int subPartitions = 4;
+	// counts and offsets are computed in size_t on the host; the kernels
+	// index with int, which cudppPlan() guarantees is sufficient
+	size_t numPartitions = (numElements+BLOCKSORT_SIZE-1)/BLOCKSORT_SIZE;
+	size_t numBlocks = numPartitions/2;
+	size_t partitionSize = BLOCKSORT_SIZE;
+	size_t subPartitions = 4;
 
 
 	unsigned int* temp_keys;
@@ -82,14 +85,14 @@ void runStringSort(unsigned int *pkeys,
 	blockWiseStringSort<unsigned int, DEPTH>
 		<<<numPartitions, BLOCKSORT_SIZE/DEPTH, 2*(BLOCKSORT_SIZE)*sizeof(unsigned int)>>>(pkeys, pvals, stringVals, BLOCKSORT_SIZE, numElements, stringArrayLength);
 
-	int mult = 1; int count = 0;
+	size_t mult = 1; int count = 0;
 
-	CUDA_SAFE_CALL(cudaThreadSynchronize());
+	CUDA_CHECK_ERROR("blockWiseStringSort");
 	//we run p stages of simpleMerge until numBlocks <= some Critical level
 	while(numPartitions > 32 || (partitionSize*mult < 16384 && numPartitions > 1))
 	{	
 		//printf("Running simple merge for %d partitions of size %d\n", numPartitions, partitionSize*mult);
-		numBlocks = (numPartitions&0xFFFE);	    
+		numBlocks = (numPartitions & ~(size_t)1);	    
 		if(count%2 == 0)
 		{ 				
 			simpleStringMerge<unsigned int, 2>
@@ -99,8 +102,8 @@ void runStringSort(unsigned int *pkeys,
 			if(numPartitions%2 == 1)
 			{			
 
-				int offset = (partitionSize*mult*(numPartitions-1));
-				int numElementsToCopy = numElements-offset;												
+				size_t offset = (partitionSize*mult*(numPartitions-1));
+				size_t numElementsToCopy = numElements-offset;												
 				simpleCopy<unsigned int>
 					<<<(numElementsToCopy+numThreads-1)/numThreads, numThreads>>>(pkeys, pvals, temp_keys, temp_vals, offset, numElementsToCopy);
 			}
@@ -113,8 +116,8 @@ void runStringSort(unsigned int *pkeys,
 			
 			if(numPartitions%2 == 1)
 			{			
-				int offset = (partitionSize*mult*(numPartitions-1));
-				int numElementsToCopy = numElements-offset;						
+				size_t offset = (partitionSize*mult*(numPartitions-1));
+				size_t numElementsToCopy = numElements-offset;						
 				simpleCopy<unsigned int>
 					<<<(numElementsToCopy+numThreads-1)/numThreads, numThreads>>>(temp_keys, temp_vals, pkeys, pvals, offset, numElementsToCopy);
 			}
@@ -133,8 +136,8 @@ void runStringSort(unsigned int *pkeys,
 	while (numPartitions > 1)
 	{		
 		//printf("Running multi merge for %d partitions of size %d\n", numPartitions, partitionSize*mult);
-		numBlocks = (numPartitions&0xFFFE);	 
-		int secondBlocks = ((numBlocks)*subPartitions+numThreads-1)/numThreads;			
+		numBlocks = (numPartitions & ~(size_t)1);	 
+		size_t secondBlocks = ((numBlocks)*subPartitions+numThreads-1)/numThreads;			
 		if(count%2 == 1)
 		{								
 			findMultiPartitions<unsigned int>
@@ -143,15 +146,15 @@ void runStringSort(unsigned int *pkeys,
 			
 
 			//int lastSubPart = getLastSubPart(numBlocks, subPartitions, partitionSize, mult, numElements);
-			CUDA_SAFE_CALL(cudaThreadSynchronize());
+			CUDA_CHECK_ERROR("findMultiPartitions");
 			stringMergeMulti<unsigned int, DEPTH_multi>
 				<<<numBlocks*subPartitions, CTASIZE_multi, (2*INTERSECT_B_BLOCK_SIZE_multi+4)*sizeof(unsigned int)>>>(temp_keys, pkeys, temp_vals, 
 				pvals, stringVals, subPartitions, numBlocks, partitionBeginA, partitionSizeA, partitionBeginB, partitionSizeB, mult*partitionSize, count, numElements, stringArrayLength);
-			CUDA_SAFE_CALL(cudaThreadSynchronize());
+			CUDA_CHECK_ERROR("stringMergeMulti");
 			if(numPartitions%2 == 1)
 			{			
-				int offset = (partitionSize*mult*(numPartitions-1));
-				int numElementsToCopy = numElements-offset;				
+				size_t offset = (partitionSize*mult*(numPartitions-1));
+				size_t numElementsToCopy = numElements-offset;				
 				simpleCopy<unsigned int>
 					<<<(numElementsToCopy+numThreads-1)/numThreads, numThreads>>>(temp_keys, temp_vals, pkeys, pvals, offset, numElementsToCopy);
 			}
@@ -163,17 +166,17 @@ void runStringSort(unsigned int *pkeys,
 			findMultiPartitions<unsigned int>
 				<<<secondBlocks, numThreads>>>(pkeys, pvals, stringVals, subPartitions, numBlocks, partitionSize*mult, partitionBeginA, partitionSizeA, 
 				partitionBeginB, partitionSizeB, numElements, stringArrayLength);											
-			CUDA_SAFE_CALL(cudaThreadSynchronize());
+			CUDA_CHECK_ERROR("findMultiPartitions");
 			//int lastSubPart = getLastSubPart(numBlocks, subPartitions, partitionSize, mult, numElements);
 			stringMergeMulti<unsigned int, DEPTH_multi>
 				<<<numBlocks*subPartitions, CTASIZE_multi, (2*INTERSECT_B_BLOCK_SIZE_multi+4)*sizeof(unsigned int)>>>(pkeys, temp_keys, pvals, 
 				temp_vals, stringVals, subPartitions, numBlocks, partitionBeginA, partitionSizeA, partitionBeginB, partitionSizeB, mult*partitionSize, count, numElements, stringArrayLength);
 
-			CUDA_SAFE_CALL(cudaThreadSynchronize());
+			CUDA_CHECK_ERROR("stringMergeMulti");
 			if(numPartitions%2 == 1)
 			{			
-				int offset = (partitionSize*mult*(numPartitions-1));
-				int numElementsToCopy = numElements-offset;				
+				size_t offset = (partitionSize*mult*(numPartitions-1));
+				size_t numElementsToCopy = numElements-offset;				
 				simpleCopy<unsigned int>
 					<<<(numElementsToCopy+numThreads-1)/numThreads, numThreads>>>(pkeys, pvals, temp_keys, temp_vals, offset, numElementsToCopy);
 			}
@@ -187,6 +190,8 @@ void runStringSort(unsigned int *pkeys,
 		numPartitions = (numPartitions+1)/2;				
 	}	
 
+	plan->m_planManager->addIterations(count);
+
 	if(count%2==1)
 	{
 		CUDA_SAFE_CALL(cudaMemcpy(pkeys, temp_keys, numElements*sizeof(unsigned int), cudaMemcpyDeviceToDevice));
@@ -31,6 +31,13 @@
 #include <cstdlib>
 #include <cstdio>
 #include <assert.h>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "kernel/tridiagonal_kernel.cuh"
 
@@ -42,6 +49,27 @@ inline unsigned int crpcrSharedSize(unsigned int systemSizeOriginal)
     return (systemSize + 1 + restSystemSize) * 5 * sizeof(T);
 }
 
+template <typename T>
+inline size_t crThomasSharedSize(unsigned int systemSize)
+{
+    return (size_t)systemSize * 4 * sizeof(T);
+}
+
+/**
+ * @brief Returns a grid of at least \a numBlocks CTAs
+ *
+ * Grids are limited to 65535 CTAs in each dimension, so large batches
+ * use a 2D grid; kernels linearize the block index and skip the excess.
+ *
+ * @param[in] numBlocks The number of CTAs needed
+ */
+inline dim3 tridiagonalGrid(size_t numBlocks)
+{
+    if (numBlocks <= 65535)
+        return dim3((unsigned int)numBlocks, 1, 1);
+    return dim3(65535, (unsigned int)((numBlocks + 65534) / 65535), 1);
+}
+
 /**
  * @brief Hybrid CR-PCR solver (CRPCR)
  *
@@ -70,7 +98,7 @@ void crpcr(T *d_a,
     const unsigned int iterations = logBase2Pow2(restSystemSize/2);
   
     // setup execution parameters
-    dim3  grid(numSystems, 1, 1);
+    dim3  grid = tridiagonalGrid(numSystems);
     dim3  threads(num_threads_block, 1, 1);
     const unsigned int smemSize = crpcrSharedSize<T>(systemSizeOriginal);
 
@@ -80,11 +108,607 @@ void crpcr(T *d_a,
                                               d_d, 
                                               d_x, 
                                               systemSizeOriginal,
-                                              iterations);
+                                              iterations,
+                                              numSystems);
 
     CUDA_CHECK_ERROR("crpcr");
 }
 
+/**
+ * @brief Interleaved Thomas solver for small systems
+ *
+ * Launches thomasInterleavedKernel with as many systems per CTA as fit in
+ * shared memory (at most ::TRIDIAGONAL_THOMAS_CTA_SIZE, rounded down to a
+ * whole number of warps when possible).
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] prop Properties of the current device
+ */
+template <typename T>
+void thomasInterleaved(T *d_a,
+                       T *d_b,
+                       T *d_c,
+                       T *d_d,
+                       T *d_x,
+                       unsigned int systemSize,
+                       unsigned int numSystems,
+                       const cudaDeviceProp &prop)
+{
+    unsigned int systemsPerBlock = 
+        prop.sharedMemPerBlock / (4 * systemSize * sizeof(T));
+    systemsPerBlock = std::min(systemsPerBlock, 
+                               (unsigned int)TRIDIAGONAL_THOMAS_CTA_SIZE);
+    if (systemsPerBlock >= WARP_SIZE)
+        systemsPerBlock -= systemsPerBlock % WARP_SIZE;
+
+    const unsigned int numBlocks = 
+        (numSystems + systemsPerBlock - 1) / systemsPerBlock;
+    const size_t smemSize = 4 * systemSize * systemsPerBlock * sizeof(T);
+
+    thomasInterleavedKernel<<< tridiagonalGrid(numBlocks), systemsPerBlock, 
+                               smemSize >>>(d_a, d_b, d_c, d_d, d_x,
+                                            systemSize, numSystems,
+                                            systemsPerBlock);
+
+    CUDA_CHECK_ERROR("thomasInterleaved");
+}
+
+/**
+ * @brief CR-Thomas solver for systems that fit in shared memory
+ *
+ * This is a wrapper function for crThomasKernel, which solves one system
+ * of any size per CTA.
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ */
+template <typename T>
+void crThomas(T *d_a,
+              T *d_b,
+              T *d_c,
+              T *d_d,
+              T *d_x,
+              unsigned int systemSize,
+              unsigned int numSystems)
+{
+    unsigned int numThreads = std::min((systemSize / 2 + WARP_SIZE - 1) & ~(WARP_SIZE - 1),
+                                       (unsigned int)TRIDIAGONAL_CR_CTA_SIZE);
+
+    crThomasKernel<<< tridiagonalGrid(numSystems), numThreads, 
+                      crThomasSharedSize<T>(systemSize) >>>
+        (d_a, d_b, d_c, d_d, d_x, systemSize, numSystems);
+
+    CUDA_CHECK_ERROR("crThomas");
+}
+
+template <typename T>
+CUDPPResult tridiagonalSolve(T *d_a, T *d_b, T *d_c, T *d_d, T *d_x,
+                             unsigned int systemSize, unsigned int numSystems,
+                             const cudaDeviceProp &prop);
+
+/**
+ * @brief Partitioned (SPIKE-style) solver for large systems
+ *
+ * Systems too large for shared memory are split into partitions of
+ * ::TRIDIAGONAL_PARTITION_SIZE equations, one thread per partition.  The
+ * last equation of each partition is an interface unknown; the spikes of
+ * each partition reduce the problem to a tridiagonal system in the
+ * interface unknowns, which is solved recursively with tridiagonalSolve().
+ * The interior of each partition is then solved independently.  A
+ * partition never holds a single equation, so the last partition may be
+ * one equation longer than the others.
+ *
+ * Scratch storage is allocated for the duration of the call.
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] prop Properties of the current device
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult partitionedSolve(T *d_a,
+                             T *d_b,
+                             T *d_c,
+                             T *d_d,
+                             T *d_x,
+                             unsigned int systemSize,
+                             unsigned int numSystems,
+                             const cudaDeviceProp &prop)
+{
+    const unsigned int numPartitions = 
+        (systemSize - 2) / TRIDIAGONAL_PARTITION_SIZE + 1;
+    const size_t numInterfaces = (size_t)numSystems * numPartitions;
+
+    // 6 spike arrays, the reduced system (4 arrays) and its solution, and
+    // the modified upper diagonal of the final interior solve
+    T *d_spikes = 0, *d_scratch = 0;
+    if (cudaMalloc((void**)&d_spikes, 11 * numInterfaces * sizeof(T)) != cudaSuccess)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    if (cudaMalloc((void**)&d_scratch, 
+                   (size_t)systemSize * numSystems * sizeof(T)) != cudaSuccess)
+    {
+        cudaFree(d_spikes);
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+    T *d_ra = d_spikes + 6 * numInterfaces;
+    T *d_rb = d_ra + numInterfaces;
+    T *d_rc = d_rb + numInterfaces;
+    T *d_rd = d_rc + numInterfaces;
+    T *d_u  = d_rd + numInterfaces;
+
+    const unsigned int numThreads = TRIDIAGONAL_PARTITION_CTA_SIZE;
+    dim3 grid = tridiagonalGrid((numInterfaces + numThreads - 1) / numThreads);
+
+    partitionSpikesKernel<<< grid, numThreads >>>
+        (d_a, d_b, d_c, d_d, d_spikes, systemSize, numSystems, numPartitions);
+    CUDA_CHECK_ERROR("partitionSpikes");
+
+    partitionReduceKernel<<< grid, numThreads >>>
+        (d_a, d_b, d_c, d_d, d_spikes, d_ra, d_rb, d_rc, d_rd,
+         systemSize, numSystems, numPartitions);
+    CUDA_CHECK_ERROR("partitionReduce");
+
+    CUDPPResult result = tridiagonalSolve<T>(d_ra, d_rb, d_rc, d_rd, d_u,
+                                             numPartitions, numSystems, prop);
+
+    if (result == CUDPP_SUCCESS)
+    {
+        partitionSolveKernel<<< grid, numThreads >>>
+            (d_a, d_b, d_c, d_d, d_u, d_x, d_scratch,
+             systemSize, numSystems, numPartitions);
+        CUDA_CHECK_ERROR("partitionSolve");
+    }
+
+    cudaFree(d_spikes);
+    cudaFree(d_scratch);
+
+    return result;
+}
+
+/**
+ * @brief Solves a batch of tridiagonal systems, choosing a method by size
+ *
+ * - Systems of up to ::TRIDIAGONAL_THOMAS_MAX_SIZE equations are solved
+ *   with one thread per system (thomasInterleaved()).
+ * - Power-of-two systems that fit the CR-PCR kernel use crpcr().
+ * - Other systems that fit in shared memory use one CTA per system with
+ *   cyclic reduction followed by Thomas (crThomas()).
+ * - Larger systems use the partitioned solver (partitionedSolve()).
+ *
+ * None of the methods pad the systems to a power of two.
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] prop Properties of the current device
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult tridiagonalSolve(T *d_a,
+                             T *d_b,
+                             T *d_c,
+                             T *d_d,
+                             T *d_x,
+                             unsigned int systemSize,
+                             unsigned int numSystems,
+                             const cudaDeviceProp &prop)
+{
+    if (numSystems == 0)
+        return CUDPP_SUCCESS;
+
+    if (systemSize <= TRIDIAGONAL_THOMAS_MAX_SIZE)
+        thomasInterleaved<T>(d_a, d_b, d_c, d_d, d_x, 
+                             systemSize, numSystems, prop);
+    else if (isPowerOfTwo(systemSize) && 
+             systemSize / 2 <= (unsigned int)prop.maxThreadsPerBlock &&
+             crpcrSharedSize<T>(systemSize) <= prop.sharedMemPerBlock)
+        crpcr<T>(d_a, d_b, d_c, d_d, d_x, systemSize, numSystems);
+    else if (crThomasSharedSize<T>(systemSize) <= prop.sharedMemPerBlock)
+        crThomas<T>(d_a, d_b, d_c, d_d, d_x, systemSize, numSystems);
+    else
+        return partitionedSolve<T>(d_a, d_b, d_c, d_d, d_x, 
+                                   systemSize, numSystems, prop);
+
+    return CUDPP_SUCCESS;
+}
+
+
+/**
+ * @brief Periodic (cyclic) tridiagonal solver
+ *
+ * Uses the Sherman-Morrison formula: the periodic system is written as a
+ * non-periodic system with modified first and last diagonal entries plus
+ * a rank-one correction (see periodicSetupKernel()).  The non-periodic
+ * system is solved with tridiagonalSolve() for two right hand sides, and
+ * the two solutions are combined per system.
+ *
+ * Scratch storage is allocated for the duration of the call.
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal; \a d_a[0] couples to the last unknown
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal; \a d_c[n-1] couples to the first unknown
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system (at least 3)
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] prop Properties of the current device
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult periodicSolve(T *d_a,
+                          T *d_b,
+                          T *d_c,
+                          T *d_d,
+                          T *d_x,
+                          unsigned int systemSize,
+                          unsigned int numSystems,
+                          const cudaDeviceProp &prop)
+{
+    if (systemSize < 3)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    if (numSystems == 0)
+        return CUDPP_SUCCESS;
+
+    const size_t numElements = (size_t)systemSize * numSystems;
+
+    // modified diagonal, correction right hand side and its solution
+    T *d_scratch = 0;
+    if (cudaMalloc((void**)&d_scratch, 3 * numElements * sizeof(T)) != cudaSuccess)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    T *d_bMod = d_scratch;
+    T *d_u = d_bMod + numElements;
+    T *d_z = d_u + numElements;
+
+    CUDA_SAFE_CALL(cudaMemcpy(d_bMod, d_b, numElements * sizeof(T),
+                              cudaMemcpyDeviceToDevice));
+    CUDA_SAFE_CALL(cudaMemset(d_u, 0, numElements * sizeof(T)));
+
+    const unsigned int numThreads = TRIDIAGONAL_PARTITION_CTA_SIZE;
+    dim3 systemGrid = tridiagonalGrid((numSystems + numThreads - 1) / numThreads);
+
+    periodicSetupKernel<<< systemGrid, numThreads >>>
+        (d_a, d_b, d_c, d_bMod, d_u, systemSize, numSystems);
+    CUDA_CHECK_ERROR("periodicSetup");
+
+    CUDPPResult result = tridiagonalSolve<T>(d_a, d_bMod, d_c, d_d, d_x,
+                                             systemSize, numSystems, prop);
+    if (result == CUDPP_SUCCESS)
+        result = tridiagonalSolve<T>(d_a, d_bMod, d_c, d_u, d_z,
+                                     systemSize, numSystems, prop);
+
+    if (result == CUDPP_SUCCESS)
+    {
+        // the correction right hand side is no longer needed; reuse it
+        // for the per-system factors
+        T *d_factor = d_u;
+        periodicFactorKernel<<< systemGrid, numThreads >>>
+            (d_a, d_b, d_x, d_z, d_factor, systemSize, numSystems);
+        CUDA_CHECK_ERROR("periodicFactor");
+
+        periodicCorrectKernel<<< tridiagonalGrid((numElements + numThreads - 1) / numThreads), 
+                                 numThreads >>>
+            (d_x, d_z, d_factor, systemSize, numElements);
+        CUDA_CHECK_ERROR("periodicCorrect");
+    }
+
+    cudaFree(d_scratch);
+
+    return result;
+}
+
+/**
+ * @brief Block-tridiagonal solver with M x M blocks
+ *
+ * This is a wrapper function for blockThomasKernel, which solves one
+ * system per thread.  Scratch storage is allocated for the duration of
+ * the call.
+ *
+ * @param[out] d_x Solution vectors
+ * @param[in] d_a Lower diagonal blocks
+ * @param[in] d_b Main diagonal blocks
+ * @param[in] d_c Upper diagonal blocks
+ * @param[in] d_d Right hand side vectors
+ * @param[in] systemSize The number of block rows in each system
+ * @param[in] numSystems The number of systems to be solved
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T, int M>
+CUDPPResult blockTridiagonalSolve(T *d_a,
+                                  T *d_b,
+                                  T *d_c,
+                                  T *d_d,
+                                  T *d_x,
+                                  unsigned int systemSize,
+                                  unsigned int numSystems)
+{
+    if (numSystems == 0)
+        return CUDPP_SUCCESS;
+
+    T *d_scratch = 0;
+    if (cudaMalloc((void**)&d_scratch, 
+                   (size_t)systemSize * numSystems * M * M * sizeof(T)) != cudaSuccess)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    const unsigned int numThreads = TRIDIAGONAL_PARTITION_CTA_SIZE;
+    blockThomasKernel<T, M><<< tridiagonalGrid((numSystems + numThreads - 1) / numThreads),
+                               numThreads >>>
+        (d_a, d_b, d_c, d_d, d_x, d_scratch, systemSize, numSystems);
+    CUDA_CHECK_ERROR("blockThomas");
+
+    cudaFree(d_scratch);
+
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Solves a batch of systems of the variant selected by the plan
+ *
+ * @param[out] d_x Solution vector
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @param[in] prop Properties of the current device
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult tridiagonalSolveVariant(T *d_a,
+                                    T *d_b,
+                                    T *d_c,
+                                    T *d_d,
+                                    T *d_x,
+                                    unsigned int systemSize,
+                                    unsigned int numSystems,
+                                    const CUDPPTridiagonalPlan *plan,
+                                    const cudaDeviceProp &prop)
+{
+    switch (plan->m_blockSize)
+    {
+    case 2:
+        return blockTridiagonalSolve<T, 2>(d_a, d_b, d_c, d_d, d_x, 
+                                           systemSize, numSystems);
+    case 4:
+        return blockTridiagonalSolve<T, 4>(d_a, d_b, d_c, d_d, d_x, 
+                                           systemSize, numSystems);
+    default:
+        break;
+    }
+
+    if (plan->m_periodic)
+        return periodicSolve<T>(d_a, d_b, d_c, d_d, d_x, 
+                                systemSize, numSystems, prop);
+
+    return tridiagonalSolve<T>(d_a, d_b, d_c, d_d, d_x, 
+                               systemSize, numSystems, prop);
+}
+
+/**
+ * @brief Thomas algorithm for a group of interleaved systems on the host
+ *
+ * Equation \a i of lane \a l is at <tt>i * ::TRIDIAGONAL_HOST_LANES + l</tt>,
+ * so each step of the elimination applies the same operations to
+ * ::TRIDIAGONAL_HOST_LANES consecutive values, a loop the compiler
+ * vectorizes.  \a c and \a d are overwritten with the modified upper
+ * diagonal and the solution.  A second right hand side \a u, if not
+ * null, is solved with the same elimination.
+ *
+ * @param[in] a Lower diagonal
+ * @param[in] b Main diagonal
+ * @param[in,out] c Upper diagonal
+ * @param[in,out] d Right hand side, replaced by the solution
+ * @param[in,out] u Second right hand side or null, replaced by its
+ *                solution
+ * @param[in] systemSize The size of each system
+ */
+template <typename T>
+void thomasHostLanes(const T *a, const T *b, T *c, T *d, T *u, unsigned int systemSize)
+{
+    const unsigned int lanes = TRIDIAGONAL_HOST_LANES;
+
+    // the current equation of each lane is computed in local arrays and 
+    // stored afterwards, so that no store can alias a later load and the
+    // lane loops vectorize
+    T cp[TRIDIAGONAL_HOST_LANES], dp[TRIDIAGONAL_HOST_LANES];
+    T up[TRIDIAGONAL_HOST_LANES], inv[TRIDIAGONAL_HOST_LANES];
+
+    for (unsigned int l = 0; l < lanes; l++)
+        cp[l] = dp[l] = up[l] = 0;
+    for (unsigned int i = 0; i < systemSize; i++)
+    {
+        const T *ai = a + i * lanes, *bi = b + i * lanes;
+        T *ci = c + i * lanes, *di = d + i * lanes;
+        for (unsigned int l = 0; l < lanes; l++)
+            inv[l] = 1 / (bi[l] - ai[l] * cp[l]);
+        for (unsigned int l = 0; l < lanes; l++)
+        {
+            dp[l] = (di[l] - ai[l] * dp[l]) * inv[l];
+            cp[l] = ci[l] * inv[l];
+        }
+        for (unsigned int l = 0; l < lanes; l++)
+        {
+            ci[l] = cp[l];
+            di[l] = dp[l];
+        }
+        if (u)
+        {
+            T *ui = u + i * lanes;
+            for (unsigned int l = 0; l < lanes; l++)
+                up[l] = (ui[l] - ai[l] * up[l]) * inv[l];
+            for (unsigned int l = 0; l < lanes; l++)
+                ui[l] = up[l];
+        }
+    }
+    for (unsigned int i = systemSize - 1; i-- > 0; )
+    {
+        const T *ci = c + i * lanes;
+        T *di = d + i * lanes;
+        for (unsigned int l = 0; l < lanes; l++)
+            dp[l] = di[l] - ci[l] * dp[l];
+        for (unsigned int l = 0; l < lanes; l++)
+            di[l] = dp[l];
+        if (u)
+        {
+            T *ui = u + i * lanes;
+            for (unsigned int l = 0; l < lanes; l++)
+                up[l] = ui[l] - ci[l] * up[l];
+            for (unsigned int l = 0; l < lanes; l++)
+                ui[l] = up[l];
+        }
+    }
+}
+
+/**
+ * @brief Solves tridiagonal systems in host memory with the Thomas
+ * algorithm
+ *
+ * Systems are taken in groups of ::TRIDIAGONAL_HOST_LANES, which are
+ * transposed into an interleaved layout and solved together by
+ * thomasHostLanes().  The lanes of the last group that have no system are
+ * filled with the identity.  Periodic systems use the Sherman-Morrison
+ * correction of periodicSolve(), with the two right hand sides solved in
+ * the same elimination.  When the library is built with OpenMP, each
+ * thread solves a contiguous range of groups in its own scratch storage;
+ * a thread is only used for at least ::TRIDIAGONAL_HOST_GRAIN equations.
+ *
+ * @param[out] x Solution vector
+ * @param[in] a Lower diagonal
+ * @param[in] b Main diagonal
+ * @param[in] c Upper diagonal
+ * @param[in] d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] periodic True for periodic systems
+ * @returns CUDPPResult indicating success or error condition
+ */
+template <typename T>
+CUDPPResult tridiagonalHostSolve(const T *a,
+                                 const T *b,
+                                 const T *c,
+                                 const T *d,
+                                 T *x,
+                                 unsigned int systemSize,
+                                 unsigned int numSystems,
+                                 bool periodic)
+{
+    if (periodic && systemSize < 3)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    const unsigned int lanes = TRIDIAGONAL_HOST_LANES;
+    const size_t numGroups = (numSystems + lanes - 1) / lanes;
+    const size_t groupSize = (size_t)systemSize * lanes;
+    const size_t numArrays = periodic ? 5 : 4;
+    if (numGroups == 0)
+        return CUDPP_SUCCESS;
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = (int)std::min(std::min((size_t)omp_get_max_threads(), numGroups),
+                               std::max((size_t)1, numGroups * groupSize / 
+                                                   TRIDIAGONAL_HOST_GRAIN));
+#endif
+
+    std::vector<T> scratch;
+    try
+    {
+        scratch.resize((size_t)numThreads * numArrays * groupSize);
+    }
+    catch (std::bad_alloc &)
+    {
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+    // one range of groups per iteration, whatever the size of the team
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+    for (int chunk = 0; chunk < numThreads; chunk++)
+    {
+        T *ga = &scratch[(size_t)chunk * numArrays * groupSize];
+        T *gb = ga + groupSize, *gc = gb + groupSize, *gd = gc + groupSize;
+        T *gu = periodic ? gd + groupSize : 0;
+        const size_t last = groupSize - lanes;
+        T ratio[TRIDIAGONAL_HOST_LANES];
+
+        const size_t firstGroup = numGroups * chunk / numThreads;
+        const size_t lastGroup = numGroups * (chunk + 1) / numThreads;
+        for (size_t g = firstGroup; g < lastGroup; g++)
+        {
+            for (unsigned int l = 0; l < lanes; l++)
+            {
+                const size_t sys = g * lanes + l;
+                const size_t offset = sys * systemSize;
+                for (unsigned int i = 0; i < systemSize; i++)
+                {
+                    const size_t k = (size_t)i * lanes + l;
+                    ga[k] = (sys < numSystems) ? a[offset + i] : 0;
+                    gb[k] = (sys < numSystems) ? b[offset + i] : 1;
+                    gc[k] = (sys < numSystems) ? c[offset + i] : 0;
+                    gd[k] = (sys < numSystems) ? d[offset + i] : 0;
+                }
+            }
+
+            if (periodic)
+            {
+                // u = (gamma, 0, ..., c[n-1]), v = (1, 0, ..., a[0] / gamma)
+                std::fill(gu, gu + groupSize, T(0));
+                for (unsigned int l = 0; l < lanes; l++)
+                {
+                    const T gamma = (gb[l] != 0) ? -gb[l] : 1;
+                    ratio[l] = ga[l] / gamma;
+                    gb[l] -= gamma;
+                    gb[last + l] -= gc[last + l] * ratio[l];
+                    gu[l] = gamma;
+                    gu[last + l] = gc[last + l];
+                }
+            }
+
+            thomasHostLanes<T>(ga, gb, gc, gd, gu, systemSize);
+
+            if (periodic)
+            {
+                for (unsigned int l = 0; l < lanes; l++)
+                {
+                    const T factor = (gd[l] + ratio[l] * gd[last + l]) /
+                                     (1 + gu[l] + ratio[l] * gu[last + l]);
+                    for (size_t k = l; k < groupSize; k += lanes)
+                        gd[k] -= factor * gu[k];
+                }
+            }
+
+            for (unsigned int l = 0; l < lanes && g * lanes + l < numSystems; l++)
+            {
+                const size_t offset = (g * lanes + l) * systemSize;
+                for (unsigned int i = 0; i < systemSize; i++)
+                    x[offset + i] = gd[(size_t)i * lanes + l];
+            }
+        }
+    }
+
+    return CUDPP_SUCCESS;
+}
 
 /**
  * @brief Dispatches the tridiagonal function based on the plan
@@ -111,47 +735,83 @@ CUDPPResult cudppTridiagonalDispatch(void *d_a,
                                      int numSystems, 
                                      const CUDPPTridiagonalPlan * plan)
 {
+    if (systemSize < 1 || numSystems < 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
     cudaDeviceProp prop;
     plan->m_planManager->getDeviceProps(prop);
 
-    if (ceilPow2(systemSize) > (unsigned)prop.maxThreadsPerBlock)
-        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
-
     //figure out which algorithm to run
     if (plan->m_config.datatype == CUDPP_FLOAT)
     {
-        // check necessary memory
-        if (crpcrSharedSize<float>(systemSize) > prop.sharedMemPerBlock)
-            return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
-
-        crpcr<float>((float *)d_a, 
-                     (float *)d_b, 
-                     (float *)d_c, 
-                     (float *)d_d, 
-                     (float *)d_x, 
-                     systemSize, 
-                     numSystems);
-        return CUDPP_SUCCESS;
+        return tridiagonalSolveVariant<float>((float *)d_a, 
+                                              (float *)d_b, 
+                                              (float *)d_c, 
+                                              (float *)d_d, 
+                                              (float *)d_x, 
+                                              systemSize, 
+                                              numSystems,
+                                              plan,
+                                              prop);
     }
     else if (plan->m_config.datatype == CUDPP_DOUBLE)
     {
-        // check necessary memory
-        if (crpcrSharedSize<double>(systemSize) > prop.sharedMemPerBlock)
-            return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
-
-        crpcr<double>((double *)d_a, 
-                      (double *)d_b, 
-                      (double *)d_c, 
-                      (double *)d_d, 
-                      (double *)d_x, 
-                      systemSize, 
-                      numSystems);
-        return CUDPP_SUCCESS;
+        return tridiagonalSolveVariant<double>((double *)d_a, 
+                                               (double *)d_b, 
+                                               (double *)d_c, 
+                                               (double *)d_d, 
+                                               (double *)d_x, 
+                                               systemSize, 
+                                               numSystems,
+                                               plan,
+                                               prop);
     }
     else
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
     
 }
 
+/**
+ * @brief Dispatches the host tridiagonal solver based on the plan
+ *
+ * Called by ::cudppTridiagonalHost().  Block-tridiagonal plans are not
+ * supported on the host.
+ *
+ * @param[out] x Solution vector
+ * @param[in] a Lower diagonal
+ * @param[in] b Main diagonal
+ * @param[in] c Upper diagonal
+ * @param[in] d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @param[in] plan pointer to CUDPPTridiagonalPlan
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPPResult cudppTridiagonalHostDispatch(const void *a, 
+                                         const void *b, 
+                                         const void *c, 
+                                         const void *d, 
+                                         void *x, 
+                                         int systemSize, 
+                                         int numSystems, 
+                                         const CUDPPTridiagonalPlan * plan)
+{
+    if (systemSize < 1 || numSystems < 0 || plan->m_blockSize > 1)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (plan->m_config.datatype == CUDPP_FLOAT)
+        return tridiagonalHostSolve<float>((const float *)a, (const float *)b, 
+                                           (const float *)c, (const float *)d, 
+                                           (float *)x, systemSize, numSystems,
+                                           plan->m_periodic);
+    else if (plan->m_config.datatype == CUDPP_DOUBLE)
+        return tridiagonalHostSolve<double>((const double *)a, (const double *)b, 
+                                            (const double *)c, (const double *)d, 
+                                            (double *)x, systemSize, numSystems,
+                                            plan->m_periodic);
+    else
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+}
+
 /** @} */ // end Tridiagonal functions
 /** @} */ // end cudpp_app
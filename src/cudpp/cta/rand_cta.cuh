@@ -373,5 +373,76 @@ __device__ void setupInput(unsigned int * input, unsigned int seed)
 
 //-------------------END MD5 FUNCTIONS--------------------------------------
 
+//------------PHILOX FUNCTIONS----------------------------------------------
+
+#define PHILOX_M4x32_0 0xD2511F53U   /**< Philox4x32 multiplier for words 0 and 1 */
+#define PHILOX_M4x32_1 0xCD9E8D57U   /**< Philox4x32 multiplier for words 2 and 3 */
+#define PHILOX_W32_0   0x9E3779B9U   /**< Philox key schedule constant (golden ratio) */
+#define PHILOX_W32_1   0xBB67AE85U   /**< Philox key schedule constant (sqrt(3) - 1) */
+#define PHILOX_ROUNDS  10            /**< Number of Philox4x32 rounds */
+
+/**
+ * @brief The Philox4x32-10 counter-based generator (bijection)
+ *
+ * Maps a 128-bit counter and a 64-bit key to 128 random bits with ten
+ * rounds of the Philox S-P network described in "Parallel Random
+ * Numbers: As Easy as 1, 2, 3" (Salmon et al., SC 2011).  Since the
+ * output depends only on the counter and the key, any position of any
+ * stream can be generated directly, which gives O(1) skip-ahead.  The
+ * output matches the Random123 reference implementation.
+ *
+ * @param[in] ctr The counter
+ * @param[in] key The key (the seed and the stream)
+ * @returns 128 random bits
+ * @see gen_randPhilox()
+ **/
+__device__ uint4 philox4x32(uint4 ctr, uint2 key)
+{
+#pragma unroll
+    for (int r = 0; r < PHILOX_ROUNDS; r++)
+    {
+        unsigned int hi0 = __umulhi(PHILOX_M4x32_0, ctr.x);
+        unsigned int lo0 = PHILOX_M4x32_0 * ctr.x;
+        unsigned int hi1 = __umulhi(PHILOX_M4x32_1, ctr.z);
+        unsigned int lo1 = PHILOX_M4x32_1 * ctr.z;
+        ctr = make_uint4(hi1 ^ ctr.y ^ key.x, lo1, hi0 ^ ctr.w ^ key.y, lo0);
+        key.x += PHILOX_W32_0;
+        key.y += PHILOX_W32_1;
+    }
+    return ctr;
+}
+
+/**
+ * @brief Converts 32 random bits to a float uniform on (0, 1]
+ *
+ * Uses the top 24 bits; the conversion is exact, so the result is the same
+ * on every device and on the host.
+ *
+ * @param[in] x Random bits
+ * @returns A float in (0, 1]
+ **/
+__device__ float philoxUniform(unsigned int x)
+{
+    return ((x >> 8) + 1) * (1.0f / 16777216.0f);
+}
+
+/**
+ * @brief Converts 64 random bits to a double uniform on (0, 1]
+ *
+ * Uses 53 bits (the top 21 bits of \a hi and all of \a lo); the
+ * conversion is exact.
+ *
+ * @param[in] hi Random bits
+ * @param[in] lo Random bits
+ * @returns A double in (0, 1]
+ **/
+__device__ double philoxUniform(unsigned int hi, unsigned int lo)
+{
+    unsigned long long x = ((unsigned long long)(hi >> 11) << 32) | lo;
+    return (x + 1) * (1.0 / 9007199254740992.0);
+}
+
+//-------------------END PHILOX FUNCTIONS-----------------------------------
+
 /** @} */ // end rand functions
 /** @} */ // end cudpp_cta
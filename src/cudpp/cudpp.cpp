@@ -54,6 +54,55 @@
 #include "cudpp_tridiagonal.h"
 #include "cudpp_compress.h"
 #include "cudpp_listrank.h"
+#include "cudpp_externalsort.h"
+#include "cudpp_sparseconvert.h"
+#include "cudpp_eulertour.h"
+#include "cudpp_histogram.h"
+#include "cudpp_rle.h"
+#include "cudpp_reducebykey.h"
+#include <limits.h>
+
+/** @returns the size in bytes of one element of \a datatype */
+static size_t datatypeSize(CUDPPDatatype datatype)
+{
+    switch (datatype)
+    {
+    case CUDPP_CHAR:      return sizeof(char);
+    case CUDPP_UCHAR:     return sizeof(unsigned char);
+    case CUDPP_SHORT:     return sizeof(short);
+    case CUDPP_USHORT:    return sizeof(unsigned short);
+    case CUDPP_INT:       return sizeof(int);
+    case CUDPP_UINT:      return sizeof(unsigned int);
+    case CUDPP_FLOAT:     return sizeof(float);
+    case CUDPP_DOUBLE:    return sizeof(double);
+    case CUDPP_LONGLONG:  return sizeof(long long);
+    case CUDPP_ULONGLONG: return sizeof(unsigned long long);
+    default:              return 0;
+    }
+}
+
+/** @returns the size in bytes of one value of a sort with \a config */
+static size_t valueSize(const CUDPPConfiguration &config)
+{
+    if (config.options & CUDPP_OPTION_KEYS_ONLY)
+        return 0;
+    if (config.algorithm == CUDPP_SORT_RADIX &&
+        (config.options & CUDPP_OPTION_64BIT_VALUES))
+        return sizeof(unsigned long long);
+    return sizeof(unsigned int);
+}
+
+/** @returns the largest size in bytes of the Huffman encoding of
+ *  \a numElements symbols of \a datatype: the encoded words, the
+ *  sub-block offsets and the code lengths */
+static size_t huffmanBytes(CUDPPDatatype datatype, size_t numElements)
+{
+    size_t numSubBlocks = (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) /
+                          CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+    size_t alphabetSize = (datatype == CUDPP_USHORT) ? 65536 : 256;
+    return CUDPP_HUFFMAN_MAX_WORDS(numElements) * sizeof(unsigned int) +
+           (numSubBlocks + 1) * sizeof(unsigned int) + alphabetSize;
+}
 
 /**
  * @brief Performs a scan operation of numElements on its input in
@@ -109,6 +158,11 @@ CUDPPResult cudppScan(const CUDPPHandle planHandle,
         if (plan->m_config.algorithm != CUDPP_SCAN)
             return CUDPP_ERROR_INVALID_PLAN;
             
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppScan",
+                                 CUDPP_SCAN, planHandle, plan->m_launchStream, numElements,
+                                 numElements * datatypeSize(plan->m_config.datatype),
+                                 numElements * datatypeSize(plan->m_config.datatype));
+
         cudppScanDispatch(d_out, d_in, numElements, 1, plan);
         return CUDPP_SUCCESS;
     }
@@ -176,6 +230,11 @@ CUDPPResult cudppSegmentedScan(const CUDPPHandle  planHandle,
         if (plan->m_config.algorithm != CUDPP_SEGMENTED_SCAN)
             return CUDPP_ERROR_INVALID_PLAN;
         
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppSegmentedScan",
+                                 CUDPP_SEGMENTED_SCAN, planHandle, plan->m_launchStream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + sizeof(unsigned int)),
+                                 numElements * datatypeSize(plan->m_config.datatype));
+
         cudppSegmentedScanDispatch(d_out, d_idata, d_iflags, numElements, plan);
         return CUDPP_SUCCESS;
     }
@@ -220,6 +279,11 @@ CUDPPResult cudppMultiScan(const CUDPPHandle planHandle,
         if (plan->m_config.algorithm != CUDPP_SCAN)
             return CUDPP_ERROR_INVALID_PLAN;
             
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppMultiScan",
+                                 CUDPP_SCAN, planHandle, plan->m_launchStream, numElements * numRows,
+                                 numElements * numRows * datatypeSize(plan->m_config.datatype),
+                                 numElements * numRows * datatypeSize(plan->m_config.datatype));
+
         cudppScanDispatch(d_out, d_in, numElements, numRows, plan);
         return CUDPP_SUCCESS;
     }
@@ -239,7 +303,9 @@ CUDPPResult cudppMultiScan(const CUDPPHandle planHandle,
  * valid. The output is a packed array, in GPU memory, of only those
  * elements marked as valid.
  * 
- * Internally, uses cudppScan.
+ * Internally, counts the valid elements of each tile of the input, scans
+ * the counts with cudppScan, and scatters each tile using a scan of its 
+ * flags in shared memory, so no array of output indices is stored.
  *
  * Example:
  * \code
@@ -279,6 +345,11 @@ CUDPPResult cudppCompact(const CUDPPHandle  planHandle,
         if (plan->m_config.algorithm != CUDPP_COMPACT)
             return CUDPP_ERROR_INVALID_PLAN;
         
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppCompact",
+                                 CUDPP_COMPACT, planHandle, plan->m_launchStream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + sizeof(unsigned int)),
+                                 numElements * datatypeSize(plan->m_config.datatype) + sizeof(size_t));
+
         cudppCompactDispatch(d_out, d_numValidElements, d_in, d_isValid, 
             numElements, plan);
         return CUDPP_SUCCESS;
@@ -287,6 +358,62 @@ CUDPPResult cudppCompact(const CUDPPHandle  planHandle,
         return CUDPP_ERROR_INVALID_HANDLE;
 }
 
+/**
+ * @brief Stably partitions an array: the elements of \a d_in whose flags in
+ * \a d_isValid are set, followed by those whose flags are not set.
+ *
+ * Uses a CUDPP_COMPACT plan and runs like cudppCompact(), except that the
+ * invalid elements are also written, after all the valid ones.  Both 
+ * groups keep their input order (or are reversed if the plan was created 
+ * with CUDPP_OPTION_BACKWARD).  This is the split of a radix sort pass.
+ *
+ * Example:
+ * \code
+ * d_in    = [ a b c d e f ]
+ * d_isValid = [ 1 0 1 1 0 1 ]
+ * d_out   = [ a c d f b e ]
+ * d_numValidElements = [ 4 ]
+ * \endcode
+ *
+ * @param[in] planHandle handle to CUDPPCompactPlan
+ * @param[out] d_out partitioned output, \a numElements elements
+ * @param[out] d_numValidElements number of valid elements, in GPU memory
+ * @param[in] d_in input to partition
+ * @param[in] d_isValid which elements in d_in are valid
+ * @param[in] numElements number of elements in d_in
+ * @returns CUDPPResult indicating success or error condition 
+ *
+ * @see cudppCompact
+ */
+CUDPP_DLL
+CUDPPResult cudppPartition(const CUDPPHandle  planHandle,
+                           void               *d_out, 
+                           size_t             *d_numValidElements,
+                           const void         *d_in, 
+                           const unsigned int *d_isValid,
+                           size_t             numElements)
+{
+    CUDPPCompactPlan *plan = 
+        (CUDPPCompactPlan*)getPlanPtrFromHandle<CUDPPCompactPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_COMPACT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppPartition",
+                                 CUDPP_COMPACT, planHandle, plan->m_launchStream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + sizeof(unsigned int)),
+                                 numElements * datatypeSize(plan->m_config.datatype) + sizeof(size_t));
+
+        cudppPartitionDispatch(d_out, d_numValidElements, d_in, d_isValid, 
+            numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
 /**
  * @brief Reduces an array to a single element using a binary associative operator
  * 
@@ -330,7 +457,250 @@ CUDPPResult cudppReduce(const CUDPPHandle planHandle,
         if (plan->m_config.algorithm != CUDPP_REDUCE)
             return CUDPP_ERROR_INVALID_PLAN;
         
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppReduce",
+                                 CUDPP_REDUCE, planHandle, plan->m_launchStream, numElements,
+                                 numElements * datatypeSize(plan->m_config.datatype),
+                                 datatypeSize(plan->m_config.datatype));
+
+        cudppReduceDispatch(d_out, d_in, numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Performs a scan like cudppScan(), issuing all of its work on
+ * \a stream.
+ *
+ * The call returns as soon as the work is queued, without synchronizing 
+ * the device, so scans and transfers on other streams may overlap it.  
+ * Completion is observed in the usual CUDA way, for example by recording 
+ * an event with cudaEventRecord() on \a stream after the call and waiting 
+ * on it with cudaEventSynchronize() or cudaStreamWaitEvent().
+ *
+ * The plan's intermediate storage is used by the scan until it completes, 
+ * so a plan must not be used on two streams at once; create one plan per 
+ * stream for concurrent scans.
+ *
+ * @param[in] planHandle Handle to plan for this scan
+ * @param[in] stream stream on which to issue the scan (0 is the default stream)
+ * @param[out] d_out output of scan, in GPU memory
+ * @param[in] d_in input to scan, in GPU memory
+ * @param[in] numElements number of elements to scan
+ * @returns CUDPPResult indicating success or error condition 
+ * 
+ * @see cudppScan, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppScanAsync(const CUDPPHandle planHandle,
+                           CUDPPStream       stream,
+                           void              *d_out, 
+                           const void        *d_in, 
+                           size_t            numElements)
+{
+    CUDPPScanPlan *plan = 
+        (CUDPPScanPlan*)getPlanPtrFromHandle<CUDPPScanPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SCAN)
+            return CUDPP_ERROR_INVALID_PLAN;
+            
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppScanAsync",
+                                 CUDPP_SCAN, planHandle, stream, numElements,
+                                 numElements * datatypeSize(plan->m_config.datatype),
+                                 numElements * datatypeSize(plan->m_config.datatype));
+
+        plan->m_launchStream = stream;
+        cudppScanDispatch(d_out, d_in, numElements, 1, plan);
+        plan->m_launchStream = 0;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Performs a multi-row scan like cudppMultiScan(), issuing all of
+ * its work on \a stream.
+ *
+ * See cudppScanAsync() for how completion is observed.
+ * 
+ * @param[in] planHandle handle to CUDPPScanPlan
+ * @param[in] stream stream on which to issue the scan (0 is the default stream)
+ * @param[out] d_out output of scan, in GPU memory
+ * @param[in] d_in input to scan, in GPU memory
+ * @param[in] numElements number of elements (per row) to scan
+ * @param[in] numRows number of rows to scan in parallel
+ * @returns CUDPPResult indicating success or error condition 
+ * 
+ * @see cudppMultiScan, cudppScanAsync
+ */
+CUDPP_DLL
+CUDPPResult cudppMultiScanAsync(const CUDPPHandle planHandle,
+                                CUDPPStream       stream,
+                                void              *d_out, 
+                                const void        *d_in, 
+                                size_t            numElements,
+                                size_t            numRows)
+{
+    CUDPPScanPlan *plan = 
+        (CUDPPScanPlan*)getPlanPtrFromHandle<CUDPPScanPlan>(planHandle);
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SCAN)
+            return CUDPP_ERROR_INVALID_PLAN;
+            
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppMultiScanAsync",
+                                 CUDPP_SCAN, planHandle, stream, numElements * numRows,
+                                 numElements * numRows * datatypeSize(plan->m_config.datatype),
+                                 numElements * numRows * datatypeSize(plan->m_config.datatype));
+
+        plan->m_launchStream = stream;
+        cudppScanDispatch(d_out, d_in, numElements, numRows, plan);
+        plan->m_launchStream = 0;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Performs a segmented scan like cudppSegmentedScan(), issuing all 
+ * of its work on \a stream.
+ *
+ * See cudppScanAsync() for how completion is observed.
+ *
+ * @param[in] planHandle Handle to plan for this scan
+ * @param[in] stream stream on which to issue the scan (0 is the default stream)
+ * @param[out] d_out output of segmented scan, in GPU memory
+ * @param[in] d_idata input data to segmented scan, in GPU memory
+ * @param[in] d_iflags input flags to segmented scan, in GPU memory
+ * @param[in] numElements number of elements to perform segmented scan on
+ * @returns CUDPPResult indicating success or error condition 
+ * 
+ * @see cudppSegmentedScan, cudppScanAsync
+ */
+CUDPP_DLL
+CUDPPResult cudppSegmentedScanAsync(const CUDPPHandle  planHandle,
+                                    CUDPPStream        stream,
+                                    void               *d_out, 
+                                    const void         *d_idata,
+                                    const unsigned int *d_iflags,
+                                    size_t             numElements)
+{
+    CUDPPSegmentedScanPlan *plan = 
+        (CUDPPSegmentedScanPlan*)getPlanPtrFromHandle<CUDPPSegmentedScanPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SEGMENTED_SCAN)
+            return CUDPP_ERROR_INVALID_PLAN;
+        
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppSegmentedScanAsync",
+                                 CUDPP_SEGMENTED_SCAN, planHandle, stream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + sizeof(unsigned int)),
+                                 numElements * datatypeSize(plan->m_config.datatype));
+
+        plan->m_launchStream = stream;
+        cudppSegmentedScanDispatch(d_out, d_idata, d_iflags, numElements, plan);
+        plan->m_launchStream = 0;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Compacts an array like cudppCompact(), issuing all of its work,
+ * including the internal scan, on \a stream.
+ *
+ * \a d_numValidElements is written on the device; read it back with 
+ * cudaMemcpyAsync() on the same stream.  See cudppScanAsync() for how 
+ * completion is observed.
+ *
+ * @param[in] planHandle handle to CUDPPCompactPlan
+ * @param[in] stream stream on which to issue the compact (0 is the default stream)
+ * @param[out] d_out compacted output
+ * @param[out] d_numValidElements number of valid elements, in GPU memory
+ * @param[in] d_in input to compact
+ * @param[in] d_isValid which elements in d_in are valid
+ * @param[in] numElements number of elements in d_in
+ * @returns CUDPPResult indicating success or error condition 
+ *
+ * @see cudppCompact, cudppScanAsync
+ */
+CUDPP_DLL
+CUDPPResult cudppCompactAsync(const CUDPPHandle  planHandle,
+                              CUDPPStream        stream,
+                              void               *d_out, 
+                              size_t             *d_numValidElements,
+                              const void         *d_in, 
+                              const unsigned int *d_isValid,
+                              size_t             numElements)
+{
+    CUDPPCompactPlan *plan = 
+        (CUDPPCompactPlan*)getPlanPtrFromHandle<CUDPPCompactPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_COMPACT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppCompactAsync",
+                                 CUDPP_COMPACT, planHandle, stream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + sizeof(unsigned int)),
+                                 numElements * datatypeSize(plan->m_config.datatype) + sizeof(size_t));
+
+        plan->m_launchStream = stream;
+        cudppCompactDispatch(d_out, d_numValidElements, d_in, d_isValid, 
+            numElements, plan);
+        plan->m_launchStream = 0;
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Reduces an array like cudppReduce(), issuing all of its work on
+ * \a stream.
+ *
+ * See cudppScanAsync() for how completion is observed.
+ *
+ * @param[in] planHandle handle to CUDPPReducePlan
+ * @param[in] stream stream on which to issue the reduction (0 is the default stream)
+ * @param[out] d_out Output of reduce (a single element) in GPU memory. 
+ * @param[in] d_in Input array to reduce in GPU memory.  
+ * @param[in] numElements the number of elements to reduce.  
+ * @returns CUDPPResult indicating success or error condition 
+ * 
+ * @see cudppReduce, cudppScanAsync
+ */
+CUDPP_DLL
+CUDPPResult cudppReduceAsync(const CUDPPHandle planHandle,
+                             CUDPPStream       stream,
+                             void              *d_out,
+                             const void        *d_in,
+                             size_t            numElements)
+{
+    CUDPPReducePlan *plan = 
+        (CUDPPReducePlan*)getPlanPtrFromHandle<CUDPPReducePlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_REDUCE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppReduceAsync",
+                                 CUDPP_REDUCE, planHandle, stream, numElements,
+                                 numElements * datatypeSize(plan->m_config.datatype),
+                                 datatypeSize(plan->m_config.datatype));
+
+        plan->m_launchStream = stream;
         cudppReduceDispatch(d_out, d_in, numElements, plan);
+        plan->m_launchStream = 0;
         return CUDPP_SUCCESS;
     }
     else
@@ -350,7 +720,9 @@ CUDPPResult cudppReduce(const CUDPPHandle planHandle,
  *
  * Supported key types are CUDPP_FLOAT and CUDPP_UINT.  Values can be
  * any 32-bit type (internally, values are treated only as a payload
- * and cast to unsigned int).
+ * and cast to unsigned int), or any 64-bit type if the plan was created
+ * with CUDPP_OPTION_64BIT_VALUES, which is needed when the values are
+ * indices into arrays of more than 2^32 elements.
  *
  * @todo Determine if we need to provide an "out of place" sort interface.
  * 
@@ -379,6 +751,11 @@ CUDPPResult cudppRadixSort(const CUDPPHandle planHandle,
         if (plan->m_config.algorithm != CUDPP_SORT_RADIX)
             return CUDPP_ERROR_INVALID_PLAN;
         
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppRadixSort",
+                                 CUDPP_SORT_RADIX, planHandle, plan->m_launchStream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + valueSize(plan->m_config)),
+                                 numElements * (datatypeSize(plan->m_config.datatype) + valueSize(plan->m_config)));
+
 	if(plan->m_config.algorithm == CUDPP_SORT_RADIX)
             cudppRadixSortDispatch(d_keys, d_values, numElements, plan);
 	
@@ -425,6 +802,12 @@ CUDPPResult cudppMergeSort(const CUDPPHandle planHandle,
     {
         if (plan->m_config.algorithm != CUDPP_SORT_MERGE)
             return CUDPP_ERROR_INVALID_PLAN;   	
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppMergeSort",
+                                 CUDPP_SORT_MERGE, planHandle, plan->m_launchStream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + valueSize(plan->m_config)),
+                                 numElements * (datatypeSize(plan->m_config.datatype) + valueSize(plan->m_config)));
+
 		cudppMergeSortDispatch(d_keys, d_values, numElements, plan);
 	    return CUDPP_SUCCESS;
     }
@@ -466,6 +849,12 @@ CUDPPResult cudppStringSort(const CUDPPHandle planHandle,
     {
         if (plan->m_config.algorithm != CUDPP_SORT_STRING)
             return CUDPP_ERROR_INVALID_PLAN;   	
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppStringSort",
+                                 CUDPP_SORT_STRING, planHandle, plan->m_launchStream, numElements,
+                                 (2 * numElements + stringArrayLength) * sizeof(unsigned int),
+                                 2 * numElements * sizeof(unsigned int));
+
 		cudppStringSortDispatch(d_keys, d_values, stringVals, numElements, stringArrayLength, plan);
 	    return CUDPP_SUCCESS;
     }
@@ -473,11 +862,147 @@ CUDPPResult cudppStringSort(const CUDPPHandle planHandle,
         return CUDPP_ERROR_INVALID_HANDLE;
 }
 
+/**
+ * @brief Sorts key-value pairs or keys only that are too large to fit in GPU
+ * (or host) memory
+ *
+ * Performs an out-of-core sort using the in-core sort configured in 
+ * \a planHandle, which must be a plan for CUDPP_SORT_RADIX or 
+ * CUDPP_SORT_MERGE.  The \a numElements the plan was created with is the
+ * chunk size: input is read from \a reader in chunks of at most that many
+ * elements, each chunk is sorted on the GPU and spilled to a temporary
+ * "run" file in \a tempDir, and the runs are then combined with a k-way
+ * merge and passed to \a writer in sorted order.  With OpenMP, reading
+ * the next chunk and writing the previous run are overlapped with sorting
+ * the current chunk on the GPU.  When there are many runs, groups of them
+ * are first merged into longer runs, so that only a bounded number of
+ * run files is open at a time.  GPU memory use
+ * is bounded by the plan size, and host memory use by two chunks, no matter
+ * how large the input is.
+ *
+ * The key type is the plan's datatype and values (if the plan was created
+ * with CUDPP_OPTION_KEY_VALUE_PAIRS) are unsigned ints, as for 
+ * cudppRadixSort().  The merge is stable, so equal keys keep their input
+ * order across chunks.  Temporary run files are removed before returning.
+ *
+ * @param[in] planHandle handle to a CUDPP_SORT_RADIX or CUDPP_SORT_MERGE plan
+ * @param[in] reader callback that supplies the input
+ * @param[in] readerData opaque pointer passed to \a reader
+ * @param[in] writer callback that consumes the sorted output
+ * @param[in] writerData opaque pointer passed to \a writer
+ * @param[in] tempDir directory for temporary run files (NULL means the 
+ *                    current directory)
+ * @returns CUDPPResult indicating success or error condition.
+ *          CUDPP_ERROR_INSUFFICIENT_RESOURCES is returned if a run file 
+ *          cannot be created or written, or if \a writer fails, and
+ *          CUDPP_ERROR_UNKNOWN if a run file is shorter than written.
+ *
+ * @see cudppExternalSortFile, cudppRadixSort, cudppMergeSort
+ */
+CUDPP_DLL
+CUDPPResult cudppExternalSort(const CUDPPHandle       planHandle,
+                              CUDPPExternalSortReader reader,
+                              void                    *readerData,
+                              CUDPPExternalSortWriter writer,
+                              void                    *writerData,
+                              const char              *tempDir)
+{
+    CUDPPPlan *plan = getPlanPtrFromHandle<CUDPPPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SORT_RADIX &&
+            plan->m_config.algorithm != CUDPP_SORT_MERGE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        // merge sort only sorts forward
+        if (plan->m_config.algorithm == CUDPP_SORT_MERGE &&
+            (plan->m_config.options & CUDPP_OPTION_BACKWARD))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        // runs carry unsigned int values
+        if (plan->m_config.options & CUDPP_OPTION_64BIT_VALUES)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (!reader || !writer || plan->m_numElements == 0)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppExternalSort",
+                                 plan->m_config.algorithm, planHandle, plan->m_launchStream,
+                                 0, 0, 0);
+
+        return cudppExternalSortDispatch(reader, readerData, writer, writerData,
+                                         tempDir, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Sorts raw binary files of keys (and values) that are too large to
+ * fit in memory
+ *
+ * A convenience wrapper around cudppExternalSort() that reads keys from
+ * \a keysIn and writes the sorted keys to \a keysOut.  Each file is a flat
+ * array of the plan's key datatype.  For key-value plans, \a valuesIn and
+ * \a valuesOut are flat arrays of unsigned int values with the same number
+ * of elements; they are ignored for keys-only plans.  A value file with
+ * fewer values than there are keys fails the sort with CUDPP_ERROR_UNKNOWN.
+ *
+ * @param[in] planHandle handle to a CUDPP_SORT_RADIX or CUDPP_SORT_MERGE plan
+ * @param[in] keysIn input key file
+ * @param[in] valuesIn input value file (key-value sorts only)
+ * @param[out] keysOut output key file
+ * @param[out] valuesOut output value file (key-value sorts only)
+ * @param[in] tempDir directory for temporary run files (NULL means the 
+ *                    current directory)
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppExternalSort
+ */
+CUDPP_DLL
+CUDPPResult cudppExternalSortFile(const CUDPPHandle planHandle,
+                                  const char        *keysIn,
+                                  const char        *valuesIn,
+                                  const char        *keysOut,
+                                  const char        *valuesOut,
+                                  const char        *tempDir)
+{
+    CUDPPPlan *plan = getPlanPtrFromHandle<CUDPPPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SORT_RADIX &&
+            plan->m_config.algorithm != CUDPP_SORT_MERGE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (plan->m_config.algorithm == CUDPP_SORT_MERGE &&
+            (plan->m_config.options & CUDPP_OPTION_BACKWARD))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        // runs carry unsigned int values
+        if (plan->m_config.options & CUDPP_OPTION_64BIT_VALUES)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (!keysIn || !keysOut || plan->m_numElements == 0)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (!(plan->m_config.options & CUDPP_OPTION_KEYS_ONLY) && 
+            (!valuesIn || !valuesOut))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppExternalSortFile",
+                                 plan->m_config.algorithm, planHandle, plan->m_launchStream,
+                                 0, 0, 0);
+
+        return cudppExternalSortFileDispatch(keysIn, valuesIn, keysOut, valuesOut,
+                                             tempDir, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
 /** @brief Perform matrix-vector multiply y = A*x for arbitrary sparse matrix A and vector x
   *
   * Given a matrix object handle (which has been initialized using cudppSparseMatrix()),
   * This function multiplies the input vector \a d_x by the matrix referred to by
-  * \a sparseMatrixHandle, returning the result in \a d_y.
+  * \a sparseMatrixHandle, adding the result to \a d_y (so \a d_y must be
+  * cleared first to compute y = A*x).  Rows with no nonzero elements leave
+  * \a d_y unchanged.  The kernel used is chosen from the matrix's row lengths
+  * when it is created (see cudppSparseMatrix()).
   *
   * @param sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
   * @param d_y The output vector, y
@@ -500,6 +1025,11 @@ CUDPPResult cudppSparseMatrixVectorMultiply(const CUDPPHandle  sparseMatrixHandl
         if (plan->m_config.algorithm != CUDPP_SPMVMULT)
             return CUDPP_ERROR_INVALID_PLAN;
         
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppSparseMatrixVectorMultiply",
+                                 CUDPP_SPMVMULT, sparseMatrixHandle, plan->m_launchStream, plan->m_numElements,
+                                 plan->m_numRows * datatypeSize(plan->m_config.datatype),
+                                 plan->m_numRows * datatypeSize(plan->m_config.datatype));
+
         cudppSparseMatrixVectorMultiplyDispatch(d_y, d_x, plan);
         return CUDPP_SUCCESS;
     }
@@ -507,23 +1037,237 @@ CUDPPResult cudppSparseMatrixVectorMultiply(const CUDPPHandle  sparseMatrixHandl
         return CUDPP_ERROR_INVALID_HANDLE;
 }
 
-/**
- * @brief Rand puts \a numElements random 32-bit elements into \a d_out
- *
- 
- * Outputs \a numElements random values to \a d_out. \a d_out must be of
- * type unsigned int, allocated in device memory.
- * 
- * The algorithm used for the random number generation is stored in \a planHandle.
- * Depending on the specification of the pseudo random number generator(PRNG),
- * the generator may have one or more seeds.  To set the seed, use cudppRandSeed().
- * 
- * @todo Currently only MD5 PRNG is supported.  We may provide more rand routines in 
- * the future.
- *
+/** @brief Perform matrix-matrix multiply Y += A*X for sparse matrix A and 
+  * dense matrices X and Y with several columns
+  *
+  * Multiplies the matrix referred to by \a sparseMatrixHandle (initialized
+  * using cudppSparseMatrix()) by each of the \a numVectors columns of \a d_X
+  * and adds the results to the corresponding columns of \a d_Y.  This gives
+  * the same result as \a numVectors calls to cudppSparseMatrixVectorMultiply(),
+  * but reads A once for up to 128 columns instead of once per column, which
+  * suits block Krylov solvers and propagating feature vectors over graphs.
+  *
+  * \a d_X and \a d_Y are row-major in device memory: element (i, v) is at
+  * index i * \a numVectors + v, so the \a numVectors values of a row are
+  * contiguous.  Both have as many rows as the matrix.
+  *
+  * @param sparseMatrixHandle Handle to a sparse matrix object created with cudppSparseMatrix()
+  * @param d_Y The output matrix, Y
+  * @param d_X The input matrix, X
+  * @param numVectors The number of columns of X and Y
+  * @returns CUDPPResult indicating success or error condition 
+  * 
+  * @see cudppSparseMatrix, cudppSparseMatrixVectorMultiply
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseMatrixMatrixMultiply(const CUDPPHandle  sparseMatrixHandle,
+                                            void               *d_Y,
+                                            const void         *d_X,
+                                            size_t             numVectors)
+{
+    CUDPPSparseMatrixVectorMultiplyPlan *plan = 
+        (CUDPPSparseMatrixVectorMultiplyPlan*)
+        getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandle);
+    
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPMVMULT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numVectors == 0 || numVectors > UINT_MAX)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppSparseMatrixMatrixMultiply",
+                                 CUDPP_SPMVMULT, sparseMatrixHandle, plan->m_launchStream, plan->m_numElements * numVectors,
+                                 plan->m_numRows * numVectors * datatypeSize(plan->m_config.datatype),
+                                 plan->m_numRows * numVectors * datatypeSize(plan->m_config.datatype));
+
+        cudppSparseMatrixMatrixMultiplyDispatch(d_Y, d_X, numVectors, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Convert a sparse matrix from coordinate (COO) format to CSR
+  *
+  * Takes \a numNonZeroElements nonzeros in any order, given by their row
+  * (\a d_cooRows), column (\a d_cooCols) and optional value (\a d_cooValues),
+  * and writes the matrix in compressed sparse row format: \a d_rowOffsets
+  * receives \a numRows + 1 offsets, the first nonzero of row i being at
+  * d_rowOffsets[i] and the end of the matrix at d_rowOffsets[numRows],
+  * and \a d_colIndices and \a d_values receive the columns and values sorted
+  * by row and then by column.  Empty rows get equal consecutive offsets.
+  * Duplicate entries are kept, in unspecified order.  The output can be 
+  * passed to cudppSparseMatrix() after copying it to the host.
+  *
+  * The nonzeros are sorted as 64-bit (row, column) keys with the plan's 
+  * radix sort, so the conversion costs about as much as sorting 
+  * \a numNonZeroElements 64-bit keys with 32-bit values.
+  *
+  * The plan must be created with ::CUDPP_SPARSE_CONVERT, with at least
+  * \a numNonZeroElements elements and \a numRows rows.  The values are 
+  * moved, not interpreted, so any datatype of their size may be used as
+  * the plan datatype.  \a d_values and \a d_cooValues may be null to 
+  * convert the structure only.  All arrays are in device memory, and the
+  * outputs may not overlap the inputs.
+  *
+  * @param[in] planHandle Handle to a plan created with ::CUDPP_SPARSE_CONVERT
+  * @param[out] d_rowOffsets The CSR row offsets (\a numRows + 1 entries)
+  * @param[out] d_colIndices The CSR column indices
+  * @param[out] d_values The CSR values, or null
+  * @param[in] d_cooRows The row of each nonzero
+  * @param[in] d_cooCols The column of each nonzero
+  * @param[in] d_cooValues The value of each nonzero, or null
+  * @param[in] numNonZeroElements The number of nonzeros
+  * @param[in] numRows The number of rows of the matrix
+  * @returns CUDPPResult indicating success or error condition
+  *
+  * @see cudppSparseTranspose, cudppSparseMatrix, cudppPlan
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseCooToCsr(const CUDPPHandle  planHandle,
+                                unsigned int       *d_rowOffsets,
+                                unsigned int       *d_colIndices,
+                                void               *d_values,
+                                const unsigned int *d_cooRows,
+                                const unsigned int *d_cooCols,
+                                const void         *d_cooValues,
+                                size_t             numNonZeroElements,
+                                size_t             numRows)
+{
+    CUDPPSparseConvertPlan *plan = 
+        (CUDPPSparseConvertPlan*)getPlanPtrFromHandle<CUDPPSparseConvertPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPARSE_CONVERT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numNonZeroElements > plan->m_numElements || numRows > plan->m_numRows ||
+            (d_values == NULL) != (d_cooValues == NULL))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t valueBytes = d_values ? datatypeSize(plan->m_config.datatype) : 0;
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppSparseCooToCsr",
+                                 CUDPP_SPARSE_CONVERT, planHandle, plan->m_launchStream, numNonZeroElements,
+                                 numNonZeroElements * (2 * sizeof(unsigned int) + valueBytes),
+                                 (numRows + 1) * sizeof(unsigned int) +
+                                 numNonZeroElements * (sizeof(unsigned int) + valueBytes));
+
+        cudppSparseCooToCsrDispatch(d_rowOffsets, d_colIndices, d_values, 
+                                    d_cooRows, d_cooCols, d_cooValues,
+                                    numNonZeroElements, numRows, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/** @brief Transpose a sparse matrix in CSR format
+  *
+  * Writes the transpose of the \a numRows x \a numCols CSR matrix given
+  * by \a d_rowOffsets, \a d_colIndices and \a d_values as a \a numCols x
+  * \a numRows CSR matrix.  The column indices of each row of the transpose
+  * are sorted.
+  *
+  * Because the CSR form of the transpose is the compressed sparse column
+  * (CSC) form of the matrix, and vice versa, this function also converts
+  * CSR to CSC and CSC to CSR: for CSC input pass the column offsets as 
+  * \a d_rowOffsets, the row indices as \a d_colIndices and swap
+  * \a numRows and \a numCols.
+  *
+  * Row offsets are expanded to one row index per nonzero and the nonzeros
+  * are sorted by (column, row) with the plan's radix sort, as in 
+  * cudppSparseCooToCsr().
+  *
+  * The plan must be created with ::CUDPP_SPARSE_CONVERT, with at least
+  * \a numNonZeroElements elements and at least max(\a numRows, \a numCols)
+  * rows.  \a d_values and \a d_tValues may be null to transpose the 
+  * structure only.  All arrays are in device memory, and the outputs may
+  * not overlap the inputs.
+  *
+  * @param[in] planHandle Handle to a plan created with ::CUDPP_SPARSE_CONVERT
+  * @param[out] d_tRowOffsets The row offsets of the transpose (\a numCols + 1 entries)
+  * @param[out] d_tColIndices The column indices of the transpose
+  * @param[out] d_tValues The values of the transpose, or null
+  * @param[in] d_rowOffsets The row offsets of the matrix (\a numRows + 1 entries)
+  * @param[in] d_colIndices The column indices of the matrix
+  * @param[in] d_values The values of the matrix, or null
+  * @param[in] numRows The number of rows of the matrix
+  * @param[in] numCols The number of columns of the matrix
+  * @param[in] numNonZeroElements The number of nonzeros
+  * @returns CUDPPResult indicating success or error condition
+  *
+  * @see cudppSparseCooToCsr, cudppSparseMatrix, cudppPlan
+  */
+CUDPP_DLL
+CUDPPResult cudppSparseTranspose(const CUDPPHandle  planHandle,
+                                 unsigned int       *d_tRowOffsets,
+                                 unsigned int       *d_tColIndices,
+                                 void               *d_tValues,
+                                 const unsigned int *d_rowOffsets,
+                                 const unsigned int *d_colIndices,
+                                 const void         *d_values,
+                                 size_t             numRows,
+                                 size_t             numCols,
+                                 size_t             numNonZeroElements)
+{
+    CUDPPSparseConvertPlan *plan = 
+        (CUDPPSparseConvertPlan*)getPlanPtrFromHandle<CUDPPSparseConvertPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_SPARSE_CONVERT)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numNonZeroElements > plan->m_numElements || numRows > plan->m_numRows ||
+            numCols > plan->m_numRows || (d_values == NULL) != (d_tValues == NULL))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t valueBytes = d_values ? datatypeSize(plan->m_config.datatype) : 0;
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppSparseTranspose",
+                                 CUDPP_SPARSE_CONVERT, planHandle, plan->m_launchStream, numNonZeroElements,
+                                 (numRows + 1) * sizeof(unsigned int) +
+                                 numNonZeroElements * (sizeof(unsigned int) + valueBytes),
+                                 (numCols + 1) * sizeof(unsigned int) +
+                                 numNonZeroElements * (sizeof(unsigned int) + valueBytes));
+
+        cudppSparseTransposeDispatch(d_tRowOffsets, d_tColIndices, d_tValues,
+                                     d_rowOffsets, d_colIndices, d_values,
+                                     numRows, numCols, numNonZeroElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Rand puts \a numElements random elements into \a d_out
+ *
+ 
+ * Outputs \a numElements random values to \a d_out, allocated in device
+ * memory.
+ * 
+ * The algorithm used for the random number generation is stored in \a planHandle.
+ * Depending on the specification of the pseudo random number generator(PRNG),
+ * the generator may have one or more seeds.  To set the seed, use cudppRandSeed().
+ *
+ * - CUDPP_RAND_MD5 generates unsigned ints; \a d_out must be of type 
+ * unsigned int.
+ * - CUDPP_RAND_PHILOX is a counter-based generator (Philox4x32-10).  It
+ * generates values of the plan datatype: raw bits for CUDPP_UINT, and
+ * for CUDPP_FLOAT and CUDPP_DOUBLE uniform values on (0, 1], or standard
+ * normal or exponential values with ::CUDPP_OPTION_RAND_NORMAL or
+ * ::CUDPP_OPTION_RAND_EXPONENTIAL.  The values are a pure function of
+ * the seed, the stream (cudppRandStream()) and the position in the stream.
+ * Each call continues the stream where the previous call ended, and
+ * cudppRandSkipAhead() advances the position in constant time, so 
+ * shards can generate disjoint parts of one stream.  Raw bits and
+ * uniform values are bit-identical to the Random123 reference on any
+ * device or host; normal and exponential values use the device math 
+ * library and may differ from host results in the last bits.
+ *
  * @param[in] planHandle Handle to plan for rand
  * @param[in] numElements number of elements in d_out.
- * @param[out] d_out output of rand, in GPU memory.  Should be an array of unsigned integers.
+ * @param[out] d_out output of rand, in GPU memory.
  * @returns CUDPPResult indicating success or error condition 
  *
  * @see cudppPlan, CUDPPConfiguration, CUDPPAlgorithm
@@ -538,11 +1282,18 @@ CUDPPResult cudppRand(const CUDPPHandle planHandle,
 
     if(plan != NULL)
     {
-        if (plan->m_config.algorithm != CUDPP_RAND_MD5)
+        if (plan->m_config.algorithm != CUDPP_RAND_MD5 &&
+            plan->m_config.algorithm != CUDPP_RAND_PHILOX)
             return CUDPP_ERROR_INVALID_PLAN;
         
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppRand",
+                                 plan->m_config.algorithm, planHandle, plan->m_launchStream, numElements,
+                                 0,
+                                 numElements * datatypeSize(plan->m_config.datatype));
+
         //dispatch the rand algorithm here
         cudppRandDispatch(d_out, numElements, plan);
+        plan->m_offset += numElements;
         return CUDPP_SUCCESS;
     }
     else
@@ -557,7 +1308,8 @@ CUDPPResult cudppRand(const CUDPPHandle planHandle,
  * multiple different rand algorithms in CUDPP, cudppRandSeed 
  * uses \a planHandle to determine which seed to set.  Each rand 
  * algorithm has its own  unique set of seeds depending on what 
- * the algorithm needs.
+ * the algorithm needs.  For CUDPP_RAND_PHILOX, setting the seed also 
+ * restarts the stream at position 0.
  *
  * @param[in] planHandle the handle to the plan which specifies which rand seed to set
  * @param[in] seed the value which the internal cudpp seed will be set to
@@ -572,9 +1324,11 @@ CUDPPResult cudppRandSeed(const CUDPPHandle planHandle,
 
     if (plan != NULL)
     {
-        if (plan->m_config.algorithm != CUDPP_RAND_MD5)
+        if (plan->m_config.algorithm != CUDPP_RAND_MD5 &&
+            plan->m_config.algorithm != CUDPP_RAND_PHILOX)
             return CUDPP_ERROR_INVALID_PLAN;
         plan->m_seed = seed;
+        plan->m_offset = 0;
     }
     else
         return CUDPP_ERROR_INVALID_HANDLE;
@@ -582,26 +1336,105 @@ CUDPPResult cudppRandSeed(const CUDPPHandle planHandle,
     return CUDPP_SUCCESS;
 }//end cudppRandSeed
 
+/**@brief Selects the stream of a counter-based generator
+ *
+ * For CUDPP_RAND_PHILOX the seed and the stream together form the key,
+ * so each (seed, stream) pair selects an independent sequence.  Selecting
+ * a stream restarts it at position 0.
+ *
+ * @param[in] planHandle the handle to a CUDPP_RAND_PHILOX plan
+ * @param[in] stream the stream to select
+ * @returns CUDPPResult indicating success or error condition 
+ */
+CUDPP_DLL
+CUDPPResult cudppRandStream(const CUDPPHandle planHandle, 
+                            unsigned int      stream)
+{
+    CUDPPRandPlan * plan = 
+        (CUDPPRandPlan *) getPlanPtrFromHandle<CUDPPRandPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_RAND_PHILOX)
+            return CUDPP_ERROR_INVALID_PLAN;
+        plan->m_stream = stream;
+        plan->m_offset = 0;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    return CUDPP_SUCCESS;
+}//end cudppRandStream
+
+/**@brief Advances a counter-based generator without generating values
+ *
+ * Skips \a numElements values of the current stream in constant time; the
+ * next cudppRand() call continues after them.  For example, shard \a k of
+ * a job in which each shard generates \a n values can call
+ * <tt>cudppRandSkipAhead(plan, k * n)</tt> after cudppRandSeed().
+ *
+ * @param[in] planHandle the handle to a CUDPP_RAND_PHILOX plan
+ * @param[in] numElements the number of values to skip
+ * @returns CUDPPResult indicating success or error condition 
+ */
+CUDPP_DLL
+CUDPPResult cudppRandSkipAhead(const CUDPPHandle  planHandle, 
+                               unsigned long long numElements)
+{
+    CUDPPRandPlan * plan = 
+        (CUDPPRandPlan *) getPlanPtrFromHandle<CUDPPRandPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_RAND_PHILOX)
+            return CUDPP_ERROR_INVALID_PLAN;
+        plan->m_offset += numElements;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+
+    return CUDPP_SUCCESS;
+}//end cudppRandSkipAhead
+
 /**
  * @brief Solves tridiagonal linear systems
  *
- * The solver uses a hybrid CR-PCR algorithm described in our papers "Fast
- * Fast Tridiagonal Solvers on the GPU" and "A Hybrid Method for Solving 
- * Tridiagonal Systems on the GPU". (See the \ref references bibliography).
- * Please refer to the papers for a complete description of the basic CR 
- * (Cyclic Reduction) and PCR (Parallel Cyclic Reduction) algorithms and their 
- * hybrid variants.
+ * The solver chooses a method for each call based on the system size:
+ *
+ * - Small systems (up to 64 equations) are solved with the Thomas
+ * algorithm, one thread per system, on systems transposed to an
+ * interleaved layout in shared memory.
+ * - Power-of-two systems that fit in one CUDA block use the hybrid CR-PCR
+ * algorithm described in our papers "Fast Tridiagonal Solvers on the GPU"
+ * and "A Hybrid Method for Solving Tridiagonal Systems on the GPU". (See
+ * the \ref references bibliography).  Please refer to the papers for a
+ * complete description of the basic CR (Cyclic Reduction) and PCR 
+ * (Parallel Cyclic Reduction) algorithms and their hybrid variants.
+ * - Other systems that fit in shared memory are solved one per block with
+ * cyclic reduction followed by the Thomas algorithm, without padding to a
+ * power of two.
+ * - Larger systems are split into partitions whose interfaces form a
+ * smaller tridiagonal system (a SPIKE-style partitioned method), which is
+ * solved recursively.  This method allocates temporary device memory.
+ *
+ * Two variants are selected with plan options:
+ *
+ * - ::CUDPP_OPTION_PERIODIC solves periodic (cyclic) systems, in which
+ * \a d_a[0] of each system couples the first equation to the last unknown
+ * and \a d_c[systemSize-1] couples the last equation to the first unknown.
+ * The solver applies the Sherman-Morrison formula to two non-periodic
+ * solves.  Periodic systems must have at least 3 equations.
+ * - ::CUDPP_OPTION_BLOCK_2X2 and ::CUDPP_OPTION_BLOCK_4X4 solve
+ * block-tridiagonal systems with 2x2 or 4x4 blocks, using the block Thomas
+ * algorithm (one thread per system) with partial pivoting inside each
+ * block.  \a systemSize is then the number of block rows; \a d_a, \a d_b
+ * and \a d_c hold one row-major block per block row, and \a d_d and \a d_x
+ * one vector per block row.
  *
  * - Both float and double data types are supported. 
- * - Both power-of-two and non-power-of-two system sizes are supported.
- * - The maximum system size could be limited by the maximum number of threads
- * of a CUDA block, the number of registers per multiprocessor, and the 
- * amount of shared memory available. For example, on the GTX 280 GPU, the 
- * maximum system size is 512 for the float datatype, and 256 for the double 
- * datatype, which is limited by the size of shared memory in this case. 
- * - The maximum number of systems is 65535, that is the maximum number of 
- * one-dimensional blocks that could be launched in a kernel call. Users could 
- * launch the kernel multiple times to solve more systems if required. 
+ * - Any system size and any number of systems are supported.
+ * - As with the CR-PCR algorithm, the solvers do not pivot, so the systems
+ * should be diagonally dominant (or otherwise stable without pivoting).
  *
  * @param[out] d_x Solution vector
  * @param[in] planHandle Handle to plan for tridiagonal solver
@@ -613,7 +1446,7 @@ CUDPPResult cudppRandSeed(const CUDPPHandle planHandle,
  * @param[in] numSystems The number of systems to be solved
  * @returns CUDPPResult indicating success or error condition
  *
- * @see cudppPlan, CUDPPConfiguration, CUDPPAlgorithm
+ * @see cudppTridiagonalHost, cudppPlan, CUDPPConfiguration, CUDPPAlgorithm
  */
 CUDPP_DLL
 CUDPPResult cudppTridiagonal(CUDPPHandle planHandle, 
@@ -630,6 +1463,15 @@ CUDPPResult cudppTridiagonal(CUDPPHandle planHandle,
     
     if(plan != NULL)
     {
+        size_t numEquations = (systemSize > 0 && numSystems > 0) ?
+            (size_t)systemSize * numSystems : 0;
+        size_t blockSize = (plan->m_config.options & CUDPP_OPTION_BLOCK_4X4) ? 4 :
+            (plan->m_config.options & CUDPP_OPTION_BLOCK_2X2) ? 2 : 1;
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppTridiagonal",
+                                 CUDPP_TRIDIAGONAL, planHandle, plan->m_launchStream, numEquations,
+                                 numEquations * datatypeSize(plan->m_config.datatype) * (3 * blockSize * blockSize + blockSize),
+                                 numEquations * datatypeSize(plan->m_config.datatype) * blockSize);
+
         //dispatch the tridiagonal solver here
         return cudppTridiagonalDispatch(d_a, d_b, d_c, d_d, d_x, 
                                         systemSize, numSystems, plan);
@@ -638,6 +1480,163 @@ CUDPPResult cudppTridiagonal(CUDPPHandle planHandle,
         return CUDPP_ERROR_INVALID_HANDLE;
 }
 
+/**
+ * @brief Solves tridiagonal linear systems in host memory
+ *
+ * Solves the same systems as cudppTridiagonal(), laid out the same way,
+ * with arrays in host memory.  The Thomas algorithm is vectorized across
+ * systems: groups of ::TRIDIAGONAL_HOST_LANES systems are transposed into
+ * an interleaved layout, so that each step of the elimination works on
+ * one equation of every system of the group at once.  When the library
+ * is built with OpenMP, the groups are divided among threads.  The input
+ * arrays are not modified.  Like the device solvers, this solver does
+ * not pivot.  Plans with ::CUDPP_OPTION_PERIODIC are supported; block
+ * plans are not, and return ::CUDPP_ERROR_ILLEGAL_CONFIGURATION.
+ *
+ * @param[out] x Solution vector
+ * @param[in] planHandle Handle to plan for tridiagonal solver
+ * @param[in] a Lower diagonal
+ * @param[in] b Main diagonal
+ * @param[in] c Upper diagonal
+ * @param[in] d Right hand side
+ * @param[in] systemSize The size of the linear system
+ * @param[in] numSystems The number of systems to be solved
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppTridiagonal, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppTridiagonalHost(CUDPPHandle planHandle, 
+                                 const void *a, 
+                                 const void *b, 
+                                 const void *c, 
+                                 const void *d, 
+                                 void *x, 
+                                 int systemSize, 
+                                 int numSystems)
+{   
+    CUDPPTridiagonalPlan * plan = 
+        (CUDPPTridiagonalPlan *) getPlanPtrFromHandle<CUDPPTridiagonalPlan>(planHandle);
+    
+    if (plan != NULL)
+        return cudppTridiagonalHostDispatch(a, b, c, d, x, 
+                                            systemSize, numSystems, plan);
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Huffman encodes an array of symbols
+ *
+ * Encodes \a numElements symbols of the plan's datatype, ::CUDPP_UCHAR
+ * (256 symbols) or ::CUDPP_USHORT (65536 symbols), with a canonical
+ * Huffman code whose codes are at most ::CUDPP_HUFFMAN_MAX_CODE_LENGTH 
+ * bits.  Among such codes it is the one that minimizes the encoded size
+ * (it is built by package-merge), so it is an optimal Huffman code
+ * whenever the limit does not bind.  Since the code is canonical, the
+ * code lengths are all a decoder needs to rebuild it.
+ *
+ * The stream is split into sub-blocks of ::CUDPP_HUFFMAN_SUBBLOCK_SIZE
+ * symbols that each start on a word boundary, so that they can be 
+ * decoded in parallel.  Codes are written most significant bit first.
+ * The stream is identical to that of cudppHuffmanEncodeHost().
+ *
+ * @param[in]  planHandle Handle to a ::CUDPP_HUFFMAN plan
+ * @param[out] d_compressed The encoded stream, at most
+ *             ::CUDPP_HUFFMAN_MAX_WORDS(\a numElements) words
+ * @param[out] d_codeLengths The code length of each symbol of the
+ *             alphabet, 0 for symbols that do not occur
+ * @param[out] d_subBlockOffsets The first word of each sub-block, then
+ *             the total number of words (one more entry than sub-blocks)
+ * @param[in]  d_in The symbols to encode
+ * @param[in]  numElements Number of symbols, at most the size of the plan
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppHuffmanDecode, cudppHuffmanEncodeHost, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppHuffmanEncode(CUDPPHandle   planHandle,
+                               unsigned int  *d_compressed,
+                               unsigned char *d_codeLengths,
+                               unsigned int  *d_subBlockOffsets,
+                               const void    *d_in,
+                               size_t        numElements)
+{
+    CUDPPHuffmanPlan *plan = 
+        (CUDPPHuffmanPlan *) getPlanPtrFromHandle<CUDPPHuffmanPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_HUFFMAN)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppHuffmanEncode",
+                                 CUDPP_HUFFMAN, planHandle, plan->m_launchStream, numElements,
+                                 numElements * datatypeSize(plan->m_config.datatype),
+                                 huffmanBytes(plan->m_config.datatype, numElements));
+
+        cudppHuffmanEncodeDispatch(d_compressed, d_codeLengths, d_subBlockOffsets,
+                                   d_in, numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Decodes a Huffman encoded array of symbols
+ *
+ * Decodes a stream written by cudppHuffmanEncode() or 
+ * cudppHuffmanEncodeHost().  Each sub-block is decoded by its own thread
+ * with a table-driven decoder: a lookup of the next 10 bits decodes
+ * all the codes that fit in them, up to four, and longer
+ * codes are decoded from the first canonical code of each length.
+ *
+ * @param[in]  planHandle Handle to a ::CUDPP_HUFFMAN plan
+ * @param[out] d_out The decoded symbols
+ * @param[in]  d_compressed The encoded stream
+ * @param[in]  d_codeLengths The code length of each symbol of the alphabet
+ * @param[in]  d_subBlockOffsets The first word of each sub-block, then
+ *             the total number of words
+ * @param[in]  numElements Number of symbols, at most the size of the plan
+ * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION if the code lengths are not
+ *          those of a prefix code or the stream does not decode,
+ *          otherwise CUDPPResult indicating success or error condition
+ *
+ * @see cudppHuffmanEncode, cudppHuffmanDecodeHost, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppHuffmanDecode(CUDPPHandle         planHandle,
+                               void                *d_out,
+                               const unsigned int  *d_compressed,
+                               const unsigned char *d_codeLengths,
+                               const unsigned int  *d_subBlockOffsets,
+                               size_t              numElements)
+{
+    CUDPPHuffmanPlan *plan = 
+        (CUDPPHuffmanPlan *) getPlanPtrFromHandle<CUDPPHuffmanPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_HUFFMAN)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppHuffmanDecode",
+                                 CUDPP_HUFFMAN, planHandle, plan->m_launchStream, numElements,
+                                 huffmanBytes(plan->m_config.datatype, numElements),
+                                 numElements * datatypeSize(plan->m_config.datatype));
+
+        return cudppHuffmanDecodeDispatch(d_out, d_compressed, d_codeLengths,
+                                          d_subBlockOffsets, numElements, plan);
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
 /**
  * @brief Compresses data stream
  *
@@ -647,26 +1646,26 @@ CUDPPResult cudppTridiagonal(CUDPPHandle planHandle,
  * Data Compression on the GPU". (See the \ref references bibliography).
  *
  * - Only unsigned char type is supported.
- * - Currently, the input stream (d_a) must be a buffer of 1,048,576 (uchar) elements (~1MB).
+ * - The input stream (d_a) may have any number of elements up to the size of
+ * the plan (at most 64 MB).
  * - The BWT Index (d_x) is an integer number (int). This is used during the reverse-BWT stage.
  * - The Histogram size pointer (d_y) can be ignored and can be passed a null pointer.
- * - The Histrogram (d_z) is a 256-entry (unsigned int) buffer. The histogram is used to
- * construct the Huffman tree during decoding.
- * - The Encoded offset table (d_w) is a 256-entry (unsigned int) buffer. Since the input
- * stream is compressed in blocks of 4096 characters, the offset table gives the starting offset of
- * where each block starts in the compressed data (d_xx). The very first uint at each starting offset
- * gives the size (in words) of that corresponding compressed block. This allows us to decompress each 4096
- * character-block in parallel.
+ * - The code lengths (d_z) are a 256-entry (unsigned char) buffer: the length of
+ * the canonical Huffman code of each byte of the MTF output, which is all
+ * cudppHuffmanDecode() needs to rebuild the code.
+ * - The Encoded offset table (d_w) is an (unsigned int) buffer with one entry
+ * per ::CUDPP_HUFFMAN_SUBBLOCK_SIZE characters, plus one.  It gives the word
+ * at which each sub-block starts in the compressed data (d_yy), followed by
+ * the total, so that the sub-blocks can be decompressed in parallel.
  * - The size of compressed data (d_xx) is a uint and gives the final size (in words)
  * of the compressed data.
- * - The compress data stream (d_yy) is a uint buffer. The user should allocate enough
- * memory for worst-case (no compression occurs).
- * - \a numElements is a uint and must be set to 1048576.
+ * - The compress data stream (d_yy) is a uint buffer of at most
+ * ::CUDPP_HUFFMAN_MAX_WORDS(\a numElements) words.
  *
  * @param[out] d_x BWT Index (int)
  * @param[out] d_y Histogram size (ignored, null ptr)
- * @param[out] d_z Histogram (256-entry, uint)
- * @param[out] d_w Encoded offset table (256-entry, uint)
+ * @param[out] d_z Huffman code lengths (256-entry, uchar)
+ * @param[out] d_w Encoded offset table (uint)
  * @param[out] d_xx Size of compressed data (uint)
  * @param[out] d_yy Compressed data
  * @param[in] planHandle Handle to plan for compressor
@@ -687,21 +1686,6 @@ CUDPPResult cudppCompress(CUDPPHandle planHandle,
                           void *d_yy,
                           size_t numElements)
 {   
-    // first check: is this device >= 2.0? if not, return error
-    int deviceCount;
-    int dev = 0;
-    cudaDeviceProp devProps;
-    cudaGetDeviceCount(&deviceCount);
-    dev = deviceCount - 1;
-    cudaSetDevice(dev);
-    cudaGetDeviceProperties(&devProps, dev);
-
-    if((int)devProps.major < 2) {
-        // Only supported on devices with compute
-        // capability 2.0 or greater
-        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
-    }
-    
     CUDPPCompressPlan * plan = 
         (CUDPPCompressPlan *) getPlanPtrFromHandle<CUDPPCompressPlan>(planHandle);
     
@@ -711,9 +1695,15 @@ CUDPPResult cudppCompress(CUDPPHandle planHandle,
             return CUDPP_ERROR_INVALID_PLAN;
         if (plan->m_config.datatype != CUDPP_UCHAR)
             return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
-        if (numElements != 1048576)
+        if (numElements > plan->m_numElements)
             return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppCompress",
+                                 CUDPP_COMPRESS, planHandle, plan->m_launchStream, numElements,
+                                 numElements,
+                                 sizeof(int) + sizeof(unsigned int) +
+                                 huffmanBytes(CUDPP_UCHAR, numElements));
+
         cudppCompressDispatch(d_a, d_x, d_y, d_z, d_w, 
             d_xx, d_yy, numElements, plan);
         return CUDPP_SUCCESS;
@@ -725,11 +1715,14 @@ CUDPPResult cudppCompress(CUDPPHandle planHandle,
 /**
  * @brief Performs the Burrows-Wheeler Transform
  *
- * Performs a parallel Burrows-Wheeler transform on 1,048,576 elements.
- * The BWT leverages a string-sort algorithm based on merge-sort.
+ * Performs a parallel Burrows-Wheeler transform of \a numElements bytes,
+ * any number up to the size of the plan (at most 64 MB, see 
+ * cudppPlan()).  The cyclic rotations of the input are sorted by prefix
+ * doubling: each round radix sorts pairs of ranks and doubles the number
+ * of characters compared, until all rotations are ranked apart.  Inputs
+ * with long repeats take more rounds, at most log2(\a numElements).
  *
- * - Currently, the BWT can only be performed on 1,048,576 (uchar) elements.
- * - The transformed string is written to \a d_x.
+ * - The transformed string is written to \a d_x, which may be \a d_a.
  * - The BWT index (used during the reverse-BWT) is recorded as an int 
  * in \a d_y.
  *
@@ -737,10 +1730,11 @@ CUDPPResult cudppCompress(CUDPPHandle planHandle,
  * @param[out] d_y BWT Index
  * @param[out] d_x Output data
  * @param[in] d_a Input data
- * @param[in] numElements Number of elements
+ * @param[in] numElements Number of elements, at most the size of the plan
  * @returns CUDPPResult indicating success or error condition
  *
- * @see cudppPlan, CUDPPConfiguration, CUDPPAlgorithm
+ * @see cudppPlan, CUDPPConfiguration, CUDPPAlgorithm,
+ * cudppBurrowsWheelerTransformHost
  */
 CUDPP_DLL
 CUDPPResult cudppBurrowsWheelerTransform(CUDPPHandle planHandle,
@@ -749,21 +1743,6 @@ CUDPPResult cudppBurrowsWheelerTransform(CUDPPHandle planHandle,
                                          void *d_y,
                                          size_t numElements)
 {
-    // first check: is this device >= 2.0? if not, return error
-    int deviceCount;
-    int dev = 0;
-    cudaDeviceProp devProps;
-    cudaGetDeviceCount(&deviceCount);
-    dev = deviceCount - 1;
-    cudaSetDevice(dev);
-    cudaGetDeviceProperties(&devProps, dev);
-
-    if((int)devProps.major < 2) {
-        // Only supported on devices with compute
-        // capability 2.0 or greater
-        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
-    }
-
     CUDPPBwtPlan * plan = 
         (CUDPPBwtPlan *) getPlanPtrFromHandle<CUDPPBwtPlan>(planHandle);
 
@@ -773,9 +1752,14 @@ CUDPPResult cudppBurrowsWheelerTransform(CUDPPHandle planHandle,
             return CUDPP_ERROR_INVALID_PLAN;
         if (plan->m_config.datatype != CUDPP_UCHAR)
             return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
-        if (numElements != 1048576)
+        if (numElements > plan->m_numElements)
             return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppBurrowsWheelerTransform",
+                                 CUDPP_BWT, planHandle, plan->m_launchStream, numElements,
+                                 numElements,
+                                 numElements + sizeof(int));
+
         cudppBwtDispatch(d_a, d_x, d_y, numElements, plan);
         return CUDPP_SUCCESS;
     }
@@ -786,21 +1770,30 @@ CUDPPResult cudppBurrowsWheelerTransform(CUDPPHandle planHandle,
 /**
  * @brief Performs the Move-to-Front Transform
  *
- * Performs a parallel move-to-front transform on 1,048,576 elements.
- * The MTF uses a scan-based algorithm to parallelize the computation.
- * The MTF uses a scan-based algorithm described in our paper "Parallel
- * Lossless Data Compression on the GPU". (See the \ref references bibliography).
+ * Performs a parallel move-to-front transform of \a numElements bytes,
+ * starting from the list 0..255.
+ *
+ * The input is split into chunks (see cudppMoveToFrontChunkSize()), one
+ * per thread.  The effect of a chunk on the MTF list does not depend on
+ * the list before it: the symbols used in the chunk move to the front,
+ * most recently used first.  These partial lists combine associatively,
+ * so a scan of them gives the list at the start of every chunk, from 
+ * which the chunks are encoded in parallel.  This generalizes the 
+ * scan-based algorithm of our paper "Parallel Lossless Data Compression
+ * on the GPU" (see the \ref references bibliography) to any input 
+ * size and chunk size.  The output is the sequential MTF transform of 
+ * the input, whatever the chunk size.
  *
- * - Currently, the MTF can only be performed on 1,048,576 (uchar) elements.
  * - The transformed string is written to \a d_x.
  *
  * @param[in] planHandle Handle to plan for MTF
  * @param[out] d_x Output data
  * @param[in] d_a Input data
- * @param[in] numElements Number of elements
+ * @param[in] numElements Number of elements, at most the size of the plan
  * @returns CUDPPResult indicating success or error condition
  *
- * @see cudppPlan, CUDPPConfiguration, CUDPPAlgorithm
+ * @see cudppPlan, cudppInverseMoveToFrontTransform, cudppMoveToFrontTransformHost,
+ *      CUDPPConfiguration, CUDPPAlgorithm
  */
 CUDPP_DLL
 CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
@@ -808,20 +1801,55 @@ CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
                                       void *d_x,
                                       size_t numElements)
 {
-    int deviceCount;
-    int dev = 0;
-    cudaDeviceProp devProps;
-    cudaGetDeviceCount(&deviceCount);
-    dev = deviceCount - 1;
-    cudaSetDevice(dev);
-    cudaGetDeviceProperties(&devProps, dev);
+    CUDPPMtfPlan * plan = 
+        (CUDPPMtfPlan *) getPlanPtrFromHandle<CUDPPMtfPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_MTF)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (plan->m_config.datatype != CUDPP_UCHAR ||
+            numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 
-    if((int)devProps.major < 2) {
-        // Only supported on devices with compute
-        // capability 2.0 or greater
-        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppMoveToFrontTransform",
+                                 CUDPP_MTF, planHandle, plan->m_launchStream, numElements,
+                                 numElements,
+                                 numElements);
+
+        cudppMtfDispatch(d_a, d_x, numElements, plan);
+        return CUDPP_SUCCESS;
     }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
 
+/**
+ * @brief Performs the inverse Move-to-Front Transform
+ *
+ * Decodes \a numElements MTF indices, as produced by 
+ * cudppMoveToFrontTransform(), into the original bytes.  A chunk of 
+ * indices permutes the positions of the MTF list whatever its contents,
+ * and these permutations compose associatively, so the list at the 
+ * start of every chunk is found with a scan, as for the forward 
+ * transform.
+ *
+ * The decoded data is written to \a d_x, which may be \a d_a.
+ *
+ * @param[in] planHandle Handle to plan for MTF
+ * @param[out] d_x Output (decoded) data
+ * @param[in] d_a Input MTF indices
+ * @param[in] numElements Number of elements, at most the size of the plan
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppPlan, cudppMoveToFrontTransform, cudppInverseMoveToFrontTransformHost
+ */
+CUDPP_DLL
+CUDPPResult cudppInverseMoveToFrontTransform(CUDPPHandle planHandle,
+                                             void *d_a,
+                                             void *d_x,
+                                             size_t numElements)
+{
     CUDPPMtfPlan * plan = 
         (CUDPPMtfPlan *) getPlanPtrFromHandle<CUDPPMtfPlan>(planHandle);
     
@@ -829,10 +1857,55 @@ CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
     {
         if (plan->m_config.algorithm != CUDPP_MTF)
             return CUDPP_ERROR_INVALID_PLAN;
-        if (plan->m_config.datatype != CUDPP_UCHAR)
+        if (plan->m_config.datatype != CUDPP_UCHAR ||
+            numElements > plan->m_numElements)
             return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 
-        cudppMtfDispatch(d_a, d_x, numElements, plan);
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppInverseMoveToFrontTransform",
+                                 CUDPP_MTF, planHandle, plan->m_launchStream, numElements,
+                                 numElements,
+                                 numElements);
+
+        cudppInverseMtfDispatch(d_a, d_x, numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Sets the number of symbols per chunk of the MTF transforms
+ *
+ * Each thread of the MTF transforms processes one chunk sequentially, 
+ * and each chunk needs 256 bytes of state.  Smaller chunks expose more
+ * parallelism for small inputs at the cost of more state and a longer 
+ * scan; larger chunks do less work in total.  The default is 
+ * ::MTF_DEFAULT_CHUNK_SIZE.  The results do not depend on the chunk 
+ * size.  The plan's intermediate storage is reallocated.
+ *
+ * @param[in] planHandle Handle to plan for MTF
+ * @param[in] chunkSize Number of symbols per chunk (at least 1)
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppMoveToFrontTransform, cudppInverseMoveToFrontTransform
+ */
+CUDPP_DLL
+CUDPPResult cudppMoveToFrontChunkSize(CUDPPHandle planHandle,
+                                      unsigned int chunkSize)
+{
+    CUDPPMtfPlan * plan = 
+        (CUDPPMtfPlan *) getPlanPtrFromHandle<CUDPPMtfPlan>(planHandle);
+    
+    if(plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_MTF)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (chunkSize == 0)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        freeMtfStorage(plan);
+        plan->m_mtfChunkSize = chunkSize;
+        allocMtfStorage(plan);
         return CUDPP_SUCCESS;
     }
     else
@@ -842,8 +1915,11 @@ CUDPPResult cudppMoveToFrontTransform(CUDPPHandle planHandle,
 /**
  * @brief Performs list ranking of linked list node values
  *
- * Performs parallel list ranking on values of a linked-list
- * using a pointer-jumping algorithm.
+ * Performs parallel list ranking on values of a linked-list.
+ * The list is cut at random splitters into short sublists that are
+ * ranked in parallel, the list of sublists is ranked the same way,
+ * and the sublist offsets are added back, so the work is linear in
+ * the length of the list.
  *
  * Takes as input an array of values in GPU memory
  * (\a d_a) and an equal-sized int array in GPU memory
@@ -887,12 +1963,605 @@ CUDPPResult cudppListRank(CUDPPHandle planHandle,
         if (plan->m_config.algorithm != CUDPP_LISTRANK)
             return CUDPP_ERROR_INVALID_PLAN;
 
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppListRank",
+                                 CUDPP_LISTRANK, planHandle, plan->m_launchStream, numElements,
+                                 numElements * (datatypeSize(plan->m_config.datatype) + sizeof(int)),
+                                 numElements * datatypeSize(plan->m_config.datatype));
+
         return cudppListRankDispatch(d_x, d_a, d_b, head, numElements, plan);
     }
     else
         return CUDPP_ERROR_INVALID_HANDLE;
 }
 
+/**
+ * @brief Compute the Euler tour, depth, preorder index and subtree size
+ * of every node of a forest given by parent indices
+ *
+ * Node i of the forest has parent \a d_parent[i], or is a root if 
+ * \a d_parent[i] is negative.  The children of a node are visited in
+ * increasing index order, and the trees in the increasing order of their
+ * roots.  The tour visits 2 * \a numNodes events: it enters each node,
+ * visits the subtrees of its children, and leaves the node.  The outputs
+ * are, for each node:
+ * - \a d_depth: the number of edges to its root (0 for roots)
+ * - \a d_preorder: the order in which the tour enters it, counted from 0
+ *   across the whole forest
+ * - \a d_subtreeSize: the number of nodes in its subtree, itself included
+ * 
+ * and \a d_eulerTour receives the node of each event in tour order, so 
+ * each node appears twice: where the tour enters it and where it leaves.
+ * Any output may be null if it is not needed.
+ *
+ * The whole computation runs on the device: the children are grouped by
+ * a COO to CSR conversion, the events are linked into a list and ranked
+ * with the list ranking of cudppListRank(), and the depths come from a
+ * scan of the +1 and -1 depth steps of the tour.  The work is linear in
+ * \a numNodes apart from the radix sort of the (parent, child) pairs.
+ *
+ * The plan must be created with ::CUDPP_EULER_TOUR, datatype ::CUDPP_INT
+ * and at least \a numNodes elements.  If \a d_parent does not describe a
+ * forest (it has a cycle) the results are undefined.
+ *
+ * @param[in] planHandle Handle to a plan created with ::CUDPP_EULER_TOUR
+ * @param[out] d_depth The depth of each node, or null
+ * @param[out] d_preorder The preorder index of each node, or null
+ * @param[out] d_subtreeSize The size of the subtree of each node, or null
+ * @param[out] d_eulerTour The node of each event of the tour 
+ *             (2 * \a numNodes entries), or null
+ * @param[in] d_parent The parent of each node, negative for roots
+ * @param[in] numNodes The number of nodes
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppPlan, cudppListRank, cudppSparseCooToCsr
+ */
+CUDPP_DLL
+CUDPPResult cudppEulerTour(CUDPPHandle  planHandle,
+                           int          *d_depth,
+                           unsigned int *d_preorder,
+                           unsigned int *d_subtreeSize,
+                           unsigned int *d_eulerTour,
+                           const int    *d_parent,
+                           size_t       numNodes)
+{
+    CUDPPEulerTourPlan *plan = 
+        (CUDPPEulerTourPlan*)getPlanPtrFromHandle<CUDPPEulerTourPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_EULER_TOUR)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numNodes > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppEulerTour",
+                                 CUDPP_EULER_TOUR, planHandle, plan->m_launchStream, numNodes,
+                                 numNodes * sizeof(int),
+                                 5 * numNodes * sizeof(unsigned int));
+
+        cudppEulerTourDispatch(d_depth, d_preorder, d_subtreeSize, d_eulerTour,
+                               d_parent, numNodes, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Computes a histogram
+ *
+ * Counts the values of \a d_in in each bin of the plan.  The bins are
+ * set with cudppHistogramKeyBins() (one bin per integer key),
+ * cudppHistogramUniformBins() (equal-width bins) or
+ * cudppHistogramBinEdges() (bins between given edges).  Plans of
+ * datatype ::CUDPP_CHAR, ::CUDPP_UCHAR, ::CUDPP_SHORT or ::CUDPP_USHORT
+ * start with one bin per value, so that, for instance, a ::CUDPP_UCHAR
+ * plan computes a 256-bin byte histogram without further setup; plans of
+ * other datatypes must be given bins first.  Values outside of all bins
+ * are not counted.
+ *
+ * With up to 256 bins, each thread counts its values in a private 8-bit
+ * sub-histogram in shared memory, flushed to a 32-bit histogram of its
+ * CTA every 255 values, so there are no atomic operations or bank
+ * conflicts and the input is read once; bytes are read four at a time.
+ * With more bins the bins of the values are radix sorted and counted as
+ * runs.
+ *
+ * @param[in]  planHandle Handle to a plan created with ::CUDPP_HISTOGRAM
+ * @param[out] d_histogram The count of each bin
+ * @param[in]  d_in The values
+ * @param[in]  numElements Number of values, at most the size of the plan
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppHistogramHost, cudppHistogramKeyBins, cudppHistogramUniformBins,
+ *      cudppHistogramBinEdges, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppHistogram(CUDPPHandle  planHandle,
+                           unsigned int *d_histogram,
+                           const void   *d_in,
+                           size_t       numElements)
+{
+    CUDPPHistogramPlan *plan = 
+        (CUDPPHistogramPlan*)getPlanPtrFromHandle<CUDPPHistogramPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_HISTOGRAM)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (plan->m_numBins == 0 || numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppHistogram",
+                                 CUDPP_HISTOGRAM, planHandle, plan->m_launchStream, numElements,
+                                 numElements * datatypeSize(plan->m_config.datatype),
+                                 plan->m_numBins * sizeof(unsigned int));
+
+        cudppHistogramDispatch(d_histogram, d_in, numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Computes a histogram of host values
+ *
+ * Counts host values in the bins of the plan, which are assigned exactly
+ * as by cudppHistogram().  When the library is built with OpenMP, each
+ * thread counts a contiguous chunk of the values into its own
+ * sub-histograms.  Consecutive values are counted in several interleaved
+ * sub-histograms, added up at the end, so that runs of equal values do
+ * not serialize the counting.  \a numElements is not limited by the size
+ * of the plan.
+ *
+ * @param[in]  planHandle Handle to a plan created with ::CUDPP_HISTOGRAM
+ * @param[out] h_histogram The count of each bin
+ * @param[in]  h_in The values
+ * @param[in]  numElements Number of values
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppHistogram
+ */
+CUDPP_DLL
+CUDPPResult cudppHistogramHost(CUDPPHandle  planHandle,
+                               unsigned int *h_histogram,
+                               const void   *h_in,
+                               size_t       numElements)
+{
+    CUDPPHistogramPlan *plan = 
+        (CUDPPHistogramPlan*)getPlanPtrFromHandle<CUDPPHistogramPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_HISTOGRAM)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (plan->m_numBins == 0)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        cudppHistogramHostDispatch(h_histogram, h_in, numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Sets one histogram bin per integer key
+ *
+ * Bin i counts the values equal to \a firstKey + i.  Only plans of
+ * integer datatypes accept key bins.
+ *
+ * @param[in] planHandle Handle to a plan created with ::CUDPP_HISTOGRAM
+ * @param[in] numBins Number of bins, at least 1 and less than 2^32-1
+ * @param[in] firstKey Key counted in bin 0
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppHistogram
+ */
+CUDPP_DLL
+CUDPPResult cudppHistogramKeyBins(CUDPPHandle  planHandle,
+                                  unsigned int numBins,
+                                  long long    firstKey)
+{
+    CUDPPHistogramPlan *plan = 
+        (CUDPPHistogramPlan*)getPlanPtrFromHandle<CUDPPHistogramPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_HISTOGRAM)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (plan->m_config.datatype == CUDPP_FLOAT || 
+            plan->m_config.datatype == CUDPP_DOUBLE)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (numBins == 0 || numBins == UINT_MAX)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        plan->setBins(CUDPP_HISTOGRAM_KEYS, numBins, firstKey, 0, 0, 0, 0);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Sets equal-width histogram bins
+ *
+ * Divides [\a lowerLevel, \a upperLevel) into \a numBins bins of equal
+ * width.  Values are converted to double to find their bin.
+ *
+ * @param[in] planHandle Handle to a plan created with ::CUDPP_HISTOGRAM
+ * @param[in] numBins Number of bins, at least 1 and less than 2^32-1
+ * @param[in] lowerLevel Lower edge of the first bin (inclusive)
+ * @param[in] upperLevel Upper edge of the last bin (exclusive), greater
+ *            than \a lowerLevel
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppHistogram
+ */
+CUDPP_DLL
+CUDPPResult cudppHistogramUniformBins(CUDPPHandle  planHandle,
+                                      unsigned int numBins,
+                                      double       lowerLevel,
+                                      double       upperLevel)
+{
+    CUDPPHistogramPlan *plan = 
+        (CUDPPHistogramPlan*)getPlanPtrFromHandle<CUDPPHistogramPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_HISTOGRAM)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numBins == 0 || numBins == UINT_MAX || !(upperLevel > lowerLevel))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        plan->setBins(CUDPP_HISTOGRAM_UNIFORM, numBins, 0, lowerLevel, upperLevel, 0, 0);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Sets histogram bins between given edges
+ *
+ * Bin i counts the values x with \a h_edges[i] <= x < \a h_edges[i+1].
+ * The edges have the datatype of the plan, must be nondecreasing and
+ * are copied, so \a h_edges may be freed after the call.
+ *
+ * @param[in] planHandle Handle to a plan created with ::CUDPP_HISTOGRAM
+ * @param[in] numBins Number of bins, at least 1 and less than 2^32-1
+ * @param[in] h_edges The \a numBins + 1 bin edges, in host memory
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppHistogram
+ */
+CUDPP_DLL
+CUDPPResult cudppHistogramBinEdges(CUDPPHandle  planHandle,
+                                   unsigned int numBins,
+                                   const void   *h_edges)
+{
+    CUDPPHistogramPlan *plan = 
+        (CUDPPHistogramPlan*)getPlanPtrFromHandle<CUDPPHistogramPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_HISTOGRAM)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numBins == 0 || numBins == UINT_MAX || h_edges == NULL ||
+            !histogramValidEdges(h_edges, numBins, plan->m_config.datatype))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        plan->setBins(CUDPP_HISTOGRAM_EDGES, numBins, 0, 0, 0, h_edges,
+                      ((size_t)numBins + 1) * datatypeSize(plan->m_config.datatype));
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Run-length encodes an array
+ *
+ * Replaces each run of equal consecutive values of \a d_in by its value
+ * and its length.  Values are compared as unsigned integers of the
+ * datatype's size, so floating-point runs are runs of identical bits
+ * and the encoding is lossless.  For example:
+ *
+ * \code
+ * d_in         = [ 3 3 3 0 0 7 3 3 ]
+ * d_values     = [ 3 0 7 3 ]
+ * d_runLengths = [ 3 2 1 2 ]
+ * *d_numRuns   = 4
+ * \endcode
+ *
+ * The first value of each run is flagged, the flags are scanned to
+ * number the runs, and the first values are scattered to their run, as
+ * in cudppCompact(); the lengths are the distances between run starts.
+ * cudppRunLengthEncodeHost() produces the same runs on the host.
+ *
+ * @param[in]  planHandle Handle to a plan created with ::CUDPP_RLE
+ * @param[out] d_values The value of each run (up to \a numElements values)
+ * @param[out] d_runLengths The length of each run (up to \a numElements)
+ * @param[out] d_numRuns The number of runs (a size_t in device memory)
+ * @param[in]  d_in The values to encode
+ * @param[in]  numElements Number of values, at most the size of the plan
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppRunLengthDecode, cudppRunLengthEncodeHost, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppRunLengthEncode(CUDPPHandle  planHandle,
+                                 void         *d_values,
+                                 unsigned int *d_runLengths,
+                                 size_t       *d_numRuns,
+                                 const void   *d_in,
+                                 size_t       numElements)
+{
+    CUDPPRunLengthPlan *plan = 
+        (CUDPPRunLengthPlan*)getPlanPtrFromHandle<CUDPPRunLengthPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_RLE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t valueBytes = datatypeSize(plan->m_config.datatype);
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppRunLengthEncode",
+                                 CUDPP_RLE, planHandle, plan->m_launchStream, numElements,
+                                 numElements * valueBytes,
+                                 numElements * (valueBytes + sizeof(unsigned int)));
+
+        cudppRunLengthEncodeDispatch(d_values, d_runLengths, d_numRuns, d_in,
+                                     numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Expands a run-length encoded array
+ *
+ * Writes \a d_runLengths[r] copies of \a d_values[r] for each run r, in
+ * order; runs may be empty.  \a numElements must be the sum of the run
+ * lengths.  The run lengths are scanned to find where each run starts,
+ * the index of each run is written at its start and carried over the
+ * run by a max-scan, and each output value is gathered from its run.
+ *
+ * @param[in]  planHandle Handle to a plan created with ::CUDPP_RLE
+ * @param[out] d_out The decoded values
+ * @param[in]  d_values The value of each run
+ * @param[in]  d_runLengths The length of each run
+ * @param[in]  numRuns Number of runs, at most the size of the plan
+ * @param[in]  numElements Number of decoded values, at most the size of
+ *             the plan
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppRunLengthEncode, cudppRunLengthDecodeHost, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppRunLengthDecode(CUDPPHandle        planHandle,
+                                 void               *d_out,
+                                 const void         *d_values,
+                                 const unsigned int *d_runLengths,
+                                 size_t             numRuns,
+                                 size_t             numElements)
+{
+    CUDPPRunLengthPlan *plan = 
+        (CUDPPRunLengthPlan*)getPlanPtrFromHandle<CUDPPRunLengthPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_RLE)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numRuns > plan->m_numElements || numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t valueBytes = datatypeSize(plan->m_config.datatype);
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppRunLengthDecode",
+                                 CUDPP_RLE, planHandle, plan->m_launchStream, numElements,
+                                 numRuns * (valueBytes + sizeof(unsigned int)),
+                                 numElements * valueBytes);
+
+        cudppRunLengthDecodeDispatch(d_out, d_values, d_runLengths, numRuns,
+                                     numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Reduces the values of each group of equal keys
+ *
+ * Adjacent equal keys form a group; for each group, writes its key, the
+ * reduction of its values by the plan's operator, and the number of its
+ * keys.  With ::CUDPP_OPTION_UNSORTED_KEYS all equal keys form one group
+ * wherever they are, and the groups are written in increasing order of
+ * their key bits.  For example, with ::CUDPP_ADD and sorted keys:
+ *
+ * \code
+ * d_keys       = [ 1 1 4 4 4 9 ]
+ * d_values     = [ 2 3 1 1 1 5 ]
+ * d_keysOut    = [ 1 4 9 ]
+ * d_valuesOut  = [ 5 3 5 ]
+ * d_counts     = [ 2 3 1 ]
+ * *d_numUnique = 3
+ * \endcode
+ *
+ * Keys are 32-bit words, or 64-bit with ::CUDPP_OPTION_64BIT_KEYS, and
+ * are compared bitwise, so any key type of that size can be grouped.  The
+ * first key of each group is flagged, the flags are scanned to number the
+ * groups, and the values are reduced by a segmented scan over the same
+ * flags.  Unsorted keys are first radix sorted with their positions.
+ *
+ * \a d_values and \a d_valuesOut may both be NULL, to count the keys of
+ * each group without a value; \a d_counts may be NULL.  Values require a
+ * plan with an operator (::CUDPP_ADD, ::CUDPP_MULTIPLY, ::CUDPP_MIN or
+ * ::CUDPP_MAX).  Floating-point sums may differ from a sequential sum in
+ * the last bits.
+ *
+ * @param[in]  planHandle Handle to a plan created with ::CUDPP_REDUCE_BY_KEY
+ * @param[out] d_keysOut The key of each group (up to \a numElements keys)
+ * @param[out] d_valuesOut The reduced value of each group, or NULL
+ * @param[out] d_counts The number of keys in each group, or NULL
+ * @param[out] d_numUnique The number of groups (a size_t in device memory)
+ * @param[in]  d_keys The keys
+ * @param[in]  d_values The value of each key, or NULL
+ * @param[in]  numElements Number of keys, at most the size of the plan
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppUnique, cudppReduceByKeyHost, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppReduceByKey(CUDPPHandle  planHandle,
+                             void         *d_keysOut,
+                             void         *d_valuesOut,
+                             unsigned int *d_counts,
+                             size_t       *d_numUnique,
+                             const void   *d_keys,
+                             const void   *d_values,
+                             size_t       numElements)
+{
+    CUDPPReduceByKeyPlan *plan = 
+        (CUDPPReduceByKeyPlan*)getPlanPtrFromHandle<CUDPPReduceByKeyPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_REDUCE_BY_KEY)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements || (d_values == NULL) != (d_valuesOut == NULL))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (d_values != NULL && plan->m_config.op == CUDPP_OPERATOR_INVALID)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t keyBytes = plan->m_b64BitKeys ? sizeof(unsigned long long) : sizeof(unsigned int);
+        size_t valueBytes = d_values ? datatypeSize(plan->m_config.datatype) : 0;
+        size_t countBytes = d_counts ? sizeof(unsigned int) : 0;
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppReduceByKey",
+                                 CUDPP_REDUCE_BY_KEY, planHandle, plan->m_launchStream,
+                                 numElements, numElements * (keyBytes + valueBytes),
+                                 numElements * (keyBytes + valueBytes + countBytes));
+
+        cudppReduceByKeyDispatch(d_keysOut, d_valuesOut, d_counts, d_numUnique,
+                                 d_keys, d_values, numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Writes one key of each group of equal keys
+ *
+ * Removes the repeats of adjacent equal keys, or, with
+ * ::CUDPP_OPTION_UNSORTED_KEYS, writes each distinct key once in
+ * increasing order of its bits.  This is cudppReduceByKey() without
+ * values or counts, so any ::CUDPP_REDUCE_BY_KEY plan can be used,
+ * including one without an operator.
+ *
+ * \code
+ * d_keys       = [ 2 2 5 5 5 8 2 ]
+ * d_keysOut    = [ 2 5 8 2 ]       (sorted keys)
+ * d_keysOut    = [ 2 5 8 ]         (CUDPP_OPTION_UNSORTED_KEYS)
+ * \endcode
+ *
+ * @param[in]  planHandle Handle to a plan created with ::CUDPP_REDUCE_BY_KEY
+ * @param[out] d_keysOut The distinct keys (up to \a numElements keys)
+ * @param[out] d_numUnique The number of distinct keys (a size_t in device memory)
+ * @param[in]  d_keys The keys
+ * @param[in]  numElements Number of keys, at most the size of the plan
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppReduceByKey, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppUnique(CUDPPHandle planHandle,
+                        void        *d_keysOut,
+                        size_t      *d_numUnique,
+                        const void  *d_keys,
+                        size_t      numElements)
+{
+    CUDPPReduceByKeyPlan *plan = 
+        (CUDPPReduceByKeyPlan*)getPlanPtrFromHandle<CUDPPReduceByKeyPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_REDUCE_BY_KEY)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > plan->m_numElements)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        size_t keyBytes = plan->m_b64BitKeys ? sizeof(unsigned long long) : sizeof(unsigned int);
+        CUDPPCallRecorder record(plan->m_planManager, &plan->m_statistics, "cudppUnique",
+                                 CUDPP_REDUCE_BY_KEY, planHandle, plan->m_launchStream,
+                                 numElements, numElements * keyBytes, numElements * keyBytes);
+
+        cudppReduceByKeyDispatch(d_keysOut, NULL, NULL, d_numUnique, d_keys, NULL,
+                                 numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
+/**
+ * @brief Reduces the values of each group of equal host keys
+ *
+ * The host counterpart of cudppReduceByKey() and cudppUnique(), with the
+ * same groups, in the same order, and the same optional arguments.
+ * Unsorted keys are aggregated in hash tables, so there is no sort of the
+ * keys, and the groups are then ordered by key.  When the library is
+ * built with OpenMP, each thread aggregates a contiguous chunk of the keys
+ * in its own table, and the tables are merged by key range on all
+ * threads.  Values are combined in input order within a chunk, then
+ * chunk by chunk.  \a numElements is not limited by the size of the plan.
+ *
+ * @param[in]  planHandle Handle to a plan created with ::CUDPP_REDUCE_BY_KEY
+ * @param[out] h_keysOut The key of each group
+ * @param[out] h_valuesOut The reduced value of each group, or NULL
+ * @param[out] h_counts The number of keys in each group, or NULL
+ * @param[out] numUnique The number of groups
+ * @param[in]  h_keys The keys
+ * @param[in]  h_values The value of each key, or NULL
+ * @param[in]  numElements Number of keys, at most 2^32-1
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppReduceByKey, cudppUnique
+ */
+CUDPP_DLL
+CUDPPResult cudppReduceByKeyHost(CUDPPHandle  planHandle,
+                                 void         *h_keysOut,
+                                 void         *h_valuesOut,
+                                 unsigned int *h_counts,
+                                 size_t       *numUnique,
+                                 const void   *h_keys,
+                                 const void   *h_values,
+                                 size_t       numElements)
+{
+    CUDPPReduceByKeyPlan *plan = 
+        (CUDPPReduceByKeyPlan*)getPlanPtrFromHandle<CUDPPReduceByKeyPlan>(planHandle);
+
+    if (plan != NULL)
+    {
+        if (plan->m_config.algorithm != CUDPP_REDUCE_BY_KEY)
+            return CUDPP_ERROR_INVALID_PLAN;
+        if (numElements > UINT_MAX || (h_values == NULL) != (h_valuesOut == NULL))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (h_values != NULL && plan->m_config.op == CUDPP_OPERATOR_INVALID)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        cudppReduceByKeyHostDispatch(h_keysOut, h_valuesOut, h_counts, numUnique,
+                                     h_keys, h_values, numElements, plan);
+        return CUDPP_SUCCESS;
+    }
+    else
+        return CUDPP_ERROR_INVALID_HANDLE;
+}
+
 /** @} */ // end Algorithm Interface
 /** @} */ // end of publicInterface group
 
@@ -0,0 +1,258 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_bwt.cpp
+ *
+ * @brief Host Burrows-Wheeler transform
+ *
+ * Like the device routine (compress_app.cu), this sorts the cyclic
+ * rotations of a block by prefix doubling, starting from the first four
+ * characters of each rotation and ordering rotations with equal keys by
+ * their start, so it produces the same output and index as the device.
+ */
+
+#include "cudpp.h"
+#include "cudpp_globals.h"
+
+#include <limits.h>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/** A rotation during one prefix doubling round: its pair of ranks and
+  * its start */
+struct BwtHostRotation
+{
+    unsigned long long key;   //!< Rank of the rotation and of the rotation h later
+    unsigned int       start; //!< Start of the rotation
+
+    bool operator<(const BwtHostRotation &other) const
+    {
+        return key < other.key || (key == other.key && start < other.start);
+    }
+};
+
+/** @brief Sort \a n rotations with \a numThreads threads
+  *
+  * Each thread sorts a contiguous range, and the ranges are then merged
+  * in pairs, in parallel, until one is left.
+  *
+  * @returns The array holding the sorted rotations, \a a or \a b
+  */
+static BwtHostRotation* bwtHostSort(BwtHostRotation *a, BwtHostRotation *b,
+                                    size_t n, int numThreads)
+{
+    std::vector<size_t> bounds(numThreads + 1);
+    for (int t = 0; t <= numThreads; t++)
+        bounds[t] = n * t / numThreads;
+
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+    for (int t = 0; t < numThreads; t++)
+        std::sort(a + bounds[t], a + bounds[t + 1]);
+
+    for (int width = 1; width < numThreads; width *= 2)
+    {
+        const int numMerges = (numThreads + 2 * width - 1) / (2 * width);
+#pragma omp parallel for schedule(static, 1) num_threads(numMerges)
+        for (int m = 0; m < numMerges; m++)
+        {
+            const size_t first = bounds[2 * m * width];
+            const size_t middle = bounds[std::min(2 * m * width + width, numThreads)];
+            const size_t last = bounds[std::min(2 * m * width + 2 * width, numThreads)];
+            std::merge(a + first, a + middle, a + middle, a + last, b + first);
+        }
+        std::swap(a, b);
+    }
+    return a;
+}
+
+/** @brief Burrows-Wheeler transform of one block with \a numThreads
+  * threads
+  *
+  * Each prefix doubling round builds the rank pairs, sorts them with
+  * bwtHostSort(), and ranks the sorted pairs with a scan of the flags
+  * that mark new pairs, each step split among the threads.  The rounds
+  * stop when every rank is distinct or whole rotations are compared.
+  *
+  * @returns false if memory cannot be allocated
+  */
+static bool bwtHostBlock(unsigned char *out, int *index, const unsigned char *in,
+                         unsigned int n, int numThreads)
+{
+    std::vector<unsigned int> ranks, counts;
+    std::vector<BwtHostRotation> rotations, buffer;
+    try
+    {
+        ranks.resize(n);
+        counts.resize(numThreads + 1);
+        rotations.resize(n);
+        buffer.resize(n);
+    }
+    catch (std::bad_alloc &)
+    {
+        return false;
+    }
+
+    // the first four characters of each rotation, packed into a word
+#pragma omp parallel for num_threads(numThreads)
+    for (int i = 0; i < (int)n; i++)
+    {
+        unsigned int word = 0;
+        unsigned int j = i;
+        for (int c = 0; c < 4; ++c)
+        {
+            word = (word << 8) | in[j];
+            j = (j + 1 == n) ? 0 : j + 1;
+        }
+        ranks[i] = word;
+    }
+
+    BwtHostRotation *sorted = &rotations[0];
+    for (size_t h = 4; ; h *= 2)
+    {
+        const unsigned int offset = (unsigned int)(h % n);
+#pragma omp parallel for num_threads(numThreads)
+        for (int i = 0; i < (int)n; i++)
+        {
+            unsigned int j = i + offset;
+            if (j >= n) j -= n;
+            rotations[i].key = ((unsigned long long)ranks[i] << 32) | ranks[j];
+            rotations[i].start = i;
+        }
+
+        sorted = bwtHostSort(&rotations[0], &buffer[0], n, numThreads);
+        if (sorted != &rotations[0])
+            rotations.swap(buffer);
+        sorted = &rotations[0];
+
+        if (2 * h >= n)
+            break;
+
+        // the new rank of a rotation is the number of distinct pairs up
+        // to it: count them per range, scan the counts, then rank
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+        for (int t = 0; t < numThreads; t++)
+        {
+            unsigned int count = 0;
+            for (size_t k = (size_t)n * t / numThreads; k < (size_t)n * (t + 1) / numThreads; k++)
+                count += (k == 0 || sorted[k].key != sorted[k - 1].key);
+            counts[t + 1] = count;
+        }
+        for (int t = 0; t < numThreads; t++)
+            counts[t + 1] += counts[t];
+        if (counts[numThreads] == n)
+            break;
+
+#pragma omp parallel for schedule(static, 1) num_threads(numThreads)
+        for (int t = 0; t < numThreads; t++)
+        {
+            unsigned int rank = counts[t];
+            for (size_t k = (size_t)n * t / numThreads; k < (size_t)n * (t + 1) / numThreads; k++)
+            {
+                rank += (k == 0 || sorted[k].key != sorted[k - 1].key);
+                ranks[sorted[k].start] = rank;
+            }
+        }
+    }
+
+#pragma omp parallel for num_threads(numThreads)
+    for (int k = 0; k < (int)n; k++)
+    {
+        const unsigned int start = sorted[k].start;
+        if (start == 0)
+            *index = k;
+        out[k] = in[(start == 0) ? n - 1 : start - 1];
+    }
+    return true;
+}
+
+/** @brief Burrows-Wheeler transform blocks of an array in host memory
+  *
+  * The host counterpart of cudppBurrowsWheelerTransform().  The input is
+  * split into blocks of \a blockSize symbols (the last may be shorter),
+  * each transformed independently with the same output and index as the
+  * device.  When the library is built with OpenMP, blocks are
+  * transformed in parallel when there are at least as many as threads;
+  * otherwise the blocks are transformed in turn, each with all threads,
+  * which share the sorts and scans of every prefix doubling round.  A
+  * thread works on at least ::BWT_HOST_GRAIN symbols of a block.
+  *
+  * @param[out] out The transformed blocks
+  * @param[out] indices The index of each block: the position at which
+  *             the block itself sorts among its rotations
+  * @param[in]  in The symbols
+  * @param[in]  numElements Number of symbols
+  * @param[in]  blockSize Symbols per block, at most 2^31-1, or 0 to
+  *             transform the whole input as one block
+  * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION for a block of more than
+  *          2^31-1 symbols, CUDPP_ERROR_INSUFFICIENT_RESOURCES if memory
+  *          cannot be allocated, otherwise CUDPP_SUCCESS
+  *
+  * @see cudppBurrowsWheelerTransform, cudppMoveToFrontTransformHost
+  */
+CUDPP_DLL
+CUDPPResult cudppBurrowsWheelerTransformHost(unsigned char       *out,
+                                             int                 *indices,
+                                             const unsigned char *in,
+                                             size_t              numElements,
+                                             size_t              blockSize)
+{
+    if (blockSize == 0)
+        blockSize = numElements;
+    if (numElements == 0)
+        return CUDPP_SUCCESS;
+    if (blockSize > INT_MAX || out == NULL || indices == NULL || in == NULL)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    const size_t numBlocks = (numElements + blockSize - 1) / blockSize;
+    int maxThreads = 1;
+#ifdef _OPENMP
+    maxThreads = omp_get_max_threads();
+#endif
+
+    bool succeeded = true;
+    if (numBlocks >= (size_t)maxThreads)
+    {
+#pragma omp parallel for schedule(dynamic, 1) num_threads(maxThreads) reduction(&&: succeeded)
+        for (int b = 0; b < (int)numBlocks; b++)
+        {
+            const size_t begin = b * blockSize;
+            const size_t length = std::min(blockSize, numElements - begin);
+            succeeded = bwtHostBlock(out + begin, indices + b, in + begin,
+                                     (unsigned int)length, 1) && succeeded;
+        }
+    }
+    else
+    {
+        for (size_t b = 0; b < numBlocks && succeeded; b++)
+        {
+            const size_t begin = b * blockSize;
+            const size_t length = std::min(blockSize, numElements - begin);
+            const int numThreads = (int)std::min((size_t)maxThreads,
+                                                 std::max((size_t)1, length / BWT_HOST_GRAIN));
+            succeeded = bwtHostBlock(out + begin, indices + b, in + begin,
+                                     (unsigned int)length, numThreads);
+        }
+    }
+
+    return succeeded ? CUDPP_SUCCESS : CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -34,4 +34,12 @@ void cudppCompactDispatch(void                   *d_out,
                           size_t                 numElements,
                           const CUDPPCompactPlan *plan);
 
+extern "C"
+void cudppPartitionDispatch(void                   *d_out, 
+                            size_t                 *d_numValidElements,
+                            const void             *d_in, 
+                            const unsigned int     *d_isValid,
+                            size_t                 numElements,
+                            const CUDPPCompactPlan *plan);
+
 #endif // _CUDPP_COMPACT_H_
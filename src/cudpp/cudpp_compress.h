@@ -21,6 +21,8 @@
 class CUDPPCompressPlan;
 class CUDPPBwtPlan;
 class CUDPPMtfPlan;
+class CUDPPHuffmanPlan;
+struct huffman_table_entry;
 
 // Compress
 extern "C"
@@ -67,4 +69,49 @@ void cudppMtfDispatch(void *d_mtfIn,
                       size_t numElements,
                       const CUDPPMtfPlan *plan);
 
+extern "C"
+void cudppInverseMtfDispatch(void *d_mtfIn,
+                             void *d_mtfOut,
+                             size_t numElements,
+                             const CUDPPMtfPlan *plan);
+
+// Huffman code construction (host, cudpp_huffman.cpp)
+void huffmanCodeLengths(unsigned char      *codeLengths,
+                        const unsigned int *histogram,
+                        unsigned int       alphabetSize);
+
+void huffmanCanonicalCodes(unsigned int        *codes,
+                           const unsigned char *codeLengths,
+                           unsigned int        alphabetSize);
+
+bool huffmanDecodeTables(huffman_table_entry *table,
+                         unsigned int        *firstCode,
+                         unsigned int        *firstIndex,
+                         unsigned short      *sortedSymbols,
+                         const unsigned char *codeLengths,
+                         unsigned int        alphabetSize);
+
+// Huffman
+extern "C"
+void allocHuffmanStorage(CUDPPHuffmanPlan* plan);
+
+extern "C"
+void freeHuffmanStorage(CUDPPHuffmanPlan* plan);
+
+extern "C"
+void cudppHuffmanEncodeDispatch(unsigned int  *d_compressed,
+                                unsigned char *d_codeLengths,
+                                unsigned int  *d_subBlockOffsets,
+                                const void    *d_in,
+                                size_t        numElements,
+                                const CUDPPHuffmanPlan *plan);
+
+extern "C"
+CUDPPResult cudppHuffmanDecodeDispatch(void                *d_out,
+                                       const unsigned int  *d_compressed,
+                                       const unsigned char *d_codeLengths,
+                                       const unsigned int  *d_subBlockOffsets,
+                                       size_t              numElements,
+                                       const CUDPPHuffmanPlan *plan);
+
 #endif // _CUDPP_COMPRESS_H_
@@ -0,0 +1,38 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt 
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_eulertour.h
+*
+* @brief Euler tour tree functionality header file - contains CUDPP interface (not public)
+*/
+
+#ifndef _CUDPP_EULERTOUR_H_
+#define _CUDPP_EULERTOUR_H_
+
+class CUDPPEulerTourPlan;
+
+extern "C"
+void allocEulerTourStorage(CUDPPEulerTourPlan *plan);
+
+extern "C"
+void freeEulerTourStorage(CUDPPEulerTourPlan *plan);
+
+extern "C"
+void cudppEulerTourDispatch(int          *d_depth,
+                            unsigned int *d_preorder,
+                            unsigned int *d_subtreeSize,
+                            unsigned int *d_eulerTour,
+                            const int    *d_parent,
+                            size_t       numNodes,
+                            const CUDPPEulerTourPlan *plan);
+
+#endif // _CUDPP_EULERTOUR_H_
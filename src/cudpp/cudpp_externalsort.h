@@ -0,0 +1,31 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+#ifndef   __EXTERNALSORT_H__
+#define   __EXTERNALSORT_H__
+
+#include "cudpp_globals.h"
+#include "cudpp.h"
+#include "cudpp_plan.h"
+
+CUDPPResult cudppExternalSortDispatch(CUDPPExternalSortReader reader,
+                                      void                    *readerData,
+                                      CUDPPExternalSortWriter writer,
+                                      void                    *writerData,
+                                      const char              *tempDir,
+                                      const CUDPPPlan         *plan);
+
+CUDPPResult cudppExternalSortFileDispatch(const char      *keysIn,
+                                          const char      *valuesIn,
+                                          const char      *keysOut,
+                                          const char      *valuesOut,
+                                          const char      *tempDir,
+                                          const CUDPPPlan *plan);
+
+#endif // __EXTERNALSORT_H__
@@ -25,6 +25,12 @@ const int SORT_CTA_SIZE = 256;                   /**< Number of threads per CTA
 const int SCAN_CTA_SIZE = 128;                   /**< Number of threads in a CTA */
 const int REDUCE_CTA_SIZE = 256;                 /**< Number of threads in a CTA */
 
+/** Maximum number of CTAs of one deterministic reduction pass.  Like the
+  * CTA size it is a constant, not a property of the device, so the order in
+  * which CUDPP_OPTION_DETERMINISTIC reductions combine elements depends only
+  * on the number of elements. */
+const unsigned int REDUCE_DETERMINISTIC_MAX_BLOCKS = 65535;
+
 const int LOG_SCAN_CTA_SIZE = 7;                 /**< log_2(CTA_SIZE) */
 
 const int WARP_SIZE = 32;                        /**< Number of threads in a warp */
@@ -35,69 +41,95 @@ const int LOG_SIZEOF_FLOAT = 2;                  /**< log_2(sizeof(float)) */
 const int SCAN_ELTS_PER_THREAD = 8;              /**< Number of elements per scan thread */
 const int SEGSCAN_ELTS_PER_THREAD = 8;           /**< Number of elements per segmented scan thread */
 
+/** Maximum number of elements processed by a single pass of the scan and
+  * compact kernels (one grid of at most 65535 CTAs).  Longer arrays are
+  * processed in segments of this size, so kernel-level indices stay 32-bit. */
+const unsigned int SCAN_MAX_SEGMENT_SIZE = SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE * 65535;
+
+// External sort
+#define EXTSORT_MIN_MERGE_BLOCK 4096             /**< Minimum elements per run buffer in the external merge */
+#define EXTSORT_MAX_MERGE_RUNS  64               /**< Most runs merged at once (two open files each) by the external merge */
+
+// Sparse matrix-vector multiply
+#define SPMV_CTA_SIZE                   128      /**< Threads per CTA for the sparse matrix-vector kernels */
+#define SPMV_ROW_PER_THREAD_MAX_LENGTH  4        /**< Mean row length below which each row gets one thread */
+#define SPMV_SKEWED_ROW_RATIO           16       /**< Longest/mean row length ratio above which merge path is used */
+#define SPMV_MERGE_ITEMS_PER_THREAD     7        /**< Merge-path items (row ends plus nonzeros) per thread */
+#define SPMM_VECTORS_PER_THREAD         4        /**< Right-hand sides accumulated per thread in SpMM */
+#define SPMM_CARRY_VECTORS              (WARP_SIZE * SPMM_VECTORS_PER_THREAD) /**< Right-hand sides per pass over the long-row pieces in SpMM */
+#define SPMM_ROW_PIECE_LENGTH           1024     /**< Nonzeros per piece of a long row of a skewed matrix in SpMM */
+#define SPMV_INDEX_BLOCK_SIZE           256      /**< Nonzeros sharing a base column with 16-bit column indices */
+
+// Sparse matrix conversion
+#define SPARSE_CONVERT_CTA_SIZE         256      /**< Threads per CTA for the sparse matrix conversion kernels */
+
+// Sparse matrix files
+#define SPARSE_PARSE_CHUNK_SIZE (1 << 20)        /**< Minimum bytes of a Matrix Market file parsed by one thread */
+
+// List ranking
+#define LISTRANK_CTA_SIZE      128               /**< Threads per CTA for the list ranking kernels */
+#define LISTRANK_SUBLIST_SIZE  32                /**< Mean nodes per sublist; each level of the ranking is this much shorter */
+#define LISTRANK_MAX_LEVELS    16                /**< Maximum levels of sublists (7 suffice for 2^31 nodes) */
+
+// Euler tour
+#define EULER_TOUR_CTA_SIZE    256               /**< Threads per CTA for the Euler tour kernels */
+
+// Histogram
+#define HISTOGRAM_CTA_SIZE       128             /**< Most threads per CTA of the shared-memory histogram kernel */
+#define HISTOGRAM_SHARED_BINS    256             /**< Most bins counted in shared memory; more bins are counted by sorting */
+#define HISTOGRAM_COUNTER_BYTES  8192            /**< Shared memory of the 8-bit per-thread sub-histograms of a CTA */
+#define HISTOGRAM_MAX_BLOCKS     256             /**< Most CTAs of the shared-memory histogram kernel */
+#define HISTOGRAM_HOST_LANES     4               /**< Interleaved sub-histograms of the host histogram */
+#define HISTOGRAM_HOST_GRAIN     (1 << 16)       /**< Minimum values counted by one thread of the host histogram */
+#define HISTOGRAM_REDUCE_CTA_SIZE 256            /**< Threads per CTA for the sort-based and reduction histogram kernels */
+
+// Run-length encoding
+#define RLE_CTA_SIZE           256               /**< Threads per CTA for the run-length encoding kernels */
+
+// Reduce by key
+#define REDUCE_BY_KEY_CTA_SIZE 256               /**< Threads per CTA for the reduce-by-key kernels */
+#define REDUCE_BY_KEY_HOST_LOAD_FACTOR 2         /**< Hash table slots per key for host aggregation of unsorted keys */
+#define REDUCE_BY_KEY_HOST_GRAIN (1 << 16)     /**< Minimum keys aggregated by one thread of the host reduce-by-key */
+#define REDUCE_BY_KEY_HOST_OVERSAMPLING 64       /**< Sampled keys per key range when merging host reduce-by-key tables */
+
+// Tridiagonal
+#define TRIDIAGONAL_THOMAS_MAX_SIZE  64          /**< Largest systems solved by one thread each (interleaved Thomas) */
+#define TRIDIAGONAL_THOMAS_CTA_SIZE  128         /**< Maximum systems per CTA for the interleaved Thomas solver */
+#define TRIDIAGONAL_CR_THOMAS_SIZE   32          /**< Cyclic reduction stops at this many equations and switches to Thomas */
+#define TRIDIAGONAL_CR_CTA_SIZE      256         /**< Maximum threads per CTA for the CR-Thomas solver */
+#define TRIDIAGONAL_PARTITION_SIZE   64          /**< Equations per partition in the partitioned solver for large systems */
+#define TRIDIAGONAL_PARTITION_CTA_SIZE 128       /**< Threads per CTA for the partitioned solver */
+#define TRIDIAGONAL_HOST_LANES       8           /**< Systems solved together, interleaved, by the host Thomas solver */
+#define TRIDIAGONAL_HOST_GRAIN       (1 << 15)   /**< Minimum equations solved by one thread of the host solver */
+
 // BWT
-#define BWT_NUMPARTITIONS 1024
-#define BWT_CTA_BLOCK 128
-#define BWT_BLOCKSORT_SIZE 1024
-#define BWT_CTASIZE_simple 256
-#define BWT_DEPTH_simple 2
-#define BWT_CTASIZE_multi 256
-#define BWT_DEPTH_multi 2
-#define BWT_INTERSECT_B_BLOCK_SIZE_simple 1024
-
-#define BWT_SIZE                            BWT_BLOCKSORT_SIZE*BWT_NUMPARTITIONS
-#define BWT_INTERSECT_A_BLOCK_SIZE_simple   BWT_DEPTH_simple*BWT_CTASIZE_simple
-#define BWT_INTERSECT_A_BLOCK_SIZE_multi    BWT_DEPTH_multi*BWT_CTASIZE_multi
-#define BWT_INTERSECT_B_BLOCK_SIZE_multi    2*BWT_DEPTH_multi*BWT_CTASIZE_multi
+#define BWT_CTA_SIZE   256                       /**< Default threads per CTA for the BWT kernels (see cudppAutotune()) */
+#define BWT_MAX_SIZE   (1 << 26)                 /**< Largest BWT block: 64 MB */
+#define BWT_HOST_GRAIN (1 << 16)                 /**< Minimum symbols of a block sorted by one thread of the host BWT */
 
 // MTF
-#define MTF_PER_THREAD      64
-#define MTF_THREADS_BLOCK   64
-#define MTF_LIST_SIZE       25
+#define MTF_CTA_SIZE            64               /**< Threads per CTA for the MTF kernels (one chunk per thread) */
+#define MTF_DEFAULT_CHUNK_SIZE  128              /**< Default symbols per chunk; see cudppMoveToFrontChunkSize() */
+#define MTF_SCAN_GROUP_SIZE     16               /**< Chunk states combined per thread at each level of the state scan */
+#define MTF_HOST_GRAIN          (1 << 16)        /**< Minimum symbols transformed by one thread of the host MTF */
 
 // Huffman
-#define HUFF_THREADS_PER_BLOCK_HIST     64
-#define HUFF_WORK_PER_THREAD_HIST       512
-#define HUFF_THREADS_PER_BLOCK          128
-#define HUFF_WORK_PER_THREAD            32
-#define HUFF_NUM_CHARS                  257
-
-#define HUFF_BLOCK_CHARS (HUFF_THREADS_PER_BLOCK*HUFF_WORK_PER_THREAD)
-#define HUFF_CODE_BYTES ( ((HUFF_BLOCK_CHARS*12)%32 == 0) ? (HUFF_BLOCK_CHARS*12/32) : (HUFF_BLOCK_CHARS*12/32+1) )
-
-#define HUFF_FALSE   0
-#define HUFF_TRUE    1
-#define HUFF_NONE    -1
-#define HUFF_COUNT_T_MAX     UINT_MAX    /* based on count_t being unsigned int */
-#define HUFF_COMPOSITE_NODE      -1      /* node represents multiple characters */
-#define HUFF_EOF_CHAR    (HUFF_NUM_CHARS - 1) /* index used for EOF */
-
-#define CUDPP_CHAR_BIT 8
-#define BITS_TO_CHARS(bits)   ((((bits) - 1) / 8) + 1)
-#define MS_BIT                (1 << (8 - 1))
-#define BIT_CHAR(bit)         ((bit) / CUDPP_CHAR_BIT)
-#define BIT_IN_CHAR(bit)      (1 << (8 - 1 - ((bit)  % 8)))
-
-struct encoded {
-    unsigned int block_size;            // Block size in words
-    unsigned int code[HUFF_CODE_BYTES]; // Blocks are stored as unsigned ints
-};
-
-struct huffman_code {
-    unsigned char code[32];
-    unsigned char codeLen;
-    unsigned int numBits;
-};
-
-struct my_huffman_node_t
+#define HUFF_CTA_SIZE       128                  /**< Default threads per CTA for the Huffman kernels, one sub-block per thread (see cudppAutotune()) */
+#define HUFF_TABLE_BITS     10                   /**< Bits of the stream looked up at once by the table-driven decoder */
+#define HUFF_TABLE_SYMBOLS  4                    /**< Most symbols decoded by one table lookup */
+
+/** @brief Entry of the table-driven Huffman decoder
+  *
+  * Indexed by the next ::HUFF_TABLE_BITS bits of the stream, an entry 
+  * holds the symbols whose codes lie entirely within those bits.  Codes
+  * longer than ::HUFF_TABLE_BITS have no entry (numSymbols is 0) and are
+  * decoded from the first canonical code of each length.
+  */
+struct huffman_table_entry
 {
-    int value;          /* character(s) represented by this entry */
-    unsigned int count;      /* number of occurrences of value (probability) */
-
-    char ignore;        /* TRUE -> already handled or no need to handle */
-    int level;          /* depth in tree (root is 0) */
-        unsigned int iter;
-        int left, right, parent;
+    unsigned short symbols[HUFF_TABLE_SYMBOLS]; //!< The symbols decoded, in order
+    unsigned char  numSymbols;                  //!< Number of symbols decoded
+    unsigned char  numBits;                     //!< Bits of the stream they use
 };
 
 #endif // __CUDPP_GLOBALS_H__
@@ -0,0 +1,48 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+* @file
+* cudpp_histogram.h
+*
+* @brief Histogram functionality header file - contains CUDPP interface (not public)
+*/
+
+#ifndef _CUDPP_HISTOGRAM_H_
+#define _CUDPP_HISTOGRAM_H_
+
+#include "cudpp.h"
+
+class CUDPPHistogramPlan;
+
+extern "C"
+void allocHistogramStorage(CUDPPHistogramPlan *plan);
+
+extern "C"
+void freeHistogramStorage(CUDPPHistogramPlan *plan);
+
+extern "C"
+bool histogramValidEdges(const void    *h_edges,
+                         unsigned int  numBins,
+                         CUDPPDatatype datatype);
+
+extern "C"
+void cudppHistogramDispatch(unsigned int             *d_histogram,
+                            const void               *d_in,
+                            size_t                   numElements,
+                            const CUDPPHistogramPlan *plan);
+
+extern "C"
+void cudppHistogramHostDispatch(unsigned int             *h_histogram,
+                                const void               *h_in,
+                                size_t                   numElements,
+                                const CUDPPHistogramPlan *plan);
+
+#endif // _CUDPP_HISTOGRAM_H_
@@ -0,0 +1,456 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_huffman.cpp
+ *
+ * @brief Host routines to build canonical Huffman codes, and the host
+ * Huffman encoder and decoder
+ *
+ * The device encoder (compress_app.cu) builds its codes with these
+ * routines, so the host and device encoders produce identical streams.
+ */
+
+#include "cudpp.h"
+#include "cudpp_globals.h"
+#include "cudpp_compress.h"
+
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+#include <vector>
+
+/** @brief Compare symbols by count, for sorting the leaves of package-merge */
+struct HuffmanCountLess
+{
+    const unsigned int *histogram;
+    bool operator()(unsigned int a, unsigned int b) const
+    {
+        return histogram[a] < histogram[b];
+    }
+};
+
+/** @brief Compute length-limited Huffman code lengths by package-merge
+  *
+  * Finds the code lengths, at most ::CUDPP_HUFFMAN_MAX_CODE_LENGTH bits,
+  * that minimize the encoded size (Larmore and Hirschberg's package-merge).
+  * The list of depth d merges the symbols, lightest first, with packages
+  * of adjacent pairs of the list of depth d + 1.  The 2n - 2 lightest
+  * items of the depth 1 list are the optimal choice of n - 1 packages and
+  * their leaves; each symbol's length is the number of lists in which it
+  * is chosen.  Since the symbols of every list are merged lightest first,
+  * the chosen symbols of a list are always its lightest, so only the
+  * number of symbols in each prefix is needed.  Symbols that do not occur
+  * get no code; a single symbol gets a 1-bit code.
+  *
+  * @param[out] codeLengths The length of the code of each symbol, 0 if none
+  * @param[in]  histogram   The number of occurrences of each symbol
+  * @param[in]  alphabetSize Number of symbols, at most 65536
+  */
+void huffmanCodeLengths(unsigned char      *codeLengths,
+                        const unsigned int *histogram,
+                        unsigned int       alphabetSize)
+{
+    memset(codeLengths, 0, alphabetSize);
+
+    std::vector<unsigned int> leaves;
+    for (unsigned int s = 0; s < alphabetSize; ++s)
+    {
+        if (histogram[s] > 0)
+            leaves.push_back(s);
+    }
+    size_t n = leaves.size();
+    if (n == 0)
+        return;
+    if (n == 1)
+    {
+        codeLengths[leaves[0]] = 1;
+        return;
+    }
+
+    HuffmanCountLess less = { histogram };
+    std::stable_sort(leaves.begin(), leaves.end(), less);
+
+    const int L = CUDPP_HUFFMAN_MAX_CODE_LENGTH;
+
+    // isLeaf[d - 1] flags the symbols of the depth d list; weights of the
+    // list below are kept while each list is merged
+    std::vector<std::vector<unsigned char> > isLeaf(L);
+    std::vector<unsigned long long> below(n), weights;
+    for (size_t i = 0; i < n; ++i)
+        below[i] = histogram[leaves[i]];
+    isLeaf[L - 1].assign(n, 1);
+
+    for (int d = L - 1; d >= 1; --d)
+    {
+        size_t numPackages = below.size() / 2;
+        weights.clear();
+        isLeaf[d - 1].clear();
+        size_t i = 0, p = 0;
+        while (i < n || p < numPackages)
+        {
+            unsigned long long package = (p < numPackages) ?
+                below[2 * p] + below[2 * p + 1] : 0;
+            if (p == numPackages || (i < n && histogram[leaves[i]] <= package))
+            {
+                weights.push_back(histogram[leaves[i++]]);
+                isLeaf[d - 1].push_back(1);
+            }
+            else
+            {
+                weights.push_back(package);
+                isLeaf[d - 1].push_back(0);
+                p++;
+            }
+        }
+        below.swap(weights);
+    }
+
+    size_t numChosen = 2 * n - 2;
+    for (int d = 1; d <= L && numChosen > 0; ++d)
+    {
+        size_t numLeaves = 0;
+        for (size_t k = 0; k < numChosen; ++k)
+            numLeaves += isLeaf[d - 1][k];
+        for (size_t k = 0; k < numLeaves; ++k)
+            codeLengths[leaves[k]]++;
+        numChosen = 2 * (numChosen - numLeaves);
+    }
+}
+
+/** @brief Assign canonical codes from code lengths
+  *
+  * Codes of each length are consecutive, in symbol order, and shorter
+  * codes come first, so the code lengths alone determine the codes.
+  *
+  * @param[out] codes The code of each symbol, in its low codeLengths[s] bits
+  * @param[in]  codeLengths The length of the code of each symbol, 0 if none
+  * @param[in]  alphabetSize Number of symbols
+  */
+void huffmanCanonicalCodes(unsigned int        *codes,
+                           const unsigned char *codeLengths,
+                           unsigned int        alphabetSize)
+{
+    unsigned int count[CUDPP_HUFFMAN_MAX_CODE_LENGTH + 1] = { 0 };
+    unsigned int nextCode[CUDPP_HUFFMAN_MAX_CODE_LENGTH + 1];
+    for (unsigned int s = 0; s < alphabetSize; ++s)
+        count[codeLengths[s]]++;
+
+    unsigned int code = 0;
+    count[0] = 0;
+    for (int len = 1; len <= CUDPP_HUFFMAN_MAX_CODE_LENGTH; ++len)
+    {
+        code = (code + count[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+
+    for (unsigned int s = 0; s < alphabetSize; ++s)
+        codes[s] = codeLengths[s] ? nextCode[codeLengths[s]]++ : 0;
+}
+
+/** @brief Build the tables of the table-driven Huffman decoder
+  *
+  * The first canonical code of each length and the symbols sorted by
+  * code length decode any code; the lookup table decodes up to
+  * ::HUFF_TABLE_SYMBOLS codes in the next ::HUFF_TABLE_BITS bits at once.
+  *
+  * @param[out] table 2^::HUFF_TABLE_BITS lookup table entries
+  * @param[out] firstCode The first code of each length (::CUDPP_HUFFMAN_MAX_CODE_LENGTH + 2 entries)
+  * @param[out] firstIndex The first sorted symbol of each length (::CUDPP_HUFFMAN_MAX_CODE_LENGTH + 2 entries)
+  * @param[out] sortedSymbols The symbols with a code, by length then symbol
+  * @param[in]  codeLengths The length of the code of each symbol, 0 if none
+  * @param[in]  alphabetSize Number of symbols
+  * @returns false if the code lengths are not those of a prefix code
+  *          (too long, over-subscribed, or no codes at all)
+  */
+bool huffmanDecodeTables(huffman_table_entry *table,
+                         unsigned int        *firstCode,
+                         unsigned int        *firstIndex,
+                         unsigned short      *sortedSymbols,
+                         const unsigned char *codeLengths,
+                         unsigned int        alphabetSize)
+{
+    const int L = CUDPP_HUFFMAN_MAX_CODE_LENGTH;
+    unsigned int count[CUDPP_HUFFMAN_MAX_CODE_LENGTH + 2] = { 0 };
+    for (unsigned int s = 0; s < alphabetSize; ++s)
+    {
+        if (codeLengths[s] > L)
+            return false;
+        count[codeLengths[s]]++;
+    }
+
+    // Kraft: a prefix code uses at most the whole code space
+    unsigned long long space = 0;
+    for (int len = 1; len <= L; ++len)
+        space += (unsigned long long)count[len] << (L - len);
+    if (space == 0 || space > (1ull << L))
+        return false;
+
+    unsigned int code = 0;
+    firstIndex[0] = 0;
+    firstCode[0] = 0;
+    count[0] = 0;
+    for (int len = 1; len <= L + 1; ++len)
+    {
+        code = (code + count[len - 1]) << 1;
+        firstCode[len] = code;
+        firstIndex[len] = firstIndex[len - 1] + count[len - 1];
+    }
+
+    std::vector<unsigned int> next(firstIndex, firstIndex + L + 1);
+    for (unsigned int s = 0; s < alphabetSize; ++s)
+    {
+        if (codeLengths[s])
+            sortedSymbols[next[codeLengths[s]]++] = (unsigned short)s;
+    }
+
+    for (unsigned int w = 0; w < (1u << HUFF_TABLE_BITS); ++w)
+    {
+        huffman_table_entry &entry = table[w];
+        entry.numSymbols = 0;
+        entry.numBits = 0;
+        while (entry.numSymbols < HUFF_TABLE_SYMBOLS)
+        {
+            int left = HUFF_TABLE_BITS - entry.numBits;
+            int len = 1;
+            for (; len <= left; ++len)
+            {
+                unsigned int c = (w >> (left - len)) & ((1u << len) - 1);
+                if (c - firstCode[len] < firstIndex[len + 1] - firstIndex[len])
+                {
+                    entry.symbols[entry.numSymbols++] =
+                        sortedSymbols[firstIndex[len] + c - firstCode[len]];
+                    entry.numBits += len;
+                    break;
+                }
+            }
+            if (len > left)
+                break;
+        }
+    }
+
+    return true;
+}
+
+/** @brief Number of symbols of a Huffman alphabet, or 0 if unsupported */
+static unsigned int huffmanAlphabetSize(CUDPPDatatype datatype)
+{
+    switch (datatype)
+    {
+    case CUDPP_UCHAR:  return 256;
+    case CUDPP_USHORT: return 65536;
+    default:           return 0;
+    }
+}
+
+template <class T>
+void huffmanEncodeHost(unsigned int  *compressed,
+                       unsigned char *codeLengths,
+                       unsigned int  *subBlockOffsets,
+                       const T       *in,
+                       size_t        numElements,
+                       unsigned int  alphabetSize)
+{
+    std::vector<unsigned int> histogram(alphabetSize, 0), codes(alphabetSize);
+    for (size_t i = 0; i < numElements; ++i)
+        histogram[in[i]]++;
+    huffmanCodeLengths(codeLengths, &histogram[0], alphabetSize);
+    huffmanCanonicalCodes(&codes[0], codeLengths, alphabetSize);
+
+    size_t numSubBlocks =
+        (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+    unsigned int numWords = 0;
+    for (size_t b = 0; b < numSubBlocks; ++b)
+    {
+        subBlockOffsets[b] = numWords;
+
+        // codes are written most significant bit first; each sub-block
+        // starts on a new word
+        unsigned long long bits = 0;
+        unsigned int numBits = 0;
+        size_t end = std::min(numElements, (b + 1) * CUDPP_HUFFMAN_SUBBLOCK_SIZE);
+        for (size_t i = b * CUDPP_HUFFMAN_SUBBLOCK_SIZE; i < end; ++i)
+        {
+            bits = (bits << codeLengths[in[i]]) | codes[in[i]];
+            numBits += codeLengths[in[i]];
+            if (numBits >= 32)
+            {
+                numBits -= 32;
+                compressed[numWords++] = (unsigned int)(bits >> numBits);
+                bits &= (1ull << numBits) - 1;
+            }
+        }
+        if (numBits > 0)
+            compressed[numWords++] = (unsigned int)(bits << (32 - numBits));
+    }
+    subBlockOffsets[numSubBlocks] = numWords;
+}
+
+template <class T>
+bool huffmanDecodeHost(T                   *out,
+                       const unsigned int  *compressed,
+                       const unsigned char *codeLengths,
+                       const unsigned int  *subBlockOffsets,
+                       size_t              numElements,
+                       unsigned int        alphabetSize)
+{
+    std::vector<huffman_table_entry> table(1 << HUFF_TABLE_BITS);
+    unsigned int firstCode[CUDPP_HUFFMAN_MAX_CODE_LENGTH + 2];
+    unsigned int firstIndex[CUDPP_HUFFMAN_MAX_CODE_LENGTH + 2];
+    std::vector<unsigned short> sortedSymbols(alphabetSize);
+    if (!huffmanDecodeTables(&table[0], firstCode, firstIndex, &sortedSymbols[0],
+                             codeLengths, alphabetSize))
+        return false;
+
+    size_t numSubBlocks =
+        (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+    for (size_t b = 0; b < numSubBlocks; ++b)
+    {
+        unsigned int word = subBlockOffsets[b];
+        unsigned int endWord = subBlockOffsets[b + 1];
+        if (endWord < word)
+            return false;
+
+        // the next 'numBits' bits of the stream, at the top of 'bits'
+        unsigned long long bits = 0;
+        unsigned int numBits = 0;
+        size_t i = b * CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+        size_t end = std::min(numElements, i + CUDPP_HUFFMAN_SUBBLOCK_SIZE);
+        while (i < end)
+        {
+            while (numBits <= 32)
+            {
+                unsigned long long w = (word < endWord) ? compressed[word] : 0;
+                word++;
+                bits |= w << (32 - numBits);
+                numBits += 32;
+            }
+
+            const huffman_table_entry &entry =
+                table[(unsigned int)(bits >> (64 - HUFF_TABLE_BITS))];
+            if (entry.numSymbols > 0)
+            {
+                for (int k = 0; k < entry.numSymbols && i < end; ++k)
+                    out[i++] = (T)entry.symbols[k];
+                bits <<= entry.numBits;
+                numBits -= entry.numBits;
+                continue;
+            }
+
+            unsigned int window = (unsigned int)(bits >> 32);
+            int len = HUFF_TABLE_BITS + 1;
+            for (; len <= CUDPP_HUFFMAN_MAX_CODE_LENGTH; ++len)
+            {
+                unsigned int c = window >> (32 - len);
+                if (c - firstCode[len] < firstIndex[len + 1] - firstIndex[len])
+                {
+                    out[i++] = (T)sortedSymbols[firstIndex[len] + c - firstCode[len]];
+                    bits <<= len;
+                    numBits -= len;
+                    break;
+                }
+            }
+            if (len > CUDPP_HUFFMAN_MAX_CODE_LENGTH)
+                return false; // not a code
+        }
+    }
+    return true;
+}
+
+/** @brief Huffman encode an array in host memory
+  *
+  * The host counterpart of cudppHuffmanEncode(), producing the same code
+  * lengths, sub-block offsets and stream.
+  *
+  * @param[out] compressed The encoded stream, at most
+  *             ::CUDPP_HUFFMAN_MAX_WORDS(\a numElements) words
+  * @param[out] codeLengths The code length of each symbol of the alphabet
+  *             (256 for ::CUDPP_UCHAR, 65536 for ::CUDPP_USHORT), 0 for
+  *             symbols that do not occur.  This is all a decoder needs
+  *             to rebuild the code.
+  * @param[out] subBlockOffsets The first word of each sub-block of
+  *             ::CUDPP_HUFFMAN_SUBBLOCK_SIZE symbols, followed by the
+  *             total number of words
+  * @param[in]  in The symbols to encode
+  * @param[in]  numElements Number of symbols
+  * @param[in]  datatype ::CUDPP_UCHAR or ::CUDPP_USHORT
+  * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION for other datatypes,
+  *          otherwise CUDPP_SUCCESS
+  *
+  * @see cudppHuffmanEncode, cudppHuffmanDecodeHost
+  */
+CUDPP_DLL
+CUDPPResult cudppHuffmanEncodeHost(unsigned int  *compressed,
+                                   unsigned char *codeLengths,
+                                   unsigned int  *subBlockOffsets,
+                                   const void    *in,
+                                   size_t        numElements,
+                                   CUDPPDatatype datatype)
+{
+    unsigned int alphabetSize = huffmanAlphabetSize(datatype);
+    if (alphabetSize == 0 || numElements > INT_MAX)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (datatype == CUDPP_UCHAR)
+        huffmanEncodeHost(compressed, codeLengths, subBlockOffsets,
+                          (const unsigned char*)in, numElements, alphabetSize);
+    else
+        huffmanEncodeHost(compressed, codeLengths, subBlockOffsets,
+                          (const unsigned short*)in, numElements, alphabetSize);
+    return CUDPP_SUCCESS;
+}
+
+/** @brief Decode a Huffman encoded array in host memory
+  *
+  * The host counterpart of cudppHuffmanDecode().
+  *
+  * @param[out] out The decoded symbols
+  * @param[in]  compressed The encoded stream
+  * @param[in]  codeLengths The code length of each symbol of the alphabet
+  * @param[in]  subBlockOffsets The first word of each sub-block, followed
+  *             by the total number of words
+  * @param[in]  numElements Number of symbols
+  * @param[in]  datatype ::CUDPP_UCHAR or ::CUDPP_USHORT
+  * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION for other datatypes, for
+  *          code lengths that are not those of a prefix code, or for a
+  *          stream that does not decode, otherwise CUDPP_SUCCESS
+  *
+  * @see cudppHuffmanDecode, cudppHuffmanEncodeHost
+  */
+CUDPP_DLL
+CUDPPResult cudppHuffmanDecodeHost(void                *out,
+                                   const unsigned int  *compressed,
+                                   const unsigned char *codeLengths,
+                                   const unsigned int  *subBlockOffsets,
+                                   size_t              numElements,
+                                   CUDPPDatatype       datatype)
+{
+    unsigned int alphabetSize = huffmanAlphabetSize(datatype);
+    if (alphabetSize == 0 || numElements > INT_MAX)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    if (numElements == 0)
+        return CUDPP_SUCCESS;
+
+    bool decoded;
+    if (datatype == CUDPP_UCHAR)
+        decoded = huffmanDecodeHost((unsigned char*)out, compressed, codeLengths,
+                                    subBlockOffsets, numElements, alphabetSize);
+    else
+        decoded = huffmanDecodeHost((unsigned short*)out, compressed, codeLengths,
+                                    subBlockOffsets, numElements, alphabetSize);
+    return decoded ? CUDPP_SUCCESS : CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
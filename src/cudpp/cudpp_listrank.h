@@ -27,6 +27,13 @@ void allocListRankStorage(CUDPPListRankPlan* plan);
 extern "C"
 void freeListRankStorage(CUDPPListRankPlan* plan);
 
+extern "C"
+void listRankOffsets(unsigned int            *d_ranks,
+                     const int               *d_next_indices,
+                     const int               *d_head,
+                     size_t                  numElements,
+                     const CUDPPListRankPlan *plan);
+
 extern "C"
 CUDPPResult cudppListRankDispatch(void *d_ranked_values,
                            void *d_unranked_values,
@@ -64,18 +64,370 @@ CUDPPResult cudppDestroy(CUDPPHandle theCudpp)
 
 /** @} */ // end Library Management Interface
 
+/** @name Instrumentation Interface
+ * @{
+ */
+
+/**
+ * @brief Starts or stops updating the performance counters of an instance
+ * of the CUDPP library.
+ *
+ * While statistics are enabled, every call through the public interface
+ * adds to the counters of its plan (see cudppGetPlanStatistics()) and of
+ * its algorithm (see cudppGetStatistics()).  Each call is timed with CUDA
+ * events on the stream it issues its work on and waits for that work to
+ * complete, so asynchronous calls are serialized.  When statistics and 
+ * tracing are both off, the only cost of a call is one test.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @param[in] enable nonzero to enable statistics, zero to disable them
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppGetStatistics, cudppResetStatistics, cudppSetTraceCallbacks
+ */
+CUDPP_DLL
+CUDPPResult cudppEnableStatistics(CUDPPHandle theCudpp,
+                                  int         enable)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    mgr->enableStatistics(enable != 0);
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Clears the per-algorithm counters of an instance of the CUDPP 
+ * library.
+ *
+ * The scratch memory of the plans still alive is kept, and the counters 
+ * of the plans themselves are not changed.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPP_DLL
+CUDPPResult cudppResetStatistics(CUDPPHandle theCudpp)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    mgr->resetStatistics();
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Returns the counters of all the calls to plans of one algorithm.
+ *
+ * \a scratchBytes is the intermediate storage of the algorithm's plans 
+ * that are currently alive, whether or not statistics are enabled now, 
+ * counting only plans created while statistics or tracing were enabled.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @param[in] algorithm the algorithm
+ * @param[out] stats the counters
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppEnableStatistics, cudppGetPlanStatistics
+ */
+CUDPP_DLL
+CUDPPResult cudppGetStatistics(CUDPPHandle     theCudpp,
+                               CUDPPAlgorithm  algorithm,
+                               CUDPPStatistics *stats)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    if (stats == NULL || algorithm < 0 || algorithm >= CUDPP_ALGORITHM_INVALID)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    mgr->getStatistics(algorithm, *stats);
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Sets functions to be called at the start and end of every call
+ * through the public interface.
+ *
+ * Either callback may be null; passing null for both turns tracing off.
+ * The end callback receives the device start time and duration of the
+ * call and what it added to the counters, whether or not statistics are
+ * enabled.  Traced calls wait for their work to complete, as described for
+ * cudppEnableStatistics().  Replaces any trace started with 
+ * cudppStartTrace().
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @param[in] begin called before each call issues its work, or null
+ * @param[in] end called after each call's work has completed, or null
+ * @param[in] userData passed to both callbacks
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see CUDPPTraceEvent, cudppStartTrace
+ */
+CUDPP_DLL
+CUDPPResult cudppSetTraceCallbacks(CUDPPHandle        theCudpp,
+                                   CUDPPTraceCallback begin,
+                                   CUDPPTraceCallback end,
+                                   void               *userData)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    mgr->stopTrace();
+    mgr->setTraceCallbacks(begin, end, userData);
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Traces every call to a file in Chrome trace format.
+ *
+ * Each call is written as a complete ("X") event with its device start 
+ * time and duration and, as arguments, its counters, so the file can be
+ * loaded in chrome://tracing or Perfetto.  Calls on different streams are
+ * on different rows.  The file is completed by cudppStopTrace() or 
+ * cudppDestroy().  Replaces any trace callbacks.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @param[in] filename the file to write
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppStopTrace, cudppSetTraceCallbacks
+ */
+CUDPP_DLL
+CUDPPResult cudppStartTrace(CUDPPHandle theCudpp,
+                            const char  *filename)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    if (filename == NULL)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    return mgr->startTrace(filename);
+}
+
+/**
+ * @brief Completes and closes the trace file of cudppStartTrace(), and 
+ * turns tracing off.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @returns CUDPPResult indicating success or error condition
+ */
+CUDPP_DLL
+CUDPPResult cudppStopTrace(CUDPPHandle theCudpp)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    mgr->stopTrace();
+    return CUDPP_SUCCESS;
+}
+
+/** @} */ // end Instrumentation Interface
+
 /** @} */ // end publicInterface
 
 //! @brief CUDPP Manager constructor
 CUDPPManager::CUDPPManager()
+: m_statisticsEnabled(false),
+  m_currentCall(0),
+  m_haveEpoch(false),
+  m_traceBegin(0),
+  m_traceEnd(0),
+  m_traceUserData(0),
+  m_traceFile(0),
+  m_traceEventsWritten(0),
+  m_tuningOverride(0)
 {
     int device = -1;
     CUDA_SAFE_CALL(cudaGetDevice(&device));
     CUDA_SAFE_CALL(cudaGetDeviceProperties(&m_deviceProps, device));
+
+    CUDPPStatistics zero = { 0, 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i <= CUDPP_ALGORITHM_INVALID; i++)
+        m_statistics[i] = zero;
 }
 
 /** @brief CUDPP Manager destructor 
 */
 CUDPPManager::~CUDPPManager()
 {
+    stopTrace();
+    if (m_haveEpoch)
+        cudaEventDestroy(m_epoch);
+}
+
+//! @internal Records the event trace times are measured from
+void CUDPPManager::ensureEpoch()
+{
+    if (!m_haveEpoch)
+    {
+        CUDA_SAFE_CALL(cudaEventCreate(&m_epoch));
+        CUDA_SAFE_CALL(cudaEventRecord(m_epoch, 0));
+        m_haveEpoch = true;
+    }
+}
+
+void CUDPPManager::enableStatistics(bool enable)
+{
+    if (enable)
+        ensureEpoch();
+    m_statisticsEnabled = enable;
+}
+
+void CUDPPManager::resetStatistics()
+{
+    for (int i = 0; i <= CUDPP_ALGORITHM_INVALID; i++)
+    {
+        unsigned long long scratchBytes = m_statistics[i].scratchBytes;
+        CUDPPStatistics zero = { 0, 0, 0, 0, 0, 0, 0 };
+        m_statistics[i] = zero;
+        m_statistics[i].scratchBytes = scratchBytes;
+    }
+}
+
+void CUDPPManager::getStatistics(int algorithm, CUDPPStatistics &stats) const
+{
+    stats = m_statistics[algorithm];
+}
+
+/** @brief Gets the tunable parameters a new plan should use
+  *
+  * @param[in]  algorithm   The algorithm of the plan
+  * @param[in]  datatype    The datatype of the plan
+  * @param[in]  numElements The size of the plan
+  * @param[out] tuning      The parameters, if any
+  * @returns true if parameters are being measured by cudppAutotune(), or
+  * the tuning database has an entry for this device, algorithm and 
+  * datatype; false if the plan should use its defaults
+  */
+bool CUDPPManager::getTuning(CUDPPAlgorithm algorithm, CUDPPDatatype datatype,
+                             size_t numElements, CUDPPTuning &tuning) const
+{
+    if (m_tuningOverride)
+    {
+        tuning = *m_tuningOverride;
+        return true;
+    }
+    return m_tuningDatabase.lookup(getDeviceKey(), algorithm, datatype,
+                                   numElements, tuning);
+}
+
+//! @internal @returns the device name, with blanks replaced so that it is one word
+std::string CUDPPManager::getDeviceKey() const
+{
+    std::string key(m_deviceProps.name);
+    for (size_t i = 0; i < key.size(); i++)
+    {
+        if (key[i] == ' ' || key[i] == '\t')
+            key[i] = '_';
+    }
+    return key.empty() ? std::string("unknown") : key;
+}
+
+void CUDPPManager::setTraceCallbacks(CUDPPTraceCallback begin, 
+                                     CUDPPTraceCallback end,
+                                     void *userData)
+{
+    if (begin || end)
+        ensureEpoch();
+    m_traceBegin = begin;
+    m_traceEnd = end;
+    m_traceUserData = userData;
+}
+
+CUDPPResult CUDPPManager::startTrace(const char *filename)
+{
+    stopTrace();
+    m_traceFile = fopen(filename, "w");
+    if (!m_traceFile)
+        return CUDPP_ERROR_UNKNOWN;
+    fprintf(m_traceFile, "{\"traceEvents\":[");
+    m_traceEventsWritten = 0;
+    setTraceCallbacks(0, writeTraceEvent, this);
+    return CUDPP_SUCCESS;
+}
+
+void CUDPPManager::stopTrace()
+{
+    if (m_traceFile)
+    {
+        fprintf(m_traceFile, "\n]}\n");
+        fclose(m_traceFile);
+        m_traceFile = 0;
+        setTraceCallbacks(0, 0, 0);
+    }
+}
+
+//! @internal End callback of cudppStartTrace(): one complete event per call
+void CUDPPManager::writeTraceEvent(const CUDPPTraceEvent *event, void *userData)
+{
+    CUDPPManager *mgr = (CUDPPManager*)userData;
+    const CUDPPStatistics &c = event->counters;
+    fprintf(mgr->m_traceFile, 
+            "%s\n{\"name\":\"%s\",\"cat\":\"cudpp\",\"ph\":\"X\","
+            "\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%llu,"
+            "\"args\":{\"algorithm\":%d,\"elements\":%llu,"
+            "\"bytes_in\":%llu,\"bytes_out\":%llu,\"scratch_bytes\":%llu,"
+            "\"iterations\":%llu,\"restarts\":%llu}}",
+            mgr->m_traceEventsWritten ? "," : "", event->name,
+            event->startTime * 1000.0, event->time * 1000.0,
+            (unsigned long long)event->plan, (int)event->algorithm,
+            (unsigned long long)event->numElements, c.bytesIn, c.bytesOut,
+            c.scratchBytes, c.iterations, c.restarts);
+    mgr->m_traceEventsWritten++;
+}
+
+//! @internal Adds the counters of one call to a total
+static void addCall(CUDPPStatistics &total, const CUDPPStatistics &call)
+{
+    total.calls      += call.calls;
+    total.time       += call.time;
+    total.bytesIn    += call.bytesIn;
+    total.bytesOut   += call.bytesOut;
+    total.iterations += call.iterations;
+    total.restarts   += call.restarts;
+}
+
+//! @internal Starts recording a call: see CUDPPCallRecorder
+void CUDPPManager::beginCall(CUDPPCallRecorder &call)
+{
+    ensureEpoch();
+    call.m_outerCall = m_currentCall;
+    m_currentCall = &call.m_event.counters;
+
+    if (m_traceBegin)
+        m_traceBegin(&call.m_event, m_traceUserData);
+
+    CUDA_SAFE_CALL(cudaEventCreate(&call.m_start));
+    CUDA_SAFE_CALL(cudaEventCreate(&call.m_stop));
+    CUDA_SAFE_CALL(cudaEventRecord(call.m_start, call.m_stream));
+}
+
+//! @internal Waits for a recorded call and adds it to the counters
+void CUDPPManager::endCall(CUDPPCallRecorder &call)
+{
+    CUDA_SAFE_CALL(cudaEventRecord(call.m_stop, call.m_stream));
+    CUDA_SAFE_CALL(cudaEventSynchronize(call.m_stop));
+
+    float startTime = 0, time = 0;
+    CUDA_SAFE_CALL(cudaEventElapsedTime(&startTime, m_epoch, call.m_start));
+    CUDA_SAFE_CALL(cudaEventElapsedTime(&time, call.m_start, call.m_stop));
+    CUDA_SAFE_CALL(cudaEventDestroy(call.m_start));
+    CUDA_SAFE_CALL(cudaEventDestroy(call.m_stop));
+
+    m_currentCall = call.m_outerCall;
+
+    call.m_event.startTime = startTime;
+    call.m_event.time = time;
+    call.m_event.counters.calls = 1;
+    call.m_event.counters.time = time;
+
+    if (m_statisticsEnabled)
+    {
+        addCall(m_statistics[call.m_statisticsIndex], call.m_event.counters);
+        if (call.m_planStatistics)
+            addCall(*call.m_planStatistics, call.m_event.counters);
+    }
+
+    if (m_traceEnd)
+        m_traceEnd(&call.m_event, m_traceUserData);
 }
@@ -11,9 +11,19 @@
 #define __CUDPP_MANAGER_H__
 
 #include <cuda_runtime_api.h>
+#include <stdio.h>
+#include "cudpp.h"
+#include "cudpp_tuning.h"
+
+class CUDPPCallRecorder;
 
 /** @brief Internal manager class for CUDPPP resources
   * 
+  * The manager also holds the performance counters of each algorithm and
+  * the trace callbacks.  Calls through the public interface are wrapped in
+  * a CUDPPCallRecorder, which does nothing unless statistics or tracing 
+  * are enabled.  Plans take their tunable parameters from the manager's
+  * tuning database (see cudppAutotune()).
   */
 class CUDPPManager
 {
@@ -39,8 +49,130 @@ public:
         return reinterpret_cast<CUDPPHandle>(this);
     }
 
+    //! @internal Counters of hash tables are kept after those of the algorithms
+    enum { HASH_TABLE_STATISTICS = CUDPP_ALGORITHM_INVALID };
+
+    //! @internal True if calls are being counted or traced
+    bool isInstrumented() const 
+    { 
+        return m_statisticsEnabled || m_traceBegin || m_traceEnd; 
+    }
+
+    void enableStatistics(bool enable);
+    void resetStatistics();
+    void getStatistics(int algorithm, CUDPPStatistics &stats) const;
+    void setTraceCallbacks(CUDPPTraceCallback begin, CUDPPTraceCallback end,
+                           void *userData);
+    CUDPPResult startTrace(const char *filename);
+    void stopTrace();
+
+    //! @internal Adds plan scratch memory (negative when a plan is destroyed)
+    void addScratchBytes(int algorithm, long long bytes)
+    {
+        m_statistics[algorithm].scratchBytes += bytes;
+    }
+
+    //! @internal Counts passes of the call being recorded, if any
+    void addIterations(unsigned long long n)
+    {
+        if (m_currentCall) m_currentCall->iterations += n;
+    }
+
+    //! @internal Counts restarts of the call being recorded, if any
+    void addRestarts(unsigned long long n)
+    {
+        if (m_currentCall) m_currentCall->restarts += n;
+    }
+
+    void beginCall(CUDPPCallRecorder &call);
+    void endCall(CUDPPCallRecorder &call);
+
+    //! @internal The configurations measured by cudppAutotune() or loaded
+    CUDPPTuningDatabase& getTuningDatabase() { return m_tuningDatabase; }
+
+    //! @internal Makes plans use \a tuning instead of the database (null to stop)
+    void setTuningOverride(const CUDPPTuning *tuning) { m_tuningOverride = tuning; }
+
+    bool getTuning(CUDPPAlgorithm algorithm, CUDPPDatatype datatype,
+                   size_t numElements, CUDPPTuning &tuning) const;
+    std::string getDeviceKey() const;
+
 private:
+    void ensureEpoch();
+    static void writeTraceEvent(const CUDPPTraceEvent *event, void *userData);
+
     cudaDeviceProp m_deviceProps;
+
+    CUDPPStatistics    m_statistics[CUDPP_ALGORITHM_INVALID + 1]; //!< Per algorithm, then hash tables
+    bool               m_statisticsEnabled; //!< Counters are updated
+    CUDPPStatistics   *m_currentCall;       //!< Counters of the innermost call being recorded
+    cudaEvent_t        m_epoch;             //!< Event that trace times are measured from
+    bool               m_haveEpoch;         //!< m_epoch has been recorded
+
+    CUDPPTraceCallback m_traceBegin;        //!< Called at the start of each call
+    CUDPPTraceCallback m_traceEnd;          //!< Called at the end of each call
+    void              *m_traceUserData;     //!< Passed to the callbacks
+    FILE              *m_traceFile;         //!< Chrome trace written by cudppStartTrace()
+    unsigned long long m_traceEventsWritten; //!< Events written to m_traceFile
+
+    CUDPPTuningDatabase m_tuningDatabase;   //!< Tuned parameters, consulted by plans
+    const CUDPPTuning  *m_tuningOverride;   //!< Parameters being measured by cudppAutotune()
+};
+
+/** @brief Records one call through the public interface
+  *
+  * Construct one at the start of a public function, after its arguments
+  * are checked; the call is recorded when it goes out of scope.  When the
+  * manager is not instrumented, construction is a single test and the 
+  * destructor does nothing.
+  *
+  * Recorded calls are timed with events on \a stream and wait for their
+  * work to complete, so instrumentation serializes asynchronous calls.
+  */
+class CUDPPCallRecorder
+{
+public:
+    CUDPPCallRecorder(CUDPPManager *mgr, CUDPPStatistics *planStatistics,
+                      const char *name, CUDPPAlgorithm algorithm, 
+                      CUDPPHandle plan, CUDPPStream stream, size_t numElements,
+                      unsigned long long bytesIn, unsigned long long bytesOut)
+    : m_manager((mgr && mgr->isInstrumented()) ? mgr : 0)
+    {
+        if (m_manager)
+        {
+            m_planStatistics = planStatistics;
+            m_statisticsIndex = algorithm; // hash tables: HASH_TABLE_STATISTICS
+            m_stream = (cudaStream_t)stream;
+            m_event.name = name;
+            m_event.algorithm = algorithm;
+            m_event.plan = plan;
+            m_event.numElements = numElements;
+            m_event.startTime = 0;
+            m_event.time = 0;
+            CUDPPStatistics zero = { 0, 0, 0, 0, 0, 0, 0 };
+            m_event.counters = zero;
+            m_event.counters.bytesIn = bytesIn;
+            m_event.counters.bytesOut = bytesOut;
+            if (planStatistics)
+                m_event.counters.scratchBytes = planStatistics->scratchBytes;
+            m_manager->beginCall(*this);
+        }
+    }
+
+    ~CUDPPCallRecorder()
+    {
+        if (m_manager)
+            m_manager->endCall(*this);
+    }
+
+    CUDPPManager    *m_manager;         //!< Manager recording the call, or null
+    CUDPPStatistics *m_planStatistics;  //!< Counters of the plan, or null
+    int              m_statisticsIndex; //!< Algorithm counters to add to
+    cudaStream_t     m_stream;          //!< Stream the call issues its work on
+    cudaEvent_t      m_start;           //!< Recorded before the call's work
+    cudaEvent_t      m_stop;            //!< Recorded after the call's work
+    CUDPPStatistics *m_outerCall;       //!< Call this one is nested in, if any
+    CUDPPTraceEvent  m_event;           //!< The call, as reported to the trace callbacks
 };
 
 #endif // __CUDPP_PLAN_MANAGER_H__
@@ -0,0 +1,263 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_mtf.cpp
+ *
+ * @brief Host move-to-front transform and its inverse
+ *
+ * Like the device routines (compress_app.cu), these split the input into
+ * chunks whose states are combined with a scan, starting from the list
+ * 0..255, so each chunk can be transformed independently.  The
+ * transform of a stream is unique, so the output is the same as the
+ * device's for any number of threads.
+ */
+
+#include "cudpp.h"
+#include "cudpp_globals.h"
+
+#include <string.h>
+#include <algorithm>
+#include <new>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/** @returns the number of chunks, one per thread, for \a numElements symbols */
+static int mtfHostNumChunks(size_t numElements)
+{
+    int numChunks = 1;
+#ifdef _OPENMP
+    numChunks = (int)std::min((size_t)omp_get_max_threads(),
+                              std::max((size_t)1, numElements / MTF_HOST_GRAIN));
+#endif
+    return numChunks;
+}
+
+/** @brief The recency list of a chunk: its distinct symbols, most recently
+  * used first
+  *
+  * @returns The number of distinct symbols
+  */
+static unsigned int mtfRecencyList(unsigned char *list, const unsigned char *in,
+                                   size_t numElements)
+{
+    bool seen[256] = { false };
+    unsigned int size = 0;
+    for (size_t i = numElements; i-- > 0 && size < 256; )
+    {
+        if (!seen[in[i]])
+        {
+            seen[in[i]] = true;
+            list[size++] = in[i];
+        }
+    }
+    return size;
+}
+
+/** @brief Move-to-front encode one chunk, starting from \a list
+  *
+  * The list is kept as the position of each symbol.  Moving a symbol at
+  * position r to the front adds one to every position below r, a
+  * branch-free update of all 256 positions that the compiler vectorizes,
+  * so the cost of a symbol does not depend on its position.
+  */
+static void mtfEncodeHost(unsigned char *out, const unsigned char *in,
+                          size_t numElements, const unsigned char *list)
+{
+    unsigned char position[256];
+    for (unsigned int j = 0; j < 256; j++)
+        position[list[j]] = (unsigned char)j;
+
+    for (size_t i = 0; i < numElements; i++)
+    {
+        const unsigned char r = position[in[i]];
+        out[i] = r;
+        if (r == 0)
+            continue;
+        for (unsigned int j = 0; j < 256; j++)
+            position[j] += (position[j] < r);
+        position[in[i]] = 0;
+    }
+}
+
+/** @brief Move-to-front decode one chunk, updating \a list in place
+  *
+  * If \a out is null only the list is updated; decoding a chunk from the
+  * list 0..255 that way gives the permutation the chunk applies to the
+  * list positions.
+  */
+static void mtfDecodeHost(unsigned char *out, const unsigned char *in,
+                          size_t numElements, unsigned char *list)
+{
+    for (size_t i = 0; i < numElements; i++)
+    {
+        const unsigned char r = in[i];
+        const unsigned char symbol = list[r];
+        memmove(list + 1, list, r);
+        list[0] = symbol;
+        if (out)
+            out[i] = symbol;
+    }
+}
+
+/** @brief Move-to-front transform an array in host memory
+  *
+  * The host counterpart of cudppMoveToFrontTransform(), producing the
+  * same output.  When the library is built with OpenMP, each thread
+  * computes the recency list of one chunk of the input; the lists are
+  * combined in order into the MTF list before each chunk, and each thread
+  * then encodes its chunk.  A symbol is encoded with a vectorized update
+  * of the position of every symbol.
+  *
+  * @param[out] out The MTF indices
+  * @param[in]  in The symbols
+  * @param[in]  numElements Number of symbols
+  * @returns CUDPPResult indicating success or error condition
+  *
+  * @see cudppMoveToFrontTransform, cudppInverseMoveToFrontTransformHost
+  */
+CUDPP_DLL
+CUDPPResult cudppMoveToFrontTransformHost(unsigned char       *out,
+                                          const unsigned char *in,
+                                          size_t              numElements)
+{
+    if (numElements > 0 && (out == NULL || in == NULL))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    const int numChunks = mtfHostNumChunks(numElements);
+    const size_t chunkSize = numElements / numChunks;
+
+    std::vector<unsigned char> lists;
+    std::vector<unsigned int> listSizes;
+    try
+    {
+        lists.resize((size_t)(numChunks + 1) * 256);
+        listSizes.resize(numChunks);
+    }
+    catch (std::bad_alloc &)
+    {
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+    // one chunk per iteration, whatever the size of the team
+#pragma omp parallel for schedule(static, 1) num_threads(numChunks)
+    for (int chunk = 0; chunk < numChunks - 1; chunk++)
+        listSizes[chunk] = mtfRecencyList(&lists[(size_t)(chunk + 1) * 256],
+                                          in + chunk * chunkSize, chunkSize);
+
+    // the list before chunk k + 1 is the recency list of chunk k followed
+    // by the list before chunk k without those symbols
+    for (unsigned int j = 0; j < 256; j++)
+        lists[j] = (unsigned char)j;
+    for (int chunk = 0; chunk < numChunks - 1; chunk++)
+    {
+        const unsigned char *before = &lists[(size_t)chunk * 256];
+        unsigned char *after = &lists[(size_t)(chunk + 1) * 256];
+        bool recent[256] = { false };
+        for (unsigned int j = 0; j < listSizes[chunk]; j++)
+            recent[after[j]] = true;
+        unsigned int size = listSizes[chunk];
+        for (unsigned int j = 0; j < 256; j++)
+        {
+            if (!recent[before[j]])
+                after[size++] = before[j];
+        }
+    }
+
+#pragma omp parallel for schedule(static, 1) num_threads(numChunks)
+    for (int chunk = 0; chunk < numChunks; chunk++)
+    {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = (chunk == numChunks - 1) ? numElements : begin + chunkSize;
+        mtfEncodeHost(out + begin, in + begin, end - begin, &lists[(size_t)chunk * 256]);
+    }
+
+    return CUDPP_SUCCESS;
+}
+
+/** @brief Inverse move-to-front transform an array in host memory
+  *
+  * The host counterpart of cudppInverseMoveToFrontTransform().  When the
+  * library is built with OpenMP, each thread computes the permutation
+  * one chunk applies to the list positions; the permutations are
+  * composed in order into the MTF list before each chunk, and each
+  * thread then decodes its chunk.  A symbol is decoded by moving the
+  * front of the list with memmove().
+  *
+  * @param[out] out The symbols
+  * @param[in]  in The MTF indices
+  * @param[in]  numElements Number of indices
+  * @returns CUDPPResult indicating success or error condition
+  *
+  * @see cudppInverseMoveToFrontTransform, cudppMoveToFrontTransformHost
+  */
+CUDPP_DLL
+CUDPPResult cudppInverseMoveToFrontTransformHost(unsigned char       *out,
+                                                 const unsigned char *in,
+                                                 size_t              numElements)
+{
+    if (numElements > 0 && (out == NULL || in == NULL))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    const int numChunks = mtfHostNumChunks(numElements);
+    const size_t chunkSize = numElements / numChunks;
+
+    std::vector<unsigned char> lists;
+    try
+    {
+        lists.resize((size_t)(numChunks + 1) * 256);
+    }
+    catch (std::bad_alloc &)
+    {
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+
+    // one chunk per iteration, whatever the size of the team
+#pragma omp parallel for schedule(static, 1) num_threads(numChunks)
+    for (int chunk = 0; chunk < numChunks - 1; chunk++)
+    {
+        unsigned char *permutation = &lists[(size_t)(chunk + 1) * 256];
+        for (unsigned int j = 0; j < 256; j++)
+            permutation[j] = (unsigned char)j;
+        mtfDecodeHost(NULL, in + chunk * chunkSize, chunkSize, permutation);
+    }
+
+    // the list after chunk k holds, at position j, the symbol at position
+    // permutation[j] of the list before it
+    for (unsigned int j = 0; j < 256; j++)
+        lists[j] = (unsigned char)j;
+    for (int chunk = 0; chunk < numChunks - 1; chunk++)
+    {
+        const unsigned char *before = &lists[(size_t)chunk * 256];
+        unsigned char *after = &lists[(size_t)(chunk + 1) * 256];
+        for (unsigned int j = 0; j < 256; j++)
+            after[j] = before[after[j]];
+    }
+
+#pragma omp parallel for schedule(static, 1) num_threads(numChunks)
+    for (int chunk = 0; chunk < numChunks; chunk++)
+    {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = (chunk == numChunks - 1) ? numElements : begin + chunkSize;
+        mtfDecodeHost(out + begin, in + begin, end - begin, &lists[(size_t)chunk * 256]);
+    }
+
+    return CUDPP_SUCCESS;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
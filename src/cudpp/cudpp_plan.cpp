@@ -20,10 +20,34 @@
 #include "cudpp_reduce.h"
 #include "cudpp_compress.h"
 #include "cudpp_listrank.h"
+#include "cudpp_sparseconvert.h"
+#include "cudpp_eulertour.h"
+#include "cudpp_histogram.h"
+#include "cudpp_rle.h"
+#include "cudpp_reducebykey.h"
 #include "cuda_util.h"
+#include "cudpp_globals.h"
 #include <cuda_runtime_api.h>
 
 #include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+//! @internal Device memory allocated on the current device, in bytes, 
+//! used to measure the intermediate storage of a plan.  cudaMemGetInfo()
+//! synchronizes with the device, so it is only called when \a mgr is
+//! instrumented.
+static size_t deviceMemoryInUse(const CUDPPManager *mgr)
+{
+    size_t freeMem = 0, totalMem = 0;
+    if (!mgr || !mgr->isInstrumented())
+        return 0;
+    if (cudaMemGetInfo(&freeMem, &totalMem) != cudaSuccess)
+        return 0;
+    return totalMem - freeMem;
+}
 
 CUDPPResult validateOptions(CUDPPConfiguration config, size_t numElements, size_t numRows, size_t /*rowPitch*/)
 {
@@ -36,10 +60,144 @@ CUDPPResult validateOptions(CUDPPConfiguration config, size_t numElements, size_
     if (config.algorithm == CUDPP_COMPACT && numRows > 1)
         ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION; //!< @todo: add support for multi-row cudppCompact
 
+    // only radix sort supports 64-bit values
+    if ((config.options & CUDPP_OPTION_64BIT_VALUES) && config.algorithm != CUDPP_SORT_RADIX)
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // only algorithms that sum floating-point values have a reduction order
+    if ((config.options & CUDPP_OPTION_DETERMINISTIC) && config.algorithm != CUDPP_SCAN &&
+        config.algorithm != CUDPP_SEGMENTED_SCAN && config.algorithm != CUDPP_REDUCE)
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // partial results are widened from float to double, and multi-row 
+    // scans keep their block sums in the datatype
+    if (config.options & CUDPP_OPTION_ACCUMULATE_DOUBLE)
+    {
+        if (config.datatype != CUDPP_FLOAT)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (config.algorithm != CUDPP_SCAN && config.algorithm != CUDPP_SEGMENTED_SCAN &&
+            config.algorithm != CUDPP_REDUCE && config.algorithm != CUDPP_SPMVMULT)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (config.algorithm == CUDPP_SCAN && numRows > 1)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // the merge and string sort kernels index elements with 32-bit signed
+    // integers, as do the next indices of list ranking
+    if ((config.algorithm == CUDPP_SORT_MERGE || config.algorithm == CUDPP_SORT_STRING ||
+         config.algorithm == CUDPP_LISTRANK) &&
+        numElements > INT_MAX)
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
     if (config.algorithm == CUDPP_TRIDIAGONAL) {
         if (config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE) 
             ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        // one block size; periodic block systems are not supported
+        unsigned int blockOptions = config.options & 
+            (CUDPP_OPTION_BLOCK_2X2 | CUDPP_OPTION_BLOCK_4X4);
+        if (blockOptions == (CUDPP_OPTION_BLOCK_2X2 | CUDPP_OPTION_BLOCK_4X4) ||
+            (blockOptions && (config.options & CUDPP_OPTION_PERIODIC)))
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+    else if (config.options & (CUDPP_OPTION_PERIODIC | CUDPP_OPTION_BLOCK_2X2 |
+                               CUDPP_OPTION_BLOCK_4X4))
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (config.algorithm == CUDPP_RAND_PHILOX) {
+        // raw bits as unsigned int, or floating point distributions
+        const unsigned int dists = config.options & 
+            (CUDPP_OPTION_RAND_NORMAL | CUDPP_OPTION_RAND_EXPONENTIAL);
+        if (config.datatype != CUDPP_UINT && config.datatype != CUDPP_FLOAT &&
+            config.datatype != CUDPP_DOUBLE)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (dists == (CUDPP_OPTION_RAND_NORMAL | CUDPP_OPTION_RAND_EXPONENTIAL) ||
+            (dists && config.datatype == CUDPP_UINT))
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+    else if (config.options & (CUDPP_OPTION_RAND_NORMAL | CUDPP_OPTION_RAND_EXPONENTIAL))
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (config.algorithm == CUDPP_SPMVMULT) {
+        // compressed values are floating point, and there is one value format
+        const unsigned int values = config.options & 
+            (CUDPP_OPTION_SPMV_HALF_VALUES | CUDPP_OPTION_SPMV_BFLOAT16_VALUES);
+        if (config.datatype != CUDPP_INT && config.datatype != CUDPP_UINT &&
+            config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (values == (CUDPP_OPTION_SPMV_HALF_VALUES | CUDPP_OPTION_SPMV_BFLOAT16_VALUES) ||
+            (values && config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE))
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+    else if (config.options & (CUDPP_OPTION_SPMV_HALF_VALUES | CUDPP_OPTION_SPMV_BFLOAT16_VALUES |
+                               CUDPP_OPTION_SPMV_16BIT_INDICES))
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // values are moved as 32- or 64-bit words; indices are 32-bit
+    if (config.algorithm == CUDPP_SPARSE_CONVERT) {
+        if (config.datatype != CUDPP_INT && config.datatype != CUDPP_UINT &&
+            config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE &&
+            config.datatype != CUDPP_LONGLONG && config.datatype != CUDPP_ULONGLONG)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (numElements > UINT_MAX || numRows >= UINT_MAX)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // the BWT ranks rotations with 32-bit unsigned integers
+    if ((config.algorithm == CUDPP_BWT || config.algorithm == CUDPP_COMPRESS) &&
+        numElements > BWT_MAX_SIZE)
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // the MTF kernels index symbols with 32-bit unsigned integers
+    if (config.algorithm == CUDPP_MTF && numElements > UINT_MAX)
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // the Huffman alphabet is bytes or 16-bit symbols; counts are int
+    if (config.algorithm == CUDPP_HUFFMAN) {
+        if (config.datatype != CUDPP_UCHAR && config.datatype != CUDPP_USHORT)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (numElements > INT_MAX)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // parents are int, and the tour of 2n events is ranked as a list
+    if (config.algorithm == CUDPP_EULER_TOUR) {
+        if (config.datatype != CUDPP_INT)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (numElements > INT_MAX / 2)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // counts and the sorted bins are unsigned int
+    if (config.algorithm == CUDPP_HISTOGRAM) {
+        if (config.datatype >= CUDPP_DATATYPE_INVALID)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (numElements > UINT_MAX)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // run lengths and run indices are unsigned int
+    if (config.algorithm == CUDPP_RLE) {
+        if (config.datatype >= CUDPP_DATATYPE_INVALID)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (numElements > UINT_MAX)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    // values are reduced by segmented scan, which has no 8- or 16-bit
+    // types; groups and positions are unsigned int
+    if (config.algorithm == CUDPP_REDUCE_BY_KEY) {
+        if (config.op > CUDPP_OPERATOR_INVALID)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (config.op != CUDPP_OPERATOR_INVALID &&
+            config.datatype != CUDPP_INT && config.datatype != CUDPP_UINT &&
+            config.datatype != CUDPP_FLOAT && config.datatype != CUDPP_DOUBLE &&
+            config.datatype != CUDPP_LONGLONG && config.datatype != CUDPP_ULONGLONG)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        if (numElements > UINT_MAX)
+            ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
     }
+    else if (config.options & (CUDPP_OPTION_64BIT_KEYS | CUDPP_OPTION_UNSORTED_KEYS))
+        ret = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 
     return ret;
 }
@@ -96,6 +254,8 @@ CUDPPResult cudppPlan(const CUDPPHandle  cudppHandle,
         return result;
     }
 
+    size_t memoryBefore = deviceMemoryInUse(mgr);
+
     switch (config.algorithm)
     {
     case CUDPP_SCAN:
@@ -129,6 +289,7 @@ CUDPPResult cudppPlan(const CUDPPHandle  cudppHandle,
             break;
         }
     case CUDPP_RAND_MD5:
+    case CUDPP_RAND_PHILOX:
         {
             plan = new CUDPPRandPlan(mgr, config, numElements);
             break;
@@ -163,6 +324,36 @@ CUDPPResult cudppPlan(const CUDPPHandle  cudppHandle,
             plan = new CUDPPListRankPlan(mgr, config, numElements);
             break;
         }
+    case CUDPP_SPARSE_CONVERT:
+        {
+            plan = new CUDPPSparseConvertPlan(mgr, config, numElements, numRows);
+            break;
+        }
+    case CUDPP_EULER_TOUR:
+        {
+            plan = new CUDPPEulerTourPlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_HUFFMAN:
+        {
+            plan = new CUDPPHuffmanPlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_HISTOGRAM:
+        {
+            plan = new CUDPPHistogramPlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_RLE:
+        {
+            plan = new CUDPPRunLengthPlan(mgr, config, numElements);
+            break;
+        }
+    case CUDPP_REDUCE_BY_KEY:
+        {
+            plan = new CUDPPReduceByKeyPlan(mgr, config, numElements);
+            break;
+        }
     default:
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION; 
         break;
@@ -172,6 +363,11 @@ CUDPPResult cudppPlan(const CUDPPHandle  cudppHandle,
         return CUDPP_ERROR_UNKNOWN;
     else
     {
+        size_t memoryAfter = deviceMemoryInUse(mgr);
+        if (memoryAfter > memoryBefore)
+            plan->m_statistics.scratchBytes = memoryAfter - memoryBefore;
+        mgr->addScratchBytes(config.algorithm, plan->m_statistics.scratchBytes);
+
         *planHandle = plan->getHandle();
         return CUDPP_SUCCESS;
     }
@@ -193,6 +389,9 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
 
     CUDPPPlan* plan = getPlanPtrFromHandle<CUDPPPlan>(planHandle);
 
+    plan->m_planManager->addScratchBytes(plan->m_config.algorithm,
+        -(long long)plan->m_statistics.scratchBytes);
+
     switch (plan->m_config.algorithm)
     {
     case CUDPP_SCAN:
@@ -226,6 +425,7 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
             break;
         }
     case CUDPP_RAND_MD5:
+    case CUDPP_RAND_PHILOX:
         {
             delete static_cast<CUDPPRandPlan*>(plan);
             break;
@@ -260,6 +460,36 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
             delete static_cast<CUDPPListRankPlan*>(plan);
             break;
         }
+    case CUDPP_SPARSE_CONVERT:
+        {
+            delete static_cast<CUDPPSparseConvertPlan*>(plan);
+            break;
+        }
+    case CUDPP_EULER_TOUR:
+        {
+            delete static_cast<CUDPPEulerTourPlan*>(plan);
+            break;
+        }
+    case CUDPP_HUFFMAN:
+        {
+            delete static_cast<CUDPPHuffmanPlan*>(plan);
+            break;
+        }
+    case CUDPP_HISTOGRAM:
+        {
+            delete static_cast<CUDPPHistogramPlan*>(plan);
+            break;
+        }
+    case CUDPP_RLE:
+        {
+            delete static_cast<CUDPPRunLengthPlan*>(plan);
+            break;
+        }
+    case CUDPP_REDUCE_BY_KEY:
+        {
+            delete static_cast<CUDPPReduceByKeyPlan*>(plan);
+            break;
+        }
     default:
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION; 
         break;
@@ -281,6 +511,24 @@ CUDPPResult cudppDestroyPlan(CUDPPHandle planHandle)
   * passed as \a numNonZeroElements. This is used to allocate internal
   * storage space at the time the sparse matrix plan is created.
   *
+  * The row lengths are analyzed once, here, to choose the multiply kernel:
+  * one thread per row for short rows, a vector of threads per row for
+  * longer rows of similar length (e.g. banded matrices), and a merge-path
+  * kernel that balances work across threads when a few rows are much longer
+  * than the average (e.g. power-law graphs).
+  *
+  * The datatype may be CUDPP_INT, CUDPP_UINT, CUDPP_FLOAT or CUDPP_DOUBLE;
+  * \a A and the vectors passed to the multiply are of that type.  Since
+  * the multiply is limited by memory bandwidth, the matrix can be stored
+  * more compactly:
+  * - ::CUDPP_OPTION_SPMV_HALF_VALUES or ::CUDPP_OPTION_SPMV_BFLOAT16_VALUES
+  *   (float or double only) round the values to 16 bits when the matrix is
+  *   created; products are still accumulated in the datatype.
+  * - ::CUDPP_OPTION_SPMV_16BIT_INDICES stores each column index as a 16-bit
+  *   offset from the smallest column of its block of 256 nonzeros.  If the
+  *   columns of some block span more than 65535 (e.g. scattered columns in
+  *   a large matrix) the 32-bit indices are kept.
+  *
   * @param[out] sparseMatrixHandle A pointer to an opaque handle to the sparse matrix object
   * @param[in]  cudppHandle A handle to an instance of the CUDPP library used for resource management
   * @param[in]  config The configuration struct specifying algorithm and options
@@ -307,10 +555,15 @@ CUDPPResult cudppSparseMatrix(const CUDPPHandle  cudppHandle,
     CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(cudppHandle);
 
     if ((config.algorithm != CUDPP_SPMVMULT) || 
-        (numNonZeroElements <= 0) || (numRows <= 0))
+        (numNonZeroElements <= 0) || (numRows <= 0) ||
+        (numNonZeroElements > UINT_MAX) || (numRows > UINT_MAX))
     {
         result = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
     }
+    else
+    {
+        result = validateOptions(config, numNonZeroElements, numRows, 0);
+    }
 
     if (result != CUDPP_SUCCESS)
     {
@@ -318,12 +571,20 @@ CUDPPResult cudppSparseMatrix(const CUDPPHandle  cudppHandle,
         return result;
     }
 
+    size_t memoryBefore = deviceMemoryInUse(mgr);
+
     sparseMatrix = 
         new CUDPPSparseMatrixVectorMultiplyPlan(mgr, config, numNonZeroElements, A, 
                                                 h_rowIndices, h_indices, numRows);
 
     if (sparseMatrix)
     {
+        // the matrix itself counts as intermediate storage
+        size_t memoryAfter = deviceMemoryInUse(mgr);
+        if (memoryAfter > memoryBefore)
+            sparseMatrix->m_statistics.scratchBytes = memoryAfter - memoryBefore;
+        mgr->addScratchBytes(CUDPP_SPMVMULT, sparseMatrix->m_statistics.scratchBytes);
+
         *sparseMatrixHandle = sparseMatrix->getHandle();
         return CUDPP_SUCCESS;
     }
@@ -351,11 +612,42 @@ CUDPPResult cudppDestroySparseMatrix(CUDPPHandle sparseMatrixHandle)
 
     CUDPPSparseMatrixVectorMultiplyPlan* plan = 
         getPlanPtrFromHandle<CUDPPSparseMatrixVectorMultiplyPlan>(sparseMatrixHandle);
+    plan->m_planManager->addScratchBytes(CUDPP_SPMVMULT,
+        -(long long)plan->m_statistics.scratchBytes);
     delete plan;
     plan = 0;
     return CUDPP_SUCCESS;
 }
 
+/** @brief Returns the performance counters of a plan or sparse matrix
+  *
+  * The counters are those of the calls made with \a planHandle while 
+  * statistics were enabled (see cudppEnableStatistics()).  \a scratchBytes
+  * is the device memory the plan allocated when it was created, as seen 
+  * by cudaMemGetInfo(), so it is approximate when other threads allocate 
+  * memory at the same time.  It is only measured for plans created while
+  * statistics or tracing were enabled, and is 0 otherwise.
+  * 
+  * @param[in] planHandle The plan or sparse matrix
+  * @param[out] stats The counters
+  * @returns CUDPPResult indicating success or error condition
+  *
+  * @see cudppEnableStatistics, cudppGetStatistics
+  */
+CUDPP_DLL
+CUDPPResult cudppGetPlanStatistics(CUDPPHandle     planHandle,
+                                   CUDPPStatistics *stats)
+{
+    if (planHandle == CUDPP_INVALID_HANDLE)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    if (stats == NULL)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    CUDPPPlan* plan = getPlanPtrFromHandle<CUDPPPlan>(planHandle);
+    *stats = plan->m_statistics;
+    return CUDPP_SUCCESS;
+}
+
 /** @} */ // end Plan Interface
 /** @} */ // end publicInterface
 
@@ -377,8 +669,11 @@ CUDPPPlan::CUDPPPlan(CUDPPManager *mgr,
   m_numElements(numElements),
   m_numRows(numRows),
   m_rowPitch(rowPitch),
-  m_planManager(mgr)
+  m_planManager(mgr),
+  m_launchStream(0)
 {
+    CUDPPStatistics zero = { 0, 0, 0, 0, 0, 0, 0 };
+    m_statistics = zero;
 }
 
 /** @brief Scan Plan constructor
@@ -399,7 +694,9 @@ CUDPPScanPlan::CUDPPScanPlan(CUDPPManager *mgr,
   m_rowPitches(0),
   m_numEltsAllocated(0),
   m_numRowsAllocated(0),
-  m_numLevelsAllocated(0)
+  m_numLevelsAllocated(0),
+  m_d_carry(0),
+  m_firstLevelSums(0)
 {
     allocScanStorage(this);
 }
@@ -423,6 +720,7 @@ CUDPPSegmentedScanPlan::CUDPPSegmentedScanPlan(CUDPPManager *mgr,
   m_blockSums(0),
   m_blockFlags(0),
   m_blockIndices(0),
+  m_firstLevelSums(0),
   m_numEltsAllocated(0),
   m_numLevelsAllocated(0)
 {
@@ -449,7 +747,10 @@ CUDPPCompactPlan::CUDPPCompactPlan(CUDPPManager *mgr,
                                    size_t numRows, 
                                    size_t rowPitch)
 : CUDPPPlan(mgr, config, numElements, numRows, rowPitch),
-  m_d_outputIndices(0)
+  m_d_blockCounts(0),
+  m_d_blockOffsets(0),
+  m_d_outputBase(0),
+  m_d_numValidTotal(0)
 {
     assert(numRows == 1); //!< @todo Add support for multirow compaction
 
@@ -462,7 +763,16 @@ CUDPPCompactPlan::CUDPPCompactPlan(CUDPPManager *mgr,
         CUDPP_OPTION_BACKWARD | CUDPP_OPTION_EXCLUSIVE : 
         CUDPP_OPTION_FORWARD  | CUDPP_OPTION_EXCLUSIVE 
     };
-    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numElements, numRows, rowPitch);
+    // compactArray() scans the valid counts of the tiles of one segment
+    // at a time, so the scan never needs to cover more than one count per 
+    // tile of a segment
+    size_t numScanElements = (numElements > SCAN_MAX_SEGMENT_SIZE) ? 
+        SCAN_MAX_SEGMENT_SIZE : numElements;
+    const size_t eltsPerTile = SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE;
+    numScanElements = (numScanElements + eltsPerTile - 1) / eltsPerTile;
+    if (numScanElements < 1)
+        numScanElements = 1;
+    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numScanElements, numRows, rowPitch);
 
     allocCompactStorage(this);
 }
@@ -487,6 +797,16 @@ CUDPPReducePlan::CUDPPReducePlan(CUDPPManager *mgr,
   m_threadsPerBlock(REDUCE_CTA_SIZE),
   m_maxBlocks(64)
 {
+    // a deterministic reduction must not depend on the tuning, and may use
+    // as many blocks as a fixed-size-per-block split of the input needs
+    CUDPPTuning tuning;
+    if (config.options & CUDPP_OPTION_DETERMINISTIC)
+        m_maxBlocks = REDUCE_DETERMINISTIC_MAX_BLOCKS;
+    else if (mgr && mgr->getTuning(CUDPP_REDUCE, config.datatype, numElements, tuning))
+    {
+        m_threadsPerBlock = tuning.values[0];
+        m_maxBlocks = tuning.values[1];
+    }
     allocReduceStorage(this);
 }
 
@@ -601,24 +921,30 @@ CUDPPSparseMatrixVectorMultiplyPlan::CUDPPSparseMatrixVectorMultiplyPlan(CUDPPMa
                                                                          size_t             numRows
                                                                          )
 : CUDPPPlan(mgr, config, numNonZeroElements, 1, 0),
-  m_segmentedScanPlan(0),
-  m_d_prod(0),
-  m_d_flags(0),
+  m_strategy(CUDPP_SPMV_ROW_PER_THREAD),
+  m_vectorSize(1),
+  m_numTiles(0),
+  m_maxRowLength(0),
+  m_d_carryValue(0),
+  m_d_carryRow(0),
+  m_numLongRows(0),
+  m_numRowPieces(0),
+  m_d_longRow(0),
+  m_d_longRowPieces(0),
+  m_d_pieceStart(0),
+  m_d_pieceEnd(0),
+  m_d_pieceCarry(0),
   m_d_rowFinalIndex(0),
+  m_d_rowIndex(0),
+  m_d_index(0),
+  m_d_indexDelta(0),
+  m_d_indexBase(0),
+  m_d_A(0),
   m_rowFinalIndex(0),
   m_numRows(numRows),
   m_numNonZeroElements(numNonZeroElements)  
 {
-    CUDPPConfiguration segScanConfig = 
-    { 
-      CUDPP_SEGMENTED_SCAN, 
-      CUDPP_ADD, 
-      config.datatype, 
-      (CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE) 
-    };
-    m_segmentedScanPlan = new CUDPPSegmentedScanPlan(mgr, segScanConfig, m_numNonZeroElements);
-
-    // Generate an array of the indices of the last element of each row
+    // Generate an array of the indices one past the last element of each row
     // in the "flattened" version of the sparse matrix
     m_rowFinalIndex = new unsigned int [m_numRows];
     for (unsigned int i=0; i < m_numRows; ++i)
@@ -627,6 +953,35 @@ CUDPPSparseMatrixVectorMultiplyPlan::CUDPPSparseMatrixVectorMultiplyPlan(CUDPPMa
             m_rowFinalIndex[i] = rowIndex[i+1];
         else
             m_rowFinalIndex[i] = (unsigned int)numNonZeroElements;
+
+        m_maxRowLength = std::max(m_maxRowLength, m_rowFinalIndex[i] - rowIndex[i]);
+    }
+
+    // Choose the kernel from the row-length distribution.  Rows much longer
+    // than average (power-law graphs) would leave most threads of the row- and
+    // vector-based kernels idle, so those matrices use the merge path, which
+    // balances work regardless of row length.  Otherwise short rows get one
+    // thread each, and longer rows a vector of threads matching their mean length.
+    double meanRowLength = (double)m_numNonZeroElements / m_numRows;
+
+    if (m_maxRowLength > WARP_SIZE && 
+        m_maxRowLength > SPMV_SKEWED_ROW_RATIO * meanRowLength)
+    {
+        m_strategy = CUDPP_SPMV_MERGE_PATH;
+        size_t pathLength = m_numRows + m_numNonZeroElements;
+        size_t itemsPerTile = SPMV_CTA_SIZE * SPMV_MERGE_ITEMS_PER_THREAD;
+        m_numTiles = (unsigned int)((pathLength + itemsPerTile - 1) / itemsPerTile);
+    }
+    else if (meanRowLength < SPMV_ROW_PER_THREAD_MAX_LENGTH)
+    {
+        m_strategy = CUDPP_SPMV_ROW_PER_THREAD;
+    }
+    else
+    {
+        m_strategy = CUDPP_SPMV_VECTOR_PER_ROW;
+        m_vectorSize = 2;
+        while (m_vectorSize < WARP_SIZE && m_vectorSize < meanRowLength)
+            m_vectorSize <<= 1;
     }
 
     allocSparseMatrixVectorMultiplyStorage(this, A, rowIndex, index);
@@ -636,7 +991,6 @@ CUDPPSparseMatrixVectorMultiplyPlan::CUDPPSparseMatrixVectorMultiplyPlan(CUDPPMa
 CUDPPSparseMatrixVectorMultiplyPlan::~CUDPPSparseMatrixVectorMultiplyPlan()
 {
     freeSparseMatrixVectorMultiplyStorage(this);
-    delete m_segmentedScanPlan;
     delete [] m_rowFinalIndex;
 }
 
@@ -648,7 +1002,9 @@ CUDPPSparseMatrixVectorMultiplyPlan::~CUDPPSparseMatrixVectorMultiplyPlan()
   */
 CUDPPRandPlan::CUDPPRandPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t num_elements) 
  : CUDPPPlan(mgr, config, num_elements, 1, 0),
-   m_seed(0)
+   m_seed(0),
+   m_stream(0),
+   m_offset(0)
 {
     
 }
@@ -659,9 +1015,14 @@ CUDPPRandPlan::CUDPPRandPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_
   * @param[in] config The configuration struct specifying options
   */
 CUDPPTridiagonalPlan::CUDPPTridiagonalPlan(CUDPPManager *mgr, CUDPPConfiguration config) 
- : CUDPPPlan(mgr, config, 0, 0, 0)
+ : CUDPPPlan(mgr, config, 0, 0, 0),
+   m_blockSize(1),
+   m_periodic((config.options & CUDPP_OPTION_PERIODIC) != 0)
 {
-    
+    if (config.options & CUDPP_OPTION_BLOCK_2X2)
+        m_blockSize = 2;
+    else if (config.options & CUDPP_OPTION_BLOCK_4X4)
+        m_blockSize = 4;
 }
 
 /** @brief CUDPP Compress Plan Constructor
@@ -671,17 +1032,108 @@ CUDPPTridiagonalPlan::CUDPPTridiagonalPlan(CUDPPManager *mgr, CUDPPConfiguration
   * @param[in] numElements The maximum number of elements to be compressed
   */
 CUDPPCompressPlan::CUDPPCompressPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
- : CUDPPPlan(mgr, config, numElements, 1, 0)
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_sortPlan(0),
+   m_scanPlan(0),
+   m_bwtCtaSize(BWT_CTA_SIZE),
+   m_mtfChunkSize(MTF_DEFAULT_CHUNK_SIZE),
+   m_huffmanPlan(0)
 {
+    CUDPPConfiguration sortConfig = 
+    { 
+      CUDPP_SORT_RADIX, 
+      CUDPP_OPERATOR_INVALID, 
+      CUDPP_ULONGLONG, 
+      CUDPP_OPTION_KEY_VALUE_PAIRS 
+    };
+    CUDPPConfiguration scanConfig = 
+    { 
+      CUDPP_SCAN, 
+      CUDPP_ADD, 
+      CUDPP_UINT, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE 
+    };
+    CUDPPConfiguration huffmanConfig = 
+    { 
+      CUDPP_HUFFMAN, 
+      CUDPP_OPERATOR_INVALID, 
+      CUDPP_UCHAR, 
+      0 
+    };
+
+    // the stages use the tuning of the standalone BWT and MTF plans; the
+    // Huffman plan looks up its own
+    CUDPPTuning tuning;
+    if (mgr && mgr->getTuning(CUDPP_BWT, config.datatype, numElements, tuning))
+        m_bwtCtaSize = tuning.values[0];
+    if (mgr && mgr->getTuning(CUDPP_MTF, config.datatype, numElements, tuning))
+        m_mtfChunkSize = tuning.values[0];
+
+    // the BWT sorts rank pairs of the rotations and scans to rank them
+    m_sortPlan = new CUDPPRadixSortPlan(mgr, sortConfig, numElements);
+    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numElements, 1, 0);
+    m_huffmanPlan = new CUDPPHuffmanPlan(mgr, huffmanConfig, numElements);
     allocCompressStorage(this);
 }
 
 /** @brief Compress plan destructor */
 CUDPPCompressPlan::~CUDPPCompressPlan()
 {
+    delete m_sortPlan;
+    delete m_scanPlan;
+    delete m_huffmanPlan;
     freeCompressStorage(this);
 }
 
+/** @brief CUDPP Huffman Plan Constructor
+  *
+  * @param[in] mgr pointer to the CUDPPManager
+  * @param[in] config The configuration struct specifying options
+  * @param[in] numElements The maximum number of symbols to be encoded
+  */
+CUDPPHuffmanPlan::CUDPPHuffmanPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_alphabetSize(config.datatype == CUDPP_USHORT ? 65536 : 256),
+   m_sortPlan(0),
+   m_scanPlan(0),
+   m_ctaSize(HUFF_CTA_SIZE)
+{
+    CUDPPConfiguration sortConfig = 
+    { 
+      CUDPP_SORT_RADIX, 
+      CUDPP_OPERATOR_INVALID, 
+      CUDPP_UINT, 
+      CUDPP_OPTION_KEYS_ONLY 
+    };
+    CUDPPConfiguration scanConfig = 
+    { 
+      CUDPP_SCAN, 
+      CUDPP_ADD, 
+      CUDPP_UINT, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+    };
+
+    CUDPPTuning tuning;
+    if (mgr && mgr->getTuning(CUDPP_HUFFMAN, config.datatype, numElements, tuning))
+        m_ctaSize = tuning.values[0];
+
+    // the symbols are sorted to count them, and the words of the 
+    // sub-blocks scanned to place them
+    size_t numSubBlocks = 
+        (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+    m_sortPlan = new CUDPPRadixSortPlan(mgr, sortConfig, numElements);
+    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numSubBlocks + 1, 1, 0);
+    allocHuffmanStorage(this);
+}
+
+/** @brief Huffman plan destructor */
+CUDPPHuffmanPlan::~CUDPPHuffmanPlan()
+{
+    delete m_sortPlan;
+    delete m_scanPlan;
+    freeHuffmanStorage(this);
+}
+
 /** @brief CUDPP BWT Plan Constructor
   *
   * @param[in] mgr pointer to the CUDPPManager
@@ -689,14 +1141,41 @@ CUDPPCompressPlan::~CUDPPCompressPlan()
   * @param[in] numElements The maximum number of elements to be transformed
   */
 CUDPPBwtPlan::CUDPPBwtPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
- : CUDPPPlan(mgr, config, numElements, 1, 0)
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_sortPlan(0),
+   m_scanPlan(0),
+   m_bwtCtaSize(BWT_CTA_SIZE)
 {
+    CUDPPConfiguration sortConfig = 
+    { 
+      CUDPP_SORT_RADIX, 
+      CUDPP_OPERATOR_INVALID, 
+      CUDPP_ULONGLONG, 
+      CUDPP_OPTION_KEY_VALUE_PAIRS 
+    };
+    CUDPPConfiguration scanConfig = 
+    { 
+      CUDPP_SCAN, 
+      CUDPP_ADD, 
+      CUDPP_UINT, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE 
+    };
+
+    CUDPPTuning tuning;
+    if (mgr && mgr->getTuning(CUDPP_BWT, config.datatype, numElements, tuning))
+        m_bwtCtaSize = tuning.values[0];
+
+    // the BWT sorts rank pairs of the rotations and scans to rank them
+    m_sortPlan = new CUDPPRadixSortPlan(mgr, sortConfig, numElements);
+    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numElements, 1, 0);
     allocBwtStorage(this);
 }
 
 /** @brief BWT plan destructor */
 CUDPPBwtPlan::~CUDPPBwtPlan()
 {
+    delete m_sortPlan;
+    delete m_scanPlan;
     freeBwtStorage(this);
 }
 
@@ -707,8 +1186,12 @@ CUDPPBwtPlan::~CUDPPBwtPlan()
   * @param[in] numElements The maximum number of elements to be moved to front
   */
 CUDPPMtfPlan::CUDPPMtfPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
- : CUDPPPlan(mgr, config, numElements, 1, 0)
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_mtfChunkSize(MTF_DEFAULT_CHUNK_SIZE)
 {
+    CUDPPTuning tuning;
+    if (mgr && mgr->getTuning(CUDPP_MTF, config.datatype, numElements, tuning))
+        m_mtfChunkSize = tuning.values[0];
     allocMtfStorage(this);
 }
 
@@ -725,8 +1208,14 @@ CUDPPMtfPlan::~CUDPPMtfPlan()
   * @param[in] numElements The maximum number of elements to be ranked
   */
 CUDPPListRankPlan::CUDPPListRankPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements) 
- : CUDPPPlan(mgr, config, numElements, 1, 0)
+ : CUDPPPlan(mgr, config, numElements, 1, 0),
+   m_d_mark(0),
+   m_d_storage(0),
+   m_sublistSize(LISTRANK_SUBLIST_SIZE)
 {
+    CUDPPTuning tuning;
+    if (mgr && mgr->getTuning(CUDPP_LISTRANK, config.datatype, numElements, tuning))
+        m_sublistSize = tuning.values[0];
     allocListRankStorage(this);
 }
 
@@ -735,3 +1224,316 @@ CUDPPListRankPlan::~CUDPPListRankPlan()
 {
     freeListRankStorage(this);
 }
+
+/** @brief Sparse matrix conversion plan constructor
+  *
+  * @param[in]  mgr pointer to the CUDPPManager
+  * @param[in]  config The configuration struct specifying options
+  * @param[in]  numElements The maximum number of nonzeros to be converted
+  * @param[in]  numRows The maximum number of rows or columns of a matrix
+  */
+CUDPPSparseConvertPlan::CUDPPSparseConvertPlan(CUDPPManager *mgr, 
+                                               CUDPPConfiguration config, 
+                                               size_t numElements,
+                                               size_t numRows)
+: CUDPPPlan(mgr, config, numElements, numRows, 0),
+  m_sortPlan(0),
+  m_d_keys(0),
+  m_d_permutation(0),
+  m_d_rows(0)
+{
+    CUDPPConfiguration sortConfig = 
+    { 
+      CUDPP_SORT_RADIX, 
+      CUDPP_OPERATOR_INVALID, 
+      CUDPP_ULONGLONG, 
+      CUDPP_OPTION_KEY_VALUE_PAIRS 
+    };
+
+    m_sortPlan = new CUDPPRadixSortPlan(mgr, sortConfig, numElements);
+
+    allocSparseConvertStorage(this);
+}
+
+/** @brief Sparse matrix conversion plan destructor */
+CUDPPSparseConvertPlan::~CUDPPSparseConvertPlan()
+{
+    delete m_sortPlan;
+    freeSparseConvertStorage(this);
+}
+
+/** @brief Euler tour plan constructor
+  *
+  * @param[in]  mgr pointer to the CUDPPManager
+  * @param[in]  config The configuration struct specifying options
+  * @param[in]  numElements The maximum number of nodes of a forest
+  */
+CUDPPEulerTourPlan::CUDPPEulerTourPlan(CUDPPManager *mgr, 
+                                       CUDPPConfiguration config, 
+                                       size_t numElements)
+: CUDPPPlan(mgr, config, numElements, 1, 0),
+  m_convertPlan(0),
+  m_listRankPlan(0),
+  m_scanPlan(0),
+  m_d_storage(0)
+{
+    CUDPPConfiguration convertConfig = 
+    { 
+      CUDPP_SPARSE_CONVERT, 
+      CUDPP_OPERATOR_INVALID, 
+      CUDPP_UINT, 
+      0 
+    };
+    CUDPPConfiguration listRankConfig = 
+    { 
+      CUDPP_LISTRANK, 
+      CUDPP_OPERATOR_INVALID, 
+      CUDPP_INT, 
+      0 
+    };
+    CUDPPConfiguration scanConfig = 
+    { 
+      CUDPP_SCAN, 
+      CUDPP_ADD, 
+      CUDPP_INT, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE 
+    };
+
+    // each node is a nonzero in the row of its parent; roots are in row n
+    m_convertPlan = new CUDPPSparseConvertPlan(mgr, convertConfig, numElements, numElements + 1);
+    m_listRankPlan = new CUDPPListRankPlan(mgr, listRankConfig, 2 * numElements);
+    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, 2 * numElements, 1, 0);
+
+    allocEulerTourStorage(this);
+}
+
+/** @brief Euler tour plan destructor */
+CUDPPEulerTourPlan::~CUDPPEulerTourPlan()
+{
+    delete m_convertPlan;
+    delete m_listRankPlan;
+    delete m_scanPlan;
+    freeEulerTourStorage(this);
+}
+
+/** @brief Histogram plan constructor
+  *
+  * Byte and 16-bit datatypes start with one bin per value, so their
+  * histograms need no further setup; other datatypes have no bins until
+  * cudppHistogramKeyBins(), cudppHistogramUniformBins() or 
+  * cudppHistogramBinEdges() is called.
+  *
+  * @param[in]  mgr pointer to the CUDPPManager
+  * @param[in]  config The configuration struct specifying options
+  * @param[in]  numElements The maximum number of values
+  */
+CUDPPHistogramPlan::CUDPPHistogramPlan(CUDPPManager *mgr, 
+                                       CUDPPConfiguration config, 
+                                       size_t numElements)
+: CUDPPPlan(mgr, config, numElements, 1, 0),
+  m_binning(CUDPP_HISTOGRAM_KEYS),
+  m_numBins(0),
+  m_firstKey(0),
+  m_lowerLevel(0),
+  m_upperLevel(0),
+  m_h_edges(0),
+  m_d_edges(0),
+  m_edgeBytes(0),
+  m_numThreads(0),
+  m_numBlocks(0),
+  m_d_partials(0),
+  m_sortPlan(0),
+  m_d_keys(0),
+  m_d_bounds(0)
+{
+    switch (config.datatype)
+    {
+    case CUDPP_CHAR:
+        setBins(CUDPP_HISTOGRAM_KEYS, 256, -128, 0, 0, 0, 0);
+        break;
+    case CUDPP_UCHAR:
+        setBins(CUDPP_HISTOGRAM_KEYS, 256, 0, 0, 0, 0, 0);
+        break;
+    case CUDPP_SHORT:
+        setBins(CUDPP_HISTOGRAM_KEYS, 65536, -32768, 0, 0, 0, 0);
+        break;
+    case CUDPP_USHORT:
+        setBins(CUDPP_HISTOGRAM_KEYS, 65536, 0, 0, 0, 0, 0);
+        break;
+    default:
+        break;
+    }
+}
+
+/** @brief Histogram plan destructor */
+CUDPPHistogramPlan::~CUDPPHistogramPlan()
+{
+    freeHistogramStorage(this);
+    delete m_sortPlan;
+    free(m_h_edges);
+}
+
+/** @brief Replace the bins of a histogram plan
+  *
+  * Frees the storage of the old bins and allocates that of the new ones;
+  * bins that do not fit in shared memory get a sort plan.  The arguments
+  * not used by \a binning are ignored.
+  *
+  * @param[in] binning How values are binned
+  * @param[in] numBins Number of bins
+  * @param[in] firstKey Key counted in bin 0 (CUDPP_HISTOGRAM_KEYS)
+  * @param[in] lowerLevel Lower edge of bin 0 (CUDPP_HISTOGRAM_UNIFORM)
+  * @param[in] upperLevel Upper edge of the last bin (CUDPP_HISTOGRAM_UNIFORM)
+  * @param[in] h_edges The numBins + 1 bin edges (CUDPP_HISTOGRAM_EDGES), copied
+  * @param[in] edgeBytes Size of \a h_edges in bytes
+  */
+void CUDPPHistogramPlan::setBins(CUDPPHistogramBinning binning, 
+                                 unsigned int numBins, 
+                                 long long firstKey,
+                                 double lowerLevel, 
+                                 double upperLevel,
+                                 const void *h_edges, 
+                                 size_t edgeBytes)
+{
+    freeHistogramStorage(this);
+    delete m_sortPlan;
+    free(m_h_edges);
+    m_sortPlan = 0;
+    m_h_edges = 0;
+
+    m_binning = binning;
+    m_numBins = numBins;
+    m_firstKey = firstKey;
+    m_lowerLevel = lowerLevel;
+    m_upperLevel = upperLevel;
+    m_edgeBytes = (binning == CUDPP_HISTOGRAM_EDGES) ? edgeBytes : 0;
+
+    if (m_edgeBytes)
+    {
+        m_h_edges = malloc(m_edgeBytes);
+        memcpy(m_h_edges, h_edges, m_edgeBytes);
+    }
+
+    if (numBins > HISTOGRAM_SHARED_BINS)
+    {
+        CUDPPConfiguration sortConfig = 
+        { 
+          CUDPP_SORT_RADIX, 
+          CUDPP_OPERATOR_INVALID, 
+          CUDPP_UINT, 
+          CUDPP_OPTION_KEYS_ONLY 
+        };
+        m_sortPlan = new CUDPPRadixSortPlan(m_planManager, sortConfig, m_numElements);
+    }
+
+    allocHistogramStorage(this);
+}
+
+/** @brief Run-length encoding plan constructor
+  *
+  * @param[in]  mgr pointer to the CUDPPManager
+  * @param[in]  config The configuration struct specifying options
+  * @param[in]  numElements The maximum number of values to encode or decode
+  */
+CUDPPRunLengthPlan::CUDPPRunLengthPlan(CUDPPManager *mgr, 
+                                       CUDPPConfiguration config, 
+                                       size_t numElements)
+: CUDPPPlan(mgr, config, numElements, 1, 0),
+  m_scanPlan(0),
+  m_maxScanPlan(0),
+  m_d_flags(0),
+  m_d_ranks(0)
+{
+    CUDPPConfiguration scanConfig = 
+    { 
+      CUDPP_SCAN, 
+      CUDPP_ADD, 
+      CUDPP_UINT, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+    };
+    CUDPPConfiguration maxScanConfig = 
+    { 
+      CUDPP_SCAN, 
+      CUDPP_MAX, 
+      CUDPP_UINT, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE 
+    };
+
+    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numElements, 1, 0);
+    m_maxScanPlan = new CUDPPScanPlan(mgr, maxScanConfig, numElements, 1, 0);
+    allocRunLengthStorage(this);
+}
+
+/** @brief Run-length encoding plan destructor */
+CUDPPRunLengthPlan::~CUDPPRunLengthPlan()
+{
+    delete m_scanPlan;
+    delete m_maxScanPlan;
+    freeRunLengthStorage(this);
+}
+
+/** @brief Reduce-by-key plan constructor
+*
+* Adjacent equal keys are numbered by a scan of their head flags, and
+* their values reduced by a segmented scan over the same flags.  With
+* CUDPP_OPTION_UNSORTED_KEYS the keys are first radix sorted with their
+* positions, so that equal keys are adjacent.
+*
+* @param[in]  mgr pointer to the CUDPPManager
+* @param[in]  config The configuration struct specifying the value operator and datatype
+* @param[in]  numElements The maximum number of keys
+*/
+CUDPPReduceByKeyPlan::CUDPPReduceByKeyPlan(CUDPPManager *mgr, 
+                                           CUDPPConfiguration config, 
+                                           size_t numElements)
+: CUDPPPlan(mgr, config, numElements, 1, 0),
+  m_b64BitKeys((config.options & CUDPP_OPTION_64BIT_KEYS) != 0),
+  m_bUnsorted((config.options & CUDPP_OPTION_UNSORTED_KEYS) != 0),
+  m_scanPlan(0),
+  m_segScanPlan(0),
+  m_sortPlan(0),
+  m_d_flags(0),
+  m_d_ranks(0),
+  m_d_scanned(0),
+  m_d_sortKeys(0),
+  m_d_indices(0),
+  m_d_sortValues(0)
+{
+    CUDPPConfiguration scanConfig = 
+    { 
+      CUDPP_SCAN, 
+      CUDPP_ADD, 
+      CUDPP_UINT, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_EXCLUSIVE 
+    };
+    CUDPPConfiguration segScanConfig = 
+    { 
+      CUDPP_SEGMENTED_SCAN, 
+      config.op, 
+      config.datatype, 
+      CUDPP_OPTION_FORWARD | CUDPP_OPTION_INCLUSIVE 
+    };
+    CUDPPConfiguration sortConfig = 
+    { 
+      CUDPP_SORT_RADIX, 
+      CUDPP_OPERATOR_INVALID, 
+      m_b64BitKeys ? CUDPP_ULONGLONG : CUDPP_UINT, 
+      CUDPP_OPTION_KEY_VALUE_PAIRS 
+    };
+
+    m_scanPlan = new CUDPPScanPlan(mgr, scanConfig, numElements, 1, 0);
+    if (config.op != CUDPP_OPERATOR_INVALID)
+        m_segScanPlan = new CUDPPSegmentedScanPlan(mgr, segScanConfig, numElements);
+    if (m_bUnsorted)
+        m_sortPlan = new CUDPPRadixSortPlan(mgr, sortConfig, numElements);
+    allocReduceByKeyStorage(this);
+}
+
+/** @brief Reduce-by-key plan destructor */
+CUDPPReduceByKeyPlan::~CUDPPReduceByKeyPlan()
+{
+    delete m_scanPlan;
+    delete m_segScanPlan;
+    delete m_sortPlan;
+    freeReduceByKeyStorage(this);
+}
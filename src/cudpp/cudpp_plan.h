@@ -45,6 +45,8 @@ public:
     size_t             m_numRows;       //!< @internal Maximum number of input rows
     size_t             m_rowPitch;      //!< @internal Pitch of input rows in elements
     CUDPPManager      *m_planManager;  //!< @internal pointer to the manager of this plan
+    CUDPPStream        m_launchStream;  //!< @internal Stream on which the plan's work is issued (0 is the default stream)
+    CUDPPStatistics    m_statistics;    //!< @internal Counters of the calls to this plan (see cudppGetPlanStatistics())
    
     //! @internal Convert this pointer to an opaque handle
     //! @returns Handle to a CUDPP plan
@@ -68,6 +70,8 @@ public:
     size_t  m_numEltsAllocated;   //!< @internal Number of elements allocated (maximum scan size)
     size_t  m_numRowsAllocated;   //!< @internal Number of rows allocated (for cudppMultiScan())
     size_t  m_numLevelsAllocated; //!< @internal Number of levels allocaed (in _scanBlockSums)
+    void   *m_d_carry;            //!< @internal Carry between segments of scans longer than SCAN_MAX_SEGMENT_SIZE
+    void   *m_firstLevelSums;     //!< @internal First-level block sums before they are widened (CUDPP_OPTION_ACCUMULATE_DOUBLE only)
 };
 
 /** @brief Plan class for segmented scan algorithm
@@ -82,6 +86,7 @@ public:
     void          **m_blockSums;          //!< @internal Intermediate block sums array
     unsigned int  **m_blockFlags;         //!< @internal Intermediate block flags array
     unsigned int  **m_blockIndices;       //!< @internal Intermediate block indices array
+    void          *m_firstLevelSums;      //!< @internal First-level block sums before they are widened (CUDPP_OPTION_ACCUMULATE_DOUBLE only)
     size_t        m_numEltsAllocated;     //!< @internal Number of elements allocated (maximum scan size)
     size_t        m_numLevelsAllocated;   //!< @internal Number of levels allocaed (in _scanBlockSums)
 };
@@ -95,8 +100,11 @@ public:
     CUDPPCompactPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements, size_t numRows, size_t rowPitch);
     virtual ~CUDPPCompactPlan();
 
-    CUDPPScanPlan *m_scanPlan;         //!< @internal Compact performs a scan of type unsigned int using this plan
-    unsigned int* m_d_outputIndices; //!< @internal Output address of compacted elements; this is the result of scan
+    CUDPPScanPlan *m_scanPlan;         //!< @internal Compact scans the tile counts (unsigned int) using this plan
+    unsigned int* m_d_blockCounts;   //!< @internal Number of valid elements in each tile of the current segment
+    unsigned int* m_d_blockOffsets;  //!< @internal Output offset of each tile; this is the result of scan
+    size_t*       m_d_outputBase;    //!< @internal 64-bit output offset of the current segment for compacts longer than SCAN_MAX_SEGMENT_SIZE
+    size_t*       m_d_numValidTotal; //!< @internal Valid elements of all segments, for partitions longer than SCAN_MAX_SEGMENT_SIZE
     
 };
 
@@ -203,6 +211,18 @@ public:
 
 };
 
+/** @brief Kernel strategies for sparse matrix-vector multiply
+*
+* Chosen for each matrix from its row-length distribution when the
+* matrix is created with cudppSparseMatrix().
+*/
+enum CUDPPSpmvStrategy
+{
+    CUDPP_SPMV_ROW_PER_THREAD,  //!< One thread per row, for short rows
+    CUDPP_SPMV_VECTOR_PER_ROW,  //!< 2 to 32 threads per row, for longer rows of similar length
+    CUDPP_SPMV_MERGE_PATH       //!< Rows and nonzeros split evenly among threads, for skewed rows
+};
+
 /** @brief Plan class for sparse-matrix dense-vector multiply
 *
 */
@@ -216,24 +236,51 @@ public:
                                         const unsigned int *indx, size_t numRows);
     virtual ~CUDPPSparseMatrixVectorMultiplyPlan();
 
-    CUDPPSegmentedScanPlan *m_segmentedScanPlan; //!< @internal Performs a segmented scan of type T using this plan
-    void             *m_d_prod;  //!< @internal Vector of products (of an element in A and its corresponding (thats is
-                                 //!            belongs to the same row) element in x; this is the input and output of 
-                                 //!            segmented scan
-    unsigned int     *m_d_flags; //!< @internal Vector of flags where a flag is set if an element of A is the first element
-                                 //!            of its row; this is the flags vector for segmented scan
+    CUDPPSpmvStrategy m_strategy;   //!< @internal Kernel strategy chosen from the row lengths
+    unsigned int     m_vectorSize;  //!< @internal Threads per row for CUDPP_SPMV_VECTOR_PER_ROW
+    unsigned int     m_numTiles;    //!< @internal Number of CTA-sized tiles of the merge path
+    unsigned int     m_maxRowLength; //!< @internal Number of nonzeros in the longest row
+    void             *m_d_carryValue; //!< @internal Partial sums of the first and last row of each
+                                      //!            merge-path tile
+    unsigned int     *m_d_carryRow;   //!< @internal Rows of the partial sums in m_d_carryValue
+    unsigned int     m_numLongRows;   //!< @internal Rows split into pieces for SpMM with CUDPP_SPMV_MERGE_PATH
+    unsigned int     m_numRowPieces;  //!< @internal Total number of pieces of the long rows
+    unsigned int     *m_d_longRow;    //!< @internal Row of each long row
+    unsigned int     *m_d_longRowPieces; //!< @internal First piece of each long row, then m_numRowPieces
+    unsigned int     *m_d_pieceStart; //!< @internal Index in A of the first element of each piece
+    unsigned int     *m_d_pieceEnd;   //!< @internal Index in A one past the last element of each piece
+    void             *m_d_pieceCarry; //!< @internal Products of the pieces, SPMM_CARRY_VECTORS per piece
     unsigned int     *m_d_rowFinalIndex; //!< @internal Vector of row end indices, which for each row specifies an index in A
-                                         //!            which is the last element of that row. Resides in GPU memory. 
-    unsigned int     *m_d_rowIndex; //!< @internal Vector of row end indices, which for each row specifies an index in A
+                                         //!            one past the last element of that row. Resides in GPU memory. 
+    unsigned int     *m_d_rowIndex; //!< @internal Vector of row start indices, which for each row specifies an index in A
                                     //!            which is the first element of that row. Resides in GPU memory. 
-    unsigned int     *m_d_index;    //!<@internal Vector of column numbers one for each element in A 
-    void             *m_d_A;        //!<@internal The A matrix 
+    unsigned int     *m_d_index;    //!<@internal Vector of column numbers one for each element in A,
+                                    //!           or null if 16-bit indices are used
+    unsigned short   *m_d_indexDelta; //!<@internal 16-bit column numbers relative to m_d_indexBase, or null
+    unsigned int     *m_d_indexBase;  //!<@internal Base column of each block of SPMV_INDEX_BLOCK_SIZE elements
+    void             *m_d_A;        //!<@internal The A matrix, in the datatype or as 16-bit floats
     unsigned int     *m_rowFinalIndex; //!< @internal Vector of row end indices, which for each row specifies an index in A
-                                       //!            which is the last element of that row. Resides in CPU memory.
+                                       //!            one past the last element of that row. Resides in CPU memory.
     size_t           m_numRows; //!< Number of rows
     size_t           m_numNonZeroElements; //!<Number of non-zero elements
 };
 
+/** @brief Plan class for sparse matrix format conversion
+*
+*/
+class CUDPPSparseConvertPlan : public CUDPPPlan
+{
+public:
+    CUDPPSparseConvertPlan(CUDPPManager *mgr, CUDPPConfiguration config, 
+                           size_t numElements, size_t numRows);
+    virtual ~CUDPPSparseConvertPlan();
+
+    CUDPPRadixSortPlan *m_sortPlan;      //!< @internal Sorts the 64-bit (major, minor) keys with the permutation
+    unsigned long long *m_d_keys;        //!< @internal (major, minor) index of each nonzero
+    unsigned int       *m_d_permutation; //!< @internal Position of each sorted nonzero in the input
+    unsigned int       *m_d_rows;        //!< @internal Row of each nonzero of a matrix being transposed
+};
+
 /** @brief Plan class for random number generator
 *
 */
@@ -243,6 +290,8 @@ public:
     CUDPPRandPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t num_elements);
 
     unsigned int m_seed; //!< @internal the seed for the random number generator
+    unsigned int m_stream; //!< @internal the stream (second key word) for Philox
+    unsigned long long m_offset; //!< @internal position in the Philox stream of the next element
 };
 
 /** @brief Plan class for tridiagonal solver
@@ -252,12 +301,39 @@ class CUDPPTridiagonalPlan : public CUDPPPlan
 {
 public:
     CUDPPTridiagonalPlan(CUDPPManager *mgr, CUDPPConfiguration config);
+
+    unsigned int m_blockSize; //!< @internal Size of the (square) blocks: 1, 2 or 4
+    bool         m_periodic;  //!< @internal True if the systems are periodic
+};
+
+/** @brief Plan class for canonical Huffman coding
+*
+*/
+struct huffman_table_entry;
+class CUDPPHuffmanPlan : public CUDPPPlan
+{
+public:
+    CUDPPHuffmanPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPHuffmanPlan();
+
+    unsigned int        m_alphabetSize;     //!< @internal 256 for CUDPP_UCHAR, 65536 for CUDPP_USHORT
+    CUDPPRadixSortPlan  *m_sortPlan;        //!< @internal Sorts the symbols to count them
+    CUDPPScanPlan       *m_scanPlan;        //!< @internal Scans the words of the sub-blocks
+    unsigned int        *m_d_keys;          //!< @internal The symbols, widened and sorted
+    unsigned int        *m_d_runBounds;     //!< @internal Start, then end, of each symbol's run
+    unsigned int        *m_d_codes;         //!< @internal Canonical code of each symbol
+    unsigned int        *m_d_blockWords;    //!< @internal Words of each sub-block, plus one
+    huffman_table_entry *m_d_decodeTable;   //!< @internal Lookup table of the decoder
+    unsigned int        *m_d_firstCode;     //!< @internal First canonical code of each length
+    unsigned int        *m_d_firstIndex;    //!< @internal First sorted symbol of each length
+    unsigned short      *m_d_sortedSymbols; //!< @internal Symbols sorted by code length
+    unsigned int        *m_d_decodeError;   //!< @internal Set if a sub-block does not decode
+    unsigned int        m_ctaSize;          //!< @internal Threads per CTA of the kernels (see cudppAutotune())
 };
 
 /** @brief Plan class for compressor
 *
 */
-struct encoded;
 class CUDPPCompressPlan : public CUDPPPlan
 {
 public:
@@ -265,38 +341,26 @@ public:
     virtual ~CUDPPCompressPlan();
 
     // BWT
-    unsigned int *m_d_keys;
+    unsigned long long *m_d_keys;
     unsigned int *m_d_values;
+    unsigned int *m_d_ranks;
+    unsigned int *m_d_sortRanks;
     unsigned char *m_d_bwtOut;
-
-    unsigned int *m_d_bwtInRef;
-    unsigned int *m_d_bwtInRef2;
-    unsigned int *m_d_keys_dev;
-    unsigned int *m_d_values_dev;
-    int *m_d_partitionBeginA;
-    int *m_d_partitionSizeA;
-    int *m_d_partitionBeginB;
-    int *m_d_partitionSizeB;
+    CUDPPRadixSortPlan *m_sortPlan;
+    CUDPPScanPlan *m_scanPlan;
+    unsigned int m_bwtCtaSize; //!< @internal Threads per CTA of the BWT kernels
+    unsigned int *m_h_numRanks;    //!< @internal Pinned copy of the number of distinct ranks
+    cudaEvent_t m_numRanksEvent;   //!< @internal Recorded once m_h_numRanks is copied
 
     // MTF
     unsigned char *m_d_mtfIn;
     unsigned char *m_d_mtfOut;
     unsigned char *m_d_lists;
     unsigned short *m_d_list_sizes;
-    unsigned int npad;
+    unsigned int m_mtfChunkSize;
 
     // Huffman
-    unsigned char *m_d_huffCodesPacked;   // tightly pack together all huffman codes
-    unsigned int *m_d_huffCodeLocations;  // keep track of where each huffman code starts
-    unsigned char *m_d_huffCodeLengths;   // lengths of each huffman codes (in bits)
-    unsigned int *m_d_histograms;         // histogram used to build huffman tree
-    //unsigned int *m_d_encodedData;        // encoded data only
-    //unsigned int *m_d_totalEncodedSize;   // total words we need to read
-    unsigned int *m_d_nCodesPacked;       // Size of all Huffman codes packed together (in bytes)
-    //unsigned int *m_d_histogram;          // Final histogram
-    //unsigned int *m_d_encodeOffset;
-    encoded *m_d_encoded;
-
+    CUDPPHuffmanPlan *m_huffmanPlan; //!< @internal Encodes the MTF output
 };
 
 /** @brief Plan class for BWT
@@ -309,18 +373,15 @@ public:
     virtual ~CUDPPBwtPlan();
 
     // BWT
-    unsigned int *m_d_keys;
-    unsigned int *m_d_values;
-
-    unsigned int *m_d_bwtInRef;
-    unsigned int *m_d_bwtInRef2;
-    unsigned int *m_d_keys_dev;
-    unsigned int *m_d_values_dev;
-    int *m_d_partitionBeginA;
-    int *m_d_partitionSizeA;
-    int *m_d_partitionBeginB;
-    int *m_d_partitionSizeB;
-
+    unsigned long long *m_d_keys;      //!< @internal Rank pairs of the rotations, sorted each round
+    unsigned int       *m_d_values;    //!< @internal Start of each rotation, in sorted order
+    unsigned int       *m_d_ranks;     //!< @internal Rank of each rotation
+    unsigned int       *m_d_sortRanks; //!< @internal Rank of each rotation, in sorted order
+    CUDPPRadixSortPlan *m_sortPlan;    //!< @internal Sorts the rank pairs
+    CUDPPScanPlan      *m_scanPlan;    //!< @internal Ranks the sorted rank pairs
+    unsigned int       m_bwtCtaSize;  //!< @internal Threads per CTA of the kernels (see cudppAutotune())
+    unsigned int       *m_h_numRanks;    //!< @internal Pinned copy of the number of distinct ranks
+    cudaEvent_t        m_numRanksEvent;  //!< @internal Recorded once m_h_numRanks is copied
 };
 
 /** @brief Plan class for MTF
@@ -333,9 +394,9 @@ public:
     virtual ~CUDPPMtfPlan();
 
     // MTF
-    unsigned char   *m_d_lists;
-    unsigned short  *m_d_list_sizes;
-    unsigned int    npad;
+    unsigned char   *m_d_lists;       //!< @internal MTF state of each chunk, and the levels of the state scan
+    unsigned short  *m_d_list_sizes;  //!< @internal Number of symbols in each state
+    unsigned int    m_mtfChunkSize;   //!< @internal Symbols per chunk, one chunk per thread
 };
 
 /** @brief Plan class for ListRank
@@ -348,9 +409,102 @@ public:
     virtual ~CUDPPListRankPlan();
 
     // Intermediate buffers used during list ranking
-    int *m_d_tmp1; //!< @internal temporary next indices array
-    int *m_d_tmp2; //!< @internal temporary start indices array
-    int *m_d_tmp3; //!< @internal temporary next indices array
+    int *m_d_mark;    //!< @internal Sublist of each splitter node, -1 for other nodes
+    int *m_d_storage; //!< @internal Per-level sublist, local rank and splitter arrays
+    unsigned int m_sublistSize; //!< @internal Mean nodes per sublist (see cudppAutotune())
+};
+
+/** @brief Plan class for Euler tours of trees
+*
+*/
+class CUDPPEulerTourPlan : public CUDPPPlan
+{
+public:
+    CUDPPEulerTourPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPEulerTourPlan();
+
+    CUDPPSparseConvertPlan *m_convertPlan;  //!< @internal Groups the children of each node
+    CUDPPListRankPlan      *m_listRankPlan; //!< @internal Ranks the events of the tour
+    CUDPPScanPlan          *m_scanPlan;     //!< @internal Scans the depth steps of the tour
+    unsigned int           *m_d_storage;    //!< @internal Pool for the tour, see allocEulerTourStorage()
+};
+
+/** @brief Binnings of histogram plans
+*
+* Set with cudppHistogramKeyBins(), cudppHistogramUniformBins() and
+* cudppHistogramBinEdges().
+*/
+enum CUDPPHistogramBinning
+{
+    CUDPP_HISTOGRAM_KEYS,     //!< One bin per integer key
+    CUDPP_HISTOGRAM_UNIFORM,  //!< Equal-width bins between two levels
+    CUDPP_HISTOGRAM_EDGES     //!< Bins between given edges
+};
+
+/** @brief Plan class for histograms
+*
+*/
+class CUDPPHistogramPlan : public CUDPPPlan
+{
+public:
+    CUDPPHistogramPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPHistogramPlan();
+
+    void setBins(CUDPPHistogramBinning binning, unsigned int numBins, long long firstKey,
+                 double lowerLevel, double upperLevel,
+                 const void *h_edges, size_t edgeBytes);
+
+    CUDPPHistogramBinning m_binning;     //!< @internal How values are binned
+    unsigned int          m_numBins;     //!< @internal Number of bins (0 until bins are set)
+    long long             m_firstKey;    //!< @internal Key of bin 0 (CUDPP_HISTOGRAM_KEYS)
+    double                m_lowerLevel;  //!< @internal Lower edge of bin 0 (CUDPP_HISTOGRAM_UNIFORM)
+    double                m_upperLevel;  //!< @internal Upper edge of the last bin (CUDPP_HISTOGRAM_UNIFORM)
+    void                  *m_h_edges;    //!< @internal The bin edges (CUDPP_HISTOGRAM_EDGES)
+    void                  *m_d_edges;    //!< @internal Device copy of the bin edges
+    size_t                m_edgeBytes;   //!< @internal Size of the bin edges in bytes
+    unsigned int          m_numThreads;  //!< @internal Threads per CTA of the shared-memory histogram
+    unsigned int          m_numBlocks;   //!< @internal CTAs of the shared-memory histogram
+    unsigned int          *m_d_partials; //!< @internal Histogram of each CTA
+    CUDPPRadixSortPlan    *m_sortPlan;   //!< @internal Sorts the bins when there are too many for shared memory
+    unsigned int          *m_d_keys;     //!< @internal The bin of each value, sorted
+    unsigned int          *m_d_bounds;   //!< @internal Start, then end, of each bin's run
+};
+
+/** @brief Plan class for run-length encoding
+*
+*/
+class CUDPPRunLengthPlan : public CUDPPPlan
+{
+public:
+    CUDPPRunLengthPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPRunLengthPlan();
+
+    CUDPPScanPlan *m_scanPlan;    //!< @internal Numbers the runs, or finds where they start
+    CUDPPScanPlan *m_maxScanPlan; //!< @internal Carries the run index over each decoded run
+    unsigned int  *m_d_flags;     //!< @internal Run head flags, or the run of each decoded value
+    unsigned int  *m_d_ranks;     //!< @internal Run of each head, or start of each decoded run
+};
+
+/** @brief Plan class for reduce by key and unique
+*
+*/
+class CUDPPReduceByKeyPlan : public CUDPPPlan
+{
+public:
+    CUDPPReduceByKeyPlan(CUDPPManager *mgr, CUDPPConfiguration config, size_t numElements);
+    virtual ~CUDPPReduceByKeyPlan();
+
+    bool                   m_b64BitKeys;    //!< @internal Keys are 64-bit rather than 32-bit
+    bool                   m_bUnsorted;     //!< @internal Keys are grouped by sorting them first
+    CUDPPScanPlan          *m_scanPlan;     //!< @internal Numbers the groups
+    CUDPPSegmentedScanPlan *m_segScanPlan;  //!< @internal Reduces the values of each group (0 without an operator)
+    CUDPPRadixSortPlan     *m_sortPlan;     //!< @internal Sorts unsorted keys with their positions
+    unsigned int           *m_d_flags;      //!< @internal Group head flags
+    unsigned int           *m_d_ranks;      //!< @internal Group of each head
+    void                   *m_d_scanned;    //!< @internal Segmented scan of the values
+    void                   *m_d_sortKeys;   //!< @internal Sorted keys (unsorted keys only)
+    unsigned int           *m_d_indices;    //!< @internal Original position of each sorted key (unsorted keys only)
+    void                   *m_d_sortValues; //!< @internal Values in the order of the sorted keys (unsorted keys only)
 };
 
 #endif // __CUDPP_PLAN_H__
@@ -0,0 +1,49 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+* @file
+* cudpp_reducebykey.h
+*
+* @brief Reduce-by-key functionality header file - contains CUDPP interface (not public)
+*/
+
+#ifndef _CUDPP_REDUCEBYKEY_H_
+#define _CUDPP_REDUCEBYKEY_H_
+
+class CUDPPReduceByKeyPlan;
+
+extern "C"
+void allocReduceByKeyStorage(CUDPPReduceByKeyPlan *plan);
+
+extern "C"
+void freeReduceByKeyStorage(CUDPPReduceByKeyPlan *plan);
+
+extern "C"
+void cudppReduceByKeyDispatch(void                       *d_keysOut,
+                              void                       *d_valuesOut,
+                              unsigned int               *d_counts,
+                              size_t                     *d_numUnique,
+                              const void                 *d_keys,
+                              const void                 *d_values,
+                              size_t                     numElements,
+                              const CUDPPReduceByKeyPlan *plan);
+
+extern "C"
+void cudppReduceByKeyHostDispatch(void                       *h_keysOut,
+                                  void                       *h_valuesOut,
+                                  unsigned int               *h_counts,
+                                  size_t                     *numUnique,
+                                  const void                 *h_keys,
+                                  const void                 *h_values,
+                                  size_t                     numElements,
+                                  const CUDPPReduceByKeyPlan *plan);
+
+#endif // _CUDPP_REDUCEBYKEY_H_
@@ -0,0 +1,187 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_rle.cpp
+ *
+ * @brief Host run-length encoder and decoder
+ *
+ * Like the device routines (rle_app.cu), these compare values as
+ * unsigned integers of the datatype's size, so both produce the same
+ * runs.
+ */
+
+#include "cudpp.h"
+
+#include <limits.h>
+#include <algorithm>
+
+/** @returns the size in bytes of a value of \a datatype, 0 if invalid */
+static size_t rleValueSize(CUDPPDatatype datatype)
+{
+    switch (datatype)
+    {
+    case CUDPP_CHAR:
+    case CUDPP_UCHAR:     return 1;
+    case CUDPP_SHORT:
+    case CUDPP_USHORT:    return 2;
+    case CUDPP_INT:
+    case CUDPP_UINT:
+    case CUDPP_FLOAT:     return 4;
+    case CUDPP_DOUBLE:
+    case CUDPP_LONGLONG:
+    case CUDPP_ULONGLONG: return 8;
+    default:              return 0;
+    }
+}
+
+/** @brief Run-length encode \a numElements values (at least one)
+  *
+  * The run boundaries of each group of 64 values are found with
+  * branch-free comparisons, which the compiler vectorizes, into a bit
+  * mask.  Groups inside a run, the common case for long runs, are
+  * skipped after a single test of the mask.
+  *
+  * @returns The number of runs
+  */
+template <class T>
+static size_t runLengthEncodeHost(T *values, unsigned int *runLengths,
+                                  const T *in, size_t numElements)
+{
+    size_t numRuns = 0;
+    size_t start = 0;
+    values[0] = in[0];
+
+    for (size_t base = 1; base < numElements; base += 64)
+    {
+        size_t count = std::min((size_t)64, numElements - base);
+        unsigned long long boundaries = 0;
+        for (size_t j = 0; j < count; j++)
+            boundaries |= (unsigned long long)(in[base + j] != in[base + j - 1]) << j;
+
+        for (size_t j = 0; boundaries != 0; j++, boundaries >>= 1)
+        {
+            if (boundaries & 1)
+            {
+                runLengths[numRuns++] = (unsigned int)(base + j - start);
+                start = base + j;
+                values[numRuns] = in[start];
+            }
+        }
+    }
+
+    runLengths[numRuns++] = (unsigned int)(numElements - start);
+    return numRuns;
+}
+
+/** @brief Expand \a numRuns runs */
+template <class T>
+static void runLengthDecodeHost(T *out, const T *values, const unsigned int *runLengths,
+                                size_t numRuns)
+{
+    for (size_t r = 0; r < numRuns; r++)
+    {
+        std::fill(out, out + runLengths[r], values[r]);
+        out += runLengths[r];
+    }
+}
+
+/** @brief Run-length encode an array in host memory
+  *
+  * The host counterpart of cudppRunLengthEncode(), producing the same
+  * runs.
+  *
+  * @param[out] values The value of each run, at most \a numElements
+  * @param[out] runLengths The length of each run, at most \a numElements
+  * @param[out] numRuns The number of runs
+  * @param[in]  in The values to encode
+  * @param[in]  numElements Number of values, at most 2^32-1
+  * @param[in]  datatype Type of the values
+  * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION for an invalid datatype or
+  *          more than 2^32-1 values, otherwise CUDPP_SUCCESS
+  *
+  * @see cudppRunLengthEncode, cudppRunLengthDecodeHost
+  */
+CUDPP_DLL
+CUDPPResult cudppRunLengthEncodeHost(void          *values,
+                                     unsigned int  *runLengths,
+                                     size_t        *numRuns,
+                                     const void    *in,
+                                     size_t        numElements,
+                                     CUDPPDatatype datatype)
+{
+    size_t valueSize = rleValueSize(datatype);
+    if (valueSize == 0 || numElements > UINT_MAX)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (numElements == 0)
+        *numRuns = 0;
+    else if (valueSize == 1)
+        *numRuns = runLengthEncodeHost((unsigned char*)values, runLengths,
+                                       (const unsigned char*)in, numElements);
+    else if (valueSize == 2)
+        *numRuns = runLengthEncodeHost((unsigned short*)values, runLengths,
+                                       (const unsigned short*)in, numElements);
+    else if (valueSize == 4)
+        *numRuns = runLengthEncodeHost((unsigned int*)values, runLengths,
+                                       (const unsigned int*)in, numElements);
+    else
+        *numRuns = runLengthEncodeHost((unsigned long long*)values, runLengths,
+                                       (const unsigned long long*)in, numElements);
+    return CUDPP_SUCCESS;
+}
+
+/** @brief Expand a run-length encoded array in host memory
+  *
+  * The host counterpart of cudppRunLengthDecode().  \a out receives as
+  * many values as the sum of the run lengths.
+  *
+  * @param[out] out The decoded values
+  * @param[in]  values The value of each run
+  * @param[in]  runLengths The length of each run
+  * @param[in]  numRuns Number of runs
+  * @param[in]  datatype Type of the values
+  * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION for an invalid datatype,
+  *          otherwise CUDPP_SUCCESS
+  *
+  * @see cudppRunLengthDecode, cudppRunLengthEncodeHost
+  */
+CUDPP_DLL
+CUDPPResult cudppRunLengthDecodeHost(void               *out,
+                                     const void         *values,
+                                     const unsigned int *runLengths,
+                                     size_t             numRuns,
+                                     CUDPPDatatype      datatype)
+{
+    size_t valueSize = rleValueSize(datatype);
+    if (valueSize == 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    if (valueSize == 1)
+        runLengthDecodeHost((unsigned char*)out, (const unsigned char*)values,
+                            runLengths, numRuns);
+    else if (valueSize == 2)
+        runLengthDecodeHost((unsigned short*)out, (const unsigned short*)values,
+                            runLengths, numRuns);
+    else if (valueSize == 4)
+        runLengthDecodeHost((unsigned int*)out, (const unsigned int*)values,
+                            runLengths, numRuns);
+    else
+        runLengthDecodeHost((unsigned long long*)out, (const unsigned long long*)values,
+                            runLengths, numRuns);
+    return CUDPP_SUCCESS;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
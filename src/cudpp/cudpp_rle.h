@@ -0,0 +1,45 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+* @file
+* cudpp_rle.h
+*
+* @brief Run-length encoding functionality header file - contains CUDPP interface (not public)
+*/
+
+#ifndef _CUDPP_RLE_H_
+#define _CUDPP_RLE_H_
+
+class CUDPPRunLengthPlan;
+
+extern "C"
+void allocRunLengthStorage(CUDPPRunLengthPlan *plan);
+
+extern "C"
+void freeRunLengthStorage(CUDPPRunLengthPlan *plan);
+
+extern "C"
+void cudppRunLengthEncodeDispatch(void                     *d_values,
+                                  unsigned int             *d_runLengths,
+                                  size_t                   *d_numRuns,
+                                  const void               *d_in,
+                                  size_t                   numElements,
+                                  const CUDPPRunLengthPlan *plan);
+
+extern "C"
+void cudppRunLengthDecodeDispatch(void                     *d_out,
+                                  const void               *d_values,
+                                  const unsigned int       *d_runLengths,
+                                  size_t                   numRuns,
+                                  size_t                   numElements,
+                                  const CUDPPRunLengthPlan *plan);
+
+#endif // _CUDPP_RLE_H_
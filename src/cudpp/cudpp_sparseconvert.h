@@ -0,0 +1,52 @@
+// -------------------------------------------------------------
+// CUDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// ------------------------------------------------------------- 
+// This source code is distributed under the terms of license.txt 
+// in the root directory of this source distribution.
+// ------------------------------------------------------------- 
+
+/**
+* @file
+* cudpp_sparseconvert.h
+*
+* @brief Sparse matrix conversion functionality header file - contains CUDPP interface (not public)
+*/
+
+#ifndef _CUDPP_SPARSECONVERT_H_
+#define _CUDPP_SPARSECONVERT_H_
+
+class CUDPPSparseConvertPlan;
+
+extern "C"
+void allocSparseConvertStorage(CUDPPSparseConvertPlan *plan);
+
+extern "C"
+void freeSparseConvertStorage(CUDPPSparseConvertPlan *plan);
+
+extern "C"
+void cudppSparseCooToCsrDispatch(unsigned int       *d_rowOffsets,
+                                 unsigned int       *d_colIndices,
+                                 void               *d_values,
+                                 const unsigned int *d_cooRows,
+                                 const unsigned int *d_cooCols,
+                                 const void         *d_cooValues,
+                                 size_t             numNonZeroElements,
+                                 size_t             numRows,
+                                 const CUDPPSparseConvertPlan *plan);
+
+extern "C"
+void cudppSparseTransposeDispatch(unsigned int       *d_tRowOffsets,
+                                  unsigned int       *d_tColIndices,
+                                  void               *d_tValues,
+                                  const unsigned int *d_rowOffsets,
+                                  const unsigned int *d_colIndices,
+                                  const void         *d_values,
+                                  size_t             numRows,
+                                  size_t             numCols,
+                                  size_t             numNonZeroElements,
+                                  const CUDPPSparseConvertPlan *plan);
+
+#endif // _CUDPP_SPARSECONVERT_H_
@@ -0,0 +1,862 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_sparseio.cpp
+ *
+ * @brief Host routines to read and write sparse matrix files
+ */
+
+// Matrix Market files larger than 2 GB need a 64-bit off_t for fstat()
+#if !defined(_WIN32) && !defined(_FILE_OFFSET_BITS)
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include "cudpp.h"
+#include "cudpp_globals.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/** @brief Header of the binary CSR file format
+  *
+  * Followed by numRows + 1 row offsets and numNonZeroElements column
+  * indices (32-bit unsigned), then numNonZeroElements values of the
+  * datatype, all in native byte order.
+  */
+struct SparseFileHeader
+{
+    char               magic[8];           //!< SPARSE_FILE_MAGIC
+    unsigned int       version;            //!< SPARSE_FILE_VERSION
+    unsigned int       datatype;           //!< CUDPPDatatype of the values
+    unsigned long long numRows;            //!< Number of rows
+    unsigned long long numCols;            //!< Number of columns
+    unsigned long long numNonZeroElements; //!< Number of nonzeros
+};
+
+static const char         SPARSE_FILE_MAGIC[8] = { 'C','U','D','P','P','C','S','R' };
+static const unsigned int SPARSE_FILE_VERSION = 1;
+
+/** @brief Size in bytes of a sparse matrix value, or 0 if unsupported */
+static size_t sparseValueSize(CUDPPDatatype datatype)
+{
+    switch (datatype)
+    {
+    case CUDPP_INT:
+    case CUDPP_UINT:
+    case CUDPP_FLOAT:
+        return 4;
+    case CUDPP_DOUBLE:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+/** @brief The contents of a sparse matrix file in memory
+  *
+  * The file is memory-mapped where possible, so that several threads can
+  * parse it in place without copying it through a read buffer.  Files that
+  * cannot be mapped (pipes, or too large for the address space) are read
+  * into memory instead.
+  */
+class SparseFileContents
+{
+public:
+    SparseFileContents()
+    : m_data(0), m_size(0), m_mapped(false)
+#ifdef _WIN32
+    , m_mapping(0)
+#endif
+    {}
+
+    ~SparseFileContents()
+    {
+        if (!m_mapped)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(m_mapping);
+#else
+        munmap((void*)m_data, m_size);
+#endif
+    }
+
+    /** Maps or reads \a filename; returns false if it cannot be read */
+    bool open(const char *filename)
+    {
+        if (map(filename))
+            return true;
+
+        FILE *fp = fopen(filename, "rb");
+        if (!fp)
+            return false;
+        const size_t chunk = 1 << 20;
+        size_t n;
+        do
+        {
+            m_buffer.resize(m_size + chunk);
+            n = fread(&m_buffer[m_size], 1, chunk, fp);
+            m_size += n;
+        } while (n == chunk);
+        bool ok = !ferror(fp);
+        fclose(fp);
+        m_data = m_size ? &m_buffer[0] : 0;
+        return ok;
+    }
+
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+
+private:
+    /** Maps a non-empty regular file read-only */
+    bool map(const char *filename)
+    {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0 &&
+            (unsigned long long)size.QuadPart <= (size_t)-1)
+        {
+            m_mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+            if (m_mapping)
+            {
+                m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+                if (m_data)
+                {
+                    m_size = (size_t)size.QuadPart;
+                    m_mapped = true;
+                }
+                else
+                    CloseHandle(m_mapping);
+            }
+        }
+        CloseHandle(file); // the mapping keeps the file open
+#else
+        int fd = ::open(filename, O_RDONLY);
+        if (fd < 0)
+            return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 &&
+            (unsigned long long)st.st_size <= (size_t)-1)
+        {
+            void *p = mmap(0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED)
+            {
+                m_data = (const char*)p;
+                m_size = (size_t)st.st_size;
+                m_mapped = true;
+            }
+        }
+        close(fd); // the mapping keeps the file open
+#endif
+        return m_mapped;
+    }
+
+    const char        *m_data;
+    size_t            m_size;
+    bool              m_mapped;
+    std::vector<char> m_buffer;
+#ifdef _WIN32
+    HANDLE            m_mapping;
+#endif
+};
+
+/** @brief Returns the line starting at \a pos in [line, lineEnd), without
+  * its newline, and advances \a pos to the next line
+  *
+  * @returns false at the end of the text
+  */
+inline bool nextLine(const char *&pos, const char *end, const char *&line, const char *&lineEnd)
+{
+    if (pos >= end)
+        return false;
+    const char *nl = (const char*)memchr(pos, '\n', end - pos);
+    line = pos;
+    lineEnd = nl ? nl : end;
+    pos = nl ? nl + 1 : end;
+    return true;
+}
+
+/** @brief Returns the start of the line following the one containing
+  * \a p - 1, so that a chunk boundary never splits a line */
+inline const char* nextLineStart(const char *p, const char *begin, const char *end)
+{
+    if (p <= begin || p >= end || p[-1] == '\n')
+        return p;
+    const char *nl = (const char*)memchr(p, '\n', end - p);
+    return nl ? nl + 1 : end;
+}
+
+inline const char* skipBlanks(const char *p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        ++p;
+    return p;
+}
+
+/** @brief Returns true if \a p ends a field: the end of the line or a blank */
+inline bool atFieldEnd(const char *p, const char *end)
+{
+    return p == end || *p == ' ' || *p == '\t' || *p == '\r';
+}
+
+/** @brief Parse an unsigned decimal integer
+  *
+  * @returns a pointer past the number, or null if there is no number, it
+  * is 2^40 or more, or it is not followed by a blank or the end of the line
+  */
+static const char* parseUnsigned(const char *p, const char *end, unsigned long long &value)
+{
+    p = skipBlanks(p, end);
+    const char *start = p;
+    unsigned long long v = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        v = v * 10 + (*p++ - '0');
+        if (v >= ((unsigned long long)1 << 40))
+            return 0;
+    }
+    value = v;
+    return (p == start || !atFieldEnd(p, end)) ? 0 : p;
+}
+
+/** @brief Parse a decimal floating-point number
+  *
+  * Numbers with at most 15 significant digits and a decimal exponent of
+  * at most 22 in magnitude, which covers nearly all Matrix Market files,
+  * are converted exactly with one multiplication or division.  Anything
+  * else is passed to strtod().
+  *
+  * @returns a pointer past the number, or null if there is no number or
+  * it is not followed by a blank or the end of the line, so that "1.5abc"
+  * is rejected rather than read as 1.5
+  */
+static const char* parseReal(const char *p, const char *end, double &value)
+{
+    static const double powersOf10[] =
+        { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+          1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+    p = skipBlanks(p, end);
+    const char *start = p;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    unsigned long long mantissa = 0;
+    int digits = 0, exponent = 0;
+    bool any = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
+    {
+        if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa) ++digits; }
+        else             ++exponent;
+    }
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p, any = true)
+        {
+            if (digits < 19) { mantissa = mantissa * 10 + (*p - '0'); if (mantissa) ++digits; --exponent; }
+        }
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E' || *p == 'd' || *p == 'D'))
+    {
+        const char *q = p + 1;
+        bool negativeExp = false;
+        if (q < end && (*q == '-' || *q == '+'))
+            negativeExp = (*q++ == '-');
+        int e = 0;
+        const char *digitsStart = q;
+        for (; q < end && *q >= '0' && *q <= '9'; ++q)
+            if (e < 100000) e = e * 10 + (*q - '0');
+        if (q > digitsStart)
+        {
+            exponent += negativeExp ? -e : e;
+            p = q;
+        }
+    }
+
+    if (any && digits <= 15 && exponent >= -22 && exponent <= 22)
+    {
+        double v = (double)mantissa;
+        v = (exponent < 0) ? v / powersOf10[-exponent] : v * powersOf10[exponent];
+        value = negative ? -v : v;
+        return atFieldEnd(p, end) ? p : 0;
+    }
+
+    // long mantissas, large exponents, inf and nan
+    char token[128];
+    const char *tokenEnd = start;
+    while (tokenEnd < end && *tokenEnd != ' ' && *tokenEnd != '\t' && *tokenEnd != '\r')
+        ++tokenEnd;
+    size_t length = std::min((size_t)(tokenEnd - start), sizeof(token) - 1);
+    memcpy(token, start, length);
+    token[length] = 0;
+    char *parsedEnd;
+    value = strtod(token, &parsedEnd);
+    if (parsedEnd == token || !atFieldEnd(start + (parsedEnd - token), end))
+        return 0;
+    return start + (parsedEnd - token);
+}
+
+/** @brief Case-insensitive match of the next word of a header line */
+static bool matchWord(const char *&p, const char *end, const char *word)
+{
+    p = skipBlanks(p, end);
+    const char *q = p;
+    for (; *word; ++word, ++q)
+    {
+        if (q == end || (*q | 0x20) != *word)
+            return false;
+    }
+    if (q < end && *q != ' ' && *q != '\t' && *q != '\r')
+        return false;
+    p = q;
+    return true;
+}
+
+/** Symmetry of a Matrix Market file */
+enum SparseSymmetry
+{
+    SPARSE_GENERAL,
+    SPARSE_SYMMETRIC,
+    SPARSE_SKEW_SYMMETRIC
+};
+
+/** Orders (column, value) pairs by column only, so that a stable sort
+  * keeps duplicate entries in file order */
+template <class T>
+struct SparseColumnLess
+{
+    bool operator()(const std::pair<unsigned int, T> &a,
+                    const std::pair<unsigned int, T> &b) const
+    {
+        return a.first < b.first;
+    }
+};
+
+/** @brief Returns true if the line is an entry, i.e. neither blank nor a comment */
+inline bool isEntryLine(const char *line, const char *lineEnd)
+{
+    const char *p = skipBlanks(line, lineEnd);
+    return p != lineEnd && *p != '%';
+}
+
+/** @brief Count the entry lines of one chunk of a Matrix Market file */
+static size_t countMatrixMarketEntries(const char *pos, const char *end)
+{
+    size_t count = 0;
+    const char *line, *lineEnd;
+    while (nextLine(pos, end, line, lineEnd))
+        count += isEntryLine(line, lineEnd);
+    return count;
+}
+
+/** @brief Parse the entries of one chunk of a Matrix Market file
+  *
+  * Entries are stored from index \a first on; those at or beyond
+  * \a declaredNonZeros (trailing lines after the declared entries) are
+  * ignored.
+  *
+  * @returns false on a malformed entry
+  */
+template <class T>
+bool parseMatrixMarketEntries(const char *pos, const char *end, size_t first,
+                              size_t declaredNonZeros, bool pattern,
+                              unsigned long long numRows, unsigned long long numCols,
+                              unsigned int *cooRows, unsigned int *cooCols, T *cooValues)
+{
+    size_t i = first;
+    const char *line, *lineEnd;
+    while (i < declaredNonZeros && nextLine(pos, end, line, lineEnd))
+    {
+        if (!isEntryLine(line, lineEnd))
+            continue;
+
+        const char *p = line;
+        unsigned long long row, col;
+        double value = 1;
+        if (!(p = parseUnsigned(p, lineEnd, row)) ||
+            !(p = parseUnsigned(p, lineEnd, col)) ||
+            (!pattern && !(p = parseReal(p, lineEnd, value))))
+            return false;
+        if (row < 1 || row > numRows || col < 1 || col > numCols)
+            return false;
+
+        cooRows[i] = (unsigned int)(row - 1);
+        cooCols[i] = (unsigned int)(col - 1);
+        cooValues[i] = (T)value;
+        ++i;
+    }
+    return true;
+}
+
+/** @brief Parse the entries of a Matrix Market coordinate file into CSR
+  *
+  * The text from \a body to \a end is split at line boundaries into
+  * chunks that are parsed in parallel with OpenMP: a first pass counts the
+  * entry lines of each chunk, so that the second pass can parse each chunk
+  * straight into its place in the coordinate arrays.  The entries are then
+  * counted per row (twice for the off-diagonal entries of symmetric
+  * matrices) and scattered into CSR order with a counting sort, which keeps
+  * entries of the same row in file order.  Rows whose columns are not
+  * sorted are then sorted, in parallel.
+  */
+template <class T>
+CUDPPResult readMatrixMarketEntries(const char *body, const char *end,
+                                    SparseSymmetry symmetry, bool pattern,
+                                    CUDPPSparseMatrixData *matrix, size_t declaredNonZeros)
+{
+    const unsigned int numRows = (unsigned int)matrix->numRows;
+    const unsigned int numCols = (unsigned int)matrix->numCols;
+
+    std::vector<unsigned int> cooRows(declaredNonZeros), cooCols(declaredNonZeros);
+    std::vector<T> cooValues(declaredNonZeros);
+
+    int numThreads = 1;
+#ifdef _OPENMP
+    numThreads = omp_get_max_threads();
+#endif
+    size_t bytes = end - body;
+    int numChunks = (int)std::min((size_t)(4 * numThreads), 
+                                  bytes / SPARSE_PARSE_CHUNK_SIZE + 1);
+
+    std::vector<const char*> chunkStart(numChunks + 1);
+    for (int c = 0; c <= numChunks; ++c)
+        chunkStart[c] = nextLineStart(body + bytes / numChunks * c, body, end);
+    chunkStart[numChunks] = end;
+
+    // first entry index of each chunk
+    std::vector<size_t> chunkFirst(numChunks + 1, 0);
+#pragma omp parallel for schedule(dynamic)
+    for (int c = 0; c < numChunks; ++c)
+        chunkFirst[c + 1] = countMatrixMarketEntries(chunkStart[c], chunkStart[c + 1]);
+    for (int c = 0; c < numChunks; ++c)
+        chunkFirst[c + 1] += chunkFirst[c];
+    if (chunkFirst[numChunks] < declaredNonZeros)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    int malformed = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+:malformed)
+    for (int c = 0; c < (declaredNonZeros ? numChunks : 0); ++c)
+    {
+        if (!parseMatrixMarketEntries(chunkStart[c], chunkStart[c + 1], chunkFirst[c],
+                                      declaredNonZeros, pattern, numRows, numCols,
+                                      &cooRows[0], &cooCols[0], &cooValues[0]))
+            ++malformed;
+    }
+    if (malformed)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    const size_t count = declaredNonZeros;
+
+    // count the entries of each row, including mirrored ones
+    std::vector<unsigned long long> offsets(numRows + 1, 0);
+    for (size_t i = 0; i < count; ++i)
+    {
+        offsets[cooRows[i] + 1]++;
+        if (symmetry != SPARSE_GENERAL && cooRows[i] != cooCols[i])
+            offsets[cooCols[i] + 1]++;
+    }
+    for (unsigned int r = 0; r < numRows; ++r)
+        offsets[r + 1] += offsets[r];
+
+    unsigned long long numNonZeros = offsets[numRows];
+    if (numNonZeros > UINT_MAX)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    matrix->numNonZeroElements = (size_t)numNonZeros;
+    matrix->rowOffsets = (unsigned int*)malloc((numRows + 1) * sizeof(unsigned int));
+    matrix->colIndices = (unsigned int*)malloc(std::max(numNonZeros, (unsigned long long)1) * sizeof(unsigned int));
+    matrix->values = malloc(std::max(numNonZeros, (unsigned long long)1) * sizeof(T));
+    if (!matrix->rowOffsets || !matrix->colIndices || !matrix->values)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    unsigned int *colIndices = matrix->colIndices;
+    T *values = (T*)matrix->values;
+    for (unsigned int r = 0; r <= numRows; ++r)
+        matrix->rowOffsets[r] = (unsigned int)offsets[r];
+
+    // scatter; offsets[r] advances to the end of row r
+    for (size_t i = 0; i < count; ++i)
+    {
+        unsigned int r = cooRows[i], c = cooCols[i];
+        unsigned long long k = offsets[r]++;
+        colIndices[k] = c;
+        values[k] = cooValues[i];
+        if (symmetry != SPARSE_GENERAL && r != c)
+        {
+            k = offsets[c]++;
+            colIndices[k] = r;
+            values[k] = (symmetry == SPARSE_SKEW_SYMMETRIC) ? (T)-cooValues[i] : cooValues[i];
+        }
+    }
+
+    int outOfMemory = 0;
+#pragma omp parallel reduction(+:outOfMemory)
+    {
+        std::vector<std::pair<unsigned int, T> > rowEntries;
+#pragma omp for schedule(dynamic, 1024)
+        for (long long r = 0; r < (long long)numRows; ++r)
+        {
+            unsigned int begin = matrix->rowOffsets[r], end = matrix->rowOffsets[r + 1];
+            unsigned int k = begin + 1;
+            while (k < end && colIndices[k - 1] <= colIndices[k])
+                ++k;
+            if (k >= end)
+                continue;
+
+            try
+            {
+                rowEntries.clear();
+                for (k = begin; k < end; ++k)
+                    rowEntries.push_back(std::make_pair(colIndices[k], values[k]));
+                std::stable_sort(rowEntries.begin(), rowEntries.end(), SparseColumnLess<T>());
+                for (k = begin; k < end; ++k)
+                {
+                    colIndices[k] = rowEntries[k - begin].first;
+                    values[k] = rowEntries[k - begin].second;
+                }
+            }
+            catch (std::bad_alloc &)
+            {
+                ++outOfMemory;
+            }
+        }
+    }
+
+    return outOfMemory ? CUDPP_ERROR_INSUFFICIENT_RESOURCES : CUDPP_SUCCESS;
+}
+
+/** @brief Read a Matrix Market coordinate file into \a matrix */
+static CUDPPResult readMatrixMarket(const SparseFileContents &contents, CUDPPDatatype datatype,
+                                    CUDPPSparseMatrixData *matrix)
+{
+    const char *pos = contents.begin(), *end = contents.end();
+    SparseSymmetry symmetry = SPARSE_GENERAL;
+    bool pattern = false;
+
+    // banner; files without one are read as general real matrices
+    const char *line, *lineEnd;
+    bool haveLine = nextLine(pos, end, line, lineEnd);
+    if (haveLine && lineEnd - line >= 14 && strncmp(line, "%%MatrixMarket", 14) == 0)
+    {
+        const char *p = line + 14;
+        if (!matchWord(p, lineEnd, "matrix") || !matchWord(p, lineEnd, "coordinate"))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION; // dense arrays are not supported
+
+        if (matchWord(p, lineEnd, "pattern"))
+            pattern = true;
+        else if (!matchWord(p, lineEnd, "real") && !matchWord(p, lineEnd, "double") &&
+                 !matchWord(p, lineEnd, "integer"))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION; // complex is not supported
+
+        if (matchWord(p, lineEnd, "symmetric") || matchWord(p, lineEnd, "hermitian"))
+            symmetry = SPARSE_SYMMETRIC;
+        else if (matchWord(p, lineEnd, "skew-symmetric"))
+            symmetry = SPARSE_SKEW_SYMMETRIC;
+        else if (!matchWord(p, lineEnd, "general"))
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+        haveLine = nextLine(pos, end, line, lineEnd);
+    }
+
+    // size line, after any comments
+    while (haveLine)
+    {
+        const char *p = skipBlanks(line, lineEnd);
+        if (p != lineEnd && *p != '%')
+            break;
+        haveLine = nextLine(pos, end, line, lineEnd);
+    }
+    if (!haveLine)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    unsigned long long numRows, numCols, numNonZeros;
+    const char *p = line;
+    if (!(p = parseUnsigned(p, lineEnd, numRows)) ||
+        !(p = parseUnsigned(p, lineEnd, numCols)) ||
+        !(p = parseUnsigned(p, lineEnd, numNonZeros)))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    if (numRows >= UINT_MAX || numCols >= UINT_MAX || numNonZeros > UINT_MAX ||
+        (symmetry != SPARSE_GENERAL && numRows != numCols))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    matrix->numRows = (size_t)numRows;
+    matrix->numCols = (size_t)numCols;
+
+    try
+    {
+        switch (datatype)
+        {
+        case CUDPP_FLOAT:
+            return readMatrixMarketEntries<float>(pos, end, symmetry, pattern, matrix, 
+                                                  (size_t)numNonZeros);
+        case CUDPP_DOUBLE:
+            return readMatrixMarketEntries<double>(pos, end, symmetry, pattern, matrix, 
+                                                   (size_t)numNonZeros);
+        case CUDPP_INT:
+            return readMatrixMarketEntries<int>(pos, end, symmetry, pattern, matrix, 
+                                                (size_t)numNonZeros);
+        case CUDPP_UINT:
+            return readMatrixMarketEntries<unsigned int>(pos, end, symmetry, pattern, matrix, 
+                                                         (size_t)numNonZeros);
+        default:
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+        }
+    }
+    catch (std::bad_alloc &)
+    {
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+}
+
+/** @brief Read a binary CSR file into \a matrix
+  *
+  * The arrays are copied from the mapped file directly into their final
+  * place, then checked: the row offsets must start at 0, never decrease
+  * and end at the number of nonzeros, and every column index must be
+  * less than the number of columns.
+  */
+static CUDPPResult readSparseBinary(const SparseFileContents &contents, CUDPPDatatype datatype,
+                                    CUDPPSparseMatrixData *matrix)
+{
+    SparseFileHeader header;
+    memcpy(&header, contents.begin(), sizeof(header));
+    if (header.version != SPARSE_FILE_VERSION || header.datatype != (unsigned int)datatype ||
+        header.numRows >= UINT_MAX || header.numCols >= UINT_MAX ||
+        header.numNonZeroElements > UINT_MAX)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    size_t numRows = (size_t)header.numRows;
+    size_t numNonZeros = (size_t)header.numNonZeroElements;
+    size_t valueSize = sparseValueSize(datatype);
+
+    matrix->numRows = numRows;
+    matrix->numCols = (size_t)header.numCols;
+    matrix->numNonZeroElements = numNonZeros;
+    matrix->rowOffsets = (unsigned int*)malloc((numRows + 1) * sizeof(unsigned int));
+    matrix->colIndices = (unsigned int*)malloc(std::max(numNonZeros, (size_t)1) * sizeof(unsigned int));
+    matrix->values = malloc(std::max(numNonZeros, (size_t)1) * valueSize);
+    if (!matrix->rowOffsets || !matrix->colIndices || !matrix->values)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    const char *p = contents.begin() + sizeof(header);
+    size_t offsetBytes = (numRows + 1) * sizeof(unsigned int);
+    size_t indexBytes = numNonZeros * sizeof(unsigned int);
+    size_t valueBytes = numNonZeros * valueSize;
+    if ((size_t)(contents.end() - p) < offsetBytes + indexBytes + valueBytes)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES; // short file
+
+    memcpy(matrix->rowOffsets, p, offsetBytes);
+    memcpy(matrix->colIndices, p + offsetBytes, indexBytes);
+    memcpy(matrix->values, p + offsetBytes + indexBytes, valueBytes);
+
+    if (matrix->rowOffsets[0] != 0 || matrix->rowOffsets[numRows] != numNonZeros)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    for (size_t row = 0; row < numRows; ++row)
+    {
+        if (matrix->rowOffsets[row + 1] < matrix->rowOffsets[row])
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+    unsigned int numCols = (unsigned int)header.numCols;
+    for (size_t i = 0; i < numNonZeros; ++i)
+    {
+        if (matrix->colIndices[i] >= numCols)
+            return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+
+    return CUDPP_SUCCESS;
+}
+
+/** @addtogroup publicInterface
+  * @{
+  */
+
+/** @name Sparse Matrix File Interface
+ * @{
+ */
+
+/** @brief Read a sparse matrix file into CSR arrays in host memory
+  *
+  * Reads either a Matrix Market coordinate file or a binary CSR file
+  * written by cudppWriteSparseMatrixFile(); the format is detected from
+  * the start of the file.  The result is in the form that
+  * cudppSparseMatrix() takes: \a matrix->rowOffsets has \a numRows + 1
+  * entries, of which cudppSparseMatrix() uses the first \a numRows, and
+  * the column indices within each row are sorted.
+  *
+  * Matrix Market files are memory-mapped (or, if that is not possible,
+  * read into memory whole), split into chunks at line boundaries and
+  * parsed in parallel with OpenMP using specialized integer and
+  * floating-point parsers, then converted to CSR with a counting sort, so
+  * reading a large file takes a few passes over memory rather than one
+  * stream operation per number.
+  * Real, integer and pattern (all values 1) files are supported, with
+  * general, symmetric, skew-symmetric and hermitian symmetry; the missing
+  * triangle of symmetric matrices is filled in.  Entries are 1-based in
+  * the file and 0-based in the result.  Duplicate entries are kept.
+  *
+  * Binary files are copied from the mapping directly into the result
+  * arrays, so loading a matrix cached with cudppWriteSparseMatrixFile() is
+  * limited by I/O rather than parsing.  A binary file must have been written with the
+  * requested \a datatype, and its row offsets and column indices are
+  * checked as for a text file.
+  *
+  * The arrays are allocated by this function and must be released with
+  * cudppFreeSparseMatrixData(), including after an error.
+  *
+  * @param[in] filename The file to read
+  * @param[in] datatype The datatype of the values: CUDPP_FLOAT, 
+  *            CUDPP_DOUBLE, CUDPP_INT or CUDPP_UINT
+  * @param[out] matrix The matrix read
+  * @returns CUDPP_ERROR_INSUFFICIENT_RESOURCES if the file cannot be read
+  *          or memory cannot be allocated, CUDPP_ERROR_ILLEGAL_CONFIGURATION
+  *          for malformed or unsupported files, otherwise CUDPP_SUCCESS
+  *
+  * @see cudppWriteSparseMatrixFile, cudppFreeSparseMatrixData, cudppSparseMatrix
+  */
+CUDPP_DLL
+CUDPPResult cudppReadSparseMatrixFile(const char            *filename,
+                                      CUDPPDatatype         datatype,
+                                      CUDPPSparseMatrixData *matrix)
+{
+    if (!matrix)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    memset(matrix, 0, sizeof(*matrix));
+    matrix->datatype = datatype;
+    if (sparseValueSize(datatype) == 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    try
+    {
+        SparseFileContents contents;
+        if (!contents.open(filename))
+            return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+        if ((size_t)(contents.end() - contents.begin()) >= sizeof(SparseFileHeader) &&
+            memcmp(contents.begin(), SPARSE_FILE_MAGIC, sizeof(SPARSE_FILE_MAGIC)) == 0)
+            return readSparseBinary(contents, datatype, matrix);
+        return readMatrixMarket(contents, datatype, matrix);
+    }
+    catch (std::bad_alloc &)
+    {
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+    }
+}
+
+/** @brief Write a CSR matrix in host memory to a binary file
+  *
+  * Writes \a matrix in a binary CSR format that cudppReadSparseMatrixFile()
+  * reads back without parsing, for example to cache a matrix that was
+  * read once from a Matrix Market file.  The file holds a small header
+  * followed by the arrays as they are in memory, in native byte order.
+  *
+  * @param[in] filename The file to write
+  * @param[in] matrix The matrix to write; \a matrix->rowOffsets must have
+  *            \a numRows + 1 entries
+  * @returns CUDPP_ERROR_INSUFFICIENT_RESOURCES if the file cannot be
+  *          written, CUDPP_ERROR_ILLEGAL_CONFIGURATION for an unsupported
+  *          datatype, otherwise CUDPP_SUCCESS
+  *
+  * @see cudppReadSparseMatrixFile
+  */
+CUDPP_DLL
+CUDPPResult cudppWriteSparseMatrixFile(const char                  *filename,
+                                       const CUDPPSparseMatrixData *matrix)
+{
+    size_t valueSize = matrix ? sparseValueSize(matrix->datatype) : 0;
+    if (valueSize == 0 || !matrix->rowOffsets ||
+        (matrix->numNonZeroElements && (!matrix->colIndices || !matrix->values)))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    SparseFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SPARSE_FILE_MAGIC, sizeof(SPARSE_FILE_MAGIC));
+    header.version = SPARSE_FILE_VERSION;
+    header.datatype = matrix->datatype;
+    header.numRows = matrix->numRows;
+    header.numCols = matrix->numCols;
+    header.numNonZeroElements = matrix->numNonZeroElements;
+
+    FILE *fp = fopen(filename, "wb");
+    if (!fp)
+        return CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+
+    size_t numNonZeros = matrix->numNonZeroElements;
+    bool ok = 
+        fwrite(&header, sizeof(header), 1, fp) == 1 &&
+        fwrite(matrix->rowOffsets, sizeof(unsigned int), matrix->numRows + 1, fp) == 
+            matrix->numRows + 1 &&
+        fwrite(matrix->colIndices, sizeof(unsigned int), numNonZeros, fp) == numNonZeros &&
+        fwrite(matrix->values, valueSize, numNonZeros, fp) == numNonZeros;
+
+    if (fclose(fp) != 0)
+        ok = false;
+
+    return ok ? CUDPP_SUCCESS : CUDPP_ERROR_INSUFFICIENT_RESOURCES;
+}
+
+/** @brief Free the arrays of a matrix read by cudppReadSparseMatrixFile()
+  *
+  * @param[in,out] matrix The matrix; its array pointers are set to null
+  * @returns CUDPPResult indicating success or error condition
+  *
+  * @see cudppReadSparseMatrixFile
+  */
+CUDPP_DLL
+CUDPPResult cudppFreeSparseMatrixData(CUDPPSparseMatrixData *matrix)
+{
+    if (!matrix)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    free(matrix->rowOffsets);
+    free(matrix->colIndices);
+    free(matrix->values);
+    matrix->rowOffsets = 0;
+    matrix->colIndices = 0;
+    matrix->values = 0;
+    return CUDPP_SUCCESS;
+}
+
+/** @} */ // end Sparse Matrix File Interface
+/** @} */ // end publicInterface
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -34,4 +34,10 @@ void cudppSparseMatrixVectorMultiplyDispatch(void
                                              const void                                *d_x,
                                              const CUDPPSparseMatrixVectorMultiplyPlan *plan);
 
+extern "C"
+void cudppSparseMatrixMatrixMultiplyDispatch(void                                      *d_Y,
+                                             const void                                *d_X,
+                                             size_t                                    numVectors,
+                                             const CUDPPSparseMatrixVectorMultiplyPlan *plan);
+
 #endif // _CUDPP_SPMVMULT_H_
@@ -31,4 +31,13 @@ CUDPPResult cudppTridiagonalDispatch(void *d_a,
                                      int numSystems, 
                                      const CUDPPTridiagonalPlan * plan);
 
+CUDPPResult cudppTridiagonalHostDispatch(const void *a, 
+                                         const void *b, 
+                                         const void *c, 
+                                         const void *d, 
+                                         void *x, 
+                                         int systemSize, 
+                                         int numSystems, 
+                                         const CUDPPTridiagonalPlan * plan);
+
 #endif //__CUDPP_TRIDIAGONAL_H__
@@ -0,0 +1,624 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * cudpp_tuning.cpp
+ *
+ * @brief Autotuning of plan parameters, and the tuning database that
+ * plans consult when they are created.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "cudpp.h"
+#include "cudpp_manager.h"
+#include "cudpp_tuning.h"
+#include "cudpp_globals.h"
+#include "cuda_util.h"
+
+/** @brief The tunable parameters of one algorithm and the values
+  * cudppAutotune() tries for each, in the order of CUDPPTuning::values */
+struct tunableAlgorithm
+{
+    CUDPPAlgorithm      algorithm;     //!< The algorithm
+    unsigned int        numParameters; //!< Number of tunable parameters
+    const unsigned int *candidates[CUDPPTuning::MAX_PARAMETERS]; //!< 0-terminated values of each
+};
+
+static const unsigned int reduceThreads[]   = { 64, 128, 256, 512, 0 };
+static const unsigned int reduceBlocks[]    = { 32, 64, 128, 256, 512, 1024, 0 };
+static const unsigned int mtfChunkSizes[]   = { 32, 64, 128, 256, 512, 1024, 0 };
+static const unsigned int listRankSublists[] = { 8, 16, 32, 64, 128, 0 };
+static const unsigned int ctaSizes[]        = { 64, 128, 256, 512, 0 };
+
+static const tunableAlgorithm tunableAlgorithms[] =
+{
+    { CUDPP_REDUCE,   2, { reduceThreads, reduceBlocks } },
+    { CUDPP_MTF,      1, { mtfChunkSizes } },
+    { CUDPP_LISTRANK, 1, { listRankSublists } },
+    { CUDPP_BWT,      1, { ctaSizes } },
+    { CUDPP_HUFFMAN,  1, { ctaSizes } },
+};
+
+static const size_t numTunableAlgorithms =
+    sizeof(tunableAlgorithms) / sizeof(tunableAlgorithms[0]);
+
+//! @returns the tunable parameters of \a algorithm, or null if it has none
+static const tunableAlgorithm* findTunableAlgorithm(CUDPPAlgorithm algorithm)
+{
+    for (size_t i = 0; i < numTunableAlgorithms; i++)
+    {
+        if (tunableAlgorithms[i].algorithm == algorithm)
+            return &tunableAlgorithms[i];
+    }
+    return 0;
+}
+
+/** @brief Device buffers and input used to time candidate configurations */
+struct tuningBuffers
+{
+    void  *d_in;   //!< Input values
+    void  *d_out;  //!< Output values
+    void  *d_next; //!< Next indices of a random list (list ranking only)
+    size_t head;   //!< Head of the list
+    void  *d_aux;  //!< BWT index, or Huffman code lengths and sub-block offsets
+};
+
+//! Fills \a data with deterministic pseudo-random bytes
+static void fillTuningBytes(std::vector<unsigned char> &data)
+{
+    unsigned int state = 12345;
+    for (size_t i = 0; i < data.size(); i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        data[i] = (unsigned char)(state >> 24);
+    }
+}
+
+//! Allocates the buffers to time \a numElements elements of \a config
+static void allocTuningBuffers(tuningBuffers &buffers,
+                               const CUDPPConfiguration &config,
+                               size_t numElements)
+{
+    size_t bytes = numElements * sizeof(double);
+    buffers.d_next = 0;
+    buffers.head = 0;
+    buffers.d_aux = 0;
+    CUDA_SAFE_CALL(cudaMalloc(&buffers.d_in, bytes));
+    CUDA_SAFE_CALL(cudaMalloc(&buffers.d_out, bytes));
+
+    if (config.algorithm == CUDPP_MTF || config.algorithm == CUDPP_BWT ||
+        config.algorithm == CUDPP_HUFFMAN)
+    {
+        // these depend on the symbols, so time them on noise; the BWT of
+        // zeros would take the most doubling rounds
+        std::vector<unsigned char> symbols(bytes);
+        fillTuningBytes(symbols);
+        CUDA_SAFE_CALL(cudaMemcpy(buffers.d_in, &symbols[0], bytes,
+                                  cudaMemcpyHostToDevice));
+    }
+    else
+    {
+        CUDA_SAFE_CALL(cudaMemset(buffers.d_in, 0, bytes));
+    }
+
+    if (config.algorithm == CUDPP_LISTRANK)
+    {
+        // a list through the nodes in random order
+        std::vector<int> order(numElements), next(numElements);
+        unsigned int state = 12345;
+        for (size_t i = 0; i < numElements; i++)
+            order[i] = (int)i;
+        for (size_t i = numElements - 1; i > 0; i--)
+        {
+            state = state * 1664525u + 1013904223u;
+            std::swap(order[i], order[state % (i + 1)]);
+        }
+        for (size_t i = 0; i + 1 < numElements; i++)
+            next[order[i]] = order[i + 1];
+        next[order[numElements - 1]] = -1;
+        buffers.head = order[0];
+
+        CUDA_SAFE_CALL(cudaMalloc(&buffers.d_next, numElements * sizeof(int)));
+        CUDA_SAFE_CALL(cudaMemcpy(buffers.d_next, &next[0], numElements * sizeof(int),
+                                  cudaMemcpyHostToDevice));
+    }
+
+    if (config.algorithm == CUDPP_BWT || config.algorithm == CUDPP_HUFFMAN)
+    {
+        // the code lengths of a 16-bit alphabet, then the sub-block offsets;
+        // d_out holds the CUDPP_HUFFMAN_MAX_WORDS() words of the stream
+        size_t numSubBlocks = 
+            (numElements + CUDPP_HUFFMAN_SUBBLOCK_SIZE - 1) / CUDPP_HUFFMAN_SUBBLOCK_SIZE;
+        CUDA_SAFE_CALL(cudaMalloc(&buffers.d_aux, 
+                                  65536 + (numSubBlocks + 1) * sizeof(unsigned int)));
+    }
+}
+
+static void freeTuningBuffers(tuningBuffers &buffers)
+{
+    CUDA_SAFE_CALL(cudaFree(buffers.d_in));
+    CUDA_SAFE_CALL(cudaFree(buffers.d_out));
+    if (buffers.d_next)
+        CUDA_SAFE_CALL(cudaFree(buffers.d_next));
+    if (buffers.d_aux)
+        CUDA_SAFE_CALL(cudaFree(buffers.d_aux));
+}
+
+//! Runs the algorithm of \a config once with \a plan
+static CUDPPResult runTuningCall(CUDPPHandle plan, const CUDPPConfiguration &config,
+                                 size_t numElements, const tuningBuffers &buffers)
+{
+    switch (config.algorithm)
+    {
+    case CUDPP_REDUCE:
+        return cudppReduce(plan, buffers.d_out, buffers.d_in, numElements);
+    case CUDPP_MTF:
+        return cudppMoveToFrontTransform(plan, buffers.d_in, buffers.d_out, numElements);
+    case CUDPP_LISTRANK:
+        return cudppListRank(plan, buffers.d_out, buffers.d_in, buffers.d_next,
+                             buffers.head, numElements);
+    case CUDPP_BWT:
+        return cudppBurrowsWheelerTransform(plan, buffers.d_in, buffers.d_out,
+                                            buffers.d_aux, numElements);
+    case CUDPP_HUFFMAN:
+        {
+            // encode and decode use the same CTA size; decoding restores
+            // the input, so it is decoded in place
+            unsigned char *d_lengths = (unsigned char*)buffers.d_aux;
+            unsigned int *d_offsets = (unsigned int*)(d_lengths + 65536);
+            CUDPPResult result = 
+                cudppHuffmanEncode(plan, (unsigned int*)buffers.d_out, d_lengths,
+                                   d_offsets, buffers.d_in, numElements);
+            if (result != CUDPP_SUCCESS)
+                return result;
+            return cudppHuffmanDecode(plan, buffers.d_in, (unsigned int*)buffers.d_out,
+                                      d_lengths, d_offsets, numElements);
+        }
+    default:
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    }
+}
+
+/** @brief Times one candidate configuration
+  *
+  * A plan is created with the candidate parameters, run once untimed and
+  * then timed over a few runs, of which the fastest is kept.
+  *
+  * @returns CUDPP_SUCCESS and the time in \a time, or the error of the
+  * plan or of a run
+  */
+static CUDPPResult timeTuning(CUDPPManager *mgr, const CUDPPTuning &tuning,
+                              const CUDPPConfiguration &config,
+                              size_t numElements,
+                              const tuningBuffers &buffers, float &time)
+{
+    const int numRuns = 3;
+
+    CUDPPHandle plan;
+    mgr->setTuningOverride(&tuning);
+    CUDPPResult result = cudppPlan(mgr->getHandle(), &plan, config, numElements, 1, 0);
+    mgr->setTuningOverride(0);
+    if (result != CUDPP_SUCCESS)
+        return result;
+
+    cudaEvent_t start, stop;
+    CUDA_SAFE_CALL(cudaEventCreate(&start));
+    CUDA_SAFE_CALL(cudaEventCreate(&stop));
+
+    result = runTuningCall(plan, config, numElements, buffers);
+    for (int i = 0; i < numRuns && result == CUDPP_SUCCESS; i++)
+    {
+        CUDA_SAFE_CALL(cudaEventRecord(start, 0));
+        result = runTuningCall(plan, config, numElements, buffers);
+        CUDA_SAFE_CALL(cudaEventRecord(stop, 0));
+        CUDA_SAFE_CALL(cudaEventSynchronize(stop));
+
+        float runTime;
+        CUDA_SAFE_CALL(cudaEventElapsedTime(&runTime, start, stop));
+        if (i == 0 || runTime < time)
+            time = runTime;
+    }
+
+    CUDA_SAFE_CALL(cudaEventDestroy(start));
+    CUDA_SAFE_CALL(cudaEventDestroy(stop));
+    cudppDestroyPlan(plan);
+    return result;
+}
+
+/** @addtogroup publicInterface
+  * @{
+  */
+
+/** @name Autotuning Interface
+ * @{
+ */
+
+/**
+ * @brief Measures the tunable parameters of an algorithm on the current
+ * device and records the fastest in the instance's tuning database.
+ *
+ * Every combination of candidate values of the algorithm's tunable
+ * parameters is timed on \a numElements elements of the datatype of
+ * \a config.  The fastest is stored in the tuning database of
+ * \a theCudpp, keyed by device, algorithm, datatype and the base-2 log
+ * of \a numElements.  Plans created afterwards by cudppPlan() use the
+ * entry with the nearest size for their device, algorithm and datatype,
+ * and otherwise use their built-in defaults.  Save the database with
+ * cudppSaveTuningDatabase() to reuse it in later runs.
+ *
+ * The tunable parameters are:
+ * - CUDPP_REDUCE: threads per block and maximum number of blocks
+ * - CUDPP_MTF: symbols per chunk (see cudppMoveToFrontChunkSize())
+ * - CUDPP_LISTRANK: mean number of nodes per sublist
+ * - CUDPP_BWT: threads per block (also used by CUDPP_COMPRESS, with the
+ *   MTF chunk size)
+ * - CUDPP_HUFFMAN: threads per block (also used by CUDPP_COMPRESS)
+ *
+ * Other algorithms are built around compile-time block sizes and work
+ * per thread, and are not tuned at run time: the scan's CTA size and 
+ * elements per thread size its shared memory and are template 
+ * parameters of every scan-based kernel, the Huffman decoder's lookup
+ * table is a static shared array and its sub-block size is part of the 
+ * stream format, and the hash tables are built by cudppHashTable(), 
+ * whose space usage the caller already chooses.
+ *
+ * Tuned parameters change only the speed of an algorithm, never its
+ * results, except for the rounding of floating-point reductions.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @param[in] config The configuration to tune (algorithm, datatype,
+ *                   operator and options)
+ * @param[in] numElements The size to tune for
+ * @returns CUDPP_ERROR_ILLEGAL_CONFIGURATION if the algorithm has no
+ * tunable parameters or \a numElements is 0, the error of cudppPlan()
+ * if no candidate could be planned, and CUDPP_SUCCESS otherwise
+ *
+ * @see cudppLoadTuningDatabase, cudppSaveTuningDatabase, cudppPlan
+ */
+CUDPP_DLL
+CUDPPResult cudppAutotune(CUDPPHandle              theCudpp,
+                          const CUDPPConfiguration *config,
+                          size_t                   numElements)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    if (config == NULL || numElements == 0)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    // deterministic plans ignore the tuning, so they have nothing to tune
+    const tunableAlgorithm *tunable = findTunableAlgorithm(config->algorithm);
+    if (tunable == NULL || (config->options & CUDPP_OPTION_DETERMINISTIC))
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+
+    tuningBuffers buffers;
+    allocTuningBuffers(buffers, *config, numElements);
+
+    // enumerate every combination of candidate values, like an odometer
+    unsigned int index[CUDPPTuning::MAX_PARAMETERS] = { 0 };
+    CUDPPTuning best;
+    bool haveBest = false;
+    CUDPPResult result = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    for (;;)
+    {
+        CUDPPTuning candidate;
+        candidate.numValues = tunable->numParameters;
+        candidate.time = 0;
+        for (unsigned int p = 0; p < tunable->numParameters; p++)
+            candidate.values[p] = tunable->candidates[p][index[p]];
+
+        if (CUDPPTuningDatabase::isValid(config->algorithm, candidate))
+        {
+            CUDPPResult r = timeTuning(mgr, candidate, *config, numElements,
+                                       buffers, candidate.time);
+            if (r == CUDPP_SUCCESS && (!haveBest || candidate.time < best.time))
+            {
+                best = candidate;
+                haveBest = true;
+            }
+            if (!haveBest)
+                result = r;
+        }
+
+        unsigned int p = 0;
+        for (; p < tunable->numParameters; p++)
+        {
+            if (tunable->candidates[p][++index[p]] != 0)
+                break;
+            index[p] = 0;
+        }
+        if (p == tunable->numParameters)
+            break;
+    }
+
+    freeTuningBuffers(buffers);
+
+    if (!haveBest)
+        return result;
+    mgr->getTuningDatabase().store(mgr->getDeviceKey(), config->algorithm,
+                                   config->datatype, numElements, best);
+    return CUDPP_SUCCESS;
+}
+
+/**
+ * @brief Adds the entries of a tuning database file to the tuning
+ * database of an instance of the CUDPP library.
+ *
+ * Entries replace those of the same device, algorithm, datatype and
+ * size.  A file may hold entries for several devices; plans only use
+ * those of the device of \a theCudpp.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @param[in] filename The file, written by cudppSaveTuningDatabase()
+ * @returns CUDPPResult indicating success or error condition;
+ * CUDPP_ERROR_UNKNOWN if the file cannot be read and
+ * CUDPP_ERROR_ILLEGAL_CONFIGURATION if it has an invalid entry, in which
+ * case no entry is added
+ *
+ * @see cudppAutotune, cudppSaveTuningDatabase
+ */
+CUDPP_DLL
+CUDPPResult cudppLoadTuningDatabase(CUDPPHandle theCudpp,
+                                    const char  *filename)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    if (filename == NULL)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    return mgr->getTuningDatabase().load(filename);
+}
+
+/**
+ * @brief Writes the tuning database of an instance of the CUDPP library
+ * to a file.
+ *
+ * The file is text, one entry per line: the device name (blanks
+ * replaced by underscores), the algorithm and datatype (as CUDPPAlgorithm
+ * and CUDPPDatatype values), the base-2 log of the size, the measured
+ * time in milliseconds, and the parameter values.  Lines starting with
+ * '#' are comments.
+ *
+ * @param[in] theCudpp the handle to the CUDPP instance
+ * @param[in] filename The file to write
+ * @returns CUDPPResult indicating success or error condition;
+ * CUDPP_ERROR_UNKNOWN if the file cannot be written
+ *
+ * @see cudppAutotune, cudppLoadTuningDatabase
+ */
+CUDPP_DLL
+CUDPPResult cudppSaveTuningDatabase(CUDPPHandle theCudpp,
+                                    const char  *filename)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(theCudpp);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    if (filename == NULL)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    return mgr->getTuningDatabase().save(filename);
+}
+
+/** @} */ // end Autotuning Interface
+/** @} */ // end publicInterface
+
+bool CUDPPTuningDatabase::Key::operator<(const Key &other) const
+{
+    if (device != other.device)       return device < other.device;
+    if (algorithm != other.algorithm) return algorithm < other.algorithm;
+    if (datatype != other.datatype)   return datatype < other.datatype;
+    return bucket < other.bucket;
+}
+
+//! @returns the size bucket of \a numElements: floor(log2(numElements))
+unsigned int CUDPPTuningDatabase::sizeBucket(size_t numElements)
+{
+    unsigned int bucket = 0;
+    while (numElements > 1)
+    {
+        numElements >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+/** @brief Checks the parameters of an algorithm before a plan uses them
+  *
+  * @returns true if \a tuning has the number of values of the tunable
+  * parameters of \a algorithm, and values its plans support
+  */
+bool CUDPPTuningDatabase::isValid(CUDPPAlgorithm algorithm, const CUDPPTuning &tuning)
+{
+    const tunableAlgorithm *tunable = findTunableAlgorithm(algorithm);
+    if (tunable == NULL || tuning.numValues != tunable->numParameters)
+        return false;
+
+    for (unsigned int p = 0; p < tuning.numValues; p++)
+    {
+        if (tuning.values[p] == 0)
+            return false;
+    }
+
+    switch (algorithm)
+    {
+    case CUDPP_REDUCE:
+        // power-of-two blocks the kernels are instantiated for, and the
+        // per-block results must fit in one block for the second pass
+        return (tuning.values[0] & (tuning.values[0] - 1)) == 0 &&
+               tuning.values[0] <= 512 &&
+               tuning.values[1] <= 2 * tuning.values[0];
+    case CUDPP_LISTRANK:
+        // shorter sublists would need more than LISTRANK_MAX_LEVELS levels
+        return tuning.values[0] >= 8;
+    case CUDPP_BWT:
+    case CUDPP_HUFFMAN:
+        // whole warps, within the CTA size of every supported device
+        return tuning.values[0] % WARP_SIZE == 0 && tuning.values[0] <= 512;
+    default:
+        return true;
+    }
+}
+
+/** @brief Finds the parameters to use for a plan
+  *
+  * @param[in]  device      The device key (see CUDPPManager::getDeviceKey())
+  * @param[in]  algorithm   The algorithm of the plan
+  * @param[in]  datatype    The datatype of the plan
+  * @param[in]  numElements The size of the plan
+  * @param[out] tuning      The entry of the nearest size bucket, if any
+  * @returns true if an entry was found
+  */
+bool CUDPPTuningDatabase::lookup(const std::string &device, CUDPPAlgorithm algorithm,
+                                 CUDPPDatatype datatype, size_t numElements,
+                                 CUDPPTuning &tuning) const
+{
+    if (m_entries.empty())
+        return false;
+
+    unsigned int bucket = sizeBucket(numElements);
+    unsigned int bestDistance = 0;
+    bool found = false;
+
+    Key first = { device, algorithm, datatype, 0 };
+    std::map<Key, CUDPPTuning>::const_iterator it = m_entries.lower_bound(first);
+    for (; it != m_entries.end() && it->first.device == device &&
+           it->first.algorithm == algorithm && it->first.datatype == datatype; ++it)
+    {
+        unsigned int distance = (it->first.bucket > bucket) ?
+            it->first.bucket - bucket : bucket - it->first.bucket;
+        if (!found || distance < bestDistance)
+        {
+            tuning = it->second;
+            bestDistance = distance;
+            found = true;
+        }
+    }
+    return found;
+}
+
+//! Adds or replaces the entry for a device, algorithm, datatype and size
+void CUDPPTuningDatabase::store(const std::string &device, CUDPPAlgorithm algorithm,
+                                CUDPPDatatype datatype, size_t numElements,
+                                const CUDPPTuning &tuning)
+{
+    Key key = { device, algorithm, datatype, sizeBucket(numElements) };
+    m_entries[key] = tuning;
+}
+
+/** @brief Reads a file written by save() and adds its entries
+  *
+  * @returns CUDPP_SUCCESS, CUDPP_ERROR_UNKNOWN if the file cannot be
+  * opened, or CUDPP_ERROR_ILLEGAL_CONFIGURATION if a line is malformed
+  * or has invalid parameters (nothing is added then)
+  */
+CUDPPResult CUDPPTuningDatabase::load(const char *filename)
+{
+    FILE *file = fopen(filename, "r");
+    if (!file)
+        return CUDPP_ERROR_UNKNOWN;
+
+    std::map<Key, CUDPPTuning> entries;
+    char line[1024];
+    CUDPPResult result = CUDPP_SUCCESS;
+    while (result == CUDPP_SUCCESS && fgets(line, sizeof(line), file))
+    {
+        char device[256];
+        int algorithm, datatype, consumed;
+        unsigned int bucket;
+        CUDPPTuning tuning;
+
+        if (line[0] == '#' || strspn(line, " \t\r\n") == strlen(line))
+            continue;
+        if (sscanf(line, "%255s %d %d %u %f%n", device, &algorithm, &datatype,
+                   &bucket, &tuning.time, &consumed) != 5 ||
+            algorithm < 0 || algorithm >= CUDPP_ALGORITHM_INVALID ||
+            datatype < 0 || datatype >= CUDPP_DATATYPE_INVALID || bucket >= 64)
+        {
+            result = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+            break;
+        }
+
+        // the parameter values run to the end of the line
+        const char *p = line + consumed;
+        tuning.numValues = 0;
+        for (;;)
+        {
+            char *end;
+            unsigned long value = strtoul(p, &end, 10);
+            if (end == p)
+                break;
+            if (tuning.numValues == CUDPPTuning::MAX_PARAMETERS)
+            {
+                tuning.numValues++;
+                break;
+            }
+            tuning.values[tuning.numValues++] = (unsigned int)value;
+            p = end;
+        }
+
+        if (!isValid((CUDPPAlgorithm)algorithm, tuning))
+        {
+            result = CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+            break;
+        }
+
+        Key key = { device, algorithm, datatype, bucket };
+        entries[key] = tuning;
+    }
+    fclose(file);
+
+    if (result == CUDPP_SUCCESS)
+    {
+        std::map<Key, CUDPPTuning>::const_iterator it;
+        for (it = entries.begin(); it != entries.end(); ++it)
+            m_entries[it->first] = it->second;
+    }
+    return result;
+}
+
+/** @brief Writes all entries to a file, one per line
+  *
+  * @returns CUDPP_SUCCESS, or CUDPP_ERROR_UNKNOWN if the file cannot be
+  * written
+  */
+CUDPPResult CUDPPTuningDatabase::save(const char *filename) const
+{
+    FILE *file = fopen(filename, "w");
+    if (!file)
+        return CUDPP_ERROR_UNKNOWN;
+
+    fprintf(file, "# CUDPP tuning database\n"
+                  "# device algorithm datatype log2(elements) time_ms values...\n");
+    std::map<Key, CUDPPTuning>::const_iterator it;
+    for (it = m_entries.begin(); it != m_entries.end(); ++it)
+    {
+        fprintf(file, "%s %d %d %u %g", it->first.device.c_str(),
+                it->first.algorithm, it->first.datatype, it->first.bucket,
+                it->second.time);
+        for (unsigned int p = 0; p < it->second.numValues; p++)
+            fprintf(file, " %u", it->second.values[p]);
+        fprintf(file, "\n");
+    }
+
+    bool ok = !ferror(file);
+    if (fclose(file) != 0)
+        ok = false;
+    return ok ? CUDPP_SUCCESS : CUDPP_ERROR_UNKNOWN;
+}
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
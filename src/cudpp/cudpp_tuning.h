@@ -0,0 +1,77 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+#ifndef __CUDPP_TUNING_H__
+#define __CUDPP_TUNING_H__
+
+#include <map>
+#include <string>
+#include "cudpp.h"
+
+/** @brief Values of the tunable parameters of one algorithm
+  *
+  * The meaning of each value depends on the algorithm:
+  * - CUDPP_REDUCE: threads per block, maximum number of blocks
+  * - CUDPP_MTF: symbols per chunk
+  * - CUDPP_LISTRANK: mean nodes per sublist
+  * - CUDPP_BWT, CUDPP_HUFFMAN: threads per CTA
+  */
+struct CUDPPTuning
+{
+    enum { MAX_PARAMETERS = 4 };
+
+    unsigned int numValues;               //!< Number of values used by the algorithm
+    unsigned int values[MAX_PARAMETERS];  //!< The parameter values
+    float        time;                    //!< Time measured by cudppAutotune(), in ms
+};
+
+/** @brief Measured configurations, by device, algorithm, datatype and size
+  *
+  * Sizes are bucketed by their base-2 logarithm.  A lookup returns the
+  * entry of the nearest bucket of the same device, algorithm and
+  * datatype, so a configuration tuned at one size is used for nearby
+  * sizes too.
+  */
+class CUDPPTuningDatabase
+{
+public:
+    bool lookup(const std::string &device, CUDPPAlgorithm algorithm,
+                CUDPPDatatype datatype, size_t numElements,
+                CUDPPTuning &tuning) const;
+    void store(const std::string &device, CUDPPAlgorithm algorithm,
+               CUDPPDatatype datatype, size_t numElements,
+               const CUDPPTuning &tuning);
+    CUDPPResult load(const char *filename);
+    CUDPPResult save(const char *filename) const;
+
+    static bool isValid(CUDPPAlgorithm algorithm, const CUDPPTuning &tuning);
+    static unsigned int sizeBucket(size_t numElements);
+
+private:
+    //! @internal Database key; the bucket is the base-2 log of the size
+    struct Key
+    {
+        std::string  device;
+        int          algorithm;
+        int          datatype;
+        unsigned int bucket;
+
+        bool operator<(const Key &other) const;
+    };
+
+    std::map<Key, CUDPPTuning> m_entries;
+};
+
+#endif // __CUDPP_TUNING_H__
+
+// Leave this at the end of the file
+// Local Variables:
+// mode:c++
+// c-file-style: "NVIDIA"
+// End:
@@ -28,77 +28,220 @@
  */
 
 /**
- * @brief Consolidate non-null elements - for each non-null element
- * in \a d_in write it to \a d_out, in the position specified by 
- * \a d_isValid. Called by compactArray().
+ * @brief Count the valid elements of each block's tile. Called by 
+ * compactArray().
  *
- * @param[out] d_out    Output array of compacted values.
- * @param[out] d_numValidElements The number of elements in d_in with valid flags set to 1.
- * @param[in]  d_indices Positions where non-null elements will go in d_out.
- * @param[in]  d_isValid Flags indicating valid (1) and invalid (0) elements.  
- *             Only valid elements will be copied to \a d_out.
- * @param[in]  d_in     The input array
- * @param[in]  numElements The length of the \a d_in in elements.
+ * Each block counts the flags of SCAN_ELTS_PER_THREAD * blockDim.x
+ * consecutive elements, the same tile that compactScatter() compacts
+ * with the same launch parameters.
  *
+ * @param[out] d_blockCounts Number of valid elements in the tile of each block
+ * @param[in]  d_isValid Flags indicating valid (1) and invalid (0) elements
+ * @param[in]  numElements The length of \a d_isValid in elements
  */
-template <class T, bool isBackward>
-__global__ void compactData(T                  *d_out, 
-                            size_t             *d_numValidElements,
-                            const unsigned int *d_indices, // Exclusive Sum-Scan Result
-                            const unsigned int *d_isValid,
-                            const T            *d_in,
-                            unsigned int       numElements)
+__global__ void compactCountValid(unsigned int       *d_blockCounts,
+                                  const unsigned int *d_isValid,
+                                  unsigned int       numElements)
 {
-    if (threadIdx.x == 0)
+    __shared__ unsigned int s_counts[SCAN_CTA_SIZE];
+
+    unsigned int iGlobal = blockIdx.x * (blockDim.x * SCAN_ELTS_PER_THREAD) + threadIdx.x;
+    unsigned int count = 0;
+
+    #pragma unroll
+    for (unsigned int i = 0; i < SCAN_ELTS_PER_THREAD; i++, iGlobal += blockDim.x)
     {
-        if (isBackward)
-            d_numValidElements[0] = d_isValid[0] + d_indices[0];
-        else
-            d_numValidElements[0] = d_isValid[numElements-1] + d_indices[numElements-1];
+        if (iGlobal < numElements && d_isValid[iGlobal] > 0)
+            count++;
     }
+    s_counts[threadIdx.x] = count;
+    __syncthreads();
 
-    // The index of the first element (in a set of eight) that this
-    // thread is going to set the flag for. We left shift
-    // blockDim.x by 3 since (multiply by 8) since each block of 
-    // threads processes eight times the number of threads in that
-    // block
-    unsigned int iGlobal = blockIdx.x * (blockDim.x << 3) + threadIdx.x;
-
-    // Repeat the following 8 (SCAN_ELTS_PER_THREAD) times
-    // 1. Check if data in input array d_in is null
-    // 2. If yes do nothing
-    // 3. If not write data to output data array d_out in
-    //    the position specified by d_isValid
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];
-    }
-    iGlobal += blockDim.x;  
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];       
-    }
-    iGlobal += blockDim.x;
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];
+    // a single block may have any number of threads up to SCAN_CTA_SIZE
+    for (unsigned int stride = SCAN_CTA_SIZE / 2; stride > 0; stride >>= 1)
+    {
+        if (threadIdx.x < stride && threadIdx.x + stride < blockDim.x)
+            s_counts[threadIdx.x] += s_counts[threadIdx.x + stride];
+        __syncthreads();
     }
-    iGlobal += blockDim.x;
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];
+
+    if (threadIdx.x == 0)
+        d_blockCounts[blockIdx.x] = s_counts[0];
+}
+
+/**
+ * @brief Add the tile counts of one segment to a 64-bit count of valid
+ * elements. Called by compactArray() for partitions of more than one segment.
+ *
+ * Launched as a single block of SCAN_CTA_SIZE threads.
+ *
+ * @param[in,out] d_numValidTotal Count of valid elements
+ * @param[in]  d_blockCounts Number of valid elements in each tile, from 
+ *             compactCountValid()
+ * @param[in]  numBlocks Number of tiles
+ */
+__global__ void compactAddValidTotal(size_t             *d_numValidTotal,
+                                     const unsigned int *d_blockCounts,
+                                     unsigned int       numBlocks)
+{
+    __shared__ size_t s_counts[SCAN_CTA_SIZE];
+
+    size_t count = 0;
+    for (unsigned int i = threadIdx.x; i < numBlocks; i += blockDim.x)
+        count += d_blockCounts[i];
+    s_counts[threadIdx.x] = count;
+    __syncthreads();
+
+    for (unsigned int stride = SCAN_CTA_SIZE / 2; stride > 0; stride >>= 1)
+    {
+        if (threadIdx.x < stride)
+            s_counts[threadIdx.x] += s_counts[threadIdx.x + stride];
+        __syncthreads();
     }
-    iGlobal += blockDim.x;
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];
+
+    if (threadIdx.x == 0)
+        d_numValidTotal[0] += s_counts[0];
+}
+
+/**
+ * @brief Compact or partition each block's tile of the input, given the 
+ * scanned tile counts. Called by compactArray().
+ *
+ * Each block reads the flags of its tile once, keeps them in registers,
+ * and scans them in shared memory to find the rank of every element in 
+ * the tile.  Adding the tile's offset from \a d_blockOffsets gives the 
+ * output position, so no per-element index array is written or read.
+ *
+ * Valid elements go to \a d_out in order (in reverse order if 
+ * \a isBackward).  If \a isPartition, the invalid elements follow all 
+ * the valid ones, in the same order.
+ *
+ * @param[out] d_out    Output array of compacted values
+ * @param[out] d_numValidElements The number of valid elements in \a d_isValid,
+ *             plus the output base offset
+ * @param[in]  d_outputBase Optional pointer to a 64-bit offset added to the
+ *             position of every valid element, used when compacting in 
+ *             segments.  May be null.
+ * @param[in]  d_blockOffsets Exclusive scan of \a d_blockCounts, backward
+ *             if \a isBackward
+ * @param[in]  d_blockCounts Number of valid elements in each tile, from 
+ *             compactCountValid()
+ * @param[in]  d_numValidTotal Number of valid elements of the whole input,
+ *             for partitions of more than one segment.  May be null if the
+ *             input is a single segment.
+ * @param[in]  numPreceding Number of elements in the segments processed 
+ *             before this one
+ * @param[in]  d_isValid Flags indicating valid (1) and invalid (0) elements
+ * @param[in]  d_in     The input array
+ * @param[in]  numElements The length of the \a d_in in elements
+ */
+template <class T, bool isBackward, bool isPartition>
+__global__ void compactScatter(T                        *d_out, 
+                               size_t                   *d_numValidElements,
+                               const size_t             *d_outputBase,
+                               const unsigned int       *d_blockOffsets,
+                               const unsigned int       *d_blockCounts,
+                               const size_t             *d_numValidTotal,
+                               size_t                   numPreceding,
+                               const unsigned int       *d_isValid,
+                               const T                  *d_in,
+                               unsigned int             numElements)
+{
+    __shared__ unsigned int s_ranks[SCAN_ELTS_PER_THREAD * SCAN_CTA_SIZE];
+    __shared__ unsigned int s_sums[2 * SCAN_CTA_SIZE];
+
+    size_t base = d_outputBase ? d_outputBase[0] : 0;
+
+    // the tile compacted last holds the segment's total count
+    unsigned int lastBlock = isBackward ? 0 : gridDim.x - 1;
+    size_t numValid = base + d_blockOffsets[lastBlock] + d_blockCounts[lastBlock];
+
+    if (blockIdx.x == 0 && threadIdx.x == 0)
+        d_numValidElements[0] = numValid;
+
+    if (isPartition && d_numValidTotal)
+        numValid = d_numValidTotal[0];
+
+    const unsigned int tileStart = blockIdx.x * (blockDim.x * SCAN_ELTS_PER_THREAD);
+
+    // load the flags with coalesced reads, keeping them in registers
+    unsigned int flags[SCAN_ELTS_PER_THREAD];
+
+    #pragma unroll
+    for (unsigned int i = 0; i < SCAN_ELTS_PER_THREAD; i++)
+    {
+        unsigned int iTile = i * blockDim.x + threadIdx.x;
+        flags[i] = (tileStart + iTile < numElements && d_isValid[tileStart + iTile] > 0);
+        s_ranks[iTile] = flags[i];
     }
-    iGlobal += blockDim.x;
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];
+    __syncthreads();
+
+    // each thread scans SCAN_ELTS_PER_THREAD consecutive flags of the tile
+    unsigned int *ranks = s_ranks + threadIdx.x * SCAN_ELTS_PER_THREAD;
+    unsigned int sum = 0;
+
+    #pragma unroll
+    for (unsigned int i = 0; i < SCAN_ELTS_PER_THREAD; i++)
+    {
+        unsigned int flag = ranks[i];
+        ranks[i] = sum;
+        sum += flag;
     }
-    iGlobal += blockDim.x;
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];
+
+    // then the threads scan their sums
+    unsigned int *sumsIn  = s_sums;
+    unsigned int *sumsOut = s_sums + SCAN_CTA_SIZE;
+    sumsIn[threadIdx.x] = sum;
+    __syncthreads();
+
+    for (unsigned int offset = 1; offset < blockDim.x; offset <<= 1)
+    {
+        unsigned int value = sumsIn[threadIdx.x];
+        if (threadIdx.x >= offset)
+            value += sumsIn[threadIdx.x - offset];
+        sumsOut[threadIdx.x] = value;
+        __syncthreads();
+
+        unsigned int *temp = sumsIn;
+        sumsIn = sumsOut;
+        sumsOut = temp;
     }
-    iGlobal += blockDim.x;
-    if (iGlobal < numElements && d_isValid[iGlobal] > 0) {
-        d_out[d_indices[iGlobal]] = d_in[iGlobal];
+
+    unsigned int threadOffset = sumsIn[threadIdx.x] - sum;
+    unsigned int tileValid = sumsIn[blockDim.x - 1];
+
+    #pragma unroll
+    for (unsigned int i = 0; i < SCAN_ELTS_PER_THREAD; i++)
+        ranks[i] += threadOffset;
+    __syncthreads();
+
+    // number of valid elements compacted before this tile
+    size_t validBase = base + d_blockOffsets[blockIdx.x];
+
+    #pragma unroll
+    for (unsigned int i = 0; i < SCAN_ELTS_PER_THREAD; i++)
+    {
+        unsigned int iTile = i * blockDim.x + threadIdx.x;
+        unsigned int iGlobal = tileStart + iTile;
+        if (iGlobal >= numElements)
+            break;
+
+        // number of valid elements of the tile that come before this one
+        unsigned int rank = s_ranks[iTile];
+        if (isBackward)
+            rank = tileValid - rank - flags[i];
+
+        if (flags[i])
+        {
+            d_out[validBase + rank] = d_in[iGlobal];
+        }
+        else if (isPartition)
+        {
+            // all elements, less the valid ones, that come before this one
+            size_t preceding = numPreceding + 
+                (isBackward ? numElements - 1 - iGlobal : iGlobal);
+            d_out[numValid + preceding - (validBase + rank)] = d_in[iGlobal];
+        }
     }
 }
 
@@ -0,0 +1,185 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * eulertour_kernel.cuh
+ *
+ * @brief CUDPP kernel-level Euler tour tree routines
+ */
+
+/** \addtogroup cudpp_kernel
+  * @{
+  */
+
+/** @name Euler Tour Functions
+ * @{
+ */
+
+// The Euler tour of a forest of n nodes visits 2n events: event v < n
+// enters node v, and event n + v leaves it.  The roots are treated as
+// children of a virtual node n, so the trees of a forest are toured one
+// after another.
+
+/** @brief Write the (parent, child) pair of each node
+ *
+ * Roots (negative parents) are given the virtual parent \a numNodes.
+ *
+ * @param[out] d_rows The parent of each node
+ * @param[out] d_cols The index of each node
+ * @param[in]  d_parent The parent of each node, negative for roots
+ * @param[in]  numNodes Number of nodes
+ */
+__global__ void treeParentRows(unsigned int *d_rows,
+                               unsigned int *d_cols,
+                               const int    *d_parent,
+                               unsigned int numNodes)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numNodes;
+         i += blockDim.x * gridDim.x)
+    {
+        int p = d_parent[i];
+        d_rows[i] = (p < 0) ? numNodes : (unsigned int)p;
+        d_cols[i] = i;
+    }
+}
+
+/** @brief Record the position of each node in the list of children
+ *
+ * @param[out] d_childPos The position of each node in \a d_children
+ * @param[in]  d_children The children of all nodes, grouped by parent
+ * @param[in]  numNodes Number of nodes
+ */
+__global__ void treeChildPositions(unsigned int       *d_childPos,
+                                   const unsigned int *d_children,
+                                   unsigned int       numNodes)
+{
+    for (unsigned int k = blockIdx.x * blockDim.x + threadIdx.x; k < numNodes;
+         k += blockDim.x * gridDim.x)
+    {
+        d_childPos[d_children[k]] = k;
+    }
+}
+
+/** @brief Link the events of the Euler tour into a list
+ *
+ * Entering a node is followed by entering its first child, or by leaving
+ * the node if it is a leaf.  Leaving a node is followed by entering its
+ * next sibling, or by leaving its parent if it is the last child.  The
+ * tour starts by entering the first root and ends by leaving the last.
+ *
+ * @param[out] d_next The next event of each event, -1 for the last
+ * @param[out] d_head The first event of the tour
+ * @param[in]  d_parent The parent of each node, negative for roots
+ * @param[in]  d_offsets The offset of the children of each node in
+ *             \a d_children, with the roots last (\a numNodes + 2 entries)
+ * @param[in]  d_children The children of all nodes, grouped by parent
+ * @param[in]  d_childPos The position of each node in \a d_children
+ * @param[in]  numNodes Number of nodes
+ */
+__global__ void treeEulerLinks(int                *d_next,
+                               int                *d_head,
+                               const int          *d_parent,
+                               const unsigned int *d_offsets,
+                               const unsigned int *d_children,
+                               const unsigned int *d_childPos,
+                               unsigned int       numNodes)
+{
+    unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+    if (i == 0)
+    {
+        unsigned int first = d_offsets[numNodes];
+        *d_head = (first < numNodes) ? (int)d_children[first] : 0;
+    }
+
+    for (; i < 2 * numNodes; i += blockDim.x * gridDim.x)
+    {
+        int next;
+        if (i < numNodes)
+        {
+            unsigned int begin = d_offsets[i];
+            next = (begin < d_offsets[i + 1]) ? (int)d_children[begin] : (int)(numNodes + i);
+        }
+        else
+        {
+            unsigned int v = i - numNodes;
+            int p = d_parent[v];
+            unsigned int parent = (p < 0) ? numNodes : (unsigned int)p;
+            unsigned int sibling = d_childPos[v] + 1;
+            if (sibling < d_offsets[parent + 1])
+                next = (int)d_children[sibling];
+            else
+                next = (p < 0) ? -1 : (int)(numNodes + parent);
+        }
+        d_next[i] = next;
+    }
+}
+
+/** @brief Scatter the depth step of each event to its place in the tour
+ *
+ * @param[out] d_steps +1 where the tour enters a node, -1 where it leaves
+ * @param[out] d_tour The node of each event of the tour, or null
+ * @param[in]  d_ranks The position of each event in the tour
+ * @param[in]  numNodes Number of nodes
+ */
+__global__ void treeEulerSteps(int                *d_steps,
+                               unsigned int       *d_tour,
+                               const unsigned int *d_ranks,
+                               unsigned int       numNodes)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < 2 * numNodes;
+         i += blockDim.x * gridDim.x)
+    {
+        unsigned int r = d_ranks[i];
+        bool enter = (i < numNodes);
+        d_steps[r] = enter ? 1 : -1;
+        if (d_tour)
+            d_tour[r] = enter ? i : i - numNodes;
+    }
+}
+
+/** @brief Compute per-node results from the ranked, scanned tour
+ *
+ * The depth of a node is the scanned step where the tour enters it, less
+ * one.  Before that event the tour has entered e nodes and left l, with
+ * e + l its position and e - l the depth, so the preorder index e is
+ * (position + depth) / 2.  The tour enters and leaves each node of a
+ * subtree between entering and leaving its root.
+ *
+ * @param[out] d_depth The depth of each node, or null
+ * @param[out] d_preorder The preorder index of each node, or null
+ * @param[out] d_subtreeSize The size of the subtree of each node, or null
+ * @param[in]  d_ranks The position of each event in the tour
+ * @param[in]  d_depths The inclusive scan of the steps of the tour
+ * @param[in]  numNodes Number of nodes
+ */
+__global__ void treeEulerResults(int                *d_depth,
+                                 unsigned int       *d_preorder,
+                                 unsigned int       *d_subtreeSize,
+                                 const unsigned int *d_ranks,
+                                 const int          *d_depths,
+                                 unsigned int       numNodes)
+{
+    for (unsigned int v = blockIdx.x * blockDim.x + threadIdx.x; v < numNodes;
+         v += blockDim.x * gridDim.x)
+    {
+        unsigned int enter = d_ranks[v];
+        int depth = d_depths[enter] - 1;
+        if (d_depth)
+            d_depth[v] = depth;
+        if (d_preorder)
+            d_preorder[v] = (enter + (unsigned int)depth) / 2;
+        if (d_subtreeSize)
+            d_subtreeSize[v] = (d_ranks[numNodes + v] - enter + 1) / 2;
+    }
+}
+
+/** @} */ // end Euler tour functions
+/** @} */ // end cudpp_kernel
@@ -0,0 +1,333 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * histogram_kernel.cuh
+ *
+ * @brief CUDPP kernel-level histogram routines
+ */
+
+#include <cudpp_globals.h>
+
+/** \addtogroup cudpp_kernel
+  * @{
+  */
+
+/** @name Histogram Functions
+ * @{
+ */
+
+// Each binning is a functor that returns the bin of a value, or numBins
+// if the value is not counted.  The host histogram uses the same functors,
+// so the host and device agree on every value.
+
+/** @brief One bin per integer key, from \a firstKey to firstKey + numBins - 1 */
+template <class T>
+struct HistogramKeyBins
+{
+    unsigned int numBins;  //!< Number of bins
+    long long    firstKey; //!< Key counted in bin 0
+
+    //! Nothing to cache
+    __device__ void cacheInShared(void *) {}
+    //! Shared memory needed by cacheInShared()
+    static size_t sharedBytes(unsigned int) { return 0; }
+
+    __host__ __device__ unsigned int operator()(T x) const
+    {
+        // modulo 2^64, keys below firstKey wrap to large offsets
+        unsigned long long offset =
+            (unsigned long long)(long long)x - (unsigned long long)firstKey;
+        return (offset < numBins) ? (unsigned int)offset : numBins;
+    }
+};
+
+/** @brief \a numBins equal-width bins from \a lowerLevel (inclusive) to
+  * lowerLevel + range (exclusive) */
+template <class T>
+struct HistogramUniformBins
+{
+    unsigned int numBins;    //!< Number of bins
+    double       lowerLevel; //!< Lower edge of bin 0
+    double       range;      //!< Width of all bins
+
+    //! Nothing to cache
+    __device__ void cacheInShared(void *) {}
+    //! Shared memory needed by cacheInShared()
+    static size_t sharedBytes(unsigned int) { return 0; }
+
+    __host__ __device__ unsigned int operator()(T x) const
+    {
+        // multiply before dividing, so that integer values on bin edges
+        // fall in the right bin; NaNs fail both tests
+        double offset = ((double)x - lowerLevel) * numBins / range;
+        if (!(offset >= 0) || !(offset < numBins))
+            return numBins;
+        return (unsigned int)offset;
+    }
+};
+
+/** @brief Bins between \a numBins + 1 nondecreasing edges; bin b counts
+  * edges[b] <= x < edges[b + 1] */
+template <class T>
+struct HistogramEdgeBins
+{
+    unsigned int numBins; //!< Number of bins
+    const T      *edges;  //!< numBins + 1 edges
+
+    //! Copy the edges to shared memory, and search them there
+    __device__ void cacheInShared(void *s_edges)
+    {
+        T *cached = (T*)s_edges;
+        for (unsigned int i = threadIdx.x; i <= numBins; i += blockDim.x)
+            cached[i] = edges[i];
+        edges = cached;
+    }
+    //! Shared memory needed by cacheInShared(), rounded up to 8 bytes
+    static size_t sharedBytes(unsigned int numBins)
+    {
+        return ((numBins + 1) * sizeof(T) + 7) & ~(size_t)7;
+    }
+
+    __host__ __device__ unsigned int operator()(T x) const
+    {
+        if (!(x >= edges[0]) || !(x < edges[numBins]))
+            return numBins;
+
+        // the last edge not greater than x
+        unsigned int lo = 0, hi = numBins;
+        while (hi - lo > 1)
+        {
+            unsigned int mid = (lo + hi) / 2;
+            if (edges[mid] <= x)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+};
+
+/** @brief Byte offset of the 8-bit counter of bin \a bin of thread \a tid
+  *
+  * The counters of four consecutive bins of a thread share one word, and
+  * the words of the threads are interleaved, so that each thread always
+  * updates its own bank of shared memory, whatever the bin.
+  */
+__device__ inline unsigned int histogramCounter(unsigned int bin,
+                                                unsigned int tid)
+{
+    return (((bin >> 2) * blockDim.x + tid) << 2) + (bin & 3);
+}
+
+/** @brief Count values into per-thread sub-histograms in shared memory,
+  * and write the histogram of each CTA. Called by histogramDevice().
+  *
+  * Each thread counts its values into its own 8-bit counters, so no
+  * atomic operations are needed.  Before any counter can overflow, after
+  * 255 values per thread, the CTA adds the counters of all threads to
+  * its 32-bit histogram and clears them.
+  *
+  * When \a valuesPerLoad is 4 (byte values), each thread loads four
+  * values at a time, and thread 0 of CTA 0 first counts the last
+  * numElements % 4 values.
+  *
+  * Shared memory holds the cached bins, if any, then the CTA's histogram
+  * and then the counters: Bins::sharedBytes() + numBins * 4 +
+  * blockDim.x * 4 * ceil(numBins / 4) bytes.  blockDim.x must be a
+  * multiple of 16.
+  *
+  * @param[out] d_partials The histogram of each CTA, numBins bins each
+  * @param[in]  d_in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  bins The binning
+  */
+template <class T, class Bins, unsigned int valuesPerLoad>
+__global__ void histogramSharedCounts(unsigned int *d_partials,
+                                      const T      *d_in,
+                                      size_t       numElements,
+                                      Bins         bins)
+{
+    extern __shared__ unsigned long long s_histogramStorage[];
+
+    const unsigned int numBins = bins.numBins;
+    const unsigned int numWords = (numBins + 3) >> 2;
+    const unsigned int loadsPerRound = 255 / valuesPerLoad;
+
+    unsigned char *s_storage = (unsigned char*)s_histogramStorage;
+    bins.cacheInShared(s_storage);
+    unsigned int  *s_totals   = (unsigned int*)(s_storage + Bins::sharedBytes(numBins));
+    unsigned char *s_counters = (unsigned char*)(s_totals + numBins);
+    unsigned int  *s_words    = (unsigned int*)s_counters;
+
+    for (unsigned int i = threadIdx.x; i < numBins; i += blockDim.x)
+        s_totals[i] = 0;
+    for (unsigned int i = threadIdx.x; i < numWords * blockDim.x; i += blockDim.x)
+        s_words[i] = 0;
+    __syncthreads();
+
+    // with 4 values per load the tail is counted first, which fits in the
+    // first round: 3 + 4 * (255 / 4) = 255
+    const size_t numLoads = numElements / valuesPerLoad;
+    if (valuesPerLoad > 1 && blockIdx.x == 0 && threadIdx.x == 0)
+    {
+        for (size_t i = numLoads * valuesPerLoad; i < numElements; i++)
+        {
+            unsigned int bin = bins(d_in[i]);
+            if (bin < numBins)
+                s_counters[histogramCounter(bin, threadIdx.x)]++;
+        }
+    }
+
+    const size_t stride = (size_t)gridDim.x * blockDim.x;
+
+    for (size_t roundStart = (size_t)blockIdx.x * blockDim.x; roundStart < numLoads;
+         roundStart += stride * loadsPerRound)
+    {
+        size_t i = roundStart + threadIdx.x;
+        for (unsigned int k = 0; k < loadsPerRound && i < numLoads; k++, i += stride)
+        {
+            if (valuesPerLoad == 4)
+            {
+                uchar4 v = ((const uchar4*)d_in)[i];
+                unsigned int bin;
+                bin = bins((T)v.x);
+                if (bin < numBins) s_counters[histogramCounter(bin, threadIdx.x)]++;
+                bin = bins((T)v.y);
+                if (bin < numBins) s_counters[histogramCounter(bin, threadIdx.x)]++;
+                bin = bins((T)v.z);
+                if (bin < numBins) s_counters[histogramCounter(bin, threadIdx.x)]++;
+                bin = bins((T)v.w);
+                if (bin < numBins) s_counters[histogramCounter(bin, threadIdx.x)]++;
+            }
+            else
+            {
+                unsigned int bin = bins(d_in[i]);
+                if (bin < numBins)
+                    s_counters[histogramCounter(bin, threadIdx.x)]++;
+            }
+        }
+        __syncthreads();
+
+        // add up and clear the counters of each bin, each thread starting
+        // at a different sub-histogram to spread the banks
+        for (unsigned int bin = threadIdx.x; bin < numBins; bin += blockDim.x)
+        {
+            unsigned int sum = 0;
+            for (unsigned int t = 0; t < blockDim.x; t++)
+            {
+                unsigned int tid = (t + threadIdx.x) % blockDim.x;
+                unsigned int c = histogramCounter(bin, tid);
+                sum += s_counters[c];
+                s_counters[c] = 0;
+            }
+            s_totals[bin] += sum;
+        }
+        __syncthreads();
+    }
+
+    for (unsigned int bin = threadIdx.x; bin < numBins; bin += blockDim.x)
+        d_partials[blockIdx.x * numBins + bin] = s_totals[bin];
+}
+
+/** @brief Add up the histograms of the CTAs of histogramSharedCounts()
+  *
+  * @param[out] d_histogram The histogram
+  * @param[in]  d_partials The histogram of each CTA
+  * @param[in]  numBins Number of bins
+  * @param[in]  numPartials Number of CTA histograms
+  */
+__global__ void histogramSumPartials(unsigned int       *d_histogram,
+                                     const unsigned int *d_partials,
+                                     unsigned int       numBins,
+                                     unsigned int       numPartials)
+{
+    for (unsigned int bin = blockIdx.x * blockDim.x + threadIdx.x; bin < numBins;
+         bin += blockDim.x * gridDim.x)
+    {
+        unsigned int sum = 0;
+        for (unsigned int p = 0; p < numPartials; p++)
+            sum += d_partials[p * numBins + bin];
+        d_histogram[bin] = sum;
+    }
+}
+
+/** @brief Write the bin of each value, to be sorted. Called by
+  * histogramDevice().
+  *
+  * Values that are not counted get bin \a numBins, which sorts last.
+  *
+  * @param[out] d_keys The bin of each value
+  * @param[in]  d_in The values
+  * @param[in]  numElements Number of values
+  * @param[in]  bins The binning
+  */
+template <class T, class Bins>
+__global__ void histogramBinKeys(unsigned int *d_keys,
+                                 const T      *d_in,
+                                 unsigned int numElements,
+                                 Bins         bins)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        d_keys[i] = bins(d_in[i]);
+    }
+}
+
+/** @brief Find the run of each bin in the sorted bins
+ *
+ * Writes the first and one past the last position of the run of each
+ * bin present; the difference is the bin's count.  \a d_bounds must be
+ * zeroed first, so that empty bins count zero.
+ *
+ * @param[out] d_bounds The start of each bin's run, then the ends
+ * @param[in]  d_sorted The sorted bins
+ * @param[in]  numElements Number of values
+ * @param[in]  numBins Number of bins; bins not less than this are not counted
+ */
+__global__ void histogramRunBounds(unsigned int       *d_bounds,
+                                   const unsigned int *d_sorted,
+                                   unsigned int       numElements,
+                                   unsigned int       numBins)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        unsigned int b = d_sorted[i];
+        if (b >= numBins)
+            continue;
+        if (i == 0 || d_sorted[i - 1] != b)
+            d_bounds[b] = i;
+        if (i == numElements - 1 || d_sorted[i + 1] != b)
+            d_bounds[numBins + b] = i + 1;
+    }
+}
+
+/** @brief Compute the count of each bin from its run bounds
+ *
+ * @param[out] d_histogram The histogram
+ * @param[in]  d_bounds The start of each bin's run, then the ends
+ * @param[in]  numBins Number of bins
+ */
+__global__ void histogramRunLengths(unsigned int       *d_histogram,
+                                    const unsigned int *d_bounds,
+                                    unsigned int       numBins)
+{
+    for (unsigned int b = blockIdx.x * blockDim.x + threadIdx.x; b < numBins;
+         b += blockDim.x * gridDim.x)
+    {
+        d_histogram[b] = d_bounds[numBins + b] - d_bounds[b];
+    }
+}
+
+/** @} */ // end histogram functions
+/** @} */ // end cudpp_kernel
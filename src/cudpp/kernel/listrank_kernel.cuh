@@ -9,12 +9,6 @@
 // ------------------------------------------------------------- 
 
 #include <cudpp_globals.h>
-#include "sharedmem.h"
-#include <stdio.h>
-
-#define LISTRANK_TOTAL 1024*1024
-#define LISTRANK_MAX 2048    // max number of threads dispatched
-#define LISTRANK_CTA_BLOCK 128       // threads per block
 
 /**
  * @file
@@ -31,103 +25,190 @@
  * @{
  */
 
-typedef unsigned int uint;
-typedef unsigned char uchar;
-typedef unsigned short ushort;
-
 /**
- * @brief Use pointer jumping to rank values. After ranking
- * the values, calculate the next set of indices. The number
- * of values ranked doubles at each kernel call. Called by
- * listRank().
+ * @brief Integer hash used to pick the splitters of a list
  *
- * @param[out] d_ranked_values Ranked values array
- * @param[in]  d_unranked_values Unranked values array
- * @param[in]  d_ping Next indices array for the current kernel call
- * @param[in]  d_pong Next indices array for the next kernel call
- * @param[in]  d_start_indices Holds the starting node indices
- *             for "ranking" threads. The number of "ranking" threads
- *             doubles at each stage.
- * @param[in]  step The number of "ranking" threads.
- * @param[in]  head Head node index of the linked-list.
- * @param[in]  numElts Number of nodes to rank
+ * @param[in] x The value to hash
+ * @returns A well-mixed 32-bit hash of \a x
+ */
+__device__ unsigned int listRankHash(unsigned int x)
+{
+    x = (x ^ 61) ^ (x >> 16);
+    x *= 9;
+    x = x ^ (x >> 4);
+    x *= 0x27d4eb2d;
+    x = x ^ (x >> 15);
+    return x;
+}
+
+/**
+ * @brief Clear the splitter marks of a list. Called by listRank().
  *
+ * @param[out] d_mark The sublist of each splitter node, -1 for other nodes
+ * @param[in]  numNodes Number of nodes in the list
  */
-template <typename T>
-__global__ void list_rank_kernel_soa_1(T*               d_ranked_values,
-                                       const T*         d_unranked_values,
-                                       const int*       d_ping,
-                                       int*             d_pong,
-                                       int*             d_start_indices,
-                                       int              step,
-                                       int              head,
-                                       int              numElts)
+__global__ void listRankClearMarks(int          *d_mark,
+                                   unsigned int numNodes)
 {
-    // Global, Local IDs
-    uint idx = threadIdx.x + (blockIdx.x * blockDim.x);
-
-    if(idx==0 && step==1) d_ranked_values[0] = d_unranked_values[head];
-
-    if(idx < step && (idx+step) < numElts)
-    {
-        // Only threads which are alive/dispatched compute here
-        int myhead = (idx==0) ? head : d_start_indices[idx-1];
-        int next_index = d_ping[myhead];
-
-        d_start_indices[idx+(step-1)] = next_index;
-        d_ranked_values[idx+step] = d_unranked_values[next_index];
-    }
-
-    // All threads work to calculate next neighbors
-    // (1, 2, 4, 8, etc. neigbbors away)
-    for(int i = (int)idx; i < numElts; i += LISTRANK_TOTAL)
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numNodes; i += blockDim.x * gridDim.x)
     {
-        int my_next_index = d_ping[i];
-        int val_to_store = -1;
-        if(my_next_index >= 0){
-            val_to_store = d_ping[my_next_index];
-        }
-        d_pong[i] = val_to_store;
+        d_mark[i] = -1;
     }
 }
 
 /**
- * @brief After pointer jumping is finished and all threads are
- * able to rank values, ranking continues serially. Each thread
- * ranks values until all values are ranked. Called by listRank().
+ * @brief Pick the splitters that cut a list into sublists. Called by
+ * listRank().
+ *
+ * Splitter 0 is the head of the list.  Splitter k > 0 is a pseudo-random
+ * node of the k-th of \a numSplitters - 1 equal ranges of node indices, so
+ * the splitters are distinct and fall at random positions along the list.
+ * Each splitter marks its node with its own index.
+ *
+ * @param[out] d_mark The sublist of each splitter node
+ * @param[out] d_splitterNode The node of each splitter
+ * @param[in]  numNodes Number of nodes in the list
+ * @param[in]  numSplitters Number of splitters
+ * @param[in]  head Head node of the list, used if \a d_head is null
+ * @param[in]  d_head Head node of the list in device memory, or null
+ * @param[in]  seed Seed mixed into the splitter choice
+ */
+__global__ void listRankPickSplitters(int          *d_mark,
+                                      int          *d_splitterNode,
+                                      unsigned int numNodes,
+                                      unsigned int numSplitters,
+                                      int          head,
+                                      const int    *d_head,
+                                      unsigned int seed)
+{
+    if (d_head)
+        head = *d_head;
+
+    for (unsigned int k = blockIdx.x * blockDim.x + threadIdx.x;
+         k < numSplitters; k += blockDim.x * gridDim.x)
+    {
+        int node = head;
+        if (k > 0)
+        {
+            unsigned int numRanges = numSplitters - 1;
+            unsigned int begin = (unsigned int)((unsigned long long)(k - 1) * numNodes / numRanges);
+            unsigned int end   = (unsigned int)((unsigned long long)k * numNodes / numRanges);
+            node = begin + listRankHash(k ^ seed) % (end - begin);
+            if (node == head)
+                node = (node + 1 < (int)end) ? node + 1 : node - 1;
+        }
+        d_splitterNode[k] = node;
+        d_mark[node] = k;
+    }
+}
+
+/**
+ * @brief Walk each sublist from its splitter to the next splitter.
+ * Called by listRank().
+ *
+ * Each thread follows one sublist serially, recording for each node its
+ * sublist and the sum of the weights of the nodes before it in the
+ * sublist.  The total weight of the sublist and the sublist that follows
+ * it form the (much shorter) list of splitters, which is ranked next.
+ *
+ * @param[out] d_sublist The sublist of each node
+ * @param[out] d_local The weight before each node within its sublist
+ * @param[out] d_splitterTotal The total weight of each sublist
+ * @param[out] d_splitterNext The sublist after each sublist, or -1
+ * @param[in]  d_next The next node of each node, or -1 at the tail
+ * @param[in]  d_weights The weight of each node, or null for weight 1
+ * @param[in]  d_mark The sublist of each splitter node, -1 for other nodes
+ * @param[in]  d_splitterNode The node of each splitter
+ * @param[in]  numSplitters Number of splitters
+ */
+__global__ void listRankWalk(int                *d_sublist,
+                             unsigned int       *d_local,
+                             unsigned int       *d_splitterTotal,
+                             int                *d_splitterNext,
+                             const int          *d_next,
+                             const unsigned int *d_weights,
+                             const int          *d_mark,
+                             const int          *d_splitterNode,
+                             unsigned int       numSplitters)
+{
+    for (unsigned int k = blockIdx.x * blockDim.x + threadIdx.x;
+         k < numSplitters; k += blockDim.x * gridDim.x)
+    {
+        int node = d_splitterNode[k];
+        unsigned int sum = 0;
+        int following;
+        for (;;)
+        {
+            d_sublist[node] = k;
+            d_local[node] = sum;
+            sum += d_weights ? d_weights[node] : 1;
+
+            int next = d_next[node];
+            if (next < 0)
+            {
+                following = -1;
+                break;
+            }
+            following = d_mark[next];
+            if (following >= 0)
+                break;
+            node = next;
+        }
+        d_splitterTotal[k] = sum;
+        d_splitterNext[k] = following;
+    }
+}
+
+/**
+ * @brief Add the offset of its sublist to the local offset of each node.
+ * Called by listRank() for all but the outermost list.
+ *
+ * @param[out] d_offsets The weight before each node in the whole list
+ * @param[in]  d_sublist The sublist of each node
+ * @param[in]  d_local The weight before each node within its sublist
+ * @param[in]  d_splitterOffset The weight before each sublist
+ * @param[in]  numNodes Number of nodes in the list
+ */
+__global__ void listRankBroadcast(unsigned int       *d_offsets,
+                                  const int          *d_sublist,
+                                  const unsigned int *d_local,
+                                  const unsigned int *d_splitterOffset,
+                                  unsigned int       numNodes)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numNodes; i += blockDim.x * gridDim.x)
+    {
+        d_offsets[i] = d_local[i] + d_splitterOffset[d_sublist[i]];
+    }
+}
+
+/**
+ * @brief Write each value to its rank in the list. Called by listRank()
+ * for the outermost list.
  *
  * @param[out] d_ranked_values Ranked values array
  * @param[in]  d_unranked_values Unranked values array
- * @param[in]  d_pong Next indices array for the current kernel call
- * @param[in]  d_start_indices Holds the starting node indices
- *             for "ranking" threads. The number of "ranking" threads
- *             doubles at each stage.
- * @param[in]  head Head node index of the linked-list.
- * @param[in]  numElts Number of nodes to rank
- *
+ * @param[in]  d_sublist The sublist of each node
+ * @param[in]  d_local The rank of each node within its sublist
+ * @param[in]  d_splitterOffset The rank of the first node of each sublist
+ * @param[in]  numNodes Number of nodes in the list
  */
 template <typename T>
-__global__ void list_rank_kernel_soa_2(T*               d_ranked_values,
-                                       const T*         d_unranked_values,
-                                       const int*       d_pong,
-                                       const int*       d_start_indices,
-                                       int              head,
-                                       int              numElts)
+__global__ void listRankScatter(T                  *d_ranked_values,
+                                const T            *d_unranked_values,
+                                const int          *d_sublist,
+                                const unsigned int *d_local,
+                                const unsigned int *d_splitterOffset,
+                                unsigned int       numNodes)
 {
-    // Global, Local IDs
-    uint idx = threadIdx.x + (blockIdx.x * blockDim.x);
-
-    int myIndex = (idx==0) ? head : d_start_indices[idx-1];
-
-    // No more threads to dispatch, each thread keeps chasing
-    // until end of string (start where we left off from prev kernel)
-    for(int j=((int)idx+LISTRANK_MAX); j<numElts; j += LISTRANK_MAX)
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numNodes; i += blockDim.x * gridDim.x)
     {
-        int val = d_pong[myIndex];
-        d_ranked_values[j] = d_unranked_values[val];
-        myIndex = val;
+        d_ranked_values[d_local[i] + d_splitterOffset[d_sublist[i]]] = 
+            d_unranked_values[i];
     }
 }
 
 /** @} */ // end listrank functions
-/** @} */ // end cudpp_kernel
\ No newline at end of file
+/** @} */ // end cudpp_kernel
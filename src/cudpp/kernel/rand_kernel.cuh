@@ -40,7 +40,7 @@
  */
 __global__ void gen_randMD5(uint4 *d_out, size_t numElements, unsigned int seed)
 {
-    unsigned int idx = blockIdx.x*blockDim.x + threadIdx.x;
+    size_t idx = (size_t)blockIdx.x*blockDim.x + threadIdx.x;
 
     unsigned int data[16];
     setupInput(data, seed);
@@ -144,6 +144,139 @@ __global__ void gen_randMD5(uint4 *d_out, size_t numElements, unsigned int seed)
         d_out[idx].w = result.w;
     }
 }
+/** @brief Distributions generated by gen_randPhilox() */
+enum PhiloxDistribution
+{
+    PHILOX_UNIFORM,     //!< Raw bits (unsigned int) or uniform on (0, 1]
+    PHILOX_NORMAL,      //!< Standard normal (Box-Muller)
+    PHILOX_EXPONENTIAL, //!< Exponential with rate 1
+};
+
+/**
+ * @brief Converts one Philox output block to four 32-bit values
+ *
+ * @param[in] r 128 random bits
+ * @param[out] v The values
+ * @param[in] dist The distribution (ignored: raw bits)
+ */
+__device__ void philoxValues(uint4 r, unsigned int v[4], PhiloxDistribution /*dist*/)
+{
+    v[0] = r.x; v[1] = r.y; v[2] = r.z; v[3] = r.w;
+}
+
+/**
+ * @brief Converts one Philox output block to four floats
+ *
+ * Normal values are generated in Box-Muller pairs from (x, y) and (z, w).
+ *
+ * @param[in] r 128 random bits
+ * @param[out] v The values
+ * @param[in] dist The distribution
+ */
+__device__ void philoxValues(uint4 r, float v[4], PhiloxDistribution dist)
+{
+    v[0] = philoxUniform(r.x);
+    v[1] = philoxUniform(r.y);
+    v[2] = philoxUniform(r.z);
+    v[3] = philoxUniform(r.w);
+
+    if (dist == PHILOX_NORMAL)
+    {
+        for (int i = 0; i < 4; i += 2)
+        {
+            float rad = sqrtf(-2.0f * logf(v[i]));
+            float s, c;
+            sincosf(6.2831853071795865f * v[i+1], &s, &c);
+            v[i]   = rad * c;
+            v[i+1] = rad * s;
+        }
+    }
+    else if (dist == PHILOX_EXPONENTIAL)
+    {
+        for (int i = 0; i < 4; i++)
+            v[i] = -logf(v[i]);
+    }
+}
+
+/**
+ * @brief Converts one Philox output block to two doubles
+ *
+ * Each double uses 64 random bits, so normal values form one Box-Muller
+ * pair per block.
+ *
+ * @param[in] r 128 random bits
+ * @param[out] v The values
+ * @param[in] dist The distribution
+ */
+__device__ void philoxValues(uint4 r, double v[2], PhiloxDistribution dist)
+{
+    v[0] = philoxUniform(r.x, r.y);
+    v[1] = philoxUniform(r.z, r.w);
+
+    if (dist == PHILOX_NORMAL)
+    {
+        double rad = sqrt(-2.0 * log(v[0]));
+        double s, c;
+        sincos(6.2831853071795865 * v[1], &s, &c);
+        v[0] = rad * c;
+        v[1] = rad * s;
+    }
+    else if (dist == PHILOX_EXPONENTIAL)
+    {
+        v[0] = -log(v[0]);
+        v[1] = -log(v[1]);
+    }
+}
+
+/**
+ * @brief Philox4x32-10 counter-based random number generation
+ *
+ * Element \a e of the stream (counting from the start of the stream, not of
+ * \a d_out) is value <tt>e % V</tt> of the Philox block with counter
+ * <tt>e / V</tt>, where \a V = 16 / sizeof(T) values are derived from each
+ * 128-bit block.  This kernel writes elements <tt>offset</tt> to
+ * <tt>offset + numElements - 1</tt> to \a d_out, so a sequence generated
+ * in several calls (or on several devices) with consecutive offsets is
+ * identical to one generated in a single call.  Each thread generates
+ * one block per iteration of a grid-stride loop.
+ *
+ * @param[out] d_out The output array
+ * @param[in] numElements The number of elements to generate
+ * @param[in] offset The position in the stream of the first element
+ * @param[in] key The key (seed and stream)
+ * @param[in] dist The distribution
+ *
+ * @see launchRandPhiloxKernel()
+ */
+template <class T>
+__global__ void gen_randPhilox(T *d_out, 
+                               size_t numElements, 
+                               unsigned long long offset, 
+                               uint2 key,
+                               PhiloxDistribution dist)
+{
+    const unsigned int V = 16 / sizeof(T);
+    const unsigned long long firstBlock = offset / V;
+    const unsigned long long numBlocks = (offset + numElements - 1) / V - firstBlock + 1;
+
+    for (unsigned long long b = (size_t)blockIdx.x * blockDim.x + threadIdx.x;
+         b < numBlocks; 
+         b += (size_t)gridDim.x * blockDim.x)
+    {
+        unsigned long long block = firstBlock + b;
+        uint4 ctr = make_uint4((unsigned int)block, (unsigned int)(block >> 32), 0, 0);
+        T v[16 / sizeof(T)];
+        philoxValues(philox4x32(ctr, key), v, dist);
+
+        for (unsigned int j = 0; j < V; j++)
+        {
+            unsigned long long e = block * V + j;
+            if (e >= offset && e - offset < numElements)
+                d_out[e - offset] = v[j];
+        }
+    }
+}
+
 /** @} */ // end rand functions
 /** @} */ // end cudpp_kernel
 
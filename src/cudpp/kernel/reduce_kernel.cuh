@@ -36,21 +36,26 @@
   * overall cost of the algorithm while keeping the work complexity O(n) and the step complexity 
   * O(log n). (Brent's Theorem optimization)
   *
+  * Template parameter \a T is the type in which elements are combined, on 
+  * which \a Oper operates.  \a TIn and \a TOut, the types of the input and
+  * output, are \a T except for float reductions that accumulate in double
+  * (::CUDPP_OPTION_ACCUMULATE_DOUBLE).
+  *
   * @param[out] odata The output data pointer.  Each block writes a single output element.
   * @param[in]  idata The input data pointer.  
   * @param[in]  n     The number of elements to be reduced.
 */
-template <typename T, class Oper, unsigned int blockSize, bool nIsPow2>
-__global__ void reduce(T *odata, const T *idata, unsigned int n)
+template <typename T, class Oper, unsigned int blockSize, bool nIsPow2, typename TIn, typename TOut>
+__global__ void reduce(TOut *odata, const TIn *idata, size_t n)
 {
     Oper op;
 
     if (blockSize == 1)
     {
         if (n == 1)
-            odata[0] = idata[0];
+            odata[0] = (TOut)(T)idata[0];
         else if (n == 2)
-            odata[0] = op(idata[0], idata[1]);
+            odata[0] = (TOut)op((T)idata[0], (T)idata[1]);
     }
     else
     {
@@ -59,9 +64,11 @@ __global__ void reduce(T *odata, const T *idata, unsigned int n)
 
         // perform first level of reduction,
         // reading from global memory, writing to shared memory
+        // i and gridSize are 64-bit so that arrays of more than 2^32 elements 
+        // can be reduced
         unsigned int tid = threadIdx.x;
-        unsigned int i = blockIdx.x*(blockSize*2) + threadIdx.x;
-        unsigned int gridSize = blockSize*2*gridDim.x;
+        size_t i = (size_t)blockIdx.x*(blockSize*2) + threadIdx.x;
+        size_t gridSize = (size_t)blockSize*2*gridDim.x;
         T mySum = op.identity();
 
         // we reduce multiple elements per thread.  The number is determined by the 
@@ -69,10 +76,10 @@ __global__ void reduce(T *odata, const T *idata, unsigned int n)
         // in a larger gridSize and therefore fewer elements per thread
         while (i < n)
         {         
-            mySum = op(mySum, idata[i]);
+            mySum = op(mySum, (T)idata[i]);
             // ensure we don't read out of bounds -- this is optimized away for powerOf2 sized arrays
             if (nIsPow2 || i + blockSize < n) 
-                mySum = op(mySum, idata[i+blockSize]);  
+                mySum = op(mySum, (T)idata[i+blockSize]);  
             i += gridSize;
         } 
 
@@ -96,7 +103,7 @@ __global__ void reduce(T *odata, const T *idata, unsigned int n)
 
         // write result for this block to global mem 
         if (tid == 0) 
-            odata[blockIdx.x] = sdata[0];
+            odata[blockIdx.x] = (TOut)sdata[0];
     }   
 }
 
@@ -0,0 +1,154 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * reducebykey_kernel.cuh
+ *
+ * @brief CUDPP kernel-level reduce-by-key and unique routines
+ */
+
+#include <cudpp_globals.h>
+
+/** \addtogroup cudpp_kernel
+  * @{
+  */
+
+/** @name Reduce By Key Functions
+ * @{
+ */
+
+/** @brief Flag the first key of each group of equal adjacent keys
+ *
+ * Keys are 32- or 64-bit unsigned words, so keys are equal when their
+ * bits are.
+ *
+ * @param[out] d_flags 1 for the first key of each group, 0 elsewhere
+ * @param[in]  d_keys The keys
+ * @param[in]  numElements Number of keys
+ */
+template <class K>
+__global__ void reduceByKeyFlagHeads(unsigned int *d_flags,
+                                     const K      *d_keys,
+                                     unsigned int numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        d_flags[i] = (i == 0 || d_keys[i] != d_keys[i - 1]) ? 1 : 0;
+    }
+}
+
+/** @brief Write the key and the start of each group, and the number of groups
+ *
+ * @param[out] d_keysOut The key of each group
+ * @param[out] d_starts The first position of each group, or NULL
+ * @param[out] d_numUnique The number of groups
+ * @param[in]  d_flags 1 for the first key of each group
+ * @param[in]  d_ranks Exclusive scan of \a d_flags
+ * @param[in]  d_keys The keys
+ * @param[in]  numElements Number of keys
+ */
+template <class K>
+__global__ void reduceByKeyScatterHeads(K                  *d_keysOut,
+                                        unsigned int       *d_starts,
+                                        size_t             *d_numUnique,
+                                        const unsigned int *d_flags,
+                                        const unsigned int *d_ranks,
+                                        const K            *d_keys,
+                                        unsigned int       numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        if (d_flags[i])
+        {
+            d_keysOut[d_ranks[i]] = d_keys[i];
+            if (d_starts)
+                d_starts[d_ranks[i]] = i;
+        }
+        if (i == numElements - 1)
+            *d_numUnique = d_ranks[i] + d_flags[i];
+    }
+}
+
+/** @brief Write the reduced value and the size of each group from its last
+ *  position
+ *
+ * The last position of a group holds, after an inclusive segmented scan,
+ * the reduction of the group's values.  Its size is the position that
+ * follows minus the group's start, written by reduceByKeyScatterHeads().
+ *
+ * @param[out] d_valuesOut The reduced value of each group, or NULL
+ * @param[in,out] d_counts The start of each group in, its size out, or NULL
+ * @param[in]  d_scanned Inclusive segmented scan of the values
+ * @param[in]  d_flags 1 for the first key of each group
+ * @param[in]  d_ranks Exclusive scan of \a d_flags
+ * @param[in]  numElements Number of keys
+ */
+template <class V>
+__global__ void reduceByKeyScatterTails(V                  *d_valuesOut,
+                                        unsigned int       *d_counts,
+                                        const V            *d_scanned,
+                                        const unsigned int *d_flags,
+                                        const unsigned int *d_ranks,
+                                        unsigned int       numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        if (i == numElements - 1 || d_flags[i + 1])
+        {
+            unsigned int group = d_ranks[i] + d_flags[i] - 1;
+            if (d_valuesOut)
+                d_valuesOut[group] = d_scanned[i];
+            if (d_counts)
+                d_counts[group] = i + 1 - d_counts[group];
+        }
+    }
+}
+
+/** @brief Write the position of each key, to be sorted along with the keys
+ *
+ * @param[out] d_indices The identity permutation
+ * @param[in]  numElements Number of keys
+ */
+__global__ void reduceByKeyIndices(unsigned int *d_indices,
+                                   unsigned int numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        d_indices[i] = i;
+    }
+}
+
+/** @brief Move the values into the order of the sorted keys
+ *
+ * @param[out] d_out The values of the sorted keys
+ * @param[in]  d_in The values
+ * @param[in]  d_indices The original position of each sorted key
+ * @param[in]  numElements Number of values
+ */
+template <class V>
+__global__ void reduceByKeyGather(V                  *d_out,
+                                  const V            *d_in,
+                                  const unsigned int *d_indices,
+                                  unsigned int       numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        d_out[i] = d_in[d_indices[i]];
+    }
+}
+
+/** @} */ // end reduce by key functions
+/** @} */ // end cudpp_kernel
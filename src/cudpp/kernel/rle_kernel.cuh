@@ -0,0 +1,153 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * rle_kernel.cuh
+ *
+ * @brief CUDPP kernel-level run-length encoding routines
+ */
+
+#include <cudpp_globals.h>
+
+/** \addtogroup cudpp_kernel
+  * @{
+  */
+
+/** @name Run-Length Encoding Functions
+ * @{
+ */
+
+/** @brief Flag the first value of each run
+ *
+ * Values are compared as unsigned integers of their size, so runs are
+ * runs of identical bits.
+ *
+ * @param[out] d_flags 1 for the first value of each run, 0 elsewhere
+ * @param[in]  d_in The values
+ * @param[in]  numElements Number of values
+ */
+template <class T>
+__global__ void rleFlagHeads(unsigned int *d_flags,
+                             const T      *d_in,
+                             unsigned int numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        d_flags[i] = (i == 0 || d_in[i] != d_in[i - 1]) ? 1 : 0;
+    }
+}
+
+/** @brief Write the value and the start of each run, and the number of runs
+ *
+ * @param[out] d_values The value of each run
+ * @param[out] d_starts The first position of each run
+ * @param[out] d_numRuns The number of runs
+ * @param[in]  d_flags 1 for the first value of each run
+ * @param[in]  d_ranks Exclusive scan of \a d_flags
+ * @param[in]  d_in The values
+ * @param[in]  numElements Number of values
+ */
+template <class T>
+__global__ void rleScatterHeads(T                  *d_values,
+                                unsigned int       *d_starts,
+                                size_t             *d_numRuns,
+                                const unsigned int *d_flags,
+                                const unsigned int *d_ranks,
+                                const T            *d_in,
+                                unsigned int       numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        if (d_flags[i])
+        {
+            d_values[d_ranks[i]] = d_in[i];
+            d_starts[d_ranks[i]] = i;
+        }
+        if (i == numElements - 1)
+            *d_numRuns = d_ranks[i] + d_flags[i];
+    }
+}
+
+/** @brief Replace the start of each run with its length
+ *
+ * The last value of each run subtracts the run's start, written by
+ * rleScatterHeads(), from the position that follows it.
+ *
+ * @param[in,out] d_runLengths The start of each run in, its length out
+ * @param[in]  d_flags 1 for the first value of each run
+ * @param[in]  d_ranks Exclusive scan of \a d_flags
+ * @param[in]  numElements Number of values
+ */
+__global__ void rleRunLengths(unsigned int       *d_runLengths,
+                              const unsigned int *d_flags,
+                              const unsigned int *d_ranks,
+                              unsigned int       numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        if (i == numElements - 1 || d_flags[i + 1])
+        {
+            unsigned int run = d_ranks[i] + d_flags[i] - 1;
+            d_runLengths[run] = i + 1 - d_runLengths[run];
+        }
+    }
+}
+
+/** @brief Write the index of each nonempty run at its first output position
+ *
+ * \a d_runIndex must be zeroed first; a max-scan then gives every output
+ * position the index of its run.
+ *
+ * @param[out] d_runIndex The run index at the start of each run
+ * @param[in]  d_offsets Exclusive scan of the run lengths
+ * @param[in]  d_runLengths The length of each run
+ * @param[in]  numRuns Number of runs
+ * @param[in]  numElements Number of output values
+ */
+__global__ void rleMarkRuns(unsigned int       *d_runIndex,
+                            const unsigned int *d_offsets,
+                            const unsigned int *d_runLengths,
+                            unsigned int       numRuns,
+                            unsigned int       numElements)
+{
+    for (unsigned int r = blockIdx.x * blockDim.x + threadIdx.x; r < numRuns;
+         r += blockDim.x * gridDim.x)
+    {
+        if (d_runLengths[r] > 0 && d_offsets[r] < numElements)
+            d_runIndex[d_offsets[r]] = r;
+    }
+}
+
+/** @brief Write the value of its run to each output position
+ *
+ * @param[out] d_out The decoded values
+ * @param[in]  d_values The value of each run
+ * @param[in]  d_runIndex The run of each output position
+ * @param[in]  numElements Number of output values
+ */
+template <class T>
+__global__ void rleExpand(T                  *d_out,
+                          const T            *d_values,
+                          const unsigned int *d_runIndex,
+                          unsigned int       numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x; i < numElements;
+         i += blockDim.x * gridDim.x)
+    {
+        d_out[i] = d_values[d_runIndex[i]];
+    }
+}
+
+/** @} */ // end run-length encoding functions
+/** @} */ // end cudpp_kernel
@@ -121,5 +121,28 @@ __global__ void scan4(T            *d_out,
 
 }
 
+/**
+  * @brief Update the carry between the segments of a long scan
+  *
+  * Scans longer than ::SCAN_MAX_SEGMENT_SIZE are performed one segment at a
+  * time.  After a segment has been scanned and combined with the incoming
+  * carry, this single-thread kernel computes the total of all elements up to
+  * and including the end of the segment, which becomes the carry into the
+  * next segment.  For exclusive scans the last scanned output does not
+  * include the last input, so the input (saved in \a d_carry[1] before the
+  * segment was scanned, since the scan may be in place) is combined in.
+  *
+  * @param[in,out] d_carry  d_carry[0] receives the carry; d_carry[1] holds the
+  *                         last input of the segment for exclusive scans
+  * @param[in]     d_last   Pointer to the last scanned output of the segment
+  */
+template<class T, class Oper, bool isExclusive>
+__global__ void scanSegmentCarry(T       *d_carry,
+                                 const T *d_last)
+{
+    Oper op;
+    d_carry[0] = isExclusive ? op(d_last[0], d_carry[1]) : d_last[0];
+}
+
 /** @} */ // end scan functions
 /** @} */ // end cudpp_kernel
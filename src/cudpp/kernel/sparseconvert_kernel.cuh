@@ -0,0 +1,160 @@
+// -------------------------------------------------------------
+// cuDPP -- CUDA Data Parallel Primitives library
+// -------------------------------------------------------------
+// $Revision$
+// $Date$
+// -------------------------------------------------------------
+// This source code is distributed under the terms of license.txt
+// in the root directory of this source distribution.
+// -------------------------------------------------------------
+
+/**
+ * @file
+ * sparseconvert_kernel.cuh
+ *
+ * @brief CUDPP kernel-level sparse matrix format conversion routines
+ */
+
+/** \addtogroup cudpp_kernel
+  * @{
+  */
+
+/** @name Sparse Matrix Conversion Functions
+* @{
+*/
+
+#include <cudpp_globals.h>
+
+/**
+  * @brief Build the sort keys of a set of nonzeros
+  *
+  * The key of nonzero \a i is its major index (the row, for conversion to
+  * CSR) in the upper 32 bits and its minor index in the lower 32 bits, so
+  * sorting the keys orders the nonzeros by row and then by column.  The
+  * position \a i is stored alongside so the values can be permuted after
+  * the sort.
+  *
+  * @param[out] d_keys The sort key of each nonzero
+  * @param[out] d_permutation The position of each nonzero
+  * @param[in] d_major The major (row) index of each nonzero
+  * @param[in] d_minor The minor (column) index of each nonzero
+  * @param[in] numNonZeroElements The number of nonzeros
+  */
+__global__
+void sparseMakeKeys(unsigned long long *d_keys,
+                    unsigned int       *d_permutation,
+                    const unsigned int *d_major,
+                    const unsigned int *d_minor,
+                    unsigned int       numNonZeroElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numNonZeroElements; i += blockDim.x * gridDim.x)
+    {
+        d_keys[i] = ((unsigned long long)d_major[i] << 32) | d_minor[i];
+        d_permutation[i] = i;
+    }
+}
+
+/**
+  * @brief Expand CSR row offsets to the row index of each nonzero
+  *
+  * Each thread binary-searches the row offsets for the last row starting
+  * at or before its nonzero, so the work per thread does not depend on the
+  * row lengths and empty rows are skipped correctly.
+  *
+  * @param[out] d_rows The row of each nonzero
+  * @param[in] d_rowOffsets The CSR row offsets (\a numRows + 1 entries)
+  * @param[in] numRows The number of rows
+  * @param[in] numNonZeroElements The number of nonzeros
+  */
+__global__
+void sparseExpandRows(unsigned int       *d_rows,
+                      const unsigned int *d_rowOffsets,
+                      unsigned int       numRows,
+                      unsigned int       numNonZeroElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numNonZeroElements; i += blockDim.x * gridDim.x)
+    {
+        // largest row r with d_rowOffsets[r] <= i
+        unsigned int lo = 0, hi = numRows;
+        while (hi - lo > 1)
+        {
+            unsigned int mid = (lo + hi) >> 1;
+            if (d_rowOffsets[mid] <= i)
+                lo = mid;
+            else
+                hi = mid;
+        }
+        d_rows[i] = lo;
+    }
+}
+
+/**
+  * @brief Compute CSR offsets from the sorted keys
+  *
+  * Thread \a i (for \a i in 0 .. \a numNonZeroElements) writes the offset
+  * of every row that starts at position \a i: the rows after the row of
+  * nonzero i-1, up to and including the row of nonzero i (or all remaining
+  * rows, for the thread past the end).  Empty rows get the offset of the
+  * next nonzero, and every one of the \a numMajor + 1 offsets is written
+  * exactly once.
+  *
+  * @param[out] d_offsets The CSR offsets (\a numMajor + 1 entries)
+  * @param[in] d_keys The sorted keys from sparseMakeKeys()
+  * @param[in] numNonZeroElements The number of nonzeros
+  * @param[in] numMajor The number of rows
+  */
+__global__
+void sparseOffsetsFromKeys(unsigned int             *d_offsets,
+                           const unsigned long long *d_keys,
+                           unsigned int             numNonZeroElements,
+                           unsigned int             numMajor)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i <= numNonZeroElements; i += blockDim.x * gridDim.x)
+    {
+        long long prev = (i == 0) ? -1 : (long long)(d_keys[i - 1] >> 32);
+        long long cur = (i == numNonZeroElements) ? (long long)numMajor 
+                                                  : (long long)(d_keys[i] >> 32);
+        for (long long r = prev + 1; r <= cur; ++r)
+            d_offsets[r] = i;
+
+        if (i == numNonZeroElements)
+            break;
+    }
+}
+
+/**
+  * @brief Write the minor indices and permuted values of the sorted nonzeros
+  *
+  * Template parameter \a T is a type of the same size as the values; they
+  * are moved, not interpreted.
+  *
+  * @param[out] d_minorOut The minor (column) index of each sorted nonzero
+  * @param[out] d_valuesOut The value of each sorted nonzero, or null
+  * @param[in] d_keys The sorted keys from sparseMakeKeys()
+  * @param[in] d_permutation The original position of each sorted nonzero
+  * @param[in] d_values The values in their original order, or null
+  * @param[in] numNonZeroElements The number of nonzeros
+  */
+template <class T>
+__global__
+void sparseGatherSorted(unsigned int             *d_minorOut,
+                        T                        *d_valuesOut,
+                        const unsigned long long *d_keys,
+                        const unsigned int       *d_permutation,
+                        const T                  *d_values,
+                        unsigned int             numNonZeroElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numNonZeroElements; i += blockDim.x * gridDim.x)
+    {
+        d_minorOut[i] = (unsigned int)d_keys[i];
+        if (d_values)
+            d_valuesOut[i] = d_values[d_permutation[i]];
+    }
+}
+
+/** @} */ // end sparse matrix conversion functions
+/** @} */ // end cudpp_kernel
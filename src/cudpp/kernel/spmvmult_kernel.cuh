@@ -12,7 +12,7 @@
  * @file
  * spmvmult_kernel.cu
  *
- * @brief CUDPP kernel-level scan routines
+ * @brief CUDPP kernel-level sparse matrix-vector multiply routines
  */
 
 /** \defgroup cudpp_kernel CUDPP Kernel-Level API
@@ -33,255 +33,634 @@
 
 #include <cudpp_globals.h>
 #include <cudpp_util.h>
+#include "sharedmem.h"
 
-/** 
-  * @brief Fetch and multiply kernel
+/** @brief Sparse matrix value stored as IEEE 754 half precision */
+struct spmvHalf
+{
+    unsigned short bits; //!< The binary16 bit pattern
+};
+
+/** @brief Sparse matrix value stored as bfloat16 (the upper half of a float) */
+struct spmvBfloat16
+{
+    unsigned short bits; //!< The upper 16 bits of the float bit pattern
+};
+
+/** @brief Convert an IEEE half-precision bit pattern to float */
+__device__ float spmvHalfToFloat(unsigned short h)
+{
+    unsigned int sign = (unsigned int)(h & 0x8000) << 16;
+    unsigned int exponent = (h >> 10) & 0x1f;
+    unsigned int mantissa = h & 0x3ff;
+
+    if (exponent == 0x1f)       // infinity or NaN
+        return __int_as_float(sign | 0x7f800000 | (mantissa << 13));
+    if (exponent == 0)          // zero or subnormal: mantissa * 2^-24
+    {
+        float f = (float)mantissa * 5.9604644775390625e-8f;
+        return sign ? -f : f;
+    }
+    return __int_as_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+/** @brief Load a matrix value stored in the datatype itself */
+template <class T>
+__device__ T spmvValue(T v) { return v; }
+
+/** @brief Load a half-precision matrix value, widening to \a T */
+template <class T>
+__device__ T spmvValue(spmvHalf v) { return (T)spmvHalfToFloat(v.bits); }
+
+/** @brief Load a bfloat16 matrix value, widening to \a T */
+template <class T>
+__device__ T spmvValue(spmvBfloat16 v) { return (T)__int_as_float((unsigned int)v.bits << 16); }
+
+/** @brief Column of nonzero \a j with 32-bit column indices */
+__device__ unsigned int spmvColumn(const unsigned int *d_index,
+                                   const unsigned int * /*d_indexBase*/,
+                                   unsigned int j)
+{
+    return d_index[j];
+}
+
+/** @brief Column of nonzero \a j with 16-bit column indices: an offset from
+  * the base column of its block of ::SPMV_INDEX_BLOCK_SIZE nonzeros */
+__device__ unsigned int spmvColumn(const unsigned short *d_index,
+                                   const unsigned int   *d_indexBase,
+                                   unsigned int         j)
+{
+    return d_indexBase[j / SPMV_INDEX_BLOCK_SIZE] + d_index[j];
+}
+
+/**
+  * @brief Row-per-thread CSR kernel
   *
-  * This __global__ device function takes an element from the vector d_A, finds its 
-  * column in d_indx and multiplies the element from d_A with its 
-  * corresponding (that is having the same row) element in d_x and stores the resulting
-  * product in d_prod. It also sets all the elements of d_flags to 0.
-  * 
-  * Template parameter \a T is the datatype of the matrix A and x. 
+  * Each thread accumulates the dot product of one row of A with x and
+  * adds it to the corresponding element of \a d_y.  Used for matrices with
+  * short rows of similar length, where a row's nonzeros fit in a few
+  * sequential loads.  The grid loops over the rows, so any number of rows
+  * may be processed with at most 65535 CTAs.
   *
-  * @param[out] d_flags The output flags array
-  * @param[out] d_prod The output products array
-  * @param[in] d_A The input matrix A
-  * @param[in] d_x The input array x
-  * @param[in] d_indx The input array of column indices for each element in A
-  * @param[in] numNZElts The number of non-zero elements in matrix A
+  * Template parameter \a T is the datatype of x and y, \a V the storage
+  * type of the values of A (\a T, ::spmvHalf or ::spmvBfloat16), \a I the
+  * type of the column indices (32-bit, or 16-bit offsets from 
+  * \a d_indexBase) and \a Acc the type of accumulation (\a T, or double 
+  * for float matrices with ::CUDPP_OPTION_ACCUMULATE_DOUBLE).
+  *
+  * @param[in,out] d_y The output vector; each row's product is added to it
+  * @param[in] d_A The nonzero elements of A
+  * @param[in] d_index The column index of each nonzero element
+  * @param[in] d_indexBase The base column of each block of nonzeros, for
+  *            16-bit column indices
+  * @param[in] d_rowStart The index in \a d_A of the first element of each row
+  * @param[in] d_rowEnd The index in \a d_A one past the last element of each row
+  * @param[in] d_x The input vector x
+  * @param[in] numRows The number of rows in matrix A
   */
-template <class T, bool isFullBlock>
-__global__ 
-void sparseMatrixVectorFetchAndMultiply(
-                                        unsigned int       *d_flags, 
-                                        T                  *d_prod, 
-                                        const T            *d_A,
-                                        const T            *d_x,
-                                        const unsigned int *d_indx,
-                                        unsigned int       numNZElts
-                                        )
+template <class T, class V, class I, class Acc>
+__global__
+void spmvRowPerThread(T                  *d_y,
+                      const V            *d_A,
+                      const I            *d_index,
+                      const unsigned int *d_indexBase,
+                      const unsigned int *d_rowStart,
+                      const unsigned int *d_rowEnd,
+                      const T            *d_x,
+                      unsigned int       numRows)
 {
-// This method is currently slow
-#if 0 
-    typeToVector<T,4>::Result  tempData, outData;
-    typeToVector<unsigned int,4>::Result tempIndx, tempFlags;
-
-    typeToVector<T,4>::Result* inData = (typeToVector<T,4>::Result*)d_A;
-    typeToVector<T,4>::Result* outProd = (typeToVector<T,4>::Result*)d_prod;
-
-    typeToVector<unsigned int,4>::Result* inIndx = 
-        (typeToVector<unsigned int,4>::Result*)d_indx;
-    typeToVector<unsigned int,4>::Result* outFlags = 
-        (typeToVector<unsigned int,4>::Result*)d_flags;
-
-    unsigned int aiDev = blockIdx.x * (blockDim.x << 1) + threadIdx.x;
-    unsigned int i = aiDev * 4;
-    if (isFullBlock || ((i+3) < numNZElts) )
+    for (unsigned int row = blockIdx.x * blockDim.x + threadIdx.x;
+         row < numRows; row += blockDim.x * gridDim.x)
     {
-        tempData = inData[aiDev];
-        tempIndx = inIndx[aiDev];
+        Acc sum = 0;
+        for (unsigned int j = d_rowStart[row]; j < d_rowEnd[row]; ++j)
+            sum += spmvValue<Acc>(d_A[j]) * (Acc)d_x[spmvColumn(d_index, d_indexBase, j)];
+        d_y[row] = (T)(d_y[row] + sum);
+    }
+}
 
-        outData.x = tempData.x * d_x[tempIndx.x];
-        outData.y = tempData.y * d_x[tempIndx.y];
-        outData.z = tempData.z * d_x[tempIndx.z];
-        outData.w = tempData.w * d_x[tempIndx.w];
+/**
+  * @brief Vector-per-row CSR kernel
+  *
+  * A vector of \a vectorSize consecutive threads processes each row: the
+  * threads read the row's nonzeros with unit stride, so the loads of A and
+  * of the column indices are coalesced, and the partial sums are combined
+  * with a tree reduction in shared memory.  Used for rows of similar
+  * length that are too long for one thread; \a vectorSize is chosen from
+  * the mean row length when the matrix is created.
+  *
+  * Template parameter \a T is the datatype of x and y, \a V the storage
+  * type of the values of A (\a T, ::spmvHalf or ::spmvBfloat16), \a I the
+  * type of the column indices (32-bit, or 16-bit offsets from 
+  * \a d_indexBase) and \a Acc the type of accumulation (\a T, or double 
+  * for float matrices with ::CUDPP_OPTION_ACCUMULATE_DOUBLE).
+  * Template parameter \a vectorSize is the number of threads per row, a
+  * power of two no larger than ::WARP_SIZE.
+  *
+  * @param[in,out] d_y The output vector; each row's product is added to it
+  * @param[in] d_A The nonzero elements of A
+  * @param[in] d_index The column index of each nonzero element
+  * @param[in] d_indexBase The base column of each block of nonzeros, for
+  *            16-bit column indices
+  * @param[in] d_rowStart The index in \a d_A of the first element of each row
+  * @param[in] d_rowEnd The index in \a d_A one past the last element of each row
+  * @param[in] d_x The input vector x
+  * @param[in] numRows The number of rows in matrix A
+  */
+template <class T, class V, class I, class Acc, unsigned int vectorSize>
+__global__
+void spmvVectorPerRow(T                  *d_y,
+                      const V            *d_A,
+                      const I            *d_index,
+                      const unsigned int *d_indexBase,
+                      const unsigned int *d_rowStart,
+                      const unsigned int *d_rowEnd,
+                      const T            *d_x,
+                      unsigned int       numRows)
+{
+    SharedMemory<Acc> smem;
+    Acc* s_sum = smem.getPointer();
 
-        outProd[aiDev] = outData;
+    const unsigned int lane = threadIdx.x & (vectorSize - 1);
+    const unsigned int rowsPerCTA = blockDim.x / vectorSize;
 
-        tempFlags.x = tempFlags.y = tempFlags.z = tempFlags.w = 0;
-        outFlags[aiDev] = tempFlags;
-    }
-    else
+    // every thread of the CTA runs the same number of iterations, so the
+    // barriers in the reduction are reached uniformly
+    for (unsigned int base = blockIdx.x * rowsPerCTA; base < numRows;
+         base += gridDim.x * rowsPerCTA)
     {
-        if (i < numNZElts)
-        {
-            d_prod[i] = d_A[i] * d_x[d_indx[i]];
-            d_flags[i] = 0;
-        }
-        if ((i+1) < numNZElts)
-        {
-            d_prod[i+1] = d_A[i+1] * d_x[d_indx[i+1]];
-            d_flags[i+1] = 0;
-        }
-        if ((i+2) < numNZElts)
+        unsigned int row = base + threadIdx.x / vectorSize;
+
+        Acc sum = 0;
+        if (row < numRows)
         {
-            d_prod[i+2] = d_A[i+2] * d_x[d_indx[i+2]];
-            d_flags[i+2] = 0;
+            for (unsigned int j = d_rowStart[row] + lane; j < d_rowEnd[row]; j += vectorSize)
+                sum += spmvValue<Acc>(d_A[j]) * (Acc)d_x[spmvColumn(d_index, d_indexBase, j)];
         }
-        if ((i+3) < numNZElts)
+        s_sum[threadIdx.x] = sum;
+
+        for (unsigned int s = vectorSize >> 1; s > 0; s >>= 1)
         {
-            d_prod[i+3] = d_A[i+3] * d_x[d_indx[i+3]];
-            d_flags[i+3] = 0;
+            __syncthreads();
+            if (lane < s)
+                s_sum[threadIdx.x] += s_sum[threadIdx.x + s];
         }
-    }
 
-    unsigned int biDev = aiDev + blockDim.x;
-    i = biDev * 4;
-    if (isFullBlock || ((i+3) < numNZElts) )
-    {
-        tempData = inData[biDev];
-        tempIndx = inIndx[biDev];
+        if (lane == 0 && row < numRows)
+            d_y[row] = (T)(d_y[row] + s_sum[threadIdx.x]);
 
-        outData.x = tempData.x * d_x[tempIndx.x];
-        outData.y = tempData.y * d_x[tempIndx.y];
-        outData.z = tempData.z * d_x[tempIndx.z];
-        outData.w = tempData.w * d_x[tempIndx.w];
+        __syncthreads();
+    }
+}
 
-        outProd[biDev] = outData;
+/**
+  * @brief Find the starting point of a thread on the merge path
+  *
+  * The merge path of a CSR matrix merges the list of row end offsets with
+  * the list of nonzero indices 0 .. \a numNonZeroElements - 1.  Each step
+  * along the path either consumes a nonzero (accumulating it into the
+  * current row) or a row end (completing the row), so splitting the path
+  * into equal pieces gives every thread the same amount of work no matter
+  * how the nonzeros are distributed among the rows.  This binary search
+  * along \a diagonal returns the row and nonzero at which the piece starting
+  * at \a diagonal begins.
+  *
+  * @param[in] diagonal Number of path items preceding the start point
+  * @param[in] d_rowEnd The index one past the last element of each row
+  * @param[in] numRows The number of rows in matrix A
+  * @param[in] numNonZeroElements The number of nonzero elements in A
+  * @param[out] row Number of row ends preceding the start point
+  * @param[out] nz Number of nonzeros preceding the start point
+  */
+__device__
+void spmvMergePathSearch(size_t             diagonal,
+                         const unsigned int *d_rowEnd,
+                         unsigned int       numRows,
+                         unsigned int       numNonZeroElements,
+                         unsigned int       &row,
+                         unsigned int       &nz)
+{
+    size_t lo = (diagonal > numNonZeroElements) ? diagonal - numNonZeroElements : 0;
+    size_t hi = min(diagonal, (size_t)numRows);
 
-        tempFlags.x = tempFlags.y = tempFlags.z = tempFlags.w = 0;
-        outFlags[biDev] = tempFlags;
-    }
-    else
+    while (lo < hi)
     {
-        if (i < numNZElts)
-        {
-            d_prod[i] = d_A[i] * d_x[d_indx[i]];
-            d_flags[i] = 0;
-        }
-        if ((i+1) < numNZElts)
-        {
-            d_prod[i+1] = d_A[i+1] * d_x[d_indx[i+1]];
-            d_flags[i+1] = 0;
-        }
-        if ((i+2) < numNZElts)
-        {
-            d_prod[i+2] = d_A[i+2] * d_x[d_indx[i+2]];
-            d_flags[i+2] = 0;
-        }
-        if ((i+3) < numNZElts)
-        {
-            d_prod[i+3] = d_A[i+3] * d_x[d_indx[i+3]];
-            d_flags[i+3] = 0;
-        }
+        size_t pivot = (lo + hi) >> 1;
+        if (d_rowEnd[pivot] <= diagonal - pivot - 1)
+            lo = pivot + 1;
+        else
+            hi = pivot;
     }
-#endif
 
-#if 1
-    bool isLastBlock = (blockIdx.x == (gridDim.x-1));
-    unsigned int iGlobal = (blockIdx.x * (blockDim.x << 3)) + threadIdx.x;
-    
-    for (unsigned int i = 0; i < 8; ++i)
+    row = (unsigned int)lo;
+    nz = (unsigned int)(diagonal - lo);
+}
+
+/**
+  * @brief Merge-path balanced CSR kernel
+  *
+  * Each thread processes ::SPMV_MERGE_ITEMS_PER_THREAD consecutive items of
+  * the merge path (see spmvMergePathSearch()), so rows of any length,
+  * including single rows that span many CTAs, are split evenly.  A row
+  * that begins and ends inside one thread is added to \a d_y directly.
+  * Partial sums of rows that cross a thread boundary are combined in
+  * shared memory at the end of each tile: rows that lie inside the tile are
+  * added to \a d_y there, and the partial sums of the first and last rows
+  * of the tile, which may continue in neighbouring tiles, are written to
+  * \a d_carryRow / \a d_carryValue and added by spmvMergePathFixup().
+  *
+  * Must be launched with ::SPMV_CTA_SIZE threads per CTA and
+  * 2 * ::SPMV_CTA_SIZE * sizeof(Acc) bytes of dynamic shared memory.
+  *
+  * Template parameter \a T is the datatype of x and y, \a V the storage
+  * type of the values of A (\a T, ::spmvHalf or ::spmvBfloat16), \a I the
+  * type of the column indices (32-bit, or 16-bit offsets from 
+  * \a d_indexBase) and \a Acc the type of accumulation (\a T, or double 
+  * for float matrices with ::CUDPP_OPTION_ACCUMULATE_DOUBLE).
+  *
+  * @param[in,out] d_y The output vector; each row's product is added to it
+  * @param[out] d_carryValue Partial sums of the first and last row of each tile
+  * @param[out] d_carryRow The rows of the partial sums in \a d_carryValue
+  * @param[in] d_A The nonzero elements of A
+  * @param[in] d_index The column index of each nonzero element
+  * @param[in] d_indexBase The base column of each block of nonzeros, for
+  *            16-bit column indices
+  * @param[in] d_rowStart The index in \a d_A of the first element of each row
+  * @param[in] d_rowEnd The index in \a d_A one past the last element of each row
+  * @param[in] d_x The input vector x
+  * @param[in] numRows The number of rows in matrix A
+  * @param[in] numNonZeroElements The number of nonzero elements in A
+  * @param[in] numTiles The number of tiles of SPMV_CTA_SIZE threads
+  */
+template <class T, class V, class I, class Acc>
+__global__
+void spmvMergePath(T                  *d_y,
+                   Acc                *d_carryValue,
+                   unsigned int       *d_carryRow,
+                   const V            *d_A,
+                   const I            *d_index,
+                   const unsigned int *d_indexBase,
+                   const unsigned int *d_rowStart,
+                   const unsigned int *d_rowEnd,
+                   const T            *d_x,
+                   unsigned int       numRows,
+                   unsigned int       numNonZeroElements,
+                   unsigned int       numTiles)
+{
+    __shared__ unsigned int s_row[2 * SPMV_CTA_SIZE];
+    SharedMemory<Acc> smem;
+    Acc* s_value = smem.getPointer();
+
+    const size_t pathLength = (size_t)numRows + numNonZeroElements;
+
+    for (unsigned int tile = blockIdx.x; tile < numTiles; tile += gridDim.x)
     {
-        if (isFullBlock)
+        size_t begin = ((size_t)tile * SPMV_CTA_SIZE + threadIdx.x) * 
+                       SPMV_MERGE_ITEMS_PER_THREAD;
+        begin = min(begin, pathLength);
+        size_t end = min(begin + SPMV_MERGE_ITEMS_PER_THREAD, pathLength);
+
+        unsigned int row, nz;
+        spmvMergePathSearch(begin, d_rowEnd, numRows, numNonZeroElements, row, nz);
+
+        // a row that started in an earlier thread is only partially ours,
+        // so its sum is deferred even if we complete it
+        const unsigned int firstRow = row;
+        const bool startsMidRow = (row < numRows) && (nz > d_rowStart[row]);
+        bool isFirstRow = true;
+        Acc head = 0;
+        Acc sum = 0;
+
+        for (size_t d = begin; d < end; ++d)
         {
-            d_prod[iGlobal] = d_A[iGlobal] * d_x[d_indx[iGlobal]];
-            d_flags[iGlobal] = 0;
+            if (nz < d_rowEnd[row])
+            {
+                sum += spmvValue<Acc>(d_A[nz]) * (Acc)d_x[spmvColumn(d_index, d_indexBase, nz)];
+                ++nz;
+            }
+            else
+            {
+                if (isFirstRow && startsMidRow)
+                    head = sum;
+                else
+                    d_y[row] = (T)(d_y[row] + sum);
+                isFirstRow = false;
+                sum = 0;
+                ++row;
+            }
         }
-        else
+
+        s_row[2 * threadIdx.x] = firstRow;
+        s_value[2 * threadIdx.x] = head;
+        s_row[2 * threadIdx.x + 1] = row;
+        s_value[2 * threadIdx.x + 1] = sum;
+
+        __syncthreads();
+
+        // the partial sums are in row order; combine the runs of each row
+        if (threadIdx.x == 0)
         {
-            if (isLastBlock)
+            const unsigned int tileFirstRow = s_row[0];
+            const unsigned int tileLastRow = s_row[2 * SPMV_CTA_SIZE - 1];
+            Acc firstValue = 0;
+            Acc lastValue = 0;
+
+            unsigned int runRow = tileFirstRow;
+            Acc runValue = 0;
+            for (unsigned int i = 0; i <= 2 * SPMV_CTA_SIZE; ++i)
             {
-                if (iGlobal < numNZElts)
+                if (i == 2 * SPMV_CTA_SIZE || s_row[i] != runRow)
                 {
-                    d_prod[iGlobal] = d_A[iGlobal] * d_x[d_indx[iGlobal]];
-                    d_flags[iGlobal] = 0;
+                    if (runRow == tileFirstRow)
+                        firstValue += runValue;
+                    else if (runRow == tileLastRow)
+                        lastValue += runValue;
+                    else if (runRow < numRows)
+                        d_y[runRow] = (T)(d_y[runRow] + runValue);
+
+                    if (i == 2 * SPMV_CTA_SIZE)
+                        break;
+                    runRow = s_row[i];
+                    runValue = 0;
                 }
+                runValue += s_value[i];
             }
-            else
-            {
-                d_prod[iGlobal] = d_A[iGlobal] * d_x[d_indx[iGlobal]];
-                d_flags[iGlobal] = 0;
-            }
+
+            d_carryRow[2 * tile] = tileFirstRow;
+            d_carryValue[2 * tile] = firstValue;
+            d_carryRow[2 * tile + 1] = tileLastRow;
+            d_carryValue[2 * tile + 1] = lastValue;
         }
 
-        iGlobal += blockDim.x;
+        __syncthreads();
     }
-#endif
-    __syncthreads();
 }
 
-/** 
-  * @brief Set Flags kernel
+/**
+  * @brief Add the carried partial sums of the merge-path kernel
+  *
+  * The carries written by spmvMergePath() are in row order.  The first
+  * carry of each run of equal rows sums the run and adds it to \a d_y, so
+  * each row is updated by exactly one thread.
   *
-  * This __global__ device function takes an element from the vector d_rowindx, 
-  * and sets the corresponding position in d_flags to 1 
+  * Template parameter \a T is the datatype of y and \a Acc the type of
+  * the partial sums.
   *
-  * @param[out] d_flags The output flags array
-  * @param[in] d_rowindx The starting index of each row in the "flattened" version
-  *                      of matrix A
+  * @param[in,out] d_y The output vector
+  * @param[in] d_carryValue The partial sums written by spmvMergePath()
+  * @param[in] d_carryRow The rows of the partial sums
+  * @param[in] numCarries The number of partial sums (twice the number of tiles)
   * @param[in] numRows The number of rows in matrix A
   */
-__global__ 
-void sparseMatrixVectorSetFlags(
-                                unsigned int             *d_flags, 
-                                const unsigned int       *d_rowindx, 
-                                unsigned int             numRows
-                                )
+template <class T, class Acc>
+__global__
+void spmvMergePathFixup(T                  *d_y,
+                        const Acc          *d_carryValue,
+                        const unsigned int *d_carryRow,
+                        unsigned int       numCarries,
+                        unsigned int       numRows)
 {
-    unsigned int iGlobal = (blockIdx.x * (blockDim.x << 3)) + threadIdx.x;
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numCarries; i += blockDim.x * gridDim.x)
+    {
+        unsigned int row = d_carryRow[i];
+        if (row >= numRows || (i > 0 && d_carryRow[i - 1] == row))
+            continue;
 
-    bool isLastBlock = (blockIdx.x == (gridDim.x-1));
+        Acc sum = 0;
+        for (unsigned int j = i; j < numCarries && d_carryRow[j] == row; ++j)
+            sum += d_carryValue[j];
+        d_y[row] = (T)(d_y[row] + sum);
+    }
+}
+
+/**
+  * @brief Accumulate nonzeros \a start .. \a end - 1 of A times the rows
+  * of X into the ::SPMM_VECTORS_PER_THREAD columns \a base,
+  * \a base + blockDim.x, ... of a thread
+  *
+  * @param[out] sum The products, one per column
+  * @param[in] d_A The nonzero elements of A
+  * @param[in] d_index The column index of each nonzero element
+  * @param[in] d_indexBase The base column of each block of nonzeros, for
+  *            16-bit column indices
+  * @param[in] start The first nonzero to accumulate
+  * @param[in] end One past the last nonzero to accumulate
+  * @param[in] d_X The input matrix, row-major
+  * @param[in] numVectors The number of columns of X
+  * @param[in] base The first column of the thread
+  * @param[in] limit One past the last column to accumulate
+  */
+template <class T, class V, class I, class Acc>
+__device__
+void spmmAccumulate(Acc                *sum,
+                    const V            *d_A,
+                    const I            *d_index,
+                    const unsigned int *d_indexBase,
+                    unsigned int       start,
+                    unsigned int       end,
+                    const T            *d_X,
+                    unsigned int       numVectors,
+                    unsigned int       base,
+                    unsigned int       limit)
+{
+#pragma unroll
+    for (int c = 0; c < SPMM_VECTORS_PER_THREAD; ++c)
+        sum[c] = 0;
 
-    for (unsigned int i = 0; i < 8; ++i)
+    for (unsigned int j = start; j < end; ++j)
     {
-        if (isLastBlock)
-        {
-            if (iGlobal < numRows)
-            {
-                d_flags[d_rowindx[iGlobal]] = 1;
-            }
-        }
-        else
+        const Acc a = spmvValue<Acc>(d_A[j]);
+        const T *xRow = d_X + (size_t)spmvColumn(d_index, d_indexBase, j) * numVectors;
+#pragma unroll
+        for (int c = 0; c < SPMM_VECTORS_PER_THREAD; ++c)
         {
-            d_flags[d_rowindx[iGlobal]] = 1;
+            unsigned int v = base + c * blockDim.x;
+            if (v < limit)
+                sum[c] += a * (Acc)xRow[v];
         }
-
-        iGlobal += blockDim.x;
     }
-    
-    __syncthreads();
 }
 
-/** 
-  * @brief Gather final y values kernel
+/**
+  * @brief Sparse matrix-dense matrix multiply kernel
   *
-  * This __global__ device function takes an element from the vector d_rowFindx,
-  * which for each row gives the index of the last element of that row, reads the
-  * corresponding position in d_prod and write it in d_y
+  * Computes Y += A * X, where X and Y are row-major dense blocks of
+  * \a numVectors columns.  Each row of A is handled by one row of the
+  * thread block: the blockDim.x threads span the columns of X and Y, and
+  * each thread accumulates ::SPMM_VECTORS_PER_THREAD columns in registers.
+  * The nonzeros of a row are therefore read once for every
+  * blockDim.x * SPMM_VECTORS_PER_THREAD columns (once in total for up to 128
+  * columns) and broadcast to the threads, while the reads of the rows of X
+  * and the writes of Y are coalesced.
   *
-  * Template parameter \a T is the datatype of the matrix A and x.
+  * Rows longer than \a maxRowLength are skipped; they are split into
+  * pieces and handled by spmmRowPieces() and spmmRowPiecesFixup().
   *
-  * @param[out] d_y The output result array
-  * @param[in] d_prod The input products array (which now contains sums for each row)
-  * @param[in] d_rowFindx The starting index of each row in the "flattened" version
-  *                       of matrix A
+  * Template parameter \a T is the datatype of X and Y, \a V the storage
+  * type of the values of A, \a I the type of the column indices and
+  * \a Acc the type of accumulation (see spmvRowPerThread()).
+  *
+  * @param[in,out] d_Y The output matrix, \a numRows x \a numVectors, row-major
+  * @param[in] d_A The nonzero elements of A
+  * @param[in] d_index The column index of each nonzero element
+  * @param[in] d_indexBase The base column of each block of nonzeros, for
+  *            16-bit column indices
+  * @param[in] d_rowStart The index in \a d_A of the first element of each row
+  * @param[in] d_rowEnd The index in \a d_A one past the last element of each row
+  * @param[in] d_X The input matrix, \a numRows x \a numVectors, row-major
   * @param[in] numRows The number of rows in matrix A
+  * @param[in] numVectors The number of columns of X and Y
+  * @param[in] maxRowLength The longest row processed by this kernel
   */
-template <class T>
-__global__ 
-void yGather(
-             T                  *d_y, 
-             const T            *d_prod,
-             const unsigned int *d_rowFindx,
-             unsigned int       numRows
-             )
+template <class T, class V, class I, class Acc>
+__global__
+void spmmRowBlock(T                  *d_Y,
+                  const V            *d_A,
+                  const I            *d_index,
+                  const unsigned int *d_indexBase,
+                  const unsigned int *d_rowStart,
+                  const unsigned int *d_rowEnd,
+                  const T            *d_X,
+                  unsigned int       numRows,
+                  unsigned int       numVectors,
+                  unsigned int       maxRowLength)
 {
-    
-    unsigned int iGlobal = (blockIdx.x * (blockDim.x << 3)) + threadIdx.x;
-    
-    bool isLastBlock = (blockIdx.x == (gridDim.x-1));
-    
-    for (unsigned int i=0; i < 8; ++i)
+    for (unsigned int row = blockIdx.x * blockDim.y + threadIdx.y; 
+         row < numRows; row += gridDim.x * blockDim.y)
     {
-        if (isLastBlock)
+        const unsigned int start = d_rowStart[row];
+        const unsigned int end = d_rowEnd[row];
+        if (end - start > maxRowLength)
+            continue;
+        T *yRow = d_Y + (size_t)row * numVectors;
+
+        for (unsigned int base = threadIdx.x; base < numVectors; 
+             base += blockDim.x * SPMM_VECTORS_PER_THREAD)
         {
-            if (iGlobal < numRows)
+            Acc sum[SPMM_VECTORS_PER_THREAD];
+            spmmAccumulate<T, V, I, Acc>(sum, d_A, d_index, d_indexBase, start, end,
+                                         d_X, numVectors, base, numVectors);
+
+#pragma unroll
+            for (int c = 0; c < SPMM_VECTORS_PER_THREAD; ++c)
             {
-                d_y[iGlobal] += d_prod[d_rowFindx[iGlobal]-1];
+                unsigned int v = base + c * blockDim.x;
+                if (v < numVectors)
+                    yRow[v] = (T)(yRow[v] + sum[c]);
             }
         }
-        else
+    }
+}
+
+/**
+  * @brief Partial products of the pieces of long rows for sparse
+  * matrix-dense matrix multiply
+  *
+  * For matrices with skewed row lengths (::CUDPP_SPMV_MERGE_PATH), rows
+  * longer than ::SPMM_ROW_PIECE_LENGTH are split into pieces of at most that
+  * many nonzeros, so that a single long row is spread over many rows of
+  * threads instead of serializing one of them.  Each row of the thread
+  * block computes one piece for columns \a firstVector ..
+  * \a firstVector + \a numTileVectors - 1 and writes it to \a d_carry, to
+  * be summed by spmmRowPiecesFixup().
+  *
+  * @param[out] d_carry The product of each piece, ::SPMM_CARRY_VECTORS
+  *             columns per piece
+  * @param[in] d_A The nonzero elements of A
+  * @param[in] d_index The column index of each nonzero element
+  * @param[in] d_indexBase The base column of each block of nonzeros, for
+  *            16-bit column indices
+  * @param[in] d_pieceStart The index in \a d_A of the first element of each piece
+  * @param[in] d_pieceEnd The index in \a d_A one past the last element of each piece
+  * @param[in] d_X The input matrix, numRows x \a numVectors, row-major
+  * @param[in] numPieces The number of pieces
+  * @param[in] numVectors The number of columns of X
+  * @param[in] firstVector The first column of this pass
+  * @param[in] numTileVectors The number of columns of this pass, at most
+  *            ::SPMM_CARRY_VECTORS
+  */
+template <class T, class V, class I, class Acc>
+__global__
+void spmmRowPieces(Acc                *d_carry,
+                   const V            *d_A,
+                   const I            *d_index,
+                   const unsigned int *d_indexBase,
+                   const unsigned int *d_pieceStart,
+                   const unsigned int *d_pieceEnd,
+                   const T            *d_X,
+                   unsigned int       numPieces,
+                   unsigned int       numVectors,
+                   unsigned int       firstVector,
+                   unsigned int       numTileVectors)
+{
+    for (unsigned int piece = blockIdx.x * blockDim.y + threadIdx.y; 
+         piece < numPieces; piece += gridDim.x * blockDim.y)
+    {
+        Acc *carry = d_carry + (size_t)piece * SPMM_CARRY_VECTORS;
+
+        for (unsigned int base = threadIdx.x; base < numTileVectors; 
+             base += blockDim.x * SPMM_VECTORS_PER_THREAD)
         {
-            d_y[iGlobal] += d_prod[d_rowFindx[iGlobal]-1];
-        }
+            Acc sum[SPMM_VECTORS_PER_THREAD];
+            spmmAccumulate<T, V, I, Acc>(sum, d_A, d_index, d_indexBase, 
+                                         d_pieceStart[piece], d_pieceEnd[piece],
+                                         d_X + firstVector, numVectors, base, numTileVectors);
 
-        iGlobal += blockDim.x;
+#pragma unroll
+            for (int c = 0; c < SPMM_VECTORS_PER_THREAD; ++c)
+            {
+                unsigned int v = base + c * blockDim.x;
+                if (v < numTileVectors)
+                    carry[v] = sum[c];
+            }
+        }
     }
+}
 
-    __syncthreads();
+/**
+  * @brief Add the pieces of each long row computed by spmmRowPieces() to Y
+  *
+  * Each row of the thread block sums the pieces of one long row, with the
+  * threads spanning the columns.
+  *
+  * @param[in,out] d_Y The output matrix, numRows x \a numVectors, row-major
+  * @param[in] d_carry The product of each piece, ::SPMM_CARRY_VECTORS
+  *            columns per piece
+  * @param[in] d_longRow The row of each long row
+  * @param[in] d_longRowPieces The first piece of each long row, followed by
+  *            the total number of pieces
+  * @param[in] numLongRows The number of long rows
+  * @param[in] numVectors The number of columns of Y
+  * @param[in] firstVector The first column of this pass
+  * @param[in] numTileVectors The number of columns of this pass
+  */
+template <class T, class Acc>
+__global__
+void spmmRowPiecesFixup(T                  *d_Y,
+                        const Acc          *d_carry,
+                        const unsigned int *d_longRow,
+                        const unsigned int *d_longRowPieces,
+                        unsigned int       numLongRows,
+                        unsigned int       numVectors,
+                        unsigned int       firstVector,
+                        unsigned int       numTileVectors)
+{
+    for (unsigned int i = blockIdx.x * blockDim.y + threadIdx.y; 
+         i < numLongRows; i += gridDim.x * blockDim.y)
+    {
+        const unsigned int first = d_longRowPieces[i];
+        const unsigned int last = d_longRowPieces[i + 1];
+        T *yRow = d_Y + (size_t)d_longRow[i] * numVectors + firstVector;
 
+        for (unsigned int v = threadIdx.x; v < numTileVectors; v += blockDim.x)
+        {
+            Acc sum = 0;
+            for (unsigned int piece = first; piece < last; ++piece)
+                sum += d_carry[(size_t)piece * SPMM_CARRY_VECTORS + v];
+            yRow[v] = (T)(yRow[v] + sum);
+        }
+    }
 }
 
 /** @} */ // end sparse matrix vector multiply functions
@@ -12,9 +12,12 @@
  * @file
  * tridiagonal_kernel.cu
  *
- * @brief CUDPP kernel-level CR-PCR tridiagonal solver
+ * @brief CUDPP kernel-level tridiagonal solvers (CR-PCR, CR-Thomas,
+ * interleaved Thomas, partitioned, periodic and block-tridiagonal)
  */
 
+#include <cudpp_globals.h>
+
 /** \addtogroup cudpp_kernel
   * @{
   */
@@ -38,6 +41,7 @@
  * @param[in] d_d Right hand side
  * @param[in] systemSizeOriginal The size of each system
  * @param[in] iterations The computed number of PCR iterations
+ * @param[in] numSystems The number of systems (the grid may be 2D)
  */
 template <class T>
 __global__ void crpcrKernel(T *d_a, 
@@ -46,10 +50,13 @@ __global__ void crpcrKernel(T *d_a,
                             T *d_d, 
                             T *d_x, 
                             unsigned int systemSizeOriginal,
-                            unsigned int iterations)
+                            unsigned int iterations,
+                            unsigned int numSystems)
 {
     const unsigned int thid = threadIdx.x;
-    const unsigned int blid = blockIdx.x;
+    const unsigned int blid = blockIdx.y * gridDim.x + blockIdx.x;
+    if (blid >= numSystems)
+        return;
     const unsigned int systemSize = blockDim.x * 2;
     const unsigned int restSystemSize = blockDim.x;
     
@@ -191,6 +198,727 @@ __global__ void crpcrKernel(T *d_a,
         d_x[thid + blockDim.x + blid * systemSizeOriginal] = x[thid + blockDim.x];
 }
 
+/**
+ * @brief Thomas solver with one thread per system (interleaved layout)
+ *
+ * Each CTA solves \a systemsPerBlock small systems.  The CTA first loads
+ * its systems cooperatively (coalesced) and transposes them in shared
+ * memory into an interleaved layout, in which equation \a j of local
+ * system \a s is stored at <tt>j * systemsPerBlock + s</tt>.  Each thread
+ * then runs the sequential Thomas algorithm on one system; because
+ * neighbouring threads touch neighbouring words at every step, the
+ * sweeps are free of bank conflicts.  The forward sweep overwrites the
+ * upper diagonal and right hand side with the modified coefficients and
+ * the back substitution leaves the solution in the right hand side.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[out] d_x Solution vector
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] systemsPerBlock The number of systems solved by each CTA
+ */
+template <class T>
+__global__ void thomasInterleavedKernel(const T *d_a,
+                                        const T *d_b,
+                                        const T *d_c,
+                                        const T *d_d,
+                                        T *d_x,
+                                        unsigned int systemSize,
+                                        unsigned int numSystems,
+                                        unsigned int systemsPerBlock)
+{
+    const unsigned int blid = blockIdx.y * gridDim.x + blockIdx.x;
+    const unsigned int firstSystem = blid * systemsPerBlock;
+    if (firstSystem >= numSystems)
+        return;
+
+    const unsigned int count = min(systemsPerBlock, numSystems - firstSystem);
+    const unsigned int numLoads = count * systemSize;
+    const size_t offset = (size_t)firstSystem * systemSize;
+
+    extern __shared__ char shared[];
+
+    T* a = (T*)shared;
+    T* b = (T*)&a[systemSize * systemsPerBlock];
+    T* c = (T*)&b[systemSize * systemsPerBlock];
+    T* d = (T*)&c[systemSize * systemsPerBlock];
+
+    for (unsigned int k = threadIdx.x; k < numLoads; k += blockDim.x)
+    {
+        unsigned int s = k / systemSize;
+        unsigned int j = k - s * systemSize;
+        unsigned int i = j * systemsPerBlock + s;
+        a[i] = d_a[offset + k];
+        b[i] = d_b[offset + k];
+        c[i] = d_c[offset + k];
+        d[i] = d_d[offset + k];
+    }
+    __syncthreads();
+
+    const unsigned int s = threadIdx.x;
+    if (s < count)
+    {
+        // forward elimination
+        T cp = c[s] / b[s];
+        T dp = d[s] / b[s];
+        c[s] = cp;
+        d[s] = dp;
+        for (unsigned int j = 1; j < systemSize; j++)
+        {
+            unsigned int i = j * systemsPerBlock + s;
+            T m = 1 / (b[i] - a[i] * cp);
+            cp = c[i] * m;
+            dp = (d[i] - a[i] * dp) * m;
+            c[i] = cp;
+            d[i] = dp;
+        }
+
+        // back substitution; dp holds the last unknown
+        for (int j = systemSize - 2; j >= 0; j--)
+        {
+            unsigned int i = j * systemsPerBlock + s;
+            dp = d[i] - c[i] * dp;
+            d[i] = dp;
+        }
+    }
+    __syncthreads();
+
+    for (unsigned int k = threadIdx.x; k < numLoads; k += blockDim.x)
+    {
+        unsigned int s = k / systemSize;
+        unsigned int j = k - s * systemSize;
+        d_x[offset + k] = d[j * systemsPerBlock + s];
+    }
+}
+
+/**
+ * @brief Cyclic reduction followed by Thomas, for arbitrary system sizes
+ *
+ * Each CTA solves one system held in shared memory.  Unlike crpcrKernel,
+ * the system is not padded to a power of two: cyclic reduction runs in
+ * place with a doubling stride, updating the equations
+ * <tt>i = 2s(k+1) - 1</tt> and treating neighbours beyond the end of the
+ * system as absent.  Once at most ::TRIDIAGONAL_CR_THOMAS_SIZE equations
+ * remain, a single thread solves the reduced system with the Thomas
+ * algorithm, and the remaining unknowns are recovered by cyclic reduction
+ * back substitution.  Solved unknowns are stored over the right hand
+ * side, so only four arrays of \a systemSize elements are needed.
+ * Threads loop over the equations, so any CTA size may be used.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[out] d_x Solution vector
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems (the grid may be 2D)
+ */
+template <class T>
+__global__ void crThomasKernel(const T *d_a,
+                               const T *d_b,
+                               const T *d_c,
+                               const T *d_d,
+                               T *d_x,
+                               unsigned int systemSize,
+                               unsigned int numSystems)
+{
+    const unsigned int thid = threadIdx.x;
+    const unsigned int blid = blockIdx.y * gridDim.x + blockIdx.x;
+    if (blid >= numSystems)
+        return;
+
+    const unsigned int n = systemSize;
+    const size_t offset = (size_t)blid * n;
+
+    extern __shared__ char shared[];
+
+    T* a = (T*)shared;
+    T* b = (T*)&a[n];
+    T* c = (T*)&b[n];
+    T* d = (T*)&c[n];
+
+    for (unsigned int i = thid; i < n; i += blockDim.x)
+    {
+        // the first and last equations have no outer neighbour; zero the
+        // unused coefficients so they do not leak into the reduction
+        a[i] = (i == 0) ? 0 : d_a[offset + i];
+        b[i] = d_b[offset + i];
+        c[i] = (i == n - 1) ? 0 : d_c[offset + i];
+        d[i] = d_d[offset + i];
+    }
+    __syncthreads();
+
+    // forward reduction: at stride s the active equations are k*s - 1
+    unsigned int stride = 1;
+    while (n / stride > TRIDIAGONAL_CR_THOMAS_SIZE)
+    {
+        const unsigned int numUpdates = n / (2 * stride);
+        for (unsigned int k = thid; k < numUpdates; k += blockDim.x)
+        {
+            unsigned int i = 2 * stride * (k + 1) - 1;
+            unsigned int lo = i - stride;
+            T k1 = a[i] / b[lo];
+            T bNew = b[i] - c[lo] * k1;
+            T dNew = d[i] - d[lo] * k1;
+            T aNew = -a[lo] * k1;
+            T cNew = c[i];
+            if (i + stride < n)
+            {
+                unsigned int hi = i + stride;
+                T k2 = c[i] / b[hi];
+                bNew -= a[hi] * k2;
+                dNew -= d[hi] * k2;
+                cNew = -c[hi] * k2;
+            }
+            a[i] = aNew;
+            b[i] = bNew;
+            c[i] = cNew;
+            d[i] = dNew;
+        }
+        stride *= 2;
+        __syncthreads();
+    }
+
+    // Thomas on the remaining equations stride - 1, 2 * stride - 1, ...
+    if (thid == 0)
+    {
+        const unsigned int m = n / stride;
+        unsigned int i = stride - 1;
+        T cp = c[i] / b[i];
+        T dp = d[i] / b[i];
+        c[i] = cp;
+        d[i] = dp;
+        for (unsigned int j = 1; j < m; j++)
+        {
+            i += stride;
+            T r = 1 / (b[i] - a[i] * cp);
+            cp = c[i] * r;
+            dp = (d[i] - a[i] * dp) * r;
+            c[i] = cp;
+            d[i] = dp;
+        }
+        for (int j = m - 2; j >= 0; j--)
+        {
+            i -= stride;
+            dp = d[i] - c[i] * dp;
+            d[i] = dp;
+        }
+    }
+    __syncthreads();
+
+    // back substitution: solve the equations (2k+1)*s - 1 at each level
+    while (stride > 1)
+    {
+        stride /= 2;
+        const unsigned int numSolves = (n / stride + 1) / 2;
+        for (unsigned int k = thid; k < numSolves; k += blockDim.x)
+        {
+            unsigned int i = (2 * k + 1) * stride - 1;
+            T r = d[i];
+            if (i >= stride)
+                r -= a[i] * d[i - stride];
+            if (i + stride < n)
+                r -= c[i] * d[i + stride];
+            d[i] = r / b[i];
+        }
+        __syncthreads();
+    }
+
+    for (unsigned int i = thid; i < n; i += blockDim.x)
+        d_x[offset + i] = d[i];
+}
+
+/**
+ * @brief Partitioned solver, phase 1: compute the spikes of each partition
+ *
+ * Large systems are split into partitions of (about)
+ * ::TRIDIAGONAL_PARTITION_SIZE equations.  The last equation of
+ * partition \a p is the interface unknown \a u_p; the equations before it
+ * form an interior system whose solution can be written as
+ * <tt>x = y + v u_{p-1} + w u_p</tt>, where \a y solves the interior
+ * system with the original right hand side, and \a v and \a w are the
+ * responses to the couplings to the neighbouring interface unknowns.
+ * The reduced system only needs \a y, \a v and \a w at the first and last
+ * interior equations, so each thread handles one partition and computes
+ * them with a downward and an upward elimination sweep, without storing
+ * any per-equation values.
+ *
+ * The output \a d_spikes holds six arrays of
+ * <tt>numSystems * numPartitions</tt> values: y, v and w at the first
+ * interior equation, then y, v and w at the last interior equation.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[out] d_spikes The spike values of each partition
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] numPartitions The number of partitions per system
+ */
+template <class T>
+__global__ void partitionSpikesKernel(const T *d_a,
+                                      const T *d_b,
+                                      const T *d_c,
+                                      const T *d_d,
+                                      T *d_spikes,
+                                      unsigned int systemSize,
+                                      unsigned int numSystems,
+                                      unsigned int numPartitions)
+{
+    const size_t total = (size_t)numSystems * numPartitions;
+    const size_t g = ((size_t)blockIdx.y * gridDim.x + blockIdx.x) * blockDim.x
+                   + threadIdx.x;
+    if (g >= total)
+        return;
+
+    const unsigned int sys = g / numPartitions;
+    const unsigned int p = g - (size_t)sys * numPartitions;
+    const size_t offset = (size_t)sys * systemSize;
+
+    // interior equations [first, last]; the interface is last + 1
+    const unsigned int first = p * TRIDIAGONAL_PARTITION_SIZE;
+    const unsigned int last = (p == numPartitions - 1)
+        ? systemSize - 2
+        : first + TRIDIAGONAL_PARTITION_SIZE - 2;
+
+    // the first partition has no interface above it
+    const T aFirst = (p == 0) ? 0 : d_a[offset + first];
+    const T cLast = d_c[offset + last];
+
+    // downward sweep: values at the last interior equation
+    T cp = 0, y = 0, v = 0, w = 0;
+    for (unsigned int i = first; i <= last; i++)
+    {
+        T ai = (i == first) ? 0 : d_a[offset + i];
+        T r = 1 / (d_b[offset + i] - ai * cp);
+        cp = d_c[offset + i] * r;
+        y = (d_d[offset + i] - ai * y) * r;
+        v = (((i == first) ? -aFirst : 0) - ai * v) * r;
+        w = (((i == last) ? -cLast : 0) - ai * w) * r;
+    }
+    d_spikes[3 * total + g] = y;
+    d_spikes[4 * total + g] = v;
+    d_spikes[5 * total + g] = w;
+
+    // upward sweep: values at the first interior equation
+    T ap = 0;
+    y = 0; v = 0; w = 0;
+    for (unsigned int i = last + 1; i-- > first; )
+    {
+        T ci = (i == last) ? 0 : d_c[offset + i];
+        T r = 1 / (d_b[offset + i] - ci * ap);
+        ap = d_a[offset + i] * r;
+        y = (d_d[offset + i] - ci * y) * r;
+        v = (((i == first) ? -aFirst : 0) - ci * v) * r;
+        w = (((i == last) ? -cLast : 0) - ci * w) * r;
+    }
+    d_spikes[0 * total + g] = y;
+    d_spikes[1 * total + g] = v;
+    d_spikes[2 * total + g] = w;
+}
+
+/**
+ * @brief Partitioned solver, phase 2: build the reduced interface system
+ *
+ * Substituting the spike representation of the neighbouring interior
+ * equations into the equation of interface \a u_p gives one equation of a
+ * tridiagonal system in the interface unknowns.  The reduced systems are
+ * written contiguously (one system of \a numPartitions equations per
+ * original system), so they can be solved by any of the batched solvers.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] d_spikes The spike values from partitionSpikesKernel
+ * @param[out] d_ra Lower diagonal of the reduced systems
+ * @param[out] d_rb Main diagonal of the reduced systems
+ * @param[out] d_rc Upper diagonal of the reduced systems
+ * @param[out] d_rd Right hand side of the reduced systems
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] numPartitions The number of partitions per system
+ */
+template <class T>
+__global__ void partitionReduceKernel(const T *d_a,
+                                      const T *d_b,
+                                      const T *d_c,
+                                      const T *d_d,
+                                      const T *d_spikes,
+                                      T *d_ra,
+                                      T *d_rb,
+                                      T *d_rc,
+                                      T *d_rd,
+                                      unsigned int systemSize,
+                                      unsigned int numSystems,
+                                      unsigned int numPartitions)
+{
+    const size_t total = (size_t)numSystems * numPartitions;
+    const size_t g = ((size_t)blockIdx.y * gridDim.x + blockIdx.x) * blockDim.x
+                   + threadIdx.x;
+    if (g >= total)
+        return;
+
+    const unsigned int sys = g / numPartitions;
+    const unsigned int p = g - (size_t)sys * numPartitions;
+    const unsigned int e = (p == numPartitions - 1)
+        ? systemSize - 1
+        : (p + 1) * TRIDIAGONAL_PARTITION_SIZE - 1;
+    const size_t i = (size_t)sys * systemSize + e;
+
+    const T ae = d_a[i];
+    T ra = ae * d_spikes[4 * total + g];
+    T rb = d_b[i] + ae * d_spikes[5 * total + g];
+    T rc = 0;
+    T rd = d_d[i] - ae * d_spikes[3 * total + g];
+
+    if (p < numPartitions - 1)
+    {
+        const T ce = d_c[i];
+        rb += ce * d_spikes[1 * total + g + 1];
+        rc  = ce * d_spikes[2 * total + g + 1];
+        rd -= ce * d_spikes[0 * total + g + 1];
+    }
+
+    d_ra[g] = ra;
+    d_rb[g] = rb;
+    d_rc[g] = rc;
+    d_rd[g] = rd;
+}
+
+/**
+ * @brief Partitioned solver, phase 3: solve the interior of each partition
+ *
+ * With the interface unknowns known, the interior equations of each
+ * partition form an independent tridiagonal system, which each thread
+ * solves with the Thomas algorithm.  The modified upper diagonal is kept
+ * in \a d_scratch and the modified right hand side in \a d_x.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in] d_d Right hand side
+ * @param[in] d_u The interface unknowns (the solution of the reduced systems)
+ * @param[out] d_x Solution vector
+ * @param[out] d_scratch Temporary storage of the same size as \a d_x
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ * @param[in] numPartitions The number of partitions per system
+ */
+template <class T>
+__global__ void partitionSolveKernel(const T *d_a,
+                                     const T *d_b,
+                                     const T *d_c,
+                                     const T *d_d,
+                                     const T *d_u,
+                                     T *d_x,
+                                     T *d_scratch,
+                                     unsigned int systemSize,
+                                     unsigned int numSystems,
+                                     unsigned int numPartitions)
+{
+    const size_t total = (size_t)numSystems * numPartitions;
+    const size_t g = ((size_t)blockIdx.y * gridDim.x + blockIdx.x) * blockDim.x
+                   + threadIdx.x;
+    if (g >= total)
+        return;
+
+    const unsigned int sys = g / numPartitions;
+    const unsigned int p = g - (size_t)sys * numPartitions;
+    const size_t offset = (size_t)sys * systemSize;
+
+    const unsigned int first = p * TRIDIAGONAL_PARTITION_SIZE;
+    const unsigned int last = (p == numPartitions - 1)
+        ? systemSize - 2
+        : first + TRIDIAGONAL_PARTITION_SIZE - 2;
+
+    const T uPrev = (p == 0) ? 0 : d_u[g - 1];
+    const T u = d_u[g];
+
+    T cp = 0, dp = 0;
+    for (unsigned int i = first; i <= last; i++)
+    {
+        T ai = d_a[offset + i];
+        T di = d_d[offset + i];
+        if (i == first)
+        {
+            di -= ai * uPrev;
+            ai = 0;
+        }
+        if (i == last)
+            di -= d_c[offset + i] * u;
+        T r = 1 / (d_b[offset + i] - ai * cp);
+        cp = d_c[offset + i] * r;
+        dp = (di - ai * dp) * r;
+        d_scratch[offset + i] = cp;
+        d_x[offset + i] = dp;
+    }
+
+    d_x[offset + last + 1] = u;
+    for (unsigned int i = last; i-- > first; )
+    {
+        dp = d_x[offset + i] - d_scratch[offset + i] * dp;
+        d_x[offset + i] = dp;
+    }
+}
+
+/**
+ * @brief Periodic solver: set up the Sherman-Morrison correction
+ *
+ * A periodic system couples the first equation to the last unknown
+ * (through \a a[0]) and the last equation to the first unknown (through
+ * \a c[n-1]).  With <tt>gamma = -b[0]</tt>, or 1 when \a b[0] is zero so
+ * that \a gamma can be divided by, the periodic matrix equals a
+ * non-periodic matrix with modified first and last diagonal entries plus
+ * the rank-one term <tt>u v^T</tt>, where <tt>u = (gamma, 0, ..., c[n-1])</tt>
+ * and <tt>v = (1, 0, ..., a[0] / gamma)</tt>.  This kernel writes the
+ * modified diagonal entries to \a d_bMod (which must already hold a copy
+ * of \a d_b) and the nonzero entries of \a u to \a d_u (which must be
+ * zeroed).  One thread handles one system.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_c Upper diagonal
+ * @param[in,out] d_bMod The modified main diagonal
+ * @param[in,out] d_u The right hand side of the correction system
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ */
+template <class T>
+__global__ void periodicSetupKernel(const T *d_a,
+                                    const T *d_b,
+                                    const T *d_c,
+                                    T *d_bMod,
+                                    T *d_u,
+                                    unsigned int systemSize,
+                                    unsigned int numSystems)
+{
+    const size_t sys = ((size_t)blockIdx.y * gridDim.x + blockIdx.x) * blockDim.x
+                     + threadIdx.x;
+    if (sys >= numSystems)
+        return;
+
+    const size_t first = sys * systemSize;
+    const size_t last = first + systemSize - 1;
+
+    const T gamma = (d_b[first] != 0) ? -d_b[first] : 1;
+    d_bMod[first] = d_b[first] - gamma;
+    d_bMod[last] = d_b[last] - d_c[last] * d_a[first] / gamma;
+    d_u[first] = gamma;
+    d_u[last] = d_c[last];
+}
+
+/**
+ * @brief Periodic solver: compute the Sherman-Morrison factor per system
+ *
+ * Given the solutions \a y and \a z of the modified system with the
+ * original right hand side and with \a u, computes
+ * <tt>(v.y) / (1 + v.z)</tt> for each system.
+ *
+ * @param[in] d_a Lower diagonal
+ * @param[in] d_b Main diagonal
+ * @param[in] d_y Solution of the modified system for the right hand side
+ * @param[in] d_z Solution of the modified system for \a u
+ * @param[out] d_factor One factor per system
+ * @param[in] systemSize The size of each system
+ * @param[in] numSystems The number of systems
+ */
+template <class T>
+__global__ void periodicFactorKernel(const T *d_a,
+                                     const T *d_b,
+                                     const T *d_y,
+                                     const T *d_z,
+                                     T *d_factor,
+                                     unsigned int systemSize,
+                                     unsigned int numSystems)
+{
+    const size_t sys = ((size_t)blockIdx.y * gridDim.x + blockIdx.x) * blockDim.x
+                     + threadIdx.x;
+    if (sys >= numSystems)
+        return;
+
+    const size_t first = sys * systemSize;
+    const size_t last = first + systemSize - 1;
+
+    const T gamma = (d_b[first] != 0) ? -d_b[first] : 1;
+    const T ratio = d_a[first] / gamma;
+    d_factor[sys] = (d_y[first] + ratio * d_y[last]) /
+                    (1 + d_z[first] + ratio * d_z[last]);
+}
+
+/**
+ * @brief Periodic solver: apply the Sherman-Morrison correction
+ *
+ * Computes <tt>x = y - factor * z</tt>, one thread per equation.
+ *
+ * @param[in,out] d_x On input the solution \a y, on output the solution
+ * @param[in] d_z Solution of the modified system for \a u
+ * @param[in] d_factor One factor per system
+ * @param[in] systemSize The size of each system
+ * @param[in] numElements The total number of equations in all systems
+ */
+template <class T>
+__global__ void periodicCorrectKernel(T *d_x,
+                                      const T *d_z,
+                                      const T *d_factor,
+                                      unsigned int systemSize,
+                                      size_t numElements)
+{
+    const size_t i = ((size_t)blockIdx.y * gridDim.x + blockIdx.x) * blockDim.x
+                   + threadIdx.x;
+    if (i >= numElements)
+        return;
+
+    d_x[i] -= d_factor[i / systemSize] * d_z[i];
+}
+
+/**
+ * @brief Solves the dense system <tt>L X = R</tt> for an M x M matrix
+ *
+ * Gaussian elimination with partial pivoting.  \a R holds M + 1 right
+ * hand sides (the columns of an M x M block followed by a vector) and is
+ * overwritten with the solution.  \a L is destroyed.
+ *
+ * @param[in,out] L The M x M matrix
+ * @param[in,out] R The right hand sides, replaced by the solution
+ */
+template <class T, int M>
+__device__ void blockSolve(T L[M][M], T R[M][M+1])
+{
+    for (int k = 0; k < M; k++)
+    {
+        int p = k;
+        for (int r = k + 1; r < M; r++)
+            if (fabs(L[r][k]) > fabs(L[p][k]))
+                p = r;
+        if (p != k)
+        {
+            for (int j = 0; j < M; j++)
+            {
+                T t = L[k][j]; L[k][j] = L[p][j]; L[p][j] = t;
+            }
+            for (int j = 0; j <= M; j++)
+            {
+                T t = R[k][j]; R[k][j] = R[p][j]; R[p][j] = t;
+            }
+        }
+        for (int r = k + 1; r < M; r++)
+        {
+            T f = L[r][k] / L[k][k];
+            for (int j = k + 1; j < M; j++)
+                L[r][j] -= f * L[k][j];
+            for (int j = 0; j <= M; j++)
+                R[r][j] -= f * R[k][j];
+        }
+    }
+    for (int k = M - 1; k >= 0; k--)
+    {
+        for (int j = 0; j <= M; j++)
+        {
+            T v = R[k][j];
+            for (int r = k + 1; r < M; r++)
+                v -= L[k][r] * R[r][j];
+            R[k][j] = v / L[k][k];
+        }
+    }
+}
+
+/**
+ * @brief Block-tridiagonal Thomas solver with M x M blocks
+ *
+ * Each thread solves one system with the block Thomas algorithm.  The
+ * diagonals \a d_a, \a d_b and \a d_c hold one row-major M x M block per
+ * equation, and \a d_d and \a d_x one M-vector per equation.  The forward
+ * sweep computes <tt>C'_j = (B_j - A_j C'_{j-1})^{-1} C_j</tt>, kept in
+ * \a d_scratch, and the modified right hand side, kept in \a d_x; the back
+ * substitution then computes <tt>x_j = d'_j - C'_j x_{j+1}</tt>.
+ *
+ * @param[in] d_a Lower diagonal blocks
+ * @param[in] d_b Main diagonal blocks
+ * @param[in] d_c Upper diagonal blocks
+ * @param[in] d_d Right hand side vectors
+ * @param[out] d_x Solution vectors
+ * @param[out] d_scratch Temporary storage of the same size as \a d_b
+ * @param[in] systemSize The number of block rows in each system
+ * @param[in] numSystems The number of systems
+ */
+template <class T, int M>
+__global__ void blockThomasKernel(const T *d_a,
+                                  const T *d_b,
+                                  const T *d_c,
+                                  const T *d_d,
+                                  T *d_x,
+                                  T *d_scratch,
+                                  unsigned int systemSize,
+                                  unsigned int numSystems)
+{
+    const size_t sys = ((size_t)blockIdx.y * gridDim.x + blockIdx.x) * blockDim.x
+                     + threadIdx.x;
+    if (sys >= numSystems)
+        return;
+
+    const T *a = d_a + sys * systemSize * M * M;
+    const T *b = d_b + sys * systemSize * M * M;
+    const T *c = d_c + sys * systemSize * M * M;
+    const T *d = d_d + sys * systemSize * M;
+    T *x = d_x + sys * systemSize * M;
+    T *cp = d_scratch + sys * systemSize * M * M;
+
+    T L[M][M];
+    T R[M][M+1];
+
+    for (unsigned int j = 0; j < systemSize; j++)
+    {
+        for (int r = 0; r < M; r++)
+        {
+            for (int k = 0; k < M; k++)
+            {
+                L[r][k] = b[(j * M + r) * M + k];
+                R[r][k] = (j == systemSize - 1) ? 0 : c[(j * M + r) * M + k];
+            }
+            R[r][M] = d[j * M + r];
+        }
+
+        if (j > 0)
+        {
+            for (int r = 0; r < M; r++)
+            {
+                for (int l = 0; l < M; l++)
+                {
+                    T arl = a[(j * M + r) * M + l];
+                    for (int k = 0; k < M; k++)
+                        L[r][k] -= arl * cp[((j - 1) * M + l) * M + k];
+                    R[r][M] -= arl * x[(j - 1) * M + l];
+                }
+            }
+        }
+
+        blockSolve<T, M>(L, R);
+
+        for (int r = 0; r < M; r++)
+        {
+            for (int k = 0; k < M; k++)
+                cp[(j * M + r) * M + k] = R[r][k];
+            x[j * M + r] = R[r][M];
+        }
+    }
+
+    for (int j = systemSize - 2; j >= 0; j--)
+    {
+        for (int r = 0; r < M; r++)
+        {
+            T v = x[j * M + r];
+            for (int k = 0; k < M; k++)
+                v -= cp[(j * M + r) * M + k] * x[(j + 1) * M + k];
+            x[j * M + r] = v;
+        }
+    }
+}
+
 /** @} */ // end Tridiagonal functions
 /** @} */ // end cudpp_kernel
 
@@ -151,6 +151,11 @@ __global__ void vectorAddUniform2(T *g_data,
   * memory and adds that value to all values "owned" by the CTA in \a d_vector.  
   * Each thread adds the uniform value to eight values in \a d_vector.
   *
+  * Template parameter \a U is the type of the uniforms, in which they are
+  * combined with the elements of \a d_vector; it is \a T, or double for
+  * float scans with ::CUDPP_OPTION_ACCUMULATE_DOUBLE.  \a Oper operates on
+  * \a U.
+  *
   * @param[out] d_vector The d_vector whose values will have the uniform added
   * @param[in] d_uniforms The array of uniform values (one per CTA)
   * @param[in] numElements The number of elements in \a d_vector to process
@@ -163,16 +168,16 @@ __global__ void vectorAddUniform2(T *g_data,
   * @param[in] baseIndex an optional offset to the beginning of the array 
   * within \a d_vector.
   */
-template <class T, class Oper, int elementsPerThread, bool fullBlocks>
+template <class T, class U, class Oper, int elementsPerThread, bool fullBlocks>
 __global__ void vectorAddUniform4(T       *d_vector, 
-                                  const T *d_uniforms, 
+                                  const U *d_uniforms, 
                                   int      numElements,             
                                   int      vectorRowPitch,     // width of input array in elements
                                   int      uniformRowPitch,    // width of uniform array in elements
                                   int      blockOffset, 
                                   int      baseIndex)
 {
-    __shared__ T uni;
+    __shared__ U uni;
     // Get this block's uniform value from the uniform array in device memory
     // We store it in shared memory so that the hardware's shared memory 
     // broadcast capability can be used to share among all threads in each warp
@@ -204,12 +209,52 @@ __global__ void vectorAddUniform4(T       *d_vector,
     {
         if (!fullBlocks && address >= numElements) return;
 
-        d_vector[address] = op(d_vector[address], uni);
+        d_vector[address] = (T)op((U)d_vector[address], uni);
         address += blockDim.x;
     }
 #endif
 }
 
+/** @brief Combine a single value stored in device memory with every element
+  * of an array.
+  *
+  * Unlike vectorAddUniform4(), all CTAs apply the same value, which is read
+  * from \a d_uniform rather than passed by value so that it may be produced by
+  * a preceding kernel without a round trip to the host.  This is used to
+  * propagate the running total between the segments of a scan that is too
+  * long for one pass of the scan kernels.
+  * Each thread combines the value with \a elementsPerThread values in
+  * \a d_vector.
+  *
+  * @param[in,out] d_vector The array whose values will have the uniform applied
+  * @param[in] d_uniform Pointer to the single uniform value
+  * @param[in] numElements The number of elements in \a d_vector to process
+  */
+template <class T, class Oper, int elementsPerThread>
+__global__ void vectorAddUniformValue(T            *d_vector,
+                                      const T      *d_uniform,
+                                      unsigned int numElements)
+{
+    __shared__ T uni;
+    if (threadIdx.x == 0)
+    {
+        uni = d_uniform[0];
+    }
+
+    unsigned int address = threadIdx.x + blockIdx.x * (blockDim.x * elementsPerThread);
+
+    __syncthreads();
+
+    Oper op;
+    for (int i = 0; i < elementsPerThread; i++)
+    {
+        if (address >= numElements) return;
+
+        d_vector[address] = op(uni, d_vector[address]);
+        address += blockDim.x;
+    }
+}
+
 /** @brief Adds together two vectors
  *  
  * Each thread adds two pairs of elements.
@@ -246,6 +291,9 @@ __global__ void vectorAddVector(T       *d_vectorA,        // A += B
   * it adds the uniform to all values "owned" by the CTA.
   * Each thread adds the uniform value to eight values in \a d_vector.
   *
+  * Template parameter \a U is the type of the uniforms, as for
+  * vectorAddUniform4().
+  *
   * @param[out] d_vector The d_vector whose values will have the uniform added
   * @param[in] d_uniforms The array of uniform values (one per CTA)
   * @param[in] d_maxIndices The array of maximum indices (one per CTA). This is
@@ -258,15 +306,15 @@ __global__ void vectorAddVector(T       *d_vectorA,        // A += B
   * @param[in] baseIndex an optional offset to the beginning of the array 
   * within \a d_vector.
   */
-template <class T, class Oper, bool isLastBlockFull>
+template <class T, class U, class Oper, bool isLastBlockFull>
 __global__ void vectorSegmentedAddUniform4(T                  *d_vector, 
-                                           const T            *d_uniforms, 
+                                           const U            *d_uniforms, 
                                            const unsigned int *d_maxIndices,
                                            unsigned int       numElements,
                                            int                blockOffset, 
                                            int                baseIndex)
 {
-    __shared__ T uni[2];
+    __shared__ U uni[2];
 
     unsigned int blockAddress = 
         blockIdx.x + __mul24(gridDim.x, blockIdx.y) + blockOffset;
@@ -286,7 +334,7 @@ __global__ void vectorSegmentedAddUniform4(T                  *d_vector,
         else
             uni[0] = op.identity(); 
         
-        // Tacit assumption that T is four-byte wide
+        // Tacit assumption that U is at least four bytes wide
         *((unsigned int *)(uni + 1)) = d_maxIndices[blockAddress]; 
     }
 
@@ -315,7 +363,7 @@ __global__ void vectorSegmentedAddUniform4(T                  *d_vector,
             {
                 for (unsigned int i = 0; i < 8; ++i)
                     d_vector[address + i * blockDim.x] = 
-                        op(d_vector[address + i * blockDim.x], uni[0]);
+                        (T)op((U)d_vector[address + i * blockDim.x], uni[0]);
             }
             else
             {
@@ -323,7 +371,7 @@ __global__ void vectorSegmentedAddUniform4(T                  *d_vector,
                 {
                     if (address < maxIndex)
                         d_vector[address] = 
-                            op(d_vector[address], uni[0]);
+                            (T)op((U)d_vector[address], uni[0]);
 
                     address += blockDim.x;
                 }
@@ -338,7 +386,7 @@ __global__ void vectorSegmentedAddUniform4(T                  *d_vector,
             {
                 if (address < numElements)
                     d_vector[address] = 
-                        op(d_vector[address], uni[0]);
+                        (T)op((U)d_vector[address], uni[0]);
                 
                 address += blockDim.x;
             }
@@ -348,7 +396,7 @@ __global__ void vectorSegmentedAddUniform4(T                  *d_vector,
             for (unsigned int i=0; i<8; ++i)
             {
                 d_vector[address] = 
-                    op(d_vector[address], uni[0]);
+                    (T)op((U)d_vector[address], uni[0]);
                 
                 address += blockDim.x;
             }            
@@ -365,6 +413,9 @@ __global__ void vectorSegmentedAddUniform4(T                  *d_vector,
   * it adds the uniform to all values "owned" by the CTA.
   * Each thread adds the uniform value to eight values in \a d_vector.
   *
+  * Template parameter \a U is the type of the uniforms, as for
+  * vectorAddUniform4().
+  *
   * @param[out] d_vector The d_vector whose values will have the uniform added
   * @param[in] d_uniforms The array of uniform values (one per CTA)
   * @param[in] d_minIndices The array of minimum indices (one per CTA). The
@@ -382,15 +433,15 @@ __global__ void vectorSegmentedAddUniform4(T                  *d_vector,
   * within \a d_vector.
   *
   */
-template <class T, class Oper, bool isLastBlockFull>
+template <class T, class U, class Oper, bool isLastBlockFull>
 __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector, 
-                                                  const T            *d_uniforms, 
+                                                  const U            *d_uniforms, 
                                                   const unsigned int *d_minIndices,
                                                   unsigned int       numElements,
                                                   int                blockOffset, 
                                                   int                baseIndex)
 {
-    __shared__ T uni[2];
+    __shared__ U uni[2];
 
     unsigned int blockAddress = 
         blockIdx.x + __mul24(gridDim.x, blockIdx.y) + blockOffset;
@@ -412,7 +463,7 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
         else
             uni[0] = op.identity(); 
         
-        // Tacit assumption that T is four-byte wide
+        // Tacit assumption that U is at least four bytes wide
         *((unsigned int *)(uni + 1)) = d_minIndices[blockAddress]; 
     }
 
@@ -444,7 +495,7 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
                     for (unsigned int i = 0; i < 8; ++i) 
                     { 
                         if (address < numElements) 
-                            d_vector[address] = op(d_vector[address], uni[0]); 
+                            d_vector[address] = (T)op((U)d_vector[address], uni[0]); 
                         address += blockDim.x; 
                     } 
                 } 
@@ -452,7 +503,7 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
                 { 
                     for (unsigned int i=0; i<8; ++i) 
                     { 
-                        d_vector[address] = op(d_vector[address], uni[0]); 
+                        d_vector[address] = (T)op((U)d_vector[address], uni[0]); 
                         address += blockDim.x; 
                     }             
                 }
@@ -464,7 +515,7 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
                     for (unsigned int i = 0; i < 8; ++i) 
                     { 
                         if (address > minIndex && address < numElements) 
-                            d_vector[address] = op(d_vector[address], uni[0]); 
+                            d_vector[address] = (T)op((U)d_vector[address], uni[0]); 
          
                         address += blockDim.x; 
                     }
@@ -474,7 +525,7 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
                     for (unsigned int i=0; i<8; ++i) 
                     {
                         if (address > minIndex) 
-                            d_vector[address] = op(d_vector[address], uni[0]); 
+                            d_vector[address] = (T)op((U)d_vector[address], uni[0]); 
 
                         address += blockDim.x; 
                     }             
@@ -489,7 +540,7 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
             for (unsigned int i = 0; i < 8; ++i)
             {
                 if (address < numElements)
-                    d_vector[address] = op(d_vector[address], uni[0]);
+                    d_vector[address] = (T)op((U)d_vector[address], uni[0]);
                 
                 address += blockDim.x;
             }
@@ -498,7 +549,7 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
         {
             for (unsigned int i=0; i<8; ++i)
             {
-                d_vector[address] = op(d_vector[address], uni[0]);
+                d_vector[address] = (T)op((U)d_vector[address], uni[0]);
                 
                 address += blockDim.x;
             }            
@@ -506,5 +557,27 @@ __global__ void vectorSegmentedAddUniformToRight4(T                  *d_vector,
     }
 }
 
+/** @brief Copy an array, converting each element to another type
+  *
+  * Used to widen the first-level block sums of float scans and segmented
+  * scans to double for ::CUDPP_OPTION_ACCUMULATE_DOUBLE.  The grid loops
+  * over the array, so any number of CTAs may be launched.
+  *
+  * @param[out] d_out The converted array
+  * @param[in] d_in The array to convert
+  * @param[in] numElements The number of elements to convert
+  */
+template <class T, class U>
+__global__ void vectorConvert(U            *d_out,
+                              const T      *d_in,
+                              unsigned int numElements)
+{
+    for (unsigned int i = blockIdx.x * blockDim.x + threadIdx.x;
+         i < numElements; i += blockDim.x * gridDim.x)
+    {
+        d_out[i] = (U)d_in[i];
+    }
+}
+
 /** @} */ // end d_vector functions
 /** @} */ // end cudpp_kernel
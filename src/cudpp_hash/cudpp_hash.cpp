@@ -303,6 +303,49 @@ cudppHashTable(CUDPPHandle cudppHandle, CUDPPHandle *plan,
     return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
 }
 
+/**
+ * @brief Builds a hash table of any type, recording the call and the
+ * attempts the build took for the instance's statistics
+ */
+template <class HTI>
+static CUDPPResult hashTableInsert(CUDPPHandle plan, const void* d_keys, 
+                                   const void* d_vals, size_t num)
+{
+    HTI * hti = (HTI *) getPlanPtrFromHandle<HTI>(plan);
+    CUDPPManager *mgr = 
+        CUDPPManager::getManagerFromHandle(hti->hash_table->getTheCudpp());
+    CUDPPCallRecorder record(mgr, NULL, "cudppHashInsert", 
+                             CUDPP_ALGORITHM_INVALID, plan, 0, num,
+                             2 * num * sizeof(unsigned int), 0);
+
+    bool s = hti->hash_table->Build(num, (const unsigned int *) d_keys, 
+                                    (const unsigned int *) d_vals);
+
+    unsigned attempts = hti->hash_table->get_build_attempts();
+    mgr->addIterations(attempts);
+    if (attempts > 1)
+        mgr->addRestarts(attempts - 1);
+    return s ? CUDPP_SUCCESS : CUDPP_ERROR_UNKNOWN;
+}
+
+/**
+ * @brief Queries a hash table of any type, recording the call for the 
+ * instance's statistics
+ */
+template <class HTI, class V>
+static CUDPPResult hashTableRetrieve(CUDPPHandle plan, const void* d_keys, 
+                                     void* d_vals, size_t num)
+{
+    HTI * hti = (HTI *) getPlanPtrFromHandle<HTI>(plan);
+    CUDPPCallRecorder record(
+        CUDPPManager::getManagerFromHandle(hti->hash_table->getTheCudpp()), 
+        NULL, "cudppHashRetrieve", CUDPP_ALGORITHM_INVALID, plan, 0, num,
+        num * sizeof(unsigned int), num * sizeof(V));
+
+    hti->hash_table->Retrieve(num, (const unsigned int *) d_keys, (V *) d_vals);
+    return CUDPP_SUCCESS;
+}
+
 // Then cudppHashTableInsert/Retrieve, or any other functions that
 // operate on it, take the CUDPPHandle as input, and call
 // getPlanPtrFromHandle<T>(handle), where T is the type of the
@@ -342,31 +385,14 @@ cudppHashInsert(CUDPPHandle plan, const void* d_keys, const void* d_vals,
     switch(hti_init->config.type)
     {
     case CUDPP_BASIC_HASH_TABLE:
-    {
-        hti_basic * hti = (hti_basic *) getPlanPtrFromHandle<hti_basic>(plan);
-        bool s = hti->hash_table->Build(num, (const unsigned int *) d_keys, 
-                                        (const unsigned int *) d_vals);
-        return s ? CUDPP_SUCCESS : CUDPP_ERROR_UNKNOWN;
+        return hashTableInsert<hti_basic>(plan, d_keys, d_vals, num);
         break;
-    }
     case CUDPP_COMPACTING_HASH_TABLE:
-    {
-        hti_compacting * hti =
-            (hti_compacting *) getPlanPtrFromHandle<hti_compacting>(plan);
-        bool s = hti->hash_table->Build(num, (const unsigned int *) d_keys, 
-                                        (const unsigned int *) d_vals);
-        return s ? CUDPP_SUCCESS : CUDPP_ERROR_UNKNOWN;
+        return hashTableInsert<hti_compacting>(plan, d_keys, d_vals, num);
         break;
-    } 
     case CUDPP_MULTIVALUE_HASH_TABLE:
-    {
-        hti_multivalue * hti =
-            (hti_multivalue *) getPlanPtrFromHandle<hti_multivalue>(plan);
-        bool s = hti->hash_table->Build(num, (const unsigned int *) d_keys, 
-                                        (const unsigned int *) d_vals);
-        return s ? CUDPP_SUCCESS : CUDPP_ERROR_UNKNOWN;
+        return hashTableInsert<hti_multivalue>(plan, d_keys, d_vals, num);
         break;
-    } 
     case CUDPP_INVALID_HASH_TABLE:
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
         break;
@@ -406,31 +432,14 @@ cudppHashRetrieve(CUDPPHandle plan, const void* d_keys, void* d_vals,
     switch(hti_init->config.type)
     {
     case CUDPP_BASIC_HASH_TABLE:
-    {
-        hti_basic * hti = (hti_basic *) getPlanPtrFromHandle<hti_basic>(plan);
-        hti->hash_table->Retrieve(num, (const unsigned int *) d_keys, 
-                                           (unsigned int *) d_vals);
-        return CUDPP_SUCCESS;
+        return hashTableRetrieve<hti_basic, unsigned int>(plan, d_keys, d_vals, num);
         break;
-    }
     case CUDPP_COMPACTING_HASH_TABLE:
-    {
-        hti_compacting * hti = 
-            (hti_compacting *) getPlanPtrFromHandle<hti_compacting>(plan);
-        hti->hash_table->Retrieve(num, (const unsigned int *) d_keys, 
-                                  (unsigned int *) d_vals);
-        return CUDPP_SUCCESS;
+        return hashTableRetrieve<hti_compacting, unsigned int>(plan, d_keys, d_vals, num);
         break;
-    }
     case CUDPP_MULTIVALUE_HASH_TABLE:
-    {
-        hti_multivalue * hti = 
-            (hti_multivalue *) getPlanPtrFromHandle<hti_multivalue>(plan);
-        hti->hash_table->Retrieve(num, (const unsigned int *) d_keys, 
-                                  (uint2 *) d_vals);
-        return CUDPP_SUCCESS;
+        return hashTableRetrieve<hti_multivalue, uint2>(plan, d_keys, d_vals, num);
         break;
-    }
     case CUDPP_INVALID_HASH_TABLE:
         return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
         break;
@@ -557,6 +566,36 @@ cudppMultivalueHashGetAllValues(CUDPPHandle plan, unsigned int ** d_vals)
     return CUDPP_SUCCESS;
 }
 
+/**
+ * @brief Gets the counters of all the hash table calls of an instance 
+ * of the CUDPP library
+ *
+ * Insertions and retrievals of every hash table created with 
+ * \a cudppHandle are counted together, while statistics are enabled
+ * (see cudppEnableStatistics()).  Each insertion counts the attempts 
+ * its build took as iterations, and the attempts after the first as 
+ * restarts.  Scratch bytes are not tracked for hash tables.
+ *
+ * @param[in] cudppHandle Handle to CUDPP instance
+ * @param[out] stats The counters
+ * @returns CUDPPResult indicating success or error condition
+ *
+ * @see cudppEnableStatistics, cudppGetStatistics, cudppHashInsert,
+ * cudppHashRetrieve
+ */
+CUDPP_DLL
+CUDPPResult
+cudppHashTableStatistics(CUDPPHandle cudppHandle, CUDPPStatistics *stats)
+{
+    CUDPPManager *mgr = CUDPPManager::getManagerFromHandle(cudppHandle);
+    if (mgr == NULL)
+        return CUDPP_ERROR_INVALID_HANDLE;
+    if (stats == NULL)
+        return CUDPP_ERROR_ILLEGAL_CONFIGURATION;
+    mgr->getStatistics(CUDPPManager::HASH_TABLE_STATISTICS, *stats);
+    return CUDPP_SUCCESS;
+}
+
 /** @} */ // end Plan Interface
 /** @} */ // end publicInterface
 
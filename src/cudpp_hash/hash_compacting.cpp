@@ -103,6 +103,7 @@ bool CompactingHashTable::Build(const unsigned  n,
 #endif
     }
 
+    build_attempts_ = num_attempts;
     if (num_attempts >= kMaxRestartAttempts) {
         PrintMessage("Completely failed to build.", true);
         return false;
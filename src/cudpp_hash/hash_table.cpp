@@ -83,7 +83,8 @@ unsigned ComputeMaxIterations(const unsigned n,
 HashTable::HashTable() : table_size_(0),
                          d_contents_(NULL),
                          stash_count_(0),
-                         d_failures_(NULL) {
+                         d_failures_(NULL),
+                         build_attempts_(0) {
     CUDA_CHECK_ERROR("Failed in constructor.\n");                         
 }                         
 
@@ -238,6 +239,8 @@ bool HashTable::Build(const unsigned  n,
     CUDA_SAFE_CALL(cudaFree(d_iterations_taken));
 #endif
 
+    build_attempts_ = num_attempts;
+
     // Dump some info if a restart was required.
     if (num_attempts >= kMaxRestartAttempts) {
         sprintf(buffer, "Completely failed to build");
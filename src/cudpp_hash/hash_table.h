@@ -155,6 +155,9 @@ class HashTable {
   inline unsigned     get_num_hash_functions() const {return 
                                                       num_hash_functions_;}
 
+  //! Returns how many attempts the last Build() made.
+  inline unsigned     get_build_attempts()     const {return build_attempts_;}
+
   //! When using two hash functions, returns the constants.
   inline Functions<2> get_constants_2()        const {return constants_2_;}
 
@@ -170,6 +173,9 @@ class HashTable {
   //! Set the internal CUDPP instance
   inline void setTheCudpp(CUDPPHandle theCudpp_)     { theCudpp = theCudpp_; }
 
+  //! Returns the internal CUDPP instance
+  inline CUDPPHandle getTheCudpp()             const { return theCudpp; }
+
   /// @}
 
  protected:
@@ -185,6 +191,7 @@ class HashTable {
   Functions<5>  constants_5_;          //!< Constants for a set of five hash functions.
 
   unsigned     *d_failures_;           //!< Device memory: General use error flag.
+  unsigned      build_attempts_;       //!< Attempts made by the last Build().
 
   CUDPPHandle  theCudpp;               //!< CUDPP instance
 };